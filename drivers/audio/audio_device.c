@@ -151,7 +151,7 @@ static void _audio_dma_start_transfer(struct _audio_desc *desc, void *src_addres
 
 	dma_configure_transfer(desc->dma.channel, &desc->dma.cfg);
 	if(cb)
-		dma_set_callback(desc->dma.channel, cb, NULL);
+		dma_set_callback(desc->dma.channel, cb, desc->dma.cb_arg);
 	dma_start_transfer(desc->dma.channel);
 }
 
@@ -423,7 +423,7 @@ void audio_dma_transfer(struct _audio_desc *desc, void *buffer, uint32_t size,
 			return;
 
 		case AUDIO_DEVICE_RECORD:
-			pdmic_dma_transfer(buffer, size, cb, NULL);
+			pdmic_dma_transfer(buffer, size, cb, desc->dma.cb_arg);
 			return;
 		}
 		break;
@@ -459,6 +459,7 @@ bool audio_dma_transfer_is_done(struct _audio_desc *desc)
 
 void audio_set_dma_callback(struct _audio_desc *desc, audio_callback_t cb, void* arg)
 {
+	desc->dma.cb_arg = arg;
 	dma_set_callback(desc->dma.channel, cb, arg);
 }
 
@@ -113,6 +113,7 @@ struct _audio_desc {
 		struct dma_channel *channel;
 		struct dma_xfer_cfg cfg;
 		bool configured;
+		void* cb_arg;
 	} dma;
 
 	/* Sample Frequency (fs) Ratio */
@@ -165,7 +166,7 @@ extern void audio_dma_stop(struct _audio_desc *desc);
  * \param desc     Audio descriptor
  * \param buffer   Data buffer (input/output according to configuration in descriptor)
  * \param size     Data buffer size
- * \param cb       Callback at end of DMA transfer
+ * \param cb       Callback at end of DMA transfer, called with desc->dma.cb_arg
  */
 extern void audio_dma_transfer(struct _audio_desc *desc, void *buffer, uint32_t size, audio_callback_t cb);
 
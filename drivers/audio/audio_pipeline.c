@@ -0,0 +1,600 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "audio/audio_pipeline.h"
+#include "misc/cache.h"
+
+#include "ring.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static inline uint32_t _queue_size(const struct _audio_pipeline* pipe)
+{
+	return pipe->count + 1;
+}
+
+static uint32_t _queue_count(const struct _audio_pipeline* pipe,
+		const struct _audio_queue* q)
+{
+	return RING_CNT(q->head, q->tail, _queue_size(pipe));
+}
+
+static void _queue_push(struct _audio_pipeline* pipe, struct _audio_queue* q,
+		struct _audio_buffer* buf)
+{
+	uint8_t head = q->head;
+
+	q->idx[head] = buf->index;
+	/* publish the entry before the index */
+	dmb();
+	RING_INC(head, _queue_size(pipe));
+	q->head = head;
+}
+
+static struct _audio_buffer* _queue_pop(struct _audio_pipeline* pipe,
+		struct _audio_queue* q)
+{
+	uint8_t tail = q->tail;
+	uint8_t index;
+
+	if (RING_EMPTY(q->head, tail))
+		return NULL;
+	dmb();
+	index = q->idx[tail];
+	RING_INC(tail, _queue_size(pipe));
+	q->tail = tail;
+	return &pipe->buffers[index];
+}
+
+static void _reset_queues(struct _audio_pipeline* pipe)
+{
+	uint8_t i;
+
+	RING_CLEAR(pipe->free.head, pipe->free.tail);
+	RING_CLEAR(pipe->filled.head, pipe->filled.tail);
+	RING_CLEAR(pipe->ready.head, pipe->ready.tail);
+	for (i = 0; i < pipe->count; i++)
+		_queue_push(pipe, &pipe->free, &pipe->buffers[i]);
+	pipe->capture = NULL;
+	pipe->playback = NULL;
+	pipe->sink_active = false;
+}
+
+static void _update_latency(struct _audio_pipeline* pipe,
+		const struct _audio_buffer* buf)
+{
+	uint32_t latency = pipe->sequence - buf->sequence - 1;
+
+	pipe->stats.latency = latency;
+	if (latency < pipe->stats.latency_min)
+		pipe->stats.latency_min = latency;
+	if (latency > pipe->stats.latency_max)
+		pipe->stats.latency_max = latency;
+}
+
+static void _source_callback(struct dma_channel* channel, void* arg);
+static void _sink_callback(struct dma_channel* channel, void* arg);
+
+static void _source_start(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf)
+{
+	pipe->capture = buf;
+	/* drop dirty lines left by the stages before the DMA writes */
+	cache_invalidate_region(buf->data, pipe->period_size);
+	audio_dma_transfer(pipe->source, buf->data, pipe->period_size,
+			_source_callback);
+}
+
+static void _source_callback(struct dma_channel* channel, void* arg)
+{
+	struct _audio_pipeline* pipe = (struct _audio_pipeline*)arg;
+	struct _audio_buffer* buf = pipe->capture;
+	struct _audio_buffer* next;
+
+	if (!pipe->running || !buf)
+		return;
+
+	next = _queue_pop(pipe, &pipe->free);
+	if (next) {
+		cache_invalidate_region(buf->data, pipe->period_size);
+		buf->size = pipe->period_size;
+		buf->bits = pipe->bits;
+		buf->sequence = pipe->sequence;
+		_queue_push(pipe, &pipe->filled, buf);
+	} else {
+		/* no room downstream: capture again over the same period */
+		pipe->stats.overruns++;
+		next = buf;
+	}
+	pipe->sequence++;
+	_source_start(pipe, next);
+}
+
+static void _sink_start(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf)
+{
+	pipe->playback = buf;
+	_update_latency(pipe, buf);
+	/* audio_dma_transfer() cleans the buffer from the cache */
+	audio_dma_transfer(pipe->sink, buf->data, buf->size, _sink_callback);
+}
+
+static void _sink_callback(struct dma_channel* channel, void* arg)
+{
+	struct _audio_pipeline* pipe = (struct _audio_pipeline*)arg;
+	struct _audio_buffer* buf = pipe->playback;
+	struct _audio_buffer* next;
+
+	if (!pipe->running || !buf)
+		return;
+
+	pipe->playback = NULL;
+	_queue_push(pipe, &pipe->free, buf);
+	pipe->stats.periods++;
+
+	next = _queue_pop(pipe, &pipe->ready);
+	if (next) {
+		_sink_start(pipe, next);
+	} else {
+		/* starved: audio_pipeline_process() restarts after prefill so
+		 * that the latency is the same as after start */
+		pipe->stats.underruns++;
+		pipe->sink_active = false;
+	}
+}
+
+static inline int32_t _saturate(int32_t value, int32_t max)
+{
+	if (value > max)
+		return max;
+	if (value < -max - 1)
+		return -max - 1;
+	return value;
+}
+
+static inline int32_t _sample_max(uint8_t bits)
+{
+	return (int32_t)((1u << (bits - 1)) - 1);
+}
+
+static void _stage_volume(struct _audio_stage* stage, struct _audio_buffer* buf)
+{
+	int32_t gain = stage->cfg.volume.gain;
+	uint32_t i, count;
+
+	if (gain == AUDIO_GAIN_UNITY)
+		return;
+
+	if (buf->bits == 16) {
+		int16_t* s = (int16_t*)buf->data;
+		count = buf->size / sizeof(int16_t);
+		for (i = 0; i < count; i++)
+			s[i] = _saturate((s[i] * gain) >> 15, INT16_MAX);
+	} else {
+		int32_t* s = (int32_t*)buf->data;
+		int32_t max = _sample_max(buf->bits);
+		count = buf->size / sizeof(int32_t);
+		for (i = 0; i < count; i++) {
+			int64_t v = ((int64_t)s[i] * gain) >> 15;
+			if (v > max)
+				v = max;
+			else if (v < -(int64_t)max - 1)
+				v = -(int64_t)max - 1;
+			s[i] = (int32_t)v;
+		}
+	}
+}
+
+static void _stage_mix(struct _audio_stage* stage, struct _audio_buffer* buf)
+{
+	struct _audio_pipeline* from = stage->cfg.mix.from;
+	struct _audio_buffer* other = audio_pipeline_get_ready(from);
+	int32_t gain = stage->cfg.mix.gain;
+	uint32_t i, count, size;
+
+	if (!other)
+		return;
+
+	size = buf->size < other->size ? buf->size : other->size;
+	if (buf->bits == 16) {
+		int16_t* d = (int16_t*)buf->data;
+		const int16_t* s = (const int16_t*)other->data;
+		count = size / sizeof(int16_t);
+		for (i = 0; i < count; i++)
+			d[i] = _saturate(d[i] + ((s[i] * gain) >> 15), INT16_MAX);
+	} else {
+		int32_t* d = (int32_t*)buf->data;
+		const int32_t* s = (const int32_t*)other->data;
+		int64_t max = _sample_max(buf->bits);
+		count = size / sizeof(int32_t);
+		for (i = 0; i < count; i++) {
+			int64_t v = d[i] + (((int64_t)s[i] * gain) >> 15);
+			if (v > max)
+				v = max;
+			else if (v < -max - 1)
+				v = -max - 1;
+			d[i] = (int32_t)v;
+		}
+	}
+
+	audio_pipeline_release(from, other);
+}
+
+static void _stage_convert(struct _audio_stage* stage, struct _audio_buffer* buf)
+{
+	const int16_t* s = (const int16_t*)buf->data;
+	int32_t* d = (int32_t*)buf->data;
+	uint8_t shift = stage->cfg.convert.bits == 24 ? 8 : 16;
+	uint32_t count = buf->size / sizeof(int16_t);
+
+	/* expand in place, from the end so no sample is overwritten early */
+	while (count--)
+		d[count] = (int32_t)((uint32_t)(int32_t)s[count] << shift);
+
+	buf->size = (buf->size / sizeof(int16_t)) * sizeof(int32_t);
+	buf->bits = stage->cfg.convert.bits;
+}
+
+/**
+ * \brief Sample resolution at the output of a pipeline stage chain
+ */
+static uint8_t _output_bits(const struct _audio_pipeline* pipe)
+{
+	const struct _audio_stage* stage;
+	uint8_t bits = pipe->bits;
+
+	for (stage = pipe->stages; stage; stage = stage->next)
+		if (stage->type == AUDIO_STAGE_CONVERT)
+			bits = stage->cfg.convert.bits;
+	return bits;
+}
+
+/**
+ * \brief Check that a stage accepts the samples produced before it
+ * \param pipe   Pipeline
+ * \param stage  Stage to check
+ * \param bits   Sample resolution at the input of the stage
+ */
+static bool _stage_is_valid(const struct _audio_pipeline* pipe,
+		const struct _audio_stage* stage, uint8_t bits)
+{
+	const struct _audio_pipeline* from;
+
+	switch (stage->type) {
+	case AUDIO_STAGE_MIX:
+		from = stage->cfg.mix.from;
+		if (!from || from == pipe || from->sink)
+			return false;
+		return _output_bits(from) == bits;
+	case AUDIO_STAGE_CONVERT:
+		/* expanded in place: the buffer must hold twice a period */
+		return bits == 16 &&
+			pipe->buffer_size >= 2 * pipe->period_size;
+	case AUDIO_STAGE_CUSTOM:
+		return stage->cfg.custom.cb != NULL;
+	default:
+		return true;
+	}
+}
+
+/**
+ * \brief Check the stage chain of a pipeline, followed by an optional new stage
+ */
+static int _check_stages(const struct _audio_pipeline* pipe,
+		const struct _audio_stage* extra)
+{
+	const struct _audio_stage* stage = pipe->stages ? pipe->stages : extra;
+	uint8_t bits = pipe->bits;
+
+	while (stage) {
+		if (!_stage_is_valid(pipe, stage, bits))
+			return AUDIO_PIPELINE_INVALID_PARAM;
+		if (stage->type == AUDIO_STAGE_CONVERT)
+			bits = stage->cfg.convert.bits;
+		if (stage->next)
+			stage = stage->next;
+		else if (stage != extra)
+			stage = extra;
+		else
+			stage = NULL;
+	}
+	return AUDIO_PIPELINE_SUCCESS;
+}
+
+static void _run_stages(struct _audio_pipeline* pipe, struct _audio_buffer* buf)
+{
+	struct _audio_stage* stage;
+
+	for (stage = pipe->stages; stage; stage = stage->next) {
+		/* the sample format after a convert stage was checked when the
+		 * chain was built, so it cannot be bypassed */
+		if (stage->bypass && stage->type != AUDIO_STAGE_CONVERT)
+			continue;
+
+		switch (stage->type) {
+		case AUDIO_STAGE_VOLUME:
+			_stage_volume(stage, buf);
+			break;
+		case AUDIO_STAGE_MIX:
+			_stage_mix(stage, buf);
+			break;
+		case AUDIO_STAGE_CONVERT:
+			_stage_convert(stage, buf);
+			break;
+		case AUDIO_STAGE_CUSTOM:
+			stage->cfg.custom.cb(stage, buf, stage->cfg.custom.arg);
+			break;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int audio_pipeline_initialize(struct _audio_pipeline* pipe)
+{
+	uint8_t i;
+
+	if (!pipe->pool || ((uint32_t)pipe->pool & (L1_CACHE_BYTES - 1)))
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (pipe->count < 2 || pipe->count > AUDIO_PIPELINE_MAX_BUFFERS)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (!pipe->buffer_size || (pipe->buffer_size & (L1_CACHE_BYTES - 1)))
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (!pipe->period_size || pipe->period_size > pipe->buffer_size)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (pipe->bits != 16 && pipe->bits != 24 && pipe->bits != 32)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (pipe->prefill >= pipe->count)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+	if (!pipe->prefill)
+		pipe->prefill = pipe->count / 2;
+	if (_check_stages(pipe, NULL) != AUDIO_PIPELINE_SUCCESS)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+
+	for (i = 0; i < pipe->count; i++) {
+		pipe->buffers[i].data = pipe->pool + i * pipe->buffer_size;
+		pipe->buffers[i].size = 0;
+		pipe->buffers[i].sequence = 0;
+		pipe->buffers[i].bits = pipe->bits;
+		pipe->buffers[i].index = i;
+	}
+	_reset_queues(pipe);
+	pipe->running = false;
+	pipe->sequence = 0;
+	audio_pipeline_get_stats(pipe, NULL, true);
+
+	return AUDIO_PIPELINE_SUCCESS;
+}
+
+int audio_pipeline_add_stage(struct _audio_pipeline* pipe,
+		struct _audio_stage* stage)
+{
+	struct _audio_stage** last = &pipe->stages;
+
+	if (pipe->running)
+		return AUDIO_PIPELINE_ERROR_BUSY;
+
+	stage->next = NULL;
+	if (_check_stages(pipe, stage) != AUDIO_PIPELINE_SUCCESS)
+		return AUDIO_PIPELINE_INVALID_PARAM;
+
+	while (*last)
+		last = &(*last)->next;
+	*last = stage;
+
+	return AUDIO_PIPELINE_SUCCESS;
+}
+
+int audio_pipeline_start(struct _audio_pipeline* pipe)
+{
+	if (pipe->running)
+		return AUDIO_PIPELINE_ERROR_BUSY;
+
+	_reset_queues(pipe);
+	pipe->sequence = 0;
+	pipe->running = true;
+
+	if (pipe->sink) {
+		pipe->sink->dma.cb_arg = pipe;
+		audio_enable(pipe->sink, true);
+	}
+	if (pipe->source) {
+		pipe->source->dma.cb_arg = pipe;
+		_source_start(pipe, _queue_pop(pipe, &pipe->free));
+		audio_enable(pipe->source, true);
+	}
+
+	return AUDIO_PIPELINE_SUCCESS;
+}
+
+void audio_pipeline_stop(struct _audio_pipeline* pipe)
+{
+	pipe->running = false;
+
+	if (pipe->source) {
+		audio_enable(pipe->source, false);
+		audio_dma_stop(pipe->source);
+	}
+	if (pipe->sink) {
+		audio_dma_stop(pipe->sink);
+		audio_enable(pipe->sink, false);
+	}
+	_reset_queues(pipe);
+}
+
+uint32_t audio_pipeline_process(struct _audio_pipeline* pipe)
+{
+	struct _audio_buffer* buf;
+	uint32_t processed = 0;
+
+	if (!pipe->running)
+		return 0;
+
+	while ((buf = _queue_pop(pipe, &pipe->filled)) != NULL) {
+		_run_stages(pipe, buf);
+		_queue_push(pipe, &pipe->ready, buf);
+		processed++;
+	}
+
+	/* The sink callback only clears sink_active once its DMA is idle, so
+	 * the restart below cannot race with it */
+	if (pipe->sink && !pipe->sink_active &&
+	    _queue_count(pipe, &pipe->ready) >= pipe->prefill) {
+		pipe->sink_active = true;
+		_sink_start(pipe, _queue_pop(pipe, &pipe->ready));
+	}
+
+	return processed;
+}
+
+struct _audio_buffer* audio_pipeline_get_free(struct _audio_pipeline* pipe)
+{
+	struct _audio_buffer* buf;
+
+	if (pipe->source || !pipe->running)
+		return NULL;
+
+	buf = _queue_pop(pipe, &pipe->free);
+	if (!buf) {
+		pipe->stats.overruns++;
+		return NULL;
+	}
+	buf->size = 0;
+	buf->bits = pipe->bits;
+	return buf;
+}
+
+void audio_pipeline_submit(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf)
+{
+	/* stages may expand the samples up to the checked bound */
+	if (buf->size > pipe->period_size)
+		buf->size = pipe->period_size;
+	buf->sequence = pipe->sequence++;
+	_queue_push(pipe, &pipe->filled, buf);
+}
+
+struct _audio_buffer* audio_pipeline_get_ready(struct _audio_pipeline* pipe)
+{
+	struct _audio_buffer* buf;
+
+	if (pipe->sink || !pipe->running)
+		return NULL;
+
+	if (!pipe->sink_active) {
+		if (_queue_count(pipe, &pipe->ready) < pipe->prefill)
+			return NULL;
+		pipe->sink_active = true;
+	}
+
+	buf = _queue_pop(pipe, &pipe->ready);
+	if (!buf) {
+		pipe->stats.underruns++;
+		pipe->sink_active = false;
+		return NULL;
+	}
+	_update_latency(pipe, buf);
+	return buf;
+}
+
+void audio_pipeline_release(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf)
+{
+	_queue_push(pipe, &pipe->free, buf);
+	pipe->stats.periods++;
+}
+
+void audio_pipeline_get_stats(struct _audio_pipeline* pipe,
+		struct _audio_pipeline_stats* stats, bool reset)
+{
+	if (stats)
+		memcpy(stats, &pipe->stats, sizeof(*stats));
+
+	if (reset) {
+		memset(&pipe->stats, 0, sizeof(pipe->stats));
+		pipe->stats.latency_min = UINT32_MAX;
+	}
+}
+
+uint32_t audio_pipeline_periods_to_us(struct _audio_pipeline* pipe,
+		uint32_t periods, uint32_t frame_size, uint32_t sample_rate)
+{
+	uint64_t frames;
+
+	if (!frame_size || !sample_rate)
+		return 0;
+
+	frames = (uint64_t)periods * (pipe->period_size / frame_size);
+	return (uint32_t)((frames * 1000000) / sample_rate);
+}
+
+void audio_stage_init_volume(struct _audio_stage* stage, uint16_t gain)
+{
+	memset(stage, 0, sizeof(*stage));
+	stage->type = AUDIO_STAGE_VOLUME;
+	stage->cfg.volume.gain = gain;
+}
+
+void audio_stage_init_mix(struct _audio_stage* stage,
+		struct _audio_pipeline* from, uint16_t gain)
+{
+	memset(stage, 0, sizeof(*stage));
+	stage->type = AUDIO_STAGE_MIX;
+	stage->cfg.mix.from = from;
+	stage->cfg.mix.gain = gain;
+}
+
+void audio_stage_init_convert(struct _audio_stage* stage, uint8_t bits)
+{
+	memset(stage, 0, sizeof(*stage));
+	stage->type = AUDIO_STAGE_CONVERT;
+	stage->cfg.convert.bits = bits == 24 ? 24 : 32;
+}
+
+void audio_stage_init_custom(struct _audio_stage* stage,
+		audio_stage_callback_t cb, void* arg)
+{
+	memset(stage, 0, sizeof(*stage));
+	stage->type = AUDIO_STAGE_CUSTOM;
+	stage->cfg.custom.cb = cb;
+	stage->cfg.custom.arg = arg;
+}
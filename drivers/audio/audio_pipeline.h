@@ -0,0 +1,305 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Zero-copy audio pipeline.
+ *
+ * A pipeline owns a pool of cache-aligned period buffers and moves them by
+ * reference from a source to a sink:
+ *
+ *   free -> source -> filled -> stages -> ready -> sink -> free
+ *
+ * The source is either an audio device in record direction (SSC RX, PDMIC)
+ * driven by DMA, or the application pushing periods with
+ * audio_pipeline_get_free() / audio_pipeline_submit() (USB OUT, WAV file).
+ * The sink is either an audio device in play direction (SSC TX, ClassD)
+ * driven by DMA, or the application pulling periods with
+ * audio_pipeline_get_ready() / audio_pipeline_release() (USB IN, SD card).
+ *
+ * Each queue is a single-producer single-consumer ring of buffer indices, so
+ * the DMA callbacks and the application never need to mask interrupts.
+ * Stages (mixing, volume, format conversion) run in place from
+ * audio_pipeline_process(), which must be called from the main loop.
+ */
+
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "audio/audio_device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of period buffers in a pipeline pool */
+#define AUDIO_PIPELINE_MAX_BUFFERS   (16)
+
+/** Unity gain for volume and mix stages (Q15) */
+#define AUDIO_GAIN_UNITY             (0x8000)
+
+#define AUDIO_PIPELINE_SUCCESS       (0)
+#define AUDIO_PIPELINE_INVALID_PARAM (1)
+#define AUDIO_PIPELINE_ERROR_BUSY    (2)
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Period buffer, always handed around by reference */
+struct _audio_buffer {
+	uint8_t* data;      /**< cache-aligned storage */
+	uint32_t size;      /**< valid bytes */
+	uint32_t sequence;  /**< source period counter when filled */
+	uint8_t bits;       /**< sample resolution: 16, 24 or 32 */
+	uint8_t index;      /**< position in the pool */
+};
+
+struct _audio_pipeline;
+struct _audio_stage;
+
+typedef void (*audio_stage_callback_t)(struct _audio_stage* stage,
+		struct _audio_buffer* buf, void* arg);
+
+enum _audio_stage_type {
+	AUDIO_STAGE_VOLUME,
+	AUDIO_STAGE_MIX,
+	AUDIO_STAGE_CONVERT,
+	AUDIO_STAGE_CUSTOM,
+};
+
+/** In-place processing stage */
+struct _audio_stage {
+	enum _audio_stage_type type;
+	union {
+		struct {
+			volatile uint16_t gain;   /* Q15 */
+		} volume;
+		struct {
+			struct _audio_pipeline* from;
+			volatile uint16_t gain;   /* Q15, applied to 'from' */
+		} mix;
+		struct {
+			uint8_t bits;             /* 24 or 32 */
+		} convert;
+		struct {
+			audio_stage_callback_t cb;
+			void* arg;
+		} custom;
+	} cfg;
+	bool bypass;
+	struct _audio_stage* next;
+};
+
+struct _audio_pipeline_stats {
+	uint32_t periods;     /**< periods delivered to the sink */
+	uint32_t overruns;    /**< source periods lost for lack of a free buffer */
+	uint32_t underruns;   /**< sink starvations */
+	uint32_t latency;     /**< periods captured between the end of capture and
+	                           the start of playback of the last period */
+	uint32_t latency_min;
+	uint32_t latency_max;
+};
+
+/** Single-producer single-consumer queue of buffer indices */
+struct _audio_queue {
+	uint8_t idx[AUDIO_PIPELINE_MAX_BUFFERS + 1];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+};
+
+struct _audio_pipeline {
+	/* configuration */
+	struct _audio_desc* source;  /**< record device, NULL if pushed by the application */
+	struct _audio_desc* sink;    /**< play device, NULL if pulled by the application */
+	uint8_t* pool;               /**< count * buffer_size bytes, cache-aligned */
+	uint32_t buffer_size;        /**< buffer capacity, multiple of L1_CACHE_BYTES */
+	uint32_t period_size;        /**< bytes captured per period by the source */
+	uint8_t count;               /**< number of buffers, up to AUDIO_PIPELINE_MAX_BUFFERS */
+	uint8_t bits;                /**< sample resolution produced by the source */
+	uint8_t prefill;             /**< periods queued before the sink starts */
+	struct _audio_stage* stages;
+
+	/* runtime */
+	struct _audio_buffer buffers[AUDIO_PIPELINE_MAX_BUFFERS];
+	struct _audio_queue free;
+	struct _audio_queue filled;
+	struct _audio_queue ready;
+	struct _audio_buffer* capture;
+	struct _audio_buffer* playback;
+	volatile uint32_t sequence;
+	volatile bool sink_active;
+	bool running;
+	struct _audio_pipeline_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a pipeline and its buffer pool
+ * \param pipe  Pipeline with its configuration fields filled in
+ * \return AUDIO_PIPELINE_SUCCESS or AUDIO_PIPELINE_INVALID_PARAM if the
+ * configuration or the stage chain is invalid
+ */
+extern int audio_pipeline_initialize(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Append a stage to the pipeline processing chain.
+ * The stage must accept the sample format produced by the stages before it:
+ * a mix stage needs the same resolution as its 'from' pipeline and a convert
+ * stage needs 16-bit input and buffers twice the period size. The chain is
+ * checked again by audio_pipeline_initialize().
+ * \param pipe   Pipeline, with its configuration fields filled in
+ * \param stage  Initialized stage
+ * \return AUDIO_PIPELINE_SUCCESS, AUDIO_PIPELINE_INVALID_PARAM if the stage
+ * does not fit the chain or AUDIO_PIPELINE_ERROR_BUSY if the pipeline runs
+ */
+extern int audio_pipeline_add_stage(struct _audio_pipeline* pipe,
+		struct _audio_stage* stage);
+
+/**
+ * \brief Start the pipeline (and the source DMA if any)
+ * \param pipe  Pipeline
+ * \return AUDIO_PIPELINE_SUCCESS or AUDIO_PIPELINE_ERROR_BUSY
+ */
+extern int audio_pipeline_start(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Stop the pipeline DMA transfers and return all buffers to the pool
+ * \param pipe  Pipeline
+ */
+extern void audio_pipeline_stop(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Run the stages on captured periods and feed the sink.
+ * Must be called from the main loop at least once per period.
+ * \param pipe  Pipeline
+ * \return number of periods processed
+ */
+extern uint32_t audio_pipeline_process(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Get an empty buffer to fill (application source)
+ * \param pipe  Pipeline
+ * \return buffer, or NULL on overrun
+ */
+extern struct _audio_buffer* audio_pipeline_get_free(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Queue a buffer filled by the application (application source).
+ * buf->size must be set to the number of valid bytes, at most the period
+ * size.
+ * \param pipe  Pipeline
+ * \param buf   Buffer obtained from audio_pipeline_get_free()
+ */
+extern void audio_pipeline_submit(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf);
+
+/**
+ * \brief Get the next processed buffer (application sink)
+ * \param pipe  Pipeline
+ * \return buffer, or NULL if none is ready or the pipeline is refilling
+ */
+extern struct _audio_buffer* audio_pipeline_get_ready(struct _audio_pipeline* pipe);
+
+/**
+ * \brief Return a consumed buffer to the pool (application sink)
+ * \param pipe  Pipeline
+ * \param buf   Buffer obtained from audio_pipeline_get_ready()
+ */
+extern void audio_pipeline_release(struct _audio_pipeline* pipe,
+		struct _audio_buffer* buf);
+
+/**
+ * \brief Get the pipeline statistics
+ * \param pipe   Pipeline
+ * \param stats  Copy of the statistics
+ * \param reset  Clear counters and latency bounds after reading
+ */
+extern void audio_pipeline_get_stats(struct _audio_pipeline* pipe,
+		struct _audio_pipeline_stats* stats, bool reset);
+
+/**
+ * \brief Convert a latency in periods to microseconds
+ * \param pipe        Pipeline
+ * \param periods     Latency in periods
+ * \param frame_size  Bytes per frame at the source (channels * sample size)
+ * \param sample_rate Sample rate in Hz
+ */
+extern uint32_t audio_pipeline_periods_to_us(struct _audio_pipeline* pipe,
+		uint32_t periods, uint32_t frame_size, uint32_t sample_rate);
+
+/**
+ * \brief Initialize a fixed-point volume stage
+ * \param stage  Stage
+ * \param gain   Q15 gain, AUDIO_GAIN_UNITY for 0dB (up to +6dB)
+ */
+extern void audio_stage_init_volume(struct _audio_stage* stage, uint16_t gain);
+
+/**
+ * \brief Initialize a mix stage adding the periods of another pipeline.
+ * The other pipeline must have an application sink; it is consumed by
+ * this stage instead and must still be run with audio_pipeline_process().
+ * \param stage  Stage
+ * \param from   Pipeline to mix in
+ * \param gain   Q15 gain applied to the mixed-in stream
+ */
+extern void audio_stage_init_mix(struct _audio_stage* stage,
+		struct _audio_pipeline* from, uint16_t gain);
+
+/**
+ * \brief Initialize a 16-bit to 24/32-bit conversion stage.
+ * 24-bit samples are right-aligned and 32-bit samples left-aligned in 32-bit
+ * words. Buffers must be twice the source period size. A convert stage
+ * always runs, its bypass flag is ignored.
+ * \param stage  Stage
+ * \param bits   Output resolution, 24 or 32
+ */
+extern void audio_stage_init_convert(struct _audio_stage* stage, uint8_t bits);
+
+/**
+ * \brief Initialize an application-defined in-place stage
+ * \param stage  Stage
+ * \param cb     Processing callback
+ * \param arg    Callback argument
+ */
+extern void audio_stage_init_custom(struct _audio_stage* stage,
+		audio_stage_callback_t cb, void* arg);
+
+#endif /* AUDIO_PIPELINE_H */
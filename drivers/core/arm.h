@@ -64,6 +64,37 @@ static inline void irq_disable(void)
 #endif
 }
 
+/**
+ * \brief Disable IRQs and return the previous IRQ mask state, for critical
+ * sections that may also be entered from interrupt context.
+ */
+static inline uint32_t irq_save(void)
+{
+	uint32_t cpsr;
+#if defined(__ICCARM__) || defined(__GNUC__)
+	asm volatile ("mrs %0, cpsr" : "=r"(cpsr));
+	irq_disable();
+	asm volatile ("" ::: "memory");
+#else
+#error Unsupported compiler!
+#endif
+	return cpsr & CPSR_MASK_IRQ;
+}
+
+/**
+ * \brief Restore the IRQ mask state returned by irq_save()
+ */
+static inline void irq_restore(uint32_t state)
+{
+#if defined(__ICCARM__) || defined(__GNUC__)
+	asm volatile ("" ::: "memory");
+#else
+#error Unsupported compiler!
+#endif
+	if (!state)
+		irq_enable();
+}
+
 #if defined(CONFIG_CORE_ARM926)
 
 static inline void irq_wait(void)
@@ -94,6 +94,24 @@ void cp15_write_ttb(uint32_t value)
 	asm("mcr p15, 0, %0, c2, c0, 0" :: "r"(value));
 }
 
+void cp15_tlb_invalidate(void)
+{
+	/* TLBIALL */
+	asm("mcr p15, 0, %0, c8, c7, 0" :: "r"(0));
+}
+
+void cp15_tlb_invalidate_mva(uint32_t mva)
+{
+	/* TLBIMVA */
+	asm("mcr p15, 0, %0, c8, c7, 1" :: "r"(mva));
+}
+
+void cp15_bp_invalidate(void)
+{
+	/* BPIALL */
+	asm("mcr p15, 0, %0, c7, c5, 6" :: "r"(0));
+}
+
 void cp15_cache_set_exclusive(void)
 {
 	uint32_t actlr;
@@ -218,7 +236,7 @@ void cp15_dcache_invalidate_region(uint32_t start, uint32_t end)
 
 	assert(start < end);
 
-	for (mva = start & ~L1_CACHE_BYTES; mva < end; mva += L1_CACHE_BYTES) {
+	for (mva = start & ~(L1_CACHE_BYTES - 1); mva < end; mva += L1_CACHE_BYTES) {
 		/* DCIMVAC */
 		asm("mcr p15, 0, %0, c7, c6, 1" :: "r"(mva));
 	}
@@ -232,7 +250,7 @@ void cp15_dcache_clean_region(uint32_t start, uint32_t end)
 
 	assert(start < end);
 
-	for (mva = start & ~L1_CACHE_BYTES; mva < end; mva += L1_CACHE_BYTES) {
+	for (mva = start & ~(L1_CACHE_BYTES - 1); mva < end; mva += L1_CACHE_BYTES) {
 		/* DCCMVAC */
 		asm("mcr p15, 0, %0, c7, c10, 1" :: "r"(mva));
 	}
@@ -246,7 +264,7 @@ void cp15_dcache_clean_invalidate_region(uint32_t start, uint32_t end)
 
 	assert(start < end);
 
-	for (mva = start & ~L1_CACHE_BYTES; mva < end; mva += L1_CACHE_BYTES) {
+	for (mva = start & ~(L1_CACHE_BYTES - 1); mva < end; mva += L1_CACHE_BYTES) {
 		/* DCCIMVAC */
 		asm("mcr p15, 0, %0, c7, c14, 1" :: "r"(mva));
 	}
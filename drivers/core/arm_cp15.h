@@ -152,6 +152,22 @@ extern void cp15_write_domain_access_control(uint32_t value);
  */
 extern void cp15_write_ttb(uint32_t value);
 
+/**
+ * \brief Invalidate the whole unified TLB.
+ */
+extern void cp15_tlb_invalidate(void);
+
+/**
+ * \brief Invalidate the unified TLB entries of a virtual address.
+ * \param mva virtual address
+ */
+extern void cp15_tlb_invalidate_mva(uint32_t mva);
+
+/**
+ * \brief Invalidate all branch predictors.
+ */
+extern void cp15_bp_invalidate(void);
+
 /**
  * \brief Indicate CPU that L2 is in exclusive caching mode.
  */
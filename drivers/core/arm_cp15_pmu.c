@@ -246,3 +246,78 @@ uint32_t cp15_get_cycle_counter(void)
 	asm("mrc     p15, 0, %0, c9, c13, 0":"=r"(value));
 	return value;
 }
+
+void cp15_pmu_enable(void)
+{
+	uint32_t value;
+	asm("mrc     p15, 0, %0, c9, c12, 0":"=r"(value));
+	value &= ~(1u << CP15_PMCR_DIVIDER);
+	value |= (CP15_ResetPerCycCounter << 1) | (1u << CP15_PMCR_ENABLE);
+	asm("mcr     p15, 0, %0, c9, c12, 0": :"r"(value));
+}
+
+void cp15_pmu_disable(void)
+{
+	uint32_t value;
+	asm("mrc     p15, 0, %0, c9, c12, 0":"=r"(value));
+	value &= ~(1u << CP15_PMCR_ENABLE);
+	asm("mcr     p15, 0, %0, c9, c12, 0": :"r"(value));
+}
+
+void cp15_pmu_start(uint32_t counters)
+{
+	asm("mcr     p15, 0, %0, c9, c12, 1": :"r"(counters));
+}
+
+void cp15_pmu_stop(uint32_t counters)
+{
+	asm("mcr     p15, 0, %0, c9, c12, 2": :"r"(counters));
+}
+
+void cp15_pmu_set_event(uint8_t counter, PerfEventType event)
+{
+	uint32_t value = counter;
+	assert(counter < CP15_PMU_EVENT_COUNTERS);
+	asm("mcr     p15, 0, %0, c9, c12, 5": :"r"(value));
+	value = event & 0xFF;
+	asm("mcr     p15, 0, %0, c9, c13, 1": :"r"(value));
+}
+
+uint32_t cp15_pmu_get_event_count(uint8_t counter)
+{
+	uint32_t value = counter;
+	assert(counter < CP15_PMU_EVENT_COUNTERS);
+	asm("mcr     p15, 0, %0, c9, c12, 5": :"r"(value));
+	asm volatile("mrc     p15, 0, %0, c9, c13, 2":"=r"(value));
+	return value;
+}
+
+void cp15_pmu_set_event_count(uint8_t counter, uint32_t value)
+{
+	uint32_t select = counter;
+	assert(counter < CP15_PMU_EVENT_COUNTERS);
+	asm("mcr     p15, 0, %0, c9, c12, 5": :"r"(select));
+	asm("mcr     p15, 0, %0, c9, c13, 2": :"r"(value));
+}
+
+uint32_t cp15_pmu_get_overflow(void)
+{
+	uint32_t value;
+	asm volatile("mrc     p15, 0, %0, c9, c12, 3":"=r"(value));
+	return value;
+}
+
+void cp15_pmu_clear_overflow(uint32_t counters)
+{
+	asm("mcr     p15, 0, %0, c9, c12, 3": :"r"(counters));
+}
+
+void cp15_pmu_enable_it(uint32_t counters)
+{
+	asm("mcr     p15, 0, %0, c9, c14, 1": :"r"(counters));
+}
+
+void cp15_pmu_disable_it(uint32_t counters)
+{
+	asm("mcr     p15, 0, %0, c9, c14, 2": :"r"(counters));
+}
@@ -53,37 +53,45 @@
 #define CP15_Counter1           2
 #define CP15_BothCounter        3
 
+/** Number of event counters (PMXEVCNTR) */
+#define CP15_PMU_EVENT_COUNTERS     2
+
+/** Counter masks for the cp15_pmu_* functions */
+#define CP15_PMU_EVENT_COUNTER(n)   (1u << (n))
+#define CP15_PMU_CYCLE_COUNTER      (1u << 31)
+
 typedef enum {
-	L1_IC_FILL,		// Level 1 instruction cache refill
-	L1_ITLB_FILL,		// Level 1 instruction TLB refill
-	L1_DC_FILL,		// Level 1 data cache refill
-	L1_DC_ACC,		// Level 1 data cache access
-	L1_DTLB_FILL,		// Level 1 data TLB refill
-	LOAD,			// Load
-	STORE,			// Store
-	InstArchExec,		// Instruction architecturally executed
-	ExcepetionTaken,	// Exception taken
-	ExcepetionRet,		// Exception return
-	WrCONTEXTIDR,		// Write to CONTEXTIDR
-	SoftPCChange,		// Software change of the PC
-	ImmBr,			// Immediate branch
-	ProcRet,		// Procedure return
-	UnalingedLdStr,		// Unaligned load or store
-	MispredictedBranchExec,	// Mispredicted or not predicted branch speculatively executed
-	PredictedBranchExec,	// Predictable branch speculatively executed
-	DataMemAcc,		// Data memory access.
-	ICAcc,			// Instruction Cache access.
-	DCEviction,		// Data cache eviction.
-	IRQException,		// IRQ exception taken.
-	FIQException,		// FIQ exception taken.
-	ExtMemReq,		// External memory request.
-	NCExtMemReq,		// Non-cacheable external memory request
-	PrefetchLineFill,	// Linefill because of prefetch.
-	PrefetchLineDrop,	// Prefetch linefill dropped.
-	EnteringRAmode,		// Entering read allocate mode.
-	RAmode,			// Read allocate mode.
-	reserved,		// Reserved, do not use
-	DWstallSBFfull		// Data Write operation that stalls the pipeline because the store buffer is full.
+	L1_IC_FILL = 0x01,		// Level 1 instruction cache refill
+	L1_ITLB_FILL = 0x02,		// Level 1 instruction TLB refill
+	L1_DC_FILL = 0x03,		// Level 1 data cache refill
+	L1_DC_ACC = 0x04,		// Level 1 data cache access
+	L1_DTLB_FILL = 0x05,		// Level 1 data TLB refill
+	LOAD = 0x06,			// Load
+	STORE = 0x07,			// Store
+	InstArchExec = 0x08,		// Instruction architecturally executed
+	ExcepetionTaken = 0x09,		// Exception taken
+	ExcepetionRet = 0x0A,		// Exception return
+	WrCONTEXTIDR = 0x0B,		// Write to CONTEXTIDR
+	SoftPCChange = 0x0C,		// Software change of the PC
+	ImmBr = 0x0D,			// Immediate branch
+	ProcRet = 0x0E,			// Procedure return
+	UnalingedLdStr = 0x0F,		// Unaligned load or store
+	MispredictedBranchExec = 0x10,	// Mispredicted or not predicted branch speculatively executed
+	CycleCount = 0x11,		// Cycle count
+	PredictedBranchExec = 0x12,	// Predictable branch speculatively executed
+	DataMemAcc = 0x13,		// Data memory access.
+	ICAcc = 0x14,			// Instruction Cache access.
+	DCEviction = 0x15,		// Data cache eviction.
+	IRQException = 0x86,		// IRQ exception taken.
+	FIQException = 0x87,		// FIQ exception taken.
+	ExtMemReq = 0xC0,		// External memory request.
+	NCExtMemReq = 0xC1,		// Non-cacheable external memory request
+	PrefetchLineFill = 0xC2,	// Linefill because of prefetch.
+	PrefetchLineDrop = 0xC3,	// Prefetch linefill dropped.
+	EnteringRAmode = 0xC4,		// Entering read allocate mode.
+	RAmode = 0xC5,			// Read allocate mode.
+	reserved = 0xC6,		// Reserved, do not use
+	DWstallSBFfull = 0xC9		// Data Write operation that stalls the pipeline because the store buffer is full.
 } PerfEventType;
 
 /*----------------------------------------------------------------------------
@@ -103,4 +111,70 @@ extern void cp15_enable_interrupt(uint8_t Enable, uint8_t Counter);
 extern void cp15_disable_interrupt(uint8_t Disable, uint8_t Counter);
 extern void cp15_init_perf_counter(PerfEventType Event, uint8_t Counter);
 
+/**
+ * \brief Enable the PMU, the cycle counter counting every cycle, and reset
+ * all counters. Counters still have to be started with cp15_pmu_start().
+ */
+extern void cp15_pmu_enable(void);
+
+/**
+ * \brief Disable the PMU, all counters stop.
+ */
+extern void cp15_pmu_disable(void);
+
+/**
+ * \brief Start counters.
+ * \param counters  Mask of CP15_PMU_EVENT_COUNTER(n) / CP15_PMU_CYCLE_COUNTER
+ */
+extern void cp15_pmu_start(uint32_t counters);
+
+/**
+ * \brief Stop counters.
+ * \param counters  Mask of CP15_PMU_EVENT_COUNTER(n) / CP15_PMU_CYCLE_COUNTER
+ */
+extern void cp15_pmu_stop(uint32_t counters);
+
+/**
+ * \brief Select the event counted by an event counter.
+ * \param counter  Event counter index (0 or 1)
+ * \param event  Event to count
+ */
+extern void cp15_pmu_set_event(uint8_t counter, PerfEventType event);
+
+/**
+ * \brief Read an event counter.
+ * \param counter  Event counter index (0 or 1)
+ */
+extern uint32_t cp15_pmu_get_event_count(uint8_t counter);
+
+/**
+ * \brief Write an event counter, e.g. to make it overflow after a period.
+ * \param counter  Event counter index (0 or 1)
+ * \param value  New counter value
+ */
+extern void cp15_pmu_set_event_count(uint8_t counter, uint32_t value);
+
+/**
+ * \brief Read the overflow flags (mask of counters).
+ */
+extern uint32_t cp15_pmu_get_overflow(void);
+
+/**
+ * \brief Clear overflow flags.
+ * \param counters  Mask of counters
+ */
+extern void cp15_pmu_clear_overflow(uint32_t counters);
+
+/**
+ * \brief Enable the overflow interrupt of counters.
+ * \param counters  Mask of counters
+ */
+extern void cp15_pmu_enable_it(uint32_t counters);
+
+/**
+ * \brief Disable the overflow interrupt of counters.
+ * \param counters  Mask of counters
+ */
+extern void cp15_pmu_disable_it(uint32_t counters);
+
 #endif /* ARM_CP15_PMU_H */
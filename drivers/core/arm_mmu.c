@@ -64,12 +64,104 @@
 #include "arm.h"
 #include "arm_mmu.h"
 
+#ifdef CONFIG_HAVE_L2CC
+#include "peripherals/l2cc.h"
+#endif
+
+#include <assert.h>
+
+/*------------------------------------------------------------------------------ */
+/*         Local definitions                                                     */
+/*------------------------------------------------------------------------------ */
+
+/* Descriptor bits that select the cache policy of a section */
+#if defined(CONFIG_CORE_CORTEXA5)
+#define TTB_SECT_CACHE_POLICY_MASK (TTB_SECT_TEX(7) | TTB_SECT_CACHEABLE | TTB_SECT_WRITE_BACK)
+#else
+#define TTB_SECT_CACHE_POLICY_MASK (TTB_SECT_CACHEABLE | TTB_SECT_WRITE_BACK)
+#endif
+
+/* Supersection flag of a section descriptor */
+#define TTB_SECT_SUPERSECTION      (1 << 18)
+
+/* Cache policies encoded in the C/B bits or in the TEX[1:0] bits */
+#define POLICY_NON_CACHEABLE       0
+#define POLICY_WB_WA               1
+#define POLICY_WT                  2
+#define POLICY_WB                  3
+
+/*------------------------------------------------------------------------------ */
+/*         Local variables                                                       */
+/*------------------------------------------------------------------------------ */
+
+/** Translation table given to mmu_configure */
+static uint32_t *_tlb;
+
+/*------------------------------------------------------------------------------ */
+/*         Local functions                                                       */
+/*------------------------------------------------------------------------------ */
+
+static bool _is_section(uint32_t desc)
+{
+	return (desc & 3) == TTB_TYPE_SECT && !(desc & TTB_SECT_SUPERSECTION);
+}
+
+/**
+ * \brief Decode the cache policies of a section descriptor
+ * \return false if the descriptor does not map normal memory with a known
+ * cache policy, in which case the caller must assume the worst
+ */
+static bool _get_cache_policy(uint32_t desc, uint8_t *inner, uint8_t *outer)
+{
+	uint8_t cb = (desc >> 2) & 3;
+
+	if (!_is_section(desc))
+		return false;
+
+#if defined(CONFIG_CORE_CORTEXA5)
+	uint8_t tex = (desc >> 12) & 7;
+
+	if (tex & 4) {
+		*inner = cb;
+		*outer = tex & 3;
+		return true;
+	}
+
+	switch ((tex << 2) | cb) {
+	case 0x0: /* strongly ordered */
+	case 0x1: /* shareable device */
+	case 0x4: /* normal, non cacheable */
+	case 0x8: /* non-shareable device */
+		*inner = *outer = POLICY_NON_CACHEABLE;
+		return true;
+	case 0x2: /* write-through, no write-allocate */
+		*inner = *outer = POLICY_WT;
+		return true;
+	case 0x3: /* write-back, no write-allocate */
+		*inner = *outer = POLICY_WB;
+		return true;
+	case 0x7: /* write-back, write-allocate */
+		*inner = *outer = POLICY_WB_WA;
+		return true;
+	default:
+		return false;
+	}
+#else
+	if (!(cb & 2))
+		*inner = *outer = POLICY_NON_CACHEABLE;
+	else
+		*inner = *outer = cb;
+	return true;
+#endif
+}
+
 /*------------------------------------------------------------------------------ */
 /*         Exported functions                                                    */
 /*------------------------------------------------------------------------------ */
 
 void mmu_configure(uint32_t *tlb)
 {
+	_tlb = tlb;
 	cp15_write_ttb((unsigned int)tlb);
 	/* Program the domain access register */
 	/* only domain 15: access are not checked */
@@ -77,3 +169,112 @@ void mmu_configure(uint32_t *tlb)
 	dsb();
 	isb();
 }
+
+uint32_t mmu_get_region_attributes(uint32_t addr)
+{
+	uint32_t desc;
+
+	if (!_tlb)
+		return 0;
+
+	desc = _tlb[addr >> 20];
+	if (!_is_section(desc))
+		return 0;
+
+	return desc & TTB_SECT_ATTRIBUTES_MASK;
+}
+
+bool mmu_set_region_attributes(uint32_t start, uint32_t length, uint32_t attributes)
+{
+	uint32_t first, last, i, state;
+	bool flush = false;
+
+	assert((attributes & ~TTB_SECT_ATTRIBUTES_MASK) == 0);
+
+	if (!_tlb || length == 0)
+		return false;
+
+	first = start >> 20;
+	last = (start + length - 1) >> 20;
+	for (i = first; i <= last; i++)
+		if (!_is_section(_tlb[i]))
+			return false;
+
+	state = irq_save();
+
+	for (i = first; i <= last; i++) {
+		if ((_tlb[i] ^ attributes) & TTB_SECT_CACHE_POLICY_MASK)
+			flush = true;
+		_tlb[i] = (_tlb[i] & ~TTB_SECT_ATTRIBUTES_MASK) | attributes;
+	}
+
+	/* Translation table walks are not cached, write the descriptors
+	 * back to memory before invalidating the TLB */
+	cp15_dcache_clean_region((uint32_t)&_tlb[first], (uint32_t)&_tlb[last + 1]);
+#ifdef CONFIG_HAVE_L2CC
+	if (l2cc_is_enabled()) {
+		l2cc_clean_region((uint32_t)&_tlb[first], (uint32_t)&_tlb[last + 1] - 1);
+		l2cc_cache_sync();
+	}
+#endif
+	dsb();
+
+	for (i = first; i <= last; i++)
+		cp15_tlb_invalidate_mva(i << 20);
+	cp15_bp_invalidate();
+	dsb();
+	isb();
+
+	/* Sections are at least 1MB, larger than the caches: cleaning and
+	 * invalidating by set/way is cheaper than walking the region.  This
+	 * writes back the lines allocated with the previous policy and
+	 * discards them so that they cannot hit with the new one. */
+	if (flush) {
+		cp15_dcache_clean_invalidate();
+#ifdef CONFIG_HAVE_L2CC
+		l2cc_clean_invalidate();
+		cp15_dcache_invalidate();
+#endif
+	}
+
+	irq_restore(state);
+
+	return true;
+}
+
+bool mmu_is_region_cacheable(uint32_t start, uint32_t length)
+{
+	uint32_t i;
+	uint8_t inner, outer;
+
+	if (!_tlb || !length || !cp15_mmu_is_enabled())
+		return true;
+
+	for (i = start >> 20; i <= (start + length - 1) >> 20; i++) {
+		if (!_get_cache_policy(_tlb[i], &inner, &outer))
+			return true;
+		if (inner != POLICY_NON_CACHEABLE || outer != POLICY_NON_CACHEABLE)
+			return true;
+	}
+
+	return false;
+}
+
+bool mmu_is_region_write_back(uint32_t start, uint32_t length)
+{
+	uint32_t i;
+	uint8_t inner, outer;
+
+	if (!_tlb || !length || !cp15_mmu_is_enabled())
+		return true;
+
+	for (i = start >> 20; i <= (start + length - 1) >> 20; i++) {
+		if (!_get_cache_policy(_tlb[i], &inner, &outer))
+			return true;
+		if (inner == POLICY_WB || inner == POLICY_WB_WA ||
+		    outer == POLICY_WB || outer == POLICY_WB_WA)
+			return true;
+	}
+
+	return false;
+}
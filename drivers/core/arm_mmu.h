@@ -30,6 +30,13 @@
 #ifndef ARM_MMU_H_
 #define ARM_MMU_H_
 
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
 /*----------------------------------------------------------------------------
  *        Exported definitions
  *----------------------------------------------------------------------------*/
@@ -76,11 +83,36 @@
 #define TTB_SECT_AP_PRIV_READ_ONLY ((1 << 15) | (1 << 10))
 #define TTB_SECT_AP_READ_ONLY      ((1 << 15) | (2 << 10))
 
+/* TTB Section Descriptor: Type Extension (TEX) */
+#define TTB_SECT_TEX(x)            (((x) & 7) << 12)
+
+/* TTB Section Descriptor: Shareable (S) */
+#define TTB_SECT_NON_SHAREABLE     (0 << 16)
+#define TTB_SECT_SHAREABLE         (1 << 16)
+
+/* TTB Section Descriptor: Normal memory with TEX=001 */
+#define TTB_SECT_NORMAL_NON_CACHEABLE (TTB_SECT_TEX(1) | TTB_SECT_NON_CACHEABLE | TTB_SECT_WRITE_THROUGH)
+#define TTB_SECT_CACHEABLE_WB_WA   (TTB_SECT_TEX(1) | TTB_SECT_CACHEABLE | TTB_SECT_WRITE_BACK)
+
+/* TTB Section Descriptor: bits that can be changed with mmu_set_region_attributes */
+#define TTB_SECT_ATTRIBUTES_MASK   (TTB_SECT_TEX(7) | TTB_SECT_CACHEABLE | TTB_SECT_WRITE_BACK | \
+                                    TTB_SECT_SHAREABLE | TTB_SECT_EXEC_NEVER)
+
 #endif /* defined(CONFIG_CORE_CORTEXA5) */
 
+#if defined(CONFIG_CORE_ARM926)
+
+/* TTB Section Descriptor: bits that can be changed with mmu_set_region_attributes */
+#define TTB_SECT_ATTRIBUTES_MASK   (TTB_SECT_CACHEABLE | TTB_SECT_WRITE_BACK)
+
+#endif /* defined(CONFIG_CORE_ARM926) */
+
 /* TTB Section Descriptor: Section Base Address */
 #define TTB_SECT_ADDR(x)           ((x) & 0xFFF00000)
 
+/* Size of the memory mapped by a section descriptor */
+#define TTB_SECT_SIZE              (1u << 20)
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -90,4 +122,49 @@
  */
 extern void mmu_configure(uint32_t *tlb);
 
+/**
+ * \brief Get the attributes of the section containing an address
+ *
+ * \param addr address to look up
+ * \return the descriptor bits covered by TTB_SECT_ATTRIBUTES_MASK, or 0 if the
+ * MMU has not been configured or the address is not mapped by a section
+ */
+extern uint32_t mmu_get_region_attributes(uint32_t addr);
+
+/**
+ * \brief Change the attributes of all the sections covering a memory region
+ *
+ * Only the bits covered by TTB_SECT_ATTRIBUTES_MASK are updated, the address,
+ * domain and access permissions of the sections are left untouched.  The
+ * caches are cleaned and invalidated when the cache policy changes, then the
+ * TLB and branch predictor are invalidated.
+ *
+ * \param start Beginning of the memory region
+ * \param length Length of the memory region
+ * \param attributes new attributes (i.e. TTB_SECT_CACHEABLE_WT | TTB_SECT_EXEC_NEVER)
+ * \return true on success, false if the MMU has not been configured or if the
+ * region is not entirely mapped by section descriptors
+ */
+extern bool mmu_set_region_attributes(uint32_t start, uint32_t length, uint32_t attributes);
+
+/**
+ * \brief Check whether a memory region may have lines in a data cache
+ *
+ * \param start Beginning of the memory region
+ * \param length Length of the memory region
+ * \return false only if every section covering the region is known to be
+ * non-cacheable
+ */
+extern bool mmu_is_region_cacheable(uint32_t start, uint32_t length);
+
+/**
+ * \brief Check whether a memory region may have dirty lines in a data cache
+ *
+ * \param start Beginning of the memory region
+ * \param length Length of the memory region
+ * \return false only if every section covering the region is known to be
+ * non-cacheable or write-through (inner and outer)
+ */
+extern bool mmu_is_region_write_back(uint32_t start, uint32_t length);
+
 #endif  /* ARM_MMU_H_ */
@@ -0,0 +1,270 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * IRQ dispatching, deferred work and interrupt latency probe.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "core/irq.h"
+#include "peripherals/aic.h"
+#include "peripherals/tc.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Interrupt nesting level, only changed with IRQs masked */
+static volatile uint32_t _nesting;
+
+/** Deferred work queue, protected by masking IRQs */
+static struct _softirq* _softirq_head;
+static struct _softirq* _softirq_tail;
+static volatile bool _softirq_running;
+
+static irq_exit_hook_t _exit_hook;
+
+static struct {
+	uint32_t count;
+	uint32_t max_nesting;
+	uint32_t softirqs;
+	uint32_t probe_samples;
+	uint32_t latency_min;
+	uint32_t latency_max;
+	uint64_t latency_sum;
+} _stats;
+
+static struct {
+	Tc* tc;
+	uint32_t channel;
+	uint32_t freq;
+} _probe;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Run the deferred work queue. Called and returns with IRQs masked,
+ * each work item runs with IRQs enabled.
+ */
+static void _softirq_run(void)
+{
+	struct _softirq* work;
+
+	_softirq_running = true;
+	while ((work = _softirq_head) != NULL) {
+		_softirq_head = work->next;
+		if (!_softirq_head)
+			_softirq_tail = NULL;
+		/* raising again from the handler queues it again */
+		work->pending = false;
+
+		irq_enable();
+		work->handler(work->arg);
+		irq_disable();
+
+		_stats.softirqs++;
+	}
+	_softirq_running = false;
+}
+
+static void _irq_latency_probe_handler(void)
+{
+	/* the channel restarts from 0 on RC compare, so the counter value is
+	 * the time elapsed since the interrupt was raised */
+	uint32_t latency = tc_get_cv(_probe.tc, _probe.channel);
+
+	tc_get_status(_probe.tc, _probe.channel);
+
+	if (!_stats.probe_samples || latency < _stats.latency_min)
+		_stats.latency_min = latency;
+	if (latency > _stats.latency_max)
+		_stats.latency_max = latency;
+	_stats.latency_sum += latency;
+	_stats.probe_samples++;
+}
+
+static uint32_t _ticks_to_ns(uint64_t ticks)
+{
+	if (!_probe.freq)
+		return 0;
+	return (uint32_t)((ticks * 1000000000ull) / _probe.freq);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+irq_exit_t irq_dispatch(aic_handler_t handler)
+{
+	_nesting++;
+	_stats.count++;
+	if (_nesting > _stats.max_nesting)
+		_stats.max_nesting = _nesting;
+
+	/* The AIC now only asserts nIRQ for a higher priority source */
+	irq_enable();
+	handler();
+	irq_disable();
+
+	aic_end_interrupt(AIC);
+	_nesting--;
+
+	/* Back to thread context only from the outermost interrupt, and not
+	 * from one preempting the deferred work */
+	if (_nesting > 0 || _softirq_running)
+		return NULL;
+
+	if (_softirq_head)
+		_softirq_run();
+
+	return _exit_hook ? _exit_hook() : NULL;
+}
+
+void irq_set_exit_hook(irq_exit_hook_t hook)
+{
+	_exit_hook = hook;
+}
+
+uint32_t irq_get_nesting(void)
+{
+	return _nesting;
+}
+
+bool irq_in_interrupt(void)
+{
+	return _nesting > 0 || _softirq_running;
+}
+
+void softirq_init(struct _softirq* work, softirq_handler_t handler,
+		void* arg)
+{
+	work->handler = handler;
+	work->arg = arg;
+	work->next = NULL;
+	work->pending = false;
+}
+
+bool softirq_raise(struct _softirq* work)
+{
+	uint32_t state = irq_save();
+	bool queued = !work->pending;
+
+	if (queued) {
+		work->pending = true;
+		work->next = NULL;
+		if (_softirq_tail)
+			_softirq_tail->next = work;
+		else
+			_softirq_head = work;
+		_softirq_tail = work;
+	}
+	irq_restore(state);
+	return queued;
+}
+
+void softirq_process(void)
+{
+	uint32_t state = irq_save();
+
+	if (_nesting == 0 && _softirq_head && !_softirq_running)
+		_softirq_run();
+	irq_restore(state);
+}
+
+void irq_latency_probe_start(Tc* tc, uint32_t channel, uint32_t freq,
+		uint8_t priority)
+{
+	uint32_t id = get_tc_id_from_addr(tc);
+	uint32_t rc;
+
+	irq_latency_probe_stop();
+
+	_probe.tc = tc;
+	_probe.channel = channel;
+	/* fastest clock for the best resolution */
+	_probe.freq = tc_get_available_freq(tc, TC_CMR_TCCLKS_TIMER_CLOCK1);
+
+	tc_configure(tc, channel, TC_CMR_TCCLKS_TIMER_CLOCK1 |
+			TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC);
+	rc = _probe.freq / freq;
+	tc_set_ra_rb_rc(tc, channel, NULL, NULL, &rc);
+
+	aic_configure(id, AIC_SMR_SRCTYPE_INT_LEVEL_SENSITIVE |
+			AIC_SMR_PRIOR(priority));
+	aic_set_source_vector(id, _irq_latency_probe_handler);
+	tc_start(tc, channel);
+	tc_enable_it(tc, channel, TC_IER_CPCS);
+	aic_enable(id);
+}
+
+void irq_latency_probe_stop(void)
+{
+	if (!_probe.tc)
+		return;
+
+	tc_disable_it(_probe.tc, _probe.channel, TC_IDR_CPCS);
+	tc_stop(_probe.tc, _probe.channel);
+	aic_disable(get_tc_id_from_addr(_probe.tc));
+	_probe.tc = NULL;
+}
+
+void irq_get_stats(struct _irq_stats* stats)
+{
+	uint32_t state = irq_save();
+
+	stats->count = _stats.count;
+	stats->max_nesting = _stats.max_nesting;
+	stats->softirqs = _stats.softirqs;
+	stats->probe_samples = _stats.probe_samples;
+	stats->latency_min = _ticks_to_ns(_stats.latency_min);
+	stats->latency_max = _ticks_to_ns(_stats.latency_max);
+	stats->latency_avg = _stats.probe_samples ?
+		_ticks_to_ns(_stats.latency_sum / _stats.probe_samples) : 0;
+	irq_restore(state);
+}
+
+void irq_reset_stats(void)
+{
+	uint32_t state = irq_save();
+
+	memset(&_stats, 0, sizeof(_stats));
+	irq_restore(state);
+}
@@ -0,0 +1,194 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * IRQ dispatching with nesting, deferred work (softirq) and interrupt
+ * latency measurement.
+ *
+ * irqHandler in cstartup reads the vector from the AIC and calls
+ * irq_dispatch() in SVC mode. IRQs are unmasked around the handler, so a
+ * source with a higher AIC priority (see aic_configure()) preempts a
+ * running handler of lower priority. Sources of the same or a lower
+ * priority are held by the AIC until the end of the handler. A handler
+ * sharing data with a source that may be given a higher priority (the
+ * latency probe takes one) must therefore update it with IRQs masked
+ * (irq_save()/irq_restore()), as it would from thread context.
+ *
+ * Handlers can move their heavy processing to a softirq: work raised with
+ * softirq_raise() runs once the outermost interrupt has been acknowledged,
+ * with IRQs enabled, just before returning to the interrupted code. Any
+ * interrupt, whatever its priority, can preempt deferred work.
+ *
+ * The latency probe uses a TC channel whose RC compare fires periodically;
+ * the counter value read in its handler is the time taken to enter the
+ * handler, and records the worst case seen at the chosen priority.
+ */
+
+#ifndef IRQ_H
+#define IRQ_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "peripherals/aic.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+typedef void (*softirq_handler_t)(void* arg);
+
+/** Routine irqHandler branches to, instead of returning to the interrupted
+ * code, with the IRQ context still on the IRQ stack */
+typedef void (*irq_exit_t)(void);
+
+/** Called with IRQs masked when an interrupt returns to thread context */
+typedef irq_exit_t (*irq_exit_hook_t)(void);
+
+/** Deferred work item, usually embedded in a driver descriptor */
+struct _softirq {
+	softirq_handler_t handler;
+	void* arg;
+	struct _softirq* next;
+	volatile bool pending;
+};
+
+/** Interrupt statistics, latencies in nanoseconds */
+struct _irq_stats {
+	uint32_t count;          /**< interrupts dispatched */
+	uint32_t max_nesting;    /**< deepest interrupt nesting seen */
+	uint32_t softirqs;       /**< deferred work items run */
+	uint32_t probe_samples;  /**< latency probe interrupts */
+	uint32_t latency_min;
+	uint32_t latency_max;
+	uint32_t latency_avg;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Run an interrupt handler, called by irqHandler with IRQs masked
+ * after the AIC vector has been read. Acknowledges the interrupt to the AIC
+ * and runs the pending deferred work when leaving the outermost interrupt.
+ * \param handler  Handler read from AIC_IVR.
+ * \return Routine returned by the exit hook, or NULL to return to the
+ * interrupted code.
+ */
+extern irq_exit_t irq_dispatch(aic_handler_t handler);
+
+/**
+ * \brief Set the routine called when an interrupt returns to thread
+ * context, after the deferred work. Used by the scheduler to preempt the
+ * interrupted thread.
+ * \param hook  Exit hook, NULL for none.
+ */
+extern void irq_set_exit_hook(irq_exit_hook_t hook);
+
+/**
+ * \brief Return the current interrupt nesting level, 0 in thread context.
+ */
+extern uint32_t irq_get_nesting(void);
+
+/**
+ * \brief Tell whether the caller runs in a hard interrupt handler or in
+ * deferred work.
+ */
+extern bool irq_in_interrupt(void);
+
+/**
+ * \brief Initialize a deferred work item.
+ * \param work     Work item.
+ * \param handler  Function to run.
+ * \param arg      Argument given to the function.
+ */
+extern void softirq_init(struct _softirq* work, softirq_handler_t handler,
+		void* arg);
+
+/**
+ * \brief Queue a work item; it runs once, whatever the number of calls
+ * made before it starts. Safe from interrupt handlers and thread context.
+ * Work raised from thread context runs at the end of the next interrupt,
+ * or on the next call to softirq_process().
+ * \param work  Work item.
+ * \return true if queued, false if it was already pending.
+ */
+extern bool softirq_raise(struct _softirq* work);
+
+/**
+ * \brief Run the pending work items from thread context, e.g. in a main
+ * loop or before entering idle. Does nothing if called from an interrupt.
+ */
+extern void softirq_process(void);
+
+/**
+ * \brief Start the interrupt latency probe. Its interrupt vector is taken
+ * over and configured with the given AIC priority.
+ * \param tc        TC instance.
+ * \param channel   TC channel.
+ * \param freq      Probe interrupt frequency, in Hz.
+ * \param priority  AIC priority of the probe, 0 (lowest) to 7.
+ */
+extern void irq_latency_probe_start(Tc* tc, uint32_t channel, uint32_t freq,
+		uint8_t priority);
+
+/**
+ * \brief Stop the interrupt latency probe.
+ */
+extern void irq_latency_probe_stop(void);
+
+/**
+ * \brief Get the interrupt statistics.
+ * \param stats  Statistics to be filled.
+ */
+extern void irq_get_stats(struct _irq_stats* stats);
+
+/**
+ * \brief Clear the interrupt statistics.
+ */
+extern void irq_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQ_H */
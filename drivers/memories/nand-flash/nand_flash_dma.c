@@ -39,6 +39,8 @@
 #include "nand_flash_dma.h"
 #include "misc/cache.h"
 
+#include "sched.h"
+
 #include <assert.h>
 #include <stdlib.h>
 
@@ -53,6 +55,9 @@ static struct dma_channel *nand_dma_tx_channel;
 /** DMA transfer completion notifier */
 static volatile bool transfer_complete = false;
 
+/** Posted on transfer completion, for threads waiting on it */
+static struct _sched_sem transfer_sem;
+
 /*-------------------------------------------------------------------------
  *        Local functions
  *------------------------------------------------------------------------*/
@@ -63,6 +68,24 @@ static volatile bool transfer_complete = false;
 static void _nand_dma_callback(struct dma_channel *channel, void *arg)
 {
 	transfer_complete = true;
+	sched_sem_post(&transfer_sem);
+}
+
+/**
+ * \brief Wait for the end of the current transfer
+ */
+static void _nand_dma_wait(void)
+{
+	while (!transfer_complete) {
+		if (dma_is_polling()) {
+			/* no interrupt signals the completion: poll */
+			dma_poll();
+		} else {
+			/* returns at once when the scheduler is not running,
+			 * the loop then busy-waits for the callback */
+			sched_sem_wait(&transfer_sem, SCHED_WAIT_FOREVER);
+		}
+	}
 }
 
 /*--------------------------------------------------------------------------
@@ -118,13 +141,10 @@ uint8_t nand_dma_write(uint32_t src_address, uint32_t dest_address,
 
 	/* Start transfer */
 	transfer_complete = false;
+	sched_sem_init(&transfer_sem, 0);
 	dma_start_transfer(nand_dma_tx_channel);
 	/* Wait for completion */
-	while (!transfer_complete) {
-		/* always call dma_poll, it will do nothing if polling mode
-		 * is disabled */
-		dma_poll();
-	}
+	_nand_dma_wait();
 	return 0;
 }
 
@@ -153,13 +173,10 @@ uint8_t nand_dma_read(uint32_t src_address, uint32_t dest_address,
 
 	/* Start transfer */
 	transfer_complete = false;
+	sched_sem_init(&transfer_sem, 0);
 	dma_start_transfer(nand_dma_rx_channel);
 	/* Wait for completion */
-	while (!transfer_complete) {
-		/* always call dma_poll, it will do nothing if polling mode
-		 * is disabled */
-		dma_poll();
-	}
+	_nand_dma_wait();
 	cache_invalidate_region((uint32_t *)dest_address, size);
 	return 0;
 }
@@ -50,6 +50,10 @@ void cache_invalidate_region(void *start, uint32_t length)
 	uint32_t start_addr = (uint32_t)start;
 	uint32_t end_addr = start_addr + length;
 
+	/* nothing can be cached in non-cacheable sections */
+	if (!mmu_is_region_cacheable(start_addr, length))
+		return;
+
 	if (cp15_dcache_is_enabled()) {
 		cp15_dcache_invalidate_region(start_addr, end_addr);
 #ifdef CONFIG_HAVE_L2CC
@@ -64,6 +68,10 @@ void cache_clean_region(const void *start, uint32_t length)
 	uint32_t start_addr = (uint32_t)start;
 	uint32_t end_addr = start_addr + length;
 
+	/* non-cacheable and write-through sections never hold dirty lines */
+	if (!mmu_is_region_write_back(start_addr, length))
+		return;
+
 	if (cp15_dcache_is_enabled()) {
 		cp15_dcache_clean_region(start_addr, end_addr);
 #ifdef CONFIG_HAVE_L2CC
@@ -45,6 +45,10 @@
  * sections will contain only cache aligned variables, we can be certain that
  * flushing/invalidating any variable in these regions will not
  * flush/invalidate more than expected.
+ *
+ * Maintenance is skipped for regions whose MMU sections are non-cacheable
+ * (or write-through, for cleaning), so DMA buffers placed in such sections
+ * (see mmu_set_region_attributes) do not pay for cache_clean_region.
  */
 
 #ifndef CACHE_H_
@@ -0,0 +1,264 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Continuous ADC acquisition driver.
+ *
+ * The ADC converts a sequence of channels on each rising edge of a
+ * hardware trigger (TC TIOA or PWM event line). Tagged results read from
+ * ADC_LCDR are moved by the DMA into a ping-pong buffer through a
+ * circular linked list of two descriptors, so that the acquisition never
+ * stops. Each time a half of the buffer is full, its samples are sorted
+ * per channel using the tag, optionally averaged, and handed to the user
+ * callback while the DMA fills the other half.
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "trace.h"
+
+#include "peripherals/adc.h"
+#include "peripherals/adcd.h"
+#include "peripherals/pmc.h"
+#include "peripherals/tc.h"
+
+#include "misc/cache.h"
+
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+ *         Local functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Sort the samples of a half buffer per channel, average them and
+ * invoke the user callback.
+ * \param desc ADC driver descriptor
+ * \param raw tagged samples of the half buffer
+ */
+static void _adcd_process(struct _adcd_desc* desc, const uint16_t* raw)
+{
+	uint32_t sum[ADCD_MAX_CHANNELS];
+	uint16_t pos[ADCD_MAX_CHANNELS];
+	uint8_t acc[ADCD_MAX_CHANNELS];
+	uint32_t total = desc->sequences * desc->num_channels;
+	uint8_t decimation = desc->decimation > 1 ? desc->decimation : 1;
+	uint32_t count = desc->sequences / decimation;
+	uint32_t i;
+
+	memset(sum, 0, sizeof(sum));
+	memset(pos, 0, sizeof(pos));
+	memset(acc, 0, sizeof(acc));
+
+	for (i = 0; i < total; i++) {
+		uint32_t chnb = (raw[i] & ADC_LCDR_CHNB_Msk) >> ADC_LCDR_CHNB_Pos;
+		uint8_t idx = desc->index[chnb];
+
+		if (idx >= desc->num_channels || pos[idx] >= count) {
+			desc->stats.discarded++;
+			continue;
+		}
+
+		sum[idx] += raw[i] & ADC_LCDR_LDATA_Msk;
+		if (++acc[idx] == decimation) {
+			desc->output[idx * count + pos[idx]++] = sum[idx] / decimation;
+			sum[idx] = 0;
+			acc[idx] = 0;
+		}
+	}
+	desc->stats.samples += total;
+	desc->stats.blocks++;
+
+	if (desc->callback)
+		desc->callback(desc, desc->output, count, desc->cb_args);
+}
+
+/**
+ * \brief DMA callback, invoked at the end of each half buffer.
+ */
+static void _adcd_dma_callback(struct dma_channel* channel, void* arg)
+{
+	struct _adcd_desc* desc = (struct _adcd_desc*)arg;
+	uint32_t half_len = desc->sequences * desc->num_channels;
+	uint16_t* raw = &desc->buffer[desc->half * half_len];
+
+	if (!desc->running)
+		return;
+
+	desc->half ^= 1;
+	cache_invalidate_region(raw, half_len * sizeof(uint16_t));
+	_adcd_process(desc, raw);
+}
+
+/**
+ * \brief Configure the timer to output a rising edge on TIOA at the
+ * sequence rate.
+ * \param desc ADC driver descriptor
+ */
+static void _adcd_configure_timer(struct _adcd_desc* desc)
+{
+	uint32_t tcclks, ra, rc;
+
+	pmc_enable_peripheral(get_tc_id_from_addr(desc->tc));
+	tcclks = tc_find_best_clock_source(desc->tc, desc->rate);
+	tc_configure(desc->tc, desc->tc_channel, tcclks | TC_CMR_WAVE |
+			TC_CMR_ACPA_SET | TC_CMR_ACPC_CLEAR | TC_CMR_CPCTRG);
+	rc = tc_get_available_freq(desc->tc, tcclks) / desc->rate;
+	ra = rc / 2;
+	tc_set_ra_rb_rc(desc->tc, desc->tc_channel, &ra, NULL, &rc);
+}
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+uint32_t adcd_configure(struct _adcd_desc* desc)
+{
+	uint8_t decimation = desc->decimation > 1 ? desc->decimation : 1;
+	uint32_t i;
+
+	if (!desc->channels || desc->num_channels == 0 ||
+	    desc->num_channels > ADCD_MAX_CHANNELS)
+		return ADCD_INVALID_PARAM;
+	if (!desc->buffer || !desc->output || desc->sequences == 0 ||
+	    (desc->sequences % decimation) != 0 ||
+	    desc->sequences * desc->num_channels > DMA_MAX_BT_SIZE)
+		return ADCD_INVALID_PARAM;
+	if (desc->tc && desc->rate == 0)
+		return ADCD_INVALID_PARAM;
+	if (desc->running)
+		return ADCD_ERROR_BUSY;
+
+	/* Channel number to channel index lookup for tagged samples */
+	memset(desc->index, 0xff, sizeof(desc->index));
+	for (i = 0; i < desc->num_channels; i++) {
+		if (desc->channels[i] >= ADCD_MAX_CHANNELS)
+			return ADCD_INVALID_PARAM;
+		desc->index[desc->channels[i]] = i;
+	}
+
+	/* Convert the channels in the given order, tag the results */
+	adc_set_sequence_by_list((uint8_t*)desc->channels, desc->num_channels);
+	adc_set_sequence_mode(true);
+	for (i = 0; i < desc->num_channels; i++)
+		adc_enable_channel(desc->channels[i]);
+	adc_set_tag_enable(true);
+
+	/* No conversion until started */
+	adc_set_trigger_mode(ADC_TRGR_TRGMOD_NO_TRIGGER);
+	adc_set_trigger(desc->trigger);
+
+	if (desc->tc)
+		_adcd_configure_timer(desc);
+
+	memset(&desc->stats, 0, sizeof(desc->stats));
+
+	return ADCD_SUCCESS;
+}
+
+uint32_t adcd_start(struct _adcd_desc* desc)
+{
+	struct dma_xfer_item_tmpl tmpl;
+	uint32_t half_len = desc->sequences * desc->num_channels;
+	int i;
+
+	if (desc->running)
+		return ADCD_ERROR_BUSY;
+
+	desc->dma = dma_allocate_channel(ID_ADC, DMA_PERIPH_MEMORY);
+	if (!desc->dma) {
+		trace_error("adcd: can't allocate DMA channel\r\n");
+		return ADCD_ERROR_DMA;
+	}
+
+	/* Circular list: half 0 -> half 1 -> half 0... */
+	memset(&tmpl, 0, sizeof(tmpl));
+	tmpl.sa = (void*)&ADC->ADC_LCDR;
+	tmpl.upd_sa_per_data = 0;
+	tmpl.upd_da_per_data = 1;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 1;
+	tmpl.data_width = DMA_DATA_WIDTH_HALF_WORD;
+	tmpl.chunk_size = DMA_CHUNK_SIZE_1;
+	tmpl.blk_size = half_len;
+	for (i = 0; i < 2; i++) {
+		tmpl.da = &desc->buffer[i * half_len];
+		dma_prepare_item(desc->dma, &tmpl, &desc->items[i]);
+	}
+	dma_link_item(desc->dma, &desc->items[0], &desc->items[1]);
+	dma_link_item(desc->dma, &desc->items[1], &desc->items[0]);
+	cache_clean_region(desc->items, sizeof(desc->items));
+
+	tmpl.da = desc->buffer;
+	if (dma_configure_sg_transfer(desc->dma, &tmpl, desc->items) != DMA_OK ||
+	    dma_enable_item_callback(desc->dma) != DMA_OK) {
+		dma_free_channel(desc->dma);
+		desc->dma = NULL;
+		return ADCD_ERROR_DMA;
+	}
+	dma_set_callback(desc->dma, _adcd_dma_callback, desc);
+
+	desc->half = 0;
+	desc->running = true;
+	cache_invalidate_region(desc->buffer, 2 * half_len * sizeof(uint16_t));
+
+	/* Drop a stale result, then start DMA before the trigger */
+	(void)ADC->ADC_LCDR;
+	dma_start_transfer(desc->dma);
+	adc_set_trigger_mode(ADC_TRGR_TRGMOD_EXT_TRIG_RISE);
+	if (desc->tc)
+		tc_start(desc->tc, desc->tc_channel);
+
+	return ADCD_SUCCESS;
+}
+
+void adcd_stop(struct _adcd_desc* desc)
+{
+	if (!desc->running)
+		return;
+
+	if (desc->tc)
+		tc_stop(desc->tc, desc->tc_channel);
+	adc_set_trigger_mode(ADC_TRGR_TRGMOD_NO_TRIGGER);
+
+	desc->running = false;
+	dma_stop_transfer(desc->dma);
+	dma_free_channel(desc->dma);
+	desc->dma = NULL;
+}
+
+void adcd_get_stats(const struct _adcd_desc* desc, struct _adcd_stats* stats)
+{
+	memcpy(stats, &desc->stats, sizeof(*stats));
+}
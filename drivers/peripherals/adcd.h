@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _ADCD_H_
+#define _ADCD_H_
+
+#ifdef CONFIG_HAVE_ADC
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "peripherals/dma.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------------------------
+ *         Definitions
+ *------------------------------------------------------------------------------*/
+
+#define ADCD_SUCCESS         (0)
+#define ADCD_INVALID_PARAM   (1)
+#define ADCD_ERROR_DMA       (2)
+#define ADCD_ERROR_BUSY      (3)
+
+/** Number of channel numbers that can be tagged in ADC_LCDR */
+#define ADCD_MAX_CHANNELS    16
+
+/*------------------------------------------------------------------------------
+ *         Types
+ *------------------------------------------------------------------------------*/
+
+struct _adcd_desc;
+
+/**
+ * \brief Callback invoked from the DMA interrupt each time a half of the
+ * acquisition buffer is full.
+ * \param desc ADC driver descriptor
+ * \param data de-interleaved samples, channel after channel:
+ * data[i * count + j] is sample j of desc->channels[i]
+ * \param count number of samples per channel
+ * \param arg user argument
+ */
+typedef void (*adcd_callback_t)(struct _adcd_desc* desc,
+		const uint16_t* data, uint32_t count, void* arg);
+
+/** \brief Continuous ADC acquisition statistics */
+struct _adcd_stats {
+	uint32_t blocks;     /**< half buffers delivered */
+	uint32_t samples;    /**< samples de-interleaved */
+	uint32_t discarded;  /**< samples of unexpected channels */
+};
+
+/** \brief Continuous ADC acquisition descriptor */
+struct _adcd_desc {
+	/* Configuration, set by the user */
+	const uint8_t* channels;  /**< channel numbers, in conversion order */
+	uint8_t num_channels;     /**< number of channels */
+	uint8_t decimation;       /**< samples averaged per output (0/1: none) */
+	uint32_t rate;            /**< sequence rate in Hz, if tc is set */
+	Tc* tc;                   /**< timer triggering the ADC, NULL if the
+	                               trigger is configured by the user
+	                               (PWM event line, ADTRG...) */
+	uint8_t tc_channel;       /**< channel of the timer */
+	uint32_t trigger;         /**< ADC_MR_TRGSEL_xxx value of the trigger */
+	uint16_t* buffer;         /**< acquisition buffer (cache-aligned),
+	                               2 * sequences * num_channels samples */
+	uint32_t sequences;       /**< sequences per half buffer (multiple of
+	                               decimation) */
+	uint16_t* output;         /**< de-interleaved output,
+	                               num_channels * sequences / decimation */
+	adcd_callback_t callback; /**< half buffer callback */
+	void* cb_args;            /**< callback argument */
+
+	/* Run time state, managed by the driver */
+	struct dma_channel* dma;
+	struct dma_xfer_item items[2];
+	uint8_t index[ADCD_MAX_CHANNELS];
+	uint8_t half;
+	volatile bool running;
+	struct _adcd_stats stats;
+};
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Configure the ADC sequencer, tags and trigger (and the timer, if
+ * any) for the channels of the descriptor. The ADC must have been
+ * initialized (clock, timings) with adc_initialize() and adc_set_clock().
+ * \param desc ADC driver descriptor
+ * \return ADCD_SUCCESS or an error code
+ */
+extern uint32_t adcd_configure(struct _adcd_desc* desc);
+
+/**
+ * \brief Start the acquisition: allocate a DMA channel and arm the circular
+ * DMA over both halves of the buffer, then start the trigger timer. Conversions go on without
+ * software intervention until adcd_stop() is called.
+ * \param desc ADC driver descriptor
+ * \return ADCD_SUCCESS or an error code
+ */
+extern uint32_t adcd_start(struct _adcd_desc* desc);
+
+/**
+ * \brief Stop the acquisition and release the DMA channel.
+ * \param desc ADC driver descriptor
+ */
+extern void adcd_stop(struct _adcd_desc* desc);
+
+/**
+ * \brief Get the acquisition statistics.
+ * \param desc ADC driver descriptor
+ * \param stats destination statistics
+ */
+extern void adcd_get_stats(const struct _adcd_desc* desc,
+		struct _adcd_stats* stats);
+
+#endif /* CONFIG_HAVE_ADC */
+
+#endif /* _ADCD_H_ */
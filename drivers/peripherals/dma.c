@@ -435,6 +435,15 @@ uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 #endif
 }
 
+uint32_t dma_enable_item_callback(struct dma_channel *channel)
+{
+#if defined(CONFIG_HAVE_XDMAC)
+	return xdmad_enable_item_callback((struct _xdmad_channel *)channel);
+#elif defined(CONFIG_HAVE_DMAC)
+	return dmacd_enable_item_callback((struct _dmacd_channel *)channel);
+#endif
+}
+
 uint32_t dma_start_transfer(struct dma_channel *channel)
 {
 #if defined(CONFIG_HAVE_XDMAC)
@@ -471,4 +480,13 @@ void dma_poll(void)
 #endif
 }
 
+bool dma_is_polling(void)
+{
+#if defined(CONFIG_HAVE_XDMAC)
+	return xdmad_is_polling();
+#elif defined(CONFIG_HAVE_DMAC)
+	return dmacd_is_polling();
+#endif
+}
+
 /**@}*/
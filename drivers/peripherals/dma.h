@@ -200,6 +200,12 @@ extern void dma_initialize(bool polling);
  */
 extern void dma_poll(void);
 
+/**
+ * \brief Tell whether the driver was initialized in polling mode, in which
+ * case no interrupt signals the completion of the transfers.
+ */
+extern bool dma_is_polling(void);
+
 /**
  * \brief Allocate an DMA channel
  * \param src Source peripheral ID, DMA_PERIPH_MEMORY for memory.
@@ -271,6 +277,14 @@ extern uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 				struct dma_xfer_item_tmpl *tmpl,
 				struct dma_xfer_item *desc_list);
 
+/**
+ * \brief Invoke the callback at the end of each transfer descriptor
+ * instead of the end of the transfer. Allows circular linked lists, whose
+ * transfer never ends. Shall be called after dma_configure_sg_transfer.
+ * \param channel Channel pointer
+ */
+extern uint32_t dma_enable_item_callback(struct dma_channel *channel);
+
 /**
  * \brief Stop DMA transfer.
  * \param channel Channel pointer
@@ -90,6 +90,7 @@ struct _dmacd_channel
 	uint8_t          dest_txif;  /**< Destination TX Interface ID */
 	uint8_t          dest_rxif;  /**< Destination RX Interface ID */
 	volatile uint32_t rep_count; /**< repeat count in auto mode */
+	bool             item_cb;    /**< Callback at end of each LLI */
 	volatile uint8_t state;      /**< Channel State */
 };
 
@@ -141,7 +142,10 @@ static void dmacd_handler(void)
 			channel = _dmacd_channel(cont, chan);
 			if (channel->state == DMACD_STATE_FREE)
 				continue;
-			if (dmac_get_global_it_mask(dmac) & (DMAC_EBCIMR_CBTC0 << chan)) {
+			if (channel->item_cb && (gis & (DMAC_EBCISR_BTC0 << chan))) {
+				/* Channel still running, end of a linked list item */
+				exec = 1;
+			} else if (dmac_get_global_it_mask(dmac) & (DMAC_EBCIMR_CBTC0 << chan)) {
 				if (gis & (DMAC_EBCISR_CBTC0 << chan)) {
 					if (channel->rep_count) {
 						if (channel->rep_count == 1) {
@@ -188,6 +192,7 @@ void dmacd_initialize(bool polling)
 			channel->dest_txif = 0;
 			channel->dest_rxif = 0;
 			channel->rep_count = 0;
+			channel->item_cb = false;
 			channel->state = DMACD_STATE_FREE;
 		}
 
@@ -206,6 +211,11 @@ void dmacd_poll(void)
 		dmacd_handler();
 }
 
+bool dmacd_is_polling(void)
+{
+	return _dmacd.polling;
+}
+
 struct _dmacd_channel *dmacd_allocate_channel(uint8_t src, uint8_t dest)
 {
 	uint32_t i;
@@ -322,6 +332,7 @@ uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 	else if (channel->state == DMACD_STATE_STARTED)
 		return DMACD_BUSY;
 	Dmac *dmac = channel->dmac;
+	channel->item_cb = false;
 
 	sa = ((struct _dma_desc *)desc_addr)->sa;
 	da = ((struct _dma_desc *)desc_addr)->da;
@@ -373,6 +384,18 @@ uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 	return DMACD_OK;
 }
 
+uint32_t dmacd_enable_item_callback(struct _dmacd_channel *channel)
+{
+	if (channel->state == DMACD_STATE_FREE)
+		return DMACD_ERROR;
+	else if (channel->state == DMACD_STATE_STARTED)
+		return DMACD_BUSY;
+
+	channel->item_cb = true;
+
+	return DMACD_OK;
+}
+
 uint32_t dmacd_start_transfer(struct _dmacd_channel *channel)
 {
 	if (channel->state == DMACD_STATE_FREE)
@@ -126,6 +126,12 @@ extern void dmacd_initialize(bool polling);
  */
 extern void dmacd_poll(void);
 
+/**
+ * \brief Tell whether the driver was initialized in polling mode, in which
+ * case no interrupt signals the completion of the transfers.
+ */
+extern bool dmacd_is_polling(void);
+
 /**
  * \brief Allocate a DMA channel
  * \param src Source peripheral ID, DMACD_PERIPH_MEMORY for memory.
@@ -160,6 +166,13 @@ extern uint32_t dmacd_set_callback(struct _dmacd_channel *channel,
 extern uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 		struct _dmacd_cfg *cfg,  void *desc_addr);
 
+/**
+ * \brief Invoke the callback at the end of each linked list item, while
+ * the channel goes on (circular lists). Call after dmacd_configure_transfer.
+ * \param channel Channel pointer
+ */
+extern uint32_t dmacd_enable_item_callback(struct _dmacd_channel *channel);
+
 /**
  * \brief Start DMA transfer.
  * \param channel Channel pointer
@@ -35,6 +35,7 @@
 #include "trace.h"
 #include "ring.h"
 
+#include "core/irq.h"
 #include "peripherals/aic.h"
 #include "peripherals/gmacd.h"
 #include "misc/cache.h"
@@ -56,11 +57,20 @@
  *         Types
  *---------------------------------------------------------------------------*/
 
+/** Interrupt status read by the IRQ handler, processed as deferred work */
+struct _gmacd_work {
+	struct _softirq softirq;
+	struct _ethd*   gmacd;
+	uint8_t         queue;
+	uint32_t        isr;
+};
+
 struct _gmacd_irq_handler {
-	Gmac*           addr;
-	struct _ethd** gmacd;
-	uint32_t        irq;
-	aic_handler_t   handler;
+	Gmac*               addr;
+	struct _gmacd_work* work;
+	uint8_t             queue;
+	uint32_t            irq;
+	aic_handler_t       handler;
 };
 
 /*---------------------------------------------------------------------------
@@ -77,60 +87,60 @@ struct _gmacd_irq_handler {
 #endif
 #endif
 
-static struct _ethd* _gmacd0;
+static struct _gmacd_work _gmacd0_work[ETH_NUM_QUEUES];
 #ifdef GMAC1
-static struct _ethd* _gmacd1;
+static struct _gmacd_work _gmacd1_work[ETH_NUM_QUEUES];
 #endif
 
-static void _gmacd_handler(struct _ethd* gmacd, uint8_t queue);
+static void _gmacd_handler(struct _gmacd_work* work);
 
 static void _gmacd_gmac0_irq_handler(void)
 {
-	_gmacd_handler(_gmacd0, 0);
+	_gmacd_handler(&_gmacd0_work[0]);
 }
 
 #ifdef CONFIG_HAVE_GMAC_QUEUES
 static void _gmacd_gmac0q1_irq_handler(void)
 {
-	_gmacd_handler(_gmacd0, 1);
+	_gmacd_handler(&_gmacd0_work[1]);
 }
 
 static void _gmacd_gmac0q2_irq_handler(void)
 {
-	_gmacd_handler(_gmacd0, 2);
+	_gmacd_handler(&_gmacd0_work[2]);
 }
 #endif
 
 #ifdef GMAC1
 static void _gmacd_gmac1_irq_handler(void)
 {
-	_gmacd_handler(_gmacd1, 0);
+	_gmacd_handler(&_gmacd1_work[0]);
 }
 
 #ifdef CONFIG_HAVE_GMAC_QUEUES
 static void _gmacd_gmac1q1_irq_handler(void)
 {
-	_gmacd_handler(_gmacd1, 1);
+	_gmacd_handler(&_gmacd1_work[1]);
 }
 
 static void _gmacd_gmac1q2_irq_handler(void)
 {
-	_gmacd_handler(_gmacd1, 2);
+	_gmacd_handler(&_gmacd1_work[2]);
 }
 #endif
 #endif
 
 static const struct _gmacd_irq_handler _gmacd_irq_handlers[] = {
-	{ GMAC0, &_gmacd0, ID_GMAC0,    _gmacd_gmac0_irq_handler },
+	{ GMAC0, &_gmacd0_work[0], 0, ID_GMAC0,    _gmacd_gmac0_irq_handler },
 #ifdef CONFIG_HAVE_GMAC_QUEUES
-	{ GMAC0, &_gmacd0, ID_GMAC0_Q1, _gmacd_gmac0q1_irq_handler },
-	{ GMAC0, &_gmacd0, ID_GMAC0_Q2, _gmacd_gmac0q2_irq_handler },
+	{ GMAC0, &_gmacd0_work[1], 1, ID_GMAC0_Q1, _gmacd_gmac0q1_irq_handler },
+	{ GMAC0, &_gmacd0_work[2], 2, ID_GMAC0_Q2, _gmacd_gmac0q2_irq_handler },
 #endif
 #ifdef GMAC1
-	{ GMAC1, &_gmacd1, ID_GMAC1,    _gmacd_gmac1_irq_handler },
+	{ GMAC1, &_gmacd1_work[0], 0, ID_GMAC1,    _gmacd_gmac1_irq_handler },
 #ifdef CONFIG_HAVE_GMAC_QUEUES
-	{ GMAC1, &_gmacd1, ID_GMAC1_Q1, _gmacd_gmac1q1_irq_handler },
-	{ GMAC1, &_gmacd1, ID_GMAC1_Q2, _gmacd_gmac1q2_irq_handler },
+	{ GMAC1, &_gmacd1_work[1], 1, ID_GMAC1_Q1, _gmacd_gmac1q1_irq_handler },
+	{ GMAC1, &_gmacd1_work[2], 2, ID_GMAC1_Q2, _gmacd_gmac1q2_irq_handler },
 #endif
 #endif
 };
@@ -290,13 +300,11 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
 	 */
 	gmac_transmit_enable(gmac, false);
 
-	/* The following step should be optional since this function is called
-	 * directly by the IRQ handler. Indeed, according to Cadence
-	 * documentation, the transmission is halted on errors such as
-	 * too many retries or transmit under run.
-	 * However it would become mandatory if the call of this function
-	 * were scheduled as a task by the IRQ handler (this is how Linux
-	 * driver works). Then this function might compete with ethd_send().
+	/* According to Cadence documentation, the transmission is halted on
+	 * errors such as too many retries or transmit under run.
+	 * However the following step is mandatory since this function runs
+	 * as deferred work after the IRQ handler (this is how Linux driver
+	 * works): it might compete with ethd_send().
 	 *
 	 * Setting bit 10, tx_halt, of the Network Control Register is not enough:
 	 * We should wait for bit 3, tx_go, of the Transmit Status Register to
@@ -352,18 +360,40 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
  *---------------------------------------------------------------------------*/
 
 /**
- *  \brief GMAC Interrupt handler
- *  \param gmacd Pointer to GMAC Driver instance.
+ *  \brief GMAC Interrupt handler: keeps the interrupt status and leaves
+ *  its processing to the deferred work, out of hard IRQ context.
+ *  \param work Pointer to the deferred work of the GMAC queue.
  */
-static void _gmacd_handler(struct _ethd * gmacd, uint8_t queue)
+static void _gmacd_handler(struct _gmacd_work* work)
 {
+	/* Interrupt Status Register is cleared on read */
+	work->isr |= gmac_get_it_status(work->gmacd->gmac, work->queue);
+	softirq_raise(&work->softirq);
+}
+
+/**
+ *  \brief Process the interrupt status kept by the GMAC Interrupt handler
+ *  \param arg Pointer to the deferred work of the GMAC queue.
+ */
+static void _gmacd_process(void* arg)
+{
+	struct _gmacd_work* work = (struct _gmacd_work*)arg;
+	struct _ethd* gmacd = work->gmacd;
+	uint8_t queue = work->queue;
 	Gmac *gmac = gmacd->gmac;
 	struct _ethd_queue* q = &gmacd->queues[queue];
 	uint32_t isr;
 	uint32_t rsr;
+	uint32_t state;
+
+	for (;;) {
+		state = irq_save();
+		isr = work->isr;
+		work->isr = 0;
+		irq_restore(state);
+		if (!isr)
+			break;
 
-	/* Interrupt Status Register is cleared on read */
-	while ((isr = gmac_get_it_status(gmac, queue)) != 0) {
 		/* RX packet */
 		if (isr & GMAC_INT_RX_BITS) {
 			/* Clear status */
@@ -414,7 +444,11 @@ void gmacd_configure(struct _ethd * gmacd,
 	uint32_t id = get_gmac_id_from_addr(gmac);
 	for (i = 0; i < ARRAY_SIZE(_gmacd_irq_handlers); i++) {
 		if (_gmacd_irq_handlers[i].addr == gmac) {
-			*_gmacd_irq_handlers[i].gmacd = gmacd;
+			struct _gmacd_work* work = _gmacd_irq_handlers[i].work;
+			work->gmacd = gmacd;
+			work->queue = _gmacd_irq_handlers[i].queue;
+			work->isr = 0;
+			softirq_init(&work->softirq, _gmacd_process, work);
 			aic_set_source_vector(_gmacd_irq_handlers[i].irq,
 					_gmacd_irq_handlers[i].handler);
 		}
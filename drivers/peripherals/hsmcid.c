@@ -50,6 +50,9 @@
 #include "board.h"
 #include "intmath.h"
 #include "timer.h"
+#include "compiler.h"
+#include "core/irq.h"
+#include "peripherals/aic.h"
 #include "peripherals/pmc.h"
 #include "peripherals/tc.h"
 #include "peripherals/hsmcic.h"
@@ -108,6 +111,9 @@ static uint8_t hsmci_cancel_command(struct hsmci_set *set);
 static uint8_t hsmci_release_dma(struct hsmci_set *set);
 static void hsmci_finish_cmd(struct hsmci_set *set, uint8_t bStatus);
 
+/** Driver instances, as found by the interrupt handler */
+static struct hsmci_set *_hsmci_sets[3];
+
 static void hsmci_power_device(struct hsmci_set *set, bool on)
 {
 	assert(set);
@@ -266,6 +272,19 @@ static void hsmci_handler(struct hsmci_set *set)
 	}
 }
 
+static void hsmci_irq_handler(void)
+{
+	uint32_t id = aic_get_current_interrupt_identifier();
+	uint8_t i;
+
+	for (i = 0; i < ARRAY_SIZE(_hsmci_sets); i++) {
+		if (_hsmci_sets[i] && _hsmci_sets[i]->id == id) {
+			hsmci_handler(_hsmci_sets[i]);
+			return;
+		}
+	}
+}
+
 /**
  * \brief Check if the command is finished.
  */
@@ -275,6 +294,9 @@ static bool hsmci_is_busy(struct hsmci_set *set)
 
 	if (set->use_polling)
 		hsmci_handler(set);
+	else if (set->state == MCID_CMD)
+		/* In case the DMA driver was switched to polling mode since */
+		dma_poll();
 	if (set->state == MCID_CMD)
 		return true;
 	return false;
@@ -284,15 +306,21 @@ static uint8_t hsmci_cancel_command(struct hsmci_set *set)
 {
 	assert(set);
 
+	uint32_t irq_state;
+
 	if (set->state == MCID_IDLE)
 		return SDMMC_ERROR_STATE;
+	/* Keep the interrupt handlers off the command being cancelled */
+	irq_state = irq_save();
 	if (set->state == MCID_CMD) {
 		/* Cancel ... */
+		hsmci_disable_it(set->regs, ~0ul);
 		hsmci_release_dma(set);
 		hsmci_reset(set->regs, true);
 		/* Command is finished */
 		hsmci_finish_cmd(set, SDMMC_ERROR_USER_CANCEL);
 	}
+	irq_restore(irq_state);
 	return SDMMC_OK;
 }
 
@@ -618,6 +646,12 @@ static uint32_t hsmci_control(void *_set, uint32_t bCtl, uint32_t param)
 		*param_u32 = 0;
 		break;
 
+	case SDMMC_IOCTL_GET_IRQMODE:
+		if (!param)
+			return SDMMC_ERROR_PARAM;
+		*param_u32 = set->use_polling || dma_is_polling() ? 0 : 1;
+		break;
+
 	case SDMMC_IOCTL_BUSY_CHECK:
 		if (!param)
 			return SDMMC_ERROR_PARAM;
@@ -838,6 +872,7 @@ bool hsmci_initialize(struct hsmci_set *set, Hsmci *regs, uint32_t periph_id,
 	assert(tc_ch < TCCHANNEL_NUMBER);
 
 	Tc * const tc_module = get_tc_addr_from_id(tc_id);
+	uint8_t i;
 
 	assert(tc_module);
 	memset(set, 0, sizeof(*set));
@@ -845,7 +880,9 @@ bool hsmci_initialize(struct hsmci_set *set, Hsmci *regs, uint32_t periph_id,
 	set->regs = regs;
 	set->tc_id = tc_id;
 	set->timer = &tc_module->TC_CHANNEL[tc_ch];
-	set->use_polling = true;
+	/* The end of DMA transfers triggers the final event of data
+	 * commands: when the DMA driver polls, so does this driver */
+	set->use_polling = dma_is_polling();
 	set->state = MCID_OFF;
 
 	/* Prepare our Timer/Counter */
@@ -865,6 +902,19 @@ bool hsmci_initialize(struct hsmci_set *set, Hsmci *regs, uint32_t periph_id,
 		| HSMCI_DTOR_DTOMUL_1048576);
 	hsmci_cfg_compl_timeout(regs, HSMCI_CSTOR_CSTOCYC_Msk
 		| HSMCI_CSTOR_CSTOMUL_1048576);
+
+	if (!set->use_polling) {
+		/* Have the command events processed by our interrupt handler */
+		for (i = 0; i < ARRAY_SIZE(_hsmci_sets); i++) {
+			if (!_hsmci_sets[i] || _hsmci_sets[i]->id == periph_id) {
+				_hsmci_sets[i] = set;
+				break;
+			}
+		}
+		assert(i < ARRAY_SIZE(_hsmci_sets));
+		aic_set_source_vector(periph_id, hsmci_irq_handler);
+		aic_enable(periph_id);
+	}
 	return true;
 }
 
@@ -167,6 +167,56 @@ static bool configure_ram(struct mcan_set *set,
 	return true;
 }
 
+/**
+ * \brief Append a message to the TX FIFO / Queue.
+ * \param set  Pointer to driver instance data.
+ * \param id  Message ID.
+ * \param len  Data length, in bytes.
+ * \param data  Pointer to data.
+ * \param t1_flags  Additional T1 word flags (Message Marker, EFC).
+ * \return Index of the assigned transmit buffer, or 0xff.
+ */
+static uint8_t enqueue_msg(struct mcan_set *set, uint32_t id, uint8_t len,
+                           const uint8_t *data, uint32_t t1_flags)
+{
+	assert(len <= set->cfg.buf_size_tx);
+
+	Mcan *mcan = set->cfg.regs;
+	uint32_t val;
+	uint32_t *pThisTxBuf = 0;
+	const enum mcan_can_mode mode = mcan_get_mode(set);
+	enum mcan_dlc dlc;
+	uint8_t putIdx = 255;
+
+	if (!get_length_code(len, &dlc))
+		dlc = CAN_DLC_0;
+	/* Configured for FifoQ and FifoQ not full? */
+	if (set->cfg.fifo_size_tx == 0 || (mcan->MCAN_TXFQS & MCAN_TXFQS_TFQF))
+		return putIdx;
+	putIdx = (uint8_t)((mcan->MCAN_TXFQS & MCAN_TXFQS_TFQPI_Msk)
+	    >> MCAN_TXFQS_TFQPI_Pos);
+	pThisTxBuf = set->ram_array_tx + (uint32_t)
+	    putIdx * (MCAN_RAM_BUF_HDR_SIZE + set->cfg.buf_size_tx / 4);
+	if (mcan_is_extended_id(id))
+		*pThisTxBuf++ = MCAN_RAM_BUF_XTD | MCAN_RAM_BUF_ID_XTD(id);
+	else
+		*pThisTxBuf++ = MCAN_RAM_BUF_ID_STD(id);
+	val = t1_flags | MCAN_RAM_BUF_DLC((uint32_t)dlc);
+	if (mode == MCAN_MODE_EXT_LEN_CONST_RATE)
+		val |= MCAN_RAM_BUF_FDF;
+	else if (mode == MCAN_MODE_EXT_LEN_DUAL_RATE)
+		val |= MCAN_RAM_BUF_FDF | MCAN_RAM_BUF_BRS;
+	*pThisTxBuf++ = val;
+	memcpy(pThisTxBuf, data, len);
+	/* enable transmit from buffer to set TC interrupt bit in IR,
+	 * but interrupt will not happen unless TC interrupt is enabled
+	 */
+	mcan->MCAN_TXBTIE = (1 << putIdx);
+	/* request to send */
+	mcan->MCAN_TXBAR = (1 << putIdx);
+	return putIdx;
+}
+
 /*---------------------------------------------------------------------------
  *      Exported Functions
  *---------------------------------------------------------------------------*/
@@ -401,6 +451,21 @@ void mcan_init_loopback(struct mcan_set *set)
 	mcan->MCAN_TEST |= MCAN_TEST_LBCK_ENABLED;
 }
 
+void mcan_configure_timestamp(struct mcan_set *set, uint8_t prescaler)
+{
+	assert(prescaler <= 16);
+
+	Mcan *mcan = set->cfg.regs;
+
+	if (prescaler == 0)
+		mcan->MCAN_TSCC = MCAN_TSCC_TSS_ALWAYS_0;
+	else
+		mcan->MCAN_TSCC = MCAN_TSCC_TSS_TCP_INC
+		    | MCAN_TSCC_TCP(prescaler - 1);
+	/* reset the counter */
+	mcan->MCAN_TSCV = 0;
+}
+
 void mcan_set_tx_queue_mode(struct mcan_set *set)
 {
 	Mcan *mcan = set->cfg.regs;
@@ -512,42 +577,15 @@ void mcan_send_tx_buffer(struct mcan_set *set, uint8_t buf_idx)
 uint8_t mcan_enqueue_outgoing_msg(struct mcan_set *set, uint32_t id,
 			          uint8_t len, const uint8_t *data)
 {
-	assert(len <= set->cfg.buf_size_tx);
-
-	Mcan *mcan = set->cfg.regs;
-	uint32_t val;
-	uint32_t *pThisTxBuf = 0;
-	const enum mcan_can_mode mode = mcan_get_mode(set);
-	enum mcan_dlc dlc;
-	uint8_t putIdx = 255;
+	return enqueue_msg(set, id, len, data, MCAN_RAM_BUF_MM(0));
+}
 
-	if (!get_length_code(len, &dlc))
-		dlc = CAN_DLC_0;
-	/* Configured for FifoQ and FifoQ not full? */
-	if (set->cfg.fifo_size_tx == 0 || (mcan->MCAN_TXFQS & MCAN_TXFQS_TFQF))
-		return putIdx;
-	putIdx = (uint8_t)((mcan->MCAN_TXFQS & MCAN_TXFQS_TFQPI_Msk)
-	    >> MCAN_TXFQS_TFQPI_Pos);
-	pThisTxBuf = set->ram_array_tx + (uint32_t)
-	    putIdx * (MCAN_RAM_BUF_HDR_SIZE + set->cfg.buf_size_tx / 4);
-	if (mcan_is_extended_id(id))
-		*pThisTxBuf++ = MCAN_RAM_BUF_XTD | MCAN_RAM_BUF_ID_XTD(id);
-	else
-		*pThisTxBuf++ = MCAN_RAM_BUF_ID_STD(id);
-	val = MCAN_RAM_BUF_MM(0) | MCAN_RAM_BUF_DLC((uint32_t)dlc);
-	if (mode == MCAN_MODE_EXT_LEN_CONST_RATE)
-		val |= MCAN_RAM_BUF_FDF;
-	else if (mode == MCAN_MODE_EXT_LEN_DUAL_RATE)
-		val |= MCAN_RAM_BUF_FDF | MCAN_RAM_BUF_BRS;
-	*pThisTxBuf++ = val;
-	memcpy(pThisTxBuf, data, len);
-	/* enable transmit from buffer to set TC interrupt bit in IR,
-	 * but interrupt will not happen unless TC interrupt is enabled
-	 */
-	mcan->MCAN_TXBTIE = (1 << putIdx);
-	/* request to send */
-	mcan->MCAN_TXBAR = (1 << putIdx);
-	return putIdx;
+uint8_t mcan_enqueue_tracked_msg(struct mcan_set *set, uint32_t id,
+			         uint8_t len, const uint8_t *data,
+			         uint8_t marker)
+{
+	return enqueue_msg(set, id, len, data, MCAN_RAM_BUF_MM(marker)
+	    | MCAN_RAM_BUF_EFC);
 }
 
 bool mcan_is_buffer_sent(const struct mcan_set *set, uint8_t buf_idx)
@@ -745,4 +783,41 @@ uint8_t mcan_dequeue_received_msg(struct mcan_set *set, uint8_t fifo,
 	return (fill_level);
 }
 
+uint8_t mcan_dequeue_tx_event(struct mcan_set *set,
+                              struct mcan_tx_event_info *evt)
+{
+	Mcan *mcan = set->cfg.regs;
+	const uint32_t *pThisEvt;
+	uint32_t tempEy;   /* temp copy of TX event word */
+	uint32_t get_index;
+	uint8_t fill_level;
+
+	tempEy = mcan->MCAN_TXEFS;
+	fill_level = (uint8_t)((tempEy & MCAN_TXEFS_EFFL_Msk)
+	    >> MCAN_TXEFS_EFFL_Pos);
+	if (fill_level == 0)
+		return 0;
+	get_index = (tempEy & MCAN_TXEFS_EFGI_Msk) >> MCAN_TXEFS_EFGI_Pos;
+
+	pThisEvt = set->ram_fifo_tx_evt + get_index * MCAN_RAM_TX_EVT_SIZE;
+	tempEy = *pThisEvt++;   /* word E0 contains ID */
+	if (tempEy & MCAN_RAM_BUF_XTD)
+		evt->id = CAN_EXT_MSG_ID | (tempEy & MCAN_RAM_BUF_ID_XTD_Msk)
+		    >> MCAN_RAM_BUF_ID_XTD_Pos;
+	else
+		evt->id = (tempEy & MCAN_RAM_BUF_ID_STD_Msk)
+		    >> MCAN_RAM_BUF_ID_STD_Pos;
+	tempEy = *pThisEvt;   /* word E1 contains DLC, timestamp & marker */
+	evt->len = get_data_length((enum mcan_dlc)
+	    ((tempEy & MCAN_RAM_BUF_DLC_Msk) >> MCAN_RAM_BUF_DLC_Pos));
+	/* TXTS shares the position of RXTS */
+	evt->timestamp = (tempEy & MCAN_RAM_BUF_RXTS_Msk)
+	    >> MCAN_RAM_BUF_RXTS_Pos;
+	evt->marker = (uint8_t)((tempEy & MCAN_RAM_BUF_MM_Msk)
+	    >> MCAN_RAM_BUF_MM_Pos);
+	/* acknowledge reading the event */
+	mcan->MCAN_TXEFA = MCAN_TXEFA_EFAI(get_index);
+	return fill_level;
+}
+
 /**@}*/
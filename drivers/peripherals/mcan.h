@@ -89,6 +89,14 @@ struct mcan_msg_info
 	uint8_t data_len;
 };
 
+struct mcan_tx_event_info
+{
+	uint32_t id;
+	uint32_t timestamp;
+	uint8_t marker;
+	uint8_t len;
+};
+
 struct mcan_config
 {
 	uint32_t id;                  /* peripheral ID (ID_xxx) */
@@ -181,6 +189,13 @@ static inline uint32_t mcan_get_id(uint32_t msg_id)
 	return msg_id & CAN_EXT_MSG_ID ? msg_id & 0x1fffffff : msg_id & 0x7ff;
 }
 
+static inline uint16_t mcan_get_timestamp(const struct mcan_set *set)
+{
+	Mcan *mcan = set->cfg.regs;
+	return (uint16_t)((mcan->MCAN_TSCV & MCAN_TSCV_TSC_Msk)
+	    >> MCAN_TSCV_TSC_Pos);
+}
+
 static inline bool mcan_is_tx_complete(const struct mcan_set *set)
 {
 	Mcan *mcan = set->cfg.regs;
@@ -279,6 +294,17 @@ enum mcan_can_mode mcan_get_mode(const struct mcan_set *set);
  */
 void mcan_set_tx_queue_mode(struct mcan_set *set);
 
+/**
+ * \brief Make the timestamp counter increment every 'prescaler' CAN bit times,
+ * so that received frames and TX events are timestamped.
+ * INIT must be set - so this should be called between mcan_initialize() and
+ * mcan_enable().
+ * \param set  Pointer to driver instance data.
+ * \param prescaler  Number of CAN bit times per counter increment, 1 to 16.
+ * 0 stops the counter (timestamps read as 0).
+ */
+void mcan_configure_timestamp(struct mcan_set *set, uint8_t prescaler);
+
 /**
  * \brief Initialize the MCAN in loop back mode.
  * INIT must be set - so this should be called between mcan_initialize() and
@@ -358,6 +384,20 @@ void mcan_send_tx_buffer(struct mcan_set *set, uint8_t buf_idx);
 uint8_t mcan_enqueue_outgoing_msg(struct mcan_set *set, uint32_t id,
      uint8_t len, const uint8_t *data);
 
+/**
+ * \brief Same as mcan_enqueue_outgoing_msg(), but also request a TX Event FIFO
+ * entry tagged with the given marker once the message has been transmitted.
+ * \param set  Pointer to driver instance data.
+ * \param id  Message ID.
+ * \param len  Data length, in bytes.
+ * \param data  Pointer to data.
+ * \param marker  Message Marker, copied to the TX Event FIFO entry.
+ * \return Index of the assigned transmit buffer, part of the FIFO / queue.
+ * Or 0xff if the TX FIFO / queue was full, or an error occurred.
+ */
+uint8_t mcan_enqueue_tracked_msg(struct mcan_set *set, uint32_t id,
+     uint8_t len, const uint8_t *data, uint8_t marker);
+
 /**
  * \brief Check if message transmitted from the specified TX Buffer, either
  * dedicated or part of the TX FIFO or TX Queue.
@@ -432,6 +472,17 @@ void mcan_read_rx_buffer(struct mcan_set *set, uint8_t buf_idx,
 uint8_t mcan_dequeue_received_msg(struct mcan_set *set, uint8_t fifo,
     struct mcan_msg_info *msg);
 
+/**
+ * \brief Detach one entry from the TX Event FIFO.
+ * \param set  Pointer to driver instance data.
+ * \param evt  Address where the properties of the transmitted message will be
+ * written.
+ * \return: # of TX Event FIFO entries at the time the function was entered,
+ * 0 if the FIFO was empty.
+ */
+uint8_t mcan_dequeue_tx_event(struct mcan_set *set,
+    struct mcan_tx_event_info *evt);
+
 #ifdef __cplusplus
 }
 #endif
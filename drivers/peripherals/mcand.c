@@ -0,0 +1,810 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *  Interrupt-driven MCAN driver: software RX/TX rings, extended timestamps
+ *  and ISO-TP style segmentation.
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "compiler.h"
+#include "hrtimer.h"
+#include "ring.h"
+
+#include "peripherals/aic.h"
+#include "peripherals/mcan.h"
+#include "peripherals/mcand.h"
+
+#include <assert.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+ *         Local definitions
+ *------------------------------------------------------------------------------*/
+
+/** Number of MCAN instances */
+#define MCAND_INSTANCES     (2)
+
+/** ISO-TP Protocol Control Information */
+#define ISOTP_PCI_SF        (0x0)
+#define ISOTP_PCI_FF        (0x1)
+#define ISOTP_PCI_CF        (0x2)
+#define ISOTP_PCI_FC        (0x3)
+
+/** ISO-TP Flow Status */
+#define ISOTP_FS_CTS        (0x0)
+#define ISOTP_FS_WAIT       (0x1)
+#define ISOTP_FS_OVFLW      (0x2)
+
+/** ISO-TP padding byte */
+#define ISOTP_PADDING       (0xCC)
+
+enum _isotp_state {
+	ISOTP_IDLE,
+	ISOTP_WAIT_FC,
+	ISOTP_SENDING,
+	ISOTP_RECEIVING,
+};
+
+/*------------------------------------------------------------------------------
+ *         Local variables
+ *------------------------------------------------------------------------------*/
+
+static struct _mcand_desc* _mcand_descs[MCAND_INSTANCES];
+
+/*------------------------------------------------------------------------------
+ *         Local functions
+ *------------------------------------------------------------------------------*/
+
+static uint8_t _mcand_get_instance(const struct _mcand_desc* desc)
+{
+	uint32_t id = desc->set->cfg.id;
+
+	return (id == ID_CAN0_INT0 || id == ID_CAN0_INT1) ? 0 : 1;
+}
+
+static uint32_t _mcand_get_irq(const struct _mcand_desc* desc)
+{
+	if (_mcand_get_instance(desc) == 0)
+		return desc->int_line ? ID_CAN0_INT1 : ID_CAN0_INT0;
+	else
+		return desc->int_line ? ID_CAN1_INT1 : ID_CAN1_INT0;
+}
+
+static bool _mcand_is_valid_length(uint8_t len)
+{
+	if (len <= 8)
+		return true;
+	return len == 12 || len == 16 || len == 20 || len == 24 ||
+	       len == 32 || len == 48 || len == 64;
+}
+
+/**
+ * \brief Account for pending timestamp counter wrap-arounds, and read the
+ * counter. Loop until no wrap-around happened while reading it, so that the
+ * returned value and desc->ts_wraps are consistent.
+ */
+static uint16_t _mcand_update_timestamp(struct _mcand_desc* desc)
+{
+	Mcan* mcan = desc->set->cfg.regs;
+	uint16_t now;
+
+	do {
+		if (mcan->MCAN_IR & MCAN_IR_TSW) {
+			mcan->MCAN_IR = MCAN_IR_TSW;
+			desc->ts_wraps++;
+		}
+		now = mcan_get_timestamp(desc->set);
+	} while (mcan->MCAN_IR & MCAN_IR_TSW);
+	return now;
+}
+
+/**
+ * \brief Extend a 16-bit timestamp captured before 'now'. A timestamp
+ * greater than 'now' was captured before the last wrap-around.
+ */
+static uint32_t _mcand_extend_timestamp(const struct _mcand_desc* desc,
+		uint32_t ts, uint16_t now)
+{
+	uint32_t wraps = desc->ts_wraps;
+
+	if (desc->ts_prescaler == 0)
+		return 0;
+	if (ts > now)
+		wraps--;
+	return (wraps << 16) | ts;
+}
+
+static uint32_t _mcand_drain_rx_fifo(struct _mcand_desc* desc, uint8_t fifo,
+		uint16_t now)
+{
+	struct _mcand_frame scratch;
+	struct _mcand_frame* frame;
+	struct mcan_msg_info msg;
+	uint32_t events = 0;
+	uint8_t fill_level;
+	bool drop;
+
+	do {
+		drop = RING_SPACE(desc->rx_head, desc->rx_tail, desc->rx_size) == 0;
+		frame = drop ? &scratch : &desc->rx[desc->rx_head];
+		msg.data = frame->data;
+		msg.data_len = sizeof(frame->data);
+		fill_level = mcan_dequeue_received_msg(desc->set, fifo, &msg);
+		if (fill_level == 0)
+			break;
+		if (drop) {
+			desc->stats.rx_dropped++;
+			events |= MCAND_EVENT_RX_LOST;
+			continue;
+		}
+		frame->id = msg.id;
+		frame->len = msg.data_len;
+		frame->fifo = fifo;
+		frame->timestamp = _mcand_extend_timestamp(desc, msg.timestamp,
+				now);
+		/* publish the frame before moving the head */
+		dmb();
+		RING_INC(desc->rx_head, desc->rx_size);
+		desc->stats.rx_frames++;
+		events |= MCAND_EVENT_RX;
+	} while (fill_level > 1);
+
+	return events;
+}
+
+static uint32_t _mcand_drain_tx_events(struct _mcand_desc* desc,
+		uint16_t now)
+{
+	struct mcan_tx_event_info info;
+	struct _mcand_tx_event* evt;
+	uint32_t events = 0;
+	uint8_t fill_level;
+
+	do {
+		fill_level = mcan_dequeue_tx_event(desc->set, &info);
+		if (fill_level == 0)
+			break;
+		if (RING_SPACE(desc->evt_head, desc->evt_tail,
+				desc->events_size) == 0) {
+			desc->stats.tx_events_dropped++;
+			continue;
+		}
+		evt = &desc->events[desc->evt_head];
+		evt->id = info.id;
+		evt->marker = info.marker;
+		evt->len = info.len;
+		evt->timestamp = _mcand_extend_timestamp(desc, info.timestamp,
+				now);
+		dmb();
+		RING_INC(desc->evt_head, desc->events_size);
+		desc->stats.tx_events++;
+		events |= MCAND_EVENT_TX_EVENT;
+	} while (fill_level > 1);
+
+	return events;
+}
+
+/**
+ * \brief Move frames from the TX ring to the TX FIFO, as long as it has
+ * free elements. Called with the MCAN interrupt masked.
+ */
+static void _mcand_fill_tx_fifo(struct _mcand_desc* desc)
+{
+	struct _mcand_frame* frame;
+	uint8_t idx;
+
+	while (!RING_EMPTY(desc->tx_head, desc->tx_tail)) {
+		frame = &desc->tx[desc->tx_tail];
+		if (desc->events)
+			idx = mcan_enqueue_tracked_msg(desc->set, frame->id,
+					frame->len, frame->data, frame->marker);
+		else
+			idx = mcan_enqueue_outgoing_msg(desc->set, frame->id,
+					frame->len, frame->data);
+		if (idx == 0xff)
+			break;
+		RING_INC(desc->tx_tail, desc->tx_size);
+		desc->stats.tx_frames++;
+	}
+}
+
+static void _mcand_handler(void)
+{
+	uint32_t id = aic_get_current_interrupt_identifier();
+	struct _mcand_desc* desc;
+	Mcan* mcan;
+	uint32_t status, events = 0;
+	uint16_t now;
+
+	desc = _mcand_descs[(id == ID_CAN0_INT0 || id == ID_CAN0_INT1) ? 0 : 1];
+	if (!desc)
+		return;
+	mcan = desc->set->cfg.regs;
+
+	/* Clear the flags first, so that events occurring while the FIFOs are
+	 * drained raise the interrupt again */
+	status = mcan->MCAN_IR & desc->it_mask & ~MCAN_IR_TSW;
+	mcan->MCAN_IR = status;
+	now = _mcand_update_timestamp(desc);
+
+	if (status & (MCAN_IR_RF0N | MCAN_IR_RF0L))
+		events |= _mcand_drain_rx_fifo(desc, 0, now);
+	if (status & (MCAN_IR_RF1N | MCAN_IR_RF1L))
+		events |= _mcand_drain_rx_fifo(desc, 1, now);
+	if (status & (MCAN_IR_RF0L | MCAN_IR_RF1L)) {
+		desc->stats.rx_lost++;
+		events |= MCAND_EVENT_RX_LOST;
+	}
+
+	if (status & (MCAN_IR_TEFN | MCAN_IR_TEFL))
+		events |= _mcand_drain_tx_events(desc, now);
+	if (status & MCAN_IR_TEFL)
+		desc->stats.tx_events_dropped++;
+
+	if (status & MCAN_IR_TFE) {
+		_mcand_fill_tx_fifo(desc);
+		if (RING_EMPTY(desc->tx_head, desc->tx_tail) &&
+		    (mcan->MCAN_TXFQS & MCAN_TXFQS_TFFL_Msk) >> MCAN_TXFQS_TFFL_Pos
+		    == desc->set->cfg.fifo_size_tx)
+			events |= MCAND_EVENT_TX_EMPTY;
+	} else if (status & MCAN_IR_TEFN) {
+		/* a TX FIFO element has been freed */
+		_mcand_fill_tx_fifo(desc);
+	}
+
+	if (status & MCAN_IR_BO) {
+		desc->bus_off = (mcan->MCAN_PSR & MCAN_PSR_BO) ? true : false;
+		if (desc->bus_off) {
+			desc->stats.bus_off++;
+			events |= MCAND_EVENT_BUS_OFF;
+		}
+	}
+
+	if (events && desc->callback)
+		desc->callback(desc, events, desc->cb_args);
+}
+
+/**
+ * \brief Smallest valid CAN FD data length greater or equal to len.
+ */
+static uint8_t _isotp_frame_length(uint8_t len)
+{
+	static const uint8_t lengths[] = { 12, 16, 20, 24, 32, 48, 64 };
+	unsigned int i;
+
+	if (len <= 8)
+		return len;
+	for (i = 0; i < ARRAY_SIZE(lengths) - 1; i++)
+		if (len <= lengths[i])
+			break;
+	return lengths[i];
+}
+
+static uint32_t _isotp_send_frame(struct _mcand_isotp* isotp, uint8_t* buf,
+		uint8_t len)
+{
+	uint8_t frame_len = _isotp_frame_length(len);
+
+	memset(buf + len, ISOTP_PADDING, frame_len - len);
+	return mcand_write(isotp->mcand, isotp->tx_id, buf, frame_len, NULL);
+}
+
+static void _isotp_send_flow_control(struct _mcand_isotp* isotp, uint8_t fs)
+{
+	uint8_t buf[3];
+
+	buf[0] = (ISOTP_PCI_FC << 4) | fs;
+	buf[1] = isotp->block_size;
+	buf[2] = isotp->st_min;
+	_isotp_send_frame(isotp, buf, sizeof(buf));
+}
+
+/**
+ * hrtimer callback, in interrupt context: only flag the expiry, the state
+ * machine runs in mcand_isotp_poll()
+ */
+static void _isotp_timer_callback(struct _hrtimer* timer, void* arg)
+{
+	struct _mcand_isotp* isotp = (struct _mcand_isotp*)arg;
+
+	if (timer == &isotp->tx_timer)
+		isotp->tx_expired = true;
+	else
+		isotp->rx_expired = true;
+}
+
+/** (Re)start an N_Bs or N_Cr timeout */
+static void _isotp_start_timer(struct _mcand_isotp* isotp,
+		struct _hrtimer* timer)
+{
+	hrtimer_start_us(timer, isotp->timeout * 1000, 0);
+	if (timer == &isotp->tx_timer)
+		isotp->tx_expired = false;
+	else
+		isotp->rx_expired = false;
+}
+
+static void _isotp_end_tx(struct _mcand_isotp* isotp, uint32_t status)
+{
+	hrtimer_cancel(&isotp->tx_timer);
+	isotp->tx_state = ISOTP_IDLE;
+	if (isotp->tx_callback)
+		isotp->tx_callback(isotp, status, isotp->cb_args);
+}
+
+static void _isotp_end_rx(struct _mcand_isotp* isotp)
+{
+	hrtimer_cancel(&isotp->rx_timer);
+	isotp->rx_state = ISOTP_IDLE;
+	if (isotp->rx_callback)
+		isotp->rx_callback(isotp, isotp->rx_buffer, isotp->rx_len,
+				isotp->cb_args);
+}
+
+static void _isotp_process_single(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame)
+{
+	uint32_t len = frame->data[0] & 0xf;
+	uint32_t offset = 1;
+
+	if (len == 0) {
+		/* CAN FD escape sequence */
+		if (frame->len < 2)
+			return;
+		len = frame->data[1];
+		offset = 2;
+	}
+	if (len == 0 || offset + len > frame->len ||
+	    len > isotp->rx_buffer_size)
+		return;
+
+	/* a single frame aborts any reception in progress */
+	memcpy(isotp->rx_buffer, &frame->data[offset], len);
+	isotp->rx_len = len;
+	_isotp_end_rx(isotp);
+}
+
+static void _isotp_process_first(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame)
+{
+	uint32_t len, offset, count;
+
+	if (frame->len < 8)
+		return;
+	len = ((frame->data[0] & 0xf) << 8) | frame->data[1];
+	offset = 2;
+	if (len == 0) {
+		/* message longer than 4095 bytes */
+		len = (frame->data[2] << 24) | (frame->data[3] << 16) |
+		      (frame->data[4] << 8) | frame->data[5];
+		offset = 6;
+	}
+	if (len > isotp->rx_buffer_size) {
+		isotp->rx_state = ISOTP_IDLE;
+		_isotp_send_flow_control(isotp, ISOTP_FS_OVFLW);
+		return;
+	}
+
+	count = frame->len - offset;
+	if (count > len)
+		count = len;
+	memcpy(isotp->rx_buffer, &frame->data[offset], count);
+	isotp->rx_len = len;
+	isotp->rx_offset = count;
+	isotp->rx_sn = 1;
+	isotp->rx_bs_left = isotp->block_size;
+	isotp->rx_state = ISOTP_RECEIVING;
+	_isotp_start_timer(isotp, &isotp->rx_timer);
+	_isotp_send_flow_control(isotp, ISOTP_FS_CTS);
+}
+
+static void _isotp_process_consecutive(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame)
+{
+	uint32_t count;
+
+	if (isotp->rx_state != ISOTP_RECEIVING)
+		return;
+	if ((frame->data[0] & 0xf) != isotp->rx_sn) {
+		/* lost frame, drop the message */
+		isotp->rx_state = ISOTP_IDLE;
+		return;
+	}
+
+	count = frame->len - 1;
+	if (count > isotp->rx_len - isotp->rx_offset)
+		count = isotp->rx_len - isotp->rx_offset;
+	memcpy(&isotp->rx_buffer[isotp->rx_offset], &frame->data[1], count);
+	isotp->rx_offset += count;
+	isotp->rx_sn = (isotp->rx_sn + 1) & 0xf;
+	if (isotp->rx_offset == isotp->rx_len) {
+		_isotp_end_rx(isotp);
+		return;
+	}
+
+	_isotp_start_timer(isotp, &isotp->rx_timer);
+	if (isotp->block_size && --isotp->rx_bs_left == 0) {
+		isotp->rx_bs_left = isotp->block_size;
+		_isotp_send_flow_control(isotp, ISOTP_FS_CTS);
+	}
+}
+
+static void _isotp_process_flow_control(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame)
+{
+	uint32_t st_min_us;
+	uint8_t st_min;
+
+	if (isotp->tx_state != ISOTP_WAIT_FC || frame->len < 3)
+		return;
+
+	switch (frame->data[0] & 0xf) {
+	case ISOTP_FS_CTS:
+		hrtimer_cancel(&isotp->tx_timer);
+		isotp->tx_bs_left = frame->data[1];
+		st_min = frame->data[2];
+		/* 0xF1-0xF9 are 100-900 us; reserved values shall be handled
+		 * as the maximum, 127 ms */
+		if (st_min >= 0xf1 && st_min <= 0xf9)
+			st_min_us = (st_min - 0xf0) * 100;
+		else if (st_min > 0x7f)
+			st_min_us = 0x7f * 1000;
+		else
+			st_min_us = st_min * 1000;
+		isotp->tx_st_min = (uint32_t)hrtimer_us_to_ticks(st_min_us);
+		/* no separation time before the first consecutive frame */
+		isotp->tx_next = hrtimer_get_ticks();
+		isotp->tx_state = ISOTP_SENDING;
+		break;
+	case ISOTP_FS_WAIT:
+		_isotp_start_timer(isotp, &isotp->tx_timer);
+		break;
+	case ISOTP_FS_OVFLW:
+		_isotp_end_tx(isotp, MCAND_ERROR_OVERFLOW);
+		break;
+	default:
+		_isotp_end_tx(isotp, MCAND_ERROR_PROTOCOL);
+		break;
+	}
+}
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+uint32_t mcand_initialize(struct _mcand_desc* desc)
+{
+	struct mcan_set* set = desc->set;
+	Mcan* mcan;
+	uint32_t irq, mask = 0;
+
+	if (!set || !set->cfg.regs || desc->int_line > 1 ||
+	    desc->ts_prescaler > 16 || set->cfg.fifo_size_tx == 0 ||
+	    !desc->rx || desc->rx_size < 2 || !desc->tx || desc->tx_size < 2)
+		return MCAND_INVALID_PARAM;
+	if (desc->events &&
+	    (desc->events_size < 2 || set->cfg.fifo_size_tx_evt == 0))
+		return MCAND_INVALID_PARAM;
+	mcan = set->cfg.regs;
+
+	RING_CLEAR(desc->rx_head, desc->rx_tail);
+	RING_CLEAR(desc->tx_head, desc->tx_tail);
+	RING_CLEAR(desc->evt_head, desc->evt_tail);
+	desc->ts_wraps = 0;
+	desc->marker = 0;
+	desc->bus_off = false;
+	memset(&desc->stats, 0, sizeof(desc->stats));
+
+	mcan_configure_timestamp(set, desc->ts_prescaler);
+
+	if (set->cfg.fifo_size_rx0)
+		mask |= MCAN_IR_RF0N | MCAN_IR_RF0L;
+	if (set->cfg.fifo_size_rx1)
+		mask |= MCAN_IR_RF1N | MCAN_IR_RF1L;
+	if (desc->events)
+		mask |= MCAN_IR_TEFN | MCAN_IR_TEFL;
+	if (desc->ts_prescaler)
+		mask |= MCAN_IR_TSW;
+	mask |= MCAN_IR_TFE | MCAN_IR_BO;
+	desc->it_mask = mask;
+
+	irq = _mcand_get_irq(desc);
+	aic_disable(irq);
+	_mcand_descs[_mcand_get_instance(desc)] = desc;
+	aic_set_source_vector(irq, _mcand_handler);
+
+	/* Route the interrupts to the selected line */
+	if (desc->int_line) {
+		mcan->MCAN_ILS |= mask;
+		mcan->MCAN_ILE |= MCAN_ILE_EINT1;
+	} else {
+		mcan->MCAN_ILS &= ~mask;
+		mcan->MCAN_ILE |= MCAN_ILE_EINT0;
+	}
+	mcan->MCAN_IR = mask;
+	mcan->MCAN_IE |= mask;
+
+	aic_enable(irq);
+
+	return MCAND_SUCCESS;
+}
+
+void mcand_shutdown(struct _mcand_desc* desc)
+{
+	Mcan* mcan = desc->set->cfg.regs;
+
+	aic_disable(_mcand_get_irq(desc));
+	mcan->MCAN_IE &= ~desc->it_mask;
+	mcan->MCAN_IR = desc->it_mask;
+	_mcand_descs[_mcand_get_instance(desc)] = NULL;
+
+	RING_CLEAR(desc->rx_head, desc->rx_tail);
+	RING_CLEAR(desc->tx_head, desc->tx_tail);
+	RING_CLEAR(desc->evt_head, desc->evt_tail);
+}
+
+uint32_t mcand_write(struct _mcand_desc* desc, uint32_t id,
+		const uint8_t* data, uint8_t len, uint8_t* marker)
+{
+	struct _mcand_frame* frame;
+	uint32_t irq;
+
+	if ((len && !data) || !_mcand_is_valid_length(len) ||
+	    len > desc->set->cfg.buf_size_tx)
+		return MCAND_INVALID_PARAM;
+	if (RING_SPACE(desc->tx_head, desc->tx_tail, desc->tx_size) == 0)
+		return MCAND_ERROR_BUSY;
+
+	frame = &desc->tx[desc->tx_head];
+	frame->id = id;
+	frame->len = len;
+	frame->marker = desc->marker++;
+	memcpy(frame->data, data, len);
+	if (marker)
+		*marker = frame->marker;
+	dmb();
+	RING_INC(desc->tx_head, desc->tx_size);
+
+	/* Kick the transmission: the interrupt handler refills the TX FIFO
+	 * once it is running, but it may be idle */
+	irq = _mcand_get_irq(desc);
+	aic_disable(irq);
+	_mcand_fill_tx_fifo(desc);
+	aic_enable(irq);
+
+	return MCAND_SUCCESS;
+}
+
+bool mcand_read(struct _mcand_desc* desc, struct _mcand_frame* frame)
+{
+	if (RING_EMPTY(desc->rx_head, desc->rx_tail))
+		return false;
+
+	*frame = desc->rx[desc->rx_tail];
+	dmb();
+	RING_INC(desc->rx_tail, desc->rx_size);
+	return true;
+}
+
+bool mcand_get_tx_event(struct _mcand_desc* desc,
+		struct _mcand_tx_event* evt)
+{
+	if (!desc->events || RING_EMPTY(desc->evt_head, desc->evt_tail))
+		return false;
+
+	*evt = desc->events[desc->evt_tail];
+	dmb();
+	RING_INC(desc->evt_tail, desc->events_size);
+	return true;
+}
+
+uint32_t mcand_get_rx_count(const struct _mcand_desc* desc)
+{
+	return RING_CNT(desc->rx_head, desc->rx_tail, desc->rx_size);
+}
+
+uint32_t mcand_get_tx_space(const struct _mcand_desc* desc)
+{
+	return RING_SPACE(desc->tx_head, desc->tx_tail, desc->tx_size);
+}
+
+uint32_t mcand_get_timestamp(struct _mcand_desc* desc)
+{
+	uint32_t irq = _mcand_get_irq(desc);
+	uint32_t ts;
+	uint16_t now;
+
+	aic_disable(irq);
+	now = _mcand_update_timestamp(desc);
+	ts = _mcand_extend_timestamp(desc, now, now);
+	aic_enable(irq);
+
+	return ts;
+}
+
+void mcand_get_stats(const struct _mcand_desc* desc,
+		struct _mcand_stats* stats)
+{
+	*stats = desc->stats;
+}
+
+uint32_t mcand_isotp_initialize(struct _mcand_isotp* isotp)
+{
+	if (!isotp->mcand || !isotp->rx_buffer || isotp->rx_buffer_size == 0)
+		return MCAND_INVALID_PARAM;
+	if (isotp->frame_len < 8 || !_mcand_is_valid_length(isotp->frame_len) ||
+	    isotp->frame_len > isotp->mcand->set->cfg.buf_size_tx)
+		return MCAND_INVALID_PARAM;
+	if (isotp->st_min > 0x7f)
+		return MCAND_INVALID_PARAM;
+	/* The protocol timeouts run on the hrtimer service */
+	if (!hrtimer_get_frequency())
+		return MCAND_INVALID_PARAM;
+
+	hrtimer_cancel(&isotp->tx_timer);
+	hrtimer_cancel(&isotp->rx_timer);
+	hrtimer_setup(&isotp->tx_timer, _isotp_timer_callback, isotp);
+	hrtimer_setup(&isotp->rx_timer, _isotp_timer_callback, isotp);
+	isotp->tx_state = ISOTP_IDLE;
+	isotp->rx_state = ISOTP_IDLE;
+	return MCAND_SUCCESS;
+}
+
+uint32_t mcand_isotp_send(struct _mcand_isotp* isotp, const uint8_t* data,
+		uint32_t len)
+{
+	uint8_t buf[MCAND_MAX_DATA_LEN];
+	uint32_t sf_max, offset, count, status;
+
+	if (!data || len == 0)
+		return MCAND_INVALID_PARAM;
+	if (isotp->tx_state != ISOTP_IDLE)
+		return MCAND_ERROR_BUSY;
+
+	/* Single frame: the CAN FD escape sequence adds a length byte */
+	sf_max = isotp->frame_len == 8 ? 7 : isotp->frame_len - 2;
+	if (len <= sf_max) {
+		if (len <= 7) {
+			buf[0] = (ISOTP_PCI_SF << 4) | len;
+			offset = 1;
+		} else {
+			buf[0] = ISOTP_PCI_SF << 4;
+			buf[1] = len;
+			offset = 2;
+		}
+		memcpy(&buf[offset], data, len);
+		status = _isotp_send_frame(isotp, buf, offset + len);
+		if (status == MCAND_SUCCESS && isotp->tx_callback)
+			isotp->tx_callback(isotp, status, isotp->cb_args);
+		return status;
+	}
+
+	/* First frame, then wait for the flow control of the receiver */
+	if (len <= 4095) {
+		buf[0] = (ISOTP_PCI_FF << 4) | (len >> 8);
+		buf[1] = len & 0xff;
+		offset = 2;
+	} else {
+		buf[0] = ISOTP_PCI_FF << 4;
+		buf[1] = 0;
+		buf[2] = len >> 24;
+		buf[3] = (len >> 16) & 0xff;
+		buf[4] = (len >> 8) & 0xff;
+		buf[5] = len & 0xff;
+		offset = 6;
+	}
+	count = isotp->frame_len - offset;
+	memcpy(&buf[offset], data, count);
+	status = _isotp_send_frame(isotp, buf, isotp->frame_len);
+	if (status != MCAND_SUCCESS)
+		return status;
+
+	isotp->tx_data = data;
+	isotp->tx_len = len;
+	isotp->tx_offset = count;
+	isotp->tx_sn = 1;
+	isotp->tx_state = ISOTP_WAIT_FC;
+	_isotp_start_timer(isotp, &isotp->tx_timer);
+	return MCAND_SUCCESS;
+}
+
+bool mcand_isotp_process(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame)
+{
+	if (frame->id != isotp->rx_id)
+		return false;
+	if (frame->len == 0)
+		return true;
+
+	switch (frame->data[0] >> 4) {
+	case ISOTP_PCI_SF:
+		_isotp_process_single(isotp, frame);
+		break;
+	case ISOTP_PCI_FF:
+		_isotp_process_first(isotp, frame);
+		break;
+	case ISOTP_PCI_CF:
+		_isotp_process_consecutive(isotp, frame);
+		break;
+	case ISOTP_PCI_FC:
+		_isotp_process_flow_control(isotp, frame);
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+void mcand_isotp_poll(struct _mcand_isotp* isotp)
+{
+	uint8_t buf[MCAND_MAX_DATA_LEN];
+	uint64_t now;
+	uint32_t count;
+
+	if (isotp->rx_state == ISOTP_RECEIVING && isotp->rx_expired)
+		isotp->rx_state = ISOTP_IDLE;
+
+	if (isotp->tx_state == ISOTP_WAIT_FC && isotp->tx_expired) {
+		_isotp_end_tx(isotp, MCAND_ERROR_TIMEOUT);
+		return;
+	}
+
+	while (isotp->tx_state == ISOTP_SENDING) {
+		now = hrtimer_get_ticks();
+		if (now < isotp->tx_next)
+			break;
+		if (mcand_get_tx_space(isotp->mcand) == 0)
+			break;
+
+		count = isotp->frame_len - 1;
+		if (count > isotp->tx_len - isotp->tx_offset)
+			count = isotp->tx_len - isotp->tx_offset;
+		buf[0] = (ISOTP_PCI_CF << 4) | isotp->tx_sn;
+		memcpy(&buf[1], &isotp->tx_data[isotp->tx_offset], count);
+		if (_isotp_send_frame(isotp, buf, count + 1) != MCAND_SUCCESS)
+			break;
+		isotp->tx_offset += count;
+		isotp->tx_sn = (isotp->tx_sn + 1) & 0xf;
+		isotp->tx_next = now + isotp->tx_st_min;
+
+		if (isotp->tx_offset == isotp->tx_len) {
+			_isotp_end_tx(isotp, MCAND_SUCCESS);
+			break;
+		}
+		if (isotp->tx_bs_left && --isotp->tx_bs_left == 0) {
+			isotp->tx_state = ISOTP_WAIT_FC;
+			_isotp_start_timer(isotp, &isotp->tx_timer);
+		}
+	}
+}
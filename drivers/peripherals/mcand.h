@@ -0,0 +1,330 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * \section Purpose
+ *
+ * Interrupt-driven layer on top of the MCAN driver.
+ *
+ * The interrupt handler drains RX FIFO 0/1 and the TX Event FIFO of the
+ * Message RAM into software rings, extends the 16-bit hardware timestamps to
+ * 32 bits, and refills the TX FIFO from a software TX ring. The rings are
+ * single producer / single consumer: the application never has to mask the
+ * MCAN interrupt to read a frame.
+ *
+ * An ISO 15765-2 (ISO-TP) style transport is also provided to exchange
+ * messages larger than a CAN or CAN FD frame. Its N_Bs / N_Cr timeouts and
+ * the STmin separation time run on the hrtimer service, which shall be
+ * configured beforehand (hrtimer_configure()).
+ */
+
+#ifndef _MCAND_H_
+#define _MCAND_H_
+
+#ifdef CONFIG_HAVE_MCAN
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "peripherals/mcan.h"
+#include "hrtimer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------------------------
+ *         Definitions
+ *------------------------------------------------------------------------------*/
+
+#define MCAND_SUCCESS          (0)
+#define MCAND_INVALID_PARAM    (1)
+#define MCAND_ERROR_BUSY       (2)
+#define MCAND_ERROR_TIMEOUT    (3)
+#define MCAND_ERROR_PROTOCOL   (4)
+#define MCAND_ERROR_OVERFLOW   (5)
+
+/** Events reported to the mcand callback */
+#define MCAND_EVENT_RX         (1u << 0)  /**< frames added to the RX ring */
+#define MCAND_EVENT_TX_EVENT   (1u << 1)  /**< entries added to the TX event ring */
+#define MCAND_EVENT_TX_EMPTY   (1u << 2)  /**< TX ring and TX FIFO are empty */
+#define MCAND_EVENT_RX_LOST    (1u << 3)  /**< frames lost (hardware or ring) */
+#define MCAND_EVENT_BUS_OFF    (1u << 4)  /**< controller went Bus_Off */
+
+/** Largest CAN FD payload */
+#define MCAND_MAX_DATA_LEN     (64)
+
+/*------------------------------------------------------------------------------
+ *         Types
+ *------------------------------------------------------------------------------*/
+
+struct _mcand_desc;
+
+/**
+ * \brief Callback invoked from the MCAN interrupt.
+ * \param desc mcand descriptor
+ * \param events MCAND_EVENT_xxx mask
+ * \param arg user argument
+ */
+typedef void (*mcand_callback_t)(struct _mcand_desc* desc, uint32_t events,
+		void* arg);
+
+/** \brief CAN frame, as stored in the RX and TX rings */
+struct _mcand_frame {
+	uint32_t id;         /**< CAN_STD_MSG_ID or CAN_EXT_MSG_ID | identifier */
+	uint32_t timestamp;  /**< RX: extended timestamp */
+	uint8_t len;         /**< data length, in bytes */
+	uint8_t fifo;        /**< RX: index of the RX FIFO */
+	uint8_t marker;      /**< TX: marker reported in the TX event */
+	uint8_t data[MCAND_MAX_DATA_LEN];
+};
+
+/** \brief Transmitted frame, reported through the TX Event FIFO */
+struct _mcand_tx_event {
+	uint32_t id;         /**< message identifier */
+	uint32_t timestamp;  /**< extended timestamp of the start of frame */
+	uint8_t marker;      /**< marker returned by mcand_write() */
+	uint8_t len;         /**< data length, in bytes */
+};
+
+/** \brief mcand statistics */
+struct _mcand_stats {
+	uint32_t rx_frames;   /**< frames moved to the RX ring */
+	uint32_t rx_dropped;  /**< frames dropped because the RX ring was full */
+	uint32_t rx_lost;     /**< RX FIFO overruns reported by the MCAN */
+	uint32_t tx_frames;   /**< frames moved to the TX FIFO */
+	uint32_t tx_events;   /**< TX events moved to the TX event ring */
+	uint32_t tx_events_dropped; /**< TX events lost (ring or hardware) */
+	uint32_t bus_off;     /**< Bus_Off transitions */
+};
+
+/** \brief mcand descriptor */
+struct _mcand_desc {
+	/* Configuration, set by the user */
+	struct mcan_set* set;     /**< initialized MCAN driver instance */
+	uint8_t int_line;         /**< 0: m_can_int0, 1: m_can_int1 */
+	uint8_t ts_prescaler;     /**< CAN bit times per timestamp tick,
+	                               1 to 16, 0 for no timestamps */
+	struct _mcand_frame* rx;  /**< RX ring storage */
+	uint16_t rx_size;         /**< RX ring size (holds rx_size - 1 frames) */
+	struct _mcand_frame* tx;  /**< TX ring storage */
+	uint16_t tx_size;         /**< TX ring size (holds tx_size - 1 frames) */
+	struct _mcand_tx_event* events; /**< TX event ring storage, NULL if the
+	                               Message RAM has no TX Event FIFO */
+	uint16_t events_size;     /**< TX event ring size */
+	mcand_callback_t callback; /**< optional interrupt callback */
+	void* cb_args;            /**< callback argument */
+
+	/* Run time state, managed by the driver */
+	volatile uint16_t rx_head;
+	volatile uint16_t rx_tail;
+	volatile uint16_t tx_head;
+	volatile uint16_t tx_tail;
+	volatile uint16_t evt_head;
+	volatile uint16_t evt_tail;
+	volatile uint32_t ts_wraps;
+	uint32_t it_mask;
+	uint8_t marker;
+	volatile bool bus_off;
+	struct _mcand_stats stats;
+};
+
+struct _mcand_isotp;
+
+/**
+ * \brief Callback invoked when an ISO-TP message has been received.
+ * \param isotp ISO-TP channel
+ * \param data received message (in isotp->rx_buffer)
+ * \param len message length
+ * \param arg user argument
+ */
+typedef void (*mcand_isotp_rx_cb_t)(struct _mcand_isotp* isotp,
+		const uint8_t* data, uint32_t len, void* arg);
+
+/**
+ * \brief Callback invoked when an ISO-TP transmission is over.
+ * \param isotp ISO-TP channel
+ * \param status MCAND_SUCCESS or an error code
+ * \param arg user argument
+ */
+typedef void (*mcand_isotp_tx_cb_t)(struct _mcand_isotp* isotp,
+		uint32_t status, void* arg);
+
+/** \brief ISO-TP channel: one pair of identifiers */
+struct _mcand_isotp {
+	/* Configuration, set by the user */
+	struct _mcand_desc* mcand;  /**< underlying mcand instance */
+	uint32_t tx_id;             /**< identifier of the frames we send */
+	uint32_t rx_id;             /**< identifier of the frames we accept */
+	uint8_t frame_len;          /**< TX_DL: 8 for CAN, 12 to 64 for CAN FD */
+	uint8_t block_size;         /**< BS we request, 0 for no limit */
+	uint8_t st_min;             /**< STmin we request, in ms */
+	uint16_t timeout;           /**< N_Bs / N_Cr timeout, in ms */
+	uint8_t* rx_buffer;         /**< reassembly buffer */
+	uint32_t rx_buffer_size;    /**< size of the reassembly buffer */
+	mcand_isotp_rx_cb_t rx_callback; /**< message received */
+	mcand_isotp_tx_cb_t tx_callback; /**< transmission over */
+	void* cb_args;              /**< callbacks argument */
+
+	/* Run time state, managed by the driver */
+	const uint8_t* tx_data;
+	uint32_t tx_len;
+	uint32_t tx_offset;
+	uint8_t tx_state;
+	uint8_t tx_sn;
+	uint8_t tx_bs_left;
+	uint32_t tx_st_min;         /**< separation time, in hrtimer ticks */
+	uint64_t tx_next;           /**< earliest time of the next CF */
+	struct _hrtimer tx_timer;   /**< N_Bs */
+	volatile bool tx_expired;
+	uint32_t rx_len;
+	uint32_t rx_offset;
+	uint8_t rx_state;
+	uint8_t rx_sn;
+	uint8_t rx_bs_left;
+	struct _hrtimer rx_timer;   /**< N_Cr */
+	volatile bool rx_expired;
+};
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Set up the interrupt-driven layer: timestamp counter, RX FIFO, TX
+ * Event FIFO, TX FIFO and Bus_Off interrupts, and interrupt vector.
+ * Shall be called after mcan_initialize() and before mcan_enable().
+ * \param desc mcand descriptor
+ * \return MCAND_SUCCESS or an error code
+ */
+extern uint32_t mcand_initialize(struct _mcand_desc* desc);
+
+/**
+ * \brief Disable the MCAN interrupts used by the driver and flush the rings.
+ * \param desc mcand descriptor
+ */
+extern void mcand_shutdown(struct _mcand_desc* desc);
+
+/**
+ * \brief Queue a frame for transmission.
+ * \param desc mcand descriptor
+ * \param id message identifier (CAN_STD_MSG_ID or CAN_EXT_MSG_ID | id)
+ * \param data frame data
+ * \param len data length: 0 to 8, 12, 16, 20, 24, 32, 48 or 64
+ * \param marker if not NULL, receives the marker of the matching TX event
+ * \return MCAND_SUCCESS, or MCAND_ERROR_BUSY if the TX ring is full
+ */
+extern uint32_t mcand_write(struct _mcand_desc* desc, uint32_t id,
+		const uint8_t* data, uint8_t len, uint8_t* marker);
+
+/**
+ * \brief Get the oldest received frame.
+ * \param desc mcand descriptor
+ * \param frame destination frame
+ * \return true if a frame has been copied, false if the RX ring is empty
+ */
+extern bool mcand_read(struct _mcand_desc* desc, struct _mcand_frame* frame);
+
+/**
+ * \brief Get the oldest TX event.
+ * \param desc mcand descriptor
+ * \param evt destination event
+ * \return true if an event has been copied, false if the ring is empty
+ */
+extern bool mcand_get_tx_event(struct _mcand_desc* desc,
+		struct _mcand_tx_event* evt);
+
+/**
+ * \brief Get the number of frames waiting in the RX ring.
+ */
+extern uint32_t mcand_get_rx_count(const struct _mcand_desc* desc);
+
+/**
+ * \brief Get the number of free entries in the TX ring.
+ */
+extern uint32_t mcand_get_tx_space(const struct _mcand_desc* desc);
+
+/**
+ * \brief Read the current extended timestamp, comparable with the
+ * timestamps of received frames and TX events.
+ * \param desc mcand descriptor
+ */
+extern uint32_t mcand_get_timestamp(struct _mcand_desc* desc);
+
+/**
+ * \brief Get the driver statistics.
+ * \param desc mcand descriptor
+ * \param stats destination statistics
+ */
+extern void mcand_get_stats(const struct _mcand_desc* desc,
+		struct _mcand_stats* stats);
+
+/**
+ * \brief Reset the run time state of an ISO-TP channel. The configuration
+ * fields shall be set beforehand, and the hrtimer service configured.
+ * \param isotp ISO-TP channel
+ * \return MCAND_SUCCESS or MCAND_INVALID_PARAM
+ */
+extern uint32_t mcand_isotp_initialize(struct _mcand_isotp* isotp);
+
+/**
+ * \brief Start sending a message. The data buffer shall remain valid until
+ * the tx_callback is invoked.
+ * \param isotp ISO-TP channel
+ * \param data message
+ * \param len message length, 1 to 2^32 - 1 bytes
+ * \return MCAND_SUCCESS, or MCAND_ERROR_BUSY if a message is being sent
+ */
+extern uint32_t mcand_isotp_send(struct _mcand_isotp* isotp,
+		const uint8_t* data, uint32_t len);
+
+/**
+ * \brief Feed a received frame to the ISO-TP channel. Frames whose
+ * identifier is not rx_id are ignored.
+ * \param isotp ISO-TP channel
+ * \param frame received frame
+ * \return true if the frame was consumed by this channel
+ */
+extern bool mcand_isotp_process(struct _mcand_isotp* isotp,
+		const struct _mcand_frame* frame);
+
+/**
+ * \brief Send the pending consecutive frames allowed by the flow control of
+ * the receiver, and check the protocol timeouts. Shall be called
+ * periodically from the main loop.
+ * \param isotp ISO-TP channel
+ */
+extern void mcand_isotp_poll(struct _mcand_isotp* isotp);
+
+#endif /* CONFIG_HAVE_MCAN */
+
+#endif /* _MCAND_H_ */
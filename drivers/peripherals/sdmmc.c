@@ -68,6 +68,7 @@
 #include "chip.h"
 #include "intmath.h"
 #include "timer.h"
+#include "peripherals/aic.h"
 #include "peripherals/pmc.h"
 #include "peripherals/tc.h"
 #include "misc/cache.h"
@@ -127,6 +128,9 @@ union uint32_u {
 	uint8_t bytes[4];
 };
 
+/** Driver instances, as found by the interrupt handler */
+static struct sdmmc_set *_sdmmc_sets[2];
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -735,6 +739,10 @@ static void sdmmc_poll(struct sdmmc_set *set)
 Fetch:
 	/* Fetch normal events */
 	events = regs->SDMMC_NISTR;
+	/* In interrupt mode, no interrupt signals the end of the Auto CMD12
+	 * delay, which lasts about a hundred device clock cycles: wait for it */
+	if (set->expect_auto_end && !set->use_polling)
+		while (set->timer->TC_SR & TC_SR_CLKSTA) ;
 	if (set->expect_auto_end && !(set->timer->TC_SR & TC_SR_CLKSTA))
 		events |= SDMMC_NISTR_CUSTOM_EVT;
 	if (!events)
@@ -1002,6 +1010,9 @@ End:
 	/* Clear residual normal interrupts, if any */
 	if (events)
 		regs->SDMMC_NISTR = events;
+	/* Stop signaling the events of this command */
+	regs->SDMMC_NISIER = 0;
+	regs->SDMMC_EISIER = 0;
 #if 0 && !defined(NDEBUG)
 	if (set->resp_len == 1)
 		trace_debug("CMD%u got response %08lx\n\r", cmd->bCmd,
@@ -1037,6 +1048,15 @@ End:
 		(cmd->fCallback)(cmd->bStatus, cmd->pArg);
 }
 
+static void sdmmc_irq_handler(void)
+{
+	uint32_t id = aic_get_current_interrupt_identifier();
+	struct sdmmc_set *set = _sdmmc_sets[id == ID_SDMMC0 ? 0 : 1];
+
+	if (set && set->state == MCID_CMD)
+		sdmmc_poll(set);
+}
+
 /**
  * \brief Check if the command is finished.
  */
@@ -1074,6 +1094,9 @@ static uint8_t sdmmc_cancel_command(struct sdmmc_set *set)
 		return SDMMC_OK;
 	}
 	assert(cmd);
+	/* Keep the interrupt handler off the command being cancelled */
+	regs->SDMMC_NISIER = 0;
+	regs->SDMMC_EISIER = 0;
 	/* Asynchronous Abort, if a data transfer has been started */
 	if (cmd->cmdOp.bmBits.xfrData == SDMMC_CMD_TX
 	    || cmd->cmdOp.bmBits.xfrData == SDMMC_CMD_RX) {
@@ -1096,7 +1119,8 @@ static uint8_t sdmmc_cancel_command(struct sdmmc_set *set)
 			timer_configure(10);
 			for (usec = 0; set->state == MCID_CMD && usec < 500000; usec+= 10) {
 				timer_sleep(1);
-				sdmmc_poll(set);
+				if (set->use_polling)
+					sdmmc_poll(set);
 			}
 			timer_configure(timer_res_prv);
 		}
@@ -1402,6 +1426,12 @@ static uint32_t sdmmc_control(void *_set, uint32_t bCtl, uint32_t param)
 		*param_u32 = 1;
 		break;
 
+	case SDMMC_IOCTL_GET_IRQMODE:
+		if (!param)
+			return SDMMC_ERROR_PARAM;
+		*param_u32 = set->use_polling ? 0 : 1;
+		break;
+
 	case SDMMC_IOCTL_BUSY_CHECK:
 		if (!param)
 			return SDMMC_ERROR_PARAM;
@@ -1636,6 +1666,12 @@ static uint32_t sdmmc_send_command(void *_set, sSdmmcCommand *cmd)
 	    | SDMMC_EISTR_DATEND | SDMMC_EISTR_DATCRC | SDMMC_EISTR_DATTEO
 	    | SDMMC_EISTR_CMDIDX | SDMMC_EISTR_CMDEND | SDMMC_EISTR_CMDCRC
 	    | SDMMC_EISTR_CMDTEO;
+	/* In interrupt mode, have the enabled events raise the interrupt */
+	if (!set->use_polling) {
+		regs->SDMMC_NISIER = SDMMC_NISIER_BRDRDY | SDMMC_NISIER_BWRRDY
+		    | SDMMC_NISIER_TRFC | SDMMC_NISIER_CMDC;
+		regs->SDMMC_EISIER = eister;
+	}
 
 	/* Issue the command */
 	if (has_data) {
@@ -1741,7 +1777,7 @@ bool sdmmc_initialize(struct sdmmc_set *set, Sdmmc *regs, uint32_t periph_id,
 	set->timer = &tc_module->TC_CHANNEL[tc_ch];
 	set->table_size = dma_buf ? dma_buf_size / SDMMC_DMADL_SIZE : 0;
 	set->table = set->table_size ? dma_buf : NULL;
-	set->use_polling = true;
+	set->use_polling = false;
 	set->use_set_blk_cnt = false;
 	set->state = MCID_OFF;
 
@@ -1798,6 +1834,11 @@ bool sdmmc_initialize(struct sdmmc_set *set, Sdmmc *regs, uint32_t periph_id,
 	else
 		regs->SDMMC_MC1R &= ~SDMMC_MC1R_FCD;
 
+	/* Have the command events processed by our interrupt handler */
+	_sdmmc_sets[periph_id == ID_SDMMC0 ? 0 : 1] = set;
+	aic_set_source_vector(periph_id, sdmmc_irq_handler);
+	aic_enable(periph_id);
+
 	return true;
 }
 
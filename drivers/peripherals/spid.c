@@ -39,6 +39,7 @@
 #include "misc/cache.h"
 
 #include "trace.h"
+#include "sched.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -86,6 +87,7 @@ void spid_configure(struct _spi_desc* desc)
 #endif
 	(void)spi_get_status(desc->addr);
 
+	sched_sem_init(&desc->done, 0);
 	spi_enable(desc->addr);
 }
 
@@ -95,6 +97,12 @@ void spid_begin_transfert(struct _spi_desc* desc)
 	spi_configure_cs_mode(desc->addr, desc->chip_select, SPI_KEEP_CS_OW);
 }
 
+static void _spid_release(struct _spi_desc* desc)
+{
+	mutex_unlock(&desc->mutex);
+	sched_sem_post(&desc->done);
+}
+
 static void _spid_dma_finish(struct dma_channel *channel, struct _spi_desc* desc)
 {
 	dma_free_channel(channel);
@@ -104,6 +112,7 @@ static void _spid_dma_finish(struct dma_channel *channel, struct _spi_desc* desc
 
 	if (desc->dma_unlocks_mutex)
 		mutex_unlock(&desc->mutex);
+	sched_sem_post(&desc->done);
 }
 
 static void _spid_dma_write_callback(struct dma_channel *channel, void *arg)
@@ -112,6 +121,19 @@ static void _spid_dma_write_callback(struct dma_channel *channel, void *arg)
 	_spid_dma_finish(channel, desc);
 }
 
+static void _spid_wait_dma(struct _spi_desc* desc, struct dma_channel* channel)
+{
+	while (!dma_is_transfer_done(channel)) {
+		if (dma_is_polling()) {
+			/* no interrupt signals the completion: poll */
+			dma_poll();
+		} else if (sched_sem_wait(&desc->done, SCHED_WAIT_FOREVER)) {
+			/* pass the completion on to other waiters */
+			sched_sem_post(&desc->done);
+		}
+	}
+}
+
 static void _spid_dma_write(struct _spi_desc* desc, bool wait_completion)
 {
 	struct dma_channel* w_channel = NULL;
@@ -158,7 +180,8 @@ static void _spid_dma_write(struct _spi_desc* desc, bool wait_completion)
 	dma_start_transfer(r_channel);
 
 	if (wait_completion) {
-		while (!dma_is_transfer_done(w_channel));
+		_spid_wait_dma(desc, w_channel);
+		sched_sem_init(&desc->done, 0);
 	}
 }
 
@@ -226,6 +249,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 			trace_error("SPID mutex already locked!\r\n");
 			return SPID_ERROR_LOCK;
 		}
+		sched_sem_init(&desc->done, 0);
 
 		if (tx) {
 			for (i = 0; i < tx->size; ++i)
@@ -240,7 +264,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 		if (cb)
 			cb(desc, user_args);
 
-		mutex_unlock(&desc->mutex);
+		_spid_release(desc);
 
 		break;
 
@@ -249,6 +273,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 			trace_error("SPID mutex already locked!\r\n");
 			return SPID_ERROR_LOCK;
 		}
+		sched_sem_init(&desc->done, 0);
 
 		if (tx) {
 			if (tx->size < SPID_DMA_THRESHOLD) {
@@ -257,7 +282,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 				if (!rx) {
 					if (cb)
 						cb(desc, user_args);
-					mutex_unlock(&desc->mutex);
+					_spid_release(desc);
 				}
 			} else {
 				desc->dma_region_start = tx->data;
@@ -282,7 +307,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 					rx->data[i] = spi_read(spi, desc->chip_select);
 				if (cb)
 					cb(desc, user_args);
-				mutex_unlock(&desc->mutex);
+				_spid_release(desc);
 			} else {
 				desc->dma_region_start = rx->data;
 				desc->dma_region_length = rx->size;
@@ -301,6 +326,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 			trace_error("SPID mutex already locked!\r\n");
 			return SPID_ERROR_LOCK;
 		}
+		sched_sem_init(&desc->done, 0);
 
 		if (tx)
 			spi_write_stream(spi, desc->chip_select, tx->data, tx->size);
@@ -311,7 +337,7 @@ uint32_t spid_transfert(struct _spi_desc* desc, struct _buffer* rx,
 		if (cb)
 			cb(desc, user_args);
 
-		mutex_unlock(&desc->mutex);
+		_spid_release(desc);
 
 		break;
 #endif
@@ -350,7 +376,15 @@ uint32_t spid_is_busy(const struct _spi_desc* desc)
 	return mutex_is_locked(&desc->mutex);
 }
 
-void spid_wait_transfert(const struct _spi_desc* desc)
+void spid_wait_transfert(struct _spi_desc* desc)
 {
-	while (spid_is_busy(desc)) {}
+	while (spid_is_busy(desc)) {
+		if (desc->transfert_mode == SPID_MODE_DMA && dma_is_polling()) {
+			/* no interrupt signals the completion: poll */
+			dma_poll();
+		} else if (sched_sem_wait(&desc->done, SCHED_WAIT_FOREVER)) {
+			/* pass the completion on to other waiters */
+			sched_sem_post(&desc->done);
+		}
+	}
 }
@@ -37,6 +37,7 @@
 
 #include <stdint.h>
 #include "mutex.h"
+#include "sched.h"
 #include "io.h"
 
 /*------------------------------------------------------------------------------
@@ -76,6 +77,7 @@ struct _spi_desc
 	bool            dma_unlocks_mutex;
 	void*           dma_region_start;
 	uint32_t        dma_region_length;
+	struct _sched_sem done; /* posted when a DMA transfer completes */
 };
 
 /*------------------------------------------------------------------------------
@@ -95,6 +97,6 @@ extern void spid_finish_transfert_callback(struct _spi_desc* desc,
 extern void spid_close(const struct _spi_desc* desc);
 
 extern uint32_t spid_is_busy(const struct _spi_desc* desc);
-extern void spid_wait_transfert(const struct _spi_desc* desc);
+extern void spid_wait_transfert(struct _spi_desc* desc);
 
 #endif /* SPID_HEADER__ */
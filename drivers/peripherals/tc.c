@@ -168,6 +168,13 @@ uint32_t tc_get_status(Tc *tc, uint32_t channel)
 	return tc->TC_CHANNEL[channel].TC_SR;
 }
 
+uint32_t tc_get_cv(Tc *tc, uint32_t channel)
+{
+	assert(channel < ARRAY_SIZE(tc->TC_CHANNEL));
+
+	return tc->TC_CHANNEL[channel].TC_CV;
+}
+
 void tc_trigger_on_freq(Tc *tc, uint32_t channel, uint32_t freq)
 {
 	uint32_t tcclks, rc;
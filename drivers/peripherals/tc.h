@@ -128,6 +128,14 @@ extern uint32_t tc_find_best_clock_source(Tc *tc, uint32_t freq);
  */
 extern uint32_t tc_get_status(Tc* tc, uint32_t channel);
 
+/**
+ * \brief Get the counter value of a Channel
+ * \param tc Pointer to Tc instance
+ * \param channel Channel number
+ * \return value of the counter
+ */
+extern uint32_t tc_get_cv(Tc* tc, uint32_t channel);
+
 /**
  * \brief Configure the TC to trigger on a given frequency
  * \param tc Pointer to Tc instance
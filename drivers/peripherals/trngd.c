@@ -0,0 +1,461 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \addtogroup trngd_module Working with TRNG driver
+ * \ingroup peripherals_module
+ * The TRNG driver provides a non-blocking random number service built on top
+ * of the TRNG peripheral.
+ * \n
+ *
+ * The TRNG interrupt (trng_enable_it()) fills an entropy pool in background.
+ * The pool is a single-producer/single-consumer ring: the interrupt handler
+ * only moves the head and the consumer only moves the tail, so no lock is
+ * needed. To avoid an interrupt every 84 clock cycles, the TRNG interrupt is
+ * disabled while the pool is full and re-enabled when the pool is drained.
+ *
+ * Random bytes are produced by a CTR-DRBG (NIST SP 800-90A, AES-128, no
+ * derivation function) which is reseeded from the entropy pool every
+ * TRNGD_RESEED_INTERVAL requests. If the pool does not hold enough entropy at
+ * that time, the reseed is postponed to a later request instead of waiting for
+ * the TRNG. The AES peripheral is used when CONFIG_HAVE_AES is defined, a
+ * software implementation is used otherwise.
+ *
+ * Small requests are served from a buffer of pre-generated bytes
+ * (TRNGD_CACHE_SIZE) to amortize the cost of the DRBG update step.
+ *
+ * Related files :\n
+ * \ref trngd.c\n
+ * \ref trngd.h\n
+ */
+/*@{*/
+/*@}*/
+
+/**
+ * \file
+ *
+ * Implementation of the TRNG driver (entropy pool and CTR-DRBG)
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "peripherals/pmc.h"
+#include "peripherals/trng.h"
+#include "peripherals/trngd.h"
+#ifdef CONFIG_HAVE_AES
+#include "peripherals/aes.h"
+#endif
+
+#include "intmath.h"
+#include "ring.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** AES block length, in bytes */
+#define BLOCK_LEN 16
+
+/** DRBG seed length (key + counter), in bytes */
+#define SEED_LEN (2 * BLOCK_LEN)
+
+/** DRBG seed length, in 32-bit words */
+#define SEED_WORDS (SEED_LEN / 4)
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _drbg {
+	uint8_t key[BLOCK_LEN];
+	uint8_t v[BLOCK_LEN];
+	uint32_t reseed_counter;
+#ifndef CONFIG_HAVE_AES
+	uint32_t round_keys[44];
+#endif
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile bool running;
+	uint32_t data[TRNGD_POOL_SIZE];
+} _pool;
+
+static struct _drbg _drbg;
+
+static uint8_t _cache[TRNGD_CACHE_SIZE];
+static uint32_t _cache_count;
+
+static struct _trngd_stats _stats;
+
+#ifndef CONFIG_HAVE_AES
+static const uint8_t _sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local functions: AES-128 block cipher
+ *----------------------------------------------------------------------------*/
+
+#ifdef CONFIG_HAVE_AES
+
+static void _aes_set_key(struct _drbg* drbg)
+{
+	uint32_t key[BLOCK_LEN / 4];
+
+	memcpy(key, drbg->key, BLOCK_LEN);
+	aes_soft_reset();
+	aes_configure(AES_MR_CIPHER_ENCRYPT | AES_MR_OPMOD_ECB |
+		AES_MR_KEYSIZE_AES128 | AES_MR_SMOD_MANUAL_START |
+		AES_MR_CKEY_PASSWD);
+	aes_write_key(key, BLOCK_LEN);
+}
+
+static void _aes_encrypt(const struct _drbg* drbg, const uint8_t* in,
+		uint8_t* out)
+{
+	uint32_t block[BLOCK_LEN / 4];
+
+	memcpy(block, in, BLOCK_LEN);
+	aes_set_input(block);
+	aes_start();
+	while (!(aes_get_status() & AES_ISR_DATRDY));
+	aes_get_output(block);
+	memcpy(out, block, BLOCK_LEN);
+}
+
+#else /* !CONFIG_HAVE_AES */
+
+static uint32_t _sub_word(uint32_t w)
+{
+	return _sbox[w & 0xff] | (_sbox[(w >> 8) & 0xff] << 8) |
+	       (_sbox[(w >> 16) & 0xff] << 16) | (_sbox[w >> 24] << 24);
+}
+
+static uint8_t _xtime(uint8_t x)
+{
+	return (x << 1) ^ ((x & 0x80) ? 0x1b : 0x00);
+}
+
+static void _aes_set_key(struct _drbg* drbg)
+{
+	uint32_t* rk = drbg->round_keys;
+	uint8_t rcon = 1;
+	int i;
+
+	/* words are stored little-endian: byte 0 of the key is in bits 7:0 */
+	memcpy(rk, drbg->key, BLOCK_LEN);
+	for (i = 4; i < 44; i++) {
+		uint32_t t = rk[i - 1];
+		if ((i & 3) == 0) {
+			t = _sub_word((t >> 8) | (t << 24)) ^ rcon;
+			rcon = _xtime(rcon);
+		}
+		rk[i] = rk[i - 4] ^ t;
+	}
+}
+
+static void _aes_encrypt(const struct _drbg* drbg, const uint8_t* in,
+		uint8_t* out)
+{
+	const uint8_t* rk = (const uint8_t*)drbg->round_keys;
+	uint8_t s[BLOCK_LEN], t[BLOCK_LEN];
+	int i, round;
+
+	for (i = 0; i < BLOCK_LEN; i++)
+		s[i] = in[i] ^ rk[i];
+
+	for (round = 1; round <= 10; round++) {
+		/* SubBytes + ShiftRows */
+		for (i = 0; i < BLOCK_LEN; i++)
+			t[i] = _sbox[s[(i + 4 * (i & 3)) & 15]];
+		/* MixColumns (skipped on last round) */
+		if (round < 10) {
+			for (i = 0; i < BLOCK_LEN; i += 4) {
+				uint8_t a0 = t[i], a1 = t[i + 1];
+				uint8_t a2 = t[i + 2], a3 = t[i + 3];
+				uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+				t[i] = a0 ^ all ^ _xtime(a0 ^ a1);
+				t[i + 1] = a1 ^ all ^ _xtime(a1 ^ a2);
+				t[i + 2] = a2 ^ all ^ _xtime(a2 ^ a3);
+				t[i + 3] = a3 ^ all ^ _xtime(a3 ^ a0);
+			}
+		}
+		/* AddRoundKey */
+		for (i = 0; i < BLOCK_LEN; i++)
+			s[i] = t[i] ^ rk[16 * round + i];
+	}
+
+	memcpy(out, s, BLOCK_LEN);
+}
+
+#endif /* CONFIG_HAVE_AES */
+
+/*----------------------------------------------------------------------------
+ *        Local functions: CTR-DRBG
+ *----------------------------------------------------------------------------*/
+
+static void _drbg_increment(uint8_t* v)
+{
+	int i;
+
+	for (i = BLOCK_LEN - 1; i >= 0; i--)
+		if (++v[i] != 0)
+			break;
+}
+
+/**
+ * \brief CTR_DRBG_Update: derive a new key/counter from the current state
+ * and optional provided data (SEED_LEN bytes).
+ */
+static void _drbg_update(struct _drbg* drbg, const uint8_t* provided)
+{
+	uint8_t temp[SEED_LEN];
+	int i;
+
+	_drbg_increment(drbg->v);
+	_aes_encrypt(drbg, drbg->v, temp);
+	_drbg_increment(drbg->v);
+	_aes_encrypt(drbg, drbg->v, temp + BLOCK_LEN);
+
+	if (provided)
+		for (i = 0; i < SEED_LEN; i++)
+			temp[i] ^= provided[i];
+
+	memcpy(drbg->key, temp, BLOCK_LEN);
+	memcpy(drbg->v, temp + BLOCK_LEN, BLOCK_LEN);
+	memset(temp, 0, sizeof(temp));
+	_aes_set_key(drbg);
+}
+
+static void _drbg_reseed(struct _drbg* drbg, const uint32_t* seed)
+{
+	_drbg_update(drbg, (const uint8_t*)seed);
+	drbg->reseed_counter = 1;
+}
+
+static void _drbg_generate(struct _drbg* drbg, uint8_t* out, uint32_t len)
+{
+	uint8_t block[BLOCK_LEN];
+
+	while (len >= BLOCK_LEN) {
+		_drbg_increment(drbg->v);
+		_aes_encrypt(drbg, drbg->v, out);
+		out += BLOCK_LEN;
+		len -= BLOCK_LEN;
+	}
+	if (len) {
+		_drbg_increment(drbg->v);
+		_aes_encrypt(drbg, drbg->v, block);
+		memcpy(out, block, len);
+		memset(block, 0, sizeof(block));
+	}
+
+	_drbg_update(drbg, NULL);
+	drbg->reseed_counter++;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions: entropy pool
+ *----------------------------------------------------------------------------*/
+
+static void _trngd_callback(uint32_t random_value, void* user_arg)
+{
+	(void)user_arg;
+
+	_pool.data[_pool.head] = random_value;
+	RING_INC(_pool.head, TRNGD_POOL_SIZE);
+
+	if (RING_SPACE(_pool.head, _pool.tail, TRNGD_POOL_SIZE) == 0) {
+		/* pool full: stop the interrupt until it is drained */
+		_pool.running = false;
+		trng_disable_it();
+	}
+}
+
+static void _trngd_start_pool(void)
+{
+	if (!_pool.running) {
+		_pool.running = true;
+		trng_enable_it(_trngd_callback, NULL);
+	}
+}
+
+static bool _trngd_pool_read(uint32_t* words, uint32_t count)
+{
+	uint32_t i;
+
+	if (RING_CNT(_pool.head, _pool.tail, TRNGD_POOL_SIZE) < count)
+		return false;
+
+	for (i = 0; i < count; i++) {
+		words[i] = _pool.data[_pool.tail];
+		_pool.data[_pool.tail] = 0;
+		RING_INC(_pool.tail, TRNGD_POOL_SIZE);
+	}
+
+	/* head only moves forward in the interrupt, it is safe to restart
+	 * the interrupt once some space has been freed */
+	_trngd_start_pool();
+	return true;
+}
+
+static void _trngd_check_reseed(void)
+{
+	uint32_t seed[SEED_WORDS];
+
+	if (_drbg.reseed_counter < TRNGD_RESEED_INTERVAL)
+		return;
+
+	if (_trngd_pool_read(seed, SEED_WORDS)) {
+		_drbg_reseed(&_drbg, seed);
+		memset(seed, 0, sizeof(seed));
+		_stats.reseeds++;
+	} else {
+		_stats.late_reseeds++;
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void trngd_initialize(void)
+{
+	uint32_t seed[SEED_WORDS];
+	int i;
+
+	memset(&_pool, 0, sizeof(_pool));
+	memset(&_drbg, 0, sizeof(_drbg));
+	memset(&_stats, 0, sizeof(_stats));
+	_cache_count = 0;
+
+	trng_enable();
+#ifdef CONFIG_HAVE_AES
+	pmc_enable_peripheral(ID_AES);
+#endif
+
+	/* Instantiate: the initial seed is read synchronously (this is the
+	 * only place where the driver waits for the TRNG) */
+	for (i = 0; i < SEED_WORDS; i++)
+		seed[i] = trng_get_random_data();
+	_aes_set_key(&_drbg);
+	_drbg_reseed(&_drbg, seed);
+	memset(seed, 0, sizeof(seed));
+
+	_trngd_start_pool();
+}
+
+void trngd_get_random(void* buffer, uint32_t len)
+{
+	uint8_t* out = (uint8_t*)buffer;
+	uint32_t count;
+
+	_stats.generated += len;
+
+	/* serve from the cache first */
+	count = min_u32(len, _cache_count);
+	if (count) {
+		memcpy(out, &_cache[TRNGD_CACHE_SIZE - _cache_count], count);
+		memset(&_cache[TRNGD_CACHE_SIZE - _cache_count], 0, count);
+		_cache_count -= count;
+		out += count;
+		len -= count;
+	}
+	if (!len)
+		return;
+
+#ifdef CONFIG_HAVE_AES
+	/* the AES peripheral may have been used by someone else */
+	_aes_set_key(&_drbg);
+#endif
+	_trngd_check_reseed();
+
+	if (len >= TRNGD_CACHE_SIZE) {
+		/* large request: generate directly into the user buffer */
+		_drbg_generate(&_drbg, out, len);
+	} else {
+		/* small request: refill the cache */
+		_drbg_generate(&_drbg, _cache, TRNGD_CACHE_SIZE);
+		memcpy(out, _cache, len);
+		memset(_cache, 0, len);
+		_cache_count = TRNGD_CACHE_SIZE - len;
+	}
+}
+
+uint32_t trngd_get_random_word(void)
+{
+	uint32_t value;
+	trngd_get_random(&value, sizeof(value));
+	return value;
+}
+
+uint32_t trngd_get_pool_count(void)
+{
+	return RING_CNT(_pool.head, _pool.tail, TRNGD_POOL_SIZE);
+}
+
+void trngd_request_reseed(void)
+{
+	_drbg.reseed_counter = TRNGD_RESEED_INTERVAL;
+	_cache_count = 0;
+}
+
+void trngd_get_stats(struct _trngd_stats* stats)
+{
+	*stats = _stats;
+}
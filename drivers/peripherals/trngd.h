@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _TRNGD_H_
+#define _TRNGD_H_
+
+#ifdef CONFIG_HAVE_TRNG
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*------------------------------------------------------------------------------
+ *         Definitions
+ *------------------------------------------------------------------------------*/
+
+/** Size of the entropy pool, in 32-bit words (any size, the RING_xxx indexes
+ * wrap by compare, one word is always left free) */
+#define TRNGD_POOL_SIZE 64
+
+/** Number of generate requests between two reseeds of the DRBG */
+#define TRNGD_RESEED_INTERVAL 1024
+
+/** Size of the buffer of pre-generated bytes used for small requests */
+#define TRNGD_CACHE_SIZE 64
+
+/*------------------------------------------------------------------------------
+ *         Types
+ *------------------------------------------------------------------------------*/
+
+/** \brief TRNG driver statistics */
+struct _trngd_stats {
+	uint32_t reseeds;       /**< number of DRBG reseeds */
+	uint32_t late_reseeds;  /**< reseeds delayed because pool was empty */
+	uint32_t generated;     /**< number of bytes generated */
+};
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize the TRNG driver: enable the TRNG, instantiate the DRBG
+ * from fresh TRNG output and start filling the entropy pool in background
+ * using the TRNG interrupt.
+ */
+extern void trngd_initialize(void);
+
+/**
+ * \brief Fill a buffer with random bytes from the DRBG. This function never
+ * waits for the TRNG: the DRBG is reseeded from the entropy pool when enough
+ * entropy is available.
+ *
+ * This function is not reentrant and must not be called from interrupt
+ * context.
+ *
+ * \param buffer destination buffer
+ * \param len number of bytes to generate
+ */
+extern void trngd_get_random(void* buffer, uint32_t len);
+
+/**
+ * \brief Return a 32-bit random value from the DRBG.
+ */
+extern uint32_t trngd_get_random_word(void);
+
+/**
+ * \brief Return the number of 32-bit words currently available in the
+ * entropy pool.
+ */
+extern uint32_t trngd_get_pool_count(void);
+
+/**
+ * \brief Force a reseed of the DRBG on next request.
+ */
+extern void trngd_request_reseed(void);
+
+/**
+ * \brief Get the driver statistics.
+ */
+extern void trngd_get_stats(struct _trngd_stats* stats);
+
+#endif /* CONFIG_HAVE_TRNG */
+
+#endif /* _TRNGD_H_ */
@@ -44,6 +44,7 @@
 
 #include "trace.h"
 #include "io.h"
+#include "sched.h"
 #include "timer.h"
 
 #include <assert.h>
@@ -79,6 +80,12 @@ static uint32_t _twid_wait_twi_transfer(struct _twi_desc* desc)
 	return TWID_SUCCESS;
 }
 
+static void _twid_release(struct _twi_desc* desc)
+{
+	mutex_unlock(&desc->mutex);
+	sched_sem_post(&desc->done);
+}
+
 static void _twid_dma_finish(struct dma_channel* channel, struct _twi_desc* desc)
 {
 	dma_free_channel(channel);
@@ -86,7 +93,7 @@ static void _twid_dma_finish(struct dma_channel* channel, struct _twi_desc* desc
 	if (desc->callback)
 		desc->callback(desc, desc->cb_args);
 
-	mutex_unlock(&desc->mutex);
+	_twid_release(desc);
 }
 
 static void _twid_dma_read_callback(struct dma_channel* channel, void* args)
@@ -223,7 +230,7 @@ static void _twid_handler(void)
 	}
 
 	struct _async_desc* adesc = &async_desc[i];
-	addr = adesc->twi_desc.addr;
+	addr = adesc->twi_desc->addr;
 	status = twi_get_masked_status(addr);
 
 	if (TWI_STATUS_RXRDY(status)) {
@@ -258,9 +265,9 @@ static void _twid_handler(void)
 		twi_disable_it(addr, TWI_IDR_TXCOMP);
 		adesc->pdata = 0;
 		adesc->twi_id = 0;
-		if (adesc->twi_desc.callback)
-			adesc->twi_desc.callback(&adesc->twi_desc, adesc->twi_desc.cb_args);
-		mutex_unlock(&adesc->twi_desc.mutex);
+		if (adesc->twi_desc->callback)
+			adesc->twi_desc->callback(adesc->twi_desc, adesc->twi_desc->cb_args);
+		_twid_release(adesc->twi_desc);
 	}
 }
 
@@ -295,6 +302,7 @@ void twid_configure(struct _twi_desc* desc)
 #endif
 
 	desc->mutex = 0;
+	sched_sem_init(&desc->done, 0);
 }
 
 /*
@@ -427,6 +435,7 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 
 	if (!mutex_try_lock(&desc->mutex))
 		return TWID_ERROR_LOCK;
+	sched_sem_init(&desc->done, 0);
 
 	desc->callback = cb;
 	desc->cb_args = user_args;
@@ -442,8 +451,8 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 	switch (tmode) {
 
 	case TWID_MODE_ASYNC:
-		/* Copy descriptor to async descriptor */
-		async_desc[adesc_index].twi_desc = *desc;
+		/* Bind descriptor to async descriptor */
+		async_desc[adesc_index].twi_desc = desc;
 		/* Init param used by interrupt handler */
 		async_desc[adesc_index].pdata = NULL;
 		id = get_twi_id_from_addr(desc->addr);
@@ -483,7 +492,7 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 		}
 		if (status == TWID_SUCCESS && cb)
 			cb(desc, user_args);
-		mutex_unlock(&desc->mutex);
+		_twid_release(desc);
 		break;
 
 	case TWID_MODE_DMA:
@@ -492,7 +501,7 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 				status = _twid_poll_write(desc, tx);
 				if (status == TWID_SUCCESS && cb)
 					cb(desc, user_args);
-				mutex_unlock(&desc->mutex);
+				_twid_release(desc);
 			} else {
 #ifdef CONFIG_HAVE_TWI_ALTERNATE_CMD
 				twi_init_write_transfert(desc->addr,
@@ -510,7 +519,7 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 				status = _twid_poll_read(desc, rx);
 				if (status == TWID_SUCCESS && cb)
 					cb(desc, user_args);
-				mutex_unlock(&desc->mutex);
+				_twid_release(desc);
 			} else {
 
 #ifdef CONFIG_HAVE_TWI_ALTERNATE_CMD
@@ -524,7 +533,7 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 				desc->region_length = rx->size;
 				status = _check_nack(desc->addr);
 				if (status != TWID_SUCCESS) {
-					mutex_unlock(&desc->mutex);
+					_twid_release(desc);
 					break;
 				}
 				_twid_dma_read(desc, rx);
@@ -539,25 +548,19 @@ uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx, struct _buff
 						  desc->iaddr, desc->isize,
 						  tx->data, tx->size, desc->timeout);
 			status = status ? TWID_SUCCESS : TWID_ERROR_ACK;
-			if (status)
-				break;
-			status = _twid_wait_twi_transfer(desc);
-			if (status)
-				break;
+			if (status == TWID_SUCCESS)
+				status = _twid_wait_twi_transfer(desc);
 		} else {
 			status = twi_read_stream(desc->addr, desc->slave_addr,
 						 desc->iaddr, desc->isize,
 						 rx->data, rx->size, desc->timeout);
 			status = status ? TWID_SUCCESS : TWID_ERROR_ACK;
-			if (status)
-				break;
-			status = _twid_wait_twi_transfer(desc);
-			if (status)
-				break;
+			if (status == TWID_SUCCESS)
+				status = _twid_wait_twi_transfer(desc);
 		}
-		if (cb != NULL)
+		if (status == TWID_SUCCESS && cb != NULL)
 			cb(desc, user_args);
-		mutex_unlock(&desc->mutex);
+		_twid_release(desc);
 		break;
 #endif
 
@@ -573,7 +576,15 @@ uint32_t twid_is_busy(const struct _twi_desc* desc)
 	return mutex_is_locked(&desc->mutex);
 }
 
-void twid_wait_transfert(const struct _twi_desc* desc)
+void twid_wait_transfert(struct _twi_desc* desc)
 {
-	while (twid_is_busy(desc));
+	while (twid_is_busy(desc)) {
+		if (desc->transfert_mode == TWID_MODE_DMA && dma_is_polling()) {
+			/* no interrupt signals the completion: poll */
+			dma_poll();
+		} else if (sched_sem_wait(&desc->done, SCHED_WAIT_FOREVER)) {
+			/* pass the completion on to other waiters */
+			sched_sem_post(&desc->done);
+		}
+	}
 }
@@ -37,6 +37,7 @@
 #include "peripherals/twi.h"
 #include "peripherals/dma.h"
 #include "mutex.h"
+#include "sched.h"
 #include "io.h"
 
 /*------------------------------------------------------------------------------
@@ -92,12 +93,14 @@ struct _twi_desc
 			struct dma_xfer_cfg cfg;
 		} tx;
 	} dma;
+
+	struct _sched_sem done; /**< posted when a transfer completes */
 };
 
 /** \brief twi asynchronous transfer descriptor.*/
 struct _async_desc
 {
-	struct _twi_desc twi_desc;
+	struct _twi_desc* twi_desc;
 	uint32_t twi_id;
 	uint8_t *pdata; /**< Pointer to the data buffer. */
 	uint32_t size; /**< Total number of bytes to transfer. */
@@ -116,6 +119,10 @@ extern uint32_t twid_transfert(struct _twi_desc* desc, struct _buffer* rx,
 
 extern uint32_t twid_is_busy(const struct _twi_desc* desc);
 
-extern void twid_wait_transfert(const struct _twi_desc* desc);
+/**
+ * \brief Wait for the end of the current transfer. The calling thread
+ * blocks until the transfer completes when the scheduler runs.
+ */
+extern void twid_wait_transfert(struct _twi_desc* desc);
 
 #endif /* TWID_H_ */
@@ -40,6 +40,7 @@
 
 #include "trace.h"
 #include "mutex.h"
+#include "sched.h"
 
 #include <assert.h>
 #include <string.h>
@@ -124,6 +125,7 @@ void usartd_configure(struct _usart_desc* desc)
 #endif
 	pmc_enable_peripheral(id);
 	usart_configure(desc->addr, desc->mode, desc->baudrate);
+	sched_sem_init(&desc->done, 0);
 
 #ifdef CONFIG_HAVE_USART_FIFO
 	if (desc->transfert_mode == USARTD_MODE_FIFO) {
@@ -149,6 +151,7 @@ uint32_t usartd_transfert(struct _usart_desc* desc, struct _buffer* rx,
 	if (!mutex_try_lock(&desc->mutex)) {
 		return USARTD_ERROR_LOCK;
 	}
+	sched_sem_init(&desc->done, 0);
 
 	switch (desc->transfert_mode) {
 	case USARTD_MODE_POLLING:
@@ -162,12 +165,13 @@ uint32_t usartd_transfert(struct _usart_desc* desc, struct _buffer* rx,
 				rx->data[i] = usart_get_char(desc->addr);
 			}
 		}
-		mutex_unlock(&desc->mutex);
+		usartd_finish_transfert(desc);
 		if (cb)
 			cb(desc, user_args);
 		break;
 	case USARTD_MODE_DMA:
 		if (!(rx || tx)) {
+			usartd_finish_transfert(desc);
 			return USARTD_ERROR_DUPLEX;
 		}
 
@@ -178,7 +182,7 @@ uint32_t usartd_transfert(struct _usart_desc* desc, struct _buffer* rx,
 				}
 				if (cb)
 					cb(desc, user_args);
-				mutex_unlock(&desc->mutex);
+				usartd_finish_transfert(desc);
 			} else {
 				desc->region_start = tx->data;
 				desc->region_length = tx->size;
@@ -191,14 +195,14 @@ uint32_t usartd_transfert(struct _usart_desc* desc, struct _buffer* rx,
 				}
 				if (cb)
 					cb(desc, user_args);
-				mutex_unlock(&desc->mutex);
+				usartd_finish_transfert(desc);
 			} else {
 				desc->region_start = rx->data;
 				desc->region_length = rx->size;
 				_usartd_dma_read(desc, rx);
 			}
 		} else {
-			mutex_unlock(&desc->mutex);
+			usartd_finish_transfert(desc);
 		}
 		break;
 
@@ -210,7 +214,7 @@ uint32_t usartd_transfert(struct _usart_desc* desc, struct _buffer* rx,
 		if (rx) {
 			usart_read_stream(desc->addr, rx->data, rx->size);
 		}
-		mutex_unlock(&desc->mutex);
+		usartd_finish_transfert(desc);
 		if (cb)
 			cb(desc, user_args);
 		break;
@@ -232,6 +236,7 @@ void usartd_finish_transfert_callback(struct _usart_desc* desc,
 void usartd_finish_transfert(struct _usart_desc* desc)
 {
 	mutex_unlock(&desc->mutex);
+	sched_sem_post(&desc->done);
 }
 
 uint32_t usartd_is_busy(const struct _usart_desc* desc)
@@ -239,7 +244,15 @@ uint32_t usartd_is_busy(const struct _usart_desc* desc)
 	return mutex_is_locked(&desc->mutex);
 }
 
-void usartd_wait_transfert(const struct _usart_desc* desc)
+void usartd_wait_transfert(struct _usart_desc* desc)
 {
-	while (mutex_is_locked(&desc->mutex));
+	while (mutex_is_locked(&desc->mutex)) {
+		if (desc->transfert_mode == USARTD_MODE_DMA && dma_is_polling()) {
+			/* no interrupt signals the completion: poll */
+			dma_poll();
+		} else if (sched_sem_wait(&desc->done, SCHED_WAIT_FOREVER)) {
+			/* pass the completion on to other waiters */
+			sched_sem_post(&desc->done);
+		}
+	}
 }
@@ -31,6 +31,7 @@
 #define USARTD_HEADER__
 
 #include "mutex.h"
+#include "sched.h"
 #include "io.h"
 
 #define USARTD_SUCCESS         (0)
@@ -55,6 +56,7 @@ struct _usart_desc
 	uint32_t region_length;
 	usartd_callback_t callback;
 	void*   cb_args;
+	struct _sched_sem done; /**< posted when a transfer completes */
 };
 
 enum _usartd_trans_mode
@@ -72,6 +74,6 @@ extern void usartd_finish_transfert_callback(struct _usart_desc* desc,
 				      void* user_args);
 extern void usartd_finish_transfert(struct _usart_desc* desc);
 extern uint32_t usartd_is_busy(const struct _usart_desc* desc);
-extern void usartd_wait_transfert(const struct _usart_desc* desc);
+extern void usartd_wait_transfert(struct _usart_desc* desc);
 
 #endif /* USARTD_HEADER__ */
@@ -89,6 +89,7 @@ struct _xdmad_channel
 	uint8_t          src_rxif;  /**< Source RX Interface ID */
 	uint8_t          dest_txif; /**< Destination TX Interface ID */
 	uint8_t          dest_rxif; /**< Destination RX Interface ID */
+	bool             item_cb;   /**< Callback at end of each LLI */
 	volatile uint8_t state;     /**< Channel State */
 };
 
@@ -164,6 +165,12 @@ static void xdmad_handler(void)
 					channel->state = XDMAD_STATE_DONE;
 					exec = 1;
 				}
+			} else if (channel->item_cb) {
+				/* Channel still running, end of a linked list item */
+				uint32_t cis = xdmac_get_channel_isr(xdmac, chan);
+
+				if (cis & XDMAC_CIS_BIS)
+					exec = 1;
 			}
 
 			/* Execute callback */
@@ -198,6 +205,7 @@ void xdmad_initialize(bool polling)
 			channel->src_rxif = 0;
 			channel->dest_txif = 0;
 			channel->dest_rxif = 0;
+			channel->item_cb = false;
 			channel->state = XDMAD_STATE_FREE;
 		}
 
@@ -216,6 +224,11 @@ void xdmad_poll(void)
 		xdmad_handler();
 }
 
+bool xdmad_is_polling(void)
+{
+	return _xdmad.polling;
+}
+
 struct _xdmad_channel *xdmad_allocate_channel(uint8_t src, uint8_t dest)
 {
 	uint32_t i;
@@ -335,6 +348,8 @@ uint32_t xdmad_configure_transfer(struct _xdmad_channel *channel,
 	Xdmac *xdmac = channel->xdmac;
 	const uint32_t first_view = desc_cntrl & XDMAC_CNDC_NDVIEW_Msk;
 
+	channel->item_cb = false;
+
 	cfg->cfg &= ~XDMAC_CC_PERID_Msk;
 	if ((cfg->cfg & XDMAC_CC_TYPE_PER_TRAN) == XDMAC_CC_TYPE_PER_TRAN) {
 		if ((cfg->cfg & XDMAC_CC_DSYNC) == XDMAC_CC_DSYNC_PER2MEM) {
@@ -388,6 +403,19 @@ uint32_t xdmad_configure_transfer(struct _xdmad_channel *channel,
 	return XDMAD_OK;
 }
 
+uint32_t xdmad_enable_item_callback(struct _xdmad_channel *channel)
+{
+	if (channel->state == XDMAD_STATE_FREE)
+		return XDMAD_ERROR;
+	else if (channel->state == XDMAD_STATE_STARTED)
+		return XDMAD_BUSY;
+
+	channel->item_cb = true;
+	xdmac_enable_channel_it(channel->xdmac, channel->id, XDMAC_CIE_BIE);
+
+	return XDMAD_OK;
+}
+
 uint32_t xdmad_start_transfer(struct _xdmad_channel *channel)
 {
 	if (channel->state == XDMAD_STATE_FREE)
@@ -175,6 +175,12 @@ extern void xdmad_initialize(bool polling);
  */
 extern void xdmad_poll(void);
 
+/**
+ * \brief Tell whether the driver was initialized in polling mode, in which
+ * case no interrupt signals the completion of the transfers.
+ */
+extern bool xdmad_is_polling(void);
+
 /**
  * \brief Allocate an DMA channel
  * \param src Source peripheral ID, XDMAD_PERIPH_MEMORY for memory.
@@ -209,6 +215,13 @@ extern uint32_t xdmad_set_callback(struct _xdmad_channel *channel,
 extern uint32_t xdmad_configure_transfer(struct _xdmad_channel *channel,
 		struct _xdmad_cfg *cfg, uint32_t desc_cntrl, void *desc_addr);
 
+/**
+ * \brief Invoke the callback at the end of each linked list item, while
+ * the channel goes on (circular lists). Call after xdmad_configure_transfer.
+ * \param channel Channel pointer
+ */
+extern uint32_t xdmad_enable_item_callback(struct _xdmad_channel *channel);
+
 /**
  * \brief Start DMA transfer.
  * \param channel Channel pointer
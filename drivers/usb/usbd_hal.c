@@ -44,8 +44,10 @@
  *---------------------------------------------------------------------------*/
 
 #include "chip.h"
+#include "ring.h"
 #include "trace.h"
 
+#include "core/irq.h"
 #include "peripherals/aic.h"
 #include "misc/cache.h"
 #include "peripherals/pmc.h"
@@ -105,6 +107,8 @@
  *  - UDPHS_ENDPOINT_RECEIVING
  *  - UDPHS_ENDPOINT_SENDINGM
  *  - UDPHS_ENDPOINT_RECEIVINGM
+ *  - UDPHS_ENDPOINT_SENDINGQ
+ *  - UDPHS_ENDPOINT_RECEIVINGQ
  */
 enum _endpoint_state {
 	/**  Endpoint is disabled */
@@ -127,6 +131,12 @@ enum _endpoint_state {
 
 	/**  Endpoint is receiving MBL */
 	UDPHS_ENDPOINT_RECEIVINGM,
+
+	/**  Endpoint is sending queued buffers */
+	UDPHS_ENDPOINT_SENDINGQ,
+
+	/**  Endpoint is receiving queued buffers */
+	UDPHS_ENDPOINT_RECEIVINGQ,
 };
 
 /** Describes a single buffer transfer */
@@ -181,7 +191,7 @@ struct _endpoint {
 	volatile uint16_t size;
 
 	/**  Describes an ongoing transfer (if current state is either
-	 *   UDPHS_ENDPOINT_SENDING[M] or UDPHS_ENDPOINT_RECEIVING[M]) */
+	 *   UDPHS_ENDPOINT_SENDING[M|Q] or UDPHS_ENDPOINT_RECEIVING[M|Q]) */
 	struct {
 		/**  Optional callback to invoke when the transfer completes. */
 		usbd_xfer_cb_t callback;
@@ -192,9 +202,13 @@ struct _endpoint {
 		/**  Transfer type */
 		bool use_multi;
 
+		/**  Queued transfer mode */
+		bool use_queue;
+
 		union {
 			struct _single_xfer single;
 			struct _multi_xfer  multi;
+			struct _usbd_queue *queue;
 		};
 	} transfer;
 
@@ -202,16 +216,6 @@ struct _endpoint {
 	uint32_t send_zlp;
 };
 
-/**
- * DMA Descriptor.
- */
-struct _udphs_dma_desc {
-	void     *next;
-	void     *addr;
-	uint32_t  ctrl;
-	uint32_t  reserved; /** reverved (padding) */
-};
-
 /*---------------------------------------------------------------------------
  *      Internal constants
  *---------------------------------------------------------------------------*/
@@ -238,7 +242,7 @@ static struct _endpoint endpoints[CHIP_USB_ENDPOINTS];
 static bool force_full_speed = false;
 
 /** DMA link list */
-CACHE_ALIGNED static struct _udphs_dma_desc dma_desc[4];
+CACHE_ALIGNED static struct _usbd_dma_desc dma_desc[4];
 
 /*---------------------------------------------------------------------------
  *      Internal Functions
@@ -366,6 +370,28 @@ static void udphs_end_of_transfer(uint8_t ep, uint8_t status)
 			}
 		}
 		break;
+	case UDPHS_ENDPOINT_RECEIVINGQ:
+	case UDPHS_ENDPOINT_SENDINGQ:
+		{
+			struct _usbd_queue *queue = endpoint->transfer.queue;
+
+			USB_HAL_TRACE("EoQT[%s%d] ",
+					endpoint->state == UDPHS_ENDPOINT_RECEIVINGQ ? "R" : "S",
+					(unsigned)ep);
+
+			/* Stop the channel and drop all queued buffers */
+			UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL = 0;
+			endpoint->state = UDPHS_ENDPOINT_IDLE;
+			while (!RING_EMPTY(queue->head, queue->tail)) {
+				void *data = queue->desc[queue->tail].addr;
+				RING_INC(queue->tail, queue->size);
+				if (queue->callback)
+					queue->callback(queue->callback_arg,
+							status, data, 0);
+			}
+			queue->start = queue->tail;
+		}
+		break;
 	default:
 		break;
 	}
@@ -688,6 +714,132 @@ static void udphs_endpoint_handler(uint8_t ep)
 	}
 }
 
+/**
+ * Returns the length of the buffer described by a queue DMA descriptor.
+ * \param desc Pointer to the descriptor.
+ */
+static uint32_t udphs_queue_desc_length(const struct _usbd_dma_desc *desc)
+{
+	uint32_t len = (desc->ctrl & UDPHS_DMACONTROL_BUFF_LENGTH_Msk)
+		>> UDPHS_DMACONTROL_BUFF_LENGTH_Pos;
+
+	return len ? len : DMA_MAX_FIFO_SIZE;
+}
+
+/**
+ * Hands the queued buffers that are not started yet to the DMA channel.
+ * IN buffers are chained through the next descriptor pointer, so the
+ * controller fills one bank while the other one is on the bus and never
+ * has to wait for software between buffers. OUT buffers are started one
+ * at a time: a short packet ends the buffer early and its byte count is
+ * only available until the next descriptor is loaded.
+ * Must be called with the UDPHS interrupt masked or from the handler.
+ * \param ep Endpoint number.
+ */
+static void udphs_queue_start(uint8_t ep)
+{
+	struct _endpoint *endpoint = &endpoints[ep];
+	struct _usbd_queue *queue = endpoint->transfer.queue;
+	bool sending = (UDPHS->UDPHS_EPT[ep].UDPHS_EPTCFG & UDPHS_EPTCFG_EPT_DIR) != 0;
+	uint16_t first = queue->start;
+	uint16_t i = first;
+	struct _usbd_dma_desc *desc;
+
+	if (RING_EMPTY(queue->head, queue->start))
+		return;
+
+	endpoint->state = sending ?
+		UDPHS_ENDPOINT_SENDINGQ : UDPHS_ENDPOINT_RECEIVINGQ;
+
+	/* Link buffers, the last one stops the channel */
+	do {
+		desc = &queue->desc[i];
+		RING_INC(i, queue->size);
+		if (sending && i != queue->head) {
+			desc->next = &queue->desc[i];
+			desc->ctrl |= UDPHS_DMACONTROL_LDNXT_DSC;
+		} else {
+			desc->next = NULL;
+			desc->ctrl &= ~UDPHS_DMACONTROL_LDNXT_DSC;
+		}
+	} while (sending && i != queue->head);
+	queue->start = i;
+
+	USB_HAL_TRACE("StartQ%d(%d) ", ep,
+			(int)RING_CNT(queue->start, first, queue->size));
+
+	/* Flush DMA descriptors */
+	cache_clean_region(queue->desc,
+			queue->size * sizeof(struct _usbd_dma_desc));
+
+	/* Interrupt enable */
+	UDPHS->UDPHS_IEN |= UDPHS_IEN_DMA_1 << (ep - 1);
+
+	/* Start transfer with LLI */
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMANXTDSC = (uint32_t)&queue->desc[first];
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL = 0;
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL = UDPHS_DMACONTROL_LDNXT_DSC;
+}
+
+/**
+ * DMA interrupt handler for queued transfers.
+ * Reports every completed buffer, then restarts the channel on the
+ * buffers queued meanwhile once the running chain has ended.
+ * \param ep Endpoint number.
+ * \param dma_status Value of the DMA status register.
+ */
+static void udphs_queue_dma_handler(uint8_t ep, uint32_t dma_status)
+{
+	struct _endpoint *endpoint = &endpoints[ep];
+	struct _usbd_queue *queue = endpoint->transfer.queue;
+	bool sending = endpoint->state == UDPHS_ENDPOINT_SENDINGQ;
+	uint16_t done;
+
+	if (!(dma_status & (UDPHS_DMASTATUS_CHANN_ENB | UDPHS_DMASTATUS_CHANN_ACT))) {
+		/* Channel stopped, all started buffers are complete */
+		done = queue->start;
+	} else {
+		/* The buffer in progress precedes the next descriptor */
+		uint32_t next = UDPHS->UDPHS_DMA[ep].UDPHS_DMANXTDSC;
+		if (next)
+			done = (next - (uint32_t)queue->desc) /
+				sizeof(struct _usbd_dma_desc);
+		else
+			done = queue->start;
+		RING_DEC(done, queue->size);
+	}
+
+	USB_HAL_TRACE("iDmaQ%d,%d ", ep,
+			(int)RING_CNT(done, queue->tail, queue->size));
+
+	while (queue->tail != done) {
+		struct _usbd_dma_desc *desc = &queue->desc[queue->tail];
+		uint32_t transferred = udphs_queue_desc_length(desc);
+
+		if (!sending) {
+			/* BUFF_COUNT holds the number of bytes not received */
+			transferred -= (dma_status & UDPHS_DMASTATUS_BUFF_COUNT_Msk)
+				>> UDPHS_DMASTATUS_BUFF_COUNT_Pos;
+			if (transferred)
+				cache_invalidate_region(desc->addr, transferred);
+		}
+
+		/* Release the slot before the callback may queue again */
+		RING_INC(queue->tail, queue->size);
+		if (RING_EMPTY(queue->head, queue->tail))
+			endpoint->state = UDPHS_ENDPOINT_IDLE;
+
+		if (queue->callback)
+			queue->callback(queue->callback_arg,
+					USBD_STATUS_SUCCESS, desc->addr,
+					transferred);
+	}
+
+	/* Chain ended, continue with buffers queued meanwhile */
+	if (queue->tail == queue->start)
+		udphs_queue_start(ep);
+}
+
 /**
  * DMA Single transfer
  * \param ep EP number
@@ -733,6 +885,13 @@ static void udphs_dma_handler(uint8_t ep)
 		return;
 	}
 
+	/* Queued transfer */
+	if (endpoint->state == UDPHS_ENDPOINT_SENDINGQ ||
+		endpoint->state == UDPHS_ENDPOINT_RECEIVINGQ) {
+		udphs_queue_dma_handler(ep, dma_status);
+		return;
+	}
+
 	/* Disable DMA interrupt to avoid receiving 2 (B_EN and TR_EN) */
 	UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL &=
 		~(UDPHS_DMACONTROL_END_TR_EN | UDPHS_DMACONTROL_END_B_EN);
@@ -1009,6 +1168,66 @@ static uint8_t udphs_read(uint8_t ep, void *data, uint32_t data_len)
 	return USBD_STATUS_SUCCESS;
 }
 
+/**
+ * Queues a buffer on an endpoint configured for queued transfers (see
+ * usbd_hal_setup_queue()). The transfer starts immediately if the DMA
+ * channel is idle, otherwise the buffer is linked to the next chain.
+ *
+ * *The buffer must be kept allocated until the queue callback reports it*.
+ * \param ep Endpoint number.
+ * \param data Pointer to the data buffer.
+ * \param data_len Size of the data buffer in bytes (1 to 64K).
+ * \return USBD_STATUS_SUCCESS if the buffer has been queued;
+ *         otherwise, the corresponding error code.
+ */
+static uint8_t udphs_enqueue(uint8_t ep, const void *data, uint32_t data_len)
+{
+	struct _endpoint *endpoint = &endpoints[ep];
+	struct _usbd_queue *queue = endpoint->transfer.queue;
+	struct _usbd_dma_desc *desc;
+	uint32_t ctrl, state;
+
+	/* Check parameter */
+	if (data_len == 0 || data_len > DMA_MAX_FIFO_SIZE)
+		return USBD_STATUS_INVALID_PARAMETER;
+
+	if (UDPHS->UDPHS_EPT[ep].UDPHS_EPTCFG & UDPHS_EPTCFG_EPT_DIR) {
+		ctrl = UDPHS_DMACONTROL_END_B_EN;
+	} else {
+		ctrl = UDPHS_DMACONTROL_END_TR_EN |
+			UDPHS_DMACONTROL_END_TR_IT |
+			UDPHS_DMACONTROL_END_B_EN;
+	}
+
+	USB_HAL_TRACE("Q%d(%d) ", ep, (unsigned)data_len);
+
+	/* The queue callback may enqueue again from the UDPHS handler */
+	state = irq_save();
+
+	if (endpoint->state < UDPHS_ENDPOINT_IDLE ||
+	    !RING_SPACE(queue->head, queue->tail, queue->size)) {
+		irq_restore(state);
+		return USBD_STATUS_LOCKED;
+	}
+
+	desc = &queue->desc[queue->head];
+	desc->next = NULL;
+	desc->addr = (void*)data;
+	desc->ctrl = ctrl | UDPHS_DMACONTROL_END_BUFFIT |
+		UDPHS_DMACONTROL_CHANN_ENB |
+		UDPHS_DMACONTROL_BUFF_LENGTH(data_len);
+	desc->reserved = 0;
+	RING_INC(queue->head, queue->size);
+
+	/* Start now if no chain is running */
+	if (queue->tail == queue->start)
+		udphs_queue_start(ep);
+
+	irq_restore(state);
+
+	return USBD_STATUS_SUCCESS;
+}
+
 /**
  * USBD (UDP) interrupt handler
  * Manages device resume, suspend, end of bus reset.
@@ -1230,7 +1449,9 @@ uint8_t usbd_hal_configure(const USBEndpointDescriptor *descriptor)
 	if ((endpoint->state == UDPHS_ENDPOINT_RECEIVING)
 		|| (endpoint->state == UDPHS_ENDPOINT_SENDING)
 		|| (endpoint->state == UDPHS_ENDPOINT_RECEIVINGM)
-		|| (endpoint->state == UDPHS_ENDPOINT_SENDINGM)) {
+		|| (endpoint->state == UDPHS_ENDPOINT_SENDINGM)
+		|| (endpoint->state == UDPHS_ENDPOINT_RECEIVINGQ)
+		|| (endpoint->state == UDPHS_ENDPOINT_SENDINGQ)) {
 		udphs_end_of_transfer(ep, USBD_STATUS_RESET);
 	}
 	endpoint->state = UDPHS_ENDPOINT_IDLE;
@@ -1385,6 +1606,65 @@ uint8_t usbd_hal_setup_multi_transfer(uint8_t ep,
 	return USBD_STATUS_SUCCESS;
 }
 
+/**
+ * Configure a DMA endpoint to use queued transfer mode. Buffers are then
+ * added by usbd_hal_write() (IN) or usbd_hal_read() (OUT) and transferred
+ * back to back by the DMA; the queue callback is invoked for each
+ * completed buffer.
+ * \param ep Endpoint number.
+ * \param queue Pointer to the queue, NULL to disable queued transfers.
+ * \param desc Descriptor storage, one per queue slot (cache-aligned).
+ * \param size Number of descriptors (a queue holds size - 1 buffers).
+ * \param callback Callback invoked for each completed buffer.
+ * \param callback_arg Argument of the callback.
+ * \return USBD_STATUS_SUCCESS if the queue has been set up;
+ *         USBD_STATUS_LOCKED if the endpoint is transferring;
+ *         otherwise, the corresponding error status code.
+ */
+uint8_t usbd_hal_setup_queue(uint8_t ep, struct _usbd_queue *queue,
+		struct _usbd_dma_desc *desc, uint16_t size,
+		usbd_queue_cb_t callback, void *callback_arg)
+{
+	struct _endpoint *endpoint = &endpoints[ep];
+	uint32_t state;
+
+	if (!CHIP_USB_ENDPOINT_HAS_DMA(ep))
+		return USBD_STATUS_HW_NOT_SUPPORTED;
+
+	if (queue && (!desc || size < 2))
+		return USBD_STATUS_INVALID_PARAMETER;
+
+	/* Do not switch modes under a running transfer, it completes from
+	 * the UDPHS handler that could be the caller */
+	state = irq_save();
+	if (endpoint->state > UDPHS_ENDPOINT_IDLE) {
+		irq_restore(state);
+		return USBD_STATUS_LOCKED;
+	}
+
+	USB_HAL_TRACE("sQXfr%d ", ep);
+
+	if (queue) {
+		queue->desc = desc;
+		queue->size = size;
+		queue->head = 0;
+		queue->start = 0;
+		queue->tail = 0;
+		queue->callback = callback;
+		queue->callback_arg = callback_arg;
+
+		endpoint->transfer.use_multi = false;
+		endpoint->transfer.use_queue = true;
+		endpoint->transfer.queue = queue;
+	} else {
+		endpoint->transfer.use_queue = false;
+	}
+
+	irq_restore(state);
+
+	return USBD_STATUS_SUCCESS;
+}
+
 /**
  * Sends data through a USB endpoint. Sets up the transfer descriptor,
  * writes one or two data payloads (depending on the number of FIFO bank
@@ -1408,7 +1688,9 @@ uint8_t usbd_hal_write(uint8_t ep, const void *data, uint32_t data_len)
 	if (CHIP_USB_ENDPOINT_HAS_DMA(ep) && data_len)
 		cache_clean_region(data, data_len);
 
-	if (endpoints[ep].transfer.use_multi)
+	if (endpoints[ep].transfer.use_queue)
+		return udphs_enqueue(ep, data, data_len);
+	else if (endpoints[ep].transfer.use_multi)
 		return udphs_add_buffer(ep, data, data_len);
 	else
 		return udphs_write(ep, data, data_len);
@@ -1592,6 +1874,170 @@ uint8_t usbd_hal_write_with_header(uint8_t ep,
 	return USBD_STATUS_SUCCESS;
 }
 
+/**
+ * Appends a descriptor to a DMA chain.
+ * \param chain Pointer to the chain.
+ * \param addr Buffer address.
+ * \param len Buffer length.
+ * \param ctrl DMA control bits (excluding length and linking bits).
+ * \return false if the chain storage is full.
+ */
+static bool udphs_chain_add(struct _usbd_dma_chain *chain,
+		const void *addr, uint32_t len, uint32_t ctrl)
+{
+	struct _usbd_dma_desc *desc;
+
+	if (chain->desc_count >= chain->desc_size)
+		return false;
+
+	desc = &chain->desc[chain->desc_count++];
+	desc->next = NULL;
+	desc->addr = (void*)addr;
+	desc->ctrl = ctrl | UDPHS_DMACONTROL_CHANN_ENB |
+		UDPHS_DMACONTROL_BUFF_LENGTH(len);
+	desc->reserved = 0;
+	chain->length += len;
+
+	return true;
+}
+
+/**
+ * Prepares a chain of DMA descriptors sending several payloads (one per
+ * (micro)frame) on an isochronous IN endpoint. Each payload is split in
+ * as many transactions as allowed by the endpoint (high bandwidth
+ * endpoints use up to 3 transactions per microframe). Payload data larger
+ * than the (micro)frame capacity is truncated.
+ *
+ * The chain can be built while another chain is being transferred and is
+ * then started with usbd_hal_write_chain(). The header and data buffers
+ * must be kept allocated until the chain transfer is finished.
+ *
+ * \param ep Endpoint number.
+ * \param chain Pointer to the chain to build (storage must be set).
+ * \param payloads Array of payloads.
+ * \param count Number of payloads.
+ * \return USBD_STATUS_SUCCESS if the chain has been built;
+ *         otherwise, the corresponding error status code.
+ */
+uint8_t usbd_hal_build_payload_chain(uint8_t ep,
+		struct _usbd_dma_chain *chain,
+		const struct _usbd_payload *payloads, uint32_t count)
+{
+	UdphsEpt *ept = &UDPHS->UDPHS_EPT[ep];
+	struct _endpoint *endpoint = &endpoints[ep];
+	uint8_t nb_trans = (ept->UDPHS_EPTCFG & UDPHS_EPTCFG_NB_TRANS_Msk) >> UDPHS_EPTCFG_NB_TRANS_Pos;
+	uint32_t i, t;
+
+	if (!CHIP_USB_ENDPOINT_HAS_DMA(ep))
+		return USBD_STATUS_HW_NOT_SUPPORTED;
+	if (!chain->desc || !count)
+		return USBD_STATUS_INVALID_PARAMETER;
+	if (nb_trans < 1)
+		nb_trans = 1;
+
+	chain->desc_count = 0;
+	chain->length = 0;
+
+	for (i = 0; i < count; i++) {
+		const struct _usbd_payload *payload = &payloads[i];
+		const uint8_t *data_ptr = (const uint8_t*)payload->data;
+		uint32_t data_len = payload->data_len;
+		uint32_t pkt_len = endpoint->size - payload->header_len;
+
+		if (payload->header_len) {
+			cache_clean_region(payload->header, payload->header_len);
+			/* header and first data slice share the first bank */
+			if (!udphs_chain_add(chain, payload->header,
+					payload->header_len,
+					data_len ? 0 : UDPHS_DMACONTROL_END_B_EN))
+				return USBD_STATUS_INVALID_PARAMETER;
+		}
+
+		if (data_len > nb_trans * endpoint->size - payload->header_len)
+			data_len = nb_trans * endpoint->size - payload->header_len;
+		if (data_len)
+			cache_clean_region(data_ptr, data_len);
+
+		/* One descriptor per bank (transaction) */
+		for (t = 0; t < nb_trans && data_len; t++) {
+			if (pkt_len > data_len)
+				pkt_len = data_len;
+			if (!udphs_chain_add(chain, data_ptr, pkt_len,
+					UDPHS_DMACONTROL_END_B_EN))
+				return USBD_STATUS_INVALID_PARAMETER;
+			data_ptr += pkt_len;
+			data_len -= pkt_len;
+			pkt_len = endpoint->size;
+		}
+	}
+
+	if (!chain->desc_count)
+		return USBD_STATUS_INVALID_PARAMETER;
+
+	/* Link descriptors, interrupt at end of last one only */
+	for (i = 0; i < chain->desc_count - 1u; i++) {
+		chain->desc[i].next = &chain->desc[i + 1];
+		chain->desc[i].ctrl |= UDPHS_DMACONTROL_LDNXT_DSC;
+	}
+	chain->desc[i].ctrl |= UDPHS_DMACONTROL_END_BUFFIT;
+
+	/* Flush DMA descriptors */
+	cache_clean_region(chain->desc,
+			chain->desc_count * sizeof(struct _usbd_dma_desc));
+
+	return USBD_STATUS_SUCCESS;
+}
+
+/**
+ * Starts a chain of DMA descriptors prepared with
+ * usbd_hal_build_payload_chain(). The transfer callback is invoked once,
+ * when the whole chain has been transferred.
+ *
+ * \param ep Endpoint number.
+ * \param chain Pointer to the chain to send.
+ * \return USBD_STATUS_SUCCESS if the transfer has been started;
+ *         otherwise, the corresponding error status code.
+ */
+uint8_t usbd_hal_write_chain(uint8_t ep, const struct _usbd_dma_chain *chain)
+{
+	struct _endpoint *endpoint = &endpoints[ep];
+	struct _single_xfer *xfer = &endpoint->transfer.single;
+
+	/* Return if DMA is not supported */
+	if (!CHIP_USB_ENDPOINT_HAS_DMA(ep))
+		return USBD_STATUS_HW_NOT_SUPPORTED;
+	if (!chain->desc_count)
+		return USBD_STATUS_INVALID_PARAMETER;
+
+	/* Return if busy */
+	if (endpoint->state > UDPHS_ENDPOINT_IDLE)
+		return USBD_STATUS_LOCKED;
+
+	/* Sending state */
+	endpoint->state = UDPHS_ENDPOINT_SENDING;
+	endpoint->send_zlp = 0;
+
+	USB_HAL_TRACE("WrC%d(%d:%d) ", ep, (unsigned)chain->desc_count,
+			(unsigned)chain->length);
+
+	/* Setup transfer descriptor */
+	endpoint->transfer.use_multi = false;
+	xfer->data = chain->desc[0].addr;
+	xfer->remaining = chain->length;
+	xfer->buffered = chain->length;
+	xfer->transferred = 0;
+
+	/* Interrupt enable */
+	UDPHS->UDPHS_IEN |= UDPHS_IEN_DMA_1 << (ep - 1);
+
+	/* Start transfer with LLI */
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMANXTDSC = (uint32_t)chain->desc;
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL = 0;
+	UDPHS->UDPHS_DMA[ep].UDPHS_DMACONTROL = UDPHS_DMACONTROL_LDNXT_DSC;
+
+	return USBD_STATUS_SUCCESS;
+}
+
 /**
  * Get the size of data is available for read or write
  * \param ep Endpoint number
@@ -1628,6 +2074,8 @@ uint8_t usbd_hal_read(uint8_t ep, void *data, uint32_t data_len)
 	if (endpoints[ep].transfer.use_multi) {
 		trace_warning("usbd_hal_read does not support 'multi' transfers\r\n");
 		return USBD_STATUS_SW_NOT_SUPPORTED;
+	} else if (endpoints[ep].transfer.use_queue) {
+		return udphs_enqueue(ep, data, data_len);
 	} else {
 		return udphs_read(ep, data, data_len);
 	}
@@ -47,6 +47,9 @@
 #include "peripherals/pwmc.h"
 #include "peripherals/spi.h"
 #include "peripherals/spid.h"
+#include "peripherals/dma.h"
+
+#include "misc/cache.h"
 
 #include "video/ili9488.h"
 #include "video/ili9488_reg.h"
@@ -58,13 +61,38 @@
 
 #include "trace.h"
 #include "compiler.h"
+#include "intmath.h"
 
 
 #include <string.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of 9-bit SPI words sent per pixel (R, G, B) */
+#define MXTX_FB_WORDS_PER_PIXEL 3
+
+/** Number of 9-bit SPI words setting the window of a rectangle and
+ * starting the memory write, see _fb_build_header */
+#define MXTX_FB_HEADER_WORDS    13
+
+/** Two dirty rectangles are merged when their union wastes less than this
+ * number of pixels: it costs less than a window setup and a DMA start */
+#define MXTX_FB_MERGE_SLACK     64
+
+/** Dirty rectangle, inclusive coordinates */
+struct _mxtx_rect {
+	uint16_t x1;
+	uint16_t y1;
+	uint16_t x2;
+	uint16_t y2;
+};
+
 /*----------------------------------------------------------------------------
  *        Local variables
  *----------------------------------------------------------------------------*/
@@ -85,6 +113,28 @@ static struct _mxtx_param sMXTX ;
 
 #define pgm_read_byte(addr) (*(const unsigned char *)(addr))
 
+/* Framebuffer mode state */
+static struct {
+	uint16_t*             buffer;
+	struct dma_channel*   dma;
+	struct _mxtx_rect     dirty[MXTX_FB_MAX_DIRTY];
+	uint8_t               dirty_count;
+	struct _mxtx_rect     flush[MXTX_FB_MAX_DIRTY];
+	uint8_t               flush_count;
+	uint8_t               flush_index;
+	volatile bool         flushing;
+	bool                  spi_dirty;
+	mxtx_flush_callback_t callback;
+	void*                 callback_arg;
+} _fb;
+
+/* One DMA descriptor for the window commands, and one per framebuffer line
+ * of the rectangle being flushed */
+CACHE_ALIGNED static struct dma_xfer_item _fb_dlist[1 + ILI9488_MXTX_HEIGHT];
+
+/* Window commands of the rectangle being flushed */
+CACHE_ALIGNED static uint16_t _fb_header[MXTX_FB_HEADER_WORDS];
+
 static struct _spi_desc spi_ili9488_desc = {
 	.addr           = ILI9488_ADDR,
 	.bitrate        = ILI9488_FREQ,
@@ -306,6 +356,202 @@ static void mxtx_write_ram_buffer ( const LcdColor_t *pBuf, uint32_t size)
 		mxtx_write_reg24(pBuf[addr]);
 }
 
+/*----------------------------------------------------------------------------
+ *        Framebuffer functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Store a pixel in the framebuffer, already encoded as the SPI words
+ * sent by mxtx_write_reg24.
+ */
+static inline void _fb_put_pixel(uint16_t* p, LcdColor_t color)
+{
+	p[0] = MXTX_PARAM(((color >> 16) & 0xFF));
+	p[1] = MXTX_PARAM(((color >> 8) & 0xFF));
+	p[2] = MXTX_PARAM((color & 0xFF));
+}
+
+static inline uint16_t* _fb_pixel_addr(uint32_t x, uint32_t y)
+{
+	return &_fb.buffer[(y * sMXTX.scr_width + x) * MXTX_FB_WORDS_PER_PIXEL];
+}
+
+static uint32_t _fb_rect_area(const struct _mxtx_rect* r)
+{
+	return (r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static void _fb_rect_union(struct _mxtx_rect* r, const struct _mxtx_rect* other)
+{
+	r->x1 = min_u32(r->x1, other->x1);
+	r->y1 = min_u32(r->y1, other->y1);
+	r->x2 = max_u32(r->x2, other->x2);
+	r->y2 = max_u32(r->y2, other->y2);
+}
+
+/**
+ * \brief Add a rectangle to the list of areas to send on the next flush.
+ * Overlapping or close rectangles are merged, and when the list is full the
+ * rectangle is merged with the entry that grows the least.
+ */
+static void _fb_add_dirty(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2)
+{
+	struct _mxtx_rect rect = { x1, y1, x2, y2 };
+	struct _mxtx_rect u;
+	uint32_t i, best, cost, best_cost;
+
+	for (i = 0; i < _fb.dirty_count; ) {
+		struct _mxtx_rect* r = &_fb.dirty[i];
+
+		if (r->x1 <= rect.x1 && r->y1 <= rect.y1 &&
+		    r->x2 >= rect.x2 && r->y2 >= rect.y2)
+			return;
+
+		u = *r;
+		_fb_rect_union(&u, &rect);
+		if (_fb_rect_area(&u) <= _fb_rect_area(r) + _fb_rect_area(&rect)
+				+ MXTX_FB_MERGE_SLACK) {
+			/* remove the entry and start over with the union,
+			 * it may now be close to other entries */
+			rect = u;
+			_fb.dirty[i] = _fb.dirty[--_fb.dirty_count];
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+
+	if (_fb.dirty_count < MXTX_FB_MAX_DIRTY) {
+		_fb.dirty[_fb.dirty_count++] = rect;
+		return;
+	}
+
+	best = 0;
+	best_cost = UINT32_MAX;
+	for (i = 0; i < _fb.dirty_count; i++) {
+		u = _fb.dirty[i];
+		_fb_rect_union(&u, &rect);
+		cost = _fb_rect_area(&u) - _fb_rect_area(&_fb.dirty[i]);
+		if (cost < best_cost) {
+			best_cost = cost;
+			best = i;
+		}
+	}
+	_fb_rect_union(&_fb.dirty[best], &rect);
+}
+
+/**
+ * \brief Wait for the last SPI word and drop the data received during the
+ * DMA transfers, so that polled accesses start from a clean state.
+ */
+static void _fb_spi_drain(void)
+{
+	Spi* spi = spi_ili9488_desc.addr;
+
+	while (!spi_is_finished(spi));
+	(void)spi->SPI_RDR;
+	(void)spi_get_status(spi);
+}
+
+/**
+ * \brief Encode the commands sent by mxtx_set_window and the memory write
+ * command for a rectangle, as the SPI words streamed before its pixels.
+ */
+static void _fb_build_header(const struct _mxtx_rect* rect)
+{
+	uint16_t* p = _fb_header;
+
+	*p++ = MXTX_CMD(ILI9488_CMD_COLUMN_ADDRESS_SET);
+	*p++ = MXTX_PARAM((rect->x1 >> 8));
+	*p++ = MXTX_PARAM((rect->x1 & 0xFF));
+	*p++ = MXTX_PARAM((rect->x2 >> 8));
+	*p++ = MXTX_PARAM((rect->x2 & 0xFF));
+	*p++ = MXTX_CMD(ILI9488_CMD_NOP);
+	*p++ = MXTX_CMD(ILI9488_CMD_PAGE_ADDRESS_SET);
+	*p++ = MXTX_PARAM((rect->y1 >> 8));
+	*p++ = MXTX_PARAM((rect->y1 & 0xFF));
+	*p++ = MXTX_PARAM((rect->y2 >> 8));
+	*p++ = MXTX_PARAM((rect->y2 & 0xFF));
+	*p++ = MXTX_CMD(ILI9488_CMD_NOP);
+	*p++ = MXTX_CMD(ILI9488_CMD_MEMORY_WRITE);
+	assert(p == _fb_header + MXTX_FB_HEADER_WORDS);
+	cache_clean_region(_fb_header, sizeof(_fb_header));
+}
+
+/**
+ * \brief Start the DMA transfer of the next rectangle of the flush list, or
+ * complete the flush. Called from mxtx_fb_flush and from the DMA completion
+ * callback.
+ *
+ * The window commands are the first item of the linked list, so the SPI is
+ * never accessed by the CPU and nothing waits for the bus here: the words of
+ * the previous rectangle still being shifted out are followed by the next
+ * ones as the DMA refills SPI_TDR.
+ */
+static void _fb_flush_next(void)
+{
+	struct _mxtx_rect* rect;
+	struct dma_xfer_item_tmpl tmpl;
+	uint32_t words, rows, y, count, i;
+
+	if (_fb.flush_index >= _fb.flush_count) {
+		_fb.flushing = false;
+		if (_fb.callback)
+			_fb.callback(_fb.callback_arg);
+		return;
+	}
+	rect = &_fb.flush[_fb.flush_index++];
+	_fb.spi_dirty = true;
+
+	memset(&tmpl, 0, sizeof(tmpl));
+	tmpl.da = (void*)&spi_ili9488_desc.addr->SPI_TDR;
+	tmpl.upd_sa_per_data = 1;
+	tmpl.upd_da_per_data = 0;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 0;
+	tmpl.data_width = DMA_DATA_WIDTH_HALF_WORD;
+	tmpl.chunk_size = DMA_CHUNK_SIZE_1;
+
+	/* Lines of a full-width rectangle are contiguous and are sent with
+	 * as few descriptors as the DMA block size allows */
+	words = (rect->x2 - rect->x1 + 1) * MXTX_FB_WORDS_PER_PIXEL;
+	if (rect->x1 == 0 && rect->x2 == sMXTX.scr_width - 1)
+		rows = max_u32(DMA_MAX_BT_SIZE / words, 1);
+	else
+		rows = 1;
+
+	/* Set the window once for the whole rectangle */
+	_fb_build_header(rect);
+	tmpl.sa = _fb_header;
+	tmpl.blk_size = MXTX_FB_HEADER_WORDS;
+	dma_prepare_item(_fb.dma, &tmpl, &_fb_dlist[0]);
+
+	i = 1;
+	for (y = rect->y1; y <= rect->y2; y += count) {
+		count = min_u32(rows, rect->y2 - y + 1);
+		tmpl.sa = _fb_pixel_addr(rect->x1, y);
+		tmpl.blk_size = words * count;
+		cache_clean_region(tmpl.sa, tmpl.blk_size * sizeof(uint16_t));
+		dma_prepare_item(_fb.dma, &tmpl, &_fb_dlist[i]);
+		dma_link_item(_fb.dma, &_fb_dlist[i - 1], &_fb_dlist[i]);
+		i++;
+	}
+	dma_link_item(_fb.dma, &_fb_dlist[i - 1], NULL);
+	cache_clean_region(_fb_dlist, i * sizeof(_fb_dlist[0]));
+
+	tmpl.sa = _fb_header;
+	tmpl.blk_size = MXTX_FB_HEADER_WORDS;
+	dma_configure_sg_transfer(_fb.dma, &tmpl, _fb_dlist);
+	dma_start_transfer(_fb.dma);
+}
+
+static void _fb_dma_callback(struct dma_channel* channel, void* arg)
+{
+	(void)channel;
+	(void)arg;
+	_fb_flush_next();
+}
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -359,6 +605,11 @@ void mxtx_init_environment(void)
 void mxtx_draw_pixel(uint32_t x, uint32_t y)
 {
 	if( (x >= sMXTX.scr_width) || (y >= sMXTX.scr_height) ) return ;
+	if (_fb.buffer) {
+		_fb_put_pixel(_fb_pixel_addr(x, y), *gLcdPixelCache);
+		_fb_add_dirty(x, y, x, y);
+		return;
+	}
 	/* Set cursor */
 	mxtx_set_cursor( x, y );
 	/* Prepare to write in GRAM */
@@ -604,6 +855,8 @@ uint8_t mxtx_initialize (void)
 
 void mxtx_set_cursor (uint16_t x, uint16_t y)
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	/* Set Horizontal Address Start Position */
 	mxtx_send_cmd(ILI9488_CMD_COLUMN_ADDRESS_SET);
 	mxtx_write_reg16(x);
@@ -622,6 +875,8 @@ void mxtx_set_cursor (uint16_t x, uint16_t y)
  */
 void mxtx_on ( void )
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	mxtx_send_cmd(ILI9488_CMD_PIXEL_OFF);
 	mxtx_send_cmd(ILI9488_CMD_DISPLAY_ON);
 	mxtx_send_cmd(ILI9488_CMD_NORMAL_DISP_MODE_ON);
@@ -633,6 +888,8 @@ void mxtx_on ( void )
  */
 void mxtx_off ( void )
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	mxtx_send_cmd(ILI9488_CMD_DISPLAY_OFF);
 	mxtx_send_cmd(ILI9488_CMD_DISPLAY_OFF);
 }
@@ -640,6 +897,8 @@ void mxtx_off ( void )
 //=============================================================================
 void mxtx_sleep_mode ( uint8_t is_sleep )
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	if(is_sleep==1)
 	{
 		//Sleep In
@@ -683,6 +942,8 @@ void mxtx_set_color ( uint32_t dwRgb24Bits )
  */
 void mxtx_set_partial_window( uint16_t Start, uint16_t End)
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	mxtx_send_cmd(ILI9488_CMD_POWER_CONTROL_PARTIAL_5);
 	mxtx_write_reg(0x44 ) ;
 	mxtx_send_cmd(ILI9488_CMD_PARTIAL_AREA);
@@ -703,6 +964,9 @@ void mxtx_set_partial_window( uint16_t Start, uint16_t End)
 
 void mxtx_set_window ( struct _point* Coord, struct _size* Size )
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
+
 	if ( (Size->w > sMXTX.scr_width) || (Size->h > sMXTX.scr_height) )
 	{
 		printf("\n\rWindow too large\n\r");
@@ -741,6 +1005,9 @@ void mxtx_set_window ( struct _point* Coord, struct _size* Size )
 void mxtx_set_display_direction (enum _mxtx_direction direction, uint8_t BGR_mode)
 {
 	uint8_t mode = 0;
+
+	/* The rectangles of a flush in progress use the current line length */
+	mxtx_fb_wait_flush();
 	switch (direction)
 	{
 	case DDD_NORMAL:
@@ -798,6 +1065,11 @@ void mxtx_set_display_direction (enum _mxtx_direction direction, uint8_t BGR_mod
 			.h = sMXTX.scr_height,
 		};
 	mxtx_set_window( &Point, &Size ) ;
+	/* The framebuffer layout follows the new line length */
+	if (_fb.buffer) {
+		_fb.dirty_count = 0;
+		_fb_add_dirty(0, 0, sMXTX.scr_width - 1, sMXTX.scr_height - 1);
+	}
 }
 
 //=============================================================================
@@ -820,6 +1092,8 @@ void mxtx_clear_screen (void)
 //=============================================================================
 void mxtx_set_vertical_scroll_window ( uint16_t dwStartAdd, uint16_t dwHeight )
 {
+	/* Commands can't be interleaved with an asynchronous flush */
+	mxtx_fb_wait_flush();
 	mxtx_send_cmd(ILI9488_CMD_VERT_SCROLL_DEFINITION);
 	mxtx_write_reg16(dwStartAdd-1);
 	mxtx_write_reg16(dwStartAdd);
@@ -833,8 +1107,8 @@ void mxtx_set_vertical_scroll_window ( uint16_t dwStartAdd, uint16_t dwHeight )
 void mxtx_set_font (uint8_t FontSel)
 {
 	sMXTX.font_sel = FontSel;
-	sMXTX.max_lines = sMXTX.scr_height / sGFont[FontSel].height;
-	sMXTX.char_per_line = sMXTX.scr_width / sGFont[FontSel].width;
+	sMXTX.max_lines = sMXTX.scr_height / font_param[FontSel].height;
+	sMXTX.char_per_line = sMXTX.scr_width / font_param[FontSel].width;
 }
 
 //=============================================================================
@@ -843,9 +1117,9 @@ void mxtx_draw_char ( struct _point* Coord, uint8_t c, uint32_t color )
 {
 	uint32_t row, col ;
 	uint8_t Ch;
-	uint8_t width = sGFont[sMXTX.font_sel].width ;
-	uint8_t height = sGFont[sMXTX.font_sel].height;
-	uint8_t* pfont = (uint8_t*)sGFont[sMXTX.font_sel].pfont;
+	uint8_t width = font_param[sMXTX.font_sel].width ;
+	uint8_t height = font_param[sMXTX.font_sel].height;
+	uint8_t* pfont = (uint8_t*)font_param[sMXTX.font_sel].pfont;
 
 	assert( (c >= 0x20) && (c <= 0x7F) ) ;
 	mxtx_set_color(color);
@@ -912,20 +1186,20 @@ void mxtx_draw_char ( struct _point* Coord, uint8_t c, uint32_t color )
 void mxtx_draw_string(struct _point* Coord, const char* pString, uint32_t color)
 {
 	uint32_t xorg = Coord->x;
-	uint32_t w = sGFont[sMXTX.font_sel].width;
+	uint32_t w = font_param[sMXTX.font_sel].width;
 
 	while (*pString)
 	{
 		if (*pString == '\n')
 		{
-			Coord->y += sGFont[sMXTX.font_sel].height + 2;
+			Coord->y += font_param[sMXTX.font_sel].height + 2;
 			Coord->x = xorg;
 		}
 		else
 		{
 			mxtx_draw_char (Coord, *pString, color);
 			if (*pString==0x20) Coord->x += w/2;
-			else Coord->x += w + sGFont[sMXTX.font_sel].char_space;
+			else Coord->x += w + font_param[sMXTX.font_sel].char_space;
 		}
 		pString ++;
 	}
@@ -943,9 +1217,9 @@ void mxtx_draw_string(struct _point* Coord, const char* pString, uint32_t color)
  */
 void mxtx_get_string_size(const char *pString, struct _size *pSize)
 {
-	uint32_t width = sGFont[sMXTX.font_sel].width;
-	uint32_t height = sGFont[sMXTX.font_sel].height;
-	uint8_t space = sGFont[sMXTX.font_sel].char_space;
+	uint32_t width = font_param[sMXTX.font_sel].width;
+	uint32_t height = font_param[sMXTX.font_sel].height;
+	uint8_t space = font_param[sMXTX.font_sel].char_space;
 
 	while (*pString)
 	{
@@ -969,9 +1243,6 @@ void mxtx_get_string_size(const char *pString, struct _size *pSize)
  * \param pBuffer   LcdColor_t buffer area.
  */
 
-#define IRAM_ADDR       (0x00200000u) /**< Internal RAM base address */
-#define IRAM_SIZE       (0x20000u)
-
 void mxtx_draw_picture (struct _point* Coord1, struct _point* Coord2, const LcdColor_t *pBuffer )
 {
 	uint32_t size, blocks;
@@ -979,6 +1250,22 @@ void mxtx_draw_picture (struct _point* Coord1, struct _point* Coord2, const LcdC
 
 	/* Swap coordinates if necessary */
 	mxtx_check_box_coordinates(Coord1, Coord2);
+	if (_fb.buffer) {
+		uint16_t* p;
+		int32_t x, y;
+
+		if (Coord1->x < 0 || Coord1->y < 0)
+			return;
+		for (y = Coord1->y; y <= Coord2->y; y++) {
+			p = _fb_pixel_addr(Coord1->x, y);
+			for (x = Coord1->x; x <= Coord2->x; x++) {
+				_fb_put_pixel(p, *pBuffer++);
+				p += MXTX_FB_WORDS_PER_PIXEL;
+			}
+		}
+		_fb_add_dirty(Coord1->x, Coord1->y, Coord2->x, Coord2->y);
+		return;
+	}
 	/* Determine the refresh window area */
 	/* Horizontal and Vertical RAM Address Position (R50h, R51h, R52h, R53h) */
 	mxtx_set_window(Coord1, (struct _size*)Coord2);
@@ -1317,6 +1604,29 @@ void mxtx_draw_filled_rectangle(struct _point* Coord1, struct _point* Coord2)
 
 	/* Swap coordinates if necessary */
 	mxtx_check_box_coordinates(Coord1, Coord2);
+	if (_fb.buffer) {
+		uint16_t pixel[MXTX_FB_WORDS_PER_PIXEL];
+		uint16_t* p;
+		int32_t x, y;
+
+		if (Coord2->x < 0 || Coord2->y < 0)
+			return;
+		if (Coord1->x < 0)
+			Coord1->x = 0;
+		if (Coord1->y < 0)
+			Coord1->y = 0;
+		_fb_put_pixel(pixel, *gLcdPixelCache);
+		for (y = Coord1->y; y <= Coord2->y; y++) {
+			p = _fb_pixel_addr(Coord1->x, y);
+			for (x = Coord1->x; x <= Coord2->x; x++) {
+				*p++ = pixel[0];
+				*p++ = pixel[1];
+				*p++ = pixel[2];
+			}
+		}
+		_fb_add_dirty(Coord1->x, Coord1->y, Coord2->x, Coord2->y);
+		return;
+	}
 	/* Determine the refresh window area */
 	mxtx_set_window(Coord1, (struct _size*)Coord2);
 	size = (Coord2->x - Coord1->x + 1) * (Coord2->y - Coord1->y + 1);
@@ -1520,6 +1830,82 @@ void mxtx_set_backlight (uint8_t level)
 	pwmc_set_duty_cycle(PWM, CHANNEL_PWM_LCD, level);
 }
 
+//=============================================================================
+// FRAMEBUFFER
+//=============================================================================
+
+uint8_t mxtx_fb_enable(uint16_t* buffer)
+{
+	uint32_t id = get_spi_id_from_addr(spi_ili9488_desc.addr);
+
+	mxtx_fb_disable();
+
+	_fb.dma = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
+	if (!_fb.dma) {
+		trace_error("ILI9488: can't allocate DMA channel\r\n");
+		return 1;
+	}
+	dma_set_callback(_fb.dma, _fb_dma_callback, NULL);
+
+	_fb.buffer = buffer;
+	_fb.dirty_count = 0;
+	_fb_add_dirty(0, 0, sMXTX.scr_width - 1, sMXTX.scr_height - 1);
+	return 0;
+}
+
+//=============================================================================
+void mxtx_fb_disable(void)
+{
+	if (!_fb.buffer)
+		return;
+
+	mxtx_fb_wait_flush();
+	dma_free_channel(_fb.dma);
+	_fb.dma = NULL;
+	_fb.buffer = NULL;
+	_fb.dirty_count = 0;
+}
+
+//=============================================================================
+uint8_t mxtx_fb_flush(mxtx_flush_callback_t cb, void* arg)
+{
+	if (!_fb.buffer)
+		return 1;
+
+	/* No need to drain the SPI between two flushes, and the previous
+	 * one is done if called from its callback */
+	while (_fb.flushing)
+		dma_poll();
+
+	/* Drawing can go on in the dirty list while this one is sent */
+	memcpy(_fb.flush, _fb.dirty, _fb.dirty_count * sizeof(_fb.dirty[0]));
+	_fb.flush_count = _fb.dirty_count;
+	_fb.flush_index = 0;
+	_fb.dirty_count = 0;
+	_fb.callback = cb;
+	_fb.callback_arg = arg;
+	_fb.flushing = true;
+	_fb_flush_next();
+	return 0;
+}
+
+//=============================================================================
+bool mxtx_fb_is_flushing(void)
+{
+	return _fb.flushing;
+}
+
+//=============================================================================
+void mxtx_fb_wait_flush(void)
+{
+	while (_fb.flushing)
+		dma_poll();
+	if (_fb.spi_dirty) {
+		_fb_spi_drain();
+		_fb.spi_dirty = false;
+	}
+}
+
 //=============================================================================
 // DEMO and TEST
 //=============================================================================
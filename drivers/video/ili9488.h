@@ -43,8 +43,9 @@
 
 #include "board.h"
 
-#include "font.h"
+#include "widget.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*----------------------------------------------------------------------------
@@ -61,10 +62,11 @@
  *        Types
  *----------------------------------------------------------------------------*/
 
-
-struct _point;
 typedef uint32_t LcdColor_t ;
 
+/** Callback invoked when a framebuffer flush completes */
+typedef void (*mxtx_flush_callback_t)(void* arg);
+
 /*----------------------------------------------------------------------------
  *
  *----------------------------------------------------------------------------*/
@@ -91,6 +93,13 @@ typedef uint32_t LcdColor_t ;
 #define ILI9488_MXTX_HEIGHT      480
 #define MXTX_LCD_HEIGHT          ILI9488_MXTX_HEIGHT
 
+/** Size in bytes of a framebuffer for mxtx_fb_enable: each pixel is stored
+ * as the three 9-bit SPI words (R, G, B) sent to the controller */
+#define MXTX_FB_SIZE  (MXTX_LCD_WIDTH * MXTX_LCD_HEIGHT * 3 * sizeof(uint16_t))
+
+/** Maximum number of dirty rectangles tracked between two flushes */
+#define MXTX_FB_MAX_DIRTY        8
+
 /*----------------------------------------------------------------------------
  *
  *----------------------------------------------------------------------------*/
@@ -108,12 +117,6 @@ enum _mxtx_direction
 	DDD_XY_EXCHANGE_XY_MIRROR,
 };
 
-struct _size
-{
-	uint32_t w;
-	uint32_t h;
-};
-
 struct _mxtx_param
 {
 	// CURSOR
@@ -129,7 +132,7 @@ struct _mxtx_param
 	uint8_t   font_sel;
 	uint8_t   max_lines;
 	uint8_t   char_per_line;
-	G_FONT    sgFont;
+	struct _font_parameters sgFont;
 };
 
 /*----------------------------------------------------------------------------
@@ -211,6 +214,49 @@ extern void mxtx_draw_circleHelper(struct _point* Coord1, uint32_t r,
 extern void mxtx_draw_filled_circle_helper(struct _point* Coord1, uint32_t r,
 					   uint8_t corner, uint32_t delta);
 
+/**
+ * \brief Enable the framebuffer mode.
+ *
+ * Drawing functions then render to the buffer instead of the display and
+ * record the modified areas; mxtx_fb_flush sends them to the display.  The
+ * whole screen is marked as modified.
+ *
+ * \param buffer  MXTX_FB_SIZE bytes, aligned on a cache line
+ * \return 0 for successful operation, 1 if no DMA channel is available.
+ */
+extern uint8_t mxtx_fb_enable(uint16_t* buffer);
+
+/**
+ * \brief Wait for the current flush and go back to direct drawing.
+ */
+extern void mxtx_fb_disable(void);
+
+/**
+ * \brief Send the areas modified since the last flush to the display.
+ *
+ * For each dirty rectangle, the window commands and the pixels are streamed
+ * by DMA as one linked list, the next one being started from the DMA
+ * completion callback.  The function returns as soon as the first transfer is started; the
+ * framebuffer may be drawn to during the flush but areas modified before
+ * being sent are displayed with their new content.  A pending flush is
+ * completed first.
+ *
+ * \param cb   Callback invoked (from interrupt context) when the flush is done, or NULL.
+ * \param arg  Argument given to the callback.
+ * \return 0 for successful operation, 1 if the framebuffer mode is disabled.
+ */
+extern uint8_t mxtx_fb_flush(mxtx_flush_callback_t cb, void* arg);
+
+/**
+ * \brief Check whether a flush is in progress.
+ */
+extern bool mxtx_fb_is_flushing(void);
+
+/**
+ * \brief Wait for the completion of the current flush.
+ */
+extern void mxtx_fb_wait_flush(void);
+
 extern void test_lcd_ili9488(void);
 
 #endif /* #ifndef ILI9488_H_ */
@@ -35,9 +35,11 @@
 #include "video/image_sensor_inf.h"
 #include "peripherals/twi.h"
 #include "peripherals/twid.h"
+#include "misc/cache.h"
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
  
 #include "timer.h"
 #include "trace.h"
@@ -46,6 +48,22 @@
  *----------------------------------------------------------------------------*/
 static const sensor_profile_t *p_sensor;
 
+/** Output set up by sensor_setup() */
+static const sensor_output_t *p_output;
+
+/** Longest exposure time of the output, set by
+ * sensor_enable_manual_exposure() */
+static uint32_t exposure_max;
+
+/** Data of a burst write, also used by TWI DMA */
+CACHE_ALIGNED static uint8_t sensor_burst[SENSOR_BURST_MAX];
+
+/** Data of a burst read-back, also used by TWI DMA */
+CACHE_ALIGNED static uint8_t sensor_readback[SENSOR_BURST_MAX];
+
+/** Statistics of the last register list programming */
+static sensor_prog_stats_t sensor_stats;
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -168,6 +186,120 @@ static sensor_status_t sensor_twi_write_reg(struct _twi_desc* p_twid,
 	return SENSOR_OK;
 }
 
+/**
+ * \brief Number of data bytes per register.
+ */
+static uint8_t sensor_data_size(void)
+{
+	return p_sensor->twi_inf_mode == SENSOR_TWI_REG_BYTE_DATA_2BYTE ? 2 : 1;
+}
+
+/**
+ * \brief Write consecutive registers from sensor_burst in one transfer,
+ * the sensor incrementing the register address after each value.
+ * \param p_twid TWI interface
+ * \param reg First register to be written
+ * \param size Number of data bytes
+ * \return SENSOR_OK if no error; otherwise SENSOR_TWI_ERROR
+ */
+static sensor_status_t sensor_twi_write_burst(struct _twi_desc* p_twid,
+						uint16_t reg,
+						uint32_t size)
+{
+	uint32_t status;
+	struct _buffer out = {
+		.data = sensor_burst,
+		.size = size,
+	};
+
+	p_twid->slave_addr = p_sensor->twi_slave_addr;
+	p_twid->iaddr = reg;
+	p_twid->isize =
+		(p_sensor->twi_inf_mode == SENSOR_TWI_REG_2BYTE_DATA_BYTE) ? 2 : 1;
+
+	status = twid_transfert(p_twid, NULL, &out, NULL, NULL);
+	while (twid_is_busy(p_twid));
+	if (status) return SENSOR_TWI_ERROR;
+	return SENSOR_OK;
+}
+
+/**
+ * \brief Read consecutive registers into sensor_readback in one transfer.
+ * \param p_twid TWI interface
+ * \param reg First register to be read
+ * \param size Number of data bytes
+ * \return SENSOR_OK if no error; otherwise SENSOR_TWI_ERROR
+ */
+static sensor_status_t sensor_twi_read_burst(struct _twi_desc* p_twid,
+						uint16_t reg,
+						uint32_t size)
+{
+	uint32_t status;
+	uint8_t reg8[2];
+	struct _buffer in = {
+		.data = sensor_readback,
+		.size = size,
+	};
+	struct _buffer out;
+
+	p_twid->slave_addr = p_sensor->twi_slave_addr;
+	p_twid->iaddr = 0;
+	p_twid->isize = 0;
+
+	reg8[0] = reg >> 8;
+	reg8[1] = reg & 0xff;
+	if (p_sensor->twi_inf_mode == SENSOR_TWI_REG_2BYTE_DATA_BYTE) {
+		out.data = reg8;
+		out.size = 2;
+	} else {
+		out.data = reg8 + 1;
+		out.size = 1;
+	}
+	status = twid_transfert(p_twid, NULL, &out, NULL, NULL);
+	while (twid_is_busy(p_twid));
+
+	status |= twid_transfert(p_twid, &in, NULL, NULL, NULL);
+	while (twid_is_busy(p_twid));
+	if (status) return SENSOR_TWI_ERROR;
+	return SENSOR_OK;
+}
+
+/**
+ * \brief Read back registers just written from sensor_burst.
+ * \param p_twid TWI interface
+ * \param reg First register
+ * \param count Number of registers
+ * \return Number of registers read with another value, or not readable.
+ */
+static uint32_t sensor_verify_regs(struct _twi_desc* p_twid,
+						uint16_t reg,
+						uint32_t count)
+{
+	uint8_t dsize = sensor_data_size();
+	uint32_t errors = 0;
+	uint32_t i;
+
+	if (p_sensor->burst) {
+		if (sensor_twi_read_burst(p_twid, reg, count * dsize) != SENSOR_OK)
+			return count;
+	} else {
+		for (i = 0; i < count; i++) {
+			if (sensor_twi_read_reg(p_twid, reg + i,
+					&sensor_readback[i * dsize]) != SENSOR_OK)
+				return count;
+		}
+	}
+	for (i = 0; i < count; i++) {
+		if (memcmp(&sensor_burst[i * dsize], &sensor_readback[i * dsize], dsize)) {
+			trace_debug("SENSOR verify %x: wrote %x, read %x\n\r",
+				(unsigned)(reg + i), sensor_burst[i * dsize],
+				sensor_readback[i * dsize]);
+			errors++;
+		}
+	}
+	return errors;
+}
+
 /**
  * \brief Read and check sensor product ID.
  * \param p_twid TWI interface
@@ -216,17 +348,98 @@ static sensor_status_t sensor_check_pid(struct _twi_desc *p_twid,
  */
 sensor_status_t sensor_twi_write_regs(struct _twi_desc *p_twid, const sensor_reg_t *p_reglist)
 {
-	sensor_status_t status;
+	return sensor_twi_program_regs(p_twid, p_reglist, false, NULL);
+}
+
+/**
+ * \brief  Program a list of registers, coalescing consecutive registers.
+ *
+ * When the sensor profile allows bursts, runs of consecutive register
+ * addresses are written in one TWI transfer of up to SENSOR_BURST_MAX data
+ * bytes, using DMA if the TWI descriptor is in TWID_MODE_DMA. Entries with
+ * SENSOR_REG_DELAY as register wait for their value in milliseconds.
+ * Registers that change by themselves (self-clearing reset bits, status)
+ * are reported by the verify pass.
+ *
+ * \param p_twid TWI interface
+ * \param p_reglist Register list to be written
+ * \param verify Read each transfer back and compare
+ * \param stats If not NULL, filled with the programming statistics
+ * \return SENSOR_OK if no error; SENSOR_TWI_ERROR if a write failed;
+ * SENSOR_VERIFY_ERROR if some registers were read back with another value
+ */
+sensor_status_t sensor_twi_program_regs(struct _twi_desc *p_twid,
+					const sensor_reg_t *p_reglist,
+					bool verify,
+					sensor_prog_stats_t *stats)
+{
+	sensor_status_t status = SENSOR_OK;
 	const sensor_reg_t *p_next = p_reglist;
+	uint16_t reg;
+	uint8_t dsize = sensor_data_size();
+	uint32_t max = p_sensor->burst ? SENSOR_BURST_MAX / dsize : 1;
+	uint32_t count, start, verify_start;
 	volatile uint32_t delay;
 
+	memset(&sensor_stats, 0, sizeof(sensor_stats));
+	start = timer_get_tick();
+
 	while (!((p_next->reg == SENSOR_REG_TERM) && (p_next->val == SENSOR_VAL_TERM))) {
-		status = sensor_twi_write_reg( p_twid, p_next->reg, (uint8_t *)(&p_next->val));
-		for (delay = 0; delay <= 10000; delay++) ;
-		if (status) return SENSOR_TWI_ERROR;
-		p_next++;
+		if (p_next->reg == SENSOR_REG_DELAY) {
+			timer_wait(p_next->val);
+			p_next++;
+			continue;
+		}
+
+		/* Gather a run of consecutive registers */
+		reg = p_next->reg;
+		count = 0;
+		do {
+			sensor_burst[count * dsize] = p_next->val & 0xff;
+			if (dsize == 2)
+				sensor_burst[count * dsize + 1] = p_next->val >> 8;
+			count++;
+			p_next++;
+		} while (count < max && p_next->reg == reg + count &&
+			 p_next->reg != SENSOR_REG_DELAY);
+
+		if (sensor_twi_write_burst(p_twid, reg, count * dsize) != SENSOR_OK) {
+			status = SENSOR_TWI_ERROR;
+			break;
+		}
+		sensor_stats.regs += count;
+		sensor_stats.transfers++;
+
+		/* Single register writes keep the settling time sensors
+		 * without burst support have always been given */
+		if (!p_sensor->burst)
+			for (delay = 0; delay <= 10000; delay++) ;
+
+		if (verify) {
+			verify_start = timer_get_tick();
+			sensor_stats.verify_errors += sensor_verify_regs(p_twid, reg, count);
+			sensor_stats.verify_time +=
+				timer_get_interval(verify_start, timer_get_tick());
+		}
 	}
-	return SENSOR_OK;
+
+	sensor_stats.write_time = timer_get_interval(start, timer_get_tick()) -
+		sensor_stats.verify_time;
+	if (stats)
+		*stats = sensor_stats;
+	if (status == SENSOR_OK && sensor_stats.verify_errors)
+		status = SENSOR_VERIFY_ERROR;
+	return status;
+}
+
+/**
+ * \brief Retrieves the statistics of the last register list programming,
+ * including the one done by sensor_setup().
+ * \param stats Statistics to be filled.
+ */
+void sensor_get_program_stats(sensor_prog_stats_t *stats)
+{
+	*stats = sensor_stats;
 }
 
 /**
@@ -278,6 +491,8 @@ sensor_status_t sensor_setup(struct _twi_desc* p_twid,
 	if (found == 0)
 		return SENSOR_RESOLUTION_NOT_SUPPORTED;
 	p_sensor = sensor_profile;
+	p_output = sensor_profile->output_conf[i];
+	exposure_max = 0;
 
 	status = sensor_check_pid(p_twid,
 					p_sensor->pid_high_reg,
@@ -321,3 +536,191 @@ sensor_status_t sensor_get_output(sensor_output_resolution_t resolution,
 	}
 	return SENSOR_RESOLUTION_NOT_SUPPORTED;
 }
+
+/**
+ * \brief Retrieves the manual exposure control of the sensor set up by
+ * sensor_setup().
+ * \return Exposure registers and limits, NULL if not supported.
+ */
+const sensor_exposure_t *sensor_get_exposure_info(void)
+{
+	return p_sensor ? p_sensor->exposure : NULL;
+}
+
+/**
+ * \brief Get the frame length of the output set up by sensor_setup(), from
+ * the frame length registers of its register list. Registers the list does
+ * not set are read from the sensor.
+ * \param p_twid TWI interface
+ * \param lines pointer to frame length to be read, in lines.
+ * \return SENSOR_OK if no error; otherwise return SENSOR_XXX_ERROR
+ */
+static sensor_status_t sensor_get_frame_length(struct _twi_desc *p_twid,
+						uint32_t *lines)
+{
+	const sensor_exposure_t *info = p_sensor->exposure;
+	const sensor_reg_field_t *field;
+	const sensor_reg_t *p_reg;
+	/* use uint32_t to force 4-byte alignment */
+	uint32_t val;
+	bool found;
+	uint8_t i;
+
+	*lines = 0;
+	for (i = 0; i < ARRAY_SIZE(info->frame_length); i++) {
+		field = &info->frame_length[i];
+		if (!field->mask)
+			continue;
+		/* the last write of the list wins */
+		found = false;
+		for (p_reg = p_output->output_setting;
+		     p_reg->reg != SENSOR_REG_TERM || p_reg->val != SENSOR_VAL_TERM;
+		     p_reg++) {
+			if (p_reg->reg == field->reg) {
+				val = p_reg->val;
+				found = true;
+			}
+		}
+		if (!found) {
+			val = 0;
+			if (sensor_twi_read_reg(p_twid, field->reg, (uint8_t*)&val) != SENSOR_OK)
+				return SENSOR_TWI_ERROR;
+		}
+		*lines |= (val & field->mask) << field->shift;
+	}
+	return SENSOR_OK;
+}
+
+/**
+ * \brief Disable the sensor automatic exposure and gain control, and get
+ * the longest exposure time of the output set up by sensor_setup().
+ * \param p_twid TWI interface
+ * \return SENSOR_OK if no error; otherwise return SENSOR_XXX_ERROR
+ */
+sensor_status_t sensor_enable_manual_exposure(struct _twi_desc *p_twid)
+{
+	const sensor_exposure_t *info;
+	sensor_status_t status;
+	uint32_t lines;
+
+	if (!p_sensor || !p_sensor->exposure)
+		return SENSOR_NOT_SUPPORTED;
+	info = p_sensor->exposure;
+
+	status = sensor_get_frame_length(p_twid, &lines);
+	if (status != SENSOR_OK)
+		return status;
+	if (lines <= info->frame_margin)
+		return SENSOR_NOT_SUPPORTED;
+	exposure_max = (lines - info->frame_margin) * info->exposure_line;
+	if (exposure_max < info->exposure_min)
+		exposure_max = info->exposure_min;
+
+	if (!info->manual)
+		return SENSOR_OK;
+	return sensor_twi_write_regs(p_twid, info->manual);
+}
+
+/**
+ * \brief Get the longest exposure time of the current output.
+ * \return Exposure time, 0 if sensor_enable_manual_exposure() did not
+ * succeed since the last sensor_setup().
+ */
+uint32_t sensor_get_exposure_max(void)
+{
+	return exposure_max;
+}
+
+/**
+ * \brief Read the sensor exposure time and gain.
+ * \param p_twid TWI interface
+ * \param exposure pointer to exposure time to be read.
+ * \param gain pointer to gain to be read.
+ * \return SENSOR_OK if no error; otherwise return SENSOR_XXX_ERROR
+ */
+sensor_status_t sensor_get_exposure(struct _twi_desc *p_twid,
+					uint32_t *exposure,
+					uint16_t *gain)
+{
+	const sensor_exposure_t *info;
+	const sensor_reg_field_t *field;
+	/* use uint32_t to force 4-byte alignment */
+	uint32_t val;
+	uint8_t i;
+
+	info = sensor_get_exposure_info();
+	if (!info)
+		return SENSOR_NOT_SUPPORTED;
+
+	*exposure = 0;
+	for (i = 0; i < ARRAY_SIZE(info->exposure); i++) {
+		field = &info->exposure[i];
+		if (!field->mask)
+			continue;
+		val = 0;
+		if (sensor_twi_read_reg(p_twid, field->reg, (uint8_t*)&val) != SENSOR_OK)
+			return SENSOR_TWI_ERROR;
+		*exposure |= (val & field->mask) << field->shift;
+	}
+	*gain = 0;
+	for (i = 0; i < ARRAY_SIZE(info->gain); i++) {
+		field = &info->gain[i];
+		if (!field->mask)
+			continue;
+		val = 0;
+		if (sensor_twi_read_reg(p_twid, field->reg, (uint8_t*)&val) != SENSOR_OK)
+			return SENSOR_TWI_ERROR;
+		*gain |= (val & field->mask) << field->shift;
+	}
+	return SENSOR_OK;
+}
+
+/**
+ * \brief Program the sensor exposure time and gain. Values are clamped to
+ * the sensor and output limits; sensor_enable_manual_exposure() shall be
+ * called first.
+ * \param p_twid TWI interface
+ * \param exposure exposure time.
+ * \param gain gain.
+ * \return SENSOR_OK if no error; otherwise return SENSOR_XXX_ERROR
+ */
+sensor_status_t sensor_set_exposure(struct _twi_desc *p_twid,
+					uint32_t exposure,
+					uint16_t gain)
+{
+	const sensor_exposure_t *info;
+	const sensor_reg_field_t *field;
+	uint32_t val;
+	uint8_t i;
+
+	info = sensor_get_exposure_info();
+	if (!info || !exposure_max)
+		return SENSOR_NOT_SUPPORTED;
+
+	if (exposure < info->exposure_min)
+		exposure = info->exposure_min;
+	if (exposure > exposure_max)
+		exposure = exposure_max;
+	if (gain < info->gain_min)
+		gain = info->gain_min;
+	if (gain > info->gain_max)
+		gain = info->gain_max;
+
+	for (i = 0; i < ARRAY_SIZE(info->exposure); i++) {
+		field = &info->exposure[i];
+		if (!field->mask)
+			continue;
+		val = (exposure >> field->shift) & field->mask;
+		if (sensor_twi_write_reg(p_twid, field->reg, (uint8_t*)&val) != SENSOR_OK)
+			return SENSOR_TWI_ERROR;
+	}
+	for (i = 0; i < ARRAY_SIZE(info->gain); i++) {
+		field = &info->gain[i];
+		if (!field->mask)
+			continue;
+		val = (gain >> field->shift) & field->mask;
+		if (sensor_twi_write_reg(p_twid, field->reg, (uint8_t*)&val) != SENSOR_OK)
+			return SENSOR_TWI_ERROR;
+	}
+	return SENSOR_OK;
+}
@@ -36,6 +36,7 @@
  *        Headers
  *----------------------------------------------------------------------------*/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*---------------------------------------------------------------------------
@@ -47,6 +48,11 @@
 #define SENSOR_REG_TERM         0xFF
 /** terminating list entry for value in configuration file */
 #define SENSOR_VAL_TERM         0xFF
+/** list entry waiting for value milliseconds (e.g. after a sensor reset) */
+#define SENSOR_REG_DELAY        0xFFFF
+
+/** Largest number of data bytes written in one auto-increment transfer */
+#define SENSOR_BURST_MAX        64
 
 /*----------------------------------------------------------------------------
  *        Types
@@ -65,7 +71,9 @@ typedef enum _sensor_status {
 	SENSOR_OK = 0,        /**< Operation is successful */
 	SENSOR_TWI_ERROR,
 	SENSOR_ID_ERROR,
-	SENSOR_RESOLUTION_NOT_SUPPORTED
+	SENSOR_RESOLUTION_NOT_SUPPORTED,
+	SENSOR_NOT_SUPPORTED,
+	SENSOR_VERIFY_ERROR
 } sensor_status_t;
 
 /** Sensor TWI mode */
@@ -121,6 +129,37 @@ typedef struct _sensor_output {
 	const sensor_reg_t *output_setting;          /** sensor registers setting */
 } sensor_output_t;
 
+/** Register holding bits of an exposure or gain value: the register is
+ * written with (value >> shift) & mask, unused entries have a zero mask */
+typedef struct _sensor_reg_field {
+	uint16_t reg;
+	uint8_t shift;
+	uint8_t mask;
+} sensor_reg_field_t;
+
+/** Manual exposure control of a sensor */
+typedef struct _sensor_exposure {
+	const sensor_reg_t *manual;     /** Registers disabling the sensor AEC/AGC */
+	sensor_reg_field_t exposure[3]; /** Exposure time registers */
+	sensor_reg_field_t gain[2];     /** Gain registers */
+	sensor_reg_field_t frame_length[2]; /** Frame length (VTS) registers, in lines */
+	uint32_t exposure_min;          /** Shortest exposure time */
+	uint16_t exposure_line;         /** Exposure time of one line */
+	uint16_t frame_margin;          /** Lines of a frame the exposure cannot use */
+	uint16_t gain_min;              /** Lowest gain */
+	uint16_t gain_max;              /** Highest gain */
+	uint16_t gain_one;              /** Gain value for 1x */
+} sensor_exposure_t;
+
+/** Register list programming statistics */
+typedef struct _sensor_prog_stats {
+	uint32_t regs;                  /** Registers written */
+	uint32_t transfers;             /** TWI write transfers */
+	uint32_t verify_errors;         /** Registers read back with another value */
+	uint32_t write_time;            /** Write time, in timer ticks */
+	uint32_t verify_time;           /** Read-back time, in timer ticks */
+} sensor_prog_stats_t;
+
 /** define a structure for sensor profile */
 typedef struct _sensor_profile {
 	const char* name;             /** Sensor name */
@@ -133,6 +172,8 @@ typedef struct _sensor_profile {
 	uint16_t pid_low;             /** product ID low byte */
 	uint16_t version_mask;        /** version mask */
 	const sensor_output_t *output_conf[SENSOR_SUPPORTED_OUTPUTS]; /** sensor settings */
+	const sensor_exposure_t *exposure; /** manual exposure control, NULL if not supported */
+	uint8_t burst;                /** 1 if consecutive registers can be written in one transfer */
 } sensor_profile_t;
 
 /*----------------------------------------------------------------------------
@@ -153,6 +194,13 @@ extern const sensor_profile_t ov9740_profile;
 extern sensor_status_t sensor_twi_write_regs(struct _twi_desc *p_twid,
 						const sensor_reg_t *p_reglist);
 
+extern sensor_status_t sensor_twi_program_regs(struct _twi_desc *p_twid,
+						const sensor_reg_t *p_reglist,
+						bool verify,
+						sensor_prog_stats_t *stats);
+
+extern void sensor_get_program_stats(sensor_prog_stats_t *stats);
+
 extern sensor_status_t sensor_twi_read_regs(struct _twi_desc *p_twid,
 						const sensor_reg_t *p_reglist);
 
@@ -167,6 +215,20 @@ extern sensor_status_t sensor_get_output(sensor_output_resolution_t resolution,
 						uint32_t *width,
 						uint32_t *height);
 
+extern const sensor_exposure_t *sensor_get_exposure_info(void);
+
+extern sensor_status_t sensor_enable_manual_exposure(struct _twi_desc *p_twid);
+
+extern uint32_t sensor_get_exposure_max(void);
+
+extern sensor_status_t sensor_get_exposure(struct _twi_desc *p_twid,
+						uint32_t *exposure,
+						uint16_t *gain);
+
+extern sensor_status_t sensor_set_exposure(struct _twi_desc *p_twid,
+						uint32_t exposure,
+						uint16_t gain);
+
 #endif /* CONFIG_HAVE_IMAGE_SENSOR */
 
 #endif /* ! IMAGE_SENSOR_INF_H */
@@ -0,0 +1,339 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/** \addtogroup isc_3a_module
+ *@{
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "peripherals/dma.h"
+#include "peripherals/isc.h"
+#include "video/image_sensor_inf.h"
+#include "video/isc_3a.h"
+
+#include "misc/cache.h"
+
+#include "cam_3a.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Histogram acquisition steps */
+#define ISC_3A_IDLE      0 /**< Not running */
+#define ISC_3A_REQUEST   1 /**< Next channel to be requested */
+#define ISC_3A_WAIT_HIS  2 /**< Waiting for the ISC histogram */
+#define ISC_3A_WAIT_DMA  3 /**< Histogram table being read */
+#define ISC_3A_READ_DONE 4 /**< Histogram table read */
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _isc_3a {
+	struct _twi_desc    *twid;
+	uint32_t             bayer;   /**< ISC_HIS_CFG_BAYSEL_xxx */
+	struct dma_channel  *dma;
+	volatile uint8_t     step;
+	uint8_t              channel; /**< Histogram channel being acquired */
+	bool                 trace;   /**< Print a cam_3a trace on the console */
+	struct _cam_3a_state state;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Histogram tables, indexed by CAM_3A_GR..CAM_3A_B */
+CACHE_ALIGNED
+static uint32_t isc_3a_hist[CAM_3A_CHANNELS][CAM_3A_HIST_ENTRIES];
+
+static struct _isc_3a isc_3a;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _isc_3a_dma_callback(struct dma_channel *channel, void *arg)
+{
+	cache_invalidate_region(isc_3a_hist[isc_3a.channel],
+			sizeof(isc_3a_hist[0]));
+	isc_3a.step = ISC_3A_READ_DONE;
+}
+
+static void _isc_3a_apply(uint8_t changed)
+{
+	const struct _cam_3a_state *state = &isc_3a.state;
+
+	if (changed & CAM_3A_WB_CHANGED) {
+		isc_wb_adjust_bayer_color(0, 0, 0, 0,
+				state->wb_gain[CAM_3A_R],
+				state->wb_gain[CAM_3A_GR],
+				state->wb_gain[CAM_3A_B],
+				state->wb_gain[CAM_3A_GB]);
+		isc_update_profile();
+	}
+	if (changed & CAM_3A_AE_CHANGED) {
+		if (sensor_set_exposure(isc_3a.twid, state->exposure,
+					state->gain) != SENSOR_OK)
+			trace_warning("isc_3a: cannot set sensor exposure\r\n");
+	}
+}
+
+/**
+ * \brief Print the loop parameters and state, starting a cam_3a trace.
+ */
+static void _isc_3a_trace_state(void)
+{
+	const struct _cam_3a_state *state = &isc_3a.state;
+	const struct _cam_3a_cfg *cfg = &state->cfg;
+
+	printf("C %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u\r\n",
+	       cfg->wb_gain_min, cfg->wb_gain_max, cfg->wb_white_patch,
+	       cfg->wb_percentile, cfg->wb_step, cfg->ae_enabled,
+	       cfg->ae_target, cfg->ae_tolerance, cfg->ae_saturation,
+	       cfg->ae_step, cfg->ae_interval, (unsigned)cfg->exposure_min,
+	       (unsigned)cfg->exposure_max, cfg->gain_min, cfg->gain_max,
+	       cfg->gain_one);
+	printf("I %u %u %u %u %u %u %u\r\n",
+	       (unsigned)state->exposure, state->gain,
+	       state->wb_gain[CAM_3A_GR], state->wb_gain[CAM_3A_R],
+	       state->wb_gain[CAM_3A_GB], state->wb_gain[CAM_3A_B],
+	       state->ae_wait);
+}
+
+/**
+ * \brief Print the histograms of an update and its result.
+ */
+static void _isc_3a_trace_update(uint8_t changed)
+{
+	const struct _cam_3a_state *state = &isc_3a.state;
+	const uint32_t *hist;
+	int c, i, first, last;
+
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		hist = isc_3a_hist[c];
+		first = 0;
+		last = CAM_3A_HIST_ENTRIES - 1;
+		while (first < last && !hist[first])
+			first++;
+		while (last > first && !hist[last])
+			last--;
+		printf("H %d %d %d", c, first, last - first + 1);
+		for (i = first; i <= last; i++)
+			printf(" %u", (unsigned)hist[i]);
+		printf("\r\n");
+	}
+	printf("U %u %u %u %u %u %u %u %u\r\n", changed,
+	       state->wb_gain[CAM_3A_GR], state->wb_gain[CAM_3A_R],
+	       state->wb_gain[CAM_3A_GB], state->wb_gain[CAM_3A_B],
+	       (unsigned)state->exposure, state->gain, state->green_mean);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Start the control loop.
+ *
+ * If the sensor supports manual exposure control, its automatic exposure is
+ * disabled and the loop starts from the current exposure; otherwise only
+ * the white balance is controlled.
+ *
+ * \param twid   TWI interface of the sensor.
+ * \param bayer  Bayer pattern of the sensor, ISC_HIS_CFG_BAYSEL_xxx.
+ * \param cfg    Control loop parameters, NULL for the defaults. The sensor
+ *               limits are taken from the sensor profile.
+ * \return true on success, false if no DMA channel is available.
+ */
+bool isc_3a_start(struct _twi_desc *twid, uint32_t bayer,
+		const struct _cam_3a_cfg *cfg)
+{
+	const sensor_exposure_t *info = sensor_get_exposure_info();
+	struct _cam_3a_cfg loop_cfg;
+	uint32_t exposure = 0;
+	uint16_t gain = 0;
+
+	isc_3a_stop();
+
+	if (!isc_3a.dma) {
+		isc_3a.dma = dma_allocate_channel(DMA_PERIPH_MEMORY,
+				DMA_PERIPH_MEMORY);
+		if (!isc_3a.dma)
+			return false;
+	}
+
+	if (cfg) {
+		loop_cfg = *cfg;
+	} else {
+		cam_3a_default_cfg(&loop_cfg);
+		loop_cfg.ae_enabled = true;
+	}
+	if (info && loop_cfg.ae_enabled &&
+	    sensor_enable_manual_exposure(twid) == SENSOR_OK &&
+	    sensor_get_exposure(twid, &exposure, &gain) == SENSOR_OK) {
+		loop_cfg.exposure_min = info->exposure_min;
+		loop_cfg.exposure_max = sensor_get_exposure_max();
+		loop_cfg.gain_min = info->gain_min;
+		loop_cfg.gain_max = info->gain_max;
+		loop_cfg.gain_one = info->gain_one;
+	} else {
+		loop_cfg.ae_enabled = false;
+	}
+	cam_3a_init(&isc_3a.state, &loop_cfg, exposure, gain);
+
+	isc_3a.twid = twid;
+	isc_3a.bayer = bayer;
+	isc_3a.trace = false;
+	isc_3a.channel = 0;
+	isc_histogram_enabled(1);
+	isc_3a.step = ISC_3A_REQUEST;
+	return true;
+}
+
+/**
+ * \brief Stop the control loop, the gains and exposure are left as is.
+ */
+void isc_3a_stop(void)
+{
+	if (isc_3a.step == ISC_3A_IDLE)
+		return;
+
+	/* Let a histogram read complete */
+	while (isc_3a.step == ISC_3A_WAIT_DMA)
+		dma_poll();
+	isc_3a.step = ISC_3A_IDLE;
+}
+
+/**
+ * \brief Read the histogram table computed by the ISC.
+ *
+ * Shall be called from the ISC interrupt handler on ISC_INTSR_HISDONE. The
+ * table is copied by DMA, so that the next channel can be requested for
+ * the following frame.
+ */
+void isc_3a_histogram_done(void)
+{
+	struct dma_xfer_cfg cfg;
+
+	if (isc_3a.step != ISC_3A_WAIT_HIS)
+		return;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.sa = (void*)&ISC->ISC_HIS_ENTRY[0];
+	cfg.da = isc_3a_hist[isc_3a.channel];
+	cfg.upd_sa_per_data = 1;
+	cfg.upd_da_per_data = 1;
+	cfg.data_width = DMA_DATA_WIDTH_WORD;
+	cfg.chunk_size = DMA_CHUNK_SIZE_1;
+	cfg.len = CAM_3A_HIST_ENTRIES;
+	isc_3a.step = ISC_3A_WAIT_DMA;
+	dma_configure_transfer(isc_3a.dma, &cfg);
+	dma_set_callback(isc_3a.dma, _isc_3a_dma_callback, NULL);
+	dma_start_transfer(isc_3a.dma);
+}
+
+/**
+ * \brief Advance the control loop.
+ *
+ * Requests the next histogram channel and, once the four channels are
+ * read, runs cam_3a_update() and programs the results.
+ *
+ * \return The cam_3a_update() flags of the values just programmed, 0 if
+ * nothing changed.
+ */
+uint8_t isc_3a_process(void)
+{
+	const uint32_t *hist[CAM_3A_CHANNELS];
+	uint8_t c, changed;
+
+	dma_poll();
+
+	switch (isc_3a.step) {
+	case ISC_3A_REQUEST:
+		isc_histogram_configure(ISC_HIS_CFG_MODE(isc_3a.channel),
+				isc_3a.bayer, 1);
+		isc_update_profile();
+		isc_3a.step = ISC_3A_WAIT_HIS;
+		isc_update_histogram_table();
+		return 0;
+
+	case ISC_3A_READ_DONE:
+		isc_3a.step = ISC_3A_REQUEST;
+		if (++isc_3a.channel < CAM_3A_CHANNELS)
+			return 0;
+		isc_3a.channel = 0;
+
+		for (c = 0; c < CAM_3A_CHANNELS; c++)
+			hist[c] = isc_3a_hist[c];
+		changed = cam_3a_update(&isc_3a.state, hist);
+		if (isc_3a.trace)
+			_isc_3a_trace_update(changed);
+		_isc_3a_apply(changed);
+		return changed;
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief Print the histograms and the results of each update on the
+ * console, in the cam_3a trace format (see cam_3a.h). The trace can be
+ * replayed on the host by tests/host/test_cam_3a.
+ * \param enable  true to start a trace, false to stop it.
+ */
+void isc_3a_set_trace(bool enable)
+{
+	if (enable && !isc_3a.trace && isc_3a.step != ISC_3A_IDLE)
+		_isc_3a_trace_state();
+	isc_3a.trace = enable && isc_3a.step != ISC_3A_IDLE;
+}
+
+/**
+ * \brief Get the control loop state: gains, exposure and last mean level.
+ */
+const struct _cam_3a_state *isc_3a_get_state(void)
+{
+	return &isc_3a.state;
+}
+
+/**@}*/
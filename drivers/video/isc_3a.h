@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/**
+ * \ingroup lib_board
+ * \addtogroup isc_3a_module ISC Auto Exposure and White Balance
+ *
+ * \section Purpose
+ *
+ * Closes the auto-exposure and auto-white-balance loop of \ref cam_3a.h
+ * on an ISC capturing raw Bayer data. One ISC histogram channel (Gr, R, Gb
+ * or B) is computed per frame and read by DMA; once the four channels are
+ * read, the white balance gains are programmed in the ISC WB module and
+ * the exposure time and gain in the sensor.
+ *
+ * \section Usage
+ *
+ * -# Set up the sensor with sensor_setup() and the ISC with the WB module
+ *    enabled.
+ * -# Call isc_3a_start(), then isc_3a_histogram_done() from the ISC
+ *    interrupt handler on ISC_INTSR_HISDONE.
+ * -# Call isc_3a_process() from the main loop; it programs the ISC and the
+ *    sensor and shall not be called from an interrupt handler.
+ * -# Optionally, isc_3a_set_trace() prints each update on the console, to
+ *    be replayed on the host.
+ *
+ * @{
+ */
+
+#ifndef _ISC_3A_H_
+#define _ISC_3A_H_
+
+#if defined(CONFIG_HAVE_ISC) && defined(CONFIG_HAVE_IMAGE_SENSOR)
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "cam_3a.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+struct _twi_desc;
+
+extern bool isc_3a_start(struct _twi_desc *twid, uint32_t bayer,
+		const struct _cam_3a_cfg *cfg);
+
+extern void isc_3a_stop(void);
+
+extern void isc_3a_histogram_done(void);
+
+extern uint8_t isc_3a_process(void);
+
+extern void isc_3a_set_trace(bool enable);
+
+extern const struct _cam_3a_state *isc_3a_get_state(void);
+
+#endif /* CONFIG_HAVE_ISC && CONFIG_HAVE_IMAGE_SENSOR */
+
+#endif /* _ISC_3A_H_ */
+
+/**@}*/
@@ -0,0 +1,238 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/** \addtogroup isc_preview_module
+ *@{
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "peripherals/isc.h"
+#include "video/isc_preview.h"
+#include "video/lcdd.h"
+
+#include "misc/cache.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+/** Preview pipeline state, buffers are referenced by index (-1 if none) */
+struct _isc_preview {
+	struct _isc_preview_cfg   cfg;
+	volatile int8_t           capture; /**< buffer written by the ISC */
+	volatile int8_t           ready;   /**< complete, waiting for the LCDC */
+	volatile int8_t           pending; /**< queued to the LCDC */
+	volatile int8_t           front;   /**< displayed */
+	struct _isc_preview_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** ISC DMA descriptors, one looping descriptor per buffer. View 0 and view 1
+ * descriptors are prefixes of the view 2 layout. */
+CACHE_ALIGNED_DDR
+static struct _isc_dma_view2 preview_desc[ISC_PREVIEW_MAX_BUFFERS];
+
+static struct _isc_preview preview;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Return a buffer not used by the ISC nor by the LCDC, -1 if none
+ */
+static int8_t _free_buffer(void)
+{
+	int8_t i;
+
+	for (i = 0; i < preview.cfg.count; i++)
+		if (i != preview.capture && i != preview.ready &&
+		    i != preview.pending && i != preview.front)
+			return i;
+	return -1;
+}
+
+static void _flip_done(uint8_t layer, void *arg);
+
+/**
+ * Queue a buffer to the LCDC
+ */
+static bool _queue(int8_t index)
+{
+	struct _isc_preview_buffer *buf = &preview.cfg.buffers[index];
+
+	if (!lcdd_flip_buffer(preview.cfg.layer, buf->lcd_addr[0],
+			buf->lcd_addr[1], buf->lcd_addr[2], _flip_done, NULL))
+		return false;
+	preview.pending = index;
+	return true;
+}
+
+/**
+ * LCDC flip completion: the queued buffer is on screen and the previous one
+ * is free again
+ */
+static void _flip_done(uint8_t layer, void *arg)
+{
+	if (preview.pending < 0)
+		return;
+
+	preview.front = preview.pending;
+	preview.pending = -1;
+	preview.stats.displayed++;
+
+	if (preview.ready >= 0 && _queue(preview.ready))
+		preview.ready = -1;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Set up the capture buffers and their ISC DMA descriptors.
+ *
+ * Buffer 0 is expected to be on screen already. A flip left queued by a
+ * previous preview is waited for.
+ *
+ * \param cfg  Pipeline configuration.
+ * \return true on success, false if the number of buffers is out of range.
+ */
+bool isc_preview_configure(const struct _isc_preview_cfg *cfg)
+{
+	uint8_t i;
+
+	if (cfg->count < 3 || cfg->count > ISC_PREVIEW_MAX_BUFFERS)
+		return false;
+
+	while (lcdd_is_flip_pending(cfg->layer));
+
+	memset(&preview, 0, sizeof(preview));
+	preview.cfg = *cfg;
+	preview.capture = -1;
+	preview.ready = -1;
+	preview.pending = -1;
+	preview.front = 0;
+
+	for (i = 0; i < cfg->count; i++) {
+		preview_desc[i].ctrl = cfg->dview | ISC_DCTRL_DE;
+		preview_desc[i].next_desc = (uint32_t)&preview_desc[i];
+		preview_desc[i].addr0 = cfg->buffers[i].isc_addr[0];
+		preview_desc[i].stride0 = 0;
+		preview_desc[i].addr1 = cfg->buffers[i].isc_addr[1];
+		preview_desc[i].stride1 = 0;
+		preview_desc[i].addr2 = cfg->buffers[i].isc_addr[2];
+		preview_desc[i].stride2 = 0;
+	}
+	cache_clean_region(preview_desc, sizeof(preview_desc));
+	return true;
+}
+
+/**
+ * \brief Enable the ISC DMA on the first buffer not on screen. The ISC DMA
+ * input mode shall already be configured; capture is started by the
+ * caller with isc_start_capture().
+ */
+void isc_preview_start(void)
+{
+	preview.capture = 1;
+	isc_dma_configure_desc_entry((uint32_t)&preview_desc[1]);
+	isc_dma_enable(preview.cfg.dview | ISC_DCTRL_DE);
+}
+
+/**
+ * \brief Handle the end of a frame written by the ISC DMA.
+ *
+ * Shall be called from the ISC interrupt handler on ISC_INTSR_DDONE. The
+ * completed buffer is queued for display and the next descriptor is
+ * selected before the ISC fetches it at the next vertical sync.
+ */
+void isc_preview_dma_done(void)
+{
+	int8_t done = preview.capture;
+	int8_t next;
+
+	if (done < 0)
+		return;
+	preview.capture = -1;
+	preview.stats.captured++;
+
+	if (preview.pending < 0 && _queue(done)) {
+		/* An older waiting frame is superseded */
+		if (preview.ready >= 0) {
+			preview.ready = -1;
+			preview.stats.dropped++;
+		}
+	} else {
+		if (preview.ready >= 0)
+			preview.stats.dropped++;
+		preview.ready = done;
+	}
+
+	next = _free_buffer();
+	if (next < 0) {
+		/* Display lagging behind: overwrite the waiting frame */
+		next = preview.ready;
+		preview.ready = -1;
+		preview.stats.dropped++;
+	}
+	preview.capture = next;
+	isc_dma_configure_desc_entry((uint32_t)&preview_desc[next]);
+}
+
+/**
+ * \brief Get the preview statistics since configuration or last reset.
+ * \param stats  Filled with the frame counts.
+ */
+void isc_preview_get_stats(struct _isc_preview_stats *stats)
+{
+	*stats = preview.stats;
+}
+
+/**
+ * \brief Reset the preview statistics.
+ */
+void isc_preview_reset_stats(void)
+{
+	memset(&preview.stats, 0, sizeof(preview.stats));
+}
+
+/**@}*/
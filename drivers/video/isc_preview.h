@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/**
+ * \ingroup lib_board
+ * \addtogroup isc_preview_module ISC Preview Pipeline
+ *
+ * \section Purpose
+ *
+ * Zero-copy camera preview: the ISC DMA writes frames into a ring of
+ * buffers that the LCDC layer (usually HEO) scans out directly.
+ *
+ * \section Usage
+ *
+ * -# Configure the LCDC layer on buffer 0 with lcdd_create_canvas() or one
+ *    of its YUV variants, in the format written by the ISC.
+ * -# Configure the ISC pipeline and DMA input mode, then call
+ *    isc_preview_configure() and isc_preview_start().
+ * -# Call isc_preview_dma_done() from the ISC interrupt handler on
+ *    ISC_INTSR_DDONE.
+ * -# isc_preview_get_stats() returns the captured, displayed and dropped
+ *    frame counts.
+ *
+ * Each completed frame is queued to the LCDC, which switches to it at the
+ * end of the frame being displayed. If the display is still busy with a
+ * previous flip, the newest frame waits and supersedes any older waiting
+ * one, which is counted as dropped. The ISC never writes into the buffer on
+ * screen nor into the one queued for display.
+ *
+ * @{
+ */
+
+#ifndef _ISC_PREVIEW_H_
+#define _ISC_PREVIEW_H_
+
+#ifdef CONFIG_HAVE_ISC
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of capture buffers */
+#define ISC_PREVIEW_MAX_BUFFERS 4
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Planes of a capture buffer, as seen by the ISC and by the LCDC */
+struct _isc_preview_buffer {
+	uint32_t isc_addr[3]; /**< ISC DMA addresses 0..2 (unused ones are 0) */
+	void    *lcd_addr[3]; /**< LCDC Y or packed, U or UV, V planes (or NULL) */
+};
+
+/** Preview pipeline configuration */
+struct _isc_preview_cfg {
+	uint8_t  layer;   /**< LCDC layer showing the frames, e.g. LCDD_HEO */
+	uint32_t dview;   /**< ISC_DCTRL_DVIEW_PACKED, _SEMIPLANAR or _PLANAR */
+	uint8_t  count;   /**< Number of buffers, 3..ISC_PREVIEW_MAX_BUFFERS */
+	struct _isc_preview_buffer buffers[ISC_PREVIEW_MAX_BUFFERS];
+};
+
+/** Preview pipeline statistics */
+struct _isc_preview_stats {
+	uint32_t captured;  /**< Frames written by the ISC */
+	uint32_t displayed; /**< Frames put on screen */
+	uint32_t dropped;   /**< Frames captured but never displayed */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+extern bool isc_preview_configure(const struct _isc_preview_cfg *cfg);
+
+extern void isc_preview_start(void);
+
+extern void isc_preview_dma_done(void);
+
+extern void isc_preview_get_stats(struct _isc_preview_stats *stats);
+
+extern void isc_preview_reset_stats(void);
+
+#endif /* CONFIG_HAVE_ISC */
+
+#endif /* _ISC_PREVIEW_H_ */
+
+/**@}*/
@@ -37,10 +37,13 @@
 #include "compiler.h"
 
 #include "video/lcdd.h"
+#include "peripherals/aic.h"
 #include "peripherals/pio.h"
 #include "peripherals/pmc.h"
 #include "misc/cache.h"
 
+#include "timer.h"
+
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
@@ -71,6 +74,7 @@ struct _layer_info {
 	volatile uint32_t  *reg_color;      /**< regs: RGB Default, RGB Key, RGB Mask */
 	volatile uint32_t  *reg_scale;      /**< regs: scale */
 	volatile uint32_t  *reg_clut;       /**< regs: CLUT */
+	uint32_t            irq_mask;       /**< layer bit in LCDC_LCDIER/ISR */
 };
 
 /** DMA descriptor for LCDC */
@@ -90,6 +94,29 @@ struct _layer_data {
 	uint8_t                num_colors;
 };
 
+/** Frame pipeline state of a layer */
+struct _layer_frame {
+	void                  *buffers[LCDD_FRAME_MAX_BUFFERS];
+	struct _lcdc_dma_desc *desc;       /**< one looping descriptor per buffer */
+	uint8_t                count;      /**< number of buffers, 0 if unused */
+	volatile int8_t        front;      /**< buffer being displayed */
+	volatile int8_t        pending;    /**< buffer queued for the next flip */
+	int8_t                 back;       /**< buffer being rendered */
+	uint32_t               size;       /**< buffer size in bytes */
+	uint32_t               begin_tick; /**< timer tick at lcdd_frame_begin() */
+	uint32_t               present_vsync; /**< vsync count at present */
+	uint32_t               vsync_ref;  /**< vsync count at stats reset */
+	struct _lcdd_frame_stats stats;
+};
+
+/** Flip state of a layer showing externally filled buffers */
+struct _layer_flip {
+	lcdd_flip_callback_t   cb;
+	void                  *arg;
+	void * volatile        pending;    /**< buffer queued, NULL if none */
+	uint8_t                set;        /**< descriptor set for the next flip */
+};
+
 /*----------------------------------------------------------------------------
  *        Local variables
  *----------------------------------------------------------------------------*/
@@ -129,6 +156,20 @@ static struct _lcdc_dma_desc hcc_dma_desc;   /**< DMA desc. for HCC Layer */
 
 static struct _layer_data lcdd_hcc;          /**< HCC Layer */
 
+CACHE_ALIGNED_DDR
+static struct _lcdc_dma_desc frame_dma_desc[LCDD_OVR2 + 1][LCDD_FRAME_MAX_BUFFERS]; /**< DMA desc. for frame buffers */
+
+static struct _layer_frame lcdd_frames[LCDD_OVR2 + 1]; /**< Frame pipelines, indexed by layer ID */
+
+CACHE_ALIGNED_DDR
+static struct _lcdc_dma_desc flip_dma_desc[LCDD_OVR2 + 1][2][3]; /**< DMA desc. for flips: two sets of Y, U, V */
+
+static struct _layer_flip lcdd_flips[LCDD_OVR2 + 1]; /**< Flip states, indexed by layer ID */
+
+static volatile uint32_t lcdd_vsync_count;   /**< Start of frame counter */
+
+static bool lcdd_irq_installed;              /**< LCDC interrupt handler set */
+
 /*----------------------------------------------------------------------------
  *        Local constants
  *----------------------------------------------------------------------------*/
@@ -151,7 +192,8 @@ static const struct _layer_info lcdd_layers[] = {
 		.reg_cfg = &LCDC->LCDC_BASECFG0,
 		.reg_stride = &LCDC->LCDC_BASECFG2,
 		.reg_color = &LCDC->LCDC_BASECFG3,
-		.reg_clut = &LCDC->LCDC_BASECLUT[0]
+		.reg_clut = &LCDC->LCDC_BASECLUT[0],
+		.irq_mask = LCDC_LCDIER_BASEIE,
 	},
 	/* 2: LCDD_OVR1 */
 	{
@@ -165,6 +207,7 @@ static const struct _layer_info lcdd_layers[] = {
 		.reg_stride = &LCDC->LCDC_OVR1CFG4,
 		.reg_color = &LCDC->LCDC_OVR1CFG6,
 		.reg_clut = &LCDC->LCDC_OVR1CLUT[0],
+		.irq_mask = LCDC_LCDIER_OVR1IE,
 	},
 	/* 3: LCDD_HEO */
 	{
@@ -181,6 +224,7 @@ static const struct _layer_info lcdd_layers[] = {
 		.reg_color = &LCDC->LCDC_HEOCFG9,
 		.reg_scale = &LCDC->LCDC_HEOCFG13,
 		.reg_clut = &LCDC->LCDC_HEOCLUT[0],
+		.irq_mask = LCDC_LCDIER_HEOIE,
 	},
 	/* 4: LCDD_OVR2 */
 	{
@@ -194,6 +238,7 @@ static const struct _layer_info lcdd_layers[] = {
 		.reg_stride = &LCDC->LCDC_OVR2CFG4,
 		.reg_color = &LCDC->LCDC_OVR2CFG6,
 		.reg_clut = &LCDC->LCDC_OVR2CLUT[0],
+		.irq_mask = LCDC_LCDIER_OVR2IE,
 	},
 	/* 5: N/A */
 	{
@@ -303,6 +348,107 @@ static void _clear_dma_desc(struct _lcdc_dma_desc *desc,
 	dma_head_reg[3] = (uint32_t)desc;
 }
 
+/**
+ * LCDC interrupt handler: counts refresh cycles and completes the flips
+ * queued by lcdd_frame_present().
+ */
+static void _lcdc_handler(void)
+{
+	uint32_t status = LCDC->LCDC_LCDISR;
+	uint8_t layer_id;
+
+	if (status & LCDC_LCDISR_SOF)
+		lcdd_vsync_count++;
+
+	for (layer_id = LCDD_BASE; layer_id < ARRAY_SIZE(lcdd_frames); layer_id++) {
+		const struct _layer_info *layer = &lcdd_layers[layer_id];
+		struct _layer_frame *frame = &lcdd_frames[layer_id];
+		struct _layer_flip *flip = &lcdd_flips[layer_id];
+
+		if (!(status & layer->irq_mask))
+			continue;
+
+		/* Layer status is cleared on read */
+		if (!(layer->reg_enable[6] & LCDC_BASEISR_ADD))
+			continue;
+
+		/* Head descriptor loaded: the queued buffer is now scanned out
+		 * and the previous front buffer is free */
+		if (frame->count && frame->pending >= 0) {
+			frame->front = frame->pending;
+			frame->pending = -1;
+			layer->data->buffer = frame->buffers[frame->front];
+			frame->stats.flips++;
+			if (lcdd_vsync_count - frame->present_vsync > 1)
+				frame->stats.late++;
+		}
+
+		if (flip->pending) {
+			layer->data->buffer = flip->pending;
+			flip->pending = NULL;
+			if (flip->cb)
+				flip->cb(layer_id, flip->arg);
+		}
+	}
+}
+
+/**
+ * Install the LCDC interrupt handler and enable start of frame interrupts
+ */
+static void _lcdc_enable_irq(void)
+{
+	if (lcdd_irq_installed)
+		return;
+
+	aic_set_source_vector(ID_LCDC, _lcdc_handler);
+	LCDC->LCDC_LCDIER = LCDC_LCDIER_SOFIE;
+	aic_enable(ID_LCDC);
+	lcdd_irq_installed = true;
+}
+
+/**
+ * Return a buffer neither displayed nor queued for display, -1 if none
+ */
+static int8_t _frame_free_buffer(const struct _layer_frame *frame)
+{
+	int8_t i;
+
+	for (i = 0; i < frame->count; i++)
+		if (i != frame->front && i != frame->pending)
+			return i;
+	return -1;
+}
+
+/**
+ * Wait for the queued flip of a layer to complete.
+ *
+ * A disabled layer never loads its DMA head, so the queued buffer is taken
+ * as displayed at once: the LCDC fetches it first when the layer is turned
+ * back on. Otherwise wait at most LCDD_FRAME_FLIP_TIMEOUT frame periods.
+ *
+ * \return true if no flip is pending anymore, false on timeout.
+ */
+static bool _frame_wait_flip(uint8_t layer_id)
+{
+	const struct _layer_info *layer = &lcdd_layers[layer_id];
+	struct _layer_frame *frame = &lcdd_frames[layer_id];
+	uint32_t start, timeout;
+
+	timeout = 1000 * LCDD_FRAME_FLIP_TIMEOUT / (lcdd_config.framerate ? lcdd_config.framerate : 1);
+	start = timer_get_tick();
+	while (frame->pending >= 0) {
+		if (!lcdd_is_layer_on(layer_id)) {
+			frame->front = frame->pending;
+			frame->pending = -1;
+			layer->data->buffer = frame->buffers[frame->front];
+			break;
+		}
+		if (timer_get_interval(start, timer_get_tick()) > timeout)
+			return false;
+	}
+	return true;
+}
+
 /**
  * Return scaling factor
  */
@@ -400,6 +546,10 @@ void lcdd_configure(const struct _lcdd_desc *desc)
 	/* No canvas selected */
 	lcdd_canvas.buffer = NULL;
 
+	/* No frame pipeline */
+	memset(lcdd_frames, 0, sizeof(lcdd_frames));
+	memset(lcdd_flips, 0, sizeof(lcdd_flips));
+
 	/* Enable peripheral clock */
 	pmc_enable_peripheral(ID_LCDC);
 	pmc_enable_system_clock(PMC_SYSTEM_CLOCK_LCD);
@@ -1370,8 +1520,8 @@ uint8_t lcdd_select_canvas(uint8_t layer_id)
 
 	lcdd_canvas.buffer = (void *)layer->data->buffer;
 	if (layer->reg_win) {
-		lcdd_canvas.width = (layer->reg_win[1] & LCDC_HEOCFG3_XSIZE_Msk) >> LCDC_HEOCFG3_XSIZE_Pos;
-		lcdd_canvas.height = (layer->reg_win[1] & LCDC_HEOCFG3_YSIZE_Msk) >> LCDC_HEOCFG3_YSIZE_Pos;
+		lcdd_canvas.width = ((layer->reg_win[1] & LCDC_HEOCFG3_XSIZE_Msk) >> LCDC_HEOCFG3_XSIZE_Pos) + 1;
+		lcdd_canvas.height = ((layer->reg_win[1] & LCDC_HEOCFG3_YSIZE_Msk) >> LCDC_HEOCFG3_YSIZE_Pos) + 1;
 	} else {
 		lcdd_canvas.width = lcdd_config.width;
 		lcdd_canvas.height = lcdd_config.height;
@@ -1553,4 +1703,295 @@ void lcdd_configure_input_mode(uint8_t layer_id, uint32_t input_mode)
 	layer->reg_cfg[1] = input_mode;
 }
 
+/**
+ * \brief Set up the frame pipeline of a layer.
+ *
+ * The layer shall already display one of the buffers, e.g. after
+ * lcdd_create_canvas() or lcdd_show_base(). All buffers shall have the same
+ * size and format. Drawing then goes through lcdd_frame_begin() and
+ * lcdd_frame_present(), the LCDC switching buffers at the end of a frame.
+ *
+ * \param layer_id  Layer ID (BASE, OVR1, OVR2 or HEO in RGB mode).
+ * \param buffers   Display buffers.
+ * \param count     Number of buffers, 2 (double buffering) or 3 (triple
+ *                  buffering).
+ * \return true on success.
+ */
+bool lcdd_frame_setup(uint8_t layer_id, void **buffers, uint8_t count)
+{
+	const struct _layer_info *layer = &lcdd_layers[layer_id];
+	struct _layer_frame *frame;
+	uint32_t row;
+	int8_t i;
+
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames))
+		return false;
+	if (count < 2 || count > LCDD_FRAME_MAX_BUFFERS)
+		return false;
+	if (!lcdd_select_canvas(layer_id))
+		return false;
+
+	frame = &lcdd_frames[layer_id];
+	memset(frame, 0, sizeof(*frame));
+	frame->front = -1;
+	for (i = 0; i < count; i++) {
+		frame->buffers[i] = buffers[i];
+		if (buffers[i] == layer->data->buffer)
+			frame->front = i;
+	}
+	if (frame->front < 0)
+		return false;
+
+	row = (lcdd_canvas.width * lcdd_canvas.bpp + 7) / 8;
+	frame->size = ((row + 3) & ~3u) * lcdd_canvas.height;
+	frame->desc = frame_dma_desc[layer_id];
+	frame->pending = -1;
+	frame->back = -1;
+	frame->vsync_ref = lcdd_vsync_count;
+
+	_lcdc_enable_irq();
+	layer->reg_enable[3] = LCDC_BASEIER_ADD;
+	LCDC->LCDC_LCDIER = layer->irq_mask;
+
+	frame->count = count;
+	return true;
+}
+
+/**
+ * \brief Stop using the frame pipeline of a layer. The buffer currently
+ * displayed stays on screen.
+ * \param layer_id  Layer ID.
+ */
+void lcdd_frame_release(uint8_t layer_id)
+{
+	const struct _layer_info *layer = &lcdd_layers[layer_id];
+	struct _layer_frame *frame;
+
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames))
+		return;
+	frame = &lcdd_frames[layer_id];
+	if (!frame->count)
+		return;
+
+	/* Let a queued flip complete, drop it if the LCDC does not load it */
+	if (!_frame_wait_flip(layer_id))
+		frame->pending = -1;
+
+	LCDC->LCDC_LCDIDR = layer->irq_mask;
+	layer->reg_enable[4] = LCDC_BASEIDR_ADD;
+	frame->count = 0;
+}
+
+/**
+ * \brief Start rendering a frame.
+ *
+ * Waits for a buffer that is neither displayed nor queued for display, and
+ * selects it as canvas. With two buffers this waits for the previous flip,
+ * with three buffers rendering can run one frame ahead.
+ *
+ * \param layer_id  Layer ID.
+ * \return The back buffer to draw into, NULL if the layer has no frame
+ * pipeline or if the previous flip did not complete in time.
+ */
+void *lcdd_frame_begin(uint8_t layer_id)
+{
+	struct _layer_frame *frame;
+	uint32_t start;
+	int8_t back;
+
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames))
+		return NULL;
+	frame = &lcdd_frames[layer_id];
+	if (!frame->count)
+		return NULL;
+
+	if (frame->back < 0) {
+		start = timer_get_tick();
+		back = _frame_free_buffer(frame);
+		if (back < 0) {
+			/* All other buffers are displayed or queued */
+			if (!_frame_wait_flip(layer_id))
+				return NULL;
+			back = _frame_free_buffer(frame);
+		}
+		frame->back = back;
+		frame->stats.wait_total += timer_get_interval(start, timer_get_tick());
+	}
+	frame->begin_tick = timer_get_tick();
+
+	lcdd_select_canvas(layer_id);
+	lcdd_canvas.buffer = frame->buffers[frame->back];
+	return lcdd_canvas.buffer;
+}
+
+/**
+ * \brief Queue the frame rendered since lcdd_frame_begin() for display.
+ *
+ * The back buffer is flushed from the data cache and added to the LCDC DMA
+ * queue, the LCDC switching to it at the end of the current frame. Only
+ * the layers that changed need to be presented.
+ *
+ * \param layer_id  Layer ID.
+ * \return true on success, false if no frame was begun or if the previous
+ * flip did not complete in time (the frame can be presented again).
+ */
+bool lcdd_frame_present(uint8_t layer_id)
+{
+	const struct _layer_info *layer = &lcdd_layers[layer_id];
+	struct _layer_frame *frame;
+	struct _lcdc_dma_desc *desc;
+	uint32_t render;
+	int8_t back;
+
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames))
+		return false;
+	frame = &lcdd_frames[layer_id];
+	back = frame->back;
+	if (!frame->count || back < 0)
+		return false;
+
+	render = timer_get_interval(frame->begin_tick, timer_get_tick());
+	frame->stats.render_last = render;
+	frame->stats.render_total += render;
+	if (render > frame->stats.render_max)
+		frame->stats.render_max = render;
+
+	cache_clean_region(frame->buffers[back], frame->size);
+
+	/* Only one flip can be queued */
+	if (!_frame_wait_flip(layer_id))
+		return false;
+
+	desc = &frame->desc[back];
+	desc->addr = (uint32_t)frame->buffers[back];
+	desc->ctrl = LCDC_BASECTRL_DFETCH | LCDC_BASECTRL_ADDIEN;
+	desc->next = (uint32_t)desc;
+	cache_clean_region(desc, sizeof(*desc));
+
+	frame->present_vsync = lcdd_vsync_count;
+	frame->pending = back;
+	frame->back = -1;
+	frame->stats.frames++;
+
+	layer->reg_dma_head[0] = (uint32_t)desc;
+	layer->reg_enable[0] = LCDC_BASECHER_A2QEN;
+	return true;
+}
+
+/**
+ * \brief Wait for the next start of frame.
+ */
+void lcdd_wait_vsync(void)
+{
+	uint32_t count;
+
+	_lcdc_enable_irq();
+	count = lcdd_vsync_count;
+	while (count == lcdd_vsync_count);
+}
+
+/**
+ * \brief Get the frame-time statistics of a layer.
+ * \param layer_id  Layer ID.
+ * \param stats     Filled with the statistics since setup or last reset.
+ */
+void lcdd_frame_get_stats(uint8_t layer_id, struct _lcdd_frame_stats *stats)
+{
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames)) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+	*stats = lcdd_frames[layer_id].stats;
+	stats->vsyncs = lcdd_vsync_count - lcdd_frames[layer_id].vsync_ref;
+}
+
+/**
+ * \brief Reset the frame-time statistics of a layer.
+ * \param layer_id  Layer ID.
+ */
+void lcdd_frame_reset_stats(uint8_t layer_id)
+{
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_frames))
+		return;
+	memset(&lcdd_frames[layer_id].stats, 0, sizeof(struct _lcdd_frame_stats));
+	lcdd_frames[layer_id].vsync_ref = lcdd_vsync_count;
+}
+
+/**
+ * \brief Switch a layer to a buffer filled by another DMA master.
+ *
+ * The buffer is queued to the LCDC DMA without any copy and without cache
+ * maintenance on the pixel data, the LCDC switching to it at the end of the
+ * current frame. Two descriptor sets are used alternately, so the set of the
+ * buffer on screen is never modified. The layer shall have been set up with
+ * lcdd_create_canvas() or one of its YUV variants, with the same format.
+ *
+ * \param layer_id  Layer ID (BASE, OVR1, OVR2 or HEO).
+ * \param buffer    Buffer, or Y plane for YUV planar/semiplanar modes.
+ * \param buffer_u  U (planar) or UV (semiplanar) plane, NULL if unused.
+ * \param buffer_v  V plane (planar), NULL if unused.
+ * \param cb        Called from the LCDC interrupt once the buffer is
+ *                  displayed and the previous one is released, may be NULL.
+ * \param arg       Callback argument.
+ * \return true on success, false if a flip is already pending or the layer
+ * is driven by lcdd_frame_setup().
+ */
+bool lcdd_flip_buffer(uint8_t layer_id, void *buffer, void *buffer_u,
+		void *buffer_v, lcdd_flip_callback_t cb, void *arg)
+{
+	const struct _layer_info *layer = &lcdd_layers[layer_id];
+	struct _layer_flip *flip;
+	struct _lcdc_dma_desc *desc;
+
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_flips))
+		return false;
+	if ((buffer_u && !layer->reg_dma_u_head) ||
+	    (buffer_v && !layer->reg_dma_v_head))
+		return false;
+	flip = &lcdd_flips[layer_id];
+	if (lcdd_frames[layer_id].count || flip->pending)
+		return false;
+
+	_lcdc_enable_irq();
+	layer->reg_enable[3] = LCDC_BASEIER_ADD;
+	LCDC->LCDC_LCDIER = layer->irq_mask;
+
+	desc = flip_dma_desc[layer_id][flip->set];
+	flip->set ^= 1;
+	desc[0].addr = (uint32_t)buffer;
+	desc[0].ctrl = LCDC_BASECTRL_DFETCH | LCDC_BASECTRL_ADDIEN;
+	desc[0].next = (uint32_t)&desc[0];
+	desc[1].addr = (uint32_t)buffer_u;
+	desc[1].ctrl = LCDC_BASECTRL_DFETCH;
+	desc[1].next = (uint32_t)&desc[1];
+	desc[2].addr = (uint32_t)buffer_v;
+	desc[2].ctrl = LCDC_BASECTRL_DFETCH;
+	desc[2].next = (uint32_t)&desc[2];
+	cache_clean_region(desc, 3 * sizeof(*desc));
+
+	flip->cb = cb;
+	flip->arg = arg;
+	flip->pending = buffer;
+
+	layer->reg_dma_head[0] = (uint32_t)&desc[0];
+	if (buffer_u)
+		layer->reg_dma_u_head[0] = (uint32_t)&desc[1];
+	if (buffer_v)
+		layer->reg_dma_v_head[0] = (uint32_t)&desc[2];
+	layer->reg_enable[0] = LCDC_BASECHER_A2QEN;
+	return true;
+}
+
+/**
+ * \brief Check whether a flip queued by lcdd_flip_buffer() is still waiting
+ * for the end of the current frame.
+ * \param layer_id  Layer ID.
+ */
+bool lcdd_is_flip_pending(uint8_t layer_id)
+{
+	if (layer_id < LCDD_BASE || layer_id >= ARRAY_SIZE(lcdd_flips))
+		return false;
+	return lcdd_flips[layer_id].pending != NULL;
+}
+
 /**@}*/
@@ -64,6 +64,14 @@
  *                            drawing on
  *    -# lcdd_select_canvas(): Select a displayer as canvas to drawing on
  *    -# lcdd_get_canvas():    Get current selected canvas layer
+ * -# Tear-free animation, with two or three buffers per layer:
+ *    -# lcdd_frame_setup(): Attach the buffers to a displayed layer
+ *    -# lcdd_frame_begin(): Get a free back buffer as canvas
+ *    -# lcdd_frame_present(): Flip to it at the end of the current frame
+ *    -# lcdd_frame_get_stats(): Render time and flip statistics
+ * -# Buffers filled by another DMA master (e.g. a camera interface):
+ *    -# lcdd_flip_buffer(): Switch a layer to a buffer at the end of the
+ *       current frame, with a completion callback
  *
  * For LCD drawing functions, refer to \ref lcdd_draw.
  *
@@ -116,6 +124,12 @@
 #define LCDD_CUR            6
 /**     @}*/
 
+/** Maximum number of buffers of a layer frame pipeline */
+#define LCDD_FRAME_MAX_BUFFERS 3
+
+/** Frame periods to wait for a queued flip before giving up */
+#define LCDD_FRAME_FLIP_TIMEOUT 4
+
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -148,6 +162,22 @@ struct _lcdd_desc {
 	uint8_t timing_hpw; /**< Horizontal pulse width in LCDDOTCLK cycles */
 };
 
+/** Frame pipeline statistics, times are in timer ticks (see timer.h) */
+struct _lcdd_frame_stats {
+	uint32_t vsyncs;       /**< Display refresh cycles */
+	uint32_t frames;       /**< Frames presented */
+	uint32_t flips;        /**< Frames actually put on screen */
+	uint32_t late;         /**< Flips done more than one refresh after present */
+	uint32_t render_last;  /**< Render time of the last frame */
+	uint32_t render_max;   /**< Longest render time */
+	uint32_t render_total; /**< Sum of render times */
+	uint32_t wait_total;   /**< Time spent waiting for a free back buffer */
+};
+
+/** Called from the LCDC interrupt once the buffer queued by
+ * lcdd_flip_buffer() is being displayed */
+typedef void (*lcdd_flip_callback_t)(uint8_t layer, void *arg);
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -237,6 +267,25 @@ extern void *lcdd_create_canvas_yuv_semiplanar(uint8_t layer,
 		void *buffer_y, void *buffer_uv, uint8_t bpp,
 		uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 
+extern bool lcdd_frame_setup(uint8_t layer, void **buffers, uint8_t count);
+
+extern void lcdd_frame_release(uint8_t layer);
+
+extern void *lcdd_frame_begin(uint8_t layer);
+
+extern bool lcdd_frame_present(uint8_t layer);
+
+extern void lcdd_wait_vsync(void);
+
+extern void lcdd_frame_get_stats(uint8_t layer, struct _lcdd_frame_stats *stats);
+
+extern void lcdd_frame_reset_stats(uint8_t layer);
+
+extern bool lcdd_flip_buffer(uint8_t layer, void *buffer, void *buffer_u,
+		void *buffer_v, lcdd_flip_callback_t cb, void *arg);
+
+extern bool lcdd_is_flip_pending(uint8_t layer);
+
 /**  @}*/
 
 #endif /* CONFIG_HAVE_LCDD */
@@ -5254,6 +5254,28 @@ static const sensor_output_t ov5640_output_wxga =
 static const sensor_output_t ov5640_output_af =
 { 1, (sensor_output_resolution_t)0, (sensor_output_format_t)0, (sensor_output_bit_t)0, 1, 0, 0, ov5640_afc };
 
+/** Manual AEC/AGC */
+static const sensor_reg_t ov5640_manual_exposure[] = {
+	{0x3503, 0x03},
+	{0xFF, 0xFF}
+};
+
+/** Exposure in 1/16 line (0x3500..0x3502), real gain in 1/16 (0x350A..0x350B),
+ * frame length VTS (0x380E..0x380F) */
+static const sensor_exposure_t ov5640_exposure =
+{
+	ov5640_manual_exposure,
+	{ {0x3500, 16, 0x0f}, {0x3501, 8, 0xff}, {0x3502, 0, 0xff} },
+	{ {0x350a, 8, 0x03}, {0x350b, 0, 0xff} },
+	{ {0x380e, 8, 0xff}, {0x380f, 0, 0xff} },
+	16,                              /* 1 line */
+	16,                              /* 1/16 line units */
+	4,                               /* exposure up to VTS - 4 lines */
+	0x10,                            /* 1x */
+	0xf8,                            /* 15.5x */
+	0x10                             /* 1x */
+};
+
 const sensor_profile_t ov5640_profile =
 {
 	"OV5640",
@@ -5273,5 +5295,7 @@ const sensor_profile_t ov5640_profile =
 		&ov5640_output_af,
 		0,
 		0
-	}
+	},
+	&ov5640_exposure,                /* manual exposure control */
+	1                                /* burst register writes */
 };
@@ -52,6 +52,13 @@
  *  gain and offset selection, using sequencer. User can select different mode
  *  by configuration menu in the terminal.
  *
+ *  With DMA, the conversions are acquired continuously by the adcd driver:
+ *  the sequencer converts all the channels on each rising edge of ADTRG or
+ *  of the timer TIOA output, and the tagged results are moved to a
+ *  ping-pong buffer by a circular DMA linked list. With the timer trigger,
+ *  the sequences run at 1 kHz and 10 of them are averaged per displayed
+ *  value.
+ *
  *
  *  \section Usage
  *
@@ -85,7 +92,7 @@
  *      [ ] 1: Set ADC trigger mode: ADTRG.
  *      [ ] 2: Set ADC trigger mode: Timer TIOA.
  *      [E] S: Enable/Disable sequencer
- *      [E] D: Enable/Disable to tranfer with DMA.
+ *      [E] D: Enable/Disable to tranfer with DMA (adcd).
  *      [D] P: Enable/Disable ADC power save mode.
  *          Q: Quit configuration and start ADC.
  *      =========================================================
@@ -96,6 +103,7 @@
  *  \section References
  *  - adc12/main.c
  *  - adc.h
+ *  - adcd.h
  */
 
 /** \file
@@ -117,10 +125,10 @@
 #include "peripherals/pit.h"
 
 #include "peripherals/adc.h"
+#include "peripherals/adcd.h"
 #include "misc/cache.h"
 #include "peripherals/tc.h"
 #include "component/component_tc.h"
-#include "peripherals/dma.h"
 
 #include "misc/led.h"
 #include "misc/console.h"
@@ -156,6 +164,16 @@ static uint8_t adc_channel_used[] =
 
 /** MAXIMUM DIGITAL VALUE */
 #define DIGITAL_MAX    ((1 << adc_get_resolution()) - 1)
+
+/** Sequence rate of the timer trigger with DMA, in Hz */
+#define ADCD_TIMER_RATE   1000
+
+/** Sequences averaged per displayed value with the timer trigger and DMA */
+#define ADCD_DECIMATION   10
+
+/** Sequences per half buffer with the timer trigger and DMA: one callback
+ * every 100ms */
+#define ADCD_SEQUENCES    100
 /*----------------------------------------------------------------------------
  *        Local types
  *----------------------------------------------------------------------------*/
@@ -186,7 +204,19 @@ struct _adc_sample
 	uint16_t done;
 };
 
-CACHE_ALIGNED static uint16_t _dma_buffer[NUM_CHANNELS];
+/** adcd ping-pong acquisition buffer */
+CACHE_ALIGNED static uint16_t _adcd_buffer[2 * ADCD_SEQUENCES * NUM_CHANNELS];
+
+/** adcd de-interleaved output */
+static uint16_t _adcd_output[ADCD_SEQUENCES * NUM_CHANNELS];
+
+/** adcd descriptor, used when DMA is enabled */
+static struct _adcd_desc _adcd = {
+	.channels = adc_channel_used,
+	.num_channels = NUM_CHANNELS,
+	.buffer = _adcd_buffer,
+	.output = _adcd_output,
+};
 
 bool modif_config = false;
 unsigned count = 0;
@@ -231,56 +261,51 @@ struct _pin pin_tioa0 = { PIO_GROUP_D, PIO_PD5B_TIOA0, PIO_PERIPH_B , PIO_DEFAUL
  *        Local functions
  *----------------------------------------------------------------------------*/
 
-static void _start_dma(void);
-
-static void _adc_dma_callback(struct dma_channel *channel, void *arg)
+/**
+ * \brief adcd callback, invoked from the DMA interrupt with the samples of
+ * each half buffer sorted per channel: keep the last one of each channel.
+ */
+static void _adcd_callback(struct _adcd_desc* desc, const uint16_t* data,
+		uint32_t samples, void* arg)
 {
-	cache_invalidate_region(_dma_buffer, sizeof(_dma_buffer));
-
-	/* Only keep sample value, discard channel number */
-	int i, j, chan, value;
-	for (i = 0; i < NUM_CHANNELS; ++i) {
-		chan = _dma_buffer[i] >> ADC_LCDR_CHNB_Pos;
-		value = _dma_buffer[i] & ADC_LCDR_LDATA_Msk;
-
-			/* Store value to channel according to sequence table*/
-			for (j = 0; j < NUM_CHANNELS; j++) {
-				if ( _data.channel[j] == chan) {
-					_data.value[j] = value;
-					_data.done |= 1 << i;
-					break;
-				}
-			}
-	}
-	dma_free_channel(channel);
-	if (_test_mode.dma_enabled)
-		_start_dma();
+	uint8_t i;
+
+	for (i = 0; i < desc->num_channels; i++)
+		_data.value[i] = data[i * samples + samples - 1];
+	_data.done = ADC_DONE_MASK;
 }
 
 /**
- *  \brief Configure DMA and start to transfer.
+ * \brief Start the continuous acquisition of all the channels by DMA, on
+ * the rising edges of the selected hardware trigger.
  */
-static void _start_dma(void)
+static void _start_adcd(void)
 {
-	/* Allocate a DMA channel, Write accesses into SHA_IDATARx */
-	struct dma_channel* dma_channel =
-	dma_allocate_channel(ID_ADC, DMA_PERIPH_MEMORY);
-	struct dma_xfer_cfg dma_cfg;
-
-	memset(&dma_cfg, 0, sizeof(dma_cfg));
-
-	dma_cfg.sa = (void*)&ADC->ADC_LCDR;
-	dma_cfg.da = (void*)_dma_buffer;
-	dma_cfg.upd_sa_per_data = 0;
-	dma_cfg.upd_da_per_data = 1;
-	dma_cfg.data_width = DMA_DATA_WIDTH_HALF_WORD;
-	dma_cfg.chunk_size = DMA_CHUNK_SIZE_1;
-	dma_cfg.blk_size = 0;
-	dma_cfg.len = NUM_CHANNELS;
-	dma_configure_transfer(dma_channel, &dma_cfg);
-
-	dma_set_callback(dma_channel, _adc_dma_callback, NULL);
-	dma_start_transfer(dma_channel);
+	uint32_t status;
+
+	_adcd.callback = _adcd_callback;
+	if (_test_mode.trigger_mode == TRIGGER_MODE_TIMER) {
+		pio_configure(&pin_tioa0, 1);
+		_adcd.tc = TC0;
+		_adcd.tc_channel = 0;
+		_adcd.rate = ADCD_TIMER_RATE;
+		_adcd.trigger = ADC_MR_TRGSEL_ADC_TRIG1;
+		_adcd.decimation = ADCD_DECIMATION;
+		_adcd.sequences = ADCD_SEQUENCES;
+	} else {
+		/* ADTRG, one sequence per edge */
+		pio_clear(&pin_trig);
+		_adcd.tc = NULL;
+		_adcd.trigger = ADC_MR_TRGSEL_ADC_TRIG0;
+		_adcd.decimation = 1;
+		_adcd.sequences = 1;
+	}
+
+	status = adcd_configure(&_adcd);
+	if (status == ADCD_SUCCESS)
+		status = adcd_start(&_adcd);
+	if (status != ADCD_SUCCESS)
+		printf("-E- adcd error %u\n\r", (unsigned)status);
 }
 
 /**
@@ -335,9 +360,11 @@ static void _display_menu(void)
 	tmp = (_test_mode.sequence_enabled ) ? 'E' : 'D';
 	printf("[%c] S: Enable/Disable sequencer.\n\r", tmp);
 	tmp = (_test_mode.dma_enabled) ? 'E' : 'D';
-	printf("[%c] D: Enable/Disable to tranfer with DMA.\n\r", tmp);
+	printf("[%c] D: Enable/Disable to tranfer with DMA (adcd).\n\r", tmp);
 	tmp = (_test_mode.power_save_enabled) ? 'E' : 'D';
 	printf("[%c] P: Enable/Disable ADC power save mode.\n\r", tmp);
+	if (_test_mode.dma_enabled)
+		printf("    DMA: sequencer on, ADTRG or Timer TIOA trigger.\n\r");
 	printf("=========================================================\n\r");
 }
 
@@ -377,6 +404,19 @@ static void console_handler(uint8_t key)
 	default :
 		break;
 	}
+
+	/* adcd converts the sequence on the edges of a hardware trigger */
+	if (_test_mode.dma_enabled) {
+		if (key == 'd' || key == 'D') {
+			_test_mode.sequence_enabled = 1;
+			if (_test_mode.trigger_mode != TRIGGER_MODE_ADTRG)
+				_test_mode.trigger_mode = TRIGGER_MODE_TIMER;
+		} else if (!_test_mode.sequence_enabled ||
+			   _test_mode.trigger_mode == TRIGGER_MODE_SOFTWARE ||
+			   _test_mode.trigger_mode == TRIGGER_MODE_ADC_TIMER) {
+			_test_mode.dma_enabled = 0;
+		}
+	}
 	modif_config = true; /* indicate config ADC change */
 	_display_menu();
 }
@@ -442,6 +482,8 @@ static void _configure_adc(void)
 	uint8_t i = 0;
 
 	aic_disable(ID_ADC);
+	adc_disable_it(0xFFFFFFFF);
+	adcd_stop(&_adcd);
 
 	led_clear(LED_RED);
 	led_clear(LED_BLUE);
@@ -452,6 +494,18 @@ static void _configure_adc(void)
 		_data.value[i] = 0;
 	}
 
+	/* Set power save */
+	if (_test_mode.power_save_enabled) {
+		adc_set_sleep_mode(true);
+	} else {
+		adc_set_sleep_mode(false);
+	}
+
+	if (_test_mode.dma_enabled) {
+		_start_adcd();
+		return;
+	}
+
 	/* Enable/disable sequencer */
 	if (_test_mode.sequence_enabled) {
 		/* Set user defined channel sequence */
@@ -473,13 +527,6 @@ static void _configure_adc(void)
 #endif
 	}
 
-	/* Set power save */
-	if (_test_mode.power_save_enabled) {
-		adc_set_sleep_mode(true);
-	} else {
-		adc_set_sleep_mode(false);
-	}
-
 	/* Enable Data ready interrupt */
 	uint32_t ier_mask = 0;
 	for (i = 0; i < NUM_CHANNELS; i++) {
@@ -522,10 +569,7 @@ static void _configure_adc(void)
 	    default :
 			break;
 	}
-	if (_test_mode.dma_enabled) {
-		_start_dma();
-	} else
-		aic_enable(ID_ADC);
+	aic_enable(ID_ADC);
 }
 
 /**
@@ -536,7 +580,8 @@ static void _set_adc_configuration(void)
 {
 	tc_stop(TC0, 0);
 	_configure_adc();
-	adc_start_conversion();
+	if (!_test_mode.dma_enabled)
+		adc_start_conversion();
 	modif_config = false;
 }
 
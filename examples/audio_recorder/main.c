@@ -123,6 +123,8 @@
 #include "misc/cache.h"
 #include "misc/console.h"
 
+#include "audio/audio_pipeline.h"
+
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -146,6 +148,17 @@
 /* record 10 seconds */
 #define SAMPLE_COUNT (10 * SAMPLE_RATE)
 
+/* 10ms periods of 16-bit mono samples */
+#define PERIOD_SIZE (SAMPLE_RATE / 100 * sizeof(uint16_t))
+
+#define PERIOD_COUNT (SAMPLE_COUNT * sizeof(uint16_t) / PERIOD_SIZE)
+
+/* number of period buffers in each pipeline */
+#define PIPE_BUFFERS (4)
+
+/* periods queued before playback starts */
+#define PIPE_PREFILL (2)
+
 
 /*----------------------------------------------------------------------------
  *         Internal variables
@@ -159,30 +172,67 @@ static volatile bool _sound_recorded = false;
 /** audio playing volume */
 static uint8_t play_vol = AUDIO_PLAY_MAX_VOLUME/2;
 
-static volatile bool record_done = false;
+CACHE_ALIGNED_DDR static uint8_t _record_pool[PIPE_BUFFERS * PERIOD_SIZE];
+CACHE_ALIGNED_DDR static uint8_t _play_pool[PIPE_BUFFERS * PERIOD_SIZE];
+CACHE_ALIGNED_DDR static uint8_t _monitor_pool[PIPE_BUFFERS * PERIOD_SIZE];
+
+/** record device to the application, which copies into _sound_buffer */
+static struct _audio_pipeline _record_pipe = {
+	.source = &audio_record_device,
+	.sink = NULL,
+	.pool = _record_pool,
+	.buffer_size = PERIOD_SIZE,
+	.period_size = PERIOD_SIZE,
+	.count = PIPE_BUFFERS,
+	.bits = 16,
+	.prefill = 1,
+};
+
+/** application, reading from _sound_buffer, to the play device */
+static struct _audio_pipeline _play_pipe = {
+	.source = NULL,
+	.sink = &audio_play_device,
+	.pool = _play_pool,
+	.buffer_size = PERIOD_SIZE,
+	.period_size = PERIOD_SIZE,
+	.count = PIPE_BUFFERS,
+	.bits = 16,
+	.prefill = PIPE_PREFILL,
+};
+
+/** record device straight to the play device */
+static struct _audio_pipeline _monitor_pipe = {
+	.source = &audio_record_device,
+	.sink = &audio_play_device,
+	.pool = _monitor_pool,
+	.buffer_size = PERIOD_SIZE,
+	.period_size = PERIOD_SIZE,
+	.count = PIPE_BUFFERS,
+	.bits = 16,
+	.prefill = PIPE_PREFILL,
+};
 
-static volatile bool playback_done = false;
 /*----------------------------------------------------------------------------
  *         Internal functions
  *----------------------------------------------------------------------------*/
-/**
- *  \brief DMA TX callback
- */
-static void audio_play_finish_callback(struct dma_channel *channel, void* p_arg)
-{
-	p_arg = p_arg; /* dummy */
-
-	playback_done = true;
-}
 
-/**
- *  \brief DMA RX callback
- */
-static void audio_record_finish_callback(struct dma_channel *channel, void* p_arg)
+static void _print_stats(struct _audio_pipeline* pipe)
 {
-	p_arg = p_arg; /* dummy */
-
-	record_done = true;
+	struct _audio_pipeline_stats stats;
+
+	audio_pipeline_get_stats(pipe, &stats, true);
+	printf("periods %u, overruns %u, underruns %u",
+	       (unsigned)stats.periods, (unsigned)stats.overruns,
+	       (unsigned)stats.underruns);
+	if (pipe->sink && stats.periods)
+		printf(", latency %uus (min %uus, max %uus)",
+		       (unsigned)audio_pipeline_periods_to_us(pipe,
+				stats.latency, sizeof(uint16_t), SAMPLE_RATE),
+		       (unsigned)audio_pipeline_periods_to_us(pipe,
+				stats.latency_min, sizeof(uint16_t), SAMPLE_RATE),
+		       (unsigned)audio_pipeline_periods_to_us(pipe,
+				stats.latency_max, sizeof(uint16_t), SAMPLE_RATE));
+	printf("\r\n");
 }
 
 /**
@@ -195,6 +245,7 @@ static void _display_menu(void)
 	printf("-----------------\n\r");
 	printf("R -> Record the sound \n\r");
 	printf("P -> Playback the record sound \n\r");
+	printf("L -> Monitor the input live, any key stops \n\r");
 	printf("+ -> Increase the volume of playback sound \n\r");
 	printf("- -> Decrease the volume of playback sound \n\r");
 	printf("=>");
@@ -205,7 +256,7 @@ static void _record_start(void)
 	printf("<Record Start>\r\n");
 	_start_tick = timer_get_tick();
 	_sound_recorded = false;
-	audio_enable(&audio_record_device, true);
+	audio_pipeline_start(&_record_pipe);
 }
 
 static void _record_stop(void)
@@ -213,21 +264,23 @@ static void _record_stop(void)
 	uint32_t elapsed = timer_get_interval(_start_tick, timer_get_tick());
 	printf("<Record Stop (%ums elapsed)>\r\n", (unsigned)elapsed);
 	_sound_recorded = true;
-	audio_enable(&audio_record_device, false);
+	audio_pipeline_stop(&_record_pipe);
+	_print_stats(&_record_pipe);
 }
 
 static void _play_start(void)
 {
 	printf("<Play Start>\r\n");
 	_start_tick = timer_get_tick();
-	audio_enable(&audio_play_device, true);
+	audio_pipeline_start(&_play_pipe);
 }
 
 static void _play_stop(void)
 {
 	uint32_t elapsed = timer_get_interval(_start_tick, timer_get_tick());
 	printf("<Play Stop (%ums elapsed)>\r\n", (unsigned)elapsed);
-	audio_enable(&audio_play_device, false);
+	audio_pipeline_stop(&_play_pipe);
+	_print_stats(&_play_pipe);
 }
 
 /**
@@ -235,14 +288,21 @@ static void _play_stop(void)
  */
 static void _record_sound(void)
 {
-	uint32_t  audio_length = SAMPLE_COUNT * 2;
+	uint8_t* dst = (uint8_t*)_sound_buffer;
+	struct _audio_buffer* buf;
+	uint32_t periods = 0;
 
 	_record_start();
-	audio_dma_transfer(&audio_record_device, (void *)_sound_buffer, audio_length,
-					   audio_record_finish_callback);
-	while (!record_done);
+	while (periods < PERIOD_COUNT) {
+		audio_pipeline_process(&_record_pipe);
+		buf = audio_pipeline_get_ready(&_record_pipe);
+		if (!buf)
+			continue;
+		memcpy(dst + periods * PERIOD_SIZE, buf->data, buf->size);
+		audio_pipeline_release(&_record_pipe, buf);
+		periods++;
+	}
 	_record_stop();
-	record_done = false;
 }
 
 
@@ -251,8 +311,10 @@ static void _record_sound(void)
  */
 static void _playback_sound(void)
 {
-	/* our Classd support 16 bit sound only*/
-	uint32_t  audio_length = SAMPLE_COUNT * 2;	
+	const uint8_t* src = (const uint8_t*)_sound_buffer;
+	struct _audio_pipeline_stats stats;
+	struct _audio_buffer* buf;
+	uint32_t submitted = 0;
 
 	if (!_sound_recorded) {
 	       printf("Please record the sound first\n\r");
@@ -262,15 +324,56 @@ static void _playback_sound(void)
 	audio_play_mute(&audio_play_device, false);
 	_play_start();
 
-	audio_dma_transfer(&audio_play_device, (void *)_sound_buffer, audio_length,
-						audio_play_finish_callback);
+	/* the silent periods after the sound push its tail out of the
+	 * prefill window */
+	do {
+		if (submitted < PERIOD_COUNT + PIPE_PREFILL) {
+			buf = audio_pipeline_get_free(&_play_pipe);
+			if (buf) {
+				if (submitted < PERIOD_COUNT)
+					memcpy(buf->data, src + submitted * PERIOD_SIZE,
+					       PERIOD_SIZE);
+				else
+					memset(buf->data, 0, PERIOD_SIZE);
+				buf->size = PERIOD_SIZE;
+				audio_pipeline_submit(&_play_pipe, buf);
+				submitted++;
+			}
+		}
+		audio_pipeline_process(&_play_pipe);
+		audio_pipeline_get_stats(&_play_pipe, &stats, false);
+	} while (stats.periods < PERIOD_COUNT);
 
-	while (!playback_done);
 	_play_stop();
-	playback_done = false;
 	audio_play_mute(&audio_play_device, true);
 }
 
+/**
+ * \brief Play the input live until a key is pressed.
+ */
+static void _monitor_sound(void)
+{
+	uint32_t tick;
+
+	printf("<Monitor Start>\r\n");
+	audio_play_mute(&audio_play_device, false);
+	audio_pipeline_start(&_monitor_pipe);
+
+	tick = timer_get_tick();
+	while (!console_is_rx_ready()) {
+		audio_pipeline_process(&_monitor_pipe);
+		if (timer_get_interval(tick, timer_get_tick()) >= 1000) {
+			tick = timer_get_tick();
+			_print_stats(&_monitor_pipe);
+		}
+	}
+	console_get_char();
+
+	audio_pipeline_stop(&_monitor_pipe);
+	audio_play_mute(&audio_play_device, true);
+	printf("<Monitor Stop>\r\n");
+}
+
 
 /*----------------------------------------------------------------------------
  *         Exported functions
@@ -297,6 +400,13 @@ extern int main(void)
 	/* Configure audio play volume */
 	audio_play_set_volume(&audio_play_device, play_vol);
 
+	if (audio_pipeline_initialize(&_record_pipe) != AUDIO_PIPELINE_SUCCESS ||
+	    audio_pipeline_initialize(&_play_pipe) != AUDIO_PIPELINE_SUCCESS ||
+	    audio_pipeline_initialize(&_monitor_pipe) != AUDIO_PIPELINE_SUCCESS) {
+		printf("Audio pipeline configuration error\r\n");
+		while (1);
+	}
+
 	/* Infinite loop */
 	while (1) {
 		_display_menu();
@@ -307,6 +417,8 @@ extern int main(void)
 			_record_sound();
 		else if (key == 'p' || key == 'P')
 			_playback_sound();
+		else if (key == 'l' || key == 'L')
+			_monitor_sound();
 		else if (key == '+') {
 			if (play_vol < AUDIO_PLAY_MAX_VOLUME) {
 				play_vol += 10;
@@ -0,0 +1,536 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page audio_sd_recorder Audio SD Recorder Example
+ *
+ *  \section Purpose
+ *
+ *  This example records sound to a WAV file on a SD card and plays it back,
+ *  streaming the audio through the audio pipeline and the WAV stream
+ *  library (lib/wavstream).
+ *
+ *  \section Requirements
+ *
+ *  This package can be used with SAMA5D2-XPLAINED (with the Audio
+ *  xplained board, card in the removable slot) and SAMA5D4-EK (card in the
+ *  SD/MMC slot). The card shall hold a FAT or exFAT file system.
+ *
+ *  \section Description
+ *
+ *  Recorded 10ms periods are queued to the WAV writer ring and written to
+ *  the card in whole clusters from the main loop; on playback the WAV reader
+ *  prefetches whole clusters and the periods are copied from its ring to the
+ *  play pipeline. The period pools are deep enough to ride over the card
+ *  write latency. The pipeline and WAV stream statistics are printed when
+ *  each operation stops.
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board. Please
+ *     refer to the
+ *     <a href="http://www.atmel.com/dyn/resources/prod_documents/doc6421.pdf">
+ *     SAM-BA User Guide</a>, the
+ *     <a href="http://www.atmel.com/dyn/resources/prod_documents/doc6310.pdf">
+ *     GNU-Based Software Development</a> application note or to the
+ *     <a href="ftp://ftp.iar.se/WWWfiles/arm/Guides/EWARM_UserGuide.ENU.pdf">
+ *     IAR EWARM User Guide</a>, depending on your chosen solution.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Start the application.
+ *  -# In the terminal window, the following text should appear:
+ *  \code
+ *  -- Audio SD Recorder Example xxx --
+ *  -- SAMxxxxx-xx
+ *  -- Compiled: xxx xx xxxx xx:xx:xx --
+ *  \endcode
+ *  -# Press 'R' to record to the card, any key stops the recording.
+ *  -# Press 'P' to play the recording back.
+ *
+ *  \section References
+ *  - audio_sd_recorder/main.c
+ *  - audio_pipeline.h
+ *  - wav_reader.h, wav_writer.h
+ */
+
+/**
+ *  \file
+ *
+ *  This file contains all the specific code for the
+ *  audio_sd_recorder example.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "board.h"
+#include "compiler.h"
+#include "trace.h"
+#include "timer.h"
+
+#include "peripherals/pmc.h"
+
+#ifdef CONFIG_HAVE_SDMMC
+#  include "peripherals/sdmmc.h"
+#elif defined(CONFIG_HAVE_HSMCI)
+#  include "peripherals/hsmcic.h"
+#  include "peripherals/hsmcid.h"
+#else
+#  error No peripheral for SD/MMC devices
+#endif
+
+#include "misc/cache.h"
+#include "misc/console.h"
+
+#include "audio/audio_pipeline.h"
+
+#include "libsdmmc/libsdmmc.h"
+#include "fatfs/src/ff.h"
+#include "wavstream/wav_reader.h"
+#include "wavstream/wav_writer.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(CONFIG_BOARD_SAMA5D2_XPLAINED)
+	#include "config_sama5d2-xplained.h"
+#elif defined(CONFIG_BOARD_SAMA5D4_EK)
+	#include "config_sama5d4-ek.h"
+#else
+#error Unsupported board!
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+#define SAMPLE_RATE (48000)
+
+/* recordings are cut after one minute */
+#define RECORD_SECONDS (60)
+
+/* 10ms periods of 16-bit mono samples */
+#define PERIOD_SIZE (SAMPLE_RATE / 100 * sizeof(uint16_t))
+
+/* number of period buffers in each pipeline, covers card write latency */
+#define PIPE_BUFFERS (AUDIO_PIPELINE_MAX_BUFFERS)
+
+/* periods queued before playback starts */
+#define PIPE_PREFILL (4)
+
+/* size of each file access, a common SD card cluster size */
+#define WAV_CHUNK (32 * 1024)
+
+/* WAV reader/writer ring, about 2.7s of audio */
+#define WAV_RING_SIZE (8 * WAV_CHUNK)
+
+/* the card is the FatFs drive 0 */
+#define WAV_DRIVE "0:"
+
+#define WAV_FILE_PATH WAV_DRIVE "record.wav"
+
+/* Timer/Counter for the SD/MMC driver, not used by the audio drivers */
+#define SD_TIMER_MODULE ID_TC0
+#define SD_TIMER_CHANNEL 0
+
+#ifdef CONFIG_BOARD_SAMA5D2_XPLAINED
+/* removable card slot */
+#  define SD_HOST_ID ID_SDMMC1
+#  define SD_HOST_REGS SDMMC1
+#else
+/* SD/MMC slot */
+#  define SD_HOST_ID ID_HSMCI0
+#  define SD_HOST_REGS HSMCI0
+#  define SD_HOST_SLOT BOARD_HSMCI0_SLOT
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Internal variables
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _start_tick;
+
+/** audio playing volume */
+static uint8_t play_vol = AUDIO_PLAY_MAX_VOLUME/2;
+
+CACHE_ALIGNED_DDR static uint8_t _record_pool[PIPE_BUFFERS * PERIOD_SIZE];
+CACHE_ALIGNED_DDR static uint8_t _play_pool[PIPE_BUFFERS * PERIOD_SIZE];
+
+/** record device to the application, which queues to the WAV writer */
+static struct _audio_pipeline _record_pipe = {
+	.source = &audio_record_device,
+	.sink = NULL,
+	.pool = _record_pool,
+	.buffer_size = PERIOD_SIZE,
+	.period_size = PERIOD_SIZE,
+	.count = PIPE_BUFFERS,
+	.bits = 16,
+	.prefill = 1,
+};
+
+/** application, reading from the WAV reader, to the play device */
+static struct _audio_pipeline _play_pipe = {
+	.source = NULL,
+	.sink = &audio_play_device,
+	.pool = _play_pool,
+	.buffer_size = PERIOD_SIZE,
+	.period_size = PERIOD_SIZE,
+	.count = PIPE_BUFFERS,
+	.bits = 16,
+	.prefill = PIPE_PREFILL,
+};
+
+/** WAV reader/writer ring, the card DMA transfers straight into it */
+CACHE_ALIGNED_DDR static uint8_t _wav_ring[WAV_RING_SIZE];
+
+static struct _wav_writer _writer;
+
+static struct _wav_reader _reader;
+
+#ifdef CONFIG_HAVE_SDMMC
+/* SD/MMC driver instance and DMA descriptor table */
+static struct sdmmc_set _sd_drv;
+CACHE_ALIGNED_DDR static uint32_t _sd_dma_table[4 * SDMMC_DMADL_SIZE];
+#else
+static struct hsmci_set _sd_drv;
+#endif
+
+/* SDCard library instance */
+CACHE_ALIGNED_DDR static sSdCard _sd_lib;
+
+/* File system object. With _FS_TINY, all the file data that is not
+ * transferred straight from/to the WAV ring goes through FATFS::win[],
+ * which the card DMA requires to be aligned on data cache lines. */
+struct padded_fatfs {
+	uint8_t padding[L1_CACHE_BYTES - offsetof(FATFS, win) % L1_CACHE_BYTES];
+	FATFS fs;
+};
+CACHE_ALIGNED_DDR static struct padded_fatfs _fs_header;
+
+/*----------------------------------------------------------------------------
+ *         Internal functions
+ *----------------------------------------------------------------------------*/
+
+static void _print_stats(struct _audio_pipeline* pipe)
+{
+	struct _audio_pipeline_stats stats;
+
+	audio_pipeline_get_stats(pipe, &stats, true);
+	printf("periods %u, overruns %u, underruns %u\r\n",
+	       (unsigned)stats.periods, (unsigned)stats.overruns,
+	       (unsigned)stats.underruns);
+}
+
+/**
+ * \brief Display main menu.
+ */
+static void _display_menu(void)
+{
+	printf("\n\r");
+	printf("Select an option:\n\r");
+	printf("-----------------\n\r");
+	printf("R -> Record the sound to " WAV_FILE_PATH ", any key stops \n\r");
+	printf("P -> Playback " WAV_FILE_PATH ", any key stops \n\r");
+	printf("+ -> Increase the volume of playback sound \n\r");
+	printf("- -> Decrease the volume of playback sound \n\r");
+	printf("=>");
+}
+
+/**
+ * \brief Configure the SD/MMC host and its clocks.
+ */
+static void _sd_initialize(void)
+{
+	bool use_dma;
+
+	pmc_enable_peripheral(SD_TIMER_MODULE);
+	pmc_enable_peripheral(SD_HOST_ID);
+#ifdef CONFIG_HAVE_SDMMC
+	/* The Audio PLL is left to the audio devices, target SD High Speed
+	 * mode @ 50 MHz from PLLA, as the sdmmc_sdcard example does. */
+	pmc_configure_gck(SD_HOST_ID, PMC_PCR_GCKCSS_PLLA_CLK, 1 - 1);
+	pmc_enable_gck(SD_HOST_ID);
+#endif
+	if (!board_cfg_sdmmc(SD_HOST_ID))
+		trace_error("Failed to cfg cells\n\r");
+
+	use_dma = !((uint32_t)&_fs_header.fs.win % L1_CACHE_BYTES
+		    || (uint32_t)&_sd_lib.EXT % L1_CACHE_BYTES
+		    || sizeof(_sd_lib.EXT) % L1_CACHE_BYTES);
+	if (!use_dma)
+		trace_error("Buffers are not aligned on data cache lines, "
+			    "DMA disabled\n\r");
+
+#ifdef CONFIG_HAVE_SDMMC
+	sdmmc_initialize(&_sd_drv, SD_HOST_REGS, SD_HOST_ID,
+			 SD_TIMER_MODULE, SD_TIMER_CHANNEL,
+			 use_dma ? _sd_dma_table : NULL,
+			 use_dma ? ARRAY_SIZE(_sd_dma_table) : 0);
+#else
+	(void)use_dma;
+	hsmci_initialize(&_sd_drv, SD_HOST_REGS, SD_HOST_ID,
+			 SD_TIMER_MODULE, SD_TIMER_CHANNEL);
+	hsmci_set_slot(SD_HOST_REGS, SD_HOST_SLOT);
+#endif
+	SDD_InitializeSdmmcMode(&_sd_lib, &_sd_drv, 0);
+}
+
+static bool _sd_mount(void)
+{
+	FRESULT res;
+
+	if (SD_GetStatus(&_sd_lib) == SDMMC_NOT_SUPPORTED) {
+		printf("Device not detected.\n\r");
+		return false;
+	}
+	memset(&_fs_header.fs, 0, sizeof(FATFS));
+	res = f_mount(&_fs_header.fs, WAV_DRIVE, 1);
+	if (res != FR_OK) {
+		printf("Failed to mount FAT file system, error %d\n\r", res);
+		return false;
+	}
+	return true;
+}
+
+static void _sd_unmount(void)
+{
+	f_mount(NULL, WAV_DRIVE, 0);
+	SD_DeInit(&_sd_lib);
+}
+
+/**
+ * \brief Record sound to the card until a key is pressed.
+ */
+static void _record_sound(void)
+{
+	const uint32_t max_periods = RECORD_SECONDS * 100;
+	struct _audio_buffer* buf;
+	uint32_t periods = 0, dropped = 0;
+	FRESULT res;
+
+	if (!_sd_mount())
+		return;
+
+	res = wav_writer_open(&_writer, WAV_FILE_PATH, 1, SAMPLE_RATE, 16,
+			      _wav_ring, sizeof(_wav_ring), WAV_CHUNK, 0);
+	if (res != FR_OK) {
+		printf("Failed to create " WAV_FILE_PATH ", error %d\n\r", res);
+		_sd_unmount();
+		return;
+	}
+
+	printf("<Record Start>\r\n");
+	_start_tick = timer_get_tick();
+	audio_pipeline_start(&_record_pipe);
+
+	while (res == FR_OK && periods < max_periods &&
+	       !console_is_rx_ready()) {
+		audio_pipeline_process(&_record_pipe);
+		while ((buf = audio_pipeline_get_ready(&_record_pipe)) != NULL) {
+			if (wav_writer_write(&_writer, buf->data, buf->size)
+			    != buf->size)
+				dropped++;
+			audio_pipeline_release(&_record_pipe, buf);
+			periods++;
+		}
+		/* blocks for whole cluster writes, the pipeline pool keeps
+		 * the periods recorded meanwhile */
+		res = wav_writer_flush(&_writer);
+	}
+	if (console_is_rx_ready())
+		console_get_char();
+
+	printf("<Record Stop (%ums elapsed)>\r\n",
+	       (unsigned)timer_get_interval(_start_tick, timer_get_tick()));
+	audio_pipeline_stop(&_record_pipe);
+	_print_stats(&_record_pipe);
+
+	if (res != FR_OK)
+		printf("Write error %d\n\r", res);
+	res = wav_writer_close(&_writer);
+	if (res != FR_OK)
+		printf("Failed to close " WAV_FILE_PATH ", error %d\n\r", res);
+	printf("WAV writer: %u periods, %u dropped, ring max %u bytes, "
+	       "write max %ums\r\n", (unsigned)periods, (unsigned)dropped,
+	       (unsigned)_writer.stats.max_level,
+	       (unsigned)_writer.stats.max_write_time);
+
+	_sd_unmount();
+}
+
+/**
+ * \brief Play the recording from the card until its end or a key press.
+ */
+static void _playback_sound(void)
+{
+	struct _audio_pipeline_stats stats;
+	struct _audio_buffer* buf;
+	uint32_t submitted = 0, len, total = 0;
+	FRESULT res;
+
+	if (!_sd_mount())
+		return;
+
+	res = wav_reader_open(&_reader, WAV_FILE_PATH, _wav_ring,
+			      sizeof(_wav_ring), WAV_CHUNK);
+	if (res != FR_OK) {
+		printf("Failed to open " WAV_FILE_PATH ", error %d\n\r", res);
+		_sd_unmount();
+		return;
+	}
+	if (_reader.header.num_channels != 1 ||
+	    _reader.header.sample_rate != SAMPLE_RATE ||
+	    _reader.header.bits_per_sample != 16) {
+		printf("Only %u Hz 16-bit mono files are supported\n\r",
+		       SAMPLE_RATE);
+		wav_reader_close(&_reader);
+		_sd_unmount();
+		return;
+	}
+
+	audio_play_mute(&audio_play_device, false);
+	printf("<Play Start>\r\n");
+	_start_tick = timer_get_tick();
+	audio_pipeline_start(&_play_pipe);
+
+	/* once the file is consumed, the silent periods push its tail out of
+	 * the prefill window */
+	do {
+		while ((total == 0 || submitted < total) &&
+		       (buf = audio_pipeline_get_free(&_play_pipe)) != NULL) {
+			len = wav_reader_read(&_reader, buf->data, PERIOD_SIZE);
+			memset(buf->data + len, 0, PERIOD_SIZE - len);
+			buf->size = PERIOD_SIZE;
+			audio_pipeline_submit(&_play_pipe, buf);
+			submitted++;
+			if (total == 0 && wav_reader_is_eof(&_reader))
+				total = submitted + PIPE_PREFILL;
+		}
+		res = wav_reader_prefetch(&_reader);
+		audio_pipeline_process(&_play_pipe);
+		audio_pipeline_get_stats(&_play_pipe, &stats, false);
+	} while (res == FR_OK && (total == 0 || stats.periods < total) &&
+		 !console_is_rx_ready());
+	if (console_is_rx_ready())
+		console_get_char();
+
+	printf("<Play Stop (%ums elapsed)>\r\n",
+	       (unsigned)timer_get_interval(_start_tick, timer_get_tick()));
+	audio_pipeline_stop(&_play_pipe);
+	audio_play_mute(&audio_play_device, true);
+	_print_stats(&_play_pipe);
+
+	if (res != FR_OK)
+		printf("Read error %d\n\r", res);
+	printf("WAV reader: underruns %u, ring min %u bytes, read max %ums\r\n",
+	       (unsigned)_reader.stats.underruns,
+	       (unsigned)_reader.stats.min_level,
+	       (unsigned)_reader.stats.max_read_time);
+	wav_reader_close(&_reader);
+
+	_sd_unmount();
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/* Refer to sdmmc_ff.c */
+bool SD_GetInstance(uint8_t index, sSdCard **holder);
+
+bool SD_GetInstance(uint8_t index, sSdCard **holder)
+{
+	assert(holder);
+
+	if (index != 0)
+		return false;
+	*holder = &_sd_lib;
+	return true;
+}
+
+/**
+ *  \brief audio_sd_recorder Application entry point.
+ */
+extern int main(void)
+{
+	uint8_t key;
+
+	/* output example information */
+	console_example_info("Audio SD Recorder Example");
+
+	/* Configure Audio play*/
+	audio_configure(&audio_play_device);
+
+	/* Configure Audio record */
+	audio_configure(&audio_record_device);
+
+	/* Configure audio play volume */
+	audio_play_set_volume(&audio_play_device, play_vol);
+
+	if (audio_pipeline_initialize(&_record_pipe) != AUDIO_PIPELINE_SUCCESS ||
+	    audio_pipeline_initialize(&_play_pipe) != AUDIO_PIPELINE_SUCCESS) {
+		printf("Audio pipeline configuration error\r\n");
+		while (1);
+	}
+
+	_sd_initialize();
+
+	/* Infinite loop */
+	while (1) {
+		_display_menu();
+		key = console_get_char();
+		printf("%c\r\n", key);
+
+		if (key == 'r' || key == 'R')
+			_record_sound();
+		else if (key == 'p' || key == 'P')
+			_playback_sound();
+		else if (key == '+') {
+			if (play_vol < AUDIO_PLAY_MAX_VOLUME) {
+				play_vol += 10;
+				audio_play_set_volume(&audio_play_device, play_vol);
+			}
+		} else if (key == '-') {
+			if (play_vol > 10) {
+				play_vol -= 10;
+				audio_play_set_volume(&audio_play_device, play_vol);
+			}
+		}
+	}
+}
@@ -0,0 +1,334 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page cache_benchmark Cache Benchmark Example
+ *
+ *  \section Purpose
+ *
+ *  This example measures the throughput of memcpy, memset and random reads
+ *  on a DDR section for each MMU cache policy, and for several L2 cache
+ *  controller configurations.  It shows how to change the attributes of a
+ *  memory region at runtime with mmu_set_region_attributes().
+ *
+ *  \section Description
+ *
+ *  A 1MB buffer aligned on a MMU section is reserved in DDR.  For each cache
+ *  policy (strongly-ordered, device, normal non-cacheable, write-through,
+ *  write-back, write-back write-allocate) the section attributes are changed
+ *  and each test is run on a working set that fits in the L1 cache and on a
+ *  working set larger than the L2 cache.  Durations are measured with the
+ *  Cortex-A5 cycle counter and throughputs are printed in MB/s.
+ *
+ *  On devices with a L2 cache controller, the write-back policy is then
+ *  measured with the L2 disabled and with different prefetch and RAM
+ *  latency settings.
+ */
+
+/** \file
+ *
+ *  This file contains all the specific code for the cache benchmark example.
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "chip.h"
+#include "compiler.h"
+
+#include "core/arm_cp15_pmu.h"
+
+#include "peripherals/pmc.h"
+#ifdef CONFIG_HAVE_L2CC
+#include "peripherals/l2cc.h"
+#endif
+
+#include "misc/console.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Size of the small working set (fits in the L1 data cache) */
+#define SMALL_SIZE (16 * 1024)
+
+/** Size of the large working set (larger than the L2 cache) */
+#define LARGE_SIZE (256 * 1024)
+
+/** Amount of data processed by each measurement */
+#define BYTES_PER_TEST (4 * 1024 * 1024)
+
+/** Attributes common to all the tested policies */
+#define BENCH_ATTRIBUTES TTB_SECT_EXEC_NEVER
+
+struct _policy {
+	const char *name;
+	uint32_t attributes;
+};
+
+#ifdef CONFIG_HAVE_L2CC
+struct _l2_setting {
+	const char *name;
+	bool enable;
+	bool prefetch;
+	uint8_t offset;
+	const struct _l2cc_ram_latency *latency;
+};
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local constants
+ *----------------------------------------------------------------------------*/
+
+static const struct _policy policies[] = {
+	{ "strongly-ordered", TTB_SECT_STRONGLY_ORDERED },
+	{ "device", TTB_SECT_SHAREABLE_DEVICE },
+	{ "non-cacheable", TTB_SECT_NORMAL_NON_CACHEABLE },
+	{ "write-through", TTB_SECT_CACHEABLE_WT },
+	{ "write-back", TTB_SECT_CACHEABLE_WB },
+	{ "write-back/alloc", TTB_SECT_CACHEABLE_WB_WA },
+};
+
+#ifdef CONFIG_HAVE_L2CC
+/** Conservative RAM latencies, valid at any clock setting */
+static const struct _l2cc_ram_latency slow_latency = {
+	.setup = 2,
+	.read = 2,
+	.write = 2,
+};
+
+/* Settings that change the RAM latencies must be last, the reset values
+ * cannot be restored afterwards */
+static const struct _l2_setting l2_settings[] = {
+	{ "L2 off", false, false, 0, NULL },
+	{ "L2 on", true, false, 0, NULL },
+	{ "L2 prefetch +7", true, true, 7, NULL },
+	{ "L2 prefetch +31", true, true, 31, NULL },
+	{ "L2 prefetch +31, slow RAMs", true, true, 31, &slow_latency },
+};
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Benchmark buffer, it is the only content of its MMU section */
+ALIGNED(TTB_SECT_SIZE) SECTION(".region_ddr")
+static uint8_t bench_buffer[TTB_SECT_SIZE];
+
+/** Processor clock in MHz */
+static uint32_t cpu_mhz;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _throughput(uint32_t bytes, uint32_t cycles)
+{
+	if (!cycles)
+		return 0;
+	return (uint32_t)(((uint64_t)bytes * cpu_mhz) / cycles);
+}
+
+static uint32_t _bench_memcpy(uint32_t size)
+{
+	uint8_t *src = bench_buffer;
+	uint8_t *dst = bench_buffer + LARGE_SIZE;
+	uint32_t i, start, loops = BYTES_PER_TEST / size;
+
+	start = cp15_get_cycle_counter();
+	for (i = 0; i < loops; i++)
+		memcpy(dst, src, size);
+	return _throughput(loops * size, cp15_get_cycle_counter() - start);
+}
+
+static uint32_t _bench_memset(uint32_t size)
+{
+	uint8_t *dst = bench_buffer + LARGE_SIZE;
+	uint32_t i, start, loops = BYTES_PER_TEST / size;
+
+	start = cp15_get_cycle_counter();
+	for (i = 0; i < loops; i++)
+		memset(dst, (uint8_t)i, size);
+	return _throughput(loops * size, cp15_get_cycle_counter() - start);
+}
+
+static uint32_t _bench_random(uint32_t size)
+{
+	volatile uint32_t *words = (volatile uint32_t*)bench_buffer;
+	uint32_t i, start, mask = size / sizeof(uint32_t) - 1;
+	uint32_t index = 1, sum = 0;
+	uint32_t count = BYTES_PER_TEST / sizeof(uint32_t) / 4;
+
+	start = cp15_get_cycle_counter();
+	for (i = 0; i < count; i++) {
+		/* LCG, Numerical Recipes constants */
+		index = index * 1664525 + 1013904223;
+		sum += words[(index >> 8) & mask];
+	}
+	start = cp15_get_cycle_counter() - start;
+
+	/* keep the reads */
+	words[0] = sum;
+
+	return _throughput(count * sizeof(uint32_t), start);
+}
+
+static void _print_header(void)
+{
+	printf("%-28s %9s %9s %9s %9s %9s %9s\r\n", "",
+	       "cpy 16K", "set 16K", "rnd 16K",
+	       "cpy 256K", "set 256K", "rnd 256K");
+}
+
+static void _run_tests(const char *name)
+{
+	uint32_t cpy_s, set_s, rnd_s, cpy_l, set_l, rnd_l;
+
+	cpy_s = _bench_memcpy(SMALL_SIZE);
+	set_s = _bench_memset(SMALL_SIZE);
+	rnd_s = _bench_random(SMALL_SIZE);
+	cpy_l = _bench_memcpy(LARGE_SIZE);
+	set_l = _bench_memset(LARGE_SIZE);
+	rnd_l = _bench_random(LARGE_SIZE);
+
+	printf("%-28s %9u %9u %9u %9u %9u %9u\r\n", name,
+	       (unsigned)cpy_s, (unsigned)set_s, (unsigned)rnd_s,
+	       (unsigned)cpy_l, (unsigned)set_l, (unsigned)rnd_l);
+}
+
+static bool _set_policy(uint32_t attributes)
+{
+	return mmu_set_region_attributes((uint32_t)bench_buffer,
+			sizeof(bench_buffer), attributes);
+}
+
+#ifdef CONFIG_HAVE_L2CC
+static void _apply_l2_setting(const struct _l2_setting *setting)
+{
+	struct _l2cc_config cfg;
+
+	if (l2cc_is_enabled()) {
+		/* write back everything before turning the L2 off */
+		cp15_dcache_clean_invalidate();
+		l2cc_clean_invalidate();
+		l2cc_disable();
+	}
+
+	if (!setting->enable)
+		return;
+
+	if (setting->latency) {
+		l2cc_set_tag_ram_latency(setting->latency);
+		l2cc_set_data_ram_latency(setting->latency);
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.data_prefetch = setting->prefetch;
+	cfg.instruct_prefetch = setting->prefetch;
+	cfg.double_linefill = setting->prefetch;
+	cfg.incr_double_linefill = setting->prefetch;
+	cfg.prefetch_drop = setting->prefetch;
+	cfg.offset = setting->offset;
+	cfg.force_write_alloc = L2CC_FWA_NO_ALLOCATE;
+	cfg.standby_mode = true;
+	cfg.dyn_clock_gating = true;
+	l2cc_configure(&cfg);
+
+	/* l2cc_configure always enables prefetch */
+	if (!setting->prefetch) {
+		cp15_dcache_clean_invalidate();
+		l2cc_clean_invalidate();
+		l2cc_disable();
+		l2cc_set_config(&cfg);
+		l2cc_enable();
+	}
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ *  \brief Cache benchmark Application entry point.
+ *
+ *  \return Unused (ANSI-C compatibility).
+ */
+int main(void)
+{
+	uint32_t i, saved;
+
+	/* Output example information */
+	console_example_info("Cache Benchmark Example");
+
+	cpu_mhz = pmc_get_processor_clock() / 1000000;
+	printf("Processor clock: %u MHz\r\n", (unsigned)cpu_mhz);
+	printf("Buffer: %u bytes at 0x%08x\r\n", (unsigned)sizeof(bench_buffer),
+	       (unsigned)bench_buffer);
+	printf("Results in MB/s\r\n\r\n");
+
+	cp15_pmu_enable();
+	cp15_pmu_start(CP15_PMU_CYCLE_COUNTER);
+
+	saved = mmu_get_region_attributes((uint32_t)bench_buffer);
+
+	_print_header();
+	for (i = 0; i < ARRAY_SIZE(policies); i++) {
+		if (!_set_policy(policies[i].attributes | BENCH_ATTRIBUTES)) {
+			printf("-E- Cannot change the attributes of the buffer\r\n");
+			break;
+		}
+		_run_tests(policies[i].name);
+	}
+
+#ifdef CONFIG_HAVE_L2CC
+	printf("\r\nwrite-back policy, L2 cache settings\r\n");
+	_set_policy(TTB_SECT_CACHEABLE_WB | BENCH_ATTRIBUTES);
+	_print_header();
+	for (i = 0; i < ARRAY_SIZE(l2_settings); i++) {
+		_apply_l2_setting(&l2_settings[i]);
+		_run_tests(l2_settings[i].name);
+	}
+	_apply_l2_setting(&l2_settings[0]);
+#endif
+
+	_set_policy(saved);
+
+	printf("\r\nDone.\r\n");
+
+	while (1);
+}
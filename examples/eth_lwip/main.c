@@ -45,6 +45,10 @@
  *  Please refer to the lwIP documentation for more information about
  *  the TCP/IP stack and the webserver example.
  *
+ *  lwIP runs on the scheduler (CONFIG_LIB_LWIP_THREADS): the "tcpip" thread
+ *  runs the stack, its timers and the HTTP server callbacks, the "ethif"
+ *  thread hands the received frames over to it.
+ *
  *  By default, the example does not use DHCP. If you want to use DHCP,
  *  please open file lwipopts.h and define "LWIP_DHCP" and "LWIP_UDP" to 1.
  *
@@ -111,41 +115,26 @@
 #include "memories/at24.h"
 #include "misc/console.h"
 #include "peripherals/pio.h"
+#include "peripherals/trngd.h"
 
 #include "liblwip.h"
+#include "lwip/tcpip.h"
 #include "httpd.h"
 
+#include "sched.h"
+
 #include <stdio.h>
 #include <string.h>
 
-/*----------------------------------------------------------------------------
- *        Types
- *----------------------------------------------------------------------------*/
-
-/* Timer for calling lwIP tmr functions without system */
-typedef struct _timers_info {
-	uint32_t timer;
-	uint32_t timer_interval;
-	void (*timer_func)(void);
-} timers_info;
-
 /*---------------------------------------------------------------------------
  *         Variables
  *---------------------------------------------------------------------------*/
 
-/* lwIP tmr functions list */
-static timers_info timers_table[] = {
-	/* LWIP_TCP */
-	{ 0, TCP_FAST_INTERVAL,     tcp_fasttmr},
-	{ 0, TCP_SLOW_INTERVAL,     tcp_slowtmr},
-	/* LWIP_ARP */
-	{ 0, ARP_TMR_INTERVAL,      etharp_tmr},
-	/* LWIP_DHCP */
-#if LWIP_DHCP
-	{ 0, DHCP_COARSE_TIMER_SECS, dhcp_coarse_tmr},
-	{ 0, DHCP_FINE_TIMER_MSECS,  dhcp_fine_tmr},
-#endif
-};
+/* Posted by the tcpip thread once the network is up */
+static struct _sched_sem net_ready;
+
+/* The network interface */
+static struct netif eth_netif;
 
 /** if AT24 is available on the board, it will be used to setup the MAC addr */
 static const struct _pin at24_pins[] = AT24_PINS;
@@ -182,44 +171,43 @@ static const uint8_t gNetMask[4] = {255, 255, 255, 0};
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
-#if 1
+
 /**
- * Process timing functions
+ * Add the network interface and start the HTTP server, called by the tcpip
+ * thread once lwIP is initialized: the raw API must be used from there.
  */
-static void timers_update(void)
+static void _tcpip_init_done(void* arg)
 {
-	static uint32_t last_time;
-	uint32_t cur_time, time_diff, idxtimer;
-	timers_info * ptmr_inf;
+	struct ip_addr ipaddr, netmask, gw;
+	struct netif* netif;
 
-	cur_time = sys_get_ms();
-	if (cur_time >= last_time)
-	{
-		time_diff = cur_time - last_time;
-	}
-	else
-	{
-		time_diff = 0xFFFFFFFF - last_time + cur_time;
-	}
-	if (time_diff)
-	{
-		last_time = cur_time;
-		for(idxtimer=0;
-			idxtimer < (sizeof(timers_table)/sizeof(timers_info));
-			idxtimer ++)
-		{
-			ptmr_inf = &timers_table[idxtimer];
-			ptmr_inf->timer += time_diff;
-			if (ptmr_inf->timer > ptmr_inf->timer_interval)
-			{
-				if (ptmr_inf->timer_func)
-					ptmr_inf->timer_func();
-				ptmr_inf->timer -= ptmr_inf->timer_interval;
-			}
-		}
-	}
-}
+	/* Initialize net interface for lwIP */
+	ethif_setmac((u8_t*)gMacAddress);
+
+#if !LWIP_DHCP
+	IP4_ADDR(&gw, gGateWay[0], gGateWay[1], gGateWay[2], gGateWay[3]);
+	IP4_ADDR(&ipaddr, gIpAddress[0], gIpAddress[1], gIpAddress[2], gIpAddress[3]);
+	IP4_ADDR(&netmask, gNetMask[0], gNetMask[1], gNetMask[2], gNetMask[3]);
+#else
+	IP4_ADDR(&gw, 0, 0, 0, 0);
+	IP4_ADDR(&ipaddr, 0, 0, 0, 0);
+	IP4_ADDR(&netmask, 0, 0, 0, 0);
+#endif
+	netif = netif_add(&eth_netif, &ipaddr, &netmask, &gw, NULL, ethif_init,
+			tcpip_input);
+	netif_set_default(netif);
+	netif_set_up(netif);
+#if LWIP_DHCP
+	dhcp_start(netif);
 #endif
+
+	/* Initialize http server application */
+	if (ERR_OK != httpd_init())
+		printf("httpd_init failed\n\r");
+
+	sched_sem_post((struct _sched_sem*)arg);
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -231,12 +219,8 @@ static void timers_update(void)
  */
 int main(void)
 {
-	struct ip_addr ipaddr, netmask, gw;
-	struct netif NetIf, *netif;
-
-#if LWIP_DHCP
-	u8_t   dhcp_state = DHCP_INIT;
-#endif
+	/* main becomes the lowest priority thread, the others preempt it */
+	sched_start(SCHED_PRIO_IDLE);
 
 	/* Output example information */
 	console_example_info("ETH lwIP Example");
@@ -269,37 +253,23 @@ int main(void)
 	printf(" - DHCP Enabled\n\r");
 #endif
 
-	/* Initialize lwIP modules */
-	lwip_init();
+	/* Random TCP initial sequence numbers and DHCP transaction IDs */
+	trngd_initialize();
 
-	/* Initialize net interface for lwIP */
-	ethif_setmac((u8_t*)gMacAddress);
+	/* Start the tcpip thread and wait for the network to be up */
+	sched_sem_init(&net_ready, 0);
+	tcpip_init(_tcpip_init_done, &net_ready);
+	sched_sem_wait(&net_ready, SCHED_WAIT_FOREVER);
 
-#if !LWIP_DHCP
-	IP4_ADDR(&gw, gGateWay[0], gGateWay[1], gGateWay[2], gGateWay[3]);
-	IP4_ADDR(&ipaddr, gIpAddress[0], gIpAddress[1], gIpAddress[2], gIpAddress[3]);
-	IP4_ADDR(&netmask, gNetMask[0], gNetMask[1], gNetMask[2], gNetMask[3]);
-#else
-	IP4_ADDR(&gw, 0, 0, 0, 0);
-	IP4_ADDR(&ipaddr, 0, 0, 0, 0);
-	IP4_ADDR(&netmask, 0, 0, 0, 0);
-#endif
-	netif = netif_add(&NetIf, &ipaddr, &netmask, &gw, NULL, ethif_init, ip_input);
-	netif_set_default(netif);
-	netif_set_up(netif);
-	/* Initialize http server application */
-	if (ERR_OK != httpd_init())
-	{
-		printf("httpd_init ERR_OK!");
+	/* Process the frames as they are received */
+	if (!ethif_start_rx_thread(&eth_netif)) {
+		printf("Failed to start the RX thread\n\r");
 		return -1;
 	}
 	printf ("Type the IP address of the device in a web browser, http://192.168.1.3 \n\r");
-	while(1)
-	{
-		/* Run periodic tasks */
-		timers_update();
 
-		/* Run polling tasks */
-		ethif_poll(netif);
-	}
+	/* Nothing left to do here, the other threads do the work */
+	for (;;)
+		sched_sleep(SCHED_WAIT_FOREVER);
+	return 0;
 }
@@ -93,7 +93,6 @@
 #include "peripherals/aic.h"
 #include "peripherals/pmc.h"
 #include "peripherals/pio.h"
-#include "peripherals/xdmad.h"
 
 #include "misc/console.h"
 #include "peripherals/twi.h"
@@ -101,6 +100,8 @@
 #include "peripherals/isc.h"
 
 #include "video/lcdd.h"
+#include "video/isc_preview.h"
+#include "video/isc_3a.h"
 #include "video/image_sensor_inf.h"
 #include "timer.h"
 
@@ -109,6 +110,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 /*----------------------------------------------------------------------------
  *        Local definitions
@@ -119,9 +121,6 @@
 #define ISC_OUTPUT_BASE_ADDRESS1  (ISC_OUTPUT_BASE_ADDRESS + 0x100000)
 #define ISC_OUTPUT_BASE_ADDRESS2  (ISC_OUTPUT_BASE_ADDRESS1 + 0x100000)
 
-/** DMA memory address for Histogram */
-#define ISC_HIS_BASE_ADDRESS  (0x22000000)
-
 /** Supported LCD mode in this example */
 #define LCD_MODE_YUV          (LCDC_HEOCFG1_YUVEN | LCDC_HEOCFG1_YUVMODE_16BPP_YCBCR_MODE2)
 #define LCD_MODE_RGB565       LCDC_HEOCFG1_RGBMODE_16BPP_RGB_565
@@ -130,39 +129,17 @@
 #define LCD_MODE_YUV420_PLANAR   (LCDC_HEOCFG1_YUVEN |LCDC_HEOCFG1_YUVMODE_12BPP_YCBCR_PLANAR)
 #define LCD_MODE_YUV420_SEMIPLANAR   (LCDC_HEOCFG1_YUVEN |LCDC_HEOCFG1_YUVMODE_12BPP_YCBCR_SEMIPLANAR)
 
-/** Maximum number of frame buffer */
-#define ISC_MAX_NUM_FRAME_BUFFER    1
+/** Number of preview frame buffers, each made of three 1MB planes */
+#define ISC_NUM_FRAME_BUFFER    3
+#define ISC_FRAME_BUFFER_SIZE   (3 * 0x100000)
 
 /** TWI clock frequency in Hz. */
 #define TWCK                  400000
 
-/* GAMMA and HISTOGRAM definitions */
+/* GAMMA definitions */
 #define GAMMA_28
 #define GAMMA_ENTRIES   64
 
-#define HISTOGRAM_GR   0
-#define HISTOGRAM_R    1
-#define HISTOGRAM_GB   2
-#define HISTOGRAM_B    3
-#define HISTOGRAM_Y    4
-
-#define HIST_ENTRIES   512
-#define HIST_RGGB_BAYER  5
-
-#define AE_TUNING
-
-/*----------------------------------------------------------------------------
- *        Local Type
- *----------------------------------------------------------------------------*/
-
-/** Sensor status or return code */
-typedef enum _awb_status {
-	AWB_INIT = 0,
-	AWB_WAIT_HIS_READY,
-	AWB_WAIT_DMA_READY,
-	AWB_WAIT_ISC_PERFORMED,
-} awb_status_t;
-
 /*----------------------------------------------------------------------------
  *        Local variables/constants
  *----------------------------------------------------------------------------*/
@@ -180,19 +157,13 @@ static const sensor_profile_t *sensor_profiles[6] = {
 /** PIO pins to configured. */
 const struct _pin pins_twi[] = ISC_TWI_PINS;
 
-CACHE_ALIGNED struct _isc_dma_view0 dma_descs[ISC_MAX_NUM_FRAME_BUFFER + 1];
-
-CACHE_ALIGNED struct _isc_dma_view2 dma_descs2[ISC_MAX_NUM_FRAME_BUFFER + 1];
-
 /** TWI driver instance.*/
 static struct _twi_desc twid = {
 	.addr = ISC_TWI_ADDR,
 	.freq = TWCK,
-	.transfert_mode = TWID_MODE_POLLING
+	.transfert_mode = TWID_MODE_DMA
 };
 
-static awb_status_t awb_status_machine;
-
 /** LCD buffer.*/
 static uint8_t *pHeoBuffer =  (uint8_t*)ISC_OUTPUT_BASE_ADDRESS;
 static uint8_t *pHeoBuffer1 =  (uint8_t*)ISC_OUTPUT_BASE_ADDRESS1;
@@ -212,21 +183,13 @@ static sensor_output_format_t sensor_mode;
 /* LCD mode */
 static uint32_t lcd_mode;
 
-/** DMA channel */
-static struct _xdmad_channel *xdmad_channel;
-
 volatile static uint32_t capture_started = 0;
 
-static uint32_t histogram_count[HIST_RGGB_BAYER];
-
-static uint32_t histogram_y[HIST_ENTRIES];
-
-static uint32_t histogram_idx_isc;
-
-volatile static bool histogram_done;
-volatile static bool histogram_read;
 volatile static bool ae_awb;
 
+/** Print the AE/AWB updates on the console, for a host replay */
+static bool ae_awb_trace;
+
 /* Color space matrix setting */
 static struct _color_space cs = {
 	0x42, 0x81, 0x19 ,
@@ -277,65 +240,6 @@ const uint32_t gamma_table[GAMMA_ENTRIES] = {
 };
 #endif
 
-/**
- * \brief Callback entry for histogram DMA transfer done.
- */
-static void _dma_callback(struct _xdmad_channel *channel, void *arg)
-{
-	cache_invalidate_region((uint32_t*)ISC_HIS_BASE_ADDRESS, HIST_ENTRIES * sizeof(uint32_t));
-	histogram_read = true;
-}
-
-/**
- * \brief Configure xDMA to read Histogram entries.
- */
-static void xdma_read_histogram(uint32_t buf)
-{
-	struct _xdmad_cfg xdmad_cfg;
-	xdmad_cfg.ubc = HIST_ENTRIES;
-	xdmad_cfg.sa = (uint32_t *)(&(ISC->ISC_HIS_ENTRY[0]));
-	xdmad_cfg.da =  (uint32_t* )buf;
-	xdmad_cfg.cfg = XDMAC_CC_MBSIZE_SINGLE
-	              | XDMAC_CC_TYPE_MEM_TRAN
-	              | XDMAC_CC_CSIZE_CHK_1
-	              | XDMAC_CC_DWIDTH_WORD
-	              | XDMAC_CC_SIF_AHB_IF0
-	              | XDMAC_CC_DIF_AHB_IF0
-	              | XDMAC_CC_SAM_INCREMENTED_AM
-	              | XDMAC_CC_DAM_INCREMENTED_AM;
-	xdmad_cfg.bc = 0;
-	xdmad_cfg.ds = 0;
-	xdmad_cfg.sus = 0;
-	xdmad_cfg.dus = 0;
-	xdmad_configure_transfer(xdmad_channel, &xdmad_cfg, 0, 0);
-	xdmad_set_callback(xdmad_channel, _dma_callback, NULL);
-	xdmad_start_transfer(xdmad_channel);
-}
-
-/**
- * \brief Convert float data to HEX with giving format.
- * \param sign_bit length of sign in bit
- * \param magnitude_bit length of magnitude in bit
- * \param fractional_bit length of fractional in bit
- * \param f float value to be converted
- */
-static uint32_t float2hex(uint8_t sign_bit, uint8_t magnitude_bit, uint8_t fractional_bit, float f)
-{
-	uint32_t hex;
-	if(!sign_bit){
-		if (f < 0.0) return 0;
-		hex = (uint32_t) (f * (1 << fractional_bit));
-	} else {
-		if (f < 0.0) {
-			hex = (uint32_t)( (f) * (-1.0) * (1 << fractional_bit));
-			hex = ~hex - 1;
-		} else {
-			hex = (uint32_t)(f * (1 << fractional_bit));
-		}
-	}
-	return hex;
-}
-
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -355,10 +259,11 @@ static void isc_handler(void)
 		}
 	}
 	if ((status & ISC_INTSR_DDONE) == ISC_INTSR_DDONE) {
+		isc_preview_dma_done();
 	}
 
 	if ((status & ISC_INTSR_HISDONE) == ISC_INTSR_HISDONE) {
-		histogram_done = true;
+		isc_3a_histogram_done();
 	}
 
 	if ((status & ISC_INTSR_LDONE) == ISC_INTSR_LDONE) {
@@ -556,18 +461,6 @@ static void configure_isc(void)
 											ISC_DCFG_YMBSIZE_BEATS8 |
 											ISC_DCFG_CMBSIZE_BEATS8);
 			}
-			isc_dma_configure_desc_entry((uint32_t)&dma_descs2[0]);
-			if ((lcd_mode == LCD_MODE_YUV422_PLANAR) \
-				|| (lcd_mode == LCD_MODE_YUV420_PLANAR)){
-				isc_dma_enable(ISC_DCTRL_DVIEW_PLANAR | ISC_DCTRL_DE);
-			}
-			if ((lcd_mode == LCD_MODE_YUV422_SEMIPLANAR)\
-				|| (lcd_mode == LCD_MODE_YUV420_SEMIPLANAR )){
-				isc_dma_enable(ISC_DCTRL_DVIEW_SEMIPLANAR | ISC_DCTRL_DE);
-			}
-			isc_dma_adderss(0, ISC_OUTPUT_BASE_ADDRESS, 0);
-			isc_dma_adderss(0, ISC_OUTPUT_BASE_ADDRESS2, 0);
-			isc_dma_adderss(0, ISC_OUTPUT_BASE_ADDRESS1, 0);
 		}
 		if (lcd_mode == LCD_MODE_RGB565) {
 			/* Configure RGB 565 output format before the
@@ -577,9 +470,6 @@ static void configure_isc(void)
 			 * descriptor view 0 used for the data stream
 			 * is packed. */
 			isc_dma_configure_input_mode(ISC_DCFG_IMODE_PACKED16);
-			isc_dma_configure_desc_entry((uint32_t)&dma_descs[0]);
-			isc_dma_enable(ISC_DCTRL_DVIEW_PACKED | ISC_DCTRL_DE);
-			isc_dma_adderss(0, ISC_OUTPUT_BASE_ADDRESS, 0);
 		}
 	}
 	if (sensor_mode == YUV_422) {
@@ -594,10 +484,9 @@ static void configure_isc(void)
 		/* Set DAM for 8-bit packaged stream with descriptor view 0 used
 		   for the data stream is packed*/
 		isc_dma_configure_input_mode(ISC_DCFG_IMODE_PACKED8);
-		isc_dma_configure_desc_entry((uint32_t)&dma_descs[0]);
-		isc_dma_enable(ISC_DCTRL_DVIEW_PACKED | ISC_DCTRL_DE);
-		isc_dma_adderss(0, ISC_OUTPUT_BASE_ADDRESS, 0);
 	}
+	/* Capture into the preview buffers not on screen */
+	isc_preview_start();
 
 	isc_histogram_enabled(1);
 	isc_clear_histogram_table();
@@ -616,197 +505,62 @@ static void configure_isc(void)
 }
 
 /**
- * \brief Set up DMA Descriptors.
+ * \brief Set up the preview buffers shared by the ISC DMA and the LCDC.
  */
 static void configure_dma_linklist(void)
 {
-	uint32_t i;
+	struct _isc_preview_cfg cfg;
+	uint32_t base, i;
 
 	aic_disable(ID_ISC);
 	isc_software_reset();
-	if ((lcd_mode == LCD_MODE_YUV422_PLANAR) \
-		|| (lcd_mode == LCD_MODE_YUV420_PLANAR)){
-		for(i = 0; i < ISC_MAX_NUM_FRAME_BUFFER; i++) {
-			dma_descs2[i].ctrl =
-				ISC_DCTRL_DVIEW_PLANAR | ISC_DCTRL_DE;
-			dma_descs2[i].next_desc = (uint32_t)&dma_descs2[i + 1 ];
-			dma_descs2[i].addr0 = (uint32_t)ISC_OUTPUT_BASE_ADDRESS;
-			dma_descs2[i].stride0 = 0;
-			dma_descs2[i].addr1 = (uint32_t)ISC_OUTPUT_BASE_ADDRESS2;
-			dma_descs2[i].stride1 = 0;
-			dma_descs2[i].addr2 =  (uint32_t)ISC_OUTPUT_BASE_ADDRESS1;
-			dma_descs2[i].stride2 = 0;
-		}
-		dma_descs2[i-1].next_desc = (uint32_t)&dma_descs2[0];
-		cache_clean_region(dma_descs2, sizeof(dma_descs2));
 
-	} else if ((lcd_mode == LCD_MODE_YUV422_SEMIPLANAR) \
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.layer = LCDD_HEO;
+	cfg.count = ISC_NUM_FRAME_BUFFER;
+	for (i = 0; i < ISC_NUM_FRAME_BUFFER; i++) {
+		base = ISC_OUTPUT_BASE_ADDRESS + i * ISC_FRAME_BUFFER_SIZE;
+		cfg.buffers[i].isc_addr[0] = base;
+		cfg.buffers[i].lcd_addr[0] = (void*)base;
+		if ((lcd_mode == LCD_MODE_YUV422_PLANAR) \
+			|| (lcd_mode == LCD_MODE_YUV420_PLANAR)){
+			/* ISC writes Cr on channel 1 and Cb on channel 2 */
+			cfg.dview = ISC_DCTRL_DVIEW_PLANAR;
+			cfg.buffers[i].isc_addr[1] = base + 0x200000;
+			cfg.buffers[i].isc_addr[2] = base + 0x100000;
+			cfg.buffers[i].lcd_addr[1] = (void*)(base + 0x100000);
+			cfg.buffers[i].lcd_addr[2] = (void*)(base + 0x200000);
+		} else if ((lcd_mode == LCD_MODE_YUV422_SEMIPLANAR) \
 				|| (lcd_mode == LCD_MODE_YUV420_SEMIPLANAR)){
-		for(i = 0; i < ISC_MAX_NUM_FRAME_BUFFER; i++) {
-			dma_descs2[i].ctrl =
-				ISC_DCTRL_DVIEW_SEMIPLANAR | ISC_DCTRL_DE;
-			dma_descs2[i].next_desc = (uint32_t)&dma_descs2[i + 1 ];
-			dma_descs2[i].addr0 = (uint32_t)ISC_OUTPUT_BASE_ADDRESS;
-			dma_descs2[i].stride0 = 0;
-			dma_descs2[i].addr1 = (uint32_t)ISC_OUTPUT_BASE_ADDRESS1 + 1;
-			dma_descs2[i].stride1 = 0;
-			dma_descs2[i].addr2 = 0;
-			dma_descs2[i].stride2 = 0;
-		}
-		dma_descs2[i-1].next_desc = (uint32_t)&dma_descs2[0];
-		cache_clean_region(dma_descs2, sizeof(dma_descs2));
-	} else {
-		for(i = 0; i < ISC_MAX_NUM_FRAME_BUFFER; i++) {
-			dma_descs[i].ctrl =
-				ISC_DCTRL_DVIEW_PACKED | ISC_DCTRL_DE;
-			dma_descs[i].next_desc =(uint32_t)&dma_descs[i + 1];
-			dma_descs[i].addr = (uint32_t)ISC_OUTPUT_BASE_ADDRESS;
-			dma_descs[i].stride = 0;
-		}
-		dma_descs[i-1].next_desc = (uint32_t)&dma_descs[0];
-		cache_clean_region(dma_descs, sizeof(dma_descs));
-	}
-}
-
-/**
- * \brief Calculate gain for RGGB bayer and perform them with ISC WB module.
- */
-static void awb_update(void)
-{
-	float gain[HIST_RGGB_BAYER];
-	uint32_t gain_049[HIST_RGGB_BAYER];
-	gain[HISTOGRAM_GB] = 1.0000000;
-	gain[HISTOGRAM_GR] = (float)(histogram_count[HISTOGRAM_GB]) / \
-						(float)(histogram_count[HISTOGRAM_GR]);
-	gain[HISTOGRAM_R] = (float)(histogram_count[HISTOGRAM_GB]) / \
-						(float)(histogram_count[HISTOGRAM_R]);
-	gain[HISTOGRAM_B] = (float)(histogram_count[HISTOGRAM_GB]) / \
-						(float)(histogram_count[HISTOGRAM_B]);
-
-	gain_049[HISTOGRAM_GB] = float2hex(0, 4, 9, gain[HISTOGRAM_GB]);
-	gain_049[HISTOGRAM_GR] = float2hex(0, 4, 9, gain[HISTOGRAM_GR]);
-	gain_049[HISTOGRAM_B] = float2hex(0, 4, 9, gain[HISTOGRAM_B]);
-	gain_049[HISTOGRAM_R] = float2hex(0, 4, 9, gain[HISTOGRAM_R]);
-	isc_wb_adjust_bayer_color(0, 0, 0, 0,
-					gain_049[HISTOGRAM_R],
-					gain_049[HISTOGRAM_GR],
-					gain_049[HISTOGRAM_B],
-					gain_049[HISTOGRAM_GB]);
-	isc_update_profile();
-}
-
-#if defined AE_TUNING
-/**
- * \brief Calculate gain/offset for Y and perform them with ISC CBC module.
- */
-static void ae_update(void)
-{
-	uint16_t i;
-	float ygain, offset;
-	uint32_t ycount;
-	uint16_t dark_threshold, bright_threshold;
-	uint32_t gain_110, offset_138;
-
-	ycount = 0;
-	dark_threshold = 0;
-	for (i = 0; i < HIST_ENTRIES; i++) {
-		ycount += histogram_y[i];
-		if (ycount >= histogram_count[HISTOGRAM_Y] * 5 / 100) {
-			dark_threshold = i;
-			break;
-		}
-	}
-
-	ycount = 0;
-	bright_threshold = i;
-	for (i = HIST_ENTRIES - 1; i > 1; i--) {
-		ycount += histogram_y[i];
-		if (ycount >= histogram_count[HISTOGRAM_Y]) {
-			bright_threshold = i;
-			break;
-		}
-	}
-	//printf("<%d, %d> ", bright_threshold, dark_threshold);
-	ygain = 512.0/ ((float)(bright_threshold - dark_threshold));
-	offset = (512.0 / ygain) - (float)bright_threshold;
-	//printf("<%f, %f> ",ygain,offset);
-	gain_110 = float2hex(1, 10, 0, ygain);
-	offset_138 = float2hex(1, 3, 8, offset);
-
-	isc_cbc_configure(0, 0, gain_110, offset_138);
-	isc_update_profile();
-	//printf("<%x, %x> ", gain_110, offset_138);
-}
-#endif
-
-/**
- * \brief Count up 4 channel R/G/Gr/Gb histogram data.
- */
-static void histogram_count_up(void)
-{
-	uint32_t *v;
-	uint32_t i;
-	
-	v = (uint32_t *)ISC_HIS_BASE_ADDRESS;
-	histogram_count[histogram_idx_isc] = 0;
-	for (i = 0; i < HIST_ENTRIES; i++){
-		if (histogram_idx_isc < HISTOGRAM_Y){
-			histogram_count[histogram_idx_isc]+= (*v) * i;
+			cfg.dview = ISC_DCTRL_DVIEW_SEMIPLANAR;
+			cfg.buffers[i].isc_addr[1] = base + 0x100000 + 1;
+			cfg.buffers[i].lcd_addr[1] = (void*)(base + 0x100000);
 		} else {
-			histogram_count[histogram_idx_isc]+= *v ;
-		}
-		if(histogram_idx_isc == HISTOGRAM_Y){
-			histogram_y[i] = (*v);
+			cfg.dview = ISC_DCTRL_DVIEW_PACKED;
 		}
-		v++;
 	}
+	isc_preview_configure(&cfg);
 }
 
 /**
- * \brief Status machine for auto white balance.
+ * \brief Print the preview frame counters.
  */
-static bool auto_white_balance(void)
+static void show_preview_stats(void)
 {
-	if (awb_status_machine == AWB_INIT){
-		isc_histogram_configure(histogram_idx_isc, ISC_HIS_CFG_BAYSEL_BGBG, 1);
-		isc_update_profile();
-		histogram_done = false;
-		histogram_read = false;
-		isc_update_histogram_table();
-		awb_status_machine = AWB_WAIT_HIS_READY;
-		return true;
+	struct _isc_preview_stats stats;
+
+	isc_preview_get_stats(&stats);
+	printf("-I- Frames captured %u, displayed %u, dropped %u\n\r",
+	       (unsigned int)stats.captured,
+	       (unsigned int)stats.displayed,
+	       (unsigned int)stats.dropped);
+	if (ae_awb) {
+		const struct _cam_3a_state *state = isc_3a_get_state();
+		printf("-I- WB gains R %x Gr %x Gb %x B %x, exposure %u, gain %u\n\r",
+		       state->wb_gain[CAM_3A_R], state->wb_gain[CAM_3A_GR],
+		       state->wb_gain[CAM_3A_GB], state->wb_gain[CAM_3A_B],
+		       (unsigned int)state->exposure, state->gain);
 	}
-	if (awb_status_machine == AWB_WAIT_HIS_READY){
-		if(!histogram_done)
-			return true;
-		histogram_done = false;
-		xdma_read_histogram(ISC_HIS_BASE_ADDRESS);
-		awb_status_machine = AWB_WAIT_DMA_READY;
-		return true;
-	}
-	if (awb_status_machine == AWB_WAIT_DMA_READY){
-		if(!histogram_read)
-			return true;
-		histogram_read = false;
-		histogram_count_up();
-		histogram_idx_isc++;
-		if(histogram_idx_isc < HIST_RGGB_BAYER ) {
-			awb_status_machine = AWB_INIT;
-		} else {
-			awb_status_machine = AWB_WAIT_ISC_PERFORMED;
-		}
-		return true;
-	}
-	if (awb_status_machine == AWB_WAIT_ISC_PERFORMED){
-		awb_update();
-#if defined AE_TUNING
-		ae_update();
-#endif
-		histogram_idx_isc = 0;
-		awb_status_machine = AWB_INIT;
-		return true;
-	}
-	return true;
 }
 
 /*----------------------------------------------------------------------------
@@ -821,6 +575,7 @@ extern int main(void)
 {
 	int i;
 	uint8_t key;
+	sensor_prog_stats_t prog_stats;
 
 	/* Output example information */
 	console_example_info("ISC Example");
@@ -828,14 +583,6 @@ extern int main(void)
 	/* TWI Initialize */
 	configure_twi();
 
-	/* Allocate a XDMA channel. */
-	xdmad_channel = xdmad_allocate_channel(XDMAD_PERIPH_MEMORY, XDMAD_PERIPH_MEMORY);
-
-	if (!xdmad_channel) {
-		printf("-E- Can't allocate XDMA channel\n\r");
-		return 0;
-	}
-
 	printf("Image Sensor Selection:\n\r");
 	for (i = 0; i < ARRAY_SIZE(sensor_profiles); i++)
 		printf("- '%d' %s\n\r", i + 1, sensor_profiles[i]->name);
@@ -872,6 +619,10 @@ restart_sensor:
 		printf("-E- Sensor setup failed.");
 		while (1);
 	}
+	sensor_get_program_stats(&prog_stats);
+	printf("-I- Sensor programmed: %u registers in %u transfers, %ums\n\r",
+	       (unsigned)prog_stats.regs, (unsigned)prog_stats.transfers,
+	       (unsigned)prog_stats.write_time);
 
 	/* Retrieve sensor output format and size */
 	sensor_get_output(QVGA, sensor_mode, &sensor_output_bit_width,
@@ -917,30 +668,40 @@ restart_sensor:
 	configure_lcd();
 	configure_dma_linklist();
 	configure_isc();
-	awb_status_machine = AWB_INIT;
 	ae_awb = false;
+	ae_awb_trace = false;
 	printf("-I- Preview start. \n\r");
 	printf("-I- press 'S' or 's' to switch ISC mode. \n\r");
+	printf("-I- press 'F' or 'f' to show preview frame counters. \n\r");
 	if (sensor_mode == RAW_BAYER) {
 		printf("-I- press 'A' or 'a' to start auto white balance & AE. \n\r");
+		printf("-I- press 'T' or 't' to start/stop the AE/AWB trace. \n\r");
 	}
 	
 	for(;;) {
 		if (console_is_rx_ready()) {
 			key = console_get_char();
 			if ((key == 'S') || (key == 's')) {
+				if (ae_awb)
+					isc_3a_stop();
 				isc_stop_capture();
 				break;
 			}
+			if ((key == 'F') || (key == 'f'))
+				show_preview_stats();
 			if (sensor_mode == RAW_BAYER) {
 				if ((key == 'A') || (key == 'a')) {
-					ae_awb = true;
-					auto_white_balance();
+					ae_awb = isc_3a_start(&twid, ISC_HIS_CFG_BAYSEL_BGBG, NULL);
+					ae_awb_trace = false;
+				}
+				if (((key == 'T') || (key == 't')) && ae_awb) {
+					ae_awb_trace = !ae_awb_trace;
+					isc_3a_set_trace(ae_awb_trace);
 				}
 			}
 		}
 		if (ae_awb)
-			auto_white_balance();
+			isc_3a_process();
 	}
 	goto restart_sensor;
 }
@@ -46,7 +46,12 @@
  *
  *  4 layers are displayed:
  *  - Base: The layer at bottom, show test pattern with color blocks.
- *  - OVR1: The layer over base, used as canvas to draw shapes.
+ *  - OVR1: The layer over base, used as canvas to draw shapes. It is double
+ *          buffered: each drawing is rendered in the back buffer between
+ *          lcdd_frame_begin() and lcdd_frame_present(), and the frame
+ *          statistics are printed every 5 seconds.
+ *  - OVR2: The layer over OVR1, showing text drawn with the 8x8 font and
+ *          with the anti-aliased proportional font (lcd_pfont).
  *  - HEO:  The next layer, showed scaled ('F') which flips or rotates once
  *          for a while.
  *
@@ -107,6 +112,7 @@
 
 #include "lcd_draw.h"
 #include "lcd_font.h"
+#include "lcd_pfont.h"
 #include "lcd_color.h"
 #include "font.h"
 #include "timer.h"
@@ -180,10 +186,12 @@
 
 CACHE_ALIGNED_DDR static uint8_t _base_buffer[SIZE_LCD_BUFFER_BASE];
 
-/** Overlay 1 buffer */
+/** Overlay 1 buffers, double buffered */
 
 CACHE_ALIGNED_DDR static uint8_t _ovr1_buffer[SIZE_LCD_BUFFER_OVR1];
 
+CACHE_ALIGNED_DDR static uint8_t _ovr1_back_buffer[SIZE_LCD_BUFFER_OVR1];
+
 /** Overlay 2 buffer */
 
 CACHE_ALIGNED_DDR static uint8_t _ovr2_buffer[SIZE_LCD_BUFFER_OVR2];
@@ -200,6 +208,9 @@ static uint32_t test_colors[N_BLK_HOR*N_BLK_VERT] = {
     COLOR_SKYBLUE, COLOR_VIOLET, COLOR_DARKGRAY, COLOR_DARKGREEN, COLOR_BEIGE, COLOR_BROWN,
 };
 
+/** Proportional font */
+static struct _lcdd_pfont _pfont;
+
 /** Backlight value */
 static uint8_t bBackLight = 0xF0;
 /** OVR1 X */
@@ -231,8 +242,6 @@ static uint8_t  bDrawChange = 0;
 static uint8_t  bDrawSize  =  0;
 /** Drawing shape */
 static uint8_t  bDrawShape =  0;
-/** Last drawing w, h */
-static uint16_t wLastW, wLastH;
 
 /** OVR1 XY move direction (XY - 00 01 10 11) */
 static uint8_t bOvr1Dir = 0x01;
@@ -338,6 +347,16 @@ static void _LcdOn(void)
 	/* Display message font 8x8 */
 	lcdd_select_font(FONT8x8);
 	lcdd_draw_string(8, 56, "ATMEL RFO", COLOR_BLACK);
+
+	/* Display message with anti-aliased proportional font */
+	if (lcdd_pfont_load(&_pfont, lcdd_pfont_sans_16)) {
+		lcdd_pfont_select(&_pfont);
+		lcdd_pfont_draw_string_with_bgcolor(8, 8, "SAMA5 fonts",
+						    COLOR_BLACK, COLOR_WHITE);
+		lcdd_pfont_draw_string(8, 28, "Anti-aliased", COLOR_NAVY);
+	} else {
+		printf("-E- Invalid proportional font\n\r");
+	}
 	cache_clean_region(_ovr2_buffer, sizeof(_ovr2_buffer));
 
 	/* Test LCD draw */
@@ -350,6 +369,13 @@ static void _LcdOn(void)
 	lcdd_fill(OVR1_BG);
 	cache_clean_region(_ovr1_buffer, sizeof(_ovr1_buffer));
 
+	/* Render OVR1 in the back buffer and flip at end of frame */
+	{
+		void *buffers[] = { _ovr1_buffer, _ovr1_back_buffer };
+		if (!lcdd_frame_setup(LCDD_OVR1, buffers, ARRAY_SIZE(buffers)))
+			printf("-E- OVR1 frame setup failed\n\r");
+	}
+
 	printf("- LCD ON\n\r");
 }
 
@@ -523,6 +549,11 @@ static void _draws(void)
 	if (!lcdd_is_layer_on(LCDD_OVR1))
 		return;
 
+	/* The back buffer holds an older frame, redraw everything */
+	if (!lcdd_frame_begin(LCDD_OVR1))
+		return;
+	lcdd_fill(OVR1_BG);
+
 	/* Drawing width, height */
 	if (bDrawSize == 0) {
 		w = h = 2;
@@ -533,20 +564,12 @@ static void _draws(void)
 
 	/* Draw circles */
 	if (bDrawShape){
-		/* Remove last shape */
-		lcdd_draw_circle(x, y, wLastW > wLastH ? wLastH/2 : wLastW/2, OVR1_BG);
-		/* Draw new */
 		lcdd_draw_circle(x, y, w > h ? h/2 : w/2, test_colors[ncolor]);
 		ncolor = (ncolor+1)%NB_TAB_COLOR;
 	} else {
-		/* Remove last shape */
-		lcdd_draw_rounded_rect(x - wLastW/2, y - wLastH/2, wLastW, wLastH, wLastH/3, OVR1_BG);
-		/* Draw new */
 		lcdd_draw_rounded_rect(x - w/2, y - h/2, w, h, h/3, test_colors[ncolor]);
 		ncolor = (ncolor+1)%NB_TAB_COLOR;
 	}
-	wLastW = w;
-	wLastH = h;
 
 	/* Size -- */
 	if (bDrawChange) {
@@ -573,7 +596,27 @@ static void _draws(void)
 			"graphic functionnalities\n"
 			"       on a SAMA5", COLOR_BLACK);
 
-	cache_clean_region(_ovr1_buffer, sizeof(_ovr1_buffer));
+	lcdd_frame_present(LCDD_OVR1);
+}
+
+/**
+ * Print the OVR1 frame statistics and restart them.
+ */
+static void _print_frame_stats(void)
+{
+	struct _lcdd_frame_stats stats;
+
+	lcdd_frame_get_stats(LCDD_OVR1, &stats);
+	lcdd_frame_reset_stats(LCDD_OVR1);
+	if (!stats.frames)
+		return;
+
+	printf("OVR1: %u frames, %u flips (%u late) in %u refreshes, "
+	       "render avg %u max %u ms, wait %u ms\n\r",
+	       (unsigned)stats.frames, (unsigned)stats.flips,
+	       (unsigned)stats.late, (unsigned)stats.vsyncs,
+	       (unsigned)(stats.render_total / stats.frames),
+	       (unsigned)stats.render_max, (unsigned)stats.wait_total);
 }
 
 /**
@@ -638,6 +681,7 @@ extern int main(void)
 	uint32_t t1, t2;
 	uint32_t heoDly = 0;
 	uint32_t ovr1Dly = 0;
+	uint32_t statsDly = 0;
 
 	/* Output example information */
 	console_example_info("LCD Example");
@@ -673,6 +717,14 @@ extern int main(void)
 			} else {
 				heoDly++;
 			}
+
+			/* Frame statistics */
+			if (statsDly >= 5000 / 10) {
+				statsDly = 0;
+				_print_frame_stats();
+			} else {
+				statsDly++;
+			}
 		}
 	}
 }
@@ -0,0 +1,324 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page lcd_ili9488 ILI9488 SPI LCD Example
+ *
+ *  \section Purpose
+ *
+ *  This example shows how to drive the ILI9488 display of the maXTouch
+ *  Xplained Pro over SPI, in direct mode and in framebuffer mode.
+ *
+ *  \section Requirements
+ *
+ *  This package can be used with SAMA5D2-XPLAINED board, with the maXTouch
+ *  Xplained Pro extension connected on the EXT2 connector.
+ *
+ *  \section Description
+ *
+ *  A ball orbits around the center of the display, one step every 20 ms.
+ *  - In direct mode, every pixel is sent to the controller as it is drawn
+ *    by polled SPI accesses.
+ *  - In framebuffer mode (mxtx_fb_enable()), drawing is done in memory and
+ *    the modified areas are sent after each step by mxtx_fb_flush(): the
+ *    window commands and pixels of each area are streamed by DMA, the
+ *    next area being chained from the DMA completion callback. A step is
+ *    skipped if the previous flush is not done.
+ *
+ *  Press 'F' to switch between the two modes. Statistics are printed every
+ *  5 seconds.
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board. Please
+ *     refer to the
+ *     <a href="http://www.atmel.com/dyn/resources/prod_documents/6421B.pdf">
+ *     SAM-BA User Guide</a>, the
+ *     <a href="http://www.atmel.com/dyn/resources/prod_documents/doc6310.pdf">
+ *     GNU-Based Software Development</a>
+ *     application note or to the
+ *     <a href="ftp://ftp.iar.se/WWWfiles/arm/Guides/EWARM_UserGuide.ENU.pdf">
+ *     IAR EWARM User Guide</a>,
+ *     depending on your chosen solution.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Start the application.
+ *  -# In the terminal window, the
+ *     following text should appear (values depend on the board and chip used):
+ *     \code
+ *      -- ILI9488 SPI LCD Example xxx --
+ *      -- SAMxxxxx-xx
+ *      -- Compiled: xxx xx xxxx xx:xx:xx --
+ *     \endcode
+ *  -# The ball orbits on the display.
+ *
+ *  \section References
+ */
+/**
+ * \file
+ *
+ * This file contains all the specific code for the ILI9488 SPI LCD example.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "chip.h"
+
+#include "misc/cache.h"
+#include "misc/console.h"
+
+#include "video/ili9488.h"
+
+#include "lcd_color.h"
+#include "widget.h"
+#include "font.h"
+#include "timer.h"
+#include "trace.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Period of the animation steps, in ms */
+#define STEP_PERIOD     20
+
+/** Period of the statistics, in ms */
+#define STATS_PERIOD    5000
+
+/** Animation geometry */
+#define ORBIT_RADIUS    100
+#define BALL_RADIUS     16
+#define ANGLE_STEP      6
+
+#define BG_COLOR        COLOR_WHITE
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Framebuffer, pixels stored as the SPI words sent to the controller */
+CACHE_ALIGNED_DDR static uint16_t _framebuffer[MXTX_FB_SIZE / sizeof(uint16_t)];
+
+static bool _fb_mode;
+
+static const struct _point _center = {
+	.x = MXTX_LCD_WIDTH / 2,
+	.y = MXTX_LCD_HEIGHT / 2,
+};
+
+static struct _point _ball;
+static uint16_t _angle;
+
+/** Statistics of the current period */
+static struct {
+	uint32_t steps;
+	uint32_t skipped;
+	uint32_t draw_ms;
+	uint32_t flushes;
+	uint32_t flush_ms;
+	uint32_t flush_max_ms;
+} _stats;
+
+static volatile uint32_t _flush_start;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Flush completion callback, called from the DMA interrupt.
+ */
+static void _flush_done(void* arg)
+{
+	uint32_t ms = timer_get_interval(_flush_start, timer_get_tick());
+
+	(void)arg;
+	_stats.flushes++;
+	_stats.flush_ms += ms;
+	if (ms > _stats.flush_max_ms)
+		_stats.flush_max_ms = ms;
+}
+
+/**
+ * \brief Draw the static part of the display and the ball.
+ */
+static void _draw_scene(void)
+{
+	struct _point pt;
+
+	mxtx_clear_screen();
+
+	pt.x = 10;
+	pt.y = 10;
+	mxtx_draw_string(&pt, _fb_mode ? "Framebuffer + DMA" : "Direct SPI",
+			COLOR_BLACK);
+
+	/* Ring around the orbit, never touched by the ball */
+	pt = _center;
+	mxtx_set_color(COLOR_BLACK);
+	mxtx_draw_circle(&pt, ORBIT_RADIUS + BALL_RADIUS + 4);
+
+	_ball = _center;
+	point_on_circle(&_ball, ORBIT_RADIUS, _angle);
+	mxtx_set_color(COLOR_BLUE);
+	pt = _ball;
+	mxtx_draw_filled_circle(&pt, BALL_RADIUS);
+}
+
+/**
+ * \brief Move the ball one step along its orbit.
+ */
+static void _step(void)
+{
+	struct _point pt;
+
+	pt = _ball;
+	mxtx_set_color(BG_COLOR);
+	mxtx_draw_filled_circle(&pt, BALL_RADIUS);
+
+	_angle = (_angle + ANGLE_STEP) % 360;
+	_ball = _center;
+	point_on_circle(&_ball, ORBIT_RADIUS, _angle);
+	pt = _ball;
+	mxtx_set_color(COLOR_BLUE);
+	mxtx_draw_filled_circle(&pt, BALL_RADIUS);
+}
+
+/**
+ * \brief Switch between direct and framebuffer modes, and redraw.
+ */
+static void _set_mode(bool fb_mode)
+{
+	if (fb_mode) {
+		if (mxtx_fb_enable(_framebuffer)) {
+			printf("-E- Framebuffer mode not available\r\n");
+			fb_mode = false;
+		}
+	} else {
+		mxtx_fb_disable();
+	}
+	_fb_mode = fb_mode;
+	printf("%s mode\r\n", _fb_mode ? "Framebuffer" : "Direct");
+
+	_draw_scene();
+	if (_fb_mode) {
+		_flush_start = timer_get_tick();
+		mxtx_fb_flush(NULL, NULL);
+		mxtx_fb_wait_flush();
+	}
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+static void _print_stats(void)
+{
+	uint32_t draw_avg = _stats.steps ? _stats.draw_ms / _stats.steps : 0;
+
+	printf("%s: %u steps, %u skipped, draw avg %u ms",
+	       _fb_mode ? "Framebuffer" : "Direct",
+	       (unsigned)_stats.steps, (unsigned)_stats.skipped,
+	       (unsigned)draw_avg);
+	if (_stats.flushes)
+		printf(", flush avg %u max %u ms",
+		       (unsigned)(_stats.flush_ms / _stats.flushes),
+		       (unsigned)_stats.flush_max_ms);
+	printf("\r\n");
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Application entry point for the ILI9488 SPI LCD example.
+ *
+ * \return Unused (ANSI-C compatibility).
+ */
+extern int main(void)
+{
+	uint32_t step_tick, stats_tick, tick;
+
+	/* Output example information */
+	console_example_info("ILI9488 SPI LCD Example");
+
+	if (mxtx_initialize()) {
+		printf("-E- ILI9488 initialization failed\r\n");
+		while (1);
+	}
+	mxtx_set_backlight(20);
+	mxtx_set_font(FONT10x14);
+	mxtx_get_pnt_struct()->scr_bgcolor = BG_COLOR;
+
+	printf("Press 'F' to switch between direct and framebuffer modes\r\n");
+	_set_mode(true);
+
+	step_tick = stats_tick = timer_get_tick();
+	while (1) {
+		if (console_is_rx_ready()) {
+			uint8_t key = console_get_char();
+			if (key == 'f' || key == 'F')
+				_set_mode(!_fb_mode);
+		}
+
+		tick = timer_get_tick();
+		if (timer_get_interval(step_tick, tick) >= STEP_PERIOD) {
+			step_tick = tick;
+			if (_fb_mode && mxtx_fb_is_flushing()) {
+				_stats.skipped++;
+			} else {
+				_step();
+				_stats.steps++;
+				_stats.draw_ms += timer_get_interval(tick,
+						timer_get_tick());
+				if (_fb_mode) {
+					_flush_start = timer_get_tick();
+					mxtx_fb_flush(_flush_done, NULL);
+				}
+			}
+		}
+
+		if (timer_get_interval(stats_tick, tick) >= STATS_PERIOD) {
+			stats_tick = tick;
+			_print_stats();
+		}
+	}
+}
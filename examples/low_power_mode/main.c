@@ -82,6 +82,7 @@
  *      -- 2 -> Enter Ultra Low Power mode 0
  *      -- 3 -> Enter Ultra Low Power mode 1
  *      -- 4 -> Enter Idle mode
+ *      -- 5 -> Tickless idle for 10 seconds
  *      -- A -> Init DDR
  *      -- B -> Write data in DDR
  *      -- C -> Check data in DDR
@@ -137,6 +138,7 @@
 
 #include "trace.h"
 #include "timer.h"
+#include "power.h"
 #include "compiler.h"
 
 /*----------------------------------------------------------------------------
@@ -144,7 +146,7 @@
  *----------------------------------------------------------------------------
  */
 
-#define MENU_NB_OPTIONS 9
+#define MENU_NB_OPTIONS 10
 #define MENU_STRING_LENGTH 200
 char menu_choice_msg[MENU_NB_OPTIONS][MENU_STRING_LENGTH] = {
 /* "====================MAXLENGTH==================== */
@@ -157,6 +159,7 @@ char menu_choice_msg[MENU_NB_OPTIONS][MENU_STRING_LENGTH] = {
 	" 2 -> Enter Ultra Low Power mode\n\r",
 #endif	
 	" 4 -> Enter Idle mode\n\r",
+	" 5 -> Tickless idle for 10 seconds\n\r",
 	" A -> Init DDR\n\r",
 	" B -> Write data in DDR\n\r",
 	" C -> Check data in DDR\n\r",
@@ -623,6 +626,57 @@ static void menu_idle(void)
 	printf("| | | | | | Leave Idle mode | | | | | |\n\r");
 }
 
+static void _tickless_resume(enum _power_state state)
+{
+	_restore_console();
+}
+
+static void menu_tickless(void)
+{
+	struct _power_config cfg = {
+		.run_clock = &clock_test_setting[0],
+		/* use the selected clock setting for ULP0 */
+		.ulp0_clock = &clock_test_setting[use_clock_setting ?
+			use_clock_setting : 2],
+#ifdef CONFIG_SOC_SAMA5D2
+		.ulp1_clock = &clock_test_setting[6],
+		.ulp1_wakeup = PMC_FSMR_FSTT0,
+#endif
+		.resume = _tickless_resume,
+	};
+	struct _power_stats stats;
+	uint32_t deadline;
+	int i;
+
+	printf("\n\r\n\r");
+	printf("  =========== Tickless idle for 10 seconds ===========\n\r");
+
+	/* the RTC measures the time spent in ULP1 */
+	rtc_set_hour_mode(0);
+
+	timer_configure(0);
+	power_configure(&cfg);
+	power_start_measure();
+
+	deadline = timer_get_tick() + 10000;
+	while (power_idle(deadline) != POWER_STATE_RUN);
+
+	power_stop_measure();
+	power_get_stats(&stats);
+
+	/* back to the default state of the example: no PIT interrupt */
+	pit_disable_it();
+	aic_disable(ID_PIT);
+
+	printf("  Measured %u ms\n\r", (unsigned)(stats.duration / 1000));
+	for (i = 0; i < POWER_STATE_COUNT; i++)
+		printf("  %-5s %6u entries %6u ms\n\r",
+			power_get_state_name((enum _power_state)i),
+			(unsigned)stats.entries[i],
+			(unsigned)(stats.residency[i] / 1000));
+	printf("  Early wake-ups: %u\n\r", (unsigned)stats.early_wakeups);
+}
+
 static void menu_init_ddr(void)
 {
 #ifndef VARIANT_DDRAM
@@ -791,6 +845,12 @@ int main(void)
 			MenuChoice = 0;
 			_print_menu();
 			break;
+		case '5':
+			printf("5");
+			menu_tickless();
+			MenuChoice = 0;
+			_print_menu();
+			break;
 		case 'a':
 		case 'A':
 			printf("a");
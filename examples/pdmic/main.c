@@ -75,13 +75,25 @@
  * -# Connect the audio xplained board to the A5D2 board first;
  * -# Press one of the keys listed in the menu to perform the corresponding action;
  * -# Press key '1' or key '2' to record the sound for a short time
- * -# press key '3' to display the sound information
- * -# press key '4' to playback the sound using CLASSD
+ * -# press key '3' to playback the sound using CLASSD
+ * -# press key '4' to record raw PDM samples with SSC0 and convert them in
+ *    software with the pdm2pcm library (see below)
  * -# press key '+' or key '-' to increase or decrease the recorded sound gain
+ *
+ * \section Software decimation
+ *
+ * Option '4' bypasses the PDMIC: the SSC0 receiver outputs a continuous
+ * SAMPLE_RATE * PDM_OSR clock on RK0 (PB24) and shifts the microphone data
+ * in from RD0 (PB23), MSB first, sampled on the falling edge of RK0 (left
+ * channel of a PDM microphone). Wire the microphone clock and data lines to
+ * these pins. The raw stream is converted to 16-bit PCM by lib/dsp/pdm2pcm
+ * once the recording is done, and the conversion time is displayed.
+ *
  * \section References
  * - pdmic/main.c
  * - pdmic.h
  * - pdmic.c
+ * - pdm2pcm.h
  */
 
 /** \file
@@ -107,9 +119,13 @@
 #include "peripherals/pio.h"
 #include "peripherals/pmc.h"
 #include "peripherals/dma.h"
+#include "peripherals/ssc.h"
 
+#include "misc/cache.h"
 #include "misc/console.h"
 
+#include "dsp/pdm2pcm.h"
+
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -128,10 +144,19 @@
 
 #define INITIAL_ATTENUATION (10)
 
+/* software decimation: oversampling ratio and CIC order */
+#define PDM_OSR (64)
+#define PDM_ORDER (4)
+
+/* raw PDM bytes for SAMPLE_COUNT samples */
+#define PDM_SIZE (SAMPLE_COUNT * PDM_OSR / 8)
+
 static const struct _pin classd_pins[] = BOARD_CLASSD_PINS;
 
 static const struct _pin pdmic_pins[] = PINS_PDMIC_IOS1;
 
+static const struct _pin ssc_pins[] = PINS_SSC0_IOS1;
+
 static const struct {
 	int8_t gain;
 	uint16_t dgain;
@@ -165,6 +190,29 @@ static uint16_t _sound_buffer[SAMPLE_COUNT];
 
 static bool _sound_recorded = false;
 
+CACHE_ALIGNED_DDR static uint8_t _pdm_buffer[PDM_SIZE];
+
+static struct dma_channel *_ssc_dma_channel;
+
+/** SSC0 receiver, clocked from the divided clock at the PDM bit rate */
+static struct _ssc_desc ssc_desc = {
+	.addr = SSC0,
+	.bit_rate = SAMPLE_RATE * PDM_OSR,
+	.rx_auto_cfg = false,
+	.tx_auto_cfg = false,
+};
+
+/** Software PDM to PCM converter */
+static struct _pdm2pcm _pdm2pcm = {
+	.channels = 1,
+	.layout = PDM2PCM_LAYOUT_BYTES,
+	.lsb_first = false,
+	.order = PDM_ORDER,
+	.osr = PDM_OSR,
+	.bits = 16,
+	.gain = 256,
+};
+
 /** pdmic Configuration */
 static struct _pdmic_desc pdmic_desc = {
 	.sample_rate = SAMPLE_RATE,
@@ -211,6 +259,7 @@ static void _display_menu(void)
 	printf("1 -> Record the sound with DMA\n\r");
 	printf("2 -> Record the sound for polling\n\r");
 	printf("3 -> Playback the record sound using CLASSD \n\r");
+	printf("4 -> Record raw PDM with SSC0, convert with pdm2pcm\n\r");
 	printf("+ -> Increase the gain of record sound(increased 10dB)\n\r");
 	printf("- -> Decrease the gain of record sound(reduced 10dB)\n\r");
 	printf("=>");
@@ -320,6 +369,59 @@ static void _record_sound_polling(void)
 	_record_stop();
 }
 
+/**
+ * \brief Record raw PDM samples with the SSC0 receiver and DMA, then
+ * decimate them in software.
+ */
+static void _record_sound_with_ssc(void)
+{
+	struct dma_xfer_cfg cfg;
+	volatile bool done = false;
+	uint32_t frames, elapsed;
+
+	if (!_ssc_dma_channel) {
+		printf("SSC DMA channel not available\r\n");
+		return;
+	}
+
+	/* 8-bit words shifted in continuously, first PDM sample in the MSB */
+	ssc_configure(&ssc_desc);
+	ssc_configure_receiver(&ssc_desc,
+			SSC_RCMR_CKS_MCK | SSC_RCMR_CKO_CONTINUOUS |
+			SSC_RCMR_START_CONTINUOUS | SSC_RCMR_PERIOD(0),
+			SSC_RFMR_DATLEN(7) | SSC_RFMR_MSBF | SSC_RFMR_DATNB(0));
+
+	cfg.sa = (void *)&SSC0->SSC_RHR;
+	cfg.da = _pdm_buffer;
+	cfg.upd_sa_per_data = 0;
+	cfg.upd_da_per_data = 1;
+	cfg.data_width = DMA_DATA_WIDTH_BYTE;
+	cfg.chunk_size = DMA_CHUNK_SIZE_1;
+	cfg.blk_size = 0;
+	cfg.len = PDM_SIZE;
+	dma_configure_transfer(_ssc_dma_channel, &cfg);
+	dma_set_callback(_ssc_dma_channel, _pdmic_dma_callback, (void*)&done);
+
+	printf("<Raw PDM Record Start>\r\n");
+	_start_tick = timer_get_tick();
+	dma_start_transfer(_ssc_dma_channel);
+	ssc_enable_receiver(&ssc_desc);
+	while (!done);
+	ssc_disable_receiver(&ssc_desc);
+	elapsed = timer_get_interval(_start_tick, timer_get_tick());
+	printf("<Raw PDM Record Stop (%ums elapsed)>\r\n", (unsigned)elapsed);
+	cache_invalidate_region(_pdm_buffer, sizeof(_pdm_buffer));
+
+	_start_tick = timer_get_tick();
+	pdm2pcm_reset(&_pdm2pcm);
+	frames = pdm2pcm_process(&_pdm2pcm, _pdm_buffer, sizeof(_pdm_buffer),
+			_sound_buffer);
+	elapsed = timer_get_interval(_start_tick, timer_get_tick());
+	printf("%u samples converted in %ums\r\n", (unsigned)frames,
+			(unsigned)elapsed);
+	_sound_recorded = true;
+}
+
 /**
  * \brief Play wav format sound using CLASSD.
  */
@@ -376,6 +478,11 @@ int main(void)
 	else
 		printf("PDMIC configuration failed!\r\n");
 
+	pio_configure(ssc_pins, ARRAY_SIZE(ssc_pins));
+	_ssc_dma_channel = dma_allocate_channel(ID_SSC0, DMA_PERIPH_MEMORY);
+	if (!pdm2pcm_initialize(&_pdm2pcm))
+		printf("pdm2pcm configuration failed!\r\n");
+
 	while (1) {
 		_display_menu();
 		key = console_get_char();
@@ -387,6 +494,8 @@ int main(void)
 			_record_sound_polling();
 		else if (key == '3')
 			_playback_using_classd();
+		else if (key == '4')
+			_record_sound_with_ssc();
 		else if (key == '+') {
 			if (gain < 70) {
 				gain += 10;
@@ -53,6 +53,11 @@
  *  amplifier. At the same time, the audio stream received is also sent
  *  back to host from EK for recording.
  *
+ *  The USB host and the audio device run from different clocks. Instead of
+ *  retuning the codec clock, the stream goes through an asynchronous
+ *  sample-rate converter whose ratio is servoed on the amount of buffered
+ *  USB data, which also works for CLASSD.
+ *
  *  \section Usage
  *
  *  -# Build the program and download it inside the evaluation board. Please
@@ -121,6 +126,7 @@
 #include "main_descriptors.h"
 #include "../usb_common/main_usb_common.h"
 #include "audio/audio_device.h"
+#include "dsp/asrc.h"
 
 #include <stdio.h>
 #include <stdbool.h>
@@ -148,9 +154,20 @@
 /**  Size of one buffer in bytes. */
 #define BUFFER_SIZE   AUDDSpeakerDriver_BYTESPERFRAME
 
+/**  Size of one audio frame (one sample per channel) in bytes. */
+#define FRAME_SIZE    (AUDDSpeakerDriver_NUMCHANNELS * \
+                       AUDDSpeakerDriver_BYTESPERSAMPLE)
+
+/**  Number of audio frames in one buffer. */
+#define BUFFER_FRAMES (BUFFER_SIZE / FRAME_SIZE)
+
+/**  Number of audio frames in one block sent to the DAC (1 ms). */
+#define OUT_FRAMES    (AUDDSpeakerDriver_SAMPLERATE / 1000)
+
 /**  Delay (in number of buffers) before starting the DAC transmission
-     after data has been received. */
-#define DAC_DELAY     (2)
+     after data has been received. It is also the fill level the sample-rate
+     converter servo tracks. */
+#define DAC_DELAY     (4)
 
 /*----------------------------------------------------------------------------
  *         External variables
@@ -172,9 +189,19 @@ static uint32_t buffer_sizes[BUFFER_NUMBER];
 /**  Next buffer in which USB data can be stored. */
 static volatile uint32_t in_buffer_index = 0;
 
-/**  Next buffer which should be sent to the DAC. */
+/**  Next buffer which should be converted for the DAC. */
 static volatile uint32_t out_buffer_index = 0;
 
+/**  Number of bytes of the next buffer which have already been converted. */
+static uint32_t out_offset = 0;
+
+/**  Blocks sent to the DAC, one played while the other one is filled. */
+CACHE_ALIGNED static int16_t out_blocks[2][OUT_FRAMES *
+		AUDDSpeakerDriver_NUMCHANNELS];
+
+/**  Block being played. */
+static uint8_t out_block = 0;
+
 /**  Number of buffers that can be sent to the DAC. */
 static volatile uint32_t num_buffers_to_send = 0;
 
@@ -184,6 +211,21 @@ static volatile uint8_t  dac_delay;
 /**  Current state of the DAC transmission. */
 static volatile bool is_dac_active = false;
 
+/**  Whether the DAC DMA is running. */
+static volatile bool is_dac_playing = false;
+
+/**  Sample-rate converter between the USB stream and the DAC. */
+static struct _asrc asrc;
+
+/**  Servo keeping the amount of buffered USB data around DAC_DELAY. */
+static struct _asrc_servo asrc_servo = {
+	.target = DAC_DELAY * BUFFER_FRAMES,
+	.kp = 20000,        /* 20 ppm per frame of error */
+	.ki = 100,          /* 100 ppm/s per frame of error */
+	.limit = 1000000,   /* +/- 1000 ppm */
+	.smoothing = 6,     /* average over 64 ms */
+};
+
 /** audio playing volume */
 static uint8_t play_vol = AUDIO_PLAY_MAX_VOLUME/2;
 
@@ -191,6 +233,56 @@ static uint8_t play_vol = AUDIO_PLAY_MAX_VOLUME/2;
  *         Internal functions
  *----------------------------------------------------------------------------*/
 
+/**
+ *  \brief Convert received USB buffers into one DAC block, then update the
+ *  conversion ratio according to the amount of buffered data. The block is
+ *  padded with silence if the USB data runs out.
+ */
+static void fill_out_block(int16_t* out)
+{
+	const int16_t* in;
+	uint32_t produced = 0, consumed, fill;
+
+	while (produced < OUT_FRAMES && num_buffers_to_send > 0) {
+		in = (const int16_t*)&buffers[out_buffer_index][out_offset];
+		produced += asrc_process(&asrc, in,
+				(buffer_sizes[out_buffer_index] - out_offset)
+				/ FRAME_SIZE, &consumed,
+				&out[produced * AUDDSpeakerDriver_NUMCHANNELS],
+				OUT_FRAMES - produced);
+		out_offset += consumed * FRAME_SIZE;
+		if (out_offset + FRAME_SIZE > buffer_sizes[out_buffer_index]) {
+			out_buffer_index = (out_buffer_index + 1) % BUFFER_NUMBER;
+			num_buffers_to_send--;
+			out_offset = 0;
+		}
+	}
+	if (produced < OUT_FRAMES)
+		memset(&out[produced * AUDDSpeakerDriver_NUMCHANNELS], 0,
+				(OUT_FRAMES - produced) * FRAME_SIZE);
+
+	fill = num_buffers_to_send * BUFFER_FRAMES - out_offset / FRAME_SIZE;
+	asrc_set_correction(&asrc, asrc_servo_update(&asrc_servo, fill));
+}
+
+/**
+ *  \brief Start the DAC transmission once DAC_DELAY buffers are received.
+ */
+static void start_dac(void)
+{
+	asrc_reset(&asrc);
+	asrc_servo_reset(&asrc_servo, num_buffers_to_send * BUFFER_FRAMES);
+	out_offset = 0;
+	out_block = 0;
+	fill_out_block(out_blocks[0]);
+	fill_out_block(out_blocks[1]);
+
+	is_dac_playing = true;
+	audio_dma_transfer(&audio_device, out_blocks[0],
+			sizeof(out_blocks[0]), NULL);
+	audio_enable(&audio_device, true);
+}
+
 /**
  *  \brief DMA TX callback
  */
@@ -200,15 +292,16 @@ static void audio_play_finish_callback(struct dma_channel *channel, void* p_arg)
 
 	if (num_buffers_to_send == 0) {
 		/* End of transmission */
+		is_dac_playing = false;
 		is_dac_active = false;
 		return;
 	}
 
-	out_buffer_index = (out_buffer_index + 1) % BUFFER_NUMBER;
-	num_buffers_to_send--;
-	/* Load next buffer */
-	audio_dma_transfer(&audio_device, buffers[out_buffer_index],
-			buffer_sizes[out_buffer_index], NULL);
+	/* Play the block filled meanwhile, and fill the other one */
+	out_block ^= 1;
+	audio_dma_transfer(&audio_device, out_blocks[out_block],
+			sizeof(out_blocks[out_block]), NULL);
+	fill_out_block(out_blocks[out_block ^ 1]);
 }
 
 
@@ -239,14 +332,9 @@ static void frame_received(void* arg, uint8_t status, uint32_t transferred, uint
 		} else if (dac_delay > 0) {
 			/* Wait until a few buffers have been received */
 			dac_delay--;
-		} else if (audio_dma_transfer_is_done(&audio_device)) {
+		} else if (!is_dac_playing) {
 			/* Start DAC transmission if necessary */
-			audio_dma_transfer(&audio_device, buffers[out_buffer_index],
-					buffer_sizes[out_buffer_index], NULL);
-			audio_enable(&audio_device, true);
-			out_buffer_index = (out_buffer_index + 1) % BUFFER_NUMBER;
-			num_buffers_to_send--;
-
+			start_dac();
 		}
 	} else if (status == USBD_STATUS_ABORTED) {
 		/* Error , ABORT, add NULL buffer */
@@ -357,6 +445,8 @@ void audd_speaker_driver_stream_setting_changed(uint8_t new_setting)
 	if (new_setting) {
 		audio_dma_stop(&audio_device);
 		num_buffers_to_send = 0;
+		is_dac_playing = false;
+		is_dac_active = false;
 	}
 }
 
@@ -374,10 +464,6 @@ int main(void)
 	bool usb_conn = false;
 	bool audio_on = false;
 
-	uint32_t num = 0;
-	int32_t  num_diff = 0, prev_diff = 0;
-	int8_t   clock_adjust = 0;
-
 	console_set_rx_handler(console_handler);
 	console_enable_rx_interrupt();
 
@@ -390,6 +476,10 @@ int main(void)
 	/* Configure Audio */
 	audio_configure(&audio_device);
 
+	/* Convert from the USB sample rate to the audio device one */
+	asrc_initialize(&asrc, AUDDSpeakerDriver_NUMCHANNELS,
+			AUDDSpeakerDriver_SAMPLERATE, audio_device.sample_rate);
+
 	/* Configure audio play volume */
 	audio_play_set_volume(&audio_device, play_vol);
 
@@ -419,31 +509,6 @@ int main(void)
 				//printf("End ");
 				audio_on = false;
 			}
-			else {
-
-				if (num != num_buffers_to_send) {
-					num = num_buffers_to_send;
-                }
-				num_diff = num_buffers_to_send - DAC_DELAY;
-
-				if (prev_diff != num_diff) {
-					prev_diff = num_diff;
-					if (num_diff > 0 && clock_adjust != 1) {
-						/* USB too fast or SSC too slow: faster clock */
-						clock_adjust = 1;
-						audio_sync_adjust(&audio_device, clock_adjust);
-					}
-					if (num_diff < 0 && clock_adjust != -1) {
-						/* USB too slow or SSC too fast: slower clock */
-						clock_adjust = -1;
-						audio_sync_adjust(&audio_device, clock_adjust);
-					}
-					if (num_diff == 0 && clock_adjust != 0) {
-						clock_adjust = 0;
-						audio_sync_adjust(&audio_device, clock_adjust);
-					}
-				}
-			}
 		} else if(is_dac_active) {
 			//printf("Start ");
 			audio_on = true;
@@ -114,6 +114,7 @@
 
 #include "trace.h"
 #include "compiler.h"
+#include "hrtimer.h"
 
 #include "misc/cache.h"
 #include "misc/console.h"
@@ -129,6 +130,7 @@
 #include "peripherals/usart.h"
 
 #include "usb/device/cdc/cdcd_serial_driver.h"
+#include "usb/device/cdc/cdcd_serial_buffered.h"
 #include "usb/device/usbd.h"
 #include "usb/device/usbd_hal.h"
 
@@ -157,6 +159,16 @@
 /** write loop count */
 #define TEST_COUNT          (1)
 
+/** Sizes of the buffered mode TX and RX rings */
+#define CDC_TX_RING_SIZE    (4*1024)
+#define CDC_RX_RING_SIZE    (4*1024)
+
+/** Bulk OUT buffer, two halves of twice the high speed packet size */
+#define CDC_PACKET_SIZE     (4*CDCDSerialPort_BULK_MAXPACKETSIZE_HS)
+
+/** Delay before a partial packet is sent to the host, in microseconds */
+#define CDC_FLUSH_DELAY_US  (1000)
+
 /** define the peripherals and pins used for USART */
 #if defined(CONFIG_BOARD_SAMA5D2_XPLAINED)
 #define USART_ADDR USART3
@@ -199,8 +211,6 @@ static uint8_t is_cdc_serial_on = 0;
 /** CDC Echo back ON/OFF */
 static uint8_t is_cdc_echo_on = 0;
 
-/** USB Tx flag */
-static volatile uint8_t tx_done_flag = 0;
 /** Test buffer */
 CACHE_ALIGNED static uint8_t test_buffer[TEST_BUFFER_SIZE];
 
@@ -211,6 +221,20 @@ static struct _usart_desc usart_desc = {
 	.transfert_mode = USARTD_MODE_DMA,
 };
 
+static uint8_t cdc_tx_ring[CDC_TX_RING_SIZE];
+
+static uint8_t cdc_rx_ring[CDC_RX_RING_SIZE];
+
+CACHE_ALIGNED static uint8_t cdc_packet[CDC_PACKET_SIZE];
+
+/** CDC serial port in buffered mode */
+static struct _cdcd_serial_buffered cdc_serial = {
+	.tx = { .data = cdc_tx_ring, .size = sizeof(cdc_tx_ring) },
+	.rx = { .data = cdc_rx_ring, .size = sizeof(cdc_rx_ring) },
+	.packet = { .data = cdc_packet, .size = sizeof(cdc_packet) },
+	.flush_delay_us = CDC_FLUSH_DELAY_US,
+};
+
 static volatile bool usart_rx_flag = false;
 static volatile uint8_t char_recv;
 
@@ -292,40 +316,30 @@ static void _usart_dma_tx(const uint8_t* buffer, uint32_t len )
 }
 
 /**
- * Callback invoked when data has been received on the USB.
+ * Forwards the data received on the USB to the USART, and back to the
+ * host if echo is on.
  */
-static void _usb_data_received(void *read, uint8_t status,
-		uint32_t received, uint32_t remaining)
+static void _usb_to_usart(void)
 {
-	/* Check that data has been received successfully */
-	if (status == USBD_STATUS_SUCCESS) {
-		*(uint8_t *)read = 1;
-		/* Send back CDC data */
-		if (is_cdc_echo_on){
-
-			cdcd_serial_driver_write(usb_buffer, received, 0, 0);
-		}
-		/* Send data through USART */
-		if (is_cdc_serial_on) {
+	uint32_t received;
 
-			_usart_dma_tx( usb_buffer, received );
-		}
+	if (usartd_is_busy(&usart_desc))
+		return;
 
-		/* Check if bytes have been discarded */
-		if ((received == DATAPACKETSIZE) && (remaining > 0)) {
+	received = cdcd_serial_buffered_read(&cdc_serial, usb_buffer,
+			DATAPACKETSIZE);
+	if (!received)
+		return;
 
-			trace_warning(
-				"_usb_data_received: %u bytes discarded\n\r",
-					(unsigned int)remaining);
-		}
-	} else {
+	/* Send back CDC data */
+	if (is_cdc_echo_on)
+		cdcd_serial_buffered_write(&cdc_serial, usb_buffer, received);
 
-		trace_warning( "_usb_data_received: Transfer error\n\r");
-	}
+	/* Send data through USART */
+	if (is_cdc_serial_on)
+		_usart_dma_tx(usb_buffer, received);
 }
 
-
-
 /**
  * console help dump
  */
@@ -336,15 +350,6 @@ static void _debug_help(void)
 }
 
 
-/**
- * Callback invoked when data has been sent.
- */
-static void _usb_data_sent(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining)
-{
-	tx_done_flag = 1;
-}
-
-
 /**
  * Configure USART to work @ 115200
  */
@@ -365,6 +370,7 @@ static void _configure_usart(void)
  */
 static void _send_text(void)
 {
+	struct _cdcd_serial_buffered_stats stats;
 	uint32_t i, test_cnt;
 
 	if (!is_cdc_serial_on) {
@@ -379,16 +385,23 @@ static void _send_text(void)
 
 	printf("- Send 0,1,2 ... to host:\n\r");
 	for (test_cnt = 0; test_cnt < TEST_COUNT; test_cnt ++) {
-
-		tx_done_flag = 0;
-		cdcd_serial_driver_write(test_buffer, TEST_BUFFER_SIZE,
-				_usb_data_sent, NULL);
-		while(!tx_done_flag);
+		/* Wait for room in the TX ring */
+		for (i = 0; i < TEST_BUFFER_SIZE; ) {
+			if (usbd_get_state() < USBD_STATE_CONFIGURED)
+				return;
+			i += cdcd_serial_buffered_write(&cdc_serial,
+					&test_buffer[i], TEST_BUFFER_SIZE - i);
+		}
 	}
 
 	/* Finish sending */
-	cdcd_serial_driver_write(NULL, 0, NULL, NULL);
+	cdcd_serial_buffered_flush(&cdc_serial);
 	_usart_dma_tx(test_buffer, TEST_BUFFER_SIZE);
+
+	cdcd_serial_buffered_get_stats(&cdc_serial, &stats);
+	printf("- %u bytes in %u transfers, %u flushes, %u bridges\n\r",
+			(unsigned)stats.tx_bytes, (unsigned)stats.tx_transfers,
+			(unsigned)stats.tx_flushes, (unsigned)stats.tx_bridges);
 }
 
 /*----------------------------------------------------------------------------
@@ -403,7 +416,6 @@ static void _send_text(void)
 int main(void)
 {
 	uint8_t is_usb_connected = 0;
-	uint8_t usb_serial_read = 1;
 
 	/* Output example information */
 	console_example_info("USB Device CDC Serial Example");
@@ -414,8 +426,12 @@ int main(void)
 	/* Configure USART */
 	_configure_usart();
 
+	/* The flush timer of the buffered mode runs on the hrtimer */
+	hrtimer_configure(TC0, 0, TC_CMR_TCCLKS_TIMER_CLOCK2);
+
 	/* CDC serial driver initialization */
 	cdcd_serial_driver_initialize(&cdcd_serial_driver_descriptors);
+	cdc_serial.port = cdcd_serial_driver_get_port();
 
 	/* Help informaiton */
 	_debug_help();
@@ -432,10 +448,14 @@ int main(void)
 			if (is_usb_connected) {
 				is_usb_connected = 0;
 				is_cdc_serial_on  = 0;
+				cdcd_serial_buffered_stop(&cdc_serial);
 			}
 
 		} else if (is_usb_connected == 0) {
-				is_usb_connected = 1;
+			is_usb_connected = 1;
+			if (cdcd_serial_buffered_start(&cdc_serial)
+					!= USBD_STATUS_SUCCESS)
+				printf("-E- CDC buffered mode not started\n\r");
 		}
 
 		/* Serial port ON/OFF */
@@ -444,15 +464,11 @@ int main(void)
 			if (!is_cdc_serial_on) {
 				is_cdc_serial_on = 1;
 				}
-			if(usb_serial_read == 1) {
-				usb_serial_read = 0;
-				/* Start receiving data on the USB */
-				cdcd_serial_driver_read(usb_buffer, DATAPACKETSIZE,
-							_usb_data_received, &usb_serial_read);
-			}
+			_usb_to_usart();
 			if(usart_rx_flag == true) {
 				usart_rx_flag = false;
-				cdcd_serial_driver_write((void *)&char_recv, 1, 0, 0);
+				cdcd_serial_buffered_write(&cdc_serial,
+						(const void *)&char_recv, 1);
 				if(is_cdc_echo_on) {
 					_usart_dma_tx((uint8_t*)&char_recv, 1);
 				}
@@ -476,8 +492,8 @@ int main(void)
 
 			} else {
 				printf("Alive\n\r");
-				cdcd_serial_driver_write((char*)"Alive\n\r", 8,
-						NULL, NULL);
+				cdcd_serial_buffered_write(&cdc_serial,
+						"Alive\n\r", 8);
 				_usart_dma_tx((uint8_t*)"Alive\n\r", 8);
 				_debug_help();
 			}
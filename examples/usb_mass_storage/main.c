@@ -103,6 +103,7 @@
 #include "misc/console.h"
 #include "misc/cache.h"
 #include "peripherals/pmc.h"
+#include "event.h"
 
 #ifdef CONFIG_HAVE_SDMMC
 #  include "peripherals/sdmmc.h"
@@ -230,6 +231,9 @@ static uint32_t msd_write_total = 0;
 static uint8_t msd_refresh = 0;
 
 static uint8_t current_lun_num = 0;
+
+/** Posted by the MSD driver when its state machine may progress */
+static struct _event msd_event;
 /*-----------------------------------------------------------------------------
  *         Callback re-implementation
  *-----------------------------------------------------------------------------*/
@@ -443,6 +447,24 @@ static void _MemoriesInitialize(void)
 	sddisk_init();
 }
 
+/**
+ * Run the Mass storage state machine, called by the event loop
+ */
+static void _msd_event_handler(void* arg)
+{
+	/* Run again until the driver waits for a transfer or a request */
+	if (msd_driver_state_machine())
+		event_post(&msd_event);
+
+	if (msd_refresh) {
+		msd_refresh = 0;
+		if (msd_write_total < 50 * 1000) {
+			/* Flush Disk Media */
+		}
+		msd_write_total = 0;
+	}
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -468,21 +490,14 @@ int main(void)
 	/* BOT driver initialization */
 	msd_driver_initialize(&msd_driver_descriptors, luns, current_lun_num);
 
+	/* Run the state machine only when the driver signals progress */
+	event_init(&msd_event, _msd_event_handler, NULL);
+	msd_driver_set_event(&msd_event);
+
 	/* connect if needed */
 	usb_vbus_configure();
 
-	while (1) {
-		/* Mass storage state machine */
-		if (usbd_get_state() >= USBD_STATE_CONFIGURED) {
-			msd_driver_state_machine();
-			if (msd_refresh) {
-				msd_refresh = 0;
-				if (msd_write_total < 50 * 1000) {
-					/* Flush Disk Media */
-				}
-				msd_write_total = 0;
-			}
-		}
-	}
+	event_loop();
+	return 0;
 }
 /** \endcond */
@@ -52,6 +52,12 @@
  * provides image capture in various formats.
  * Data stream Pipe line: ISC PFE->RLP(DAT8)->DAM8->USB YUV2 display
  *
+ * The camera also offers a Motion-JPEG format (QVGA and VGA). When the host
+ * selects it, the ISC captures into separate buffers and each frame is
+ * encoded in software with the MJPEG library before being streamed.
+ * While Motion-JPEG frames are streamed, the frames can also be recorded
+ * to an AVI file on the SD card.
+ *
  * \section Usage
  *
  * -# On the computer, open and configure a terminal application
@@ -76,6 +82,8 @@
  *    it to preview with default resolution - QVGA.
  * -# Other video camera programs can also be used to monitor the capture
  *    output. The demo is tested on windows XP through "AmCap.exe".
+ * -# While the Motion-JPEG format is streamed, press 'r' to start recording
+ *    to video.avi on the SD card, and 'r' again to stop.
  *
  * \section References
  * - usb_uvc_isc/main.c
@@ -118,10 +126,17 @@
 #include "peripherals/pio.h"
 #include "peripherals/pit.h"
 #include "peripherals/pmc.h"
+#include "peripherals/sdmmc.h"
 #include "peripherals/twid.h"
 
 #include "video/image_sensor_inf.h"
 
+#include "libsdmmc/libsdmmc.h"
+#include "fatfs/src/ff.h"
+
+#include "mjpeg/avi_writer.h"
+#include "mjpeg/jpeg_encoder.h"
+
 #include "usb/common/uvc/usb_video.h"
 #include "usb/common/uvc/uvc_descriptors.h"
 #include "usb/device/usbd_driver.h"
@@ -132,6 +147,8 @@
 
 #include "../usb_common/main_usb_common.h"
 
+#include <assert.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -145,6 +162,27 @@
 
 #define NUM_FRAME_BUFFER     4
 
+/** JPEG quality factor of the Motion-JPEG format */
+#define JPEG_QUALITY         75
+
+/** Room kept at the end of a frame buffer to align the JPEG frame size */
+#define JPEG_ALIGN_MARGIN    (FRAME_PACKET_SIZE_HS * ISO_HIGH_BW_MODE)
+
+/** Timer/Counter for the SD/MMC driver */
+#define SD_TIMER_MODULE      ID_TC0
+#define SD_TIMER_CHANNEL     0
+
+/** Removable card slot */
+#define SD_HOST_ID           ID_SDMMC1
+#define SD_HOST_REGS         SDMMC1
+
+/** The card is the FatFs drive 0 */
+#define AVI_DRIVE            "0:"
+#define AVI_FILE_PATH        AVI_DRIVE "video.avi"
+
+/** Recordings are cut when the index is full, 10 minutes at 15 fps */
+#define AVI_MAX_FRAMES       (15 * 60 * 10)
+
 /*----------------------------------------------------------------------------
  *          External variables
  *----------------------------------------------------------------------------*/
@@ -199,6 +237,52 @@ static const sensor_profile_t *sensor_profiles[6] = {
 CACHE_ALIGNED_DDR
 static uint8_t stream_buffers[FRAME_BUFFER_SIZEC(640, 480) * NUM_FRAME_BUFFER];
 
+/** Capture buffers, used when the frames are encoded to Motion-JPEG */
+CACHE_ALIGNED_DDR
+static uint8_t capture_buffers[FRAME_BUFFER_SIZEC(640, 480) * NUM_FRAME_BUFFER];
+
+/** True when the host selected the Motion-JPEG format */
+static bool mjpeg = false;
+
+/** Set by the ISC handler when a new frame has been captured */
+static volatile bool frame_captured = false;
+
+static struct _jpeg_encoder jpeg_encoder;
+
+/** Size of the JPEG frame in each video buffer */
+static volatile uint32_t jpeg_sizes[NUM_FRAME_BUFFER];
+
+/** Video buffer the next JPEG frame is written to */
+static uint32_t jpeg_idx;
+
+/** Encoding statistics */
+static uint32_t jpeg_frames, jpeg_ticks, jpeg_bytes, jpeg_stats_tick;
+
+/** SD/MMC driver instance and DMA descriptor table */
+static struct sdmmc_set sd_drv;
+CACHE_ALIGNED_DDR static uint32_t sd_dma_table[4 * SDMMC_DMADL_SIZE];
+
+/** SDCard library instance */
+CACHE_ALIGNED_DDR static sSdCard sd_lib;
+
+/** File system object. With _FS_TINY, the file data that is not written
+ * straight from the JPEG frames goes through FATFS::win[], which the card
+ * DMA requires to be aligned on data cache lines. */
+struct padded_fatfs {
+	uint8_t padding[L1_CACHE_BYTES - offsetof(FATFS, win) % L1_CACHE_BYTES];
+	FATFS fs;
+};
+CACHE_ALIGNED_DDR static struct padded_fatfs fs_header;
+
+static struct _avi_writer avi;
+
+static struct _avi_index_entry avi_index[AVI_MAX_FRAMES];
+
+/** True while the Motion-JPEG frames are recorded to the SD card */
+static bool recording = false;
+
+static uint32_t record_start_tick;
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -221,12 +305,13 @@ static void configure_twi(void)
  */
 static void configure_dma_linklist(void)
 {
+	uint8_t* buffers = mjpeg ? capture_buffers : stream_buffers;
 	uint8_t i;
 
 	for(i = 0; i < NUM_FRAME_BUFFER; i++) {
 		isc_dma_desc[i].ctrl = ISC_DCTRL_DVIEW_PACKED | ISC_DCTRL_DE;
 		isc_dma_desc[i].next_desc = (uint32_t)&isc_dma_desc[i + 1];
-		isc_dma_desc[i].addr = (uint32_t)stream_buffers + i * FRAME_BUFFER_SIZEC(image_width, image_height);
+		isc_dma_desc[i].addr = (uint32_t)buffers + i * FRAME_BUFFER_SIZEC(image_width, image_height);
 		isc_dma_desc[i].stride = 0;
 	}
 	isc_dma_desc[i - 1].next_desc = (uint32_t)&isc_dma_desc[0];
@@ -247,7 +332,10 @@ static void isc_handler(void)
 			printf("CapS\r\n");
 		}
 		frame_idx = (frame_idx == (NUM_FRAME_BUFFER - 1)) ? 0 : (frame_idx + 1);
-		uvc_function_update_frame_idx(frame_idx);
+		if (mjpeg)
+			frame_captured = true;
+		else
+			uvc_function_update_frame_idx(frame_idx);
 	}
 }
 
@@ -285,7 +373,7 @@ static void configure_isc(void)
 	isc_dma_configure_input_mode(ISC_DCFG_IMODE_PACKED8);
 	isc_dma_configure_desc_entry((uint32_t)&isc_dma_desc);
 	isc_dma_enable(ISC_DCTRL_DVIEW_PACKED | ISC_DCTRL_DE);
-	isc_dma_adderss(0, (uint32_t)stream_buffers, 0);
+	isc_dma_adderss(0, (uint32_t)(mjpeg ? capture_buffers : stream_buffers), 0);
 
 	isc_update_profile();
 	aic_set_source_vector(ID_ISC, isc_handler);
@@ -317,6 +405,142 @@ static void start_preview(void)
 	configure_isc();
 }
 
+/**
+ * \brief Configure the SD/MMC host and its clocks.
+ */
+static void sd_initialize(void)
+{
+	pmc_enable_peripheral(SD_TIMER_MODULE);
+	pmc_enable_peripheral(SD_HOST_ID);
+	/* SD High Speed mode @ 50 MHz from PLLA */
+	pmc_configure_gck(SD_HOST_ID, PMC_PCR_GCKCSS_PLLA_CLK, 1 - 1);
+	pmc_enable_gck(SD_HOST_ID);
+	if (!board_cfg_sdmmc(SD_HOST_ID))
+		trace_error("Failed to cfg cells\n\r");
+
+	sdmmc_initialize(&sd_drv, SD_HOST_REGS, SD_HOST_ID,
+			 SD_TIMER_MODULE, SD_TIMER_CHANNEL,
+			 sd_dma_table, ARRAY_SIZE(sd_dma_table));
+	SDD_InitializeSdmmcMode(&sd_lib, &sd_drv, 0);
+}
+
+static bool sd_mount(void)
+{
+	FRESULT res;
+
+	if (SD_GetStatus(&sd_lib) == SDMMC_NOT_SUPPORTED) {
+		printf("-E- SD card not detected\r\n");
+		return false;
+	}
+	memset(&fs_header.fs, 0, sizeof(FATFS));
+	res = f_mount(&fs_header.fs, AVI_DRIVE, 1);
+	if (res != FR_OK) {
+		printf("-E- Failed to mount FAT file system, error %d\r\n", res);
+		return false;
+	}
+	return true;
+}
+
+static void sd_unmount(void)
+{
+	f_mount(NULL, AVI_DRIVE, 0);
+	SD_DeInit(&sd_lib);
+}
+
+/**
+ * \brief Open the AVI file, the Motion-JPEG frames are then appended by
+ * encode_frame().
+ */
+static void start_recording(void)
+{
+	FRESULT res;
+
+	if (!sd_mount())
+		return;
+	res = avi_writer_open(&avi, AVI_FILE_PATH, image_width, image_height,
+			15, avi_index, ARRAY_SIZE(avi_index));
+	if (res != FR_OK) {
+		printf("-E- Cannot create " AVI_FILE_PATH ", error %d\r\n", res);
+		sd_unmount();
+		return;
+	}
+	recording = true;
+	record_start_tick = timer_get_tick();
+	printf("-I- Recording to " AVI_FILE_PATH "\r\n");
+}
+
+static void stop_recording(void)
+{
+	uint32_t ms = timer_get_interval(record_start_tick, timer_get_tick());
+	FRESULT res;
+
+	recording = false;
+	/* the headers are rewritten on close, with the measured frame rate */
+	if (ms)
+		avi.fps = (avi.frames * 1000 + ms / 2) / ms;
+	if (!avi.fps)
+		avi.fps = 1;
+	res = avi_writer_close(&avi);
+	if (res != FR_OK)
+		printf("-E- Cannot close " AVI_FILE_PATH ", error %d\r\n", res);
+	else
+		printf("-I- Recorded %u frames, %u fps\r\n",
+				(unsigned)avi.frames, (unsigned)avi.fps);
+	sd_unmount();
+}
+
+/**
+ * \brief Encode the last captured frame into the next video buffer.
+ */
+static void encode_frame(void)
+{
+	uint32_t size = FRAME_BUFFER_SIZEC(image_width, image_height);
+	uint32_t src_idx = (frame_idx == 0) ? (NUM_FRAME_BUFFER - 1) : (frame_idx - 1);
+	const uint8_t* src = capture_buffers + src_idx * size;
+	uint8_t* dst = stream_buffers + jpeg_idx * size;
+	uint32_t start = timer_get_tick();
+	uint32_t len, aligned;
+
+	cache_invalidate_region((void*)src, size);
+	len = jpeg_encode_frame(&jpeg_encoder, src, image_width * 2, dst,
+			size - JPEG_ALIGN_MARGIN);
+	if (!len)
+		return;
+
+	/* record the frame before the padding moves its EOI marker */
+	if (recording) {
+		if (avi.frames >= ARRAY_SIZE(avi_index)
+		    || avi_writer_add_frame(&avi, dst, len) != FR_OK)
+			stop_recording();
+	}
+
+	/* pad with fill bytes before the EOI marker (ITU T.81 B.1.1.2) */
+	aligned = uvc_function_align_frame_size(len);
+	if (aligned > len) {
+		memset(&dst[len - 2], 0xFF, aligned - len + 1);
+		dst[aligned - 1] = 0xD9;
+	}
+	cache_clean_region(dst, aligned);
+
+	/* publish the frame: the UVC function streams the buffer before the
+	 * current index */
+	jpeg_sizes[jpeg_idx] = aligned;
+	jpeg_idx = (jpeg_idx == (NUM_FRAME_BUFFER - 1)) ? 0 : (jpeg_idx + 1);
+	uvc_function_update_frame_idx(jpeg_idx);
+
+	jpeg_frames++;
+	jpeg_bytes += len;
+	jpeg_ticks += timer_get_interval(start, timer_get_tick());
+	if (timer_get_interval(jpeg_stats_tick, timer_get_tick()) >= 5000) {
+		printf("-I- MJPEG: %u frames, %u ms/frame, %u bytes/frame\r\n",
+				(unsigned)jpeg_frames,
+				(unsigned)(jpeg_ticks / jpeg_frames),
+				(unsigned)(jpeg_bytes / jpeg_frames));
+		jpeg_frames = jpeg_ticks = jpeg_bytes = 0;
+		jpeg_stats_tick = timer_get_tick();
+	}
+}
+
 
 /**
  *  Invoked whenever a SETUP request is received from the host. Forwards the
@@ -342,6 +566,19 @@ void usbd_driver_callbacks_interface_setting_changed(uint8_t interface, uint8_t
  *        Global functions
  *----------------------------------------------------------------------------*/
 
+/* Refer to sdmmc_ff.c */
+bool SD_GetInstance(uint8_t index, sSdCard **holder);
+
+bool SD_GetInstance(uint8_t index, sSdCard **holder)
+{
+	assert(holder);
+
+	if (index != 0)
+		return false;
+	*holder = &sd_lib;
+	return true;
+}
+
 /**
  * \brief Application entry point for ISI USB video example.
  *
@@ -359,6 +596,9 @@ extern int main( void )
 	/* TWI Initialize */
 	configure_twi();
 
+	/* SD card, for the Motion-JPEG recordings */
+	sd_initialize();
+
 	printf("Image Sensor Selection:\n\r");
 	for (i = 0; i < ARRAY_SIZE(sensor_profiles); i++)
 		printf("- '%d' %s\n\r", i + 1, sensor_profiles[i]->name);
@@ -389,12 +629,29 @@ extern int main( void )
 		if (is_usb_vid_on) {
 			if (!uvc_function_is_video_on()) {
 				is_usb_vid_on = false;
+				if (recording)
+					stop_recording();
 				isc_stop_capture();
 				isc_disable_interrupt(-1);
+				uvc_function_set_frame_sizes(NULL);
 				capture_started = false;
 				printf("CapE\r\n");
 				printf("vidE\r\n");
 				frame_idx = 0;
+			} else if (mjpeg) {
+				if (console_is_rx_ready()) {
+					key = console_get_char();
+					if (key == 'r' || key == 'R') {
+						if (recording)
+							stop_recording();
+						else
+							start_recording();
+					}
+				}
+				if (frame_captured) {
+					frame_captured = false;
+					encode_frame();
+				}
 			}
 		} else {
 			if (uvc_function_is_video_on()) {
@@ -409,9 +666,23 @@ extern int main( void )
 					printf ("-I- Only support VGA and QVGA format\r\n");
 					image_resolution = QVGA;
 				}
+				mjpeg = uvc_function_get_format_index() == VIDCAMD_FormatIndexMJPEG;
 				memset(stream_buffers, 0, sizeof(stream_buffers));
 				cache_clean_region(stream_buffers, sizeof(stream_buffers));
 				start_preview();
+				if (mjpeg) {
+					jpeg_encoder_init(&jpeg_encoder, image_width,
+							image_height, JPEG_INPUT_YUYV, JPEG_QUALITY);
+					memset((void*)jpeg_sizes, 0, sizeof(jpeg_sizes));
+					jpeg_idx = 0;
+					jpeg_frames = jpeg_ticks = jpeg_bytes = 0;
+					jpeg_stats_tick = timer_get_tick();
+					frame_captured = false;
+					uvc_function_update_frame_idx(jpeg_idx);
+					uvc_function_set_frame_sizes(jpeg_sizes);
+					printf("-I- Motion-JPEG format, press 'r' to "
+							"start/stop recording\r\n");
+				}
 				uvc_function_payload_sent(NULL, USBD_STATUS_SUCCESS, 0, 0);
 				printf("vidS\r\n");
 			}
@@ -46,6 +46,10 @@
  * For the limitation of external memory size, this example only support for
  * VGA/QVGA format.
  *
+ * The camera also offers a Motion-JPEG format (QVGA and VGA). When the host
+ * selects it, the ISI captures into separate buffers and each frame is
+ * encoded in software with the MJPEG library before being streamed.
+ *
  * \section Usage
  *
  -# Build the program and download it inside the SAMA5D4 EK board.
@@ -115,6 +119,8 @@
 
 #include "video/image_sensor_inf.h"
 
+#include "mjpeg/jpeg_encoder.h"
+
 #include "usb/common/uvc/usb_video.h"
 #include "usb/common/uvc/uvc_descriptors.h"
 #include "usb/device/usbd_driver.h"
@@ -138,6 +144,12 @@
 
 #define NUM_FRAME_BUFFER     4
 
+/** JPEG quality factor of the Motion-JPEG format */
+#define JPEG_QUALITY         75
+
+/** Room kept at the end of a frame buffer to align the JPEG frame size */
+#define JPEG_ALIGN_MARGIN    (FRAME_PACKET_SIZE_HS * ISO_HIGH_BW_MODE)
+
 /*----------------------------------------------------------------------------
  *          External variables
  *----------------------------------------------------------------------------*/
@@ -189,6 +201,27 @@ static const sensor_profile_t *sensor_profiles[6] = {
 CACHE_ALIGNED_DDR
 static uint8_t stream_buffers[FRAME_BUFFER_SIZEC(640, 480) * NUM_FRAME_BUFFER];
 
+/** Capture buffers, used when the frames are encoded to Motion-JPEG */
+CACHE_ALIGNED_DDR
+static uint8_t capture_buffers[FRAME_BUFFER_SIZEC(640, 480) * NUM_FRAME_BUFFER];
+
+/** True when the host selected the Motion-JPEG format */
+static bool mjpeg = false;
+
+/** Set by the ISI handler when a new frame has been captured */
+static volatile bool frame_captured = false;
+
+static struct _jpeg_encoder jpeg_encoder;
+
+/** Size of the JPEG frame in each video buffer */
+static volatile uint32_t jpeg_sizes[NUM_FRAME_BUFFER];
+
+/** Video buffer the next JPEG frame is written to */
+static uint32_t jpeg_idx;
+
+/** Encoding statistics */
+static uint32_t jpeg_frames, jpeg_ticks, jpeg_bytes, jpeg_stats_tick;
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -202,7 +235,10 @@ static void isi_handler(void)
 
 	if ((status & ISI_SR_PXFR_DONE) == ISI_SR_PXFR_DONE) {
 		frame_idx = (frame_idx == (NUM_FRAME_BUFFER - 1)) ? 0 : (frame_idx + 1);
-		uvc_function_update_frame_idx(frame_idx);
+		if (mjpeg)
+			frame_captured = true;
+		else
+			uvc_function_update_frame_idx(frame_idx);
 	}
 }
 
@@ -224,10 +260,11 @@ static void configure_twi(void)
  */
 static void configure_dma_linklist(void)
 {
+	uint8_t* buffers = mjpeg ? capture_buffers : stream_buffers;
 	uint8_t i;
 
 	for(i = 0; i < NUM_FRAME_BUFFER; i++) {
-		dma_desc[i].address = (uint32_t)stream_buffers + i * FRAME_BUFFER_SIZEC(image_width, image_height);
+		dma_desc[i].address = (uint32_t)buffers + i * FRAME_BUFFER_SIZEC(image_width, image_height);
 		dma_desc[i].control = ISI_DMA_P_CTRL_P_FETCH | ISI_DMA_P_CTRL_P_WB;
 		dma_desc[i].next = (uint32_t)&dma_desc[i + 1];
 	}
@@ -256,7 +293,8 @@ static void configure_isi(void)
 	isi_ycrcb_format(ISI_CFG2_YCC_SWAP_MODE3);
 	/* Configure DMA for preview path. */
 	isi_set_dma_preview_path((uint32_t)&dma_desc,
-			ISI_DMA_P_CTRL_P_FETCH, (uint32_t)stream_buffers);
+			ISI_DMA_P_CTRL_P_FETCH,
+			(uint32_t)(mjpeg ? capture_buffers : stream_buffers));
 	isi_reset();
 	isi_disable_interrupt(-1);
 	aic_set_source_vector(ID_ISI, isi_handler);
@@ -289,6 +327,51 @@ static void start_preview(void)
 	aic_enable(ID_ISI);
 }
 
+/**
+ * \brief Encode the last captured frame into the next video buffer.
+ */
+static void encode_frame(void)
+{
+	uint32_t size = FRAME_BUFFER_SIZEC(image_width, image_height);
+	uint32_t src_idx = (frame_idx == 0) ? (NUM_FRAME_BUFFER - 1) : (frame_idx - 1);
+	const uint8_t* src = capture_buffers + src_idx * size;
+	uint8_t* dst = stream_buffers + jpeg_idx * size;
+	uint32_t start = timer_get_tick();
+	uint32_t len, aligned;
+
+	cache_invalidate_region((void*)src, size);
+	len = jpeg_encode_frame(&jpeg_encoder, src, image_width * 2, dst,
+			size - JPEG_ALIGN_MARGIN);
+	if (!len)
+		return;
+
+	/* pad with fill bytes before the EOI marker (ITU T.81 B.1.1.2) */
+	aligned = uvc_function_align_frame_size(len);
+	if (aligned > len) {
+		memset(&dst[len - 2], 0xFF, aligned - len + 1);
+		dst[aligned - 1] = 0xD9;
+	}
+	cache_clean_region(dst, aligned);
+
+	/* publish the frame: the UVC function streams the buffer before the
+	 * current index */
+	jpeg_sizes[jpeg_idx] = aligned;
+	jpeg_idx = (jpeg_idx == (NUM_FRAME_BUFFER - 1)) ? 0 : (jpeg_idx + 1);
+	uvc_function_update_frame_idx(jpeg_idx);
+
+	jpeg_frames++;
+	jpeg_bytes += len;
+	jpeg_ticks += timer_get_interval(start, timer_get_tick());
+	if (timer_get_interval(jpeg_stats_tick, timer_get_tick()) >= 5000) {
+		printf("-I- MJPEG: %u frames, %u ms/frame, %u bytes/frame\r\n",
+				(unsigned)jpeg_frames,
+				(unsigned)(jpeg_ticks / jpeg_frames),
+				(unsigned)(jpeg_bytes / jpeg_frames));
+		jpeg_frames = jpeg_ticks = jpeg_bytes = 0;
+		jpeg_stats_tick = timer_get_tick();
+	}
+}
+
 /**
  *  Invoked whenever a SETUP request is received from the host. Forwards the
  *  request to the standard handler.
@@ -361,9 +444,13 @@ extern int main( void )
 				isi_disable_interrupt(ISI_IDR_PXFR_DONE);
 				isi_dma_preview_channel_enabled(0);
 				isi_disable();
+				uvc_function_set_frame_sizes(NULL);
 				frame_idx = 0;
 				printf("CapE\r\n");
 				printf("vidE\r\n");
+			} else if (mjpeg && frame_captured) {
+				frame_captured = false;
+				encode_frame();
 			}
 		} else {
 			if (uvc_function_is_video_on()) {
@@ -378,10 +465,23 @@ extern int main( void )
 					printf ("-I- Only support VGA and QVGA format\r\n");
 					image_resolution = QVGA;
 				}
-					/* clear video buffer */
+				mjpeg = uvc_function_get_format_index() == VIDCAMD_FormatIndexMJPEG;
+				/* clear video buffer */
 				memset(stream_buffers, 0, sizeof(stream_buffers));
 				cache_clean_region(stream_buffers, sizeof(stream_buffers));
 				start_preview();
+				if (mjpeg) {
+					jpeg_encoder_init(&jpeg_encoder, image_width,
+							image_height, JPEG_INPUT_YUYV, JPEG_QUALITY);
+					memset((void*)jpeg_sizes, 0, sizeof(jpeg_sizes));
+					jpeg_idx = 0;
+					jpeg_frames = jpeg_ticks = jpeg_bytes = 0;
+					jpeg_stats_tick = timer_get_tick();
+					frame_captured = false;
+					uvc_function_update_frame_idx(jpeg_idx);
+					uvc_function_set_frame_sizes(jpeg_sizes);
+					printf("-I- Motion-JPEG format\r\n");
+				}
 				uvc_function_payload_sent(NULL, USBD_STATUS_SUCCESS, 0, 0);
 				printf("vidS\r\n");
 			}
@@ -86,13 +86,13 @@ static const USBDeviceQualifierDescriptor qualifierDescriptor = {
 
 /**  Configuration descriptors. */
 
-const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsFS =
+const struct UsbVideoCamMJPEGConfigurationDescriptors configurationDescriptorsFS =
 {
 	/* Configuration descriptor */
 	{
 		sizeof(USBConfigurationDescriptor),
 		USBGenericDescriptor_CONFIGURATION,
-		sizeof(struct UsbVideoCamConfigurationDescriptors),
+		sizeof(struct UsbVideoCamMJPEGConfigurationDescriptors),
 		2, /* 2 interface in this configuration */
 		1, /* This is configuration #1 */
 		0, /* No string descriptor for this configuration */
@@ -178,19 +178,20 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsFS =
 	{
 		/* VS Input Header */
 		{
-			sizeof(UsbVideoInputHeaderDescriptor1),
+			sizeof(UsbVideoInputHeaderDescriptor2),
 			VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
 			VIDStreamingInterfaceDescriptor_INPUTHEADER, /* VS_INPUT_HEADER */
-			1, /* Only 1 payload format */
-			sizeof(UsbVideoStreamingInterfaceDescriptor),
+			2, /* Uncompressed and Motion-JPEG payload formats */
+			sizeof(UsbVideoStreamingInterfaceDescriptor2),
 			0x80 | VIDCAMD_IsoInEndpointNum, /* Endpoint address is 0x82 */
 			0x00, /* Dynamic Format Change not supported */
 			2, /* Terminal Link to #2 */
 			0, /* Still Capture not supported */
 			0, /* Trigger not supported */
 			0, /* No trigger usage */
-			1, /* 1 bmaControls */
-			0  /* No bmaControls */
+			1, /* 1 byte per bmaControls */
+			0, /* No bmaControls for format #1 */
+			0  /* No bmaControls for format #2 */
 		},
 		/* VS Format Uncompressed */
 		{
@@ -200,7 +201,7 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsFS =
 				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
 				VIDStreamingInterfaceDescriptor_FMT_UNCOMPRESSED,
 				/* VS_FORMAT_UNCOMPRESSED */
-				1, /* Format index #1 */
+				VIDCAMD_FormatIndexUncompressed, /* Format index #1 */
 				VIDCAMD_NumFrameTypes, /* 3 frame types */
 				guidYUY2, /* guid YUY2 32595559-0000-0010-8000-00AA00389B71 */
 				FRAME_BPP, /* 16 bits per pixel */
@@ -278,6 +279,73 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsFS =
 				1, /* BT.709 */
 				4, /* BT.601 */
 			}
+		},
+		/* VS Format Motion-JPEG */
+		{
+			/* Payload Motion-JPEG format */
+			{
+				sizeof(USBVideoMJPEGFormatDescriptor),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FMT_MJPEG,
+				/* VS_FORMAT_MJPEG */
+				VIDCAMD_FormatIndexMJPEG, /* Format index #2 */
+				VIDCAMD_NumMJPEGFrameTypes, /* 2 frame types */
+				0, /* Variable size samples */
+				1, /* Default frame index: #1 */
+				0, /* bAspectRatioX */
+				0, /* bAspectRatioY */
+				0, /* No interlace */
+				0  /* No copy protect restrictions */
+			},
+			/* Frame format 320x240 */
+			{
+				sizeof(USBVideoMJPEGFrameDescriptor1),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FRM_MJPEG,
+				/* VS_FRAME_MJPEG */
+				1, /* Frame index #1 */
+				0, /* Still image not supported */
+				VIDCAMD_FW_1, /* wWidth */
+				VIDCAMD_FH_1, /* wHeight */
+				FRAME_BITRATEC(VIDCAMD_FW_1, VIDCAMD_FH_1, 15) / 16, /* Min bitrate */
+				FRAME_BITRATEC(VIDCAMD_FW_1, VIDCAMD_FH_1, 15) / 4, /* Max bitrate */
+				FRAME_BUFFER_SIZEC(VIDCAMD_FW_1, VIDCAMD_FH_1),
+				/* maxFrameBufferSize: a JPEG frame fits in a YUY2 frame buffer */
+				FRAME_INTERVALC(15), /* Default interval: 15F/s */
+				1, /* 1 Interval setting */
+				{
+					FRAME_INTERVALC(15), /* 15F/s, software encoded */
+				},
+			},
+			/* Frame format 640x480 */
+			{
+				sizeof(USBVideoMJPEGFrameDescriptor1),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FRM_MJPEG,
+				/* VS_FRAME_MJPEG */
+				2, /* Frame index #2 */
+				0, /* Still image not supported */
+				VIDCAMD_FW_2, /* wWidth */
+				VIDCAMD_FH_2, /* wHeight */
+				FRAME_BITRATEC(VIDCAMD_FW_2, VIDCAMD_FH_2, 5) / 16, /* Min bitrate */
+				FRAME_BITRATEC(VIDCAMD_FW_2, VIDCAMD_FH_2, 5) / 4, /* Max bitrate */
+				FRAME_BUFFER_SIZEC(VIDCAMD_FW_2, VIDCAMD_FH_2),
+				/* maxFrameBufferSize: a JPEG frame fits in a YUY2 frame buffer */
+				FRAME_INTERVALC(5), /* Default interval: 5F/s */
+				1, /* 1 Interval setting */
+				{
+					FRAME_INTERVALC(5), /* 5F/s, software encoded */
+				},
+			},
+			/* Color format Motion-JPEG */
+			{
+				sizeof(USBVideoColorMatchingDescriptor),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_COLORFORMAT, /* VS_COLORFORMAT */
+				1, /* BT.709, sRGB */
+				1, /* BT.709 */
+				4, /* BT.601 */
+			}
 		}
 	},
 	/* VS Interface Descriptor: 400K */
@@ -305,13 +373,13 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsFS =
 };
 
 /**  Configuration descriptors. */
-const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsHS =
+const struct UsbVideoCamMJPEGConfigurationDescriptors configurationDescriptorsHS =
 {
 	/* Configuration descriptor */
 	{
 		sizeof(USBConfigurationDescriptor),
 		USBGenericDescriptor_CONFIGURATION,
-		sizeof(struct UsbVideoCamConfigurationDescriptors),
+		sizeof(struct UsbVideoCamMJPEGConfigurationDescriptors),
 		2, /* 2 interface in this configuration */
 		1, /* This is configuration #1 */
 		0, /* No string descriptor for this configuration */
@@ -397,19 +465,20 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsHS =
 	{
 		/* VS Input Header */
 		{
-			sizeof(UsbVideoInputHeaderDescriptor1),
+			sizeof(UsbVideoInputHeaderDescriptor2),
 			VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
 			VIDStreamingInterfaceDescriptor_INPUTHEADER, /* VS_INPUT_HEADER */
-			1, /* Only 1 payload format */
-			sizeof(UsbVideoStreamingInterfaceDescriptor),
+			2, /* Uncompressed and Motion-JPEG payload formats */
+			sizeof(UsbVideoStreamingInterfaceDescriptor2),
 			0x80 | VIDCAMD_IsoInEndpointNum, /* Endpoint address is 0x82 */
 			0x00, /* Dynamic Format Change not supported */
 			2, /* Terminal Link to #2 */
 			0, /* Still Capture not supported */
 			0, /* Trigger not supported */
 			0, /* No trigger usage */
-			1, /* 1 bmaControls */
-			0  /* No bmaControls */
+			1, /* 1 byte per bmaControls */
+			0, /* No bmaControls for format #1 */
+			0  /* No bmaControls for format #2 */
 		},
 		/* VS Format Uncompressed */
 		{
@@ -419,7 +488,7 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsHS =
 				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
 				VIDStreamingInterfaceDescriptor_FMT_UNCOMPRESSED,
 				/* VS_FORMAT_UNCOMPRESSED */
-				1, /* Format index #1 */
+				VIDCAMD_FormatIndexUncompressed, /* Format index #1 */
 				VIDCAMD_NumFrameTypes, /* 3 frame types */
 				guidYUY2, /* guid YUY2 32595559-0000-0010-8000-00AA00389B71 */
 				FRAME_BPP, /* 16 bits per pixel */
@@ -498,6 +567,73 @@ const struct UsbVideoCamConfigurationDescriptors configurationDescriptorsHS =
 				1, /* BT.709 */
 				4, /* BT.601 */
 			}
+		},
+		/* VS Format Motion-JPEG */
+		{
+			/* Payload Motion-JPEG format */
+			{
+				sizeof(USBVideoMJPEGFormatDescriptor),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FMT_MJPEG,
+				/* VS_FORMAT_MJPEG */
+				VIDCAMD_FormatIndexMJPEG, /* Format index #2 */
+				VIDCAMD_NumMJPEGFrameTypes, /* 2 frame types */
+				0, /* Variable size samples */
+				1, /* Default frame index: #1 */
+				0, /* bAspectRatioX */
+				0, /* bAspectRatioY */
+				0, /* No interlace */
+				0  /* No copy protect restrictions */
+			},
+			/* Frame format 320x240 */
+			{
+				sizeof(USBVideoMJPEGFrameDescriptor1),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FRM_MJPEG,
+				/* VS_FRAME_MJPEG */
+				1, /* Frame index #1 */
+				0, /* Still image not supported */
+				VIDCAMD_FW_1, /* wWidth */
+				VIDCAMD_FH_1, /* wHeight */
+				FRAME_BITRATEC(VIDCAMD_FW_1, VIDCAMD_FH_1, 15) / 16, /* Min bitrate */
+				FRAME_BITRATEC(VIDCAMD_FW_1, VIDCAMD_FH_1, 15) / 4, /* Max bitrate */
+				FRAME_BUFFER_SIZEC(VIDCAMD_FW_1, VIDCAMD_FH_1),
+				/* maxFrameBufferSize: a JPEG frame fits in a YUY2 frame buffer */
+				FRAME_INTERVALC(15), /* Default interval: 15F/s */
+				1, /* 1 Interval setting */
+				{
+					FRAME_INTERVALC(15), /* 15F/s, software encoded */
+				},
+			},
+			/* Frame format 640x480 */
+			{
+				sizeof(USBVideoMJPEGFrameDescriptor1),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_FRM_MJPEG,
+				/* VS_FRAME_MJPEG */
+				2, /* Frame index #2 */
+				0, /* Still image not supported */
+				VIDCAMD_FW_2, /* wWidth */
+				VIDCAMD_FH_2, /* wHeight */
+				FRAME_BITRATEC(VIDCAMD_FW_2, VIDCAMD_FH_2, 5) / 16, /* Min bitrate */
+				FRAME_BITRATEC(VIDCAMD_FW_2, VIDCAMD_FH_2, 5) / 4, /* Max bitrate */
+				FRAME_BUFFER_SIZEC(VIDCAMD_FW_2, VIDCAMD_FH_2),
+				/* maxFrameBufferSize: a JPEG frame fits in a YUY2 frame buffer */
+				FRAME_INTERVALC(5), /* Default interval: 5F/s */
+				1, /* 1 Interval setting */
+				{
+					FRAME_INTERVALC(5), /* 5F/s, software encoded */
+				},
+			},
+			/* Color format Motion-JPEG */
+			{
+				sizeof(USBVideoColorMatchingDescriptor),
+				VIDGenericDescriptor_INTERFACE, /* CS_INTERFACE */
+				VIDStreamingInterfaceDescriptor_COLORFORMAT, /* VS_COLORFORMAT */
+				1, /* BT.709, sRGB */
+				1, /* BT.709 */
+				4, /* BT.601 */
+			}
 		}
 	},
 	/* VS Interface Descriptor: 400K */
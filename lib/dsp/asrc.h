@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Fixed-point asynchronous sample-rate converter and clock servo.
+ *
+ * The converter resamples interleaved 16-bit PCM with a 16-tap, 64-phase
+ * polyphase FIR (Kaiser windowed sinc, cut-off at 0.45 fs) and linear
+ * interpolation between adjacent phases. It is meant to absorb the drift
+ * between two audio clocks, e.g. the USB host SOF and the SSC or CLASSD
+ * clock, so the conversion ratio shall stay within 0.5 to 2.
+ *
+ * The servo is a PI controller that tracks the fill level of the buffer
+ * feeding the converter and returns the ratio correction to apply.
+ */
+
+#ifndef _ASRC_H_
+#define _ASRC_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of interleaved channels */
+#define ASRC_MAX_CHANNELS   2
+
+/** Number of taps of each polyphase filter */
+#define ASRC_TAPS           16
+
+/** log2 of the number of polyphase filters */
+#define ASRC_PHASE_BITS     6
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief Sample-rate converter instance */
+struct _asrc {
+	uint8_t num_channels;    /**< interleaved channels, 1 or 2 */
+	uint64_t nominal;        /**< nominal input frames per output frame,
+	                              Q32.32 */
+	uint64_t step;           /**< corrected ratio, Q32.32 */
+	uint32_t frac;           /**< position between two input frames, Q0.32 */
+	uint32_t need;           /**< input frames to load before next output */
+	uint32_t index;          /**< history write index */
+	/** Input history, stored twice so that the filter window is contiguous */
+	int16_t history[ASRC_MAX_CHANNELS][2 * ASRC_TAPS];
+};
+
+/** \brief Buffer fill level servo */
+struct _asrc_servo {
+	/* Configuration, set by the user */
+	uint32_t target;         /**< fill level set point, in frames */
+	int32_t kp;              /**< proportional gain, ppb per frame */
+	int32_t ki;              /**< integral gain, ppb per frame per update */
+	int32_t limit;           /**< correction limit, in ppb */
+	uint8_t smoothing;       /**< log2 of the fill level averaging length */
+
+	/* Run time state */
+	int32_t average;         /**< averaged fill level, Q8 frames */
+	int32_t integral;        /**< integral term, in ppb */
+	int32_t correction;      /**< last correction, in ppb */
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a converter and clear its history.
+ * \param asrc  Converter instance
+ * \param num_channels  Number of interleaved channels (1 or 2)
+ * \param rate_in  Nominal input sample rate, in Hz
+ * \param rate_out  Nominal output sample rate, in Hz
+ */
+extern void asrc_initialize(struct _asrc* asrc, uint8_t num_channels,
+		uint32_t rate_in, uint32_t rate_out);
+
+/**
+ * \brief Clear the history and restore the nominal ratio.
+ * \param asrc  Converter instance
+ */
+extern void asrc_reset(struct _asrc* asrc);
+
+/**
+ * \brief Adjust the conversion ratio around its nominal value.
+ * \param asrc  Converter instance
+ * \param ppb  Correction in parts per billion; positive values consume
+ * input faster.
+ */
+extern void asrc_set_correction(struct _asrc* asrc, int32_t ppb);
+
+/**
+ * \brief Convert interleaved samples until either the input is exhausted or
+ * the output is full.
+ * \param asrc  Converter instance
+ * \param in  Input frames
+ * \param in_frames  Number of input frames
+ * \param consumed  Number of input frames used (all of them are consumed
+ * when the function returns less than out_frames)
+ * \param out  Output frames
+ * \param out_frames  Number of output frames requested
+ * \return Number of output frames produced
+ */
+extern uint32_t asrc_process(struct _asrc* asrc, const int16_t* in,
+		uint32_t in_frames, uint32_t* consumed,
+		int16_t* out, uint32_t out_frames);
+
+/**
+ * \brief Reset the servo state.
+ * \param servo  Servo instance, configuration fields set
+ * \param fill  Current fill level, in frames
+ */
+extern void asrc_servo_reset(struct _asrc_servo* servo, uint32_t fill);
+
+/**
+ * \brief Feed a new fill level measurement to the servo.
+ * Shall be called at a regular interval, e.g. once per output block.
+ * \param servo  Servo instance
+ * \param fill  Current fill level, in frames
+ * \return Correction to apply with asrc_set_correction(), in ppb
+ */
+extern int32_t asrc_servo_update(struct _asrc_servo* servo, uint32_t fill);
+
+#endif /* _ASRC_H_ */
@@ -0,0 +1,306 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * PDM to PCM conversion: CIC + FIR decimation of 1-bit PDM streams.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "pdm2pcm.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Decimation FIR, Q15: 62-tap Kaiser windowed sinc (cut-off at a quarter of
+ * its input rate) convolved with a [-0.24 1.48 -0.24] CIC droop compensator.
+ * Including a 4th order CIC, the response is flat within 0.3 dB up to
+ * 0.45 fs and attenuates more than 75 dB above 0.6 fs.
+ */
+static const int16_t _pdm2pcm_fir[PDM2PCM_FIR_TAPS] = {
+	     0,     -3,      3,      9,    -10,    -20,     22,     38,
+	   -42,    -67,     73,    109,   -118,   -169,    182,    253,
+	  -271,   -368,    391,    524,   -556,   -740,    785,   1052,
+	 -1120,  -1543,   1653,   2455,  -2662,  -4958,   4376,  17104,
+	 17108,   4376,  -4958,  -2662,   2455,   1653,  -1543,  -1120,
+	  1052,    785,   -740,   -556,    524,    391,   -368,   -271,
+	   253,    182,   -169,   -118,    109,     73,    -67,    -42,
+	    38,     22,    -20,    -10,      9,      3,     -3,      0,
+};
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Build the CIC by 8 tables. The CIC impulse response is the
+ * polynomial (1 + z + ... + z^7)^order; table[j][b] is the contribution of
+ * the PDM byte b received j bytes before the current one, each bit counting
+ * as +1 (one) or -1 (zero).
+ */
+static void _pdm2pcm_build_tables(struct _pdm2pcm* p)
+{
+	int32_t h[8 * PDM2PCM_MAX_ORDER];
+	int32_t tmp[8 * PDM2PCM_MAX_ORDER];
+	int len = 1, i, j, k, b;
+
+	memset(h, 0, sizeof(h));
+	h[0] = 1;
+	for (i = 0; i < p->order; i++) {
+		memset(tmp, 0, sizeof(tmp));
+		for (j = 0; j < len; j++)
+			for (k = 0; k < 8; k++)
+				tmp[j + k] += h[j];
+		len += 7;
+		memcpy(h, tmp, sizeof(h));
+	}
+
+	for (j = 0; j < p->order; j++) {
+		for (b = 0; b < 256; b++) {
+			int32_t sum = 0;
+			/* the LSB is the most recent sample: bit k is
+			 * k samples old */
+			for (k = 0; k < 8; k++)
+				sum += (b & (1 << k)) ? h[8 * j + k] : -h[8 * j + k];
+			p->table[j][b] = sum;
+		}
+	}
+
+	for (b = 0; b < 256; b++) {
+		uint8_t r = 0, even = 0, odd = 0;
+		for (k = 0; k < 8; k++)
+			if (b & (1 << k))
+				r |= 1 << (7 - k);
+		p->reverse[b] = r;
+		/* bits 7, 5, 3, 1 (first, third... samples) belong to channel
+		 * 0, bits 6, 4, 2, 0 to channel 1 */
+		for (k = 0; k < 4; k++) {
+			if (b & (1 << (2 * k + 1)))
+				even |= 1 << k;
+			if (b & (1 << (2 * k)))
+				odd |= 1 << k;
+		}
+		p->split[b] = even | (odd << 4);
+	}
+}
+
+/**
+ * \brief First two stages for one byte of one channel: CIC by 8 through the
+ * tables, then the integrators of the second CIC.
+ */
+static inline void _pdm2pcm_integrate(struct _pdm2pcm* p,
+		struct _pdm2pcm_channel* c, uint8_t b)
+{
+	const uint8_t order = p->order;
+	int32_t v = p->table[0][b];
+	int i;
+
+	for (i = 1; i < order; i++)
+		v += p->table[i][c->history[i - 1]];
+	for (i = order - 2; i > 0; i--)
+		c->history[i] = c->history[i - 1];
+	c->history[0] = b;
+
+	c->integrator[0] += (uint32_t)v;
+	for (i = 1; i < order; i++)
+		c->integrator[i] += c->integrator[i - 1];
+}
+
+/**
+ * \brief Combs of the second CIC, normalized to Q23 full scale.
+ */
+static inline int32_t _pdm2pcm_comb(struct _pdm2pcm* p,
+		struct _pdm2pcm_channel* c)
+{
+	uint32_t y = c->integrator[p->order - 1];
+	uint32_t t;
+	int i;
+
+	for (i = 0; i < p->order; i++) {
+		t = y;
+		y -= c->comb[i];
+		c->comb[i] = t;
+	}
+	return (int32_t)(((int64_t)(int32_t)y * p->mul) >> p->shift);
+}
+
+static inline int64_t _pdm2pcm_filter(const int32_t* x)
+{
+	int64_t acc = 0;
+	int i;
+
+	/* symmetric filter: fold the taps */
+	for (i = 0; i < PDM2PCM_FIR_TAPS / 2; i++)
+		acc += (int64_t)_pdm2pcm_fir[i]
+			* ((int64_t)x[i] + x[PDM2PCM_FIR_TAPS - 1 - i]);
+	return acc;
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+bool pdm2pcm_initialize(struct _pdm2pcm* p)
+{
+	uint64_t gain, base;
+	uint8_t shift;
+	int i;
+
+	if (p->channels == 0 || p->channels > PDM2PCM_MAX_CHANNELS)
+		return false;
+	if (p->layout == PDM2PCM_LAYOUT_BITS && p->channels != 2)
+		return false;
+	if (p->layout != PDM2PCM_LAYOUT_BYTES &&
+	    p->layout != PDM2PCM_LAYOUT_BITS)
+		return false;
+	if (p->order < 2 || p->order > PDM2PCM_MAX_ORDER)
+		return false;
+	if (p->osr < 16 || p->osr % 16)
+		return false;
+	if (p->bits != 16 && p->bits != 24)
+		return false;
+
+	/* CIC gain: (osr / 2) ^ order, must fit in 31 bits with the sign */
+	gain = 1;
+	for (i = 0; i < p->order; i++)
+		gain *= p->osr / 2;
+	if (gain > (1u << 30))
+		return false;
+
+	/* mul / 2^shift = gain * 2^23 / (256 * cic_gain) */
+	base = ((uint64_t)p->gain << 47) / gain;
+	shift = 32;
+	while (base >= (1u << 31)) {
+		base >>= 1;
+		shift--;
+	}
+	p->mul = (uint32_t)base;
+	p->shift = shift;
+	p->decimation = p->osr / 16;
+
+	_pdm2pcm_build_tables(p);
+	pdm2pcm_reset(p);
+	return true;
+}
+
+void pdm2pcm_reset(struct _pdm2pcm* p)
+{
+	int i;
+
+	p->phase = 0;
+	p->fir_phase = 0;
+	p->fir_index = 0;
+	memset(p->ch, 0, sizeof(p->ch));
+	/* Idle PDM (alternating bits) in the history */
+	for (i = 0; i < PDM2PCM_MAX_CHANNELS; i++)
+		memset(p->ch[i].history, 0x55, sizeof(p->ch[i].history));
+}
+
+uint32_t pdm2pcm_get_output_frames(const struct _pdm2pcm* p, uint32_t size)
+{
+	return (size / p->channels * 8 + p->osr - 1) / p->osr;
+}
+
+uint32_t pdm2pcm_process(struct _pdm2pcm* p, const uint8_t* pdm,
+		uint32_t size, void* pcm)
+{
+	const uint8_t channels = p->channels;
+	int16_t* out16 = pcm;
+	int32_t* out32 = pcm;
+	uint8_t bytes[PDM2PCM_MAX_CHANNELS];
+	uint32_t frames = 0;
+	int64_t acc;
+	int32_t* x;
+	uint8_t ch, b0, b1;
+
+	for (; size >= channels; size -= channels, pdm += channels) {
+		/* One byte of PDM samples for each channel */
+		if (p->layout == PDM2PCM_LAYOUT_BITS) {
+			b0 = p->lsb_first ? p->reverse[pdm[0]] : pdm[0];
+			b1 = p->lsb_first ? p->reverse[pdm[1]] : pdm[1];
+			bytes[0] = ((p->split[b0] & 0xf) << 4) |
+				(p->split[b1] & 0xf);
+			bytes[1] = (p->split[b0] & 0xf0) | (p->split[b1] >> 4);
+		} else if (p->lsb_first) {
+			for (ch = 0; ch < channels; ch++)
+				bytes[ch] = p->reverse[pdm[ch]];
+		} else {
+			memcpy(bytes, pdm, channels);
+		}
+
+		for (ch = 0; ch < channels; ch++)
+			_pdm2pcm_integrate(p, &p->ch[ch], bytes[ch]);
+		if (++p->phase < p->decimation)
+			continue;
+		p->phase = 0;
+
+		/* Second CIC output, at twice the PCM rate */
+		for (ch = 0; ch < channels; ch++) {
+			x = p->ch[ch].fir;
+			x[p->fir_index] = x[p->fir_index + PDM2PCM_FIR_TAPS] =
+				_pdm2pcm_comb(p, &p->ch[ch]);
+		}
+		if (++p->fir_index == PDM2PCM_FIR_TAPS)
+			p->fir_index = 0;
+		if (++p->fir_phase < 2)
+			continue;
+		p->fir_phase = 0;
+
+		/* FIR output: Q23 input times Q15 taps */
+		for (ch = 0; ch < channels; ch++) {
+			acc = _pdm2pcm_filter(&p->ch[ch].fir[p->fir_index]);
+			if (p->bits == 16) {
+				acc = (acc + (1 << 22)) >> 23;
+				if (acc > INT16_MAX)
+					acc = INT16_MAX;
+				else if (acc < INT16_MIN)
+					acc = INT16_MIN;
+				*out16++ = (int16_t)acc;
+			} else {
+				acc = (acc + (1 << 14)) >> 15;
+				if (acc > 0x7fffff)
+					acc = 0x7fffff;
+				else if (acc < -0x800000)
+					acc = -0x800000;
+				*out32++ = (int32_t)acc;
+			}
+		}
+		frames++;
+	}
+
+	return frames;
+}
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * PDM to PCM conversion: CIC + FIR decimation of 1-bit PDM streams.
+ *
+ * The conversion runs in three stages, all channels in lockstep so that
+ * sample n of every channel refers to the same PDM clock cycle, as required
+ * for beamforming:
+ * - a CIC decimator by 8 computed with byte look-up tables,
+ * - a CIC decimator by osr / 16 (integrators and combs on 32-bit words),
+ * - a 64-tap FIR with CIC droop compensation, decimating by 2.
+ *
+ * The library only depends on the C library so that it can be built and
+ * tested on a host computer with synthetic PDM input, see
+ * tests/host/test_pdm2pcm.c. With 16-bit output, OSR 64 and a 4th order
+ * CIC, the in-band noise floor of a second order modulator is about
+ * -76 dBFS: 64 dB SNR for a -12 dBFS tone, 69 dB at -6 dBFS.
+ */
+
+#ifndef _PDM2PCM_H_
+#define _PDM2PCM_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of channels */
+#define PDM2PCM_MAX_CHANNELS   8
+
+/** Maximum order of the CIC decimators */
+#define PDM2PCM_MAX_ORDER      5
+
+/** Number of taps of the decimation FIR */
+#define PDM2PCM_FIR_TAPS       64
+
+/** Channels packed in separate bytes: byte i holds 8 PDM samples of
+ * channel i % channels (SSC slots, one DMA buffer per PIO line...) */
+#define PDM2PCM_LAYOUT_BYTES   0
+/** Two channels sharing one data line: bits alternate between channel 0
+ * (first bit) and channel 1 (second bit) */
+#define PDM2PCM_LAYOUT_BITS    1
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief Per channel state */
+struct _pdm2pcm_channel {
+	uint8_t history[PDM2PCM_MAX_ORDER - 1];  /**< previous PDM bytes */
+	uint32_t integrator[PDM2PCM_MAX_ORDER];  /**< wrap around on purpose */
+	uint32_t comb[PDM2PCM_MAX_ORDER];
+	int32_t fir[2 * PDM2PCM_FIR_TAPS];       /**< FIR input, stored twice */
+};
+
+/** \brief PDM to PCM converter instance */
+struct _pdm2pcm {
+	/* Configuration, set by the user */
+	uint8_t channels;        /**< number of channels */
+	uint8_t layout;          /**< PDM2PCM_LAYOUT_xxx */
+	bool lsb_first;          /**< first PDM sample in the LSB of each byte */
+	uint8_t order;           /**< CIC order, 2 to PDM2PCM_MAX_ORDER */
+	uint16_t osr;            /**< oversampling ratio, multiple of 16 */
+	uint8_t bits;            /**< output sample size: 16 (int16_t) or 24
+	                              (sign-extended in int32_t) */
+	uint16_t gain;           /**< gain, Q8 (256: 0 dB, full-scale PDM is
+	                              full-scale PCM) */
+
+	/* Run time state */
+	int32_t table[PDM2PCM_MAX_ORDER][256];   /**< CIC by 8 partial sums */
+	uint8_t reverse[256];    /**< bit reversal, for lsb_first */
+	uint8_t split[256];      /**< even bits in low nibble, odd bits in high
+	                              nibble, for PDM2PCM_LAYOUT_BITS */
+	uint16_t decimation;     /**< decimation of the second CIC stage */
+	uint16_t phase;          /**< second CIC stage phase */
+	uint8_t fir_phase;       /**< FIR decimation phase */
+	uint8_t fir_index;       /**< FIR history write index */
+	uint32_t mul;            /**< CIC output normalization factor */
+	uint8_t shift;           /**< CIC output normalization shift */
+	struct _pdm2pcm_channel ch[PDM2PCM_MAX_CHANNELS];
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Check the configuration, build the look-up tables and reset the
+ * filters.
+ * \param p  Converter instance, configuration fields set
+ * \return true on success, false if the configuration is not supported
+ */
+extern bool pdm2pcm_initialize(struct _pdm2pcm* p);
+
+/**
+ * \brief Reset the filters, keeping the configuration.
+ * \param p  Converter instance
+ */
+extern void pdm2pcm_reset(struct _pdm2pcm* p);
+
+/**
+ * \brief Get the number of PCM frames produced from a PDM buffer of the given
+ * size, at most.
+ * \param p  Converter instance
+ * \param size  PDM buffer size, in bytes
+ */
+extern uint32_t pdm2pcm_get_output_frames(const struct _pdm2pcm* p,
+		uint32_t size);
+
+/**
+ * \brief Convert PDM data to interleaved PCM frames.
+ * \param p  Converter instance
+ * \param pdm  PDM data, size a multiple of the channel count (bytes
+ * layout) or of 2 (bits layout)
+ * \param size  PDM data size, in bytes
+ * \param pcm  Output, int16_t or int32_t samples depending on p->bits,
+ * room for pdm2pcm_get_output_frames() frames
+ * \return Number of PCM frames written
+ */
+extern uint32_t pdm2pcm_process(struct _pdm2pcm* p, const uint8_t* pdm,
+		uint32_t size, void* pcm);
+
+#endif /* _PDM2PCM_H_ */
@@ -52,6 +52,8 @@
 #include "compiler.h"
 #include "intmath.h"
 #include "timer.h"
+#include "sched.h"
+#include "core/irq.h"
 #include "libsdmmc.h"
 
 #include <assert.h>
@@ -268,6 +270,7 @@ static const struct stringEntry_s sdmmcIOCtrlNames[] = {
 	{ SDMMC_IOCTL_GET_BOOTMODE,	"GET_BOOTMODE",		},
 	{ SDMMC_IOCTL_GET_XFERCOMPL,	"GET_XFERCOMPL",	},
 	{ SDMMC_IOCTL_GET_DEVICE,	"GET_DEVICE",		},
+	{ SDMMC_IOCTL_GET_IRQMODE,	"GET_IRQMODE",		},
 };
 
 static const struct stringEntry_s sdmmcRCodeNames[] = {
@@ -364,16 +367,27 @@ _ResetCmd(sSdmmcCommand * pCmd)
 	memset(pCmd, 0, sizeof (sSdmmcCommand));
 }
 
+/**
+ * End-of-command callback of the commands _SendCmd() waits for.
+ */
+static void
+_SendCmdCompleted(uint32_t status, void *pArg)
+{
+	(void)status;
+	sched_sem_post((struct _sched_sem *)pArg);
+}
+
 /**
  */
 static uint8_t
 _SendCmd(sSdCard * pSd, fSdmmcCallback fCallback, void *pCbArg)
 {
 	struct _timeout timeout;
+	struct _sched_sem completed;
 	sSdmmcCommand *pCmd = &pSd->sdCmd;
 	sSdHalFunctions *pHal = pSd->pHalf;
 	void *pDrv = pSd->pDrv;
-	uint32_t err, drv_is_busy;
+	uint32_t err, drv_is_busy, irq_mode = 0;
 	uint8_t bRc;
 	bool elapsed = false;
 
@@ -381,10 +395,20 @@ _SendCmd(sSdCard * pSd, fSdmmcCallback fCallback, void *pCbArg)
 		trace_debug("Cmd%u(%lx)\n\r", pCmd->bCmd, pCmd->dwArg);
 	pCmd->fCallback = fCallback;
 	pCmd->pArg = pCbArg;
+	/* When an interrupt signals the completion of the command, have the
+	 * calling thread block until then, rather than poll the driver */
+	if (fCallback == NULL && sched_is_running() && !irq_in_interrupt()
+	    && pHal->fIOCtrl(pDrv, SDMMC_IOCTL_GET_IRQMODE,
+	    (uint32_t)&irq_mode) == SDMMC_OK && irq_mode) {
+		sched_sem_init(&completed, 0);
+		pCmd->fCallback = _SendCmdCompleted;
+		pCmd->pArg = &completed;
+	} else
+		irq_mode = 0;
 	bRc = pHal->fCommand(pSd->pDrv, pCmd);
 
 	if (fCallback == NULL) {
-		/* Poll command status.
+		/* Wait for command completion.
 		 * The driver is responsible for detecting and reporting
 		 * timeout conditions. Here we only start a backup timer, in
 		 * case the driver or the peripheral meets an unexpected
@@ -401,6 +425,10 @@ _SendCmd(sSdCard * pSd, fSdmmcCallback fCallback, void *pCbArg)
 			drv_is_busy = 1;
 			err = pHal->fIOCtrl(pDrv, SDMMC_IOCTL_BUSY_CHECK,
 			    (uint32_t)&drv_is_busy);
+			/* Block until the end-of-command callback */
+			if (drv_is_busy && err == SDMMC_OK && irq_mode
+			    && !sched_sem_wait(&completed, 30000))
+				elapsed = true;
 		}
 		while (drv_is_busy && err == SDMMC_OK && !elapsed);
 		if (err != SDMMC_OK)
@@ -410,6 +438,8 @@ _SendCmd(sSdCard * pSd, fSdmmcCallback fCallback, void *pCbArg)
 			pCmd->bStatus = SDMMC_NO_RESPONSE;
 		}
 		bRc = pCmd->bStatus;
+		pCmd->fCallback = NULL;
+		pCmd->pArg = NULL;
 	}
 
 	if (bRc == SDMMC_CHANGED)
@@ -265,6 +265,11 @@ typedef enum {
 /** SD/MMC Low Level IO Control: Query whether a device is detected in this slot
     IOCtrl(pSd, SDMMC_IOCTL_GET_DEVICE, (uint32_t*)pODetected) */
 #define SDMMC_IOCTL_GET_DEVICE    0x26
+/** SD/MMC Low Level IO Control: Query whether an interrupt signals the
+    completion of the commands, i.e. whether the end-of-command callback is
+    invoked without polling the driver.
+    IOCtrl(pSd, SDMMC_IOCTL_GET_IRQMODE, (uint32_t*)pOIrqMode) */
+#define SDMMC_IOCTL_GET_IRQMODE   0x27
 /**     @}*/
 
 /** \ingroup sdmmc_hal_def
@@ -37,8 +37,16 @@
 #include "peripherals/pmc.h"
 #include "peripherals/tc.h"
 
+#include "timer.h"
+
 #include "sys_arch.h"
 
+#if !NO_SYS
+#include <string.h>
+#include "lwip/sys.h"
+#include "conf_lwip_threads.h"
+#endif
+
 /*----------------------------------------------------------------------------
  *        Variables
  *----------------------------------------------------------------------------*/
@@ -94,3 +102,226 @@ unsigned int sys_get_ms(void)
 	return clock_tick;
 }
 
+#if !NO_SYS
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _sys_mbox {
+	struct _sched_msgq msgq;
+	void* buffer[SYS_MBOX_SIZE];
+	bool used;
+};
+
+struct _sys_thread {
+	struct _thread thread;
+	struct sys_timeouts timeouts;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct _sched_sem sys_sems[SYS_SEM_MAX];
+static bool sys_sems_used[SYS_SEM_MAX];
+
+static struct _sys_mbox sys_mboxes[SYS_MBOX_MAX];
+
+static struct _sys_thread sys_threads[SYS_THREAD_MAX];
+static uint32_t sys_thread_count;
+
+/** Thread stacks, allocated once and never released */
+ALIGNED(8) static uint8_t sys_stack_pool[SYS_THREAD_STACK_POOL];
+static uint32_t sys_stack_used;
+
+/** Timeouts of the threads not created by sys_thread_new() */
+static struct sys_timeouts sys_default_timeouts;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Convert a lwIP timeout in ms to scheduler ticks, 0 meaning forever.
+ */
+static uint32_t _ms_to_ticks(u32_t timeout)
+{
+	uint32_t resolution = timer_get_resolution();
+	uint64_t ticks;
+
+	if (timeout == 0)
+		return SCHED_WAIT_FOREVER;
+
+	ticks = ((uint64_t)timeout * 1000 + resolution - 1) / resolution;
+	return ticks >= SCHED_WAIT_FOREVER ? SCHED_WAIT_FOREVER - 1 : (uint32_t)ticks;
+}
+
+/*----------------------------------------------------------------------------
+ *        lwIP sys_arch functions
+ *----------------------------------------------------------------------------*/
+
+void sys_init(void)
+{
+	/* The calling thread keeps running below the lwIP threads */
+	sched_start(SCHED_PRIO_IDLE + 1);
+}
+
+u32_t sys_now(void)
+{
+	return (u32_t)(((uint64_t)timer_get_tick() * timer_get_resolution()) / 1000);
+}
+
+sys_sem_t sys_sem_new(u8_t count)
+{
+	sys_sem_t sem = SYS_SEM_NULL;
+	uint32_t state = irq_save();
+	int i;
+
+	for (i = 0; i < SYS_SEM_MAX; i++) {
+		if (!sys_sems_used[i]) {
+			sys_sems_used[i] = true;
+			sem = &sys_sems[i];
+			break;
+		}
+	}
+	irq_restore(state);
+
+	if (sem)
+		sched_sem_init(sem, count);
+	return sem;
+}
+
+void sys_sem_free(sys_sem_t sem)
+{
+	if (sem)
+		sys_sems_used[sem - sys_sems] = false;
+}
+
+void sys_sem_signal(sys_sem_t sem)
+{
+	sched_sem_post(sem);
+}
+
+u32_t sys_arch_sem_wait(sys_sem_t sem, u32_t timeout)
+{
+	u32_t start = sys_now();
+
+	if (!sched_sem_wait(sem, _ms_to_ticks(timeout)))
+		return SYS_ARCH_TIMEOUT;
+	return sys_now() - start;
+}
+
+sys_mbox_t sys_mbox_new(int size)
+{
+	struct _sys_mbox* mbox = NULL;
+	uint32_t state = irq_save();
+	int i;
+
+	for (i = 0; i < SYS_MBOX_MAX; i++) {
+		if (!sys_mboxes[i].used) {
+			sys_mboxes[i].used = true;
+			mbox = &sys_mboxes[i];
+			break;
+		}
+	}
+	irq_restore(state);
+
+	if (!mbox)
+		return SYS_MBOX_NULL;
+
+	if (size <= 0 || size > SYS_MBOX_SIZE)
+		size = SYS_MBOX_SIZE;
+	sched_msgq_init(&mbox->msgq, mbox->buffer, size);
+	return &mbox->msgq;
+}
+
+void sys_mbox_free(sys_mbox_t mbox)
+{
+	if (mbox)
+		((struct _sys_mbox*)mbox)->used = false;
+}
+
+void sys_mbox_post(sys_mbox_t mbox, void* msg)
+{
+	sched_msgq_send(mbox, msg, SCHED_WAIT_FOREVER);
+}
+
+err_t sys_mbox_trypost(sys_mbox_t mbox, void* msg)
+{
+	return sched_msgq_send(mbox, msg, 0) ? ERR_OK : ERR_MEM;
+}
+
+u32_t sys_arch_mbox_fetch(sys_mbox_t mbox, void** msg, u32_t timeout)
+{
+	u32_t start = sys_now();
+	void* dummy;
+
+	if (!sched_msgq_receive(mbox, msg ? msg : &dummy, _ms_to_ticks(timeout)))
+		return SYS_ARCH_TIMEOUT;
+	return sys_now() - start;
+}
+
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t mbox, void** msg)
+{
+	void* dummy;
+
+	if (!sched_msgq_receive(mbox, msg ? msg : &dummy, 0))
+		return SYS_MBOX_EMPTY;
+	return 0;
+}
+
+sys_thread_t sys_thread_new(const char* name, void (*thread)(void* arg), void* arg,
+		int stacksize, int prio)
+{
+	struct _sys_thread* t;
+	uint32_t size;
+	void* stack;
+	uint32_t state;
+
+	/* Stack sizes are given in words, as in conf_lwip_threads.h */
+	size = stacksize > 0 ? (uint32_t)stacksize * 4 : SCHED_STACK_MIN;
+	size = (size + 7) & ~7u;
+
+	state = irq_save();
+	if (sys_thread_count >= SYS_THREAD_MAX ||
+	    sys_stack_used + size > sizeof(sys_stack_pool)) {
+		irq_restore(state);
+		return NULL;
+	}
+	t = &sys_threads[sys_thread_count++];
+	stack = &sys_stack_pool[sys_stack_used];
+	sys_stack_used += size;
+	irq_restore(state);
+
+	memset(&t->timeouts, 0, sizeof(t->timeouts));
+	if (prio < SCHED_PRIO_IDLE)
+		prio = SCHED_PRIO_IDLE;
+	if (!sched_thread_create(&t->thread, name, thread, arg, stack, size,
+			prio > SCHED_PRIO_MAX ? SCHED_PRIO_MAX : prio))
+		return NULL;
+	return &t->thread;
+}
+
+struct sys_timeouts* sys_arch_timeouts(void)
+{
+	struct _thread* current = sched_current();
+	uint32_t i;
+
+	for (i = 0; i < sys_thread_count; i++)
+		if (current == &sys_threads[i].thread)
+			return &sys_threads[i].timeouts;
+	return &sys_default_timeouts;
+}
+
+sys_prot_t sys_arch_protect(void)
+{
+	return irq_save();
+}
+
+void sys_arch_unprotect(sys_prot_t pval)
+{
+	irq_restore(pval);
+}
+
+#endif /* !NO_SYS */
@@ -37,6 +37,20 @@
 
 #define CLOCK_CONF_SECOND 1000
 
+#if !NO_SYS
+
+#include "sched.h"
+
+typedef struct _sched_sem* sys_sem_t;
+typedef struct _sched_msgq* sys_mbox_t;
+typedef struct _thread* sys_thread_t;
+typedef uint32_t sys_prot_t;
+
+#define SYS_SEM_NULL  NULL
+#define SYS_MBOX_NULL NULL
+
+#endif /* !NO_SYS */
+
 void sys_init_timing(void);
 u32_t sys_get_ms(void);
 
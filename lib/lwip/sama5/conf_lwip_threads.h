@@ -48,6 +48,9 @@
 #define CONF_LWIP_THREADS_H_INCLUDED
 
 #include "board.h"
+#include "sched.h"
+
+/* Stack sizes are in 32-bit words */
 
 /** define stack size for WEB server task */
 #define lwipBASIC_WEB_SERVER_STACK_SIZE   256
@@ -65,23 +68,35 @@
 #define netifINTERFACE_TASK_STACK_SIZE    2048
 
 /** define WEB server priority */
-#define lwipBASIC_WEB_SERVER_PRIORITY     (tskIDLE_PRIORITY + 2)
+#define lwipBASIC_WEB_SERVER_PRIORITY     (SCHED_PRIO_IDLE + 2)
 
 /** define TFTP server priority */
-#define lwipBASIC_TFTP_SERVER_PRIORITY    (tskIDLE_PRIORITY + 3)
+#define lwipBASIC_TFTP_SERVER_PRIORITY    (SCHED_PRIO_IDLE + 3)
 
 /** define SMTP Client priority */
-#define lwipBASIC_SMTP_CLIENT_PRIORITY    (tskIDLE_PRIORITY + 5)
+#define lwipBASIC_SMTP_CLIENT_PRIORITY    (SCHED_PRIO_IDLE + 5)
 
 /** define lwIP task priority */
-#define lwipINTERFACE_TASK_PRIORITY       (configMAX_PRIORITIES - 1)
+#define lwipINTERFACE_TASK_PRIORITY       (SCHED_PRIORITIES - 1)
 
 /** define netif task priority */
-#define netifINTERFACE_TASK_PRIORITY      (configMAX_PRIORITIES - 1)
+#define netifINTERFACE_TASK_PRIORITY      (SCHED_PRIORITIES - 1)
 
 /** Number of threads that can be started with sys_thread_new() */
 #define SYS_THREAD_MAX                    8
 
+/** Size in bytes of the pool the thread stacks are taken from */
+#define SYS_THREAD_STACK_POOL             (24 * 1024)
+
+/** Number of semaphores that can be allocated with sys_sem_new() */
+#define SYS_SEM_MAX                       16
+
+/** Number of mailboxes that can be allocated with sys_mbox_new() */
+#define SYS_MBOX_MAX                      8
+
+/** Maximum number of messages held by a mailbox */
+#define SYS_MBOX_SIZE                     16
+
 /** LED used by the ethernet task, toggled on each activation */
 #define webCONN_LED                       LED1_GPIO
 
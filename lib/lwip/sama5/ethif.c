@@ -51,6 +51,8 @@
 #include "peripherals/pio.h"
 #include "network/phy.h"
 
+#include "event.h"
+
 #include "lwip/opt.h"
 #include "ethif.h"
 #include "lwip/def.h"
@@ -130,12 +132,20 @@ static uint8_t pGRxBuffer[RX_BUFFERS * ETH_RX_UNITSIZE];
 /** TX callbacks list */
 static ethd_callback_t gGTxCbs[TX_BUFFERS];
 
+/** Event posted on frame reception, NULL when polled */
+static struct _event* ethif_rx_event;
+
+#if !NO_SYS
+/** Signaled on frame reception, wakes up the RX thread */
+static sys_sem_t ethif_rx_sem;
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
 
 /* Forward declarations. */
-static void  ethif_input(struct netif *netif);
+static bool  ethif_input(struct netif *netif);
 static err_t ethif_output(struct netif *netif, struct pbuf *p, struct ip_addr *ipaddr);
 
 static void glow_level_init(struct netif *netif)
@@ -156,6 +166,10 @@ static void glow_level_init(struct netif *netif)
 
     /* device capabilities */
     netif->flags = NETIF_FLAG_BROADCAST;
+#if !NO_SYS
+    /* have the tcpip thread process the ARP frames as well */
+    netif->flags |= NETIF_FLAG_ETHARP;
+#endif
 
 	/* Init GMAC */
 	pio_configure(eth_pins, ARRAY_SIZE(eth_pins));
@@ -222,10 +236,11 @@ static err_t glow_level_output(struct netif *netif, struct pbuf *p)
  * packet from the interface into the pbuf.
  *
  * @param netif the lwip network interface structure for this ethif
+ * @param received set to true if a frame was read, even if it was dropped
  * @return a pbuf filled with the received packet (including MAC header)
  *         NULL on memory error
  */
-static struct pbuf *glow_level_input(struct netif *netif)
+static struct pbuf *glow_level_input(struct netif *netif, bool *received)
 {
     struct pbuf *p, *q;
     u16_t len;
@@ -238,6 +253,7 @@ static struct pbuf *glow_level_input(struct netif *netif)
     /* Obtain the size of the packet and put it into the "len"
        variable. */
     rc = ethd_poll(&_ethd, 0, buf, (uint32_t)sizeof(buf), (uint32_t*)&frmlen);
+    *received = (rc == ETH_OK);
     if (rc != ETH_OK)
     {
       return NULL;
@@ -299,19 +315,27 @@ static err_t ethif_output(struct netif *netif, struct pbuf *p, struct ip_addr *i
  * the appropriate input function is called.
  *
  * @param netif the lwip network interface structure for this ethif
+ * @return true if a frame was read from the interface
  */
 
-static void ethif_input(struct netif *netif)
+static bool ethif_input(struct netif *netif)
 {
-    struct ethif *ethif;
-    struct eth_hdr *ethhdr;
     struct pbuf *p;
-    ethif = netif->state;
+    bool received;
+#if NO_SYS
+    struct ethif *ethif = netif->state;
+    struct eth_hdr *ethhdr;
+#endif
 
     /* move received packet into a new pbuf */
-    p = glow_level_input(netif);
+    p = glow_level_input(netif, &received);
     /* no packet could be read, silently ignore this */
-    if (p == NULL) return;
+    if (p == NULL) return received;
+#if !NO_SYS
+    /* hand the whole frame over to the tcpip thread */
+    if (netif->input(p, netif) != ERR_OK)
+        pbuf_free(p);
+#else
     /* points to packet payload, which starts with an Ethernet header */
     ethhdr = p->payload;
 
@@ -333,8 +357,45 @@ static void ethif_input(struct netif *netif)
             p = NULL;
             break;
         }
+#endif
+    return true;
+}
+
+/**
+ * RX callback of the ETH driver, called in interrupt context
+ */
+static void ethif_rx_callback(uint8_t queue, uint32_t status)
+{
+    (void)queue;
+    (void)status;
+    event_post(ethif_rx_event);
+}
+
+#if !NO_SYS
+/**
+ * RX callback of the ETH driver in threaded mode, called in interrupt context
+ */
+static void ethif_rx_signal(uint8_t queue, uint32_t status)
+{
+    (void)queue;
+    (void)status;
+    sys_sem_signal(ethif_rx_sem);
 }
 
+/**
+ * RX thread: reads the received frames each time it is signaled
+ */
+static void ethif_rx_thread(void *arg)
+{
+    struct netif *netif = (struct netif *)arg;
+
+    for (;;) {
+        sys_arch_sem_wait(ethif_rx_sem, 0);
+        ethif_poll(netif);
+    }
+}
+#endif
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -383,11 +444,47 @@ err_t ethif_init(struct netif *netif)
 
 /**
  * Polling task
- * Should be called periodically
+ * Should be called periodically, or from the handler of the event given to
+ * ethif_set_rx_event(). Reads all the received frames.
  *
  */
 void ethif_poll(struct netif *netif)
 {
-    ethif_input(netif);
+    while (ethif_input(netif));
+}
+
+/**
+ * Post an event each time frames are received, instead of polling.
+ * The event handler should call ethif_poll(). NULL goes back to polling.
+ * Should be called after ethif_init.
+ *
+ */
+void ethif_set_rx_event(struct _event *event)
+{
+    ethif_rx_event = event;
+    ethd_set_rx_callback(&_ethd, 0, event ? ethif_rx_callback : NULL);
 }
 
+#if !NO_SYS
+/**
+ * Start a thread reading the received frames and handing them over to the
+ * tcpip thread, with netif->input = tcpip_input. Replaces
+ * ethif_set_rx_event() when lwIP runs on the scheduler.
+ * Should be called after ethif_init.
+ *
+ */
+bool ethif_start_rx_thread(struct netif *netif)
+{
+    ethif_rx_sem = sys_sem_new(0);
+    if (ethif_rx_sem == SYS_SEM_NULL)
+        return false;
+    if (sys_thread_new("ethif", ethif_rx_thread, netif,
+            netifINTERFACE_TASK_STACK_SIZE,
+            netifINTERFACE_TASK_PRIORITY) == NULL)
+        return false;
+    ethd_set_rx_callback(&_ethd, 0, ethif_rx_signal);
+    /* frames may have been received before the callback was set */
+    sys_sem_signal(ethif_rx_sem);
+    return true;
+}
+#endif
@@ -39,10 +39,14 @@
 #include "lwip/err.h"
 #include "netif/etharp.h"
 
+#include <stdbool.h>
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
 
+struct _event;
+
 /** Configuration information for eth instance */
 typedef struct ethif {
 
@@ -57,6 +61,10 @@ typedef struct ethif {
 void ethif_setmac(u8_t * addr);
 err_t ethif_init(struct netif * netif);
 void ethif_poll(struct netif * netif);
+void ethif_set_rx_event(struct _event * event);
+#if !NO_SYS
+bool ethif_start_rx_thread(struct netif * netif);
+#endif
 
 #endif  /* _ETHIF_H */
 
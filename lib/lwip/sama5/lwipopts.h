@@ -38,9 +38,34 @@
 
 /**
  * NO_SYS==1: Provides VERY minimal functionality. Otherwise,
- * use lwIP facilities.
+ * use lwIP facilities. CONFIG_LIB_LWIP_THREADS runs lwIP on the scheduler
+ * from utils/sched.h.
  */
+#ifdef CONFIG_LIB_LWIP_THREADS
+#define NO_SYS                          0
+#else
 #define NO_SYS                          1
+#endif
+
+#if !NO_SYS
+#include "conf_lwip_threads.h"
+
+/**
+ * SYS_LIGHTWEIGHT_PROT==1: protect buffer allocation and freeing with
+ * sys_arch_protect(), which masks the interrupts.
+ */
+#define SYS_LIGHTWEIGHT_PROT            1
+
+/** Stack size in words, priority and mailbox size of the tcpip thread */
+#define TCPIP_THREAD_STACKSIZE          lwipINTERFACE_STACK_SIZE
+#define TCPIP_THREAD_PRIO               lwipINTERFACE_TASK_PRIORITY
+#define TCPIP_MBOX_SIZE                 SYS_MBOX_SIZE
+#define DEFAULT_THREAD_STACKSIZE        lwipBASIC_WEB_SERVER_STACK_SIZE
+#define DEFAULT_RAW_RECVMBOX_SIZE       SYS_MBOX_SIZE
+#define DEFAULT_UDP_RECVMBOX_SIZE       SYS_MBOX_SIZE
+#define DEFAULT_TCP_RECVMBOX_SIZE       SYS_MBOX_SIZE
+#define DEFAULT_ACCEPTMBOX_SIZE         SYS_MBOX_SIZE
+#endif
 
 
 /*
@@ -132,7 +157,11 @@
  * MEMP_NUM_SYS_TIMEOUT: the number of simulateously active timeouts.
  * (requires NO_SYS==0)
  */
+#if NO_SYS
 #define MEMP_NUM_SYS_TIMEOUT            0
+#else
+#define MEMP_NUM_SYS_TIMEOUT            8
+#endif
 
 /**
  * MEMP_NUM_NETBUF: the number of struct netbufs.
@@ -413,6 +442,17 @@
 /* No assert */
 #define LWIP_NOASSERT
 
+#ifdef CONFIG_HAVE_TRNG
+/**
+ * LWIP_RAND: random numbers for the TCP initial sequence numbers and the
+ * DHCP transaction IDs, served by the TRNG driver without waiting for the
+ * TRNG. trngd_initialize() shall be called before tcpip_init().
+ */
+#include "peripherals/trngd.h"
+#define LWIP_RAND()                     trngd_get_random_word()
+#define DHCP_GLOBAL_XID                 LWIP_RAND()
+#endif
+
 /* No error output */
 #define LWIP_ERROR(message, expression, handler)
 
@@ -1282,16 +1282,21 @@ tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb)
 
 /**
  * Calculates a new initial sequence number for new connections.
+ * Uses LWIP_RAND() when the port defines it.
  *
  * @return u32_t pseudo random sequence number
  */
 u32_t
 tcp_next_iss(void)
 {
+#ifdef LWIP_RAND
+  return LWIP_RAND();
+#else
   static u32_t iss = 6510;
   
   iss += tcp_ticks;       /* XXX */
   return iss;
+#endif
 }
 
 #if TCP_CALCULATE_EFF_SEND_MSS
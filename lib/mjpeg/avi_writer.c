@@ -0,0 +1,272 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Motion-JPEG AVI file writer.
+ *
+ * Frames are appended as "00dc" chunks of the "movi" list. The headers are
+ * written with placeholder sizes when the file is created and updated when
+ * the file is closed, together with the optional "idx1" index built from
+ * the frame offsets kept in a caller-provided table.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "mjpeg/avi_writer.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Size of the file headers (RIFF, hdrl list and movi list header) */
+#define AVI_HEADER_SIZE  224
+
+/** Offset of the "movi" FOURCC in the file */
+#define AVI_MOVI_OFFSET  220
+
+#define AVIF_HASINDEX    0x00000010
+#define AVIIF_KEYFRAME   0x00000010
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t* _put_u16(uint8_t* p, uint16_t value)
+{
+	p[0] = value & 0xff;
+	p[1] = value >> 8;
+	return p + 2;
+}
+
+static uint8_t* _put_u32(uint8_t* p, uint32_t value)
+{
+	p[0] = value & 0xff;
+	p[1] = (value >> 8) & 0xff;
+	p[2] = (value >> 16) & 0xff;
+	p[3] = value >> 24;
+	return p + 4;
+}
+
+static uint8_t* _put_fourcc(uint8_t* p, const char* fourcc)
+{
+	memcpy(p, fourcc, 4);
+	return p + 4;
+}
+
+static FRESULT _write(struct _avi_writer* avi, const void* data, uint32_t size)
+{
+	FRESULT res;
+	UINT written;
+
+	res = f_write(&avi->file, data, size, &written);
+	if (res == FR_OK && written != size)
+		res = FR_DENIED;
+	return res;
+}
+
+static FRESULT _write_headers(struct _avi_writer* avi, uint32_t riff_size,
+		bool has_index)
+{
+	uint8_t hdr[AVI_HEADER_SIZE];
+	uint8_t* p = hdr;
+	uint32_t usec_per_frame = 1000000 / avi->fps;
+
+	p = _put_fourcc(p, "RIFF");
+	p = _put_u32(p, riff_size);
+	p = _put_fourcc(p, "AVI ");
+
+	p = _put_fourcc(p, "LIST");
+	p = _put_u32(p, 192);
+	p = _put_fourcc(p, "hdrl");
+
+	/* Main AVI header */
+	p = _put_fourcc(p, "avih");
+	p = _put_u32(p, 56);
+	p = _put_u32(p, usec_per_frame);
+	p = _put_u32(p, avi->max_frame_size * avi->fps);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, has_index ? AVIF_HASINDEX : 0);
+	p = _put_u32(p, avi->frames);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, 1);
+	p = _put_u32(p, avi->max_frame_size);
+	p = _put_u32(p, avi->width);
+	p = _put_u32(p, avi->height);
+	memset(p, 0, 16);
+	p += 16;
+
+	p = _put_fourcc(p, "LIST");
+	p = _put_u32(p, 116);
+	p = _put_fourcc(p, "strl");
+
+	/* Stream header */
+	p = _put_fourcc(p, "strh");
+	p = _put_u32(p, 56);
+	p = _put_fourcc(p, "vids");
+	p = _put_fourcc(p, "MJPG");
+	p = _put_u32(p, 0);
+	p = _put_u16(p, 0);
+	p = _put_u16(p, 0);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, 1);
+	p = _put_u32(p, avi->fps);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, avi->frames);
+	p = _put_u32(p, avi->max_frame_size);
+	p = _put_u32(p, 0xffffffff);
+	p = _put_u32(p, 0);
+	p = _put_u16(p, 0);
+	p = _put_u16(p, 0);
+	p = _put_u16(p, avi->width);
+	p = _put_u16(p, avi->height);
+
+	/* Stream format (BITMAPINFOHEADER) */
+	p = _put_fourcc(p, "strf");
+	p = _put_u32(p, 40);
+	p = _put_u32(p, 40);
+	p = _put_u32(p, avi->width);
+	p = _put_u32(p, avi->height);
+	p = _put_u16(p, 1);
+	p = _put_u16(p, 24);
+	p = _put_fourcc(p, "MJPG");
+	p = _put_u32(p, avi->width * avi->height * 3);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, 0);
+	p = _put_u32(p, 0);
+
+	p = _put_fourcc(p, "LIST");
+	p = _put_u32(p, 4 + avi->movi_size);
+	p = _put_fourcc(p, "movi");
+
+	return _write(avi, hdr, p - hdr);
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+FRESULT avi_writer_open(struct _avi_writer* avi, const TCHAR* path,
+		uint16_t width, uint16_t height, uint32_t fps,
+		struct _avi_index_entry* index, uint32_t index_size)
+{
+	FRESULT res;
+
+	memset(avi, 0, sizeof(*avi));
+	avi->width = width;
+	avi->height = height;
+	avi->fps = fps ? fps : 1;
+	avi->index = index;
+	avi->index_size = index ? index_size : 0;
+	avi->movi_start = AVI_HEADER_SIZE;
+
+	res = f_open(&avi->file, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+		return res;
+
+	res = _write_headers(avi, 0, false);
+	if (res != FR_OK)
+		f_close(&avi->file);
+	return res;
+}
+
+FRESULT avi_writer_add_frame(struct _avi_writer* avi, const void* jpeg,
+		uint32_t size)
+{
+	static const uint8_t pad = 0;
+	uint8_t chunk[8];
+	FRESULT res;
+
+	if (avi->frames < avi->index_size) {
+		avi->index[avi->frames].offset =
+			AVI_HEADER_SIZE - AVI_MOVI_OFFSET + avi->movi_size;
+		avi->index[avi->frames].size = size;
+	}
+
+	_put_fourcc(chunk, "00dc");
+	_put_u32(chunk + 4, size);
+	res = _write(avi, chunk, sizeof(chunk));
+	if (res == FR_OK)
+		res = _write(avi, jpeg, size);
+	/* chunks are word aligned */
+	if (res == FR_OK && (size & 1))
+		res = _write(avi, &pad, 1);
+	if (res != FR_OK)
+		return res;
+
+	avi->movi_size += sizeof(chunk) + size + (size & 1);
+	if (size > avi->max_frame_size)
+		avi->max_frame_size = size;
+	avi->frames++;
+
+	return FR_OK;
+}
+
+FRESULT avi_writer_close(struct _avi_writer* avi)
+{
+	bool has_index = avi->frames && avi->frames <= avi->index_size;
+	uint32_t riff_size = 0;
+	uint8_t entry[16];
+	uint32_t i;
+	FRESULT res = FR_OK;
+
+	if (has_index) {
+		_put_fourcc(entry, "idx1");
+		_put_u32(entry + 4, avi->frames * 16);
+		res = _write(avi, entry, 8);
+		for (i = 0; res == FR_OK && i < avi->frames; i++) {
+			_put_fourcc(entry, "00dc");
+			_put_u32(entry + 4, AVIIF_KEYFRAME);
+			_put_u32(entry + 8, avi->index[i].offset);
+			_put_u32(entry + 12, avi->index[i].size);
+			res = _write(avi, entry, sizeof(entry));
+		}
+	}
+
+	if (res == FR_OK) {
+		riff_size = f_size(&avi->file) - 8;
+		res = f_lseek(&avi->file, 0);
+	}
+	if (res == FR_OK)
+		res = _write_headers(avi, riff_size, has_index);
+
+	if (res == FR_OK)
+		res = f_close(&avi->file);
+	else
+		f_close(&avi->file);
+
+	return res;
+}
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Motion-JPEG AVI file writer on top of FatFs.
+ */
+
+#ifndef _AVI_WRITER_H_
+#define _AVI_WRITER_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "fatfs/src/ff.h"
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief AVI index entry ("idx1" chunk) */
+struct _avi_index_entry {
+	uint32_t offset; /**< Offset of the frame chunk from the "movi" list */
+	uint32_t size;   /**< Size of the frame data */
+};
+
+/** \brief AVI writer instance */
+struct _avi_writer {
+	FIL file;
+	uint16_t width;
+	uint16_t height;
+	uint32_t fps;
+	uint32_t frames;          /**< Number of frames written */
+	uint32_t max_frame_size;  /**< Largest frame written */
+	uint32_t movi_start;      /**< File offset of the "movi" list data */
+	uint32_t movi_size;       /**< Size of the "movi" list data */
+	/** Optional index storage (the index is not written if too small) */
+	struct _avi_index_entry* index;
+	uint32_t index_size;
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Create an AVI file and write its headers.
+ * \param avi  Pointer to the writer instance.
+ * \param path  File path.
+ * \param width  Frame width in pixels.
+ * \param height  Frame height in pixels.
+ * \param fps  Frame rate.
+ * \param index  Storage for the frame index (one entry per frame), or NULL
+ * to write a file without index.
+ * \param index_size  Number of entries of the index storage.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT avi_writer_open(struct _avi_writer* avi, const TCHAR* path,
+		uint16_t width, uint16_t height, uint32_t fps,
+		struct _avi_index_entry* index, uint32_t index_size);
+
+/**
+ * \brief Append a JPEG frame to the AVI file.
+ * \param avi  Pointer to the writer instance.
+ * \param jpeg  Pointer to the JPEG image.
+ * \param size  Size of the JPEG image in bytes.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT avi_writer_add_frame(struct _avi_writer* avi,
+		const void* jpeg, uint32_t size);
+
+/**
+ * \brief Write the index, update the headers and close the AVI file.
+ * \param avi  Pointer to the writer instance.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT avi_writer_close(struct _avi_writer* avi);
+
+#endif /* _AVI_WRITER_H_ */
@@ -0,0 +1,600 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Baseline JPEG encoder (ITU-T T.81) for YUV 4:2:2 frames.
+ *
+ * The encoder works on 16x8 pixel MCUs made of two luminance blocks and one
+ * block for each chrominance component, so the packed 4:2:2 samples coming
+ * from the ISC/ISI DMA can be used directly, without color conversion or
+ * chroma subsampling.
+ *
+ * The forward DCT is the integer "slow but accurate" LL&M algorithm. The
+ * Cortex-A5 has no hardware divider, so quantization multiplies by
+ * reciprocals computed once per quality setting. Huffman coding uses the
+ * typical tables of Annex K.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "mjpeg/jpeg_encoder.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define CONST_BITS  13
+#define PASS1_BITS  2
+
+#define FIX_0_298631336  2446
+#define FIX_0_390180644  3196
+#define FIX_0_541196100  4433
+#define FIX_0_765366865  6270
+#define FIX_0_899976223  7373
+#define FIX_1_175875602  9633
+#define FIX_1_501321110  12299
+#define FIX_1_847759065  15137
+#define FIX_1_961570560  16069
+#define FIX_2_053119869  16819
+#define FIX_2_562915447  20995
+#define FIX_3_072711026  25172
+
+#define DESCALE(x, n)  (((x) + (1 << ((n) - 1))) >> (n))
+
+/** Number of fractional bits of quantization reciprocals */
+#define RECIP_BITS 16
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+/** Zigzag index to natural order index */
+static const uint8_t _zigzag[64] = {
+	 0,  1,  8, 16,  9,  2,  3, 10,
+	17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34,
+	27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36,
+	29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46,
+	53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+/** Annex K.1 quantization tables (natural order) */
+static const uint8_t _std_qt[2][64] = {
+	{
+		16, 11, 10, 16,  24,  40,  51,  61,
+		12, 12, 14, 19,  26,  58,  60,  55,
+		14, 13, 16, 24,  40,  57,  69,  56,
+		14, 17, 22, 29,  51,  87,  80,  62,
+		18, 22, 37, 56,  68, 109, 103,  77,
+		24, 35, 55, 64,  81, 104, 113,  92,
+		49, 64, 78, 87, 103, 121, 120, 101,
+		72, 92, 95, 98, 112, 100, 103,  99,
+	}, {
+		17, 18, 24, 47, 99, 99, 99, 99,
+		18, 21, 26, 66, 99, 99, 99, 99,
+		24, 26, 56, 99, 99, 99, 99, 99,
+		47, 66, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+	},
+};
+
+/** Annex K.3 Huffman tables: number of codes of each length */
+static const uint8_t _dc_bits[2][16] = {
+	{ 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 },
+};
+
+static const uint8_t _dc_vals[12] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+};
+
+static const uint8_t _ac_bits[2][16] = {
+	{ 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d },
+	{ 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 },
+};
+
+static const uint8_t _ac_vals[2][162] = {
+	{
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12,
+		0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+		0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+		0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16,
+		0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+		0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+		0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+		0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+		0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98,
+		0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+		0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+		0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+		0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4,
+		0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+		0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+		0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa,
+	}, {
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21,
+		0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+		0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+		0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+		0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34,
+		0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+		0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38,
+		0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+		0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+		0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+		0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96,
+		0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+		0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+		0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+		0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2,
+		0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+		0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9,
+		0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa,
+	},
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Huffman codes and code lengths, indexed by symbol */
+static struct {
+	uint16_t dc_code[2][12];
+	uint8_t dc_size[2][12];
+	uint16_t ac_code[2][256];
+	uint8_t ac_size[2][256];
+	bool ready;
+} _huff;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _build_huffman(const uint8_t* bits, const uint8_t* vals,
+		uint16_t* codes, uint8_t* sizes)
+{
+	uint16_t code = 0;
+	int len, i, k = 0;
+
+	for (len = 1; len <= 16; len++) {
+		for (i = 0; i < bits[len - 1]; i++) {
+			codes[vals[k]] = code++;
+			sizes[vals[k]] = len;
+			k++;
+		}
+		code <<= 1;
+	}
+}
+
+static void _init_huffman(void)
+{
+	int t;
+
+	if (_huff.ready)
+		return;
+
+	for (t = 0; t < 2; t++) {
+		_build_huffman(_dc_bits[t], _dc_vals,
+				_huff.dc_code[t], _huff.dc_size[t]);
+		_build_huffman(_ac_bits[t], _ac_vals[t],
+				_huff.ac_code[t], _huff.ac_size[t]);
+	}
+	_huff.ready = true;
+}
+
+static void _put_byte(struct _jpeg_encoder* enc, uint8_t value)
+{
+	if (enc->out_len < enc->out_size)
+		enc->out[enc->out_len++] = value;
+	else
+		enc->overflow = true;
+}
+
+static void _put_word(struct _jpeg_encoder* enc, uint16_t value)
+{
+	_put_byte(enc, value >> 8);
+	_put_byte(enc, value & 0xff);
+}
+
+static void _put_bits(struct _jpeg_encoder* enc, uint32_t code, int size)
+{
+	enc->bit_buf = (enc->bit_buf << size) | (code & ((1u << size) - 1));
+	enc->bit_cnt += size;
+
+	while (enc->bit_cnt >= 8) {
+		uint8_t c = (enc->bit_buf >> (enc->bit_cnt - 8)) & 0xff;
+		_put_byte(enc, c);
+		/* byte stuffing */
+		if (c == 0xff)
+			_put_byte(enc, 0);
+		enc->bit_cnt -= 8;
+	}
+}
+
+static void _flush_bits(struct _jpeg_encoder* enc)
+{
+	/* pad with 1 bits */
+	if (enc->bit_cnt > 0)
+		_put_bits(enc, 0x7f, 8 - enc->bit_cnt);
+	enc->bit_buf = 0;
+	enc->bit_cnt = 0;
+}
+
+static void _write_headers(struct _jpeg_encoder* enc)
+{
+	static const uint8_t jfif[] = {
+		'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0,
+	};
+	int t, i, count;
+
+	/* SOI + APP0 */
+	_put_word(enc, 0xffd8);
+	_put_word(enc, 0xffe0);
+	_put_word(enc, 2 + sizeof(jfif));
+	for (i = 0; i < (int)sizeof(jfif); i++)
+		_put_byte(enc, jfif[i]);
+
+	/* DQT */
+	_put_word(enc, 0xffdb);
+	_put_word(enc, 2 + 2 * 65);
+	for (t = 0; t < 2; t++) {
+		_put_byte(enc, t);
+		for (i = 0; i < 64; i++)
+			_put_byte(enc, enc->qt[t][i]);
+	}
+
+	/* SOF0: Y is 2x1 sampled, Cb and Cr are 1x1 */
+	_put_word(enc, 0xffc0);
+	_put_word(enc, 8 + 3 * 3);
+	_put_byte(enc, 8);
+	_put_word(enc, enc->height);
+	_put_word(enc, enc->width);
+	_put_byte(enc, 3);
+	_put_byte(enc, 1); _put_byte(enc, 0x21); _put_byte(enc, 0);
+	_put_byte(enc, 2); _put_byte(enc, 0x11); _put_byte(enc, 1);
+	_put_byte(enc, 3); _put_byte(enc, 0x11); _put_byte(enc, 1);
+
+	/* DHT: DC and AC tables for luminance and chrominance */
+	_put_word(enc, 0xffc4);
+	_put_word(enc, 2 + 2 * (17 + 12) + 2 * (17 + 162));
+	for (t = 0; t < 2; t++) {
+		_put_byte(enc, 0x00 | t);
+		for (i = 0, count = 0; i < 16; i++) {
+			_put_byte(enc, _dc_bits[t][i]);
+			count += _dc_bits[t][i];
+		}
+		for (i = 0; i < count; i++)
+			_put_byte(enc, _dc_vals[i]);
+
+		_put_byte(enc, 0x10 | t);
+		for (i = 0, count = 0; i < 16; i++) {
+			_put_byte(enc, _ac_bits[t][i]);
+			count += _ac_bits[t][i];
+		}
+		for (i = 0; i < count; i++)
+			_put_byte(enc, _ac_vals[t][i]);
+	}
+
+	/* SOS */
+	_put_word(enc, 0xffda);
+	_put_word(enc, 6 + 2 * 3);
+	_put_byte(enc, 3);
+	_put_byte(enc, 1); _put_byte(enc, 0x00);
+	_put_byte(enc, 2); _put_byte(enc, 0x11);
+	_put_byte(enc, 3); _put_byte(enc, 0x11);
+	_put_byte(enc, 0);
+	_put_byte(enc, 63);
+	_put_byte(enc, 0);
+}
+
+/**
+ * \brief Forward DCT on an 8x8 block of level-shifted samples. Output
+ * coefficients are scaled up by a factor of 8.
+ */
+static void _fdct(int32_t* data)
+{
+	int32_t tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+	int32_t tmp10, tmp11, tmp12, tmp13;
+	int32_t z1, z2, z3, z4, z5;
+	int32_t* p;
+	int i;
+
+	/* Pass 1: process rows */
+	for (i = 0, p = data; i < 8; i++, p += 8) {
+		tmp0 = p[0] + p[7];
+		tmp7 = p[0] - p[7];
+		tmp1 = p[1] + p[6];
+		tmp6 = p[1] - p[6];
+		tmp2 = p[2] + p[5];
+		tmp5 = p[2] - p[5];
+		tmp3 = p[3] + p[4];
+		tmp4 = p[3] - p[4];
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		p[0] = (tmp10 + tmp11) << PASS1_BITS;
+		p[4] = (tmp10 - tmp11) << PASS1_BITS;
+
+		z1 = (tmp12 + tmp13) * FIX_0_541196100;
+		p[2] = DESCALE(z1 + tmp13 * FIX_0_765366865, CONST_BITS - PASS1_BITS);
+		p[6] = DESCALE(z1 - tmp12 * FIX_1_847759065, CONST_BITS - PASS1_BITS);
+
+		z1 = tmp4 + tmp7;
+		z2 = tmp5 + tmp6;
+		z3 = tmp4 + tmp6;
+		z4 = tmp5 + tmp7;
+		z5 = (z3 + z4) * FIX_1_175875602;
+
+		tmp4 *= FIX_0_298631336;
+		tmp5 *= FIX_2_053119869;
+		tmp6 *= FIX_3_072711026;
+		tmp7 *= FIX_1_501321110;
+		z1 *= -FIX_0_899976223;
+		z2 *= -FIX_2_562915447;
+		z3 = z3 * -FIX_1_961570560 + z5;
+		z4 = z4 * -FIX_0_390180644 + z5;
+
+		p[7] = DESCALE(tmp4 + z1 + z3, CONST_BITS - PASS1_BITS);
+		p[5] = DESCALE(tmp5 + z2 + z4, CONST_BITS - PASS1_BITS);
+		p[3] = DESCALE(tmp6 + z2 + z3, CONST_BITS - PASS1_BITS);
+		p[1] = DESCALE(tmp7 + z1 + z4, CONST_BITS - PASS1_BITS);
+	}
+
+	/* Pass 2: process columns */
+	for (i = 0, p = data; i < 8; i++, p++) {
+		tmp0 = p[8 * 0] + p[8 * 7];
+		tmp7 = p[8 * 0] - p[8 * 7];
+		tmp1 = p[8 * 1] + p[8 * 6];
+		tmp6 = p[8 * 1] - p[8 * 6];
+		tmp2 = p[8 * 2] + p[8 * 5];
+		tmp5 = p[8 * 2] - p[8 * 5];
+		tmp3 = p[8 * 3] + p[8 * 4];
+		tmp4 = p[8 * 3] - p[8 * 4];
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		p[8 * 0] = DESCALE(tmp10 + tmp11, PASS1_BITS);
+		p[8 * 4] = DESCALE(tmp10 - tmp11, PASS1_BITS);
+
+		z1 = (tmp12 + tmp13) * FIX_0_541196100;
+		p[8 * 2] = DESCALE(z1 + tmp13 * FIX_0_765366865, CONST_BITS + PASS1_BITS);
+		p[8 * 6] = DESCALE(z1 - tmp12 * FIX_1_847759065, CONST_BITS + PASS1_BITS);
+
+		z1 = tmp4 + tmp7;
+		z2 = tmp5 + tmp6;
+		z3 = tmp4 + tmp6;
+		z4 = tmp5 + tmp7;
+		z5 = (z3 + z4) * FIX_1_175875602;
+
+		tmp4 *= FIX_0_298631336;
+		tmp5 *= FIX_2_053119869;
+		tmp6 *= FIX_3_072711026;
+		tmp7 *= FIX_1_501321110;
+		z1 *= -FIX_0_899976223;
+		z2 *= -FIX_2_562915447;
+		z3 = z3 * -FIX_1_961570560 + z5;
+		z4 = z4 * -FIX_0_390180644 + z5;
+
+		p[8 * 7] = DESCALE(tmp4 + z1 + z3, CONST_BITS + PASS1_BITS);
+		p[8 * 5] = DESCALE(tmp5 + z2 + z4, CONST_BITS + PASS1_BITS);
+		p[8 * 3] = DESCALE(tmp6 + z2 + z3, CONST_BITS + PASS1_BITS);
+		p[8 * 1] = DESCALE(tmp7 + z1 + z4, CONST_BITS + PASS1_BITS);
+	}
+}
+
+static void _encode_block(struct _jpeg_encoder* enc, int32_t* block,
+		int comp)
+{
+	const int t = comp ? 1 : 0;
+	const uint16_t* recip = enc->qt_recip[t];
+	int32_t coef[64];
+	int32_t diff, value;
+	int i, run, nbits;
+	uint32_t mag;
+
+	_fdct(block);
+
+	/* quantize, in zigzag order */
+	for (i = 0; i < 64; i++) {
+		value = block[_zigzag[i]];
+		if (value < 0)
+			coef[i] = -(int32_t)(((uint32_t)-value * recip[_zigzag[i]] + (1u << (RECIP_BITS - 1))) >> RECIP_BITS);
+		else
+			coef[i] = (int32_t)(((uint32_t)value * recip[_zigzag[i]] + (1u << (RECIP_BITS - 1))) >> RECIP_BITS);
+	}
+
+	/* DC coefficient */
+	diff = coef[0] - enc->dc_pred[comp];
+	enc->dc_pred[comp] = coef[0];
+	mag = diff < 0 ? -diff : diff;
+	for (nbits = 0; mag; mag >>= 1)
+		nbits++;
+	_put_bits(enc, _huff.dc_code[t][nbits], _huff.dc_size[t][nbits]);
+	if (nbits)
+		_put_bits(enc, diff < 0 ? diff - 1 : diff, nbits);
+
+	/* AC coefficients */
+	run = 0;
+	for (i = 1; i < 64; i++) {
+		value = coef[i];
+		/* baseline AC coefficients are limited to 10 bits */
+		if (value > 1023)
+			value = 1023;
+		else if (value < -1023)
+			value = -1023;
+		if (value == 0) {
+			run++;
+			continue;
+		}
+		while (run > 15) {
+			/* ZRL */
+			_put_bits(enc, _huff.ac_code[t][0xf0], _huff.ac_size[t][0xf0]);
+			run -= 16;
+		}
+		mag = value < 0 ? -value : value;
+		for (nbits = 0; mag; mag >>= 1)
+			nbits++;
+		_put_bits(enc, _huff.ac_code[t][(run << 4) | nbits],
+				_huff.ac_size[t][(run << 4) | nbits]);
+		_put_bits(enc, value < 0 ? value - 1 : value, nbits);
+		run = 0;
+	}
+	if (run) {
+		/* EOB */
+		_put_bits(enc, _huff.ac_code[t][0x00], _huff.ac_size[t][0x00]);
+	}
+}
+
+/**
+ * \brief Load a 16x8 MCU from packed 4:2:2 samples into level-shifted
+ * blocks (Y0, Y1, Cb, Cr). Samples outside of the image replicate the last
+ * column/line.
+ */
+static void _load_mcu(const struct _jpeg_encoder* enc, const uint8_t* src,
+		uint32_t stride, int x0, int y0, int32_t blocks[4][64])
+{
+	const int y_off = enc->input_format == JPEG_INPUT_UYVY ? 1 : 0;
+	const int c_off = 1 - y_off;
+	int x, y;
+
+	for (y = 0; y < 8; y++) {
+		int sy = y0 + y < enc->height ? y0 + y : enc->height - 1;
+		const uint8_t* line = src + sy * stride;
+
+		for (x = 0; x < 16; x += 2) {
+			int sx = x0 + x < enc->width ? x0 + x : (enc->width - 2) & ~1;
+			const uint8_t* pair = line + sx * 2;
+			int32_t* yb = blocks[x >> 3] + y * 8 + (x & 7);
+
+			yb[0] = pair[y_off] - 128;
+			yb[1] = pair[y_off + 2] - 128;
+			blocks[2][y * 8 + (x >> 1)] = pair[c_off] - 128;
+			blocks[3][y * 8 + (x >> 1)] = pair[c_off + 2] - 128;
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void jpeg_encoder_init(struct _jpeg_encoder* enc, uint16_t width,
+		uint16_t height, uint8_t input_format, uint8_t quality)
+{
+	uint32_t scale, q;
+	int t, i;
+
+	memset(enc, 0, sizeof(*enc));
+	enc->width = width;
+	enc->height = height;
+	enc->input_format = input_format;
+
+	if (quality < 1)
+		quality = 1;
+	if (quality > 100)
+		quality = 100;
+	enc->quality = quality;
+
+	/* IJG quality scaling */
+	scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+
+	for (t = 0; t < 2; t++) {
+		for (i = 0; i < 64; i++) {
+			q = (_std_qt[t][_zigzag[i]] * scale + 50) / 100;
+			if (q < 1)
+				q = 1;
+			if (q > 255)
+				q = 255;
+			enc->qt[t][i] = q;
+			/* the DCT output is scaled by 8 */
+			enc->qt_recip[t][_zigzag[i]] = ((1u << RECIP_BITS) + 4 * q) / (8 * q);
+		}
+	}
+
+	_init_huffman();
+}
+
+uint32_t jpeg_encode_frame(struct _jpeg_encoder* enc, const uint8_t* src,
+		uint32_t stride, uint8_t* out, uint32_t out_size)
+{
+	int32_t blocks[4][64];
+	int x, y;
+
+	enc->out = out;
+	enc->out_size = out_size;
+	enc->out_len = 0;
+	enc->bit_buf = 0;
+	enc->bit_cnt = 0;
+	enc->dc_pred[0] = enc->dc_pred[1] = enc->dc_pred[2] = 0;
+	enc->overflow = false;
+
+	_write_headers(enc);
+
+	for (y = 0; y < enc->height; y += 8) {
+		for (x = 0; x < enc->width; x += 16) {
+			_load_mcu(enc, src, stride, x, y, blocks);
+			_encode_block(enc, blocks[0], 0);
+			_encode_block(enc, blocks[1], 0);
+			_encode_block(enc, blocks[2], 1);
+			_encode_block(enc, blocks[3], 2);
+			if (enc->overflow)
+				return 0;
+		}
+	}
+
+	_flush_bits(enc);
+	_put_word(enc, 0xffd9);
+
+	return enc->overflow ? 0 : enc->out_len;
+}
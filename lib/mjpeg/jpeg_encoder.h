@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Baseline JPEG encoder for YUV 4:2:2 camera frames.
+ *
+ * The encoder only depends on the C library so that it can be built and
+ * tested on a host computer against libjpeg, see
+ * tests/host/test_jpeg_encoder.c.
+ */
+
+#ifndef _JPEG_ENCODER_H_
+#define _JPEG_ENCODER_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Packed YUV 4:2:2 input, byte order Y0 U Y1 V (ISC, ISI preview path) */
+#define JPEG_INPUT_YUYV  0
+/** Packed YUV 4:2:2 input, byte order U Y0 V Y1 */
+#define JPEG_INPUT_UYVY  1
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief JPEG encoder instance */
+struct _jpeg_encoder {
+	uint16_t width;          /**< Image width in pixels */
+	uint16_t height;         /**< Image height in pixels */
+	uint8_t input_format;    /**< JPEG_INPUT_YUYV or JPEG_INPUT_UYVY */
+	uint8_t quality;         /**< Quality factor (1..100) */
+
+	/** Quantization tables (zigzag order, as stored in the DQT marker) */
+	uint8_t qt[2][64];
+	/** Quantization reciprocals (natural order, 16-bit fixed point) */
+	uint16_t qt_recip[2][64];
+
+	/* Output state */
+	uint8_t* out;
+	uint32_t out_size;
+	uint32_t out_len;
+	uint32_t bit_buf;
+	int bit_cnt;
+	int16_t dc_pred[3];
+	bool overflow;
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a JPEG encoder instance.
+ * \param enc  Pointer to the encoder instance.
+ * \param width  Image width in pixels (multiple of 16 for best results).
+ * \param height  Image height in pixels (multiple of 8 for best results).
+ * \param input_format  JPEG_INPUT_YUYV or JPEG_INPUT_UYVY.
+ * \param quality  Quality factor (1..100, 75 is a good default).
+ */
+extern void jpeg_encoder_init(struct _jpeg_encoder* enc, uint16_t width,
+		uint16_t height, uint8_t input_format, uint8_t quality);
+
+/**
+ * \brief Encode a YUV 4:2:2 frame into a baseline JFIF image.
+ * \param enc  Pointer to the encoder instance.
+ * \param src  Pointer to the first pixel of the frame.
+ * \param stride  Distance between two lines of the frame, in bytes.
+ * \param out  Destination buffer.
+ * \param out_size  Size of the destination buffer, in bytes.
+ * \return Size of the JPEG image in bytes, or 0 if the destination buffer
+ * is too small.
+ */
+extern uint32_t jpeg_encode_frame(struct _jpeg_encoder* enc,
+		const uint8_t* src, uint32_t stride, uint8_t* out,
+		uint32_t out_size);
+
+#endif /* _JPEG_ENCODER_H_ */
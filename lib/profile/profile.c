@@ -0,0 +1,474 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Cycle-accurate profiling on the Cortex-A5 PMU and the L2CC event counters.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "compiler.h"
+#include "core/arm_cp15_pmu.h"
+#include "peripherals/aic.h"
+#ifdef CONFIG_HAVE_L2CC
+#include "peripherals/l2cc.h"
+#endif
+
+#include "profile/profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#ifdef ID_ARM_PMU
+#define ID_PMU ID_ARM_PMU
+#else
+#define ID_PMU ID_ARM
+#endif
+
+/** Counters sampled at scope boundaries */
+enum {
+	COUNTER_CYCLES,
+	COUNTER_CACHE_MISSES,
+	COUNTER_TLB_MISSES,
+	COUNTER_L2_HITS,
+	COUNTER_COUNT,
+};
+
+/** Event counter used for cache misses */
+#define PMU_CACHE_COUNTER 0
+
+/** Event counter used for TLB misses, or for sampling */
+#define PMU_TLB_COUNTER   1
+
+/** Interrupted PC in the frame pushed by irqHandler on the IRQ stack:
+ * {r0, spsr, lr_irq - 4} */
+#define IRQ_FRAME_PC      2
+
+#define LINE_LENGTH       112
+
+/*----------------------------------------------------------------------------
+ *         Local types
+ *----------------------------------------------------------------------------*/
+
+struct _profile_frame {
+	uint8_t scope;
+	uint32_t start[COUNTER_COUNT];
+	uint32_t nested;    /* cycles of the nested scopes */
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct _profile_scope _scopes[PROFILE_MAX_SCOPES];
+static uint32_t _scope_count;
+
+static struct _profile_frame _stack[PROFILE_MAX_DEPTH];
+static uint32_t _depth;
+
+static uint32_t _errors;
+
+/** Cycles spent reading the counters, removed from each call */
+static uint32_t _overhead;
+
+static struct {
+	volatile bool running;
+	uint32_t period;
+	uint32_t start;
+	uint32_t end;
+	uint32_t shift;
+	uint32_t* buckets;
+	uint32_t count;
+	uint32_t total;
+	uint32_t outside;   /* samples out of the code range */
+	uint32_t unscoped;  /* samples out of any scope */
+} _sampling;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _read_counters(uint32_t* values)
+{
+	values[COUNTER_CYCLES] = cp15_get_cycle_counter();
+	values[COUNTER_CACHE_MISSES] = cp15_pmu_get_event_count(PMU_CACHE_COUNTER);
+	values[COUNTER_TLB_MISSES] = _sampling.running ? 0 :
+		cp15_pmu_get_event_count(PMU_TLB_COUNTER);
+#ifdef CONFIG_HAVE_L2CC
+	values[COUNTER_L2_HITS] = l2cc_is_enabled() ?
+		l2cc_event_counter_value(0) + l2cc_event_counter_value(1) : 0;
+#else
+	values[COUNTER_L2_HITS] = 0;
+#endif
+}
+
+static uint8_t _register_scope(const char* name)
+{
+	uint32_t i;
+
+	/* the same name may be used at several places */
+	for (i = 0; i < _scope_count; i++)
+		if (!strcmp(_scopes[i].name, name))
+			return i;
+
+	if (_scope_count >= PROFILE_MAX_SCOPES) {
+		_errors++;
+		return PROFILE_SCOPE_NONE;
+	}
+	_scopes[_scope_count].name = name;
+	_scopes[_scope_count].min = UINT32_MAX;
+	return _scope_count++;
+}
+
+static void _close_frame(const struct _profile_frame* frame,
+		const uint32_t* now)
+{
+	struct _profile_scope* scope = &_scopes[frame->scope];
+	uint32_t cycles = now[COUNTER_CYCLES] - frame->start[COUNTER_CYCLES];
+	uint32_t self;
+
+	cycles = cycles > _overhead ? cycles - _overhead : 0;
+	self = cycles > frame->nested ? cycles - frame->nested : 0;
+
+	scope->count++;
+	scope->cycles += cycles;
+	scope->self += self;
+	if (cycles < scope->min)
+		scope->min = cycles;
+	if (cycles > scope->max)
+		scope->max = cycles;
+	scope->cache_misses += now[COUNTER_CACHE_MISSES] -
+		frame->start[COUNTER_CACHE_MISSES];
+	scope->tlb_misses += now[COUNTER_TLB_MISSES] -
+		frame->start[COUNTER_TLB_MISSES];
+	scope->l2_hits += now[COUNTER_L2_HITS] -
+		frame->start[COUNTER_L2_HITS];
+
+	/* the enclosing scope does not own these cycles */
+	if (_depth > 0)
+		_stack[_depth - 1].nested += cycles + _overhead;
+}
+
+/**
+ * \brief Return the PC interrupted by the current IRQ.
+ *
+ * Relies on the frame pushed on the IRQ mode stack by irqHandler in
+ * cstartup.S; the handler itself runs in SVC mode.
+ */
+static uint32_t _get_interrupted_pc(void)
+{
+	uint32_t sp_irq, cpsr;
+
+	asm volatile(
+		"mrs     %1, cpsr\n\t"
+		"cps     #0x12\n\t"
+		"mov     %0, sp\n\t"
+		"msr     cpsr_c, %1"
+		: "=r"(sp_irq), "=&r"(cpsr) : : "memory");
+	return ((uint32_t*)sp_irq)[IRQ_FRAME_PC];
+}
+
+static void _pmu_handler(void)
+{
+	uint32_t overflow = cp15_pmu_get_overflow();
+	uint32_t pc, state;
+
+	if (_sampling.running &&
+	    (overflow & CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER))) {
+		cp15_pmu_set_event_count(PMU_TLB_COUNTER, -_sampling.period);
+
+		state = irq_save();
+		pc = _get_interrupted_pc();
+		irq_restore(state);
+
+		_sampling.total++;
+		if (pc >= _sampling.start && pc < _sampling.end)
+			_sampling.buckets[(pc - _sampling.start) >> _sampling.shift]++;
+		else
+			_sampling.outside++;
+		if (_depth > 0)
+			_scopes[_stack[_depth - 1].scope].samples++;
+		else
+			_sampling.unscoped++;
+	}
+	cp15_pmu_clear_overflow(overflow);
+}
+
+static void _output(profile_output_t output, void* arg, const char* line)
+{
+	if (output)
+		output(arg, line);
+	else
+		printf("%s\r\n", line);
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void profile_initialize(void)
+{
+	uint32_t before[COUNTER_COUNT], after[COUNTER_COUNT];
+	uint32_t i, cycles;
+
+	profile_stop_sampling();
+
+	cp15_pmu_enable();
+	cp15_pmu_set_event(PMU_CACHE_COUNTER, L1_DC_FILL);
+	cp15_pmu_set_event(PMU_TLB_COUNTER, L1_DTLB_FILL);
+	cp15_pmu_start(CP15_PMU_CYCLE_COUNTER |
+			CP15_PMU_EVENT_COUNTER(PMU_CACHE_COUNTER) |
+			CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER));
+
+	memset(_scopes, 0, sizeof(_scopes));
+	_scope_count = 0;
+	_depth = 0;
+	_errors = 0;
+
+	/* smallest cost of reading the counters twice */
+	_overhead = UINT32_MAX;
+	for (i = 0; i < 16; i++) {
+		_read_counters(before);
+		_read_counters(after);
+		cycles = after[COUNTER_CYCLES] - before[COUNTER_CYCLES];
+		if (cycles < _overhead)
+			_overhead = cycles;
+	}
+}
+
+void profile_reset(void)
+{
+	uint32_t i, state = irq_save();
+
+	for (i = 0; i < _scope_count; i++) {
+		const char* name = _scopes[i].name;
+		memset(&_scopes[i], 0, sizeof(_scopes[i]));
+		_scopes[i].name = name;
+		_scopes[i].min = UINT32_MAX;
+	}
+	_errors = 0;
+	irq_restore(state);
+}
+
+void profile_begin(uint8_t* id, const char* name)
+{
+	struct _profile_frame* frame;
+	uint32_t state = irq_save();
+
+	if (*id == PROFILE_SCOPE_NONE)
+		*id = _register_scope(name);
+	if (*id == PROFILE_SCOPE_NONE || _depth >= PROFILE_MAX_DEPTH) {
+		/* profile_end() will not find the scope on the stack */
+		if (*id != PROFILE_SCOPE_NONE)
+			_errors++;
+		irq_restore(state);
+		return;
+	}
+
+	frame = &_stack[_depth++];
+	frame->scope = *id;
+	frame->nested = 0;
+	/* read last so that the bookkeeping is not measured */
+	_read_counters(frame->start);
+	irq_restore(state);
+}
+
+void profile_end(uint8_t id)
+{
+	uint32_t now[COUNTER_COUNT];
+	uint32_t i, state;
+
+	_read_counters(now);
+	if (id == PROFILE_SCOPE_NONE)
+		return;
+
+	state = irq_save();
+	for (i = _depth; i > 0; i--)
+		if (_stack[i - 1].scope == id)
+			break;
+	if (i == 0) {
+		/* not open (stack was full) */
+		irq_restore(state);
+		return;
+	}
+
+	/* close the scopes left open inside this one */
+	while (_depth > i) {
+		_errors++;
+		_depth--;
+		_close_frame(&_stack[_depth], now);
+	}
+	_depth--;
+	_close_frame(&_stack[_depth], now);
+	irq_restore(state);
+}
+
+uint32_t profile_get_scope_count(void)
+{
+	return _scope_count;
+}
+
+const struct _profile_scope* profile_get_scope(uint32_t index)
+{
+	if (index >= _scope_count)
+		return NULL;
+	return &_scopes[index];
+}
+
+uint32_t profile_get_errors(void)
+{
+	return _errors;
+}
+
+void profile_start_sampling(uint32_t period, uint32_t start, uint32_t end,
+		uint32_t* buckets, uint32_t count)
+{
+	uint32_t shift = 2;
+
+	profile_stop_sampling();
+
+	while (((end - start + (1u << shift) - 1) >> shift) > count)
+		shift++;
+
+	memset(buckets, 0, count * sizeof(*buckets));
+	_sampling.period = period;
+	_sampling.start = start;
+	_sampling.end = end;
+	_sampling.shift = shift;
+	_sampling.buckets = buckets;
+	_sampling.count = count;
+	_sampling.total = 0;
+	_sampling.outside = 0;
+	_sampling.unscoped = 0;
+
+	cp15_pmu_set_event(PMU_TLB_COUNTER, CycleCount);
+	cp15_pmu_set_event_count(PMU_TLB_COUNTER, -period);
+	cp15_pmu_clear_overflow(CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER));
+	_sampling.running = true;
+
+	aic_set_source_vector(ID_PMU, _pmu_handler);
+	aic_enable(ID_PMU);
+	cp15_pmu_enable_it(CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER));
+}
+
+void profile_stop_sampling(void)
+{
+	if (!_sampling.running)
+		return;
+
+	cp15_pmu_disable_it(CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER));
+	aic_disable(ID_PMU);
+	_sampling.running = false;
+
+	/* back to counting TLB misses */
+	cp15_pmu_set_event(PMU_TLB_COUNTER, L1_DTLB_FILL);
+	cp15_pmu_clear_overflow(CP15_PMU_EVENT_COUNTER(PMU_TLB_COUNTER));
+}
+
+void profile_dump(profile_output_t output, void* arg)
+{
+	char line[LINE_LENGTH];
+	uint32_t i;
+
+	_output(output, arg, "scope                count   avg cyc   min cyc"
+			"   max cyc  self%  l1d/call  tlb/call   l2/call  samples");
+	for (i = 0; i < _scope_count; i++) {
+		const struct _profile_scope* s = &_scopes[i];
+		uint32_t count = s->count ? s->count : 1;
+
+		snprintf(line, sizeof(line),
+			"%-18.18s %7u %9u %9u %9u %5u%% %9u %9u %9u %8u",
+			s->name, (unsigned)s->count,
+			(unsigned)(s->cycles / count),
+			(unsigned)(s->count ? s->min : 0),
+			(unsigned)s->max,
+			(unsigned)(s->cycles ? (s->self * 100) / s->cycles : 0),
+			(unsigned)(s->cache_misses / count),
+			(unsigned)(s->tlb_misses / count),
+			(unsigned)(s->l2_hits / count),
+			(unsigned)s->samples);
+		_output(output, arg, line);
+	}
+	snprintf(line, sizeof(line), "errors %u, overhead %u cycles",
+			(unsigned)_errors, (unsigned)_overhead);
+	_output(output, arg, line);
+}
+
+void profile_dump_samples(profile_output_t output, void* arg, uint32_t top)
+{
+	char line[LINE_LENGTH];
+	uint32_t i, n, best, last;
+	uint32_t last_index = 0;
+	uint32_t total = _sampling.total ? _sampling.total : 1;
+
+	snprintf(line, sizeof(line),
+		"%u samples, %u outside code range, %u outside scopes",
+		(unsigned)_sampling.total, (unsigned)_sampling.outside,
+		(unsigned)_sampling.unscoped);
+	_output(output, arg, line);
+	if (!_sampling.buckets)
+		return;
+
+	/* selection of the hottest buckets, in decreasing order; equal counts
+	 * are listed by increasing address */
+	last = UINT32_MAX;
+	for (n = 0; n < top; n++) {
+		uint32_t index = 0;
+
+		best = 0;
+		for (i = 0; i < _sampling.count; i++) {
+			uint32_t v = _sampling.buckets[i];
+			if (v > last || (v == last && i <= last_index))
+				continue;
+			if (v > best) {
+				best = v;
+				index = i;
+			}
+		}
+		if (best == 0)
+			break;
+
+		snprintf(line, sizeof(line), "0x%08x-0x%08x %8u %3u%%",
+			(unsigned)(_sampling.start + (index << _sampling.shift)),
+			(unsigned)(_sampling.start + ((index + 1) << _sampling.shift) - 1),
+			(unsigned)best, (unsigned)((best * 100ull) / total));
+		_output(output, arg, line);
+		last = best;
+		last_index = index;
+	}
+}
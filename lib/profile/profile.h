@@ -0,0 +1,200 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Cycle-accurate profiling on the Cortex-A5 PMU and the L2CC event counters.
+ *
+ * Code is instrumented with named scopes:
+ * \code
+ *	PROFILE_BEGIN(decode);
+ *	...
+ *	PROFILE_END(decode);
+ * \endcode
+ * Each scope records, per call, the CPU cycles (PMCCNTR), the L1 data cache
+ * refills (event counter 0), the L1 data TLB refills (event counter 1) and,
+ * when the L2 cache is enabled, the L2 data hits (L2CC event counters 0 and
+ * 1 as set by l2cc_configure()). Scopes may be nested, also from interrupt
+ * handlers: the cycles of nested scopes are accounted as "self" cycles of
+ * the inner scope only. The macros expand to nothing when CONFIG_LIB_PROFILE
+ * is not set, so instrumentation can stay in the code.
+ *
+ * The sampling mode makes event counter 1 count cycles and overflow every
+ * period; the PMU interrupt records the interrupted PC in a histogram of the
+ * code range, giving a flat profile without instrumentation. TLB refills
+ * are not recorded while sampling.
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Size of the scope table */
+#define PROFILE_MAX_SCOPES 32
+
+/** Maximum nesting depth of scopes */
+#define PROFILE_MAX_DEPTH 16
+
+/** Scope identifier of a scope not registered (yet) */
+#define PROFILE_SCOPE_NONE 0xff
+
+#ifdef CONFIG_LIB_PROFILE
+/** Open a named scope, \a tag must be a C identifier */
+#define PROFILE_BEGIN(tag) \
+	static uint8_t _profile_scope_##tag = PROFILE_SCOPE_NONE; \
+	profile_begin(&_profile_scope_##tag, #tag)
+/** Close the scope opened by PROFILE_BEGIN(tag) in the same block */
+#define PROFILE_END(tag) \
+	profile_end(_profile_scope_##tag)
+#else
+#define PROFILE_BEGIN(tag) do {} while (0)
+#define PROFILE_END(tag) do {} while (0)
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief Statistics of a scope */
+struct _profile_scope {
+	const char* name;
+	uint32_t count;        /**< completed calls */
+	uint32_t min;          /**< shortest call, in cycles */
+	uint32_t max;          /**< longest call, in cycles */
+	uint64_t cycles;       /**< total cycles, nested scopes included */
+	uint64_t self;         /**< total cycles, nested scopes excluded */
+	uint64_t cache_misses; /**< L1 data cache refills */
+	uint64_t tlb_misses;   /**< L1 data TLB refills */
+	uint64_t l2_hits;      /**< L2 data read and write hits */
+	uint32_t samples;      /**< samples taken inside the scope */
+};
+
+/** \brief Output function of the dump functions, called once per line */
+typedef void (*profile_output_t)(void* arg, const char* line);
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Enable the PMU counters and clear the scope table.
+ * The measurement overhead of a begin/end pair is calibrated and removed
+ * from the recorded cycles.
+ */
+extern void profile_initialize(void);
+
+/**
+ * \brief Clear the statistics, registered scopes are kept.
+ */
+extern void profile_reset(void);
+
+/**
+ * \brief Open a scope (use PROFILE_BEGIN()).
+ * \param id  Scope identifier, registered on first use.
+ * \param name  Scope name, must stay valid.
+ */
+extern void profile_begin(uint8_t* id, const char* name);
+
+/**
+ * \brief Close a scope (use PROFILE_END()).
+ * Closing a scope that is not the innermost one closes the scopes opened
+ * inside it and counts an error.
+ */
+extern void profile_end(uint8_t id);
+
+/**
+ * \brief Get the number of registered scopes.
+ */
+extern uint32_t profile_get_scope_count(void);
+
+/**
+ * \brief Get the statistics of a scope.
+ * \param index  Scope index, less than profile_get_scope_count().
+ */
+extern const struct _profile_scope* profile_get_scope(uint32_t index);
+
+/**
+ * \brief Get the number of mismatched profile_end() calls and of scopes
+ * dropped because the table or the nesting stack was full.
+ */
+extern uint32_t profile_get_errors(void);
+
+/**
+ * \brief Start sampling the PC every \a period cycles.
+ * \param period  Sampling period in CPU cycles.
+ * \param start  Start address of the code range to sample.
+ * \param end  End address (excluded) of the code range.
+ * \param buckets  Histogram, cleared by this function.
+ * \param count  Number of buckets. Each bucket covers a power of two bytes.
+ */
+extern void profile_start_sampling(uint32_t period, uint32_t start,
+		uint32_t end, uint32_t* buckets, uint32_t count);
+
+/**
+ * \brief Stop sampling, the histogram is kept.
+ */
+extern void profile_stop_sampling(void);
+
+/**
+ * \brief Print the scope table.
+ * \param output  Line output function, NULL for the console.
+ * \param arg  Argument of \a output.
+ */
+extern void profile_dump(profile_output_t output, void* arg);
+
+/**
+ * \brief Print the \a top most sampled code ranges, hottest first.
+ * \param output  Line output function, NULL for the console.
+ * \param arg  Argument of \a output.
+ * \param top  Number of ranges to print.
+ */
+extern void profile_dump_samples(profile_output_t output, void* arg,
+		uint32_t top);
+
+/**
+ * \brief Write the scope table and the flat profile to a file (FatFs
+ * volume must be mounted, requires CONFIG_LIB_FATFS).
+ * \param path  File path, the file is overwritten.
+ * \param top  Number of sampled code ranges to write.
+ * \return 0 on success, a FatFs error code otherwise.
+ */
+extern int profile_dump_to_file(const char* path, uint32_t top);
+
+#endif /* _PROFILE_H_ */
@@ -683,6 +683,44 @@ typedef struct _USBVideoUncompressedFrameDescriptor1 {
 	uint32_t dwFrameInterva[1]; /**< shortest interval, in 100ns ... following are longer */
 } USBVideoUncompressedFrameDescriptor1;
 
+/* USB Video Payload Motion-JPEG, 3.1 */
+/**
+ * Motion-JPEG Video Format Descriptor
+ */
+typedef struct _USBVideoMJPEGFormatDescriptor {
+	uint8_t  bLength; /**< Size of descriptor: 11 bytes */
+	uint8_t  bDescriptorType; /**< CS_INTERFACE descriptor type */
+	uint8_t  bDescriptorSubType; /**< VS_FORMAT_MJPEG descriptor subtype */
+	uint8_t  bFormatIndex; /**< Index of this format descriptor */
+	uint8_t  bNumFrameDescriptors; /**< Number of frame descriptors following */
+	uint8_t  bmFlags; /**< D0: fixed size samples */
+	uint8_t  bDefaultFrameIndex; /**< Optimum Frame Index (used to select resolution) for this stream */
+	uint8_t  bAspectRatioX; /**< The X dimension of the picture aspect ratio */
+	uint8_t  bAspectRatioY; /**< The Y dimension of the picture aspect ratio */
+	uint8_t  bmInterlaceFlags; /**< interlace information */
+	uint8_t  bCopyProtect; /**< Whether duplication of the video stream is restricted */
+} USBVideoMJPEGFormatDescriptor;
+/**
+ * Motion-JPEG Video Frame Descriptor
+ * (with 1 interval setting)
+ */
+typedef struct _USBVideoMJPEGFrameDescriptor1 {
+	uint8_t  bLength; /**< Size of descriptor: 26 + 4*1 bytes */
+	uint8_t  bDescriptorType; /**< CS_INTERFACE descriptor type */
+	uint8_t  bDescriptorSubType; /**< VS_FRAME_MJPEG descriptor subtype */
+	uint8_t  bFrameIndex; /**< Index of this frame descriptor */
+	uint8_t  bmCapabilities; /**< Whether still images are supported */
+	uint16_t wWidth; /**< Width of decoded bitmap frame in pixels */
+	uint16_t wHeight; /**< Height of decoded bitmap frame in pixels */
+	uint32_t dwMinBitRate; /**< Minimum bit rate at the longest frame interval, in bps */
+	uint32_t dwMaxBitRate; /**< Maximum bit rate at the longest frame interval, in bps */
+	uint32_t dwMaxVideoFrameBufferSize; /**< Max number of bytes that the compressor will produce for a video frame or still image */
+	uint32_t dwDefaultFrameInterval; /**< Frame interval the device uses as default */
+	uint8_t  bFrameIntervalType; /**< 1: The number of discrete frame intervals */
+
+	uint32_t dwFrameInterva[1]; /**< shortest interval, in 100ns ... following are longer */
+} USBVideoMJPEGFrameDescriptor1;
+
 /* USB Video, 3.9.2.5, Table 3-17 */
 /**
  * Still Image Frame Descriptor
@@ -86,6 +86,14 @@
 /** Number of Video Frame Types */
 #define VIDCAMD_NumFrameTypes           3
 
+/** Number of Motion-JPEG Video Frame Types (320x240 and 640x480) */
+#define VIDCAMD_NumMJPEGFrameTypes      2
+
+/** Format index of the uncompressed format */
+#define VIDCAMD_FormatIndexUncompressed 1
+/** Format index of the Motion-JPEG format, if present */
+#define VIDCAMD_FormatIndexMJPEG        2
+
 #define VIDCAMD_FW_1                 320
 #define VIDCAMD_FH_1                 240
 
@@ -134,6 +142,26 @@ typedef struct _UsbVideoInputHeaderDescriptor1 {
 	uint8_t     bmaControls1;
 } UsbVideoInputHeaderDescriptor1;
 
+/**
+ * Input header descriptor (with 2 formats)
+ */
+typedef struct _UsbVideoInputHeaderDescriptor2 {
+	uint8_t     bLength;
+	uint8_t     bDescriptorType;
+	uint8_t     bDescriptorSubType;
+	uint8_t     bNumFormats;
+	uint16_t    wTotalLength;
+	uint8_t     bEndpointAddress;
+	uint8_t     bmInfo;
+	uint8_t     bTerminalLink;
+	uint8_t     bStillCaptureMethod;
+	uint8_t     bTriggerSupport;
+	uint8_t     bTriggerUsage;
+	uint8_t     bControlSize;
+	uint8_t     bmaControls1;
+	uint8_t     bmaControls2;
+} UsbVideoInputHeaderDescriptor2;
+
 /**
  * Class-specific USB VideoControl Interface descriptor list
  */
@@ -157,6 +185,21 @@ typedef struct _UsbVideoStreamingInterfaceDescriptor {
 	UsbVideoFormatDescriptor format;
 } UsbVideoStreamingInterfaceDescriptor;
 
+/** USB Video Motion-JPEG Format with 2 frames */
+typedef struct _UsbVideoMJPEGFormatDescriptorList {
+	USBVideoMJPEGFormatDescriptor payload;
+	USBVideoMJPEGFrameDescriptor1 frame320x240;
+	USBVideoMJPEGFrameDescriptor1 frame640x480;
+	USBVideoColorMatchingDescriptor colorMJPEG;
+} UsbVideoMJPEGFormatDescriptorList;
+
+/** Streaming interface with uncompressed and Motion-JPEG formats */
+typedef struct _UsbVideoStreamingInterfaceDescriptor2 {
+	UsbVideoInputHeaderDescriptor2 inHeader;
+	UsbVideoFormatDescriptor format;
+	UsbVideoMJPEGFormatDescriptorList mjpeg;
+} UsbVideoStreamingInterfaceDescriptor2;
+
 struct UsbVideoCamConfigurationDescriptors {
 	/* Configuration descriptor */
 	USBConfigurationDescriptor configuration;
@@ -176,6 +219,25 @@ struct UsbVideoCamConfigurationDescriptors {
 	USBEndpointDescriptor ep11;
 };
 
+struct UsbVideoCamMJPEGConfigurationDescriptors {
+	/* Configuration descriptor */
+	USBConfigurationDescriptor configuration;
+	/* IAD */
+	USBInterfaceAssociationDescriptor iad;
+	/* VideoControl I/F */
+	USBInterfaceDescriptor interface0;
+	/* VideoControl I/F Descriptors */
+	UsbVideoControlInterfaceDescriptor vcInterface;
+	/* VideoStreaming I/F */
+	USBInterfaceDescriptor interface10;
+	/* VideoStreaming I/F Descriptors */
+	UsbVideoStreamingInterfaceDescriptor2 vsInterface;
+	/* VideoStreaming I/F */
+	USBInterfaceDescriptor interface11;
+	/* Endpoint */
+	USBEndpointDescriptor ep11;
+};
+
 PACK_RESET()
 
 /**@}*/
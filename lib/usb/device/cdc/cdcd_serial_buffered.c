@@ -0,0 +1,445 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *  Implementation of the buffered mode of the CDC serial port function.
+ */
+
+/** \addtogroup usbd_cdc
+ *@{
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "trace.h"
+#include "ring.h"
+
+#include "core/irq.h"
+
+#include "usb/device/cdc/cdcd_serial_buffered.h"
+
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+ *         Internal functions
+ *------------------------------------------------------------------------------*/
+
+static void _tx_start(struct _cdcd_serial_buffered *cdc, bool flush);
+static void _rx_start(struct _cdcd_serial_buffered *cdc);
+
+/**
+ * Returns the max packet size of the bulk endpoints for the current speed.
+ */
+static uint32_t _packet_size(void)
+{
+	return usbd_is_high_speed() ? CDCDSerialPort_BULK_MAXPACKETSIZE_HS
+		: CDCDSerialPort_BULK_MAXPACKETSIZE_FS;
+}
+
+/**
+ * Stops the port after a transfer error (USB reset, disconnection...).
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+static void _abort(struct _cdcd_serial_buffered *cdc)
+{
+	cdc->running = false;
+	hrtimer_cancel(&cdc->tx_timer);
+}
+
+/**
+ * Queue callback invoked when a bulk IN buffer has been sent.
+ * \param arg Pointer to the _cdcd_serial_buffered instance.
+ */
+static void _tx_callback(void *arg, uint8_t status, void *data,
+		uint32_t transferred)
+{
+	struct _cdcd_serial_buffered *cdc = (struct _cdcd_serial_buffered*)arg;
+
+	if (data == cdc->tx_bridge)
+		cdc->tx_bridge_busy = false;
+
+	if (status != USBD_STATUS_SUCCESS) {
+		LIBUSB_TRACE("CdcTx:%d ", status);
+		_abort(cdc);
+		return;
+	}
+
+	/* The bridge holds ring bytes too: release what was sent */
+	cdc->tx_tail = fixed_mod(cdc->tx_tail + transferred, cdc->tx.size);
+	cdc->stats.tx_transfers++;
+	cdc->stats.tx_bytes += transferred;
+
+	if (cdc->running)
+		_tx_start(cdc, false);
+}
+
+/**
+ * Timer callback: sends the partial packet waiting in the TX ring.
+ * \param arg Pointer to the _cdcd_serial_buffered instance.
+ */
+static void _tx_timer_callback(struct _hrtimer *timer, void *arg)
+{
+	struct _cdcd_serial_buffered *cdc = (struct _cdcd_serial_buffered*)arg;
+
+	if (cdc->running)
+		_tx_start(cdc, true);
+}
+
+/**
+ * Queues the TX ring data not queued yet. Every buffer but the last one of
+ * a flush is a whole number of packets: the controller validates a bank
+ * at the end of each buffer, and a short packet ends the host read.
+ * Without flush, at least one byte stays in the ring for the flush timer,
+ * so that the data always ends with a short packet and never needs a
+ * zero-length packet.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ * \param flush Send the remainder too.
+ */
+static void _tx_start(struct _cdcd_serial_buffered *cdc, bool flush)
+{
+	uint32_t pkt = _packet_size();
+	uint32_t count, len, end_len;
+	const uint8_t *data;
+	uint32_t state;
+
+	state = irq_save();
+
+	count = RING_CNT(cdc->tx_head, cdc->tx_next, cdc->tx.size);
+	if (!flush)
+		count = count ? (count - 1) - (count - 1) % pkt : 0;
+	else if (count % pkt)
+		cdc->stats.tx_flushes++;
+
+	while (count) {
+		data = &cdc->tx.data[cdc->tx_next];
+		len = RING_CNT_TO_END(cdc->tx_head, cdc->tx_next, cdc->tx.size);
+		if (len > count)
+			len = count;
+
+		if (len < count && (len % pkt)) {
+			/* The ring end splits a packet: whole packets up to
+			 * it first, then that packet copied to the bridge */
+			if (len > pkt) {
+				len -= len % pkt;
+			} else {
+				if (cdc->tx_bridge_busy)
+					break;
+				end_len = len;
+				len = count < pkt ? count : pkt;
+				if (flush && len == count && len == pkt)
+					len--;
+				memcpy(cdc->tx_bridge, data, end_len);
+				memcpy(cdc->tx_bridge + end_len, cdc->tx.data,
+						len - end_len);
+				data = cdc->tx_bridge;
+				cdc->tx_bridge_busy = true;
+				cdc->stats.tx_bridges++;
+			}
+		} else if (len == count && !(len % pkt)) {
+			/* Last buffer of a flush: end with a short packet */
+			if (flush)
+				len--;
+		}
+
+		if (cdcd_serial_port_queue_write(cdc->port, data, len)
+				!= USBD_STATUS_SUCCESS) {
+			/* Queue full, go on from the completion callback */
+			if (data == cdc->tx_bridge)
+				cdc->tx_bridge_busy = false;
+			break;
+		}
+		cdc->tx_next = fixed_mod(cdc->tx_next + len, cdc->tx.size);
+		count -= len;
+	}
+
+	/* Data waits for at most the flush delay */
+	if (!RING_EMPTY(cdc->tx_head, cdc->tx_next) &&
+			!hrtimer_is_pending(&cdc->tx_timer))
+		hrtimer_start_us(&cdc->tx_timer, cdc->flush_delay_us, 0);
+
+	irq_restore(state);
+}
+
+/**
+ * Queue callback invoked when a half of the packet buffer has been filled
+ * (or ended by a short packet).
+ * \param arg Pointer to the _cdcd_serial_buffered instance.
+ */
+static void _rx_callback(void *arg, uint8_t status, void *data,
+		uint32_t transferred)
+{
+	struct _cdcd_serial_buffered *cdc = (struct _cdcd_serial_buffered*)arg;
+	const uint8_t *src = (const uint8_t*)data;
+	uint32_t len;
+
+	cdc->rx_busy &= (src == cdc->packet.data) ? ~1 : ~2;
+
+	if (status != USBD_STATUS_SUCCESS) {
+		LIBUSB_TRACE("CdcRx:%d ", status);
+		_abort(cdc);
+		return;
+	}
+
+	cdc->stats.rx_transfers++;
+	cdc->stats.rx_bytes += transferred;
+
+	/* Space was reserved when the half was queued */
+	len = RING_SPACE_TO_END(cdc->rx_head, cdc->rx_tail, cdc->rx.size);
+	if (len > transferred)
+		len = transferred;
+	memcpy(&cdc->rx.data[cdc->rx_head], src, len);
+	memcpy(cdc->rx.data, src + len, transferred - len);
+	cdc->rx_head = fixed_mod(cdc->rx_head + transferred, cdc->rx.size);
+
+	if (cdc->running)
+		_rx_start(cdc);
+}
+
+/**
+ * Queues the free halves of the packet buffer on the bulk OUT endpoint,
+ * as long as the RX ring can hold them besides the halves already queued.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+static void _rx_start(struct _cdcd_serial_buffered *cdc)
+{
+	uint32_t half = cdc->packet.size / 2;
+	uint32_t reserved;
+	uint32_t state;
+	uint8_t i;
+
+	state = irq_save();
+
+	for (i = 0; i < 2; i++) {
+		if (cdc->rx_busy & (1 << i))
+			continue;
+		reserved = (cdc->rx_busy ? half : 0) + half;
+		if (RING_SPACE(cdc->rx_head, cdc->rx_tail, cdc->rx.size)
+				< reserved)
+			break;
+		if (cdcd_serial_port_queue_read(cdc->port,
+				&cdc->packet.data[i * half], half)
+				!= USBD_STATUS_SUCCESS)
+			break;
+		cdc->rx_busy |= 1 << i;
+	}
+
+	/* Host is NAKed until the application reads */
+	if (!cdc->rx_busy) {
+		if (!cdc->rx_stopped)
+			cdc->stats.rx_paused++;
+		cdc->rx_stopped = true;
+	} else {
+		cdc->rx_stopped = false;
+	}
+
+	irq_restore(state);
+}
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * Starts the buffered mode: resets the rings, switches the bulk endpoints
+ * to queued transfers and arms reception.
+ * Must be called once the device is configured (again after a USB reset).
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ * \return USBD_STATUS_SUCCESS if started, otherwise error code.
+ */
+uint32_t cdcd_serial_buffered_start(struct _cdcd_serial_buffered *cdc)
+{
+	uint32_t status;
+
+	if (!cdc->port || cdc->port->bBulkInPIPE == 0 ||
+			cdc->port->bBulkOutPIPE == 0)
+		return USBD_STATUS_INVALID_PARAMETER;
+	if (cdc->tx.size < 2 || cdc->packet.size == 0 ||
+			cdc->packet.size % (2 * CDCDSerialPort_BULK_MAXPACKETSIZE_HS) ||
+			cdc->rx.size <= cdc->packet.size)
+		return USBD_STATUS_INVALID_PARAMETER;
+
+	/* The flush timer runs on the hrtimer service */
+	if (!hrtimer_get_frequency())
+		return USBD_STATUS_HW_NOT_SUPPORTED;
+
+	LIBUSB_TRACE("CdcBufStart ");
+
+	cdc->running = false;
+	hrtimer_cancel(&cdc->tx_timer);
+	hrtimer_setup(&cdc->tx_timer, _tx_timer_callback, cdc);
+
+	status = cdcd_serial_port_setup_tx_queue(cdc->port, &cdc->tx_queue,
+			cdc->tx_desc, CDCD_SERIAL_BUFFERED_TX_DESC,
+			_tx_callback, cdc);
+	if (status != USBD_STATUS_SUCCESS)
+		return status;
+	status = cdcd_serial_port_setup_rx_queue(cdc->port, &cdc->rx_queue,
+			cdc->rx_desc, CDCD_SERIAL_BUFFERED_RX_DESC,
+			_rx_callback, cdc);
+	if (status != USBD_STATUS_SUCCESS)
+		return status;
+
+	cdc->tx_head = cdc->tx_next = cdc->tx_tail = 0;
+	cdc->tx_bridge_busy = false;
+	cdc->rx_head = cdc->rx_tail = 0;
+	cdc->rx_busy = 0;
+	cdc->rx_stopped = false;
+	memset(&cdc->stats, 0, sizeof(cdc->stats));
+	cdc->running = true;
+
+	_rx_start(cdc);
+
+	return USBD_STATUS_SUCCESS;
+}
+
+/**
+ * Stops the buffered mode. Queued transfers complete, but no new transfer
+ * is started.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+void cdcd_serial_buffered_stop(struct _cdcd_serial_buffered *cdc)
+{
+	_abort(cdc);
+}
+
+/**
+ * Copies data to the TX ring. Whole packets are queued at once, the
+ * remainder is sent when the flush timer expires.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ * \param data Pointer to the data to send.
+ * \param length Number of bytes to send.
+ * \return Number of bytes accepted (less than length if the ring is full).
+ */
+uint32_t cdcd_serial_buffered_write(struct _cdcd_serial_buffered *cdc,
+		const void *data, uint32_t length)
+{
+	const uint8_t *src = (const uint8_t*)data;
+	uint32_t head = cdc->tx_head;
+	uint32_t written = 0;
+	uint32_t len;
+
+	if (!cdc->running)
+		return 0;
+
+	while (written < length) {
+		len = RING_SPACE_TO_END(head, cdc->tx_tail, cdc->tx.size);
+		if (!len)
+			break;
+		if (len > length - written)
+			len = length - written;
+		memcpy(&cdc->tx.data[head], src + written, len);
+		written += len;
+		head = fixed_mod(head + len, cdc->tx.size);
+	}
+	cdc->tx_head = head;
+	cdc->stats.tx_dropped += length - written;
+
+	_tx_start(cdc, false);
+
+	return written;
+}
+
+/**
+ * Copies received data from the RX ring, and queues the packet buffer
+ * halves that were waiting for space in the ring.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ * \param data Pointer to the destination buffer.
+ * \param length Size of the destination buffer.
+ * \return Number of bytes copied.
+ */
+uint32_t cdcd_serial_buffered_read(struct _cdcd_serial_buffered *cdc,
+		void *data, uint32_t length)
+{
+	uint8_t *dst = (uint8_t*)data;
+	uint32_t tail = cdc->rx_tail;
+	uint32_t read = 0;
+	uint32_t len;
+
+	while (read < length) {
+		len = RING_CNT_TO_END(cdc->rx_head, tail, cdc->rx.size);
+		if (!len)
+			break;
+		if (len > length - read)
+			len = length - read;
+		memcpy(dst + read, &cdc->rx.data[tail], len);
+		read += len;
+		tail = fixed_mod(tail + len, cdc->rx.size);
+	}
+	cdc->rx_tail = tail;
+
+	if (cdc->running && cdc->rx_busy != 3)
+		_rx_start(cdc);
+
+	return read;
+}
+
+/**
+ * Sends all the data of the TX ring now.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+void cdcd_serial_buffered_flush(struct _cdcd_serial_buffered *cdc)
+{
+	if (cdc->running)
+		_tx_start(cdc, true);
+}
+
+/**
+ * Returns the number of received bytes available in the RX ring.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+uint32_t cdcd_serial_buffered_get_rx_count(
+		const struct _cdcd_serial_buffered *cdc)
+{
+	return RING_CNT(cdc->rx_head, cdc->rx_tail, cdc->rx.size);
+}
+
+/**
+ * Returns the number of bytes that can be written without blocking.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ */
+uint32_t cdcd_serial_buffered_get_tx_space(
+		const struct _cdcd_serial_buffered *cdc)
+{
+	return RING_SPACE(cdc->tx_head, cdc->tx_tail, cdc->tx.size);
+}
+
+/**
+ * Copies the throughput counters.
+ * \param cdc Pointer to the _cdcd_serial_buffered instance.
+ * \param stats Pointer to the destination counters.
+ */
+void cdcd_serial_buffered_get_stats(const struct _cdcd_serial_buffered *cdc,
+		struct _cdcd_serial_buffered_stats *stats)
+{
+	memcpy(stats, &cdc->stats, sizeof(*stats));
+}
+
+/**@}*/
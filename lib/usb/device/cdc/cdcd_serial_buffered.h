@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *  Buffered mode for the USB device CDC serial port function.
+ *
+ *  Data written by the application is gathered in a TX ring and queued on
+ *  the bulk IN endpoint (see usbd_setup_queue()) straight from the ring,
+ *  in whole packets; a remainder smaller than one packet is sent when the
+ *  flush timer expires. Every transfer ends with a short packet, so that
+ *  the host read completes without a zero-length packet. Two halves of the
+ *  packet buffer are kept queued on the bulk OUT endpoint and received
+ *  data is stored in a RX ring until the application reads it.
+ *
+ *  \par Usage
+ *
+ *  -# Start the hrtimer service (hrtimer_configure()), it runs the flush
+ *     timer.
+ *  -# Fill the port, buffers and flush delay of a zero-initialized
+ *     _cdcd_serial_buffered instance. The packet buffer must be
+ *     cache-aligned, a multiple of twice the high speed bulk max packet
+ *     size and smaller than the RX ring.
+ *  -# Call cdcd_serial_buffered_start() once the device is configured.
+ *  -# Use cdcd_serial_buffered_write()/cdcd_serial_buffered_read().
+ */
+
+#ifndef _CDCD_SERIAL_BUFFERED_H_
+#define _CDCD_SERIAL_BUFFERED_H_
+
+/** \addtogroup usbd_cdc
+ *@{
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hrtimer.h"
+#include "io.h"
+
+#include "usb/device/usbd_hal.h"
+#include "usb/device/cdc/cdcd_serial_port.h"
+
+/*------------------------------------------------------------------------------
+ *         Definitions
+ *------------------------------------------------------------------------------*/
+
+/** Number of bulk IN DMA descriptors (buffers queued at once, plus one) */
+#define CDCD_SERIAL_BUFFERED_TX_DESC 4
+
+/** Number of bulk OUT DMA descriptors: the two packet buffer halves, plus
+ * one */
+#define CDCD_SERIAL_BUFFERED_RX_DESC 3
+
+/*------------------------------------------------------------------------------
+ *         Types
+ *------------------------------------------------------------------------------*/
+
+/** Throughput counters of a buffered CDC serial port */
+struct _cdcd_serial_buffered_stats {
+	uint32_t tx_bytes;     /**< Bytes sent to the host */
+	uint32_t tx_transfers; /**< Bulk IN buffers completed */
+	uint32_t tx_flushes;   /**< Partial packets sent by the flush timer */
+	uint32_t tx_bridges;   /**< Packets copied across the TX ring end */
+	uint32_t tx_dropped;   /**< Bytes not accepted, TX ring full */
+	uint32_t rx_bytes;     /**< Bytes received from the host */
+	uint32_t rx_transfers; /**< Bulk OUT buffers completed */
+	uint32_t rx_paused;    /**< Times reception paused, RX ring full */
+};
+
+/** Buffered CDC serial port instance */
+struct _cdcd_serial_buffered {
+	/** CDC serial port function (endpoints) */
+	const CDCDSerialPort *port;
+	/** TX ring storage */
+	struct _buffer tx;
+	/** RX ring storage */
+	struct _buffer rx;
+	/** Bulk OUT transfer buffer (cache-aligned, two halves, each a
+	 * multiple of the packet size) */
+	struct _buffer packet;
+	/** Delay before sending a partial packet, in microseconds */
+	uint32_t flush_delay_us;
+
+	/* Run time state, managed by the driver */
+	struct _usbd_dma_desc tx_desc[CDCD_SERIAL_BUFFERED_TX_DESC];
+	struct _usbd_dma_desc rx_desc[CDCD_SERIAL_BUFFERED_RX_DESC];
+	struct _usbd_queue tx_queue;
+	struct _usbd_queue rx_queue;
+	/** Packet copied across the TX ring end */
+	uint8_t tx_bridge[CDCDSerialPort_BULK_MAXPACKETSIZE_HS];
+	bool tx_bridge_busy;
+	volatile uint32_t tx_head;  /**< Written by the application */
+	volatile uint32_t tx_next;  /**< Queued up to here */
+	volatile uint32_t tx_tail;  /**< Sent up to here */
+	struct _hrtimer tx_timer;
+	volatile uint32_t rx_head;
+	volatile uint32_t rx_tail;
+	uint8_t rx_busy;            /**< Packet buffer halves queued */
+	bool rx_stopped;
+	volatile bool running;
+	struct _cdcd_serial_buffered_stats stats;
+};
+
+/*------------------------------------------------------------------------------
+ *         Functions
+ *------------------------------------------------------------------------------*/
+
+extern uint32_t cdcd_serial_buffered_start(struct _cdcd_serial_buffered *cdc);
+
+extern void cdcd_serial_buffered_stop(struct _cdcd_serial_buffered *cdc);
+
+extern uint32_t cdcd_serial_buffered_write(struct _cdcd_serial_buffered *cdc,
+		const void *data, uint32_t length);
+
+extern uint32_t cdcd_serial_buffered_read(struct _cdcd_serial_buffered *cdc,
+		void *data, uint32_t length);
+
+extern void cdcd_serial_buffered_flush(struct _cdcd_serial_buffered *cdc);
+
+extern uint32_t cdcd_serial_buffered_get_rx_count(
+		const struct _cdcd_serial_buffered *cdc);
+
+extern uint32_t cdcd_serial_buffered_get_tx_space(
+		const struct _cdcd_serial_buffered *cdc);
+
+extern void cdcd_serial_buffered_get_stats(
+		const struct _cdcd_serial_buffered *cdc,
+		struct _cdcd_serial_buffered_stats *stats);
+
+/**@}*/
+#endif /* _CDCD_SERIAL_BUFFERED_H_ */
@@ -364,6 +364,95 @@ uint32_t cdcd_serial_port_write(const CDCDSerialPort *p_cdcd,
 			callback, callback_arg);
 }
 
+/**
+ * Switches the bulk IN endpoint of the port to queued transfers: buffers
+ * given to cdcd_serial_port_queue_write() are then sent back to back by
+ * the DMA and the callback reports each of them. Must be called once the
+ * port is configured and its bulk IN endpoint idle.
+ * \param p_cdcd  Pointer to CDCDSerialPort instance.
+ * \param queue  Pointer to the queue, NULL to go back to single transfers.
+ * \param desc  Cache-aligned DMA descriptor storage, one per queue slot.
+ * \param size  Number of descriptors (a queue holds size - 1 buffers).
+ * \param callback  Callback invoked for each completed buffer.
+ * \param callback_arg  Optional argument to the callback function.
+ * \return USBD_STATUS_SUCCESS if the queue has been set up;
+ *         otherwise, the corresponding error code.
+ */
+uint32_t cdcd_serial_port_setup_tx_queue(const CDCDSerialPort *p_cdcd,
+		struct _usbd_queue *queue, struct _usbd_dma_desc *desc,
+		uint16_t size, usbd_queue_cb_t callback, void *callback_arg)
+{
+	if (p_cdcd->bBulkInPIPE == 0)
+		return USBRC_PARAM_ERR;
+
+	return usbd_setup_queue(p_cdcd->bBulkInPIPE, queue, desc, size,
+			callback, callback_arg);
+}
+
+/**
+ * Switches the bulk OUT endpoint of the port to queued transfers: buffers
+ * given to cdcd_serial_port_queue_read() are filled back to back and the
+ * callback reports each of them, full or ended by a short packet.
+ * \param p_cdcd  Pointer to CDCDSerialPort instance.
+ * \param queue  Pointer to the queue, NULL to go back to single transfers.
+ * \param desc  Cache-aligned DMA descriptor storage, one per queue slot.
+ * \param size  Number of descriptors (a queue holds size - 1 buffers).
+ * \param callback  Callback invoked for each completed buffer.
+ * \param callback_arg  Optional argument to the callback function.
+ * \return USBD_STATUS_SUCCESS if the queue has been set up;
+ *         otherwise, the corresponding error code.
+ */
+uint32_t cdcd_serial_port_setup_rx_queue(const CDCDSerialPort *p_cdcd,
+		struct _usbd_queue *queue, struct _usbd_dma_desc *desc,
+		uint16_t size, usbd_queue_cb_t callback, void *callback_arg)
+{
+	if (p_cdcd->bBulkOutPIPE == 0)
+		return USBRC_PARAM_ERR;
+
+	return usbd_setup_queue(p_cdcd->bBulkOutPIPE, queue, desc, size,
+			callback, callback_arg);
+}
+
+/**
+ * Queues a buffer to send on a port set up with
+ * cdcd_serial_port_setup_tx_queue().
+ *
+ * *The buffer must be kept allocated until the queue callback reports it*.
+ * \param p_cdcd  Pointer to CDCDSerialPort instance.
+ * \param data  Pointer to the data buffer to send.
+ * \param length Size of the data buffer in bytes.
+ * \return USBD_STATUS_SUCCESS if the buffer has been queued;
+ *         otherwise, the corresponding error code.
+ */
+uint32_t cdcd_serial_port_queue_write(const CDCDSerialPort *p_cdcd,
+		const void *data, uint32_t length)
+{
+	if (p_cdcd->bBulkInPIPE == 0)
+		return USBRC_PARAM_ERR;
+
+	return usbd_queue_write(p_cdcd->bBulkInPIPE, data, length);
+}
+
+/**
+ * Queues a buffer to fill on a port set up with
+ * cdcd_serial_port_setup_rx_queue().
+ *
+ * *The buffer must be kept allocated until the queue callback reports it*.
+ * \param p_cdcd  Pointer to CDCDSerialPort instance.
+ * \param data  Pointer to the data buffer to fill.
+ * \param length Size of the data buffer in bytes.
+ * \return USBD_STATUS_SUCCESS if the buffer has been queued;
+ *         otherwise, the corresponding error code.
+ */
+uint32_t cdcd_serial_port_queue_read(const CDCDSerialPort *p_cdcd,
+		void *data, uint32_t length)
+{
+	if (p_cdcd->bBulkOutPIPE == 0)
+		return USBRC_PARAM_ERR;
+
+	return usbd_queue_read(p_cdcd->bBulkOutPIPE, data, length);
+}
+
 /**
  * Returns the current control line state of the RS-232 line.
  * \param p_cdcd  Pointer to CDCDSerialPort instance.
@@ -147,6 +147,24 @@ extern uint32_t cdcd_serial_port_read(
 	void *pData, uint32_t dwSize,
 	usbd_xfer_cb_t fCallback, void* pArg);
 
+extern uint32_t cdcd_serial_port_setup_tx_queue(
+	const CDCDSerialPort *pCdcd,
+	struct _usbd_queue *pQueue, struct _usbd_dma_desc *pDesc,
+	uint16_t wSize, usbd_queue_cb_t fCallback, void *pArg);
+
+extern uint32_t cdcd_serial_port_setup_rx_queue(
+	const CDCDSerialPort *pCdcd,
+	struct _usbd_queue *pQueue, struct _usbd_dma_desc *pDesc,
+	uint16_t wSize, usbd_queue_cb_t fCallback, void *pArg);
+
+extern uint32_t cdcd_serial_port_queue_write(
+	const CDCDSerialPort *pCdcd,
+	const void *pData, uint32_t dwSize);
+
+extern uint32_t cdcd_serial_port_queue_read(
+	const CDCDSerialPort *pCdcd,
+	void *pData, uint32_t dwSize);
+
 extern uint16_t cdcd_serial_port_get_serial_state(
 	const CDCDSerialPort *pCdcd);
 
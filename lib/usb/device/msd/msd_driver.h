@@ -125,11 +125,22 @@ extern void msd_driver_configuration_change_handler(
 
 /**
  * State machine for the MSD driver
- * \param  pMsdDriver  Pointer to MSDDriver instance.
+ * \return true if the state machine progressed and should be run again
  */
-static inline void msd_driver_state_machine(void)
+static inline bool msd_driver_state_machine(void)
 {
-	msd_function_state_machine();
+	return msd_function_state_machine();
+}
+
+/**
+ * Post an event each time the MSD state machine may progress, so that it
+ * only runs when needed. The event handler should run the state machine
+ * and post the event again while it returns true.
+ * \param  event  Event to post, NULL to poll the state machine instead.
+ */
+static inline void msd_driver_set_event(struct _event *event)
+{
+	msd_function_set_event(event);
 }
 
 /**@}*/
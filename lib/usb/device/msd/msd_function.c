@@ -225,6 +225,9 @@ void msd_function_configure(USBGenericDescriptor *p_descriptors,
 				(USBDescriptorParseFunction)msd_function_parse, &parse_data);
 
 	msd_function_reset();
+
+	/* Start reading CBWs */
+	msdd_notify();
 }
 
 /**
@@ -244,6 +247,9 @@ uint32_t msd_function_request_handler(
 
 	LIBUSB_TRACE("Msdf ");
 
+	/* The request may end a halt or a reset recovery */
+	msdd_notify();
+
 	/* Handle requests */
 	switch (req_code) {
 	/*--------------------- */
@@ -326,12 +332,22 @@ uint32_t msd_function_request_handler(
 
 /**
  * State machine for the MSD driver
+ * \return true if the state machine progressed and should be run again
  */
-void msd_function_state_machine(void)
+bool msd_function_state_machine(void)
 {
-	if (usbd_get_state() < USBD_STATE_CONFIGURED){}
-	else msdd_state_machine(&msd_function);
+	if (usbd_get_state() < USBD_STATE_CONFIGURED)
+		return false;
+	return msdd_state_machine(&msd_function);
+}
 
+/**
+ * Post an event when the MSD state machine may progress, instead of polling
+ * it. NULL goes back to polling.
+ */
+void msd_function_set_event(struct _event *event)
+{
+	msdd_set_event(event);
 }
 
 /**@}*/
@@ -65,7 +65,9 @@ extern uint32_t msd_function_request_handler(
 extern void msd_function_configure(
 		USBGenericDescriptor *descriptors, uint16_t length);
 
-extern void msd_function_state_machine(void);
+extern bool msd_function_state_machine(void);
+
+extern void msd_function_set_event(struct _event *event);
 
 /**@}*/
 
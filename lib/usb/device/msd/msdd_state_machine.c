@@ -37,10 +37,18 @@
  *-----------------------------------------------------------------------------*/
 
 #include "trace.h"
+#include "event.h"
 
 #include "usb/device/msd/sbc_methods.h"
 #include "usb/device/msd/msdd_state_machine.h"
 
+/*-----------------------------------------------------------------------------
+ *      Internal variables
+ *-----------------------------------------------------------------------------*/
+
+/** Event posted when the state machine can progress, NULL when polled */
+static struct _event *msdd_event;
+
 /*-----------------------------------------------------------------------------
  *      Internal functions
  *-----------------------------------------------------------------------------*/
@@ -61,6 +69,7 @@ static void msd_driver_callback(void *arg, uint8_t status,
 		transfer->transferred = transferred;
 		transfer->remaining = remaining;
 		transfer->semaphore++;
+		msdd_notify();
 	}
 }
 
@@ -371,10 +380,10 @@ static unsigned char msdd_process_command(MSDDriver * driver)
 }
 
 /**
- * State machine for the MSD %device driver
+ * Run one step of the state machine for the MSD %device driver
  * \param  driver Pointer to a MSDDriver instance
  */
-void msdd_state_machine(MSDDriver * driver)
+static void msdd_state_machine_step(MSDDriver * driver)
 {
 	MSDCommandState *command_state = &(driver->commandState);
 	MSCbw           *cbw = &(command_state->cbw);
@@ -526,4 +535,51 @@ void msdd_state_machine(MSDDriver * driver)
 	}
 }
 
+/**
+ * State machine for the MSD %device driver
+ * \param  driver Pointer to a MSDDriver instance
+ * \return true if the state machine progressed, false if it is waiting for
+ *         a USB or media transfer, or for a request from the host
+ */
+bool msdd_state_machine(MSDDriver * driver)
+{
+	MSDCommandState *command_state = &(driver->commandState);
+	uint8_t state = driver->state;
+	uint8_t wait_reset = driver->waitResetRecovery;
+	uint8_t command = command_state->state;
+	uint32_t length = command_state->length;
+	uint16_t usb_sem = command_state->transfer.semaphore;
+	uint16_t disk_sem = command_state->disktransfer.semaphore;
+
+	msdd_state_machine_step(driver);
+
+	return state != driver->state
+		|| wait_reset != driver->waitResetRecovery
+		|| command != command_state->state
+		|| length != command_state->length
+		|| usb_sem != command_state->transfer.semaphore
+		|| disk_sem != command_state->disktransfer.semaphore;
+}
+
+/**
+ * Post an event each time the state machine may progress: on transfer
+ * completions, configuration changes and requests from the host. The event
+ * handler should call the state machine again while it returns true.
+ * \param  event Event to post, NULL to poll the state machine instead
+ */
+void msdd_set_event(struct _event *event)
+{
+	msdd_event = event;
+}
+
+/**
+ * Notify that the state machine may progress, can be called in interrupt
+ * context
+ */
+void msdd_notify(void)
+{
+	if (msdd_event)
+		event_post(msdd_event);
+}
+
 /**@}*/
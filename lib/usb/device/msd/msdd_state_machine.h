@@ -55,6 +55,8 @@
 #include "usb/device/msd/msd_lun.h"
 #include "usb/device/usbd_driver.h"
 
+#include <stdbool.h>
+
 /*-----------------------------------------------------------------------------
  *      Definitions
  *-----------------------------------------------------------------------------*/
@@ -225,7 +227,13 @@ typedef struct _MSDDriver {
  *      Exported functions
  *-----------------------------------------------------------------------------*/
 
-extern void msdd_state_machine(MSDDriver * pMsdDriver);
+struct _event;
+
+extern bool msdd_state_machine(MSDDriver * pMsdDriver);
+
+extern void msdd_set_event(struct _event *event);
+
+extern void msdd_notify(void);
 
 /**@}*/
 
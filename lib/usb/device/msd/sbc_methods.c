@@ -84,6 +84,7 @@ static void msd_driver_callback(void *arg, uint8_t status,
 	transfer->transferred = transferred;
 	transfer->remaining = remaining;
 	transfer->semaphore++;
+	msdd_notify();
 }
 
 /**
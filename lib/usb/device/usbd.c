@@ -226,6 +226,58 @@ uint8_t usbd_read(uint8_t endpoint, void *data, uint32_t length,
 	return usbd_hal_read(endpoint, data, length);
 }
 
+/**
+ * Configures an endpoint for queued (streaming) transfers. Once set up,
+ * buffers are added with usbd_queue_write()/usbd_queue_read() and are
+ * transferred back to back by the DMA.
+ * \param endpoint Endpoint number.
+ * \param queue Pointer to the queue, NULL to go back to single transfers.
+ * \param desc Cache-aligned DMA descriptor storage, one per queue slot.
+ * \param size Number of descriptors in storage.
+ * \param callback Callback invoked for each completed buffer.
+ * \param callback_arg Optional argument to the callback function.
+ * \return USBD_STATUS_SUCCESS if the queue has been set up;
+ *         otherwise, the corresponding error code.
+ */
+uint8_t usbd_setup_queue(uint8_t endpoint, struct _usbd_queue *queue,
+		struct _usbd_dma_desc *desc, uint16_t size,
+		usbd_queue_cb_t callback, void *callback_arg)
+{
+	return usbd_hal_setup_queue(endpoint, queue, desc, size,
+			callback, callback_arg);
+}
+
+/**
+ * Queues a buffer to send on an IN endpoint set up with usbd_setup_queue().
+ *
+ * *The buffer must be kept allocated until the queue callback reports it*.
+ * \param endpoint Endpoint number.
+ * \param data Pointer to a buffer with the data to send.
+ * \param length Size of the data buffer.
+ * \return USBD_STATUS_SUCCESS if the buffer has been queued;
+ *         otherwise, the corresponding error code.
+ */
+uint8_t usbd_queue_write(uint8_t endpoint, const void *data, uint32_t length)
+{
+	return usbd_hal_write(endpoint, data, length);
+}
+
+/**
+ * Queues a buffer to fill on an OUT endpoint set up with usbd_setup_queue().
+ * A buffer completes when it is full or a short packet is received.
+ *
+ * *The buffer must be kept allocated until the queue callback reports it*.
+ * \param endpoint Endpoint number.
+ * \param data Pointer to a data buffer.
+ * \param length Size of the data buffer in bytes.
+ * \return USBD_STATUS_SUCCESS if the buffer has been queued;
+ *         otherwise, the corresponding error code.
+ */
+uint8_t usbd_queue_read(uint8_t endpoint, void *data, uint32_t length)
+{
+	return usbd_hal_read(endpoint, data, length);
+}
+
 /**
  * Sets the HALT feature on the given endpoint (if not already in this state).
  * \param b_endpoint Endpoint number.
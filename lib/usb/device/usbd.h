@@ -131,6 +131,11 @@
  */
 typedef void (*usbd_xfer_cb_t)(void *arg, uint8_t status, uint32_t transferred, uint32_t remaining);
 
+/**
+ * Callback used by queued transfers to notify that a buffer is complete.
+ */
+typedef void (*usbd_queue_cb_t)(void *arg, uint8_t status, void *data, uint32_t transferred);
+
 /**@}*/
 
 /*------------------------------------------------------------------------------
@@ -153,6 +158,18 @@ extern uint16_t usbd_get_data_size(uint8_t endpoint);
 extern uint8_t usbd_read(uint8_t endpoint, void *data, uint32_t length,
 		usbd_xfer_cb_t callback, void *callback_arg);
 
+struct _usbd_queue;
+struct _usbd_dma_desc;
+
+extern uint8_t usbd_setup_queue(uint8_t endpoint, struct _usbd_queue *queue,
+		struct _usbd_dma_desc *desc, uint16_t size,
+		usbd_queue_cb_t callback, void *callback_arg);
+
+extern uint8_t usbd_queue_write(uint8_t endpoint, const void *data,
+		uint32_t length);
+
+extern uint8_t usbd_queue_read(uint8_t endpoint, void *data, uint32_t length);
+
 extern uint8_t usbd_stall(uint8_t endpoint);
 
 extern void usbd_halt(uint8_t endpoint);
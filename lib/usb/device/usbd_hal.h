@@ -67,6 +67,56 @@ struct _usbd_transfer_buffer {
 	uint16_t remaining;   /**< Bytes remaining */
 };
 
+/**
+ * \brief DMA descriptor, used for linked-list transfers.
+ *
+ * Descriptors are read by the USB DMA and must be cache-aligned.
+ */
+struct _usbd_dma_desc {
+	void     *next;     /**< Next descriptor */
+	void     *addr;     /**< Buffer address */
+	uint32_t  ctrl;     /**< DMA control */
+	uint32_t  reserved; /**< Reserved (padding) */
+};
+
+/**
+ * \brief Payload (optional header + data) sent as one (micro)frame on an
+ * isochronous endpoint.
+ */
+struct _usbd_payload {
+	const void *header;  /**< Pointer to payload header */
+	uint32_t header_len; /**< Size of payload header */
+	const void *data;    /**< Pointer to payload data */
+	uint32_t data_len;   /**< Size of payload data */
+};
+
+/**
+ * \brief Chain of DMA descriptors prepared ahead of time and started with a
+ * single call.
+ */
+struct _usbd_dma_chain {
+	struct _usbd_dma_desc *desc; /**< Descriptor storage (cache-aligned) */
+	uint16_t desc_size;          /**< Number of descriptors in storage */
+	uint16_t desc_count;         /**< Number of descriptors used */
+	uint32_t length;             /**< Total number of bytes */
+};
+
+/**
+ * \brief Buffer queue for streaming transfers on a DMA endpoint.
+ *
+ * Each queued buffer is described by one DMA descriptor of the storage
+ * given to usbd_hal_setup_queue(). The indexes are managed by the driver.
+ */
+struct _usbd_queue {
+	struct _usbd_dma_desc *desc; /**< Descriptor storage (cache-aligned) */
+	uint16_t size;               /**< Number of descriptors in storage */
+	volatile uint16_t head;      /**< Next free slot */
+	volatile uint16_t start;     /**< First slot not handed to the DMA */
+	volatile uint16_t tail;      /**< First slot not completed */
+	usbd_queue_cb_t callback;    /**< Invoked for each completed buffer */
+	void *callback_arg;          /**< Argument of the callback */
+};
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -103,6 +153,10 @@ extern uint8_t usbd_hal_setup_multi_transfer(uint8_t endpoint,
 		struct _usbd_transfer_buffer *list, uint16_t list_size,
 		uint16_t start_offset);
 
+extern uint8_t usbd_hal_setup_queue(uint8_t endpoint,
+		struct _usbd_queue *queue, struct _usbd_dma_desc *desc,
+		uint16_t size, usbd_queue_cb_t callback, void *callback_arg);
+
 extern uint8_t usbd_hal_write(uint8_t endpoint,
 		const void *data, uint32_t length);
 
@@ -110,6 +164,11 @@ extern uint8_t usbd_hal_write_with_header(uint8_t endpoint,
 		const void *header, uint32_t header_length,
 		const void *data, uint32_t data_length);
 
+extern uint8_t usbd_hal_build_payload_chain(uint8_t endpoint,
+		struct _usbd_dma_chain *chain,
+		const struct _usbd_payload *payloads, uint32_t count);
+extern uint8_t usbd_hal_write_chain(uint8_t endpoint,
+		const struct _usbd_dma_chain *chain);
 extern uint16_t usbd_hal_get_data_size(uint8_t endpoint);
 
 extern uint8_t usbd_hal_read(uint8_t endpoint,
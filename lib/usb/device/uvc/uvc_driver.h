@@ -57,11 +57,15 @@ struct _uvc_driver {
 	volatile uint8_t is_video_on;
 	volatile uint8_t is_frame_xfring; //=0 default
 	uint32_t frm_format;
+	/** Format index (bFormatIndex) selected by the host */
+	uint8_t  format_index;
 	uint32_t frm_count;
 	uint32_t frm_offset;
 	uint32_t stream_frm_index;
 	uint32_t buf_start_addr;
 	uint8_t  multi_buffers;
+	/** Optional size of each frame buffer (compressed formats) */
+	const volatile uint32_t *frm_sizes;
 	/** Array for storing the current setting of each interface */
 	uint8_t alternate_interfaces[4];
 };
@@ -41,6 +41,7 @@
 #include "usb/device/usbd_hal.h"
 #include "usb/device/uvc/uvc_function.h"
 
+#include <stdbool.h>
 #include <string.h>
 
 /** Probe & Commit Controls */
@@ -80,7 +81,24 @@ static uint32_t frm_max_pkt_size = FRAME_PACKET_SIZE_HS * (ISO_HIGH_BW_MODE + 1)
 /** Buffer for USB requests data */
 CACHE_ALIGNED static uint8_t control_buffer[64];
 
-CACHE_ALIGNED static uint8_t stream_header[32];
+/** Chain of payloads sent with a single DMA linked list transfer */
+struct _uvc_chain {
+	/** DMA descriptors: header + one per transaction, for each payload */
+	struct _usbd_dma_desc desc[UVC_PAYLOADS_PER_CHAIN * (2 + ISO_HIGH_BW_MODE)];
+	/** Payload headers */
+	uint8_t headers[UVC_PAYLOADS_PER_CHAIN][FRAME_PAYLOAD_HDR_SIZE];
+	struct _usbd_payload payloads[UVC_PAYLOADS_PER_CHAIN];
+	struct _usbd_dma_chain chain;
+};
+
+/** Two chains: one being sent while the other is prepared */
+CACHE_ALIGNED static struct _uvc_chain uvc_chains[2];
+
+/** Index of the chain being sent */
+static volatile uint8_t chain_index;
+
+/** True while chains are being sent */
+static volatile bool streaming;
 
 static struct _uvc_driver *uvc_driver;
 
@@ -147,6 +165,7 @@ static void vidd_status_stage(void *arg, uint8_t status,
 	vidd_probe_data.wDelay = 0;
 	vidd_probe_data.dwMaxVideoFrameSize = FRAME_BUFFER_SIZEC(frm_width, frm_height);
 	uvc_driver->frm_format = pProbe->bFrameIndex;
+	uvc_driver->format_index = pProbe->bFormatIndex;
 	usbd_write(0, NULL, 0, NULL, NULL);
 }
 
@@ -270,21 +289,20 @@ void uvc_function_get_res(const USBGenericRequest *request)
 }
 
 /**
- * Callback that invoked when USB packet is sent.
+ * Prepare the next payload of the video stream: fill its header and select
+ * the slice of the frame buffer it carries.
  */
-void uvc_function_payload_sent(void *arg, uint8_t state,
-		uint32_t transferred, uint32_t remaining)
+static void vidd_prepare_payload(struct _usbd_payload *payload,
+		uint8_t *hdr_buf, uint32_t max_pkt_size)
 {
 	uint32_t dma_transfer_size;
-	uint32_t frame_size = FRAME_BUFFER_SIZEC(frm_width, frm_height);
+	uint32_t frame_size = uvc_driver->frm_sizes ?
+		uvc_driver->frm_sizes[frame_buffer_addr] :
+		FRAME_BUFFER_SIZEC(frm_width, frm_height);
 	uint8_t *uncompressed_stream = (uint8_t*)(uvc_driver->buf_start_addr +
 									frame_buffer_addr * FRAME_BUFFER_SIZEC(frm_width, frm_height));
-	USBVideoPayloadHeader *header = (USBVideoPayloadHeader*)stream_header;
-	uint32_t max_pkt_size = usbd_is_high_speed() ? frm_max_pkt_size : FRAME_PACKET_SIZE_FS;
-	if (remaining){
+	USBVideoPayloadHeader *header = (USBVideoPayloadHeader*)hdr_buf;
 
-		return;
-	}
 	dma_transfer_size = frame_size - uvc_driver->frm_offset;
 	header->bHeaderLength = FRAME_PAYLOAD_HDR_SIZE;
 	header->bmHeaderInfo.B = 0;
@@ -307,8 +325,83 @@ void uvc_function_payload_sent(void *arg, uint8_t state,
 	}
 	header->bmHeaderInfo.bm.EOH =  1;
 
-	usbd_hal_write_with_header(VIDCAMD_IsoInEndpointNum, header,
-		header->bHeaderLength, uncompressed_stream, dma_transfer_size);
+	payload->header = hdr_buf;
+	payload->header_len = header->bHeaderLength;
+	payload->data = uncompressed_stream;
+	payload->data_len = dma_transfer_size;
+}
+
+/**
+ * Build the DMA chain of the given slot with the next
+ * UVC_PAYLOADS_PER_CHAIN payloads of the video stream.
+ */
+static uint8_t vidd_build_chain(struct _uvc_chain *uvc_chain)
+{
+	uint32_t max_pkt_size = usbd_is_high_speed() ? frm_max_pkt_size : FRAME_PACKET_SIZE_FS;
+	uint32_t i;
+
+	for (i = 0; i < UVC_PAYLOADS_PER_CHAIN; i++)
+		vidd_prepare_payload(&uvc_chain->payloads[i],
+				uvc_chain->headers[i], max_pkt_size);
+
+	uvc_chain->chain.desc = uvc_chain->desc;
+	uvc_chain->chain.desc_size = ARRAY_SIZE(uvc_chain->desc);
+	return usbd_hal_build_payload_chain(VIDCAMD_IsoInEndpointNum,
+			&uvc_chain->chain, uvc_chain->payloads,
+			UVC_PAYLOADS_PER_CHAIN);
+}
+
+/**
+ * Callback that invoked when a chain of USB payloads is sent.
+ *
+ * Two chains are used in turn: when one completes, the other one (already
+ * prepared) is started immediately and the completed one is rebuilt with
+ * the next payloads. Calling this function while streaming is stopped
+ * (with all arguments set to 0) starts the stream.
+ */
+void uvc_function_payload_sent(void *arg, uint8_t state,
+		uint32_t transferred, uint32_t remaining)
+{
+	uint8_t done;
+
+	if (state != USBD_STATUS_SUCCESS) {
+		/* Endpoint reset: stop streaming */
+		streaming = false;
+		return;
+	}
+
+	if (remaining)
+		return;
+
+	if (!streaming) {
+		/* Start: build both chains, send the first one */
+		if (!uvc_driver->is_video_on)
+			return;
+		if (vidd_build_chain(&uvc_chains[0]) != USBD_STATUS_SUCCESS ||
+		    vidd_build_chain(&uvc_chains[1]) != USBD_STATUS_SUCCESS)
+			return;
+		streaming = true;
+		chain_index = 0;
+		usbd_hal_write_chain(VIDCAMD_IsoInEndpointNum,
+				&uvc_chains[0].chain);
+		return;
+	}
+
+	if (!uvc_driver->is_video_on) {
+		/* Video stopped */
+		streaming = false;
+		return;
+	}
+
+	/* Send the prepared chain, then prepare the completed one again */
+	done = chain_index;
+	chain_index ^= 1;
+	if (usbd_hal_write_chain(VIDCAMD_IsoInEndpointNum,
+			&uvc_chains[chain_index].chain) != USBD_STATUS_SUCCESS) {
+		streaming = false;
+		return;
+	}
+	vidd_build_chain(&uvc_chains[done]);
 }
 
 void uvc_function_initialize(struct _uvc_driver* uvc_drv)
@@ -327,10 +420,48 @@ uint8_t uvc_function_get_frame_format(void)
 	return (uint8_t)uvc_driver->frm_format;
 }
 
+uint8_t uvc_function_get_format_index(void)
+{
+	return uvc_driver->format_index;
+}
+
 void uvc_function_update_frame_idx(uint32_t idx)
 {
 	uvc_driver->stream_frm_index = idx;
 }
 
-/**@}*/
+/**
+ * Set the size of each frame buffer, for compressed formats (e.g.
+ * Motion-JPEG) where frames do not fill the whole buffer.
+ * \param sizes Array of multi_buffers sizes, NULL for uncompressed frames.
+ */
+void uvc_function_set_frame_sizes(const volatile uint32_t *sizes)
+{
+	uvc_driver->frm_sizes = sizes;
+}
+
+/**
+ * Round the size of a compressed frame up so that, like uncompressed
+ * frames, its last payload uses all the high bandwidth transactions.
+ * \param size Size of the frame in bytes.
+ * \return Size to stream, at most FRAME_PACKET_SIZE_HS * ISO_HIGH_BW_MODE
+ * bytes more than size.
+ */
+uint32_t uvc_function_align_frame_size(uint32_t size)
+{
+#if (ISO_HIGH_BW_MODE == 1 || ISO_HIGH_BW_MODE == 2)
+	uint32_t nb_last;
 
+	if (!usbd_is_high_speed())
+		return size;
+
+	nb_last = size % (frm_max_pkt_size - FRAME_PAYLOAD_HDR_SIZE);
+	if (nb_last &&
+	    nb_last + FRAME_PAYLOAD_HDR_SIZE <= FRAME_PACKET_SIZE_HS * ISO_HIGH_BW_MODE)
+		size += FRAME_PACKET_SIZE_HS * ISO_HIGH_BW_MODE + 1 -
+			FRAME_PAYLOAD_HDR_SIZE - nb_last;
+#endif
+	return size;
+}
+
+/**@}*/
@@ -45,6 +45,13 @@
 #include <stdint.h>
 #include "usb/device/uvc/uvc_driver.h"
 
+/*------------------------------------------------------------------------------
+ *      Definitions
+ *------------------------------------------------------------------------------*/
+
+/** Number of payloads ((micro)frames) prepared in a single DMA chain */
+#define UVC_PAYLOADS_PER_CHAIN 64
+
 /*------------------------------------------------------------------------------
  *      Global functions
  *------------------------------------------------------------------------------*/
@@ -60,7 +67,10 @@ extern void uvc_function_get_cur(const USBGenericRequest *request);
 extern void uvc_function_set_cur(const USBGenericRequest *request);
 extern uint8_t uvc_function_is_video_on(void);
 extern uint8_t uvc_function_get_frame_format(void);
+extern uint8_t uvc_function_get_format_index(void);
 extern void uvc_function_update_frame_idx(uint32_t idx);
+extern void uvc_function_set_frame_sizes(const volatile uint32_t *sizes);
+extern uint32_t uvc_function_align_frame_size(uint32_t size);
 /**@}*/
 
 #endif /* UVCDRIVER_H */
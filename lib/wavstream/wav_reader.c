@@ -0,0 +1,297 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "timer.h"
+
+#include "wavstream/wav_reader.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define WAV_SECTOR_SIZE       512
+
+#define WAV_FORMAT_PCM        0x0001
+#define WAV_FORMAT_EXTENSIBLE 0xfffe
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint16_t _get_u16(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t _get_u32(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static FRESULT _read(struct _wav_reader* wav, void* data, uint32_t size)
+{
+	FRESULT res;
+	UINT read;
+
+	res = f_read(&wav->file, data, size, &read);
+	if (res == FR_OK && read != size)
+		res = FR_INVALID_OBJECT;
+	return res;
+}
+
+static FRESULT _parse_chunks(struct _wav_reader* wav)
+{
+	struct _wav_header* hdr = &wav->header;
+	uint8_t buf[40];
+	uint32_t pos, size;
+	bool has_fmt = false;
+	FRESULT res;
+
+	res = _read(wav, buf, 12);
+	if (res != FR_OK)
+		return res;
+	if (memcmp(buf, "RIFF", 4) || memcmp(buf + 8, "WAVE", 4))
+		return FR_INVALID_OBJECT;
+	hdr->chunk_id = _get_u32(buf);
+	hdr->chunk_size = _get_u32(buf + 4);
+	hdr->format = _get_u32(buf + 8);
+
+	for (pos = 12; pos + 8 <= f_size(&wav->file); ) {
+		res = _read(wav, buf, 8);
+		if (res != FR_OK)
+			return res;
+		size = _get_u32(buf + 4);
+
+		if (!memcmp(buf, "fmt ", 4)) {
+			if (size < 16)
+				return FR_INVALID_OBJECT;
+			hdr->subchunk1_id = _get_u32(buf);
+			res = _read(wav, buf, size < sizeof(buf) ? size : sizeof(buf));
+			if (res != FR_OK)
+				return res;
+			hdr->subchunk1_size = 16;
+			hdr->audio_format = _get_u16(buf);
+			hdr->num_channels = _get_u16(buf + 2);
+			hdr->sample_rate = _get_u32(buf + 4);
+			hdr->byte_rate = _get_u32(buf + 8);
+			hdr->block_align = _get_u16(buf + 12);
+			hdr->bits_per_sample = _get_u16(buf + 14);
+			/* WAVE_FORMAT_EXTENSIBLE: the sub-format GUID starts with the
+			 * actual format tag */
+			if (hdr->audio_format == WAV_FORMAT_EXTENSIBLE && size >= 40)
+				hdr->audio_format = _get_u16(buf + 24);
+			has_fmt = true;
+		} else if (!memcmp(buf, "data", 4)) {
+			hdr->subchunk2_id = _get_u32(buf);
+			wav->data_start = pos + 8;
+			/* streaming writers may leave the size at 0 or ~0 */
+			if (size == 0 || size > f_size(&wav->file) - wav->data_start)
+				size = f_size(&wav->file) - wav->data_start;
+			hdr->subchunk2_size = size;
+			wav->data_end = wav->data_start + size;
+			break;
+		}
+
+		pos += 8 + size + (size & 1);
+		res = f_lseek(&wav->file, pos);
+		if (res != FR_OK)
+			return res;
+	}
+
+	if (!has_fmt || !wav->data_start)
+		return FR_INVALID_OBJECT;
+	if (hdr->audio_format != WAV_FORMAT_PCM || !hdr->num_channels ||
+	    !hdr->block_align)
+		return FR_INVALID_OBJECT;
+
+	return FR_OK;
+}
+
+/** Restart the prefetch from the sector holding the first audio byte */
+static FRESULT _restart(struct _wav_reader* wav)
+{
+	uint32_t skip = wav->data_start & (WAV_SECTOR_SIZE - 1);
+	FRESULT res;
+
+	wav->file_pos = wav->data_start - skip;
+	wav->head = 0;
+	wav->tail = 0;
+
+	res = f_lseek(&wav->file, wav->file_pos);
+	if (res == FR_OK)
+		res = wav_reader_prefetch(wav);
+	if (res == FR_OK)
+		wav->tail = skip;
+	wav->stats.min_level = wav->ring_size;
+	return res;
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+FRESULT wav_reader_open(struct _wav_reader* wav, const TCHAR* path,
+		uint8_t* ring, uint32_t ring_size, uint32_t chunk)
+{
+	FRESULT res;
+
+	if (!ring || !chunk || (chunk & (WAV_SECTOR_SIZE - 1)) ||
+	    ring_size < chunk || (ring_size % chunk))
+		return FR_INVALID_PARAMETER;
+
+	memset(wav, 0, sizeof(*wav));
+	wav->ring = ring;
+	wav->ring_size = ring_size;
+	wav->chunk = chunk;
+
+	res = f_open(&wav->file, path, FA_READ);
+	if (res != FR_OK)
+		return res;
+
+	res = _parse_chunks(wav);
+	if (res == FR_OK)
+		res = _restart(wav);
+	if (res != FR_OK)
+		f_close(&wav->file);
+	return res;
+}
+
+FRESULT wav_reader_prefetch(struct _wav_reader* wav)
+{
+	uint32_t level, len, start, elapsed;
+	FRESULT res;
+	UINT read;
+
+	if (wav->file_pos < wav->data_end) {
+		level = wav->head - wav->tail;
+		if (level < wav->stats.min_level)
+			wav->stats.min_level = level;
+	}
+
+	while (wav->file_pos < wav->data_end &&
+	       wav->ring_size - (wav->head - wav->tail) >= wav->chunk) {
+		len = wav->data_end - wav->file_pos;
+		if (len > wav->chunk)
+			len = wav->chunk;
+
+		/* head only moves by whole chunks until the last read, so
+		 * the chunk never wraps */
+		start = timer_get_tick();
+		res = f_read(&wav->file, wav->ring + (wav->head % wav->ring_size),
+				len, &read);
+		elapsed = timer_get_interval(start, timer_get_tick());
+		if (elapsed > wav->stats.max_read_time)
+			wav->stats.max_read_time = elapsed;
+		if (res != FR_OK)
+			return res;
+
+		/* file shorter than announced */
+		if (read < len)
+			wav->data_end = wav->file_pos + read;
+		wav->file_pos += read;
+
+		/* publish the data before the new head */
+		dmb();
+		wav->head += read;
+	}
+
+	return FR_OK;
+}
+
+const void* wav_reader_peek(struct _wav_reader* wav, uint32_t* size)
+{
+	uint32_t level = wav->head - wav->tail;
+	uint32_t offset = wav->tail % wav->ring_size;
+
+	dmb();
+	if (level > wav->ring_size - offset)
+		level = wav->ring_size - offset;
+	*size = level;
+	return wav->ring + offset;
+}
+
+void wav_reader_consume(struct _wav_reader* wav, uint32_t size)
+{
+	uint32_t level = wav->head - wav->tail;
+
+	if (size > level)
+		size = level;
+	wav->tail += size;
+}
+
+uint32_t wav_reader_read(struct _wav_reader* wav, void* buffer, uint32_t size)
+{
+	uint8_t* dst = (uint8_t*)buffer;
+	const void* src;
+	uint32_t count, done = 0;
+
+	while (done < size) {
+		src = wav_reader_peek(wav, &count);
+		if (!count)
+			break;
+		if (count > size - done)
+			count = size - done;
+		memcpy(dst + done, src, count);
+		wav_reader_consume(wav, count);
+		done += count;
+	}
+
+	if (done < size && wav->file_pos < wav->data_end)
+		wav->stats.underruns++;
+
+	return done;
+}
+
+uint32_t wav_reader_get_level(const struct _wav_reader* wav)
+{
+	return wav->head - wav->tail;
+}
+
+bool wav_reader_is_eof(const struct _wav_reader* wav)
+{
+	return wav->file_pos >= wav->data_end && wav->head == wav->tail;
+}
+
+FRESULT wav_reader_rewind(struct _wav_reader* wav)
+{
+	return _restart(wav);
+}
+
+FRESULT wav_reader_close(struct _wav_reader* wav)
+{
+	return f_close(&wav->file);
+}
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Streaming WAV file reader on top of FatFs.
+ *
+ * Audio data is prefetched from the file into a ring buffer with large
+ * sector-aligned f_read() calls, so that FatFs transfers whole sectors
+ * straight into the ring. wav_reader_prefetch() is called from the main
+ * loop; the audio side (possibly a DMA callback) drains the ring with
+ * wav_reader_read() or, without copy, wav_reader_peek() and
+ * wav_reader_consume().
+ */
+
+#ifndef _WAV_READER_H_
+#define _WAV_READER_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "fatfs/src/ff.h"
+#include "wav.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief WAV reader statistics */
+struct _wav_reader_stats {
+	uint32_t underruns;     /**< Reads that found less data than requested */
+	uint32_t min_level;     /**< Lowest ring fill level seen, in bytes */
+	uint32_t max_read_time; /**< Longest f_read() call, in ms */
+};
+
+/** \brief WAV reader instance */
+struct _wav_reader {
+	FIL file;
+	struct _wav_header header;  /**< Format of the file (RIFF sizes unused) */
+	uint8_t* ring;              /**< Prefetch ring, cache-aligned */
+	uint32_t ring_size;         /**< Ring size, multiple of chunk */
+	uint32_t chunk;             /**< Read size, multiple of 512 */
+	uint32_t data_start;        /**< File offset of the audio data */
+	uint32_t data_end;          /**< File offset after the audio data */
+	uint32_t file_pos;          /**< Next file offset to prefetch */
+	/* free-running byte counters: head is written by the prefetch,
+	 * tail by the consumer, head - tail is the fill level */
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	struct _wav_reader_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Open a WAV file, parse its chunks and fill the prefetch ring.
+ * \param wav  Pointer to the reader instance.
+ * \param path  File path.
+ * \param ring  Prefetch ring buffer (cache-aligned).
+ * \param ring_size  Size of the ring, multiple of chunk.
+ * \param chunk  Size of each f_read(), multiple of 512 (e.g. cluster size).
+ * \return FR_OK on success, FR_INVALID_OBJECT if the file is not PCM WAV,
+ * a FatFs error code otherwise.
+ */
+extern FRESULT wav_reader_open(struct _wav_reader* wav, const TCHAR* path,
+		uint8_t* ring, uint32_t ring_size, uint32_t chunk);
+
+/**
+ * \brief Refill the ring with as many chunks as fit. Call from the main loop.
+ * \param wav  Pointer to the reader instance.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT wav_reader_prefetch(struct _wav_reader* wav);
+
+/**
+ * \brief Get the contiguous data available at the ring tail.
+ * \param wav  Pointer to the reader instance.
+ * \param size  Returns the number of contiguous bytes available.
+ * \return pointer to the data.
+ */
+extern const void* wav_reader_peek(struct _wav_reader* wav, uint32_t* size);
+
+/**
+ * \brief Release data returned by wav_reader_peek().
+ * \param wav  Pointer to the reader instance.
+ * \param size  Number of bytes consumed.
+ */
+extern void wav_reader_consume(struct _wav_reader* wav, uint32_t size);
+
+/**
+ * \brief Copy audio data out of the ring.
+ * \param wav  Pointer to the reader instance.
+ * \param buffer  Destination.
+ * \param size  Number of bytes wanted.
+ * \return number of bytes copied, short only on underrun or end of data.
+ */
+extern uint32_t wav_reader_read(struct _wav_reader* wav, void* buffer,
+		uint32_t size);
+
+/**
+ * \brief Get the number of bytes currently prefetched.
+ */
+extern uint32_t wav_reader_get_level(const struct _wav_reader* wav);
+
+/**
+ * \brief Check whether all audio data has been consumed.
+ */
+extern bool wav_reader_is_eof(const struct _wav_reader* wav);
+
+/**
+ * \brief Restart from the beginning of the audio data.
+ * Must not be called while the consumer is active.
+ * \param wav  Pointer to the reader instance.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT wav_reader_rewind(struct _wav_reader* wav);
+
+/**
+ * \brief Close the WAV file.
+ * \param wav  Pointer to the reader instance.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT wav_reader_close(struct _wav_reader* wav);
+
+#endif /* _WAV_READER_H_ */
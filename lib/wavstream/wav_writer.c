@@ -0,0 +1,352 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "timer.h"
+
+#include "wavstream/wav_writer.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define WAV_SECTOR_SIZE     512
+
+/** Size of the RIFF, "fmt " and "JUNK" chunk headers before the padding */
+#define WAV_FIXED_HEADER    44
+
+/** Largest file a 32-bit RIFF size can describe */
+#define WAV_MAX_FILE_SIZE   0xffffffffu
+
+/** Default interval between header updates, in seconds of audio */
+#define WAV_SYNC_SECONDS    10
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t* _put_u16(uint8_t* p, uint16_t value)
+{
+	p[0] = value & 0xff;
+	p[1] = value >> 8;
+	return p + 2;
+}
+
+static uint8_t* _put_u32(uint8_t* p, uint32_t value)
+{
+	p[0] = value & 0xff;
+	p[1] = (value >> 8) & 0xff;
+	p[2] = (value >> 16) & 0xff;
+	p[3] = value >> 24;
+	return p + 4;
+}
+
+static uint8_t* _put_fourcc(uint8_t* p, const char* fourcc)
+{
+	memcpy(p, fourcc, 4);
+	return p + 4;
+}
+
+static FRESULT _write(struct _wav_writer* wav, const void* data, uint32_t size)
+{
+	uint32_t start, elapsed;
+	FRESULT res;
+	UINT written;
+
+	start = timer_get_tick();
+	res = f_write(&wav->file, data, size, &written);
+	elapsed = timer_get_interval(start, timer_get_tick());
+	if (elapsed > wav->stats.max_write_time)
+		wav->stats.max_write_time = elapsed;
+
+	if (res == FR_OK && written != size)
+		res = FR_DENIED;
+	return res;
+}
+
+/** Build the header, padded to one chunk, at the start of the ring */
+static void _build_header(struct _wav_writer* wav)
+{
+	uint16_t block_align = wav->num_channels * ((wav->bits_per_sample + 7) / 8);
+	uint8_t* p = wav->ring;
+
+	memset(p, 0, wav->chunk);
+	p = _put_fourcc(p, "RIFF");
+	p = _put_u32(p, wav->chunk - 8);
+	p = _put_fourcc(p, "WAVE");
+	p = _put_fourcc(p, "fmt ");
+	p = _put_u32(p, 16);
+	p = _put_u16(p, 1);
+	p = _put_u16(p, wav->num_channels);
+	p = _put_u32(p, wav->sample_rate);
+	p = _put_u32(p, wav->sample_rate * block_align);
+	p = _put_u16(p, block_align);
+	p = _put_u16(p, wav->bits_per_sample);
+	p = _put_fourcc(p, "JUNK");
+	_put_u32(p, wav->chunk - WAV_FIXED_HEADER - 8);
+	p = wav->ring + wav->chunk - 8;
+	p = _put_fourcc(p, "data");
+	_put_u32(p, 0);
+}
+
+/** Extend the file allocation to 'size' bytes, keeping the file pointer */
+static FRESULT _allocate(struct _wav_writer* wav, uint32_t size)
+{
+	FSIZE_t pos = f_tell(&wav->file);
+	FRESULT res;
+
+	res = f_lseek(&wav->file, size);
+	/* f_lseek() stops at the last cluster it could allocate */
+	if (res == FR_OK && f_tell(&wav->file) != size)
+		res = FR_DENIED;
+	wav->allocated = f_size(&wav->file);
+	if (res == FR_OK)
+		res = f_lseek(&wav->file, pos);
+	else
+		f_lseek(&wav->file, pos);
+	return res;
+}
+
+/** Write the current sizes to the header and commit the file */
+static FRESULT _update_header(struct _wav_writer* wav)
+{
+	FSIZE_t pos = f_tell(&wav->file);
+	uint8_t value[4];
+	FRESULT res;
+
+	_put_u32(value, wav->chunk + wav->data_size - 8);
+	res = f_lseek(&wav->file, 4);
+	if (res == FR_OK)
+		res = _write(wav, value, 4);
+
+	_put_u32(value, wav->data_size);
+	if (res == FR_OK)
+		res = f_lseek(&wav->file, wav->chunk - 4);
+	if (res == FR_OK)
+		res = _write(wav, value, 4);
+
+	if (res == FR_OK)
+		res = f_lseek(&wav->file, pos);
+	if (res == FR_OK)
+		res = f_sync(&wav->file);
+	if (res == FR_OK)
+		wav->synced = wav->data_size;
+	return res;
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+FRESULT wav_writer_open(struct _wav_writer* wav, const TCHAR* path,
+		uint16_t channels, uint32_t sample_rate, uint16_t bits,
+		uint8_t* ring, uint32_t ring_size, uint32_t chunk,
+		uint32_t preallocate)
+{
+	FRESULT res;
+	bool expanded = false;
+
+	if (!ring || !channels || !sample_rate || !bits)
+		return FR_INVALID_PARAMETER;
+
+	memset(wav, 0, sizeof(*wav));
+	wav->num_channels = channels;
+	wav->sample_rate = sample_rate;
+	wav->bits_per_sample = bits;
+	wav->ring = ring;
+	wav->ring_size = ring_size;
+
+	res = f_open(&wav->file, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+		return res;
+
+	if (!chunk)
+		chunk = wav->file.obj.fs->csize * WAV_SECTOR_SIZE;
+	if ((chunk & (WAV_SECTOR_SIZE - 1)) || ring_size < 2 * chunk ||
+	    (ring_size % chunk)) {
+		f_close(&wav->file);
+		return FR_INVALID_PARAMETER;
+	}
+	wav->chunk = chunk;
+	wav->grow = preallocate ? preallocate : 16 * chunk;
+	wav->grow = ((wav->grow + chunk - 1) / chunk) * chunk;
+	wav->sync_interval = WAV_SYNC_SECONDS * sample_rate * channels * ((bits + 7) / 8);
+
+#if _USE_EXPAND
+	/* a contiguous block keeps the card writing sequentially; fall back
+	 * to a regular allocation if the volume is too fragmented */
+	if (f_expand(&wav->file, chunk + wav->grow, 1) == FR_OK) {
+		wav->allocated = f_size(&wav->file);
+		expanded = true;
+	}
+#endif
+	if (!expanded)
+		res = _allocate(wav, chunk + wav->grow);
+	if (res == FR_OK)
+		res = f_lseek(&wav->file, 0);
+
+	if (res == FR_OK) {
+		_build_header(wav);
+		res = _write(wav, wav->ring, chunk);
+	}
+	if (res == FR_OK)
+		res = f_sync(&wav->file);
+
+	if (res != FR_OK)
+		f_close(&wav->file);
+	return res;
+}
+
+void* wav_writer_get_buffer(struct _wav_writer* wav, uint32_t size)
+{
+	uint32_t offset = wav->head % wav->ring_size;
+	uint32_t space = wav->ring_size - (wav->head - wav->tail);
+
+	if (space < size) {
+		wav->stats.overruns++;
+		return NULL;
+	}
+	/* not contiguous: the caller can still use wav_writer_write() */
+	if (wav->ring_size - offset < size)
+		return NULL;
+	return wav->ring + offset;
+}
+
+void wav_writer_commit(struct _wav_writer* wav, uint32_t size)
+{
+	uint32_t level;
+
+	/* publish the data before the new head */
+	dmb();
+	wav->head += size;
+
+	level = wav->head - wav->tail;
+	if (level > wav->stats.max_level)
+		wav->stats.max_level = level;
+}
+
+uint32_t wav_writer_write(struct _wav_writer* wav, const void* data,
+		uint32_t size)
+{
+	const uint8_t* src = (const uint8_t*)data;
+	uint32_t offset, count, done = 0;
+	uint32_t space = wav->ring_size - (wav->head - wav->tail);
+
+	if (size > space) {
+		wav->stats.overruns++;
+		size = space;
+	}
+
+	while (done < size) {
+		offset = wav->head % wav->ring_size;
+		count = wav->ring_size - offset;
+		if (count > size - done)
+			count = size - done;
+		memcpy(wav->ring + offset, src + done, count);
+		wav_writer_commit(wav, count);
+		done += count;
+	}
+
+	return done;
+}
+
+FRESULT wav_writer_flush(struct _wav_writer* wav)
+{
+	FRESULT res;
+
+	while (wav->head - wav->tail >= wav->chunk) {
+		if (wav->data_size > WAV_MAX_FILE_SIZE - 2 * wav->chunk)
+			return FR_DENIED;
+
+		/* keep at least one chunk allocated ahead of the write */
+		if (wav->chunk + wav->data_size + 2 * wav->chunk > wav->allocated) {
+			res = _allocate(wav, wav->allocated + wav->grow);
+			if (res != FR_OK)
+				return res;
+		}
+
+		/* tail only moves by whole chunks, so the chunk never wraps */
+		dmb();
+		res = _write(wav, wav->ring + (wav->tail % wav->ring_size),
+				wav->chunk);
+		if (res != FR_OK)
+			return res;
+		wav->tail += wav->chunk;
+		wav->data_size += wav->chunk;
+
+		if (wav->data_size - wav->synced >= wav->sync_interval) {
+			res = _update_header(wav);
+			if (res != FR_OK)
+				return res;
+		}
+	}
+
+	return FR_OK;
+}
+
+FRESULT wav_writer_close(struct _wav_writer* wav)
+{
+	uint32_t remaining;
+	FRESULT res;
+
+	res = wav_writer_flush(wav);
+
+	remaining = wav->head - wav->tail;
+	if (res == FR_OK && remaining) {
+		dmb();
+		res = _write(wav, wav->ring + (wav->tail % wav->ring_size),
+				remaining);
+		if (res == FR_OK) {
+			wav->tail += remaining;
+			wav->data_size += remaining;
+		}
+	}
+
+	if (res == FR_OK)
+		res = _update_header(wav);
+#if !_FS_MINIMIZE
+	/* release the pre-allocated clusters past the audio data */
+	if (res == FR_OK)
+		res = f_truncate(&wav->file);
+#endif
+
+	if (res == FR_OK)
+		res = f_close(&wav->file);
+	else
+		f_close(&wav->file);
+
+	return res;
+}
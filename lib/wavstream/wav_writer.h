@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Streaming WAV file writer on top of FatFs.
+ *
+ * The audio side (possibly a DMA callback) queues recorded periods in a ring
+ * buffer with wav_writer_write() or, without copy, wav_writer_get_buffer()
+ * and wav_writer_commit(). wav_writer_flush() is called from the main loop
+ * and writes the ring to the file in whole chunks.
+ *
+ * The header is padded with a "JUNK" chunk to exactly one chunk, so with
+ * the chunk set to the cluster size every f_write() covers one whole
+ * cluster and FatFs transfers it straight from the ring. The file is
+ * pre-allocated (contiguously when _USE_EXPAND is enabled) and grown ahead
+ * of the write position, so no cluster allocation happens on a chunk write.
+ * The sizes in the header are refreshed on every sync, so a recording cut
+ * by a power loss stays playable up to the last sync.
+ */
+
+#ifndef _WAV_WRITER_H_
+#define _WAV_WRITER_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "fatfs/src/ff.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief WAV writer statistics */
+struct _wav_writer_stats {
+	uint32_t overruns;       /**< Periods dropped because the ring was full */
+	uint32_t max_level;      /**< Highest ring fill level seen, in bytes */
+	uint32_t max_write_time; /**< Longest f_write() call, in ms */
+};
+
+/** \brief WAV writer instance */
+struct _wav_writer {
+	FIL file;
+	uint16_t num_channels;
+	uint32_t sample_rate;
+	uint16_t bits_per_sample;
+	uint8_t* ring;             /**< Write ring, cache-aligned */
+	uint32_t ring_size;        /**< Ring size, multiple of chunk */
+	uint32_t chunk;            /**< Write size, multiple of 512 */
+	uint32_t data_size;        /**< Audio bytes written to the file */
+	uint32_t allocated;        /**< Bytes allocated to the file */
+	uint32_t grow;             /**< Allocation increment */
+	uint32_t sync_interval;    /**< Audio bytes between header updates */
+	uint32_t synced;           /**< data_size at the last header update */
+	/* free-running byte counters: head is written by the producer,
+	 * tail by wav_writer_flush(), head - tail is the fill level */
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	struct _wav_writer_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Create a WAV file, pre-allocate it and write its header.
+ * \param wav  Pointer to the writer instance.
+ * \param path  File path.
+ * \param channels  Number of channels.
+ * \param sample_rate  Sample rate in Hz.
+ * \param bits  Bits per sample.
+ * \param ring  Write ring buffer (cache-aligned).
+ * \param ring_size  Size of the ring, multiple of chunk and at least two
+ * chunks.
+ * \param chunk  Size of each f_write(), multiple of 512, or 0 to use the
+ * cluster size of the volume.
+ * \param preallocate  Bytes to allocate up front, also used as the growth
+ * increment (0 for 16 chunks).
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT wav_writer_open(struct _wav_writer* wav, const TCHAR* path,
+		uint16_t channels, uint32_t sample_rate, uint16_t bits,
+		uint8_t* ring, uint32_t ring_size, uint32_t chunk,
+		uint32_t preallocate);
+
+/**
+ * \brief Get a contiguous area of the ring to record into.
+ * For zero-copy DMA, use a period size that divides the ring size.
+ * \param wav  Pointer to the writer instance.
+ * \param size  Number of bytes needed.
+ * \return pointer to the area, or NULL on overrun or if the free space
+ * wraps around the end of the ring.
+ */
+extern void* wav_writer_get_buffer(struct _wav_writer* wav, uint32_t size);
+
+/**
+ * \brief Queue data recorded in an area from wav_writer_get_buffer().
+ * \param wav  Pointer to the writer instance.
+ * \param size  Number of bytes recorded.
+ */
+extern void wav_writer_commit(struct _wav_writer* wav, uint32_t size);
+
+/**
+ * \brief Copy data into the ring.
+ * \param wav  Pointer to the writer instance.
+ * \param data  Audio data.
+ * \param size  Number of bytes.
+ * \return number of bytes queued, short on overrun.
+ */
+extern uint32_t wav_writer_write(struct _wav_writer* wav, const void* data,
+		uint32_t size);
+
+/**
+ * \brief Write all complete chunks of the ring to the file.
+ * Call from the main loop.
+ * \param wav  Pointer to the writer instance.
+ * \return FR_OK on success, FR_DENIED when the 4GB WAV limit is reached,
+ * a FatFs error code otherwise.
+ */
+extern FRESULT wav_writer_flush(struct _wav_writer* wav);
+
+/**
+ * \brief Write the remaining data, finalize the header and close the file.
+ * \param wav  Pointer to the writer instance.
+ * \return FR_OK on success, a FatFs error code otherwise.
+ */
+extern FRESULT wav_writer_close(struct _wav_writer* wav);
+
+#endif /* _WAV_WRITER_H_ */
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+#         SAM Software Package License
+# ----------------------------------------------------------------------------
+# Copyright (c) 2016, Atmel Corporation
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# - Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the disclaimer below.
+#
+# Atmel's name may not be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+# IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+# DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+# ----------------------------------------------------------------------------
+
+"""
+Generate a proportional font blob for lcd_pfont (utils/lcd_pfont.h).
+
+Glyphs are rendered with anti-aliasing from a TrueType/OpenType font by
+Pillow, or from the font built into Pillow (Aileron Regular, public domain)
+when no font file is given, and quantized to 1, 2, 4 or 8 bits of coverage.
+
+The output is either a C source file defining a 4-byte aligned array, or
+a raw binary blob to be placed e.g. in QSPI flash:
+
+  scripts/pfont_gen.py --size 16 --bpp 4 --name lcdd_pfont_sans_16 \\
+      -o utils/lcd_pfont_sans_16.c
+  scripts/pfont_gen.py --font DejaVuSans.ttf --size 24 -o font24.bin
+"""
+
+import argparse
+import struct
+import sys
+
+try:
+    from PIL import Image, ImageDraw, ImageFont
+except ImportError:
+    sys.exit("pfont_gen.py needs Pillow (pip install pillow)")
+
+LCDD_PFONT_MAGIC = 0x544E4650
+LCDD_PFONT_VERSION = 1
+
+HEADER = struct.Struct("<IBBBBHHI")   # struct _lcdd_pfont_header
+GLYPH = struct.Struct("<IBBbbB3x")     # struct _lcdd_pfont_glyph
+
+
+def load_font(path, size):
+    if path:
+        return ImageFont.truetype(path, size)
+    try:
+        return ImageFont.load_default(size)
+    except TypeError:
+        sys.exit("this Pillow has no scalable built-in font, use --font")
+
+
+def render_glyph(font, char, bpp):
+    """Return (width, height, left, top, advance, packed rows)."""
+    advance = int(round(font.getlength(char)))
+    left, top, right, bottom = font.getbbox(char)
+    width, height = right - left, bottom - top
+    if width <= 0 or height <= 0:
+        return 0, 0, 0, 0, advance, b""
+
+    image = Image.new("L", (width, height), 0)
+    ImageDraw.Draw(image).text((-left, -top), char, font=font, fill=255)
+
+    levels = (1 << bpp) - 1
+    rows = bytearray()
+    for y in range(height):
+        acc = nbits = 0
+        for x in range(width):
+            value = (image.getpixel((x, y)) * levels + 127) // 255
+            acc = (acc << bpp) | value
+            nbits += bpp
+            if nbits == 8:
+                rows.append(acc)
+                acc = nbits = 0
+        if nbits:
+            rows.append(acc << (8 - nbits))
+    return width, height, left, top, advance, bytes(rows)
+
+
+def build_blob(font, bpp, first, last):
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    count = last - first + 1
+    if height > 255 or ascent > 255:
+        sys.exit("font too large for the blob format")
+
+    glyphs = []
+    bitmaps = bytearray()
+    offset = HEADER.size + GLYPH.size * count
+    for code in range(first, last + 1):
+        width, h, left, top, advance, rows = render_glyph(font, chr(code), bpp)
+        if width > 255 or h > 255 or advance > 255 or \
+           not -128 <= left <= 127 or not -128 <= top <= 127:
+            sys.exit("glyph %r out of the blob format range" % chr(code))
+        glyphs.append(GLYPH.pack(offset + len(bitmaps) if width else 0,
+                                 width, h, left, top, advance))
+        bitmaps += rows
+
+    blob = HEADER.pack(LCDD_PFONT_MAGIC, LCDD_PFONT_VERSION, bpp, height,
+                       ascent, first, count, 0)
+    blob += b"".join(glyphs) + bitmaps
+    blob += b"\0" * (-len(blob) % 4)
+    return blob, height
+
+
+C_HEADER = """/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+"""
+
+
+def write_c(path, name, blob, description):
+    with open(path, "w") as out:
+        out.write(C_HEADER)
+        out.write("\n/** \\file\n *\n * %s\n *\n"
+                  " * Generated by scripts/pfont_gen.py, do not edit.\n */\n\n"
+                  % description)
+        out.write('#include "compiler.h"\n\n#include <stdint.h>\n\n')
+        out.write("ALIGNED(4) const uint8_t %s[%d] = {\n" % (name, len(blob)))
+        for i in range(0, len(blob), 12):
+            line = ", ".join("0x%02X" % b for b in blob[i:i + 12])
+            out.write("\t%s,\n" % line)
+        out.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate an lcd_pfont proportional font blob")
+    parser.add_argument("--font", help="TrueType/OpenType font file "
+                        "(default: font built into Pillow)")
+    parser.add_argument("--size", type=int, required=True,
+                        help="font size in pixels")
+    parser.add_argument("--bpp", type=int, choices=(1, 2, 4, 8), default=4,
+                        help="bits per coverage value (default: 4)")
+    parser.add_argument("--first", type=int, default=0x20,
+                        help="first character code (default: 0x20)")
+    parser.add_argument("--last", type=int, default=0x7E,
+                        help="last character code (default: 0x7E)")
+    parser.add_argument("--name", default="pfont",
+                        help="C array name (default: pfont)")
+    parser.add_argument("-o", "--output", required=True,
+                        help="output file, C source if it ends with .c, "
+                             "raw blob otherwise")
+    args = parser.parse_args()
+
+    if not 0 <= args.first <= args.last <= 0xFF:
+        parser.error("character codes must be in 0..255")
+
+    font = load_font(args.font, args.size)
+    blob, height = build_blob(font, args.bpp, args.first, args.last)
+
+    if args.output.endswith(".c"):
+        family = " ".join(n for n in font.getname() if n)
+        write_c(args.output, args.name, blob,
+                "%s, %dpx (line height %d), %d bpp, characters 0x%02X-0x%02X."
+                % (family, args.size, height, args.bpp, args.first,
+                   args.last))
+    else:
+        with open(args.output, "wb") as out:
+            out.write(blob)
+    print("%s: %d bytes" % (args.output, len(blob)))
+
+
+if __name__ == "__main__":
+    main()
@@ -77,6 +77,7 @@ F_BIT           DEFINE 0x40
         EXTERN  prefetch_abort_irq_handler
         EXTERN  data_abort_irq_handler
         EXTERN  software_interrupt_irq_handler
+        EXTERN  irq_dispatch
 
         DATA
 
@@ -139,9 +140,11 @@ irqHandler:
         ldr         r0, [r14, #AIC_IVR]
         str         lr, [r14, #AIC_IVR]
 
-        ; Branch to interrupt handler in Supervisor mode
+        ; Branch to interrupt handler in Supervisor mode, IRQs still masked:
+        ; irq_dispatch() unmasks them around the handler so that sources of
+        ; higher AIC priority can preempt it
 
-        msr         CPSR_c, #ARM_MODE_SVC
+        msr         CPSR_c, #ARM_MODE_SVC | I_BIT
         stmfd       sp!, { r1-r3, r4, r12, lr}
 
         ; Check for 8-byte alignment and save lr plus a
@@ -151,19 +154,19 @@ irqHandler:
         sub         sp, sp, r1
         stmfd       sp!, {r1, lr}
 
-        blx         r0
+        bl          irq_dispatch
 
         ldmia       sp!, {r1, lr}
         add         sp, sp, r1
 
+        ; Branch to the routine returned by irq_dispatch(), if any, with the
+        ; interrupted context restored but r0
+
+        cmp         r0, #0
         ldmia       sp!, { r1-r3, r4, r12, lr}
+        bxne        r0
         msr         CPSR_c, #ARM_MODE_IRQ | I_BIT
 
-        ; Acknowledge interrupt
-
-        ldr         lr, =AT91C_BASE_AIC
-        str         lr, [r14, #AIC_EOICR]
-
         ; Restore interrupt context and branch back to calling code
 
         ldmia       sp!, {r0, lr}
@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Minimal test harness for the host tests: checks, test runner and cycle
+ * counter. Libraries and utilities tested on the host only depend on the C
+ * library, or on the driver interfaces stubbed in tests/host/stubs, see
+ * tests/host/Makefile.
+ */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Checks
+ *----------------------------------------------------------------------------*/
+
+static int _host_test_failures;
+static int _host_test_checks;
+
+/** Check that a condition holds, report it and go on otherwise */
+#define CHECK(cond) do {\
+		_host_test_checks++;\
+		if (!(cond)) {\
+			_host_test_failures++;\
+			printf("%s:%d: check failed: %s\n",\
+			       __FILE__, __LINE__, #cond);\
+		}\
+	} while (0)
+
+/** Check that two integers are equal, report both values otherwise */
+#define CHECK_EQ(a, b) do {\
+		long long _a = (long long)(a), _b = (long long)(b);\
+		_host_test_checks++;\
+		if (_a != _b) {\
+			_host_test_failures++;\
+			printf("%s:%d: check failed: %s == %s (%lld != %lld)\n",\
+			       __FILE__, __LINE__, #a, #b, _a, _b);\
+		}\
+	} while (0)
+
+/** Run a test function */
+#define RUN(test) do {\
+		int _failures = _host_test_failures;\
+		printf("  %s\n", #test);\
+		test();\
+		if (_host_test_failures != _failures)\
+			printf("  %s: FAILED\n", #test);\
+	} while (0)
+
+/**
+ * \brief Report the results.
+ * \return exit status of the test program
+ */
+static inline int host_test_result(void)
+{
+	printf("%d checks, %d failures\n", _host_test_checks,
+	       _host_test_failures);
+	return _host_test_failures ? 1 : 0;
+}
+
+/*----------------------------------------------------------------------------
+ *         Cycle counter
+ *----------------------------------------------------------------------------*/
+
+static int _host_cycles_fd = -2;
+static uint64_t _host_cycles_ns;
+
+static inline uint64_t _host_test_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * \brief Whether the host cycle counter is readable. Without it (no perf
+ * events support or no permission), the measures are in nanoseconds.
+ */
+static inline bool host_cycles_available(void)
+{
+#ifdef __linux__
+	if (_host_cycles_fd == -2) {
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		_host_cycles_fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+				-1, 0);
+	}
+	return _host_cycles_fd >= 0;
+#else
+	return false;
+#endif
+}
+
+static inline void host_cycles_start(void)
+{
+	if (host_cycles_available()) {
+#ifdef __linux__
+		ioctl(_host_cycles_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(_host_cycles_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	} else {
+		_host_cycles_ns = _host_test_ns();
+	}
+}
+
+/**
+ * \brief Stop measuring.
+ * \return cycles, or nanoseconds if !host_cycles_available(), elapsed
+ * since host_cycles_start()
+ */
+static inline uint64_t host_cycles_stop(void)
+{
+	uint64_t count = 0;
+
+	if (host_cycles_available()) {
+#ifdef __linux__
+		ioctl(_host_cycles_fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(_host_cycles_fd, &count, sizeof(count))
+				!= sizeof(count))
+			count = 0;
+#endif
+	} else {
+		count = _host_test_ns() - _host_cycles_ns;
+	}
+	return count;
+}
+
+#endif /* _HOST_TEST_H_ */
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host stub of the DMA driver interface: the subset used by the utilities
+ * built by the host tests. The test programs implement the functions, for
+ * instance with memcpy.
+ */
+
+#ifndef _DMA_H_
+#define _DMA_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+#define DMA_PERIPH_MEMORY  0xFF
+
+#define DMA_MAX_BT_SIZE    0xFFFFFF
+
+#define DMA_DATA_WIDTH_BYTE        0
+#define DMA_DATA_WIDTH_HALF_WORD   1
+#define DMA_DATA_WIDTH_WORD        2
+#define DMA_DATA_WIDTH_DWORD       3
+
+#define DMA_CHUNK_SIZE_1   0
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+struct dma_channel;
+
+struct dma_xfer_item_tmpl {
+	uint8_t upd_sa_per_data : 1;
+	uint8_t upd_da_per_data : 1;
+	uint8_t upd_sa_per_blk : 1;
+	uint8_t upd_da_per_blk : 1;
+	const void *sa;
+	void* da;
+	uint8_t data_width;
+	uint8_t chunk_size;
+	uint32_t blk_size;
+};
+
+struct dma_xfer_item {
+	const void *sa;
+	void *da;
+	uint32_t size;                  /**< in bytes */
+	struct dma_xfer_item *next;
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+extern void dma_poll(void);
+
+extern struct dma_channel *dma_allocate_channel(uint8_t src, uint8_t dest);
+
+extern uint32_t dma_start_transfer(struct dma_channel *channel);
+
+extern uint32_t dma_prepare_item(struct dma_channel *channel,
+				const struct dma_xfer_item_tmpl *tmpl,
+				struct dma_xfer_item *item);
+
+extern uint32_t dma_link_item(struct dma_channel *channel,
+				struct dma_xfer_item *item,
+				struct dma_xfer_item *next_item);
+
+extern uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
+				struct dma_xfer_item_tmpl *tmpl,
+				struct dma_xfer_item *desc_list);
+
+extern bool dma_is_transfer_done(struct dma_channel *channel);
+
+#endif /* _DMA_H_ */
@@ -0,0 +1,568 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test and trace replay of the AE/AWB control loop (utils/cam_3a.c).
+ *
+ * A Bayer sensor model turns simulated scenes into the four channel
+ * histograms of the ISC. The closed loop must converge to the white balance
+ * that cancels the illuminant and to the target exposure, stay stable, and
+ * protect highlights.
+ *
+ * Every *.trace file in CAM_3A_TRACES (see cam_3a.h for the format) is
+ * then replayed, and each update must give the recorded gains and
+ * exposure. Board traces are printed by isc_3a_set_trace() ('T' in the isc
+ * example). "test_cam_3a --record <scene>" prints the trace of a simulated
+ * scene.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "host_test.h"
+
+#include "cam_3a.h"
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+#define ARRAY_SIZE(a)  (sizeof(a) / sizeof((a)[0]))
+
+#ifndef CAM_3A_TRACES
+#define CAM_3A_TRACES  "data/cam_3a"
+#endif
+
+/** Pixels of each Bayer channel */
+#define SENSOR_WIDTH   80
+#define SENSOR_HEIGHT  60
+
+/** Updates of the closed loop runs, and of the recorded traces */
+#define UPDATES        48
+#define RECORD_UPDATES 24
+
+/** Updates checked for stability at the end of a run */
+#define SETTLED        16
+
+/** OV5640 limits: exposure in 1/16 line, VTS 0x3d8, gain in 1/16 */
+#define EXPOSURE_MIN   16
+#define EXPOSURE_MAX   ((0x3d8 - 4) << 4)
+#define GAIN_MIN       0x10
+#define GAIN_MAX       0xf8
+#define GAIN_ONE       0x10
+
+/** Exposure time and gain giving the mean level of the AE target with a
+ * 18% gray scene */
+#define EXPOSURE_REF   4000
+
+/** Longest trace line: "H c first n" and 512 counts */
+#define LINE_SIZE      (32 + CAM_3A_HIST_ENTRIES * 11)
+
+/*----------------------------------------------------------------------------
+ *         Local types
+ *----------------------------------------------------------------------------*/
+
+/** Simulated scene */
+struct _scene {
+	const char *name;
+	double response[CAM_3A_CHANNELS]; /**< illuminant and sensor, per channel */
+	double brightness;                /**< 1.0: 18% gray at EXPOSURE_REF */
+	double highlight;                 /**< share of the scene 10 times brighter */
+	bool ae;                          /**< sensor with manual exposure control */
+	uint32_t exposure;                /**< initial exposure time */
+	uint16_t gain;                    /**< initial gain */
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static const struct _scene scenes[] = {
+	{ "tungsten",   { 1.0, 1.5, 1.0, 0.45 }, 1.0,  0.0,  true,  1500, GAIN_ONE },
+	{ "daylight",   { 1.0, 0.8, 1.0, 0.9 },  1.0,  0.0,  true,  9000, GAIN_ONE },
+	{ "dark",       { 1.0, 1.1, 1.0, 0.8 },  0.05, 0.0,  true,  4000, GAIN_ONE },
+	{ "highlights", { 1.0, 1.0, 1.0, 1.0 },  1.0,  0.06, true,  4000, GAIN_ONE },
+	{ "no_ae",      { 1.0, 0.7, 1.0, 1.3 },  1.0,  0.0,  false, 0,    0 },
+};
+
+static uint32_t hist_data[CAM_3A_CHANNELS][CAM_3A_HIST_ENTRIES];
+
+static const uint32_t *const hist[CAM_3A_CHANNELS] = {
+	hist_data[0], hist_data[1], hist_data[2], hist_data[3],
+};
+
+static char line[LINE_SIZE];
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _scene_cfg(const struct _scene *scene, struct _cam_3a_cfg *cfg)
+{
+	cam_3a_default_cfg(cfg);
+	if (scene->ae) {
+		cfg->ae_enabled = true;
+		cfg->exposure_min = EXPOSURE_MIN;
+		cfg->exposure_max = EXPOSURE_MAX;
+		cfg->gain_min = GAIN_MIN;
+		cfg->gain_max = GAIN_MAX;
+		cfg->gain_one = GAIN_ONE;
+	}
+}
+
+/**
+ * \brief Fill the histograms of a frame set of the scene.
+ * \param frame  frame number, seeds the noise
+ */
+static void _sensor_capture(const struct _scene *scene, uint32_t exposure,
+		uint16_t gain, uint32_t gain_one, unsigned frame)
+{
+	const double k = (CAM_3A_HIST_ENTRIES * 18 / 100)
+		/ (0.18 * EXPOSURE_REF);
+	double scale = k * scene->brightness * exposure * gain / gain_one;
+	unsigned seed = 12345 + frame * 7919;
+	/* Gr and Gb see the same color */
+	static const double tint_phase[CAM_3A_CHANNELS] = { 0.0, 2.1, 0.0, 4.2 };
+	double r, level;
+	int c, x, y, entry;
+
+	if (!scene->ae)
+		scale = k * scene->brightness * EXPOSURE_REF;
+
+	memset(hist_data, 0, sizeof(hist_data));
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		for (y = 0; y < SENSOR_HEIGHT; y++) {
+			for (x = 0; x < SENSOR_WIDTH; x++) {
+				/* gray shades, mean about 18%, with color
+				 * bands that average out over the width */
+				r = 0.03 + 0.3 * (0.5 + 0.5 * sin(x * 0.21)
+						* cos(y * 0.17));
+				r *= 1.0 + 0.3 * sin(x * 4 * M_PI / SENSOR_WIDTH
+						+ tint_phase[c]);
+				if (x < SENSOR_WIDTH * scene->highlight)
+					r *= 10.0;
+				level = r * scene->response[c] * scale;
+				/* read noise, +/- 1.5 entry */
+				seed = seed * 1103515245 + 12345;
+				level += ((seed >> 16) & 0xff) * 3.0 / 255 - 1.5;
+				entry = (int)lrint(level);
+				if (entry < 0)
+					entry = 0;
+				if (entry >= CAM_3A_HIST_ENTRIES)
+					entry = CAM_3A_HIST_ENTRIES - 1;
+				hist_data[c][entry]++;
+			}
+		}
+	}
+}
+
+static void _print_state(FILE *out, const struct _cam_3a_state *state)
+{
+	const struct _cam_3a_cfg *cfg = &state->cfg;
+
+	fprintf(out, "C %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u %u\n",
+		cfg->wb_gain_min, cfg->wb_gain_max, cfg->wb_white_patch,
+		cfg->wb_percentile, cfg->wb_step, cfg->ae_enabled,
+		cfg->ae_target, cfg->ae_tolerance, cfg->ae_saturation,
+		cfg->ae_step, cfg->ae_interval, cfg->exposure_min,
+		cfg->exposure_max, cfg->gain_min, cfg->gain_max, cfg->gain_one);
+	fprintf(out, "I %u %u %u %u %u %u %u\n", state->exposure, state->gain,
+		state->wb_gain[CAM_3A_GR], state->wb_gain[CAM_3A_R],
+		state->wb_gain[CAM_3A_GB], state->wb_gain[CAM_3A_B],
+		state->ae_wait);
+}
+
+static void _print_update(FILE *out, const struct _cam_3a_state *state,
+		uint8_t changed)
+{
+	int c, i, first, last;
+
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		first = 0;
+		last = CAM_3A_HIST_ENTRIES - 1;
+		while (first < last && !hist_data[c][first])
+			first++;
+		while (last > first && !hist_data[c][last])
+			last--;
+		fprintf(out, "H %d %d %d", c, first, last - first + 1);
+		for (i = first; i <= last; i++)
+			fprintf(out, " %u", hist_data[c][i]);
+		fprintf(out, "\n");
+	}
+	fprintf(out, "U %u %u %u %u %u %u %u %u\n", changed,
+		state->wb_gain[CAM_3A_GR], state->wb_gain[CAM_3A_R],
+		state->wb_gain[CAM_3A_GB], state->wb_gain[CAM_3A_B],
+		state->exposure, state->gain, state->green_mean);
+}
+
+/**
+ * \brief Run the closed loop on a scene.
+ * \param out  if not NULL, the trace is printed there
+ * \param changes  number of exposure changes in the last SETTLED updates
+ * \param clipped  share of clipped green pixels at the end, in %
+ */
+static void _run(const struct _scene *scene, struct _cam_3a_state *state,
+		int updates, FILE *out, int *changes, double *clipped)
+{
+	struct _cam_3a_cfg cfg;
+	uint32_t count = 0, high = 0;
+	uint8_t changed;
+	int i, e;
+
+	_scene_cfg(scene, &cfg);
+	cam_3a_init(state, &cfg, scene->exposure, scene->gain);
+	if (out)
+		_print_state(out, state);
+
+	*changes = 0;
+	for (i = 0; i < updates; i++) {
+		_sensor_capture(scene, state->exposure, state->gain,
+				cfg.gain_one, i);
+		changed = cam_3a_update(state, hist);
+		if (out)
+			_print_update(out, state, changed);
+		if ((changed & CAM_3A_AE_CHANGED) && i >= updates - SETTLED)
+			(*changes)++;
+	}
+
+	/* the frames taken with the final exposure */
+	_sensor_capture(scene, state->exposure, state->gain, cfg.gain_one,
+			updates);
+	for (e = 0; e < CAM_3A_HIST_ENTRIES; e++) {
+		count += hist_data[CAM_3A_GR][e] + hist_data[CAM_3A_GB][e];
+		if (e >= CAM_3A_HIST_ENTRIES - CAM_3A_HIST_ENTRIES / 64)
+			high += hist_data[CAM_3A_GR][e] + hist_data[CAM_3A_GB][e];
+	}
+	*clipped = 100.0 * high / count;
+}
+
+static const struct _scene *_find_scene(const char *name)
+{
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(scenes); i++)
+		if (!strcmp(scenes[i].name, name))
+			return &scenes[i];
+	return NULL;
+}
+
+/**
+ * \brief Parse the unsigned values following the record type of a line.
+ * \return number of values parsed
+ */
+static int _parse_values(const char *str, uint32_t *values, int max)
+{
+	char *end;
+	int n = 0;
+
+	while (n < max) {
+		unsigned long v = strtoul(str, &end, 10);
+		if (end == str)
+			break;
+		values[n++] = (uint32_t)v;
+		str = end;
+	}
+	return n;
+}
+
+/**
+ * \brief Replay a trace file.
+ * \return number of updates replayed, -1 if the file cannot be read
+ */
+static int _replay(const char *path)
+{
+	struct _cam_3a_state state;
+	struct _cam_3a_cfg cfg;
+	uint32_t v[CAM_3A_HIST_ENTRIES + 3];
+	bool started = false;
+	int n, updates = 0, lineno = 0;
+	uint8_t changed;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	memset(hist_data, 0, sizeof(hist_data));
+
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		/* board captures hold other console output */
+		if (line[0] == '\0' || line[1] != ' ')
+			continue;
+		n = _parse_values(line + 2, v, ARRAY_SIZE(v));
+
+		switch (line[0]) {
+		case 'C':
+			CHECK_EQ(n, 16);
+			if (n != 16)
+				break;
+			cfg.wb_gain_min = v[0];
+			cfg.wb_gain_max = v[1];
+			cfg.wb_white_patch = v[2];
+			cfg.wb_percentile = v[3];
+			cfg.wb_step = v[4];
+			cfg.ae_enabled = v[5];
+			cfg.ae_target = v[6];
+			cfg.ae_tolerance = v[7];
+			cfg.ae_saturation = v[8];
+			cfg.ae_step = v[9];
+			cfg.ae_interval = v[10];
+			cfg.exposure_min = v[11];
+			cfg.exposure_max = v[12];
+			cfg.gain_min = v[13];
+			cfg.gain_max = v[14];
+			cfg.gain_one = v[15];
+			break;
+		case 'I':
+			CHECK_EQ(n, 7);
+			if (n != 7)
+				break;
+			cam_3a_init(&state, &cfg, v[0], v[1]);
+			state.wb_gain[CAM_3A_GR] = v[2];
+			state.wb_gain[CAM_3A_R] = v[3];
+			state.wb_gain[CAM_3A_GB] = v[4];
+			state.wb_gain[CAM_3A_B] = v[5];
+			state.ae_wait = v[6];
+			started = true;
+			break;
+		case 'H':
+			CHECK(n >= 3 && v[0] < CAM_3A_CHANNELS
+			      && v[1] + v[2] <= CAM_3A_HIST_ENTRIES
+			      && n == (int)v[2] + 3);
+			if (n < 3 || v[0] >= CAM_3A_CHANNELS
+			    || v[1] + v[2] > CAM_3A_HIST_ENTRIES
+			    || n != (int)v[2] + 3)
+				break;
+			memset(hist_data[v[0]], 0, sizeof(hist_data[0]));
+			memcpy(&hist_data[v[0]][v[1]], &v[3],
+			       v[2] * sizeof(uint32_t));
+			break;
+		case 'U':
+			CHECK(started);
+			CHECK_EQ(n, 8);
+			if (!started || n != 8)
+				break;
+			changed = cam_3a_update(&state, hist);
+			if (changed != v[0]
+			    || state.wb_gain[CAM_3A_GR] != v[1]
+			    || state.wb_gain[CAM_3A_R] != v[2]
+			    || state.wb_gain[CAM_3A_GB] != v[3]
+			    || state.wb_gain[CAM_3A_B] != v[4]
+			    || state.exposure != v[5]
+			    || state.gain != v[6]
+			    || state.green_mean != v[7]) {
+				printf("%s:%d: update differs\n", path, lineno);
+				CHECK(false);
+				/* go on from the recorded state */
+				state.wb_gain[CAM_3A_GR] = v[1];
+				state.wb_gain[CAM_3A_R] = v[2];
+				state.wb_gain[CAM_3A_GB] = v[3];
+				state.wb_gain[CAM_3A_B] = v[4];
+				state.exposure = v[5];
+				state.gain = v[6];
+			}
+			updates++;
+			break;
+		default:
+			break;
+		}
+	}
+	fclose(f);
+	return updates;
+}
+
+/*----------------------------------------------------------------------------
+ *         Tests
+ *----------------------------------------------------------------------------*/
+
+/**
+ * The white balance cancels the illuminant, the exposure reaches the
+ * target and both are stable once settled.
+ */
+static void test_convergence(void)
+{
+	static const char * const names[] = { "tungsten", "daylight", "dark" };
+	struct _cam_3a_state state;
+	uint32_t target, tolerance;
+	double expected, clipped;
+	int changes, c;
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		const struct _scene *scene = _find_scene(names[i]);
+
+		_run(scene, &state, UPDATES, NULL, &changes, &clipped);
+		printf("    %-10s WB Gr %u R %u Gb %u B %u, exposure %u, "
+		       "gain %u, mean %u/16\n", scene->name,
+		       state.wb_gain[CAM_3A_GR], state.wb_gain[CAM_3A_R],
+		       state.wb_gain[CAM_3A_GB], state.wb_gain[CAM_3A_B],
+		       state.exposure, state.gain, state.green_mean);
+
+		for (c = 0; c < CAM_3A_CHANNELS; c++) {
+			expected = CAM_3A_GAIN_ONE * scene->response[CAM_3A_GR]
+				/ scene->response[c];
+			CHECK(fabs(state.wb_gain[c] - expected) < expected * 0.05);
+		}
+
+		target = state.cfg.ae_target * 16;
+		tolerance = (state.cfg.ae_tolerance + 2) * 16;
+		CHECK(state.green_mean + tolerance >= target);
+		CHECK(state.green_mean <= target + tolerance);
+		CHECK(changes <= 1);
+	}
+}
+
+/**
+ * The exposure time is used up before the gain is raised.
+ */
+static void test_exposure_then_gain(void)
+{
+	struct _cam_3a_state state;
+	double clipped;
+	int changes;
+
+	_run(_find_scene("daylight"), &state, UPDATES, NULL, &changes,
+	     &clipped);
+	CHECK(state.exposure < EXPOSURE_MAX);
+	CHECK_EQ(state.gain, GAIN_ONE);
+
+	_run(_find_scene("dark"), &state, UPDATES, NULL, &changes, &clipped);
+	CHECK_EQ(state.exposure, EXPOSURE_MAX);
+	CHECK(state.gain > GAIN_ONE);
+	CHECK(state.gain < GAIN_MAX);
+}
+
+/**
+ * A bright window is not clipped beyond the saturation limit, at the
+ * expense of the mean level, and the exposure does not hunt between the
+ * target and the saturation limit.
+ */
+static void test_highlights(void)
+{
+	struct _cam_3a_state state;
+	double clipped;
+	int changes;
+
+	_run(_find_scene("highlights"), &state, UPDATES, NULL, &changes,
+	     &clipped);
+	printf("    highlights exposure %u, mean %u/16, clipped %.1f%%\n",
+	       state.exposure, state.green_mean, clipped);
+	CHECK(clipped <= state.cfg.ae_saturation + 1.0);
+	CHECK(state.green_mean < state.cfg.ae_target * 16);
+	CHECK(changes <= 1);
+}
+
+/**
+ * Without manual exposure control, only the white balance runs.
+ */
+static void test_wb_only(void)
+{
+	const struct _scene *scene = _find_scene("no_ae");
+	struct _cam_3a_state state;
+	double clipped;
+	int changes, c;
+
+	_run(scene, &state, UPDATES, NULL, &changes, &clipped);
+	CHECK_EQ(changes, 0);
+	CHECK_EQ(state.green_mean, 0);
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		double expected = CAM_3A_GAIN_ONE * scene->response[CAM_3A_GR]
+			/ scene->response[c];
+		CHECK(fabs(state.wb_gain[c] - expected) < expected * 0.05);
+	}
+}
+
+/**
+ * Replay the recorded traces.
+ */
+static void test_replay(void)
+{
+	char path[512];
+	struct dirent *entry;
+	int files = 0, updates;
+	size_t len;
+	DIR *dir;
+
+	dir = opendir(CAM_3A_TRACES);
+	CHECK(dir != NULL);
+	if (!dir)
+		return;
+	while ((entry = readdir(dir)) != NULL) {
+		len = strlen(entry->d_name);
+		if (len < 6 || strcmp(entry->d_name + len - 6, ".trace"))
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", CAM_3A_TRACES,
+			 entry->d_name);
+		updates = _replay(path);
+		printf("    %s: %d updates\n", entry->d_name, updates);
+		CHECK(updates > 0);
+		files++;
+	}
+	closedir(dir);
+	CHECK(files > 0);
+}
+
+/*----------------------------------------------------------------------------
+ *         Main
+ *----------------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+	if (argc == 3 && !strcmp(argv[1], "--record")) {
+		const struct _scene *scene = _find_scene(argv[2]);
+		struct _cam_3a_state state;
+		double clipped;
+		int changes;
+
+		if (!scene) {
+			fprintf(stderr, "unknown scene %s\n", argv[2]);
+			return 1;
+		}
+		printf("# cam_3a trace: simulated %s scene, test_cam_3a\n",
+		       scene->name);
+		_run(scene, &state, RECORD_UPDATES, stdout, &changes, &clipped);
+		return 0;
+	}
+
+	RUN(test_convergence);
+	RUN(test_exposure_then_gain);
+	RUN(test_highlights);
+	RUN(test_wb_only);
+	RUN(test_replay);
+	return host_test_result();
+}
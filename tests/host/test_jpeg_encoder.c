@@ -0,0 +1,449 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the baseline JPEG encoder (lib/mjpeg/jpeg_encoder.c).
+ *
+ * Synthetic YUV 4:2:2 frames (color bars, ramps, a zone plate and a textured
+ * scene) are encoded, then decoded with libjpeg as the reference decoder.
+ * The decoded frames must match the source within a minimum PSNR. They must
+ * also be as good and as small as reference images encoded by libjpeg from
+ * the same frames, with the same quality and sampling factors.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "host_test.h"
+
+#include "mjpeg/jpeg_encoder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jpeglib.h>
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+#define WIDTH          320
+#define HEIGHT         240
+#define QUALITY        75
+
+/** Output buffer, large enough for any frame at quality 100 */
+#define OUT_SIZE       (WIDTH * HEIGHT * 4)
+
+/** Minimum PSNR of the luminance and chrominance planes at QUALITY, in dB.
+ * The zone plate is the worst case. */
+#define MIN_PSNR_Y     35.0
+#define MIN_PSNR_C     44.0
+
+/** PSNR loss allowed against the libjpeg reference images, in dB */
+#define MAX_PSNR_LOSS  0.1
+
+/** Size excess allowed against the libjpeg reference images, in percent */
+#define MAX_SIZE_EXCESS 2
+
+/** Number of test patterns */
+#define PATTERNS       4
+
+/*----------------------------------------------------------------------------
+ *         Local types
+ *----------------------------------------------------------------------------*/
+
+struct _psnr {
+	double y;
+	double c;
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static uint8_t frame[WIDTH * HEIGHT * 2];
+static uint8_t out[OUT_SIZE];
+static uint8_t decoded[WIDTH * HEIGHT * 3];
+
+static const char * const pattern_names[PATTERNS] = {
+	"bars", "ramps", "zone plate", "scene",
+};
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t _clamp(double value)
+{
+	if (value < 0.0)
+		return 0;
+	if (value > 255.0)
+		return 255;
+	return (uint8_t)lrint(value);
+}
+
+/**
+ * \brief Generate a YUYV test frame.
+ */
+static void _make_frame(uint8_t *yuyv, int w, int h, int pattern)
+{
+	/* 75% color bars, BT.601: white, yellow, cyan, green, magenta, red,
+	 * blue, black */
+	static const uint8_t bars[8][3] = {
+		{ 180, 128, 128 }, { 162, 44, 142 }, { 131, 156, 44 },
+		{ 112, 72, 58 }, { 84, 184, 198 }, { 65, 100, 212 },
+		{ 35, 212, 114 }, { 16, 128, 128 },
+	};
+	unsigned seed = 1;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x += 2) {
+			uint8_t *p = &yuyv[(y * w + x) * 2];
+			double r0, r1;
+
+			switch (pattern) {
+			case 0:
+				p[0] = p[2] = bars[x * 8 / w][0];
+				p[1] = bars[x * 8 / w][1];
+				p[3] = bars[x * 8 / w][2];
+				break;
+			case 1:
+				p[0] = 16 + 219 * x / w;
+				p[2] = 16 + 219 * (x + 1) / w;
+				p[1] = 16 + 224 * y / h;
+				p[3] = 240 - 224 * y / h;
+				break;
+			case 2:
+				r0 = (x - w / 2) * (x - w / 2)
+					+ (y - h / 2) * (y - h / 2);
+				r1 = (x + 1 - w / 2) * (x + 1 - w / 2)
+					+ (y - h / 2) * (y - h / 2);
+				p[0] = _clamp(128 + 100 * cos(r0 * M_PI / (2 * w)));
+				p[2] = _clamp(128 + 100 * cos(r1 * M_PI / (2 * w)));
+				p[1] = _clamp(128 + 60 * sin(x * 0.05));
+				p[3] = _clamp(128 + 60 * cos(y * 0.07));
+				break;
+			default:
+				/* smooth shapes and some sensor noise */
+				seed = seed * 1103515245 + 12345;
+				p[0] = _clamp(110 + 60 * sin(x * 0.03) * cos(y * 0.05)
+						+ ((seed >> 16) & 7) - 3.5);
+				seed = seed * 1103515245 + 12345;
+				p[2] = _clamp(110 + 60 * sin((x + 1) * 0.03) * cos(y * 0.05)
+						+ ((seed >> 16) & 7) - 3.5);
+				p[1] = _clamp(128 + 30 * sin(y * 0.02));
+				p[3] = _clamp(128 + 30 * cos(x * 0.015));
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Decode a JPEG image to YCbCr 4:4:4, chrominance replicated.
+ * \return false if libjpeg issued warnings or the image does not have the
+ * expected size
+ */
+static bool _decode(const uint8_t *jpeg, uint32_t size, int w, int h)
+{
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	bool ok;
+
+	/* the default error handler exits the test program */
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char *)jpeg, size);
+	jpeg_read_header(&cinfo, TRUE);
+	cinfo.out_color_space = JCS_YCbCr;
+	cinfo.do_fancy_upsampling = FALSE;
+	cinfo.dct_method = JDCT_ISLOW;
+	jpeg_start_decompress(&cinfo);
+	ok = cinfo.output_width == (JDIMENSION)w
+		&& cinfo.output_height == (JDIMENSION)h
+		&& cinfo.output_components == 3;
+	while (ok && cinfo.output_scanline < cinfo.output_height) {
+		JSAMPROW row = &decoded[cinfo.output_scanline * w * 3];
+		jpeg_read_scanlines(&cinfo, &row, 1);
+	}
+	if (ok)
+		jpeg_finish_decompress(&cinfo);
+	ok = ok && jerr.num_warnings == 0;
+	jpeg_destroy_decompress(&cinfo);
+	return ok;
+}
+
+/**
+ * \brief Encode a YUYV frame with libjpeg, like the encoder under test:
+ * 4:2:2 sampling, accurate integer DCT and the Annex K Huffman tables.
+ * \return size of the image, allocated in *jpeg
+ */
+static unsigned long _reference_encode(const uint8_t *yuyv, int w, int h,
+		int quality, unsigned char **jpeg)
+{
+	struct jpeg_compress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	unsigned long size = 0;
+	uint8_t *line = malloc(w * 3);
+	int x;
+
+	*jpeg = NULL;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+	jpeg_mem_dest(&cinfo, jpeg, &size);
+	cinfo.image_width = w;
+	cinfo.image_height = h;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_YCbCr;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_colorspace(&cinfo, JCS_YCbCr);
+	cinfo.comp_info[0].h_samp_factor = 2;
+	cinfo.comp_info[0].v_samp_factor = 1;
+	cinfo.dct_method = JDCT_ISLOW;
+	jpeg_set_quality(&cinfo, quality, TRUE);
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		const uint8_t *src = &yuyv[cinfo.next_scanline * w * 2];
+		JSAMPROW row = line;
+
+		for (x = 0; x < w; x++) {
+			line[x * 3] = src[x * 2];
+			line[x * 3 + 1] = src[(x & ~1) * 2 + 1];
+			line[x * 3 + 2] = src[(x & ~1) * 2 + 3];
+		}
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+	free(line);
+	return size;
+}
+
+static double _psnr_db(double sse, int count)
+{
+	if (sse == 0.0)
+		return 99.0;
+	return 10.0 * log10(255.0 * 255.0 * count / sse);
+}
+
+/**
+ * \brief PSNR of the decoded image against a YUYV frame.
+ */
+static struct _psnr _measure(const uint8_t *yuyv, int w, int h)
+{
+	double sse_y = 0.0, sse_c = 0.0, d;
+	struct _psnr psnr;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			const uint8_t *pair = &yuyv[(y * w + (x & ~1)) * 2];
+			const uint8_t *p = &decoded[(y * w + x) * 3];
+
+			d = p[0] - yuyv[(y * w + x) * 2];
+			sse_y += d * d;
+			d = p[1] - pair[1];
+			sse_c += d * d;
+			d = p[2] - pair[3];
+			sse_c += d * d;
+		}
+	}
+	psnr.y = _psnr_db(sse_y, w * h);
+	psnr.c = _psnr_db(sse_c, 2 * w * h);
+	return psnr;
+}
+
+/*----------------------------------------------------------------------------
+ *         Tests
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Compare the decoded test frames with their source and with the libjpeg
+ * reference images.
+ */
+static void test_reference_images(void)
+{
+	struct _jpeg_encoder enc;
+	struct _psnr psnr, ref_psnr;
+	unsigned char *ref;
+	unsigned long ref_size;
+	uint32_t size;
+	int pattern;
+
+	jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_YUYV, QUALITY);
+
+	for (pattern = 0; pattern < PATTERNS; pattern++) {
+		_make_frame(frame, WIDTH, HEIGHT, pattern);
+
+		size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+		CHECK(size > 0);
+		CHECK(_decode(out, size, WIDTH, HEIGHT));
+		psnr = _measure(frame, WIDTH, HEIGHT);
+
+		ref_size = _reference_encode(frame, WIDTH, HEIGHT, QUALITY, &ref);
+		CHECK(_decode(ref, ref_size, WIDTH, HEIGHT));
+		ref_psnr = _measure(frame, WIDTH, HEIGHT);
+		free(ref);
+
+		printf("    %-10s %6u bytes, Y %.2f dB, C %.2f dB "
+		       "(libjpeg %6lu bytes, Y %.2f dB, C %.2f dB)\n",
+		       pattern_names[pattern], (unsigned)size, psnr.y, psnr.c,
+		       ref_size, ref_psnr.y, ref_psnr.c);
+
+		CHECK(psnr.y >= MIN_PSNR_Y);
+		CHECK(psnr.c >= MIN_PSNR_C);
+		CHECK(psnr.y >= ref_psnr.y - MAX_PSNR_LOSS);
+		CHECK(psnr.c >= ref_psnr.c - MAX_PSNR_LOSS);
+		CHECK(size * 100 <= ref_size * (100 + MAX_SIZE_EXCESS));
+	}
+}
+
+/**
+ * YUYV and UYVY inputs of the same frame give the same image.
+ */
+static void test_input_formats(void)
+{
+	static uint8_t uyvy[WIDTH * HEIGHT * 2];
+	static uint8_t out2[OUT_SIZE];
+	struct _jpeg_encoder enc;
+	uint32_t size, size2;
+	int i;
+
+	_make_frame(frame, WIDTH, HEIGHT, 3);
+	for (i = 0; i < WIDTH * HEIGHT * 2; i += 2) {
+		uyvy[i] = frame[i + 1];
+		uyvy[i + 1] = frame[i];
+	}
+
+	jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_YUYV, QUALITY);
+	size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+	jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_UYVY, QUALITY);
+	size2 = jpeg_encode_frame(&enc, uyvy, WIDTH * 2, out2, OUT_SIZE);
+	CHECK(size > 0);
+	CHECK_EQ(size, size2);
+	CHECK(memcmp(out, out2, size) == 0);
+}
+
+/**
+ * Frames that are not a multiple of the MCU size, read with a stride larger
+ * than their width.
+ */
+static void test_partial_mcus(void)
+{
+	static const int sizes[][2] = { { 100, 60 }, { 18, 9 }, { 2, 1 } };
+	static uint8_t crop[WIDTH * HEIGHT * 2];
+	struct _jpeg_encoder enc;
+	struct _psnr psnr;
+	uint32_t size;
+	int i, y, w, h;
+
+	/* encode the top left corner of a full frame */
+	_make_frame(frame, WIDTH, HEIGHT, 3);
+	for (i = 0; i < 3; i++) {
+		w = sizes[i][0];
+		h = sizes[i][1];
+		jpeg_encoder_init(&enc, w, h, JPEG_INPUT_YUYV, QUALITY);
+		size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+		CHECK(size > 0);
+		CHECK(_decode(out, size, w, h));
+		for (y = 0; y < h; y++)
+			memcpy(&crop[y * w * 2], &frame[y * WIDTH * 2], w * 2);
+		psnr = _measure(crop, w, h);
+		CHECK(psnr.y >= MIN_PSNR_Y);
+		CHECK(psnr.c >= MIN_PSNR_C);
+	}
+}
+
+/**
+ * Extreme qualities give valid images, the size decreases with the quality
+ * and a too small output buffer is reported.
+ */
+static void test_quality_and_overflow(void)
+{
+	static const uint8_t qualities[] = { 100, 90, 75, 50, 10, 1 };
+	struct _jpeg_encoder enc;
+	uint32_t size, prev = UINT32_MAX;
+	unsigned i;
+
+	_make_frame(frame, WIDTH, HEIGHT, 2);
+	for (i = 0; i < sizeof(qualities); i++) {
+		jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_YUYV,
+				qualities[i]);
+		size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+		CHECK(size > 0);
+		CHECK(size < prev);
+		CHECK(_decode(out, size, WIDTH, HEIGHT));
+		prev = size;
+	}
+
+	jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_YUYV, QUALITY);
+	size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+	CHECK_EQ(jpeg_encode_frame(&enc, frame, WIDTH * 2, out, size - 1), 0);
+	CHECK_EQ(jpeg_encode_frame(&enc, frame, WIDTH * 2, out, 100), 0);
+	CHECK_EQ(jpeg_encode_frame(&enc, frame, WIDTH * 2, out, size), size);
+}
+
+/**
+ * Report the encoding cost per pixel.
+ */
+static void test_cycles(void)
+{
+	struct _jpeg_encoder enc;
+	uint64_t count;
+	uint32_t size;
+
+	_make_frame(frame, WIDTH, HEIGHT, 3);
+	jpeg_encoder_init(&enc, WIDTH, HEIGHT, JPEG_INPUT_YUYV, QUALITY);
+	host_cycles_start();
+	size = jpeg_encode_frame(&enc, frame, WIDTH * 2, out, OUT_SIZE);
+	count = host_cycles_stop();
+	CHECK(size > 0);
+	printf("    %.1f %s per pixel\n", (double)count / (WIDTH * HEIGHT),
+	       host_cycles_available() ? "cycles" : "ns");
+}
+
+/*----------------------------------------------------------------------------
+ *         Main
+ *----------------------------------------------------------------------------*/
+
+int main(void)
+{
+	RUN(test_reference_images);
+	RUN(test_input_formats);
+	RUN(test_partial_mcus);
+	RUN(test_quality_and_overflow);
+	RUN(test_cycles);
+	return host_test_result();
+}
@@ -0,0 +1,389 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the LCD raster core (utils/lcd_raster.c) and of the
+ * lcd_draw functions built on it (utils/lcd_draw.c).
+ *
+ * lcd_draw is built against the stub headers of tests/host/stubs. The
+ * canvas is a memory buffer surrounded by guard bytes, and the DMA stub
+ * runs the linked lists with memcpy, so that large fills take the DMA
+ * path. The tests lock in:
+ * - lcdd_read_pixel() addressing, x and y used to be swapped,
+ * - lcdd_fill() and shapes near the borders staying inside the canvas,
+ *   lcdd_fill() used to write one row and one column past it,
+ * - the palette decoder starting at any source column.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "host_test.h"
+
+#include "video/lcdd.h"
+#include "peripherals/dma.h"
+
+#include "lcd_draw.h"
+#include "lcd_raster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+#define ARRAY_SIZE(a)  (sizeof(a) / sizeof((a)[0]))
+
+/** Guard bytes before and after the canvas buffer */
+#define GUARD          64
+
+/** Guard byte value, also written to the row padding */
+#define GUARD_BYTE     0xa5
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct _lcdd_layer canvas;
+
+/** Canvas buffer, with the guard bytes */
+static uint8_t *memory;
+static uint32_t memory_size;
+
+/** Whether the DMA stub gives a channel */
+static bool dma_available;
+
+/** Number of DMA transfers started */
+static int dma_transfers;
+
+static struct dma_xfer_item *dma_list;
+
+static const uint8_t bpps[] = { 16, 24, 32 };
+
+/** A color with distinct bytes, in the native format of each bpp */
+static const uint32_t colors[] = { 0xf81f, 0x123456, 0x80abcdef };
+
+/*----------------------------------------------------------------------------
+ *         Stubs
+ *----------------------------------------------------------------------------*/
+
+struct _lcdd_layer *lcdd_get_canvas(void)
+{
+	return &canvas;
+}
+
+void dma_poll(void)
+{
+}
+
+struct dma_channel *dma_allocate_channel(uint8_t src, uint8_t dest)
+{
+	static int channel;
+
+	(void)src;
+	(void)dest;
+	return dma_available ? (struct dma_channel *)&channel : NULL;
+}
+
+uint32_t dma_prepare_item(struct dma_channel *channel,
+		const struct dma_xfer_item_tmpl *tmpl,
+		struct dma_xfer_item *item)
+{
+	(void)channel;
+	item->sa = tmpl->sa;
+	item->da = tmpl->da;
+	item->size = tmpl->blk_size << tmpl->data_width;
+	item->next = NULL;
+	return 0;
+}
+
+uint32_t dma_link_item(struct dma_channel *channel,
+		struct dma_xfer_item *item, struct dma_xfer_item *next_item)
+{
+	(void)channel;
+	item->next = next_item;
+	return 0;
+}
+
+uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
+		struct dma_xfer_item_tmpl *tmpl, struct dma_xfer_item *desc_list)
+{
+	(void)channel;
+	(void)tmpl;
+	dma_list = desc_list;
+	return 0;
+}
+
+uint32_t dma_start_transfer(struct dma_channel *channel)
+{
+	struct dma_xfer_item *item;
+
+	(void)channel;
+	for (item = dma_list; item; item = item->next)
+		memcpy(item->da, item->sa, item->size);
+	dma_transfers++;
+	return 0;
+}
+
+bool dma_is_transfer_done(struct dma_channel *channel)
+{
+	(void)channel;
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _stride(void)
+{
+	return lcd_raster_stride(canvas.width, canvas.bpp);
+}
+
+/**
+ * \brief Allocate a canvas, guard bytes and row padding set to GUARD_BYTE,
+ * pixels to 0.
+ */
+static void _setup_canvas(uint16_t width, uint16_t height, uint8_t bpp)
+{
+	uint32_t stride, y;
+
+	free(memory);
+	canvas.width = width;
+	canvas.height = height;
+	canvas.bpp = bpp;
+	stride = _stride();
+	memory_size = 2 * GUARD + stride * height;
+	memory = malloc(memory_size);
+	memset(memory, GUARD_BYTE, memory_size);
+	canvas.buffer = memory + GUARD;
+	for (y = 0; y < height; y++)
+		memset(memory + GUARD + y * stride, 0, width * (bpp / 8));
+}
+
+/**
+ * \brief Check that the guard bytes and the row padding are untouched.
+ */
+static bool _guards_intact(void)
+{
+	uint32_t stride = _stride();
+	uint32_t len = canvas.width * (canvas.bpp / 8);
+	uint32_t i, y;
+
+	for (i = 0; i < GUARD; i++) {
+		if (memory[i] != GUARD_BYTE ||
+				memory[memory_size - 1 - i] != GUARD_BYTE)
+			return false;
+	}
+	for (y = 0; y < canvas.height; y++) {
+		for (i = len; i < stride; i++)
+			if (memory[GUARD + y * stride + i] != GUARD_BYTE)
+				return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Read a pixel from the canvas memory, without lcd_raster.
+ */
+static uint32_t _pixel(uint32_t x, uint32_t y)
+{
+	const uint8_t *p = memory + GUARD + y * _stride() + x * (canvas.bpp / 8);
+	uint32_t value = 0;
+	int i;
+
+	for (i = canvas.bpp / 8 - 1; i >= 0; i--)
+		value = (value << 8) | p[i];
+	return value;
+}
+
+/**
+ * \brief Count the canvas pixels of the given color.
+ */
+static uint32_t _count(uint32_t color)
+{
+	uint32_t x, y, count = 0;
+
+	for (y = 0; y < canvas.height; y++)
+		for (x = 0; x < canvas.width; x++)
+			if (_pixel(x, y) == color)
+				count++;
+	return count;
+}
+
+/*----------------------------------------------------------------------------
+ *         Tests
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Pixels written and read on a non-square canvas are at y * stride + x.
+ */
+static void test_read_pixel(void)
+{
+	static const uint32_t points[][2] = {
+		{ 0, 0 }, { 3, 1 }, { 1, 3 }, { 36, 2 }, { 2, 20 }, { 36, 20 },
+	};
+	unsigned i, b;
+
+	for (b = 0; b < ARRAY_SIZE(bpps); b++) {
+		_setup_canvas(37, 21, bpps[b]);
+		for (i = 0; i < ARRAY_SIZE(points); i++)
+			lcdd_draw_pixel(points[i][0], points[i][1], colors[b] - i);
+		for (i = 0; i < ARRAY_SIZE(points); i++) {
+			CHECK_EQ(_pixel(points[i][0], points[i][1]), colors[b] - i);
+			CHECK_EQ(lcdd_read_pixel(points[i][0], points[i][1]),
+					colors[b] - i);
+		}
+		CHECK_EQ(lcdd_read_pixel(20, 36), 0);
+		CHECK_EQ(lcdd_read_pixel(37, 0), 0);
+		CHECK_EQ(lcdd_read_pixel(0, 21), 0);
+
+		/* ignored outside the canvas */
+		lcdd_draw_pixel(37, 0, colors[b]);
+		lcdd_draw_pixel(0, 21, colors[b]);
+		CHECK(_guards_intact());
+		CHECK_EQ(_count(0), 37 * 21 - ARRAY_SIZE(points));
+	}
+}
+
+/**
+ * lcdd_fill() covers the canvas exactly, on the CPU and on the DMA paths,
+ * with rows padded or not.
+ */
+static void test_fill(void)
+{
+	static const uint16_t sizes[][2] = {
+		{ 37, 21 }, { 40, 30 }, { 150, 120 }, { 131, 97 },
+	};
+	unsigned b, s, d;
+	int transfers;
+
+	for (d = 0; d < 2; d++) {
+		dma_available = d;
+		for (b = 0; b < ARRAY_SIZE(bpps); b++) {
+			for (s = 0; s < ARRAY_SIZE(sizes); s++) {
+				_setup_canvas(sizes[s][0], sizes[s][1],
+						bpps[b]);
+				transfers = dma_transfers;
+				lcdd_fill(colors[b]);
+				CHECK_EQ(_count(colors[b]),
+						sizes[s][0] * sizes[s][1]);
+				CHECK(_guards_intact());
+				if (!dma_available)
+					CHECK_EQ(dma_transfers, transfers);
+			}
+		}
+	}
+	/* the large canvas went through the DMA */
+	CHECK(dma_transfers > 0);
+	dma_available = false;
+}
+
+/**
+ * Rectangles and circles crossing the borders are clipped.
+ */
+static void test_clipping(void)
+{
+	unsigned b;
+
+	for (b = 0; b < ARRAY_SIZE(bpps); b++) {
+		_setup_canvas(37, 21, bpps[b]);
+		lcdd_draw_filled_rectangle(30, 15, 100, 100, colors[b]);
+		CHECK_EQ(_count(colors[b]), 7 * 6);
+		lcdd_draw_filled_rectangle(36, 20, 30, 15, 0);
+		CHECK_EQ(_count(colors[b]), 0);
+
+		lcdd_draw_filled_circle(2, 2, 10, colors[b]);
+		lcdd_draw_filled_circle(34, 18, 10, colors[b]);
+		lcdd_draw_circle(36, 0, 15, colors[b]);
+		lcdd_draw_circle(0, 20, 15, colors[b]);
+		CHECK(_count(colors[b]) > 0);
+		CHECK(_guards_intact());
+	}
+}
+
+/**
+ * Decoding the columns src_x to src_x + w - 1 of a palette image gives the
+ * same pixels as decoding the whole image.
+ */
+static void test_palette_part(void)
+{
+	static const uint8_t index_bpps[] = { 1, 2, 4, 8 };
+	uint32_t palette[256];
+	uint8_t index[16 * 8];
+	struct _lcd_surface full, part;
+	uint8_t full_buf[64 * 4 * 8], part_buf[64 * 4 * 8];
+	uint32_t src_stride, src_x, w, x, y, i;
+	unsigned n;
+
+	for (i = 0; i < ARRAY_SIZE(palette); i++)
+		palette[i] = 0x10000 + i * 0x101;
+	for (i = 0; i < sizeof(index); i++)
+		index[i] = (uint8_t)(i * 37 + 11);
+
+	for (n = 0; n < ARRAY_SIZE(index_bpps); n++) {
+		/* 16 bytes per row */
+		w = 128 / index_bpps[n];
+		if (w > 64)
+			w = 64;
+		src_stride = 16;
+		lcd_raster_init_surface(&full, full_buf, 64, 8, 32);
+		lcd_raster_draw_palette(&full, 0, 0, index, index_bpps[n],
+				src_stride, palette, w, 8);
+		for (src_x = 0; src_x < 13; src_x++) {
+			lcd_raster_init_surface(&part, part_buf, 64, 8, 32);
+			memset(part_buf, 0, sizeof(part_buf));
+			lcd_raster_draw_palette_part(&part, 1, 0, index,
+					index_bpps[n], src_stride, src_x,
+					palette, w - src_x, 8);
+			for (y = 0; y < 8; y++) {
+				CHECK_EQ(lcd_raster_get_pixel(&part, 0, y), 0);
+				for (x = 0; x + src_x < w && x + 1 < 64; x++)
+					CHECK_EQ(lcd_raster_get_pixel(&part,
+							x + 1, y),
+						lcd_raster_get_pixel(&full,
+							x + src_x, y));
+			}
+		}
+	}
+}
+
+int main(void)
+{
+	RUN(test_read_pixel);
+	RUN(test_fill);
+	RUN(test_clipping);
+	RUN(test_palette_part);
+	free(memory);
+	return host_test_result();
+}
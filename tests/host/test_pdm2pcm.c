@@ -0,0 +1,309 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the PDM to PCM converter (lib/dsp/pdm2pcm.c).
+ *
+ * A second order sigma-delta modulator turns a 1 kHz tone into a synthetic
+ * PDM stream (OSR 64, 16 kHz output, CIC order 4). The test checks the gain and the SNR
+ * of the decimated tone, that channels are decimated in lockstep whatever
+ * the layout, and measures the processing cost per output sample.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include "host_test.h"
+
+#include "pdm2pcm.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local constants
+ *----------------------------------------------------------------------------*/
+
+#define PCM_RATE       16000
+#define OSR            64
+#define TONE_FREQ      1000.0
+
+/** Output samples skipped while the filters settle */
+#define SETTLE         256
+/** Output samples analysed, an integer number of tone periods */
+#define ANALYSED       4096
+#define FRAMES         (SETTLE + ANALYSED)
+#define PDM_BYTES      (FRAMES * OSR / 8)
+
+/** Host cycles per mono output sample not to exceed, order 4, OSR 64 */
+#define MAX_CYCLES     2000
+
+/** Without cycle counter: at least ten times faster than real time */
+#define MAX_NS         (1000000000 / PCM_RATE / 10)
+
+/** Tone levels and minimum SNR for 16-bit output at OSR 64 and order 4.
+ * The in-band noise floor is about -76 dBFS: the SNR measured is 64.4 dB
+ * at -12 dBFS and 69.3 dB at -6 dBFS. */
+static const struct {
+	double amplitude;
+	double min_snr;
+} _levels[] = {
+	{ 0.25, 63.0 },
+	{ 0.5, 68.0 },
+};
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Second order sigma-delta modulation of a tone, first PDM sample in
+ * the MSB of each byte.
+ */
+static void _modulate(uint8_t* pdm, uint32_t size, double amplitude)
+{
+	double i1 = 0.0, i2 = 0.0, y = 1.0, x;
+	uint32_t n = 0, i;
+	int k;
+
+	for (i = 0; i < size; i++) {
+		pdm[i] = 0;
+		for (k = 7; k >= 0; k--, n++) {
+			x = amplitude * sin(2.0 * M_PI * TONE_FREQ * n
+					/ (PCM_RATE * OSR));
+			i1 += x - y;
+			i2 += i1 - y;
+			y = i2 >= 0.0 ? 1.0 : -1.0;
+			if (y > 0.0)
+				pdm[i] |= 1 << k;
+		}
+	}
+}
+
+/**
+ * \brief Fit the tone on the settled part of the output and return its SNR,
+ * everything but the tone and DC counting as noise.
+ */
+static double _snr(const int16_t* pcm, int stride, double* amplitude)
+{
+	double s = 0.0, c = 0.0, dc = 0.0, noise = 0.0, w, r;
+	int i;
+
+	pcm += SETTLE * stride;
+	for (i = 0; i < ANALYSED; i++) {
+		w = 2.0 * M_PI * TONE_FREQ * i / PCM_RATE;
+		s += pcm[i * stride] * sin(w);
+		c += pcm[i * stride] * cos(w);
+		dc += pcm[i * stride];
+	}
+	s *= 2.0 / ANALYSED;
+	c *= 2.0 / ANALYSED;
+	dc /= ANALYSED;
+
+	for (i = 0; i < ANALYSED; i++) {
+		w = 2.0 * M_PI * TONE_FREQ * i / PCM_RATE;
+		r = pcm[i * stride] - dc - s * sin(w) - c * cos(w);
+		noise += r * r;
+	}
+	noise /= ANALYSED;
+
+	*amplitude = sqrt(s * s + c * c);
+	return 10.0 * log10((s * s + c * c) / 2.0 / noise);
+}
+
+static void _init(struct _pdm2pcm* p, uint8_t channels, uint8_t layout)
+{
+	memset(p, 0, sizeof(*p));
+	p->channels = channels;
+	p->layout = layout;
+	p->order = 4;
+	p->osr = OSR;
+	p->bits = 16;
+	p->gain = 256;
+	CHECK(pdm2pcm_initialize(p));
+}
+
+/*----------------------------------------------------------------------------
+ *         Tests
+ *----------------------------------------------------------------------------*/
+
+static uint8_t _pdm[PDM_BYTES];
+static uint8_t _pdm2[2 * PDM_BYTES];
+static int16_t _pcm[FRAMES];
+static int16_t _pcm2[2 * FRAMES];
+
+static struct _pdm2pcm _conv;
+
+static void test_config(void)
+{
+	struct _pdm2pcm* p = &_conv;
+
+	_init(p, 1, PDM2PCM_LAYOUT_BYTES);
+	p->osr = 40;
+	CHECK(!pdm2pcm_initialize(p));
+	p->osr = OSR;
+	p->order = 6;
+	CHECK(!pdm2pcm_initialize(p));
+	p->order = 4;
+	p->layout = PDM2PCM_LAYOUT_BITS;
+	CHECK(!pdm2pcm_initialize(p));
+	p->layout = PDM2PCM_LAYOUT_BYTES;
+	p->bits = 20;
+	CHECK(!pdm2pcm_initialize(p));
+	/* CIC gain 128^5 overflows 31 bits */
+	p->bits = 16;
+	p->osr = 256;
+	p->order = 5;
+	CHECK(!pdm2pcm_initialize(p));
+
+	CHECK_EQ(pdm2pcm_get_output_frames(p, 0), 0);
+	p->channels = 2;
+	p->osr = OSR;
+	CHECK_EQ(pdm2pcm_get_output_frames(p, 16), 1);
+	CHECK_EQ(pdm2pcm_get_output_frames(p, 18), 2);
+}
+
+static void test_snr(void)
+{
+	struct _pdm2pcm* p = &_conv;
+	double snr, amplitude, gain;
+	unsigned i;
+
+	for (i = 0; i < sizeof(_levels) / sizeof(_levels[0]); i++) {
+		_modulate(_pdm, PDM_BYTES, _levels[i].amplitude);
+		_init(p, 1, PDM2PCM_LAYOUT_BYTES);
+		CHECK_EQ(pdm2pcm_process(p, _pdm, PDM_BYTES, _pcm), FRAMES);
+
+		snr = _snr(_pcm, 1, &amplitude);
+		gain = 20.0 * log10(amplitude
+				/ (_levels[i].amplitude * 32768.0));
+		printf("    %.0f dBFS tone: SNR %.1f dB, gain %+.2f dB\n",
+		       20.0 * log10(_levels[i].amplitude), snr, gain);
+		CHECK(snr >= _levels[i].min_snr);
+		CHECK(fabs(gain) < 0.5);
+	}
+
+	/* +6 dB, on the last tone */
+	p->gain = 512;
+	CHECK(pdm2pcm_initialize(p));
+	pdm2pcm_process(p, _pdm, PDM_BYTES, _pcm);
+	_snr(_pcm, 1, &amplitude);
+	gain = 20.0 * log10(amplitude / (_levels[i - 1].amplitude * 32768.0));
+	CHECK(fabs(gain - 6.02) < 0.5);
+}
+
+static void test_layouts(void)
+{
+	struct _pdm2pcm* p = &_conv;
+	uint32_t i;
+	int k;
+
+	/* Same stream on both channels, one byte per channel in turn */
+	for (i = 0; i < PDM_BYTES; i++)
+		_pdm2[2 * i] = _pdm2[2 * i + 1] = _pdm[i];
+	_init(p, 2, PDM2PCM_LAYOUT_BYTES);
+	CHECK_EQ(pdm2pcm_process(p, _pdm2, 2 * PDM_BYTES, _pcm2), FRAMES);
+	_init(p, 1, PDM2PCM_LAYOUT_BYTES);
+	pdm2pcm_process(p, _pdm, PDM_BYTES, _pcm);
+	for (i = 0; i < FRAMES; i++) {
+		CHECK_EQ(_pcm2[2 * i], _pcm[i]);
+		CHECK_EQ(_pcm2[2 * i + 1], _pcm[i]);
+	}
+
+	/* Same stream, alternating bits on one line, LSB first: channel 1
+	 * gets the inverted stream */
+	memset(_pdm2, 0, sizeof(_pdm2));
+	for (i = 0; i < 8 * PDM_BYTES; i++) {
+		uint32_t bit = 2 * i;
+		int v = (_pdm[i / 8] >> (7 - i % 8)) & 1;
+		_pdm2[bit / 8] |= v << (bit % 8);
+		bit++;
+		_pdm2[bit / 8] |= !v << (bit % 8);
+	}
+	_init(p, 2, PDM2PCM_LAYOUT_BITS);
+	p->lsb_first = true;
+	CHECK(pdm2pcm_initialize(p));
+	CHECK_EQ(pdm2pcm_process(p, _pdm2, 2 * PDM_BYTES, _pcm2), FRAMES);
+	for (i = SETTLE, k = 0; i < FRAMES; i++) {
+		CHECK_EQ(_pcm2[2 * i], _pcm[i]);
+		/* symmetric rounding: -x rounds to -x or -x +- 1 */
+		if (abs(_pcm2[2 * i + 1] + _pcm[i]) > 1)
+			k++;
+	}
+	CHECK_EQ(k, 0);
+}
+
+static void test_cycles(void)
+{
+	struct _pdm2pcm* p = &_conv;
+	uint64_t cycles;
+	int run;
+
+	_init(p, 1, PDM2PCM_LAYOUT_BYTES);
+	/* best of a few runs, the first one warms up the caches */
+	cycles = UINT64_MAX;
+	for (run = 0; run < 5; run++) {
+		uint64_t c;
+		host_cycles_start();
+		pdm2pcm_process(p, _pdm, PDM_BYTES, _pcm);
+		c = host_cycles_stop();
+		if (c < cycles)
+			cycles = c;
+	}
+
+	if (host_cycles_available()) {
+		printf("    %.0f host cycles per output sample\n",
+		       (double)cycles / FRAMES);
+		CHECK(cycles / FRAMES <= MAX_CYCLES);
+	} else {
+		printf("    %.0f ns per output sample (no cycle counter)\n",
+		       (double)cycles / FRAMES);
+		CHECK(cycles / FRAMES <= MAX_NS);
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *         Main
+ *----------------------------------------------------------------------------*/
+
+int main(void)
+{
+	RUN(test_config);
+	RUN(test_snr);
+	RUN(test_layouts);
+	RUN(test_cycles);
+	return host_test_result();
+}
@@ -0,0 +1,284 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Auto-exposure and auto-white-balance control loop.
+ *
+ * Only integer arithmetic is used, so that a recorded histogram trace
+ * gives the same gains and exposures on the host and on the target.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "cam_3a.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** First histogram entry counted as clipped */
+#define CLIPPED_ENTRY (CAM_3A_HIST_ENTRIES - CAM_3A_HIST_ENTRIES / 64)
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+/** Figures extracted from one histogram, levels are in 1/16 entry */
+struct _hist_stats {
+	uint32_t count;    /**< Number of pixels */
+	uint32_t mean;     /**< Mean level */
+	uint32_t white;    /**< Level of the brightest percentile */
+	uint32_t highest;  /**< Level of the brightest ae_saturation % */
+	uint32_t clipped;  /**< Number of pixels in the clipped entries */
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Level, in 1/16 entry, below which percentile % of the pixels are.
+ */
+static uint32_t _percentile_level(const uint32_t *hist, uint32_t count,
+		uint8_t percentile)
+{
+	uint32_t limit, acc;
+	int i;
+
+	/* Walk down from the brightest entry until (100 - percentile)% of
+	 * the pixels are above */
+	limit = (uint32_t)((uint64_t)count * (100 - percentile) / 100);
+	acc = 0;
+	for (i = CAM_3A_HIST_ENTRIES - 1; i > 0; i--) {
+		acc += hist[i];
+		if (acc > limit)
+			break;
+	}
+	return i * 16 + 8;
+}
+
+static void _hist_stats(const uint32_t *hist, const struct _cam_3a_cfg *cfg,
+		struct _hist_stats *stats)
+{
+	uint64_t sum = 0;
+	uint32_t count = 0, clipped = 0;
+	int i;
+
+	for (i = 0; i < CAM_3A_HIST_ENTRIES; i++) {
+		count += hist[i];
+		sum += (uint64_t)hist[i] * i;
+		if (i >= CLIPPED_ENTRY)
+			clipped += hist[i];
+	}
+
+	stats->count = count;
+	stats->clipped = clipped;
+	if (!count) {
+		stats->mean = 0;
+		stats->white = 0;
+		stats->highest = 0;
+		return;
+	}
+	stats->mean = (uint32_t)((sum * 16 + count / 2) / count);
+	stats->white = _percentile_level(hist, count, cfg->wb_percentile);
+	stats->highest = _percentile_level(hist, count,
+			100 - cfg->ae_saturation);
+}
+
+static uint32_t _clamp(uint32_t value, uint32_t min, uint32_t max)
+{
+	if (value < min)
+		return min;
+	if (value > max)
+		return max;
+	return value;
+}
+
+/**
+ * \brief Move value towards target by at most step/256 of value.
+ */
+static uint32_t _rate_limit(uint32_t value, uint32_t target, uint8_t step)
+{
+	uint32_t delta = (uint32_t)(((uint64_t)value * step) >> 8);
+
+	if (!delta)
+		delta = 1;
+	if (target > value + delta)
+		return value + delta;
+	if (target + delta < value)
+		return value - delta;
+	return target;
+}
+
+static uint8_t _update_wb(struct _cam_3a_state *state,
+		const struct _hist_stats *stats)
+{
+	const struct _cam_3a_cfg *cfg = &state->cfg;
+	uint32_t level[CAM_3A_CHANNELS];
+	uint32_t green, target, gain;
+	uint8_t c, changed = 0;
+
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		level[c] = (stats[c].mean * (256 - cfg->wb_white_patch) +
+			    stats[c].white * cfg->wb_white_patch) >> 8;
+		if (!level[c])
+			return 0;
+	}
+	green = (level[CAM_3A_GR] + level[CAM_3A_GB]) / 2;
+
+	for (c = 0; c < CAM_3A_CHANNELS; c++) {
+		target = (uint32_t)(((uint64_t)green * CAM_3A_GAIN_ONE +
+				     level[c] / 2) / level[c]);
+		target = _clamp(target, cfg->wb_gain_min, cfg->wb_gain_max);
+		gain = _rate_limit(state->wb_gain[c], target, cfg->wb_step);
+		if (gain != state->wb_gain[c]) {
+			state->wb_gain[c] = gain;
+			changed = CAM_3A_WB_CHANGED;
+		}
+	}
+	return changed;
+}
+
+static uint8_t _update_ae(struct _cam_3a_state *state,
+		const struct _hist_stats *stats)
+{
+	const struct _cam_3a_cfg *cfg = &state->cfg;
+	uint32_t count, clipped, mean, highest, target, ratio, limit;
+	uint32_t exposure, gain;
+	uint64_t product;
+
+	count = stats[CAM_3A_GR].count + stats[CAM_3A_GB].count;
+	if (!count)
+		return 0;
+	clipped = stats[CAM_3A_GR].clipped + stats[CAM_3A_GB].clipped;
+	mean = (stats[CAM_3A_GR].mean + stats[CAM_3A_GB].mean) / 2;
+	state->green_mean = mean;
+
+	if (state->ae_wait) {
+		state->ae_wait--;
+		return 0;
+	}
+
+	/* Correction ratio in 1/256, bounded by ae_step in both directions */
+	target = cfg->ae_target * 16;
+	if ((uint64_t)clipped * 100 > (uint64_t)count * cfg->ae_saturation)
+		ratio = 0;
+	else if (mean + cfg->ae_tolerance * 16 < target)
+		ratio = mean ? (target << 8) / mean : UINT32_MAX;
+	else if (mean > target + cfg->ae_tolerance * 16)
+		ratio = (target << 8) / mean;
+	else
+		return 0;
+	ratio = _clamp(ratio, 65536 / (256 + cfg->ae_step), 256 + cfg->ae_step);
+
+	/* Do not raise the exposure so much that more than ae_saturation %
+	 * of the pixels would clip, as the next update would lower it again:
+	 * keep the brightest ae_saturation % ae_tolerance below clipping */
+	if (ratio > 256) {
+		highest = (stats[CAM_3A_GR].highest + stats[CAM_3A_GB].highest) / 2;
+		limit = (((CLIPPED_ENTRY - cfg->ae_tolerance) * 16) << 8) / highest;
+		if (ratio > limit)
+			ratio = limit;
+		if (ratio <= 256)
+			return 0;
+	}
+
+	/* Exposure time first, then gain */
+	product = ((uint64_t)state->exposure * state->gain * ratio) >> 8;
+	exposure = (uint32_t)(product / cfg->gain_one);
+	exposure = _clamp(exposure, cfg->exposure_min, cfg->exposure_max);
+	gain = (uint32_t)(product / exposure);
+	gain = _clamp(gain, cfg->gain_min, cfg->gain_max);
+
+	if (exposure == state->exposure && gain == state->gain)
+		return 0;
+	state->exposure = exposure;
+	state->gain = gain;
+	state->ae_wait = cfg->ae_interval;
+	return CAM_3A_AE_CHANGED;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void cam_3a_default_cfg(struct _cam_3a_cfg *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->wb_gain_min = CAM_3A_GAIN_ONE / 2;
+	cfg->wb_gain_max = CAM_3A_GAIN_ONE * 8;
+	cfg->wb_white_patch = 64;
+	cfg->wb_percentile = 98;
+	cfg->wb_step = 32;
+	cfg->ae_enabled = false;
+	cfg->ae_target = CAM_3A_HIST_ENTRIES * 18 / 100;
+	cfg->ae_tolerance = CAM_3A_HIST_ENTRIES / 64;
+	cfg->ae_saturation = 2;
+	cfg->ae_step = 64;
+	cfg->ae_interval = 1;
+	cfg->exposure_min = 1;
+	cfg->exposure_max = 1;
+	cfg->gain_min = 1;
+	cfg->gain_max = 1;
+	cfg->gain_one = 1;
+}
+
+void cam_3a_init(struct _cam_3a_state *state,
+		const struct _cam_3a_cfg *cfg, uint32_t exposure, uint16_t gain)
+{
+	uint8_t c;
+
+	memset(state, 0, sizeof(*state));
+	state->cfg = *cfg;
+	for (c = 0; c < CAM_3A_CHANNELS; c++)
+		state->wb_gain[c] = CAM_3A_GAIN_ONE;
+	state->exposure = _clamp(exposure, cfg->exposure_min, cfg->exposure_max);
+	state->gain = _clamp(gain, cfg->gain_min, cfg->gain_max);
+}
+
+uint8_t cam_3a_update(struct _cam_3a_state *state,
+		const uint32_t *const hist[CAM_3A_CHANNELS])
+{
+	struct _hist_stats stats[CAM_3A_CHANNELS];
+	uint8_t c, changed;
+
+	for (c = 0; c < CAM_3A_CHANNELS; c++)
+		_hist_stats(hist[c], &state->cfg, &stats[c]);
+
+	changed = _update_wb(state, stats);
+	if (state->cfg.ae_enabled)
+		changed |= _update_ae(state, stats);
+	state->updates++;
+	return changed;
+}
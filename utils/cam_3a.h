@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Auto-exposure and auto-white-balance control loop driven by per-channel
+ * histograms of the raw Bayer data.
+ *
+ * The functions in this module only operate on histogram tables and have
+ * no dependency on the ISC, the sensor or the DMA. They can thus be
+ * compiled for the host and fed with recorded histogram traces.
+ *
+ * White balance gains are unsigned 4:9 fixed point values as used by the
+ * ISC WB module (CAM_3A_GAIN_ONE is 1.0). They are estimated from
+ * histograms taken ahead of the white balance, blending the gray world
+ * estimate (channel means) with the white patch estimate (brightest
+ * percentile of each channel).
+ *
+ * Exposure is corrected from the mean of the green channels towards a
+ * target level. It is lowered while more than ae_saturation % of the green
+ * pixels clip, and never raised past the point where they would. Exposure time and gain are in sensor units, the exposure
+ * time being raised first and the gain only when the exposure time is at
+ * its maximum. Both loops are rate limited: each update only moves the
+ * values by a bounded ratio, and the exposure is only changed every
+ * ae_interval updates to let the sensor settle.
+ *
+ * Trace format, one record per line, values in decimal:
+ * - "C" and the 16 fields of struct _cam_3a_cfg, in declaration order;
+ * - "I exposure gain wb_gr wb_r wb_gb wb_b ae_wait": the state the trace
+ *   starts from;
+ * - "H channel first n" and the n counts of the histogram entries first
+ *   to first + n - 1, the other entries being zero; one per channel;
+ * - "U flags wb_gr wb_r wb_gb wb_b exposure gain green_mean": the result
+ *   of cam_3a_update() on the histograms above.
+ * isc_3a_set_trace() prints such traces, tests/host/test_cam_3a.c replays
+ * them.
+ */
+
+#ifndef CAM_3A_H
+#define CAM_3A_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of entries of a histogram table */
+#define CAM_3A_HIST_ENTRIES 512
+
+/** Histogram channels, in the order of the ISC histogram modes */
+#define CAM_3A_GR       0
+#define CAM_3A_R        1
+#define CAM_3A_GB       2
+#define CAM_3A_B        3
+#define CAM_3A_CHANNELS 4
+
+/** White balance gain of 1.0 */
+#define CAM_3A_GAIN_ONE 0x200
+
+/** cam_3a_update() result flags */
+#define CAM_3A_WB_CHANGED (1 << 0)
+#define CAM_3A_AE_CHANGED (1 << 1)
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Control loop parameters */
+struct _cam_3a_cfg {
+	/* White balance */
+	uint16_t wb_gain_min;      /**< Lowest gain (4:9) */
+	uint16_t wb_gain_max;      /**< Highest gain (4:9) */
+	uint16_t wb_white_patch;   /**< Weight of the white patch estimate, 0..256 */
+	uint8_t  wb_percentile;    /**< Percentile of the white patch, in % */
+	uint8_t  wb_step;          /**< Largest gain change per update, in 1/256 */
+
+	/* Exposure */
+	bool     ae_enabled;       /**< false to only run the white balance */
+	uint16_t ae_target;        /**< Target mean green level, in histogram entries */
+	uint16_t ae_tolerance;     /**< No correction within target +/- tolerance */
+	uint8_t  ae_saturation;    /**< Highest share of clipped green pixels, in % */
+	uint8_t  ae_step;          /**< Largest exposure change per update, in 1/256 */
+	uint8_t  ae_interval;      /**< Updates between two exposure changes */
+	uint32_t exposure_min;     /**< Shortest exposure time, sensor units */
+	uint32_t exposure_max;     /**< Longest exposure time, sensor units */
+	uint16_t gain_min;         /**< Lowest sensor gain */
+	uint16_t gain_max;         /**< Highest sensor gain */
+	uint16_t gain_one;         /**< Sensor gain value for 1.0 */
+};
+
+/** Control loop state */
+struct _cam_3a_state {
+	struct _cam_3a_cfg cfg;
+	uint16_t wb_gain[CAM_3A_CHANNELS]; /**< White balance gains (4:9) */
+	uint32_t exposure;                 /**< Sensor exposure time */
+	uint16_t gain;                     /**< Sensor gain */
+	uint16_t green_mean;               /**< Last mean green level, in 1/16 entry */
+	uint8_t  ae_wait;                  /**< Updates left before next exposure change */
+	uint32_t updates;                  /**< Number of updates */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Fill a configuration with default parameters. The sensor limits
+ * (exposure_min/max, gain_min/max/one) are set for a sensor without manual
+ * exposure control and ae_enabled is false.
+ */
+extern void cam_3a_default_cfg(struct _cam_3a_cfg *cfg);
+
+/**
+ * \brief Initialize the control loop.
+ * \param state     Control loop state.
+ * \param cfg       Parameters, copied into the state.
+ * \param exposure  Current sensor exposure time.
+ * \param gain      Current sensor gain.
+ */
+extern void cam_3a_init(struct _cam_3a_state *state,
+		const struct _cam_3a_cfg *cfg, uint32_t exposure, uint16_t gain);
+
+/**
+ * \brief Run one step of the control loop.
+ * \param state  Control loop state, holding the new gains and exposure.
+ * \param hist   Histogram tables of CAM_3A_HIST_ENTRIES entries, indexed by
+ *               CAM_3A_GR, CAM_3A_R, CAM_3A_GB and CAM_3A_B.
+ * \return CAM_3A_WB_CHANGED and/or CAM_3A_AE_CHANGED if the white balance
+ * gains or the sensor exposure need to be programmed.
+ */
+extern uint8_t cam_3a_update(struct _cam_3a_state *state,
+		const uint32_t *const hist[CAM_3A_CHANNELS]);
+
+#endif /* CAM_3A_H */
@@ -0,0 +1,321 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  Implementation of the event loop.
+ *
+ *  The event queue and the timer list are only changed with IRQs masked.
+ *  Handlers run with IRQs enabled.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "event.h"
+#include "power.h"
+#include "timer.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Pending events, in posting order */
+static struct _event* _head;
+static struct _event* _tail;
+static uint32_t _pending;
+
+/** Active timers, earliest deadline first */
+static struct _event_timer* _timers;
+
+static void _default_idle(uint32_t deadline);
+
+static event_idle_hook_t _idle_hook = _default_idle;
+
+static struct _event_stats _stats;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _default_idle(uint32_t deadline)
+{
+#if defined(CONFIG_TIMER_TICKLESS)
+	power_idle(deadline);
+#elif !defined(CONFIG_TIMER_POLLING)
+	irq_wait();
+#endif
+}
+
+/** Tell whether tick a is before tick b, across counter wrap-around */
+static inline bool _before(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) < 0;
+}
+
+/** Called with IRQs masked */
+static void _queue(struct _event* event)
+{
+	if (event->pending)
+		return;
+
+	event->pending = true;
+	event->next = NULL;
+	if (_tail)
+		_tail->next = event;
+	else
+		_head = event;
+	_tail = event;
+
+	if (++_pending > _stats.max_pending)
+		_stats.max_pending = _pending;
+}
+
+/** Called with IRQs masked */
+static void _unqueue(struct _event* event)
+{
+	struct _event* prev = NULL;
+	struct _event* e;
+
+	if (!event->pending)
+		return;
+
+	for (e = _head; e && e != event; e = e->next)
+		prev = e;
+	if (!e)
+		return;
+
+	if (prev)
+		prev->next = event->next;
+	else
+		_head = event->next;
+	if (_tail == event)
+		_tail = prev;
+	event->pending = false;
+	_pending--;
+}
+
+/** Called with IRQs masked */
+static void _timer_insert(struct _event_timer* timer)
+{
+	struct _event_timer** link = &_timers;
+
+	while (*link && !_before(timer->deadline, (*link)->deadline))
+		link = &(*link)->next;
+	timer->next = *link;
+	*link = timer;
+	timer->active = true;
+}
+
+/** Called with IRQs masked */
+static void _timer_remove(struct _event_timer* timer)
+{
+	struct _event_timer** link = &_timers;
+
+	if (!timer->active)
+		return;
+
+	while (*link && *link != timer)
+		link = &(*link)->next;
+	if (*link)
+		*link = timer->next;
+	timer->active = false;
+}
+
+/** Post the events of the expired timers, called with IRQs masked */
+static void _timers_expire(uint32_t now)
+{
+	struct _event_timer* timer;
+
+	while (_timers && !_before(now, _timers->deadline)) {
+		timer = _timers;
+		_timers = timer->next;
+		timer->active = false;
+		_stats.timers++;
+		_queue(&timer->event);
+
+		if (timer->period) {
+			timer->deadline += timer->period;
+			/* skip the periods missed while the loop was busy */
+			if (!_before(now, timer->deadline))
+				timer->deadline = now + timer->period;
+			_timer_insert(timer);
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void event_init(struct _event* event, event_handler_t handler, void* arg)
+{
+	event->handler = handler;
+	event->arg = arg;
+	event->next = NULL;
+	event->pending = false;
+}
+
+void event_post(struct _event* event)
+{
+	uint32_t state = irq_save();
+	_queue(event);
+	irq_restore(state);
+}
+
+void event_cancel(struct _event* event)
+{
+	uint32_t state = irq_save();
+	_unqueue(event);
+	irq_restore(state);
+}
+
+bool event_is_pending(const struct _event* event)
+{
+	return event->pending;
+}
+
+void event_timer_init(struct _event_timer* timer, event_handler_t handler,
+		void* arg)
+{
+	event_init(&timer->event, handler, arg);
+	timer->deadline = 0;
+	timer->period = 0;
+	timer->active = false;
+	timer->next = NULL;
+}
+
+void event_timer_start(struct _event_timer* timer, uint32_t delay,
+		uint32_t period)
+{
+	uint32_t state = irq_save();
+
+	_timer_remove(timer);
+	timer->deadline = timer_get_tick() + delay;
+	timer->period = period;
+	_timer_insert(timer);
+
+	irq_restore(state);
+}
+
+void event_timer_stop(struct _event_timer* timer)
+{
+	uint32_t state = irq_save();
+
+	_timer_remove(timer);
+	_unqueue(&timer->event);
+
+	irq_restore(state);
+}
+
+void event_set_idle_hook(event_idle_hook_t hook)
+{
+	_idle_hook = hook ? hook : _default_idle;
+}
+
+bool event_process(void)
+{
+	struct _event* event;
+	uint32_t state;
+	bool ran = false;
+
+	while (true) {
+		state = irq_save();
+		_timers_expire(timer_get_tick());
+		event = _head;
+		if (event) {
+			_head = event->next;
+			if (!_head)
+				_tail = NULL;
+			/* cleared before the handler runs, so that it can be
+			 * posted again while it is handled */
+			event->pending = false;
+			_pending--;
+		}
+		irq_restore(state);
+
+		if (!event)
+			break;
+
+		_stats.events++;
+		event->handler(event->arg);
+		ran = true;
+	}
+
+	return ran;
+}
+
+void event_loop(void)
+{
+	uint32_t state, deadline;
+
+	while (true) {
+		if (event_process())
+			continue;
+
+		/* IRQs stay masked from the last check of the queue up to the
+		 * idle hook, an interrupt occurring in between still wakes up
+		 * the core and is handled when they are restored */
+		state = irq_save();
+		if (!_head) {
+			if (_timers)
+				deadline = _timers->deadline;
+			else
+				deadline = timer_get_tick() + (UINT32_MAX >> 1);
+			if (_before(timer_get_tick(), deadline)) {
+				_stats.idles++;
+				_idle_hook(deadline);
+			}
+		}
+		irq_restore(state);
+	}
+}
+
+void event_get_stats(struct _event_stats* stats)
+{
+	uint32_t state = irq_save();
+	*stats = _stats;
+	irq_restore(state);
+}
+
+void event_reset_stats(void)
+{
+	uint32_t state = irq_save();
+	_stats.events = 0;
+	_stats.timers = 0;
+	_stats.idles = 0;
+	_stats.max_pending = _pending;
+	irq_restore(state);
+}
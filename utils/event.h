@@ -0,0 +1,187 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  \par Purpose
+ *  Run-to-completion event loop for bare-metal applications.
+ *
+ *  Work is split into events: a handler and its argument. Interrupt
+ *  handlers and driver callbacks post events, the main loop runs their
+ *  handlers one after the other in the order they were posted, each one to
+ *  completion. Event timers post their event when they expire, either once
+ *  or periodically. When nothing is pending, the loop calls its idle hook
+ *  with IRQs masked: by default the core waits for an interrupt, or enters
+ *  the deepest low-power state allowed until the next timer deadline when
+ *  CONFIG_TIMER_TICKLESS is set (see power_idle()).
+ *
+ *  Posting an event which is already pending does nothing, so a handler
+ *  must consume all the work it was posted for (all received frames, all
+ *  received characters...).
+ *
+ *  Timers are counted in timer ticks (see timer_get_tick()).
+ *
+ *  \par Usage
+ *  -# Initialize the events with event_init() and the timers with
+ *     event_timer_init().
+ *  -# Post the events from interrupt handlers or driver callbacks with
+ *     event_post(), start the timers with event_timer_start().
+ *  -# Call event_loop() at the end of main(), or event_process() from an
+ *     existing main loop.
+ */
+
+#ifndef EVENT_HEADER_
+#define EVENT_HEADER_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+typedef void (*event_handler_t)(void* arg);
+
+/**
+ * Idle hook, called with IRQs masked when no event is pending. It must
+ * return once an interrupt is pending. deadline is the tick of the next
+ * timer expiry.
+ */
+typedef void (*event_idle_hook_t)(uint32_t deadline);
+
+/** Event, owned by the caller */
+struct _event {
+	event_handler_t handler;
+	void* arg;
+	struct _event* next;         /**< queue linkage */
+	volatile bool pending;
+};
+
+/** Timer posting an event when it expires, owned by the caller */
+struct _event_timer {
+	struct _event event;         /**< must be first */
+	uint32_t deadline;           /**< tick of the next expiry */
+	uint32_t period;             /**< ticks, 0 for a one-shot timer */
+	bool active;
+	struct _event_timer* next;   /**< timer list linkage */
+};
+
+/** Event loop statistics */
+struct _event_stats {
+	uint32_t events;             /**< handlers run */
+	uint32_t timers;             /**< timer expiries */
+	uint32_t idles;              /**< calls to the idle hook */
+	uint32_t max_pending;        /**< highest number of pending events */
+};
+
+/*----------------------------------------------------------------------------
+ *         Global functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize an event.
+ * \param event    Event.
+ * \param handler  Function run by the event loop once the event is posted.
+ * \param arg      Argument given to the handler.
+ */
+extern void event_init(struct _event* event, event_handler_t handler,
+		void* arg);
+
+/**
+ * \brief Post an event, does nothing if it is already pending. Can be
+ * called from interrupt handlers.
+ */
+extern void event_post(struct _event* event);
+
+/**
+ * \brief Remove an event from the queue if it is pending.
+ */
+extern void event_cancel(struct _event* event);
+
+/**
+ * \brief Tell whether an event is waiting to be handled.
+ */
+extern bool event_is_pending(const struct _event* event);
+
+/**
+ * \brief Initialize a timer.
+ * \param timer    Timer.
+ * \param handler  Function run by the event loop when the timer expires.
+ * \param arg      Argument given to the handler.
+ */
+extern void event_timer_init(struct _event_timer* timer,
+		event_handler_t handler, void* arg);
+
+/**
+ * \brief Start or restart a timer. Can be called from interrupt handlers.
+ * \param timer   Timer.
+ * \param delay   Ticks before the first expiry.
+ * \param period  Ticks between the next expiries, 0 for a one-shot timer.
+ */
+extern void event_timer_start(struct _event_timer* timer, uint32_t delay,
+		uint32_t period);
+
+/**
+ * \brief Stop a timer, and cancel its event if it expired but was not
+ * handled yet.
+ */
+extern void event_timer_stop(struct _event_timer* timer);
+
+/**
+ * \brief Replace the idle hook, NULL restores the default one.
+ */
+extern void event_set_idle_hook(event_idle_hook_t hook);
+
+/**
+ * \brief Post the events of the expired timers, then run the pending
+ * events until the queue is empty.
+ * \return true if at least one handler was run.
+ */
+extern bool event_process(void);
+
+/**
+ * \brief Run the event loop, never returns.
+ */
+extern void event_loop(void);
+
+/**
+ * \brief Get the event loop statistics.
+ */
+extern void event_get_stats(struct _event_stats* stats);
+
+/**
+ * \brief Clear the event loop statistics.
+ */
+extern void event_reset_stats(void);
+
+#endif /* EVENT_HEADER_ */
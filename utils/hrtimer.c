@@ -0,0 +1,492 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  High-resolution timestamps and timer wheel on a TC channel.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "hrtimer.h"
+#include "peripherals/aic.h"
+#include "peripherals/pmc.h"
+#include "peripherals/tc.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define WHEEL_BITS       6
+#define WHEEL_SLOTS      (1 << WHEEL_BITS)
+#define WHEEL_MASK       (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS     5
+
+/** Level of the timers waiting for their callback */
+#define LEVEL_EXPIRED    0xff
+
+/** Longest distance programmed in RC, keeps the 64-bit extension current */
+#define MAX_COMPARE_DELTA (1u << 31)
+
+/** Target duration of a level 0 slot: 64us */
+#define SLOT_FREQ        15625
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static Tc* _tc;
+static uint32_t _channel;
+static uint32_t _freq;
+
+/** 64-bit extension of the counter */
+static uint32_t _hi;
+static uint32_t _last_lo;
+
+/** Ticks per level 0 slot, as a power of two */
+static uint8_t _shift;
+
+/** Smallest distance programmed in RC */
+static uint32_t _min_delta;
+
+/** Level 0 slot index the wheel has been run up to */
+static uint64_t _clk;
+
+static struct _hrtimer* _wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t _bitmap[WHEEL_LEVELS];
+static struct _hrtimer* _expired;
+static bool _in_handler;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _list_add(struct _hrtimer** list, struct _hrtimer* timer)
+{
+	timer->prev = NULL;
+	timer->next = *list;
+	if (*list)
+		(*list)->prev = timer;
+	*list = timer;
+	timer->list = list;
+}
+
+static void _list_del(struct _hrtimer* timer)
+{
+	if (timer->prev)
+		timer->prev->next = timer->next;
+	else
+		*timer->list = timer->next;
+	if (timer->next)
+		timer->next->prev = timer->prev;
+
+	if (timer->level < WHEEL_LEVELS && !_wheel[timer->level][timer->slot])
+		_bitmap[timer->level] &= ~(1ull << timer->slot);
+
+	timer->list = NULL;
+	timer->next = NULL;
+	timer->prev = NULL;
+}
+
+static void _enqueue(struct _hrtimer* timer)
+{
+	uint64_t idx = timer->expires >> _shift;
+	uint8_t level, slot, bits;
+
+	if (idx < _clk)
+		idx = _clk;
+
+	/* lowest level where the timer is less than one lap ahead */
+	for (level = 0; level < WHEEL_LEVELS - 1; level++) {
+		bits = level * WHEEL_BITS;
+		if ((idx >> bits) - (_clk >> bits) < WHEEL_SLOTS)
+			break;
+	}
+
+	bits = level * WHEEL_BITS;
+	if ((idx >> bits) - (_clk >> bits) >= WHEEL_SLOTS) {
+		/* beyond the wheel: park in the farthest slot, the timer
+		 * will be re-queued when that slot cascades */
+		idx = ((_clk >> bits) + WHEEL_SLOTS - 1) << bits;
+	}
+
+	slot = (idx >> bits) & WHEEL_MASK;
+	timer->level = level;
+	timer->slot = slot;
+	_list_add(&_wheel[level][slot], timer);
+	_bitmap[level] |= 1ull << slot;
+}
+
+static void _cascade(uint8_t level)
+{
+	uint8_t slot = (_clk >> (level * WHEEL_BITS)) & WHEEL_MASK;
+	struct _hrtimer* list = _wheel[level][slot];
+	struct _hrtimer* timer;
+
+	_wheel[level][slot] = NULL;
+	_bitmap[level] &= ~(1ull << slot);
+
+	while (list) {
+		timer = list;
+		list = timer->next;
+		timer->list = NULL;
+		_enqueue(timer);
+	}
+}
+
+/** Distance from 'pos' to the next set bit of a wheel bitmap, or -1 */
+static int _next_slot(uint64_t bitmap, uint8_t pos)
+{
+	uint64_t rot;
+
+	if (!bitmap)
+		return -1;
+	rot = pos ? (bitmap >> pos) | (bitmap << (WHEEL_SLOTS - pos)) : bitmap;
+	return __builtin_ctzll(rot);
+}
+
+/** First level 0 slot index at which an upper level cascades */
+static uint64_t _next_cascade_clk(void)
+{
+	uint64_t best = UINT64_MAX;
+	uint64_t cur, clk;
+	uint8_t level, bits;
+	int d;
+
+	for (level = 1; level < WHEEL_LEVELS; level++) {
+		bits = level * WHEEL_BITS;
+		cur = _clk >> bits;
+		/* the current slot of an upper level is always empty */
+		d = _next_slot(_bitmap[level] & ~(1ull << (cur & WHEEL_MASK)),
+				cur & WHEEL_MASK);
+		if (d < 0)
+			continue;
+		clk = (cur + d) << bits;
+		if (clk < best)
+			best = clk;
+	}
+
+	return best;
+}
+
+/** First level 0 slot index at which the wheel has work to do */
+static uint64_t _next_event_clk(void)
+{
+	uint64_t best = _next_cascade_clk();
+	int d = _next_slot(_bitmap[0], _clk & WHEEL_MASK);
+
+	if (d >= 0 && _clk + d < best)
+		best = _clk + d;
+	return best;
+}
+
+static uint64_t _next_expiry(void)
+{
+	uint64_t clk = _next_cascade_clk();
+	uint64_t best = UINT64_MAX;
+	struct _hrtimer* timer;
+	int d;
+
+	if (_expired)
+		return 0;
+
+	/* level 0 slots hold exact expiries, upper levels need a wake-up at
+	 * the cascade */
+	d = _next_slot(_bitmap[0], _clk & WHEEL_MASK);
+	if (d >= 0) {
+		timer = _wheel[0][(_clk + d) & WHEEL_MASK];
+		for (; timer; timer = timer->next)
+			if (timer->expires < best)
+				best = timer->expires;
+	}
+	if (clk != UINT64_MAX && (clk << _shift) < best)
+		best = clk << _shift;
+
+	return best;
+}
+
+/** Advance the wheel to level 0 slot index 'clk', cascading on the way */
+static void _advance(uint64_t clk)
+{
+	uint8_t level;
+
+	_clk = clk;
+	for (level = 1; level < WHEEL_LEVELS; level++) {
+		if (_clk & ((1ull << (level * WHEEL_BITS)) - 1))
+			break;
+		_cascade(level);
+	}
+}
+
+static void _collect(uint64_t now)
+{
+	struct _hrtimer* timer;
+	struct _hrtimer* next;
+
+	for (timer = _wheel[0][_clk & WHEEL_MASK]; timer; timer = next) {
+		next = timer->next;
+		if (timer->expires <= now) {
+			_list_del(timer);
+			timer->level = LEVEL_EXPIRED;
+			_list_add(&_expired, timer);
+		}
+	}
+}
+
+/**
+ * Run the expired timers. The wheel is only walked with IRQs masked: a
+ * higher priority interrupt may call hrtimer_start() or hrtimer_cancel()
+ * while the TC handler runs (see irq_dispatch()). Callbacks run with IRQs
+ * restored.
+ */
+static void _process(uint64_t now)
+{
+	uint64_t now_clk = now >> _shift;
+	uint64_t clk;
+	struct _hrtimer* timer;
+	uint32_t state = irq_save();
+
+	for (;;) {
+		_collect(now);
+		if (_clk >= now_clk)
+			break;
+		/* nothing to do before the next event: jump there */
+		clk = _next_event_clk();
+		if (clk <= _clk)
+			clk = _clk + 1;
+		if (clk > now_clk)
+			clk = now_clk;
+		_advance(clk);
+	}
+
+	while (_expired) {
+		timer = _expired;
+		_list_del(timer);
+		if (timer->period) {
+			timer->expires += timer->period;
+			if (timer->expires <= now)
+				timer->expires = now + timer->period;
+			_enqueue(timer);
+		}
+		irq_restore(state);
+		timer->cb(timer, timer->arg);
+		state = irq_save();
+	}
+
+	irq_restore(state);
+}
+
+static void _program(void)
+{
+	uint64_t now, next;
+	uint32_t rc;
+
+	if (_in_handler)
+		return;
+
+	now = hrtimer_get_ticks();
+	next = _next_expiry();
+	if (next == UINT64_MAX || next - now > MAX_COMPARE_DELTA)
+		next = now + MAX_COMPARE_DELTA;
+	if (next < now + _min_delta)
+		next = now + _min_delta;
+
+	rc = (uint32_t)next;
+	tc_set_ra_rb_rc(_tc, _channel, NULL, NULL, &rc);
+	/* the compare only matches on equality, never leave it behind */
+	while ((int32_t)(rc - tc_get_cv(_tc, _channel)) <= 0) {
+		rc = tc_get_cv(_tc, _channel) + _min_delta;
+		tc_set_ra_rb_rc(_tc, _channel, NULL, NULL, &rc);
+	}
+}
+
+static void _hrtimer_handler(void)
+{
+	uint32_t state;
+
+	tc_get_status(_tc, _channel);
+
+	_in_handler = true;
+	_process(hrtimer_get_ticks());
+
+	state = irq_save();
+	_in_handler = false;
+	_program();
+	irq_restore(state);
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void hrtimer_configure(Tc* tc, uint32_t channel, uint32_t tcclks)
+{
+	uint32_t id = get_tc_id_from_addr(tc);
+	uint32_t slot_ticks;
+	uint8_t i;
+
+	_tc = tc;
+	_channel = channel;
+
+	pmc_enable_peripheral(id);
+	_freq = tc_get_available_freq(tc, tcclks);
+
+	slot_ticks = _freq / SLOT_FREQ;
+	_shift = slot_ticks ? 31 - __builtin_clz(slot_ticks) : 0;
+	_min_delta = _freq / 500000;
+	if (_min_delta < 2)
+		_min_delta = 2;
+
+	for (i = 0; i < WHEEL_LEVELS; i++) {
+		uint8_t j;
+		for (j = 0; j < WHEEL_SLOTS; j++)
+			_wheel[i][j] = NULL;
+		_bitmap[i] = 0;
+	}
+	_expired = NULL;
+	_hi = 0;
+	_last_lo = 0;
+	_clk = 0;
+
+	tc_configure(tc, channel, tcclks | TC_CMR_WAVE | TC_CMR_WAVSEL_UP);
+	aic_set_source_vector(id, _hrtimer_handler);
+	tc_start(tc, channel);
+	_program();
+	tc_enable_it(tc, channel, TC_IER_CPCS);
+	aic_enable(id);
+}
+
+uint32_t hrtimer_get_frequency(void)
+{
+	return _freq;
+}
+
+uint64_t hrtimer_get_ticks(void)
+{
+	uint32_t state = irq_save();
+	uint32_t lo = tc_get_cv(_tc, _channel);
+	uint64_t ticks;
+
+	if (lo < _last_lo)
+		_hi++;
+	_last_lo = lo;
+	ticks = ((uint64_t)_hi << 32) | lo;
+
+	irq_restore(state);
+	return ticks;
+}
+
+uint64_t hrtimer_get_us(void)
+{
+	uint64_t ticks = hrtimer_get_ticks();
+
+	return (ticks / _freq) * 1000000 + ((ticks % _freq) * 1000000) / _freq;
+}
+
+uint64_t hrtimer_us_to_ticks(uint64_t us)
+{
+	return (us / 1000000) * _freq + ((us % 1000000) * _freq) / 1000000;
+}
+
+uint64_t hrtimer_ticks_to_ns(uint64_t ticks)
+{
+	return (ticks / _freq) * 1000000000 + ((ticks % _freq) * 1000000000) / _freq;
+}
+
+void hrtimer_delay_us(uint32_t us)
+{
+	uint64_t end = hrtimer_get_ticks() + hrtimer_us_to_ticks(us);
+
+	while (hrtimer_get_ticks() < end);
+}
+
+void hrtimer_setup(struct _hrtimer* timer, hrtimer_callback_t cb, void* arg)
+{
+	timer->expires = 0;
+	timer->period = 0;
+	timer->cb = cb;
+	timer->arg = arg;
+	timer->next = NULL;
+	timer->prev = NULL;
+	timer->list = NULL;
+	timer->level = 0;
+	timer->slot = 0;
+}
+
+void hrtimer_start(struct _hrtimer* timer, uint64_t expires, uint32_t period)
+{
+	uint32_t state = irq_save();
+
+	if (timer->list)
+		_list_del(timer);
+	timer->expires = expires;
+	timer->period = period;
+	_enqueue(timer);
+	_program();
+
+	irq_restore(state);
+}
+
+void hrtimer_start_us(struct _hrtimer* timer, uint32_t delay_us,
+		uint32_t period_us)
+{
+	hrtimer_start(timer, hrtimer_get_ticks() + hrtimer_us_to_ticks(delay_us),
+			(uint32_t)hrtimer_us_to_ticks(period_us));
+}
+
+bool hrtimer_cancel(struct _hrtimer* timer)
+{
+	uint32_t state = irq_save();
+	bool pending = timer->list != NULL;
+
+	if (pending)
+		_list_del(timer);
+
+	irq_restore(state);
+	return pending;
+}
+
+bool hrtimer_is_pending(const struct _hrtimer* timer)
+{
+	return timer->list != NULL;
+}
+
+uint64_t hrtimer_get_next_expiry(void)
+{
+	uint32_t state = irq_save();
+	uint64_t next = _next_expiry();
+
+	irq_restore(state);
+	return next;
+}
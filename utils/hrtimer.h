@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  \par Purpose
+ *  High-resolution timestamps and software timers on a TC channel.
+ *
+ *  One TC channel runs free in waveform UP mode from a fast clock and is
+ *  extended to 64 bits in software. Timers are kept in a hierarchical
+ *  timer wheel (5 levels of 64 slots): adding or cancelling a timer is
+ *  O(1) whatever the number of timers. The RC compare of the channel is
+ *  programmed to the exact expiry of the next timer, so there is no
+ *  periodic tick; without pending timers the channel still wakes up every
+ *  2^31 counts to keep the 64-bit extension up to date.
+ *
+ *  \par Usage
+ *  -# Call hrtimer_configure() once with a TC instance dedicated to this
+ *     service (its interrupt vector is taken over).
+ *  -# Use hrtimer_get_ticks() / hrtimer_get_us() for timestamps.
+ *  -# Initialize timers with hrtimer_setup(), then arm them with
+ *     hrtimer_start() or hrtimer_start_us(). Callbacks run in interrupt
+ *     context.
+ */
+
+#ifndef HRTIMER_HEADER_
+#define HRTIMER_HEADER_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+struct _hrtimer;
+
+typedef void (*hrtimer_callback_t)(struct _hrtimer* timer, void* arg);
+
+/** Software timer, owned by the caller */
+struct _hrtimer {
+	uint64_t expires;            /**< absolute expiry, in counter ticks */
+	uint32_t period;             /**< reload in ticks, 0 for one-shot */
+	hrtimer_callback_t cb;
+	void* arg;
+	/* wheel linkage */
+	struct _hrtimer* next;
+	struct _hrtimer* prev;
+	struct _hrtimer** list;      /**< list holding the timer, NULL if idle */
+	uint8_t level;
+	uint8_t slot;
+};
+
+/*----------------------------------------------------------------------------
+ *         Global functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Start the counter and the timer service.
+ * \param tc      TC instance, dedicated to the service
+ * \param channel TC channel
+ * \param tcclks  Clock selection (TC_CMR_TCCLKS_TIMER_CLOCKx), e.g.
+ *                TC_CMR_TCCLKS_TIMER_CLOCK2 for MCK/8
+ */
+extern void hrtimer_configure(Tc* tc, uint32_t channel, uint32_t tcclks);
+
+/**
+ * \brief Get the counter frequency in Hz
+ */
+extern uint32_t hrtimer_get_frequency(void);
+
+/**
+ * \brief Get the 64-bit timestamp, in counter ticks
+ */
+extern uint64_t hrtimer_get_ticks(void);
+
+/**
+ * \brief Get the 64-bit timestamp, in microseconds
+ */
+extern uint64_t hrtimer_get_us(void);
+
+/**
+ * \brief Convert microseconds to counter ticks
+ */
+extern uint64_t hrtimer_us_to_ticks(uint64_t us);
+
+/**
+ * \brief Convert counter ticks to nanoseconds
+ */
+extern uint64_t hrtimer_ticks_to_ns(uint64_t ticks);
+
+/**
+ * \brief Busy-wait for a number of microseconds
+ */
+extern void hrtimer_delay_us(uint32_t us);
+
+/**
+ * \brief Initialize a timer before its first use
+ * \param timer Timer
+ * \param cb    Callback, called in interrupt context on expiry
+ * \param arg   Callback argument
+ */
+extern void hrtimer_setup(struct _hrtimer* timer, hrtimer_callback_t cb,
+		void* arg);
+
+/**
+ * \brief Arm (or re-arm) a timer at an absolute time
+ * \param timer   Timer
+ * \param expires Absolute expiry, in ticks (see hrtimer_get_ticks())
+ * \param period  Reload in ticks for a periodic timer, 0 for one-shot
+ */
+extern void hrtimer_start(struct _hrtimer* timer, uint64_t expires,
+		uint32_t period);
+
+/**
+ * \brief Arm (or re-arm) a timer relative to now
+ * \param timer     Timer
+ * \param delay_us  Delay before the first expiry, in microseconds
+ * \param period_us Reload in microseconds, 0 for one-shot
+ */
+extern void hrtimer_start_us(struct _hrtimer* timer, uint32_t delay_us,
+		uint32_t period_us);
+
+/**
+ * \brief Cancel a timer
+ * \return true if the timer was pending
+ */
+extern bool hrtimer_cancel(struct _hrtimer* timer);
+
+/**
+ * \brief Tell whether a timer is armed
+ */
+extern bool hrtimer_is_pending(const struct _hrtimer* timer);
+
+/**
+ * \brief Get the time of the next timer expiry, in ticks.
+ * Used to decide how long the system may sleep.
+ * \return expiry, or UINT64_MAX if no timer is armed
+ */
+extern uint64_t hrtimer_get_next_expiry(void);
+
+#endif /* HRTIMER_HEADER_ */
@@ -42,17 +42,31 @@
 
 #include "board.h"
 #include "compiler.h"
+#include "intmath.h"
 
 #include "video/lcdd.h"
+#include "peripherals/dma.h"
+#include "misc/cache.h"
 
 #include "lcd_draw.h"
 #include "lcd_font.h"
+#include "lcd_raster.h"
 #include "font.h"
 
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Minimum area, in bytes, for a rectangle to be filled by DMA */
+#define LCDD_DMA_FILL_MIN_SIZE (16 * 1024)
+
+/** Number of rows copied by one DMA linked list */
+#define LCDD_DMA_FILL_ROWS 32
+
 /*----------------------------------------------------------------------------
  *        Local variable
  *----------------------------------------------------------------------------*/
@@ -60,15 +74,36 @@
 /** Front color cache */
 static uint32_t front_color;
 
+/** Canvas geometry, latched when drawing starts */
+static struct _lcd_surface surface;
+
+/** Memory-to-memory channel used for large fills */
+static struct dma_channel *fill_dma;
+
+/** Linked list used to replicate the first row of a large fill */
+CACHE_ALIGNED static struct dma_xfer_item fill_dlist[LCDD_DMA_FILL_ROWS];
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+/**
+ * Latch the current canvas geometry for the raster functions
+ */
+static void _update_surface(void)
+{
+	struct _lcdd_layer *canvas = lcdd_get_canvas();
+
+	lcd_raster_init_surface(&surface, canvas->buffer, canvas->width,
+			canvas->height, canvas->bpp);
+}
+
 /**
  * Hide canvas layer
  */
 static void _hide_canvas(void)
 {
+	_update_surface();
 	//lcdd_enable_layer(lcdd_get_canvas()->layer_id, false);
 }
 
@@ -97,43 +132,94 @@ static void _set_front_color(uint32_t color)
  */
 static void _draw_pixel(uint32_t dwX, uint32_t dwY)
 {
-	struct _lcdd_layer *pDisp = lcdd_get_canvas();
-	uint8_t *buffer = pDisp->buffer;
-	uint16_t w = pDisp->width;
-	//uint16_t h = pDisp->height;
-	uint16_t cw = pDisp->bpp / 8;	/* color width */
-	uint32_t rw = w * cw;	/* row width in bytes */
-	//uint8_t  r, g, b;
-	uint8_t *pPix;
-
-	if (buffer == NULL)
-		return;
+	lcd_raster_put_pixel(&surface, dwX, dwY, front_color);
+}
 
-	if (rw & 0x3)
-		rw = (rw | 0x3) + 1;	/* 4-byte aligned rows */
-	pPix = &buffer[dwY * rw + cw * dwX];
-
-	switch (pDisp->bpp) {
-	case 16:		/* TRGB 1555 */
-		pPix[0] = (front_color) & 0xFF;
-		pPix[1] = (front_color >> 8) & 0xFF;
-		break;
-	case 24:		/*  RGB  888 */
-		pPix[0] = (front_color) & 0xFF;
-		pPix[1] = (front_color >> 8) & 0xFF;
-		pPix[2] = (front_color >> 16) & 0xFF;
-		break;
-	case 32:		/* ARGB 8888 */
-		pPix[0] = (front_color) & 0xFF;
-		pPix[1] = (front_color >> 8) & 0xFF;
-		pPix[2] = (front_color >> 16) & 0xFF;
-		pPix[3] = (front_color >> 24) & 0xFF;
-		break;
+/**
+ * \brief Replicate the first row of a rectangle to the next rows by DMA.
+ *
+ * \param first  Address of the first (already filled) row.
+ * \param len    Length of a row, in bytes.
+ * \param rows   Total number of rows, including the first one.
+ * \return true if the rows were copied, false if the DMA cannot be used.
+ */
+static bool _dma_fill_rows(uint8_t *first, uint32_t len, uint32_t rows)
+{
+	struct dma_xfer_item_tmpl tmpl;
+	uint32_t stride = surface.stride;
+	uint32_t size = (rows - 1) * stride + len;
+	uint32_t align = (uint32_t)(uintptr_t)first | len | stride;
+	uint8_t *row = first + stride;
+	uint32_t remaining = rows - 1;
+	uint32_t i, count;
+
+	memset(&tmpl, 0, sizeof(tmpl));
+	if ((align & 0x3) == 0) {
+		tmpl.data_width = DMA_DATA_WIDTH_WORD;
+		tmpl.blk_size = len / 4;
+	} else if ((align & 0x1) == 0) {
+		tmpl.data_width = DMA_DATA_WIDTH_HALF_WORD;
+		tmpl.blk_size = len / 2;
+	} else {
+		tmpl.data_width = DMA_DATA_WIDTH_BYTE;
+		tmpl.blk_size = len;
+	}
+	if (tmpl.blk_size > DMA_MAX_BT_SIZE)
+		return false;
+
+	if (!fill_dma) {
+		fill_dma = dma_allocate_channel(DMA_PERIPH_MEMORY,
+				DMA_PERIPH_MEMORY);
+		if (!fill_dma)
+			return false;
+	}
+
+	/* The first row is the source, and no dirty line of the
+	 * destination shall be written back over the DMA data */
+	cache_clean_region(first, size);
+
+	tmpl.upd_sa_per_data = 1;
+	tmpl.upd_da_per_data = 1;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 1;
+	tmpl.chunk_size = DMA_CHUNK_SIZE_1;
+	while (remaining) {
+		count = min_u32(remaining, LCDD_DMA_FILL_ROWS);
+		tmpl.sa = first;
+		for (i = 0; i < count; i++) {
+			tmpl.da = row + i * stride;
+			dma_prepare_item(fill_dma, &tmpl, &fill_dlist[i]);
+			if (i)
+				dma_link_item(fill_dma, &fill_dlist[i - 1],
+						&fill_dlist[i]);
+		}
+		dma_link_item(fill_dma, &fill_dlist[count - 1], NULL);
+		cache_clean_region(fill_dlist, count * sizeof(fill_dlist[0]));
+
+		tmpl.da = row;
+		dma_configure_sg_transfer(fill_dma, &tmpl, fill_dlist);
+		dma_start_transfer(fill_dma);
+		while (!dma_is_transfer_done(fill_dma)) {
+			/* always call dma_poll, it will do nothing if polling
+			 * mode is disabled */
+			dma_poll();
+		}
+
+		row += count * stride;
+		remaining -= count;
 	}
+
+	cache_invalidate_region(first + stride, size - stride);
+	return true;
 }
 
 /**
  * \brief Fill rectangle with front color.
+ *
+ * Corners may be given in any order, the rectangle is clipped to the
+ * canvas. Large areas only have their first row filled by the CPU, the
+ * other rows being copied by DMA.
+ *
  * \param dwX1  X-coordinate of top left.
  * \param dwY1  Y-coordinate of top left.
  * \param dwX2  X-coordinate of bottom right.
@@ -141,56 +227,26 @@ static void _draw_pixel(uint32_t dwX, uint32_t dwY)
  */
 static void _fill_rect(uint32_t dwX1, uint32_t dwY1, uint32_t dwX2, uint32_t dwY2)
 {
-	struct _lcdd_layer *pDisp = lcdd_get_canvas();
-	uint16_t w = pDisp->width;
-	uint16_t cw = pDisp->bpp / 8;	/* color width */
-	uint32_t rw = w * cw;	/* row width in bytes */
-	uint8_t *base;
-	uint8_t *buffer = pDisp->buffer;
-	uint32_t fillStart, fillEnd;
-	uint32_t i;
-	if (buffer == NULL)
+	uint32_t w, h, len;
+	uint8_t *first;
+
+	if (dwX1 > dwX2)
+		SWAP(dwX1, dwX2);
+	if (dwY1 > dwY2)
+		SWAP(dwY1, dwY2);
+	w = dwX2 - dwX1 + 1;
+	h = dwY2 - dwY1 + 1;
+	if (!lcd_raster_clip(&surface, &dwX1, &dwY1, &w, &h))
 		return;
 
-	/* 4-byte aligned rows */
-	if (rw & 0x3)
-		rw = (rw | 0x3) + 1;
-	/* Buffer address for the starting row */
-	base = &buffer[dwY1 * rw];
-
-	fillStart = dwX1 * cw;
-	fillEnd = dwX2 * cw;
-
-#if 1				/* Memcopy pixel */
-	buffer = base;
-	for (; dwY1 <= dwY2; dwY1++) {
-		for (i = fillStart; i <= fillEnd; i += cw) {
-			memcpy(&buffer[i], &front_color, cw);
-		}
-		buffer = &buffer[rw];
-	}
-#endif
-
-#if 0				/* Pixel by pixel */
-	for (; dwY1 <= dwY2; dwY1++) {
-		for (i = dwX1; i <= dwX2; i++) {
-			_draw_pixel(i, dwY1);
-		}
-	}
-#endif
-
-#if 0				/* Optimized */
-	/* First row */
-	for (i = fillStart; i <= fillEnd; i += cw) {
-		memcpy(&base[i], &front_color, cw);
-	}
-	/* Next rows, copy first */
-	buffer = &base[rw + fillStart];
-	for (i = dwY1 + 1; i <= dwY2; i++) {
-		memcpy(buffer, &base[fillStart], fillEnd - fillStart + cw);
-		buffer = &buffer[rw];
+	len = w * (surface.bpp / 8);
+	if (h > 1 && len * h >= LCDD_DMA_FILL_MIN_SIZE) {
+		first = lcd_raster_pixel_addr(&surface, dwX1, dwY1);
+		lcd_raster_fill_span(first, w, surface.bpp, front_color);
+		if (_dma_fill_rows(first, len, h))
+			return;
 	}
-#endif
+	lcd_raster_fill_rect(&surface, dwX1, dwY1, w, h, front_color);
 }
 
 /**
@@ -288,10 +344,9 @@ static uint32_t _draw_line_bresenham (uint32_t dwX1, uint32_t dwY1, uint32_t dwX
  */
 void lcdd_fill(uint32_t color)
 {
-	struct _lcdd_layer *pDisp = lcdd_get_canvas();
 	_set_front_color(color);
 	_hide_canvas();
-	_fill_rect(0, 0, pDisp->width, pDisp->height);
+	_fill_rect(0, 0, surface.width - 1, surface.height - 1);
 	_show_canvas();
 }
 
@@ -333,36 +388,8 @@ void lcdd_draw_pixel(uint32_t x, uint32_t y, uint32_t color)
  */
 extern uint32_t lcdd_read_pixel(uint32_t x, uint32_t y)
 {
-	struct _lcdd_layer *pDisp = lcdd_get_canvas();
-	uint8_t *buffer = pDisp->buffer;
-	uint16_t w = pDisp->width;
-	//uint16_t h = pDisp->height;
-	uint16_t cw = pDisp->bpp / 8;	/* color width */
-	uint32_t rw = w * cw;	/* row width in bytes */
-	uint8_t *pPix;
-	uint32_t color = 0;
-
-	if (buffer == NULL)
-		return 0;
-
-	if (rw & 0x3)
-		rw = (rw | 0x3) + 1;	/* 4-byte aligned rows */
-	pPix = &buffer[x * rw + cw * y];
-
-	switch (pDisp->bpp) {
-	case 16:		/* TRGB 1555 */
-		color = pPix[0] | (pPix[1] << 8);
-		break;
-	case 24:		/*  RGB  888 */
-		color = pPix[0] | (pPix[1] << 8) | (pPix[2] << 16);
-		break;
-	case 32:		/* ARGB 8888 */
-		color =
-			pPix[0] | (pPix[1] << 8) | (pPix[2] << 16) | (pPix[3] <<
-								      24);
-		break;
-	}
-	return color;
+	_update_surface();
+	return lcd_raster_get_pixel(&surface, x, y);
 }
 
 /**
@@ -654,24 +681,94 @@ void lcdd_get_string_size(const char *p_string, uint32_t * p_width, uint32_t * p
 void lcdd_draw_image(uint32_t dwX, uint32_t dwY, const uint8_t * pImage,
 		     uint32_t width, uint32_t height)
 {
-	struct _lcdd_layer *pDisp = lcdd_get_canvas();
-	uint16_t cw = pDisp->bpp / 8;	/* color width */
-	uint32_t rw = pDisp->width * cw;	/* Row width in bytes */
-	uint32_t rws = width * cw;	/* Source Row Width */
-	uint32_t rl = (rw & 0x3) ? ((rw | 0x3) + 1) : rw;	/* Aligned length */
-	uint32_t rls = (rws & 0x3) ? ((rws | 0x3) + 1) : rws;	/* Aligned length */
-	uint8_t *pSrc, *pDst;
-	uint32_t i;
-
-	pSrc = (uint8_t *) pImage;
-	pDst = pDisp->buffer;
-	pDst = &pDst[dwX * cw + dwY * rl];
-
-	for (i = 0; i < height; i++) {
-		memcpy(pDst, pSrc, rws);
-		pSrc = &pSrc[rls];
-		pDst = &pDst[rl];
-	}
+	_update_surface();
+	lcd_raster_blit(&surface, dwX, dwY, pImage,
+			lcd_raster_stride(width, surface.bpp), width, height);
+}
+
+/**
+ * \brief Copy a rectangle of the canvas to another position.
+ *
+ * Source and destination may overlap, e.g. when scrolling.
+ *
+ * \param src_x   X-coordinate of the source rectangle.
+ * \param src_y   Y-coordinate of the source rectangle.
+ * \param dst_x   X-coordinate of the destination rectangle.
+ * \param dst_y   Y-coordinate of the destination rectangle.
+ * \param width   Rectangle width.
+ * \param height  Rectangle height.
+ */
+void lcdd_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x,
+		    uint32_t dst_y, uint32_t width, uint32_t height)
+{
+	_hide_canvas();
+	lcd_raster_copy_rect(&surface, dst_x, dst_y, src_x, src_y,
+			width, height);
+	_show_canvas();
+}
+
+/**
+ * \brief Blend an ARGB 8888 image over the canvas.
+ *
+ * \param x       X-coordinate of image start.
+ * \param y       Y-coordinate of image start.
+ * \param image   Image pixels, rows are not padded.
+ * \param width   Image width.
+ * \param height  Image height.
+ * \param alpha   Global opacity applied on top of the image alpha (255 is
+ *                opaque).
+ */
+void lcdd_draw_image_alpha(uint32_t x, uint32_t y, const uint32_t *image,
+			   uint32_t width, uint32_t height, uint8_t alpha)
+{
+	_hide_canvas();
+	lcd_raster_blend(&surface, x, y, image, width * sizeof(uint32_t),
+			width, height, alpha);
+	_show_canvas();
+}
+
+/**
+ * \brief Draw a run-length encoded image, see lcd_raster_draw_rle() for
+ * the stream format. Pixels are in the canvas format.
+ *
+ * \param x       X-coordinate of image start.
+ * \param y       Y-coordinate of image start.
+ * \param data    Encoded stream.
+ * \param size    Size of the encoded stream in bytes.
+ * \param width   Image width.
+ * \param height  Image height.
+ * \return true if the stream matched the image size.
+ */
+bool lcdd_draw_image_rle(uint32_t x, uint32_t y, const uint8_t *data,
+			 uint32_t size, uint32_t width, uint32_t height)
+{
+	bool ok;
+
+	_hide_canvas();
+	ok = lcd_raster_draw_rle(&surface, x, y, data, size, width, height);
+	_show_canvas();
+	return ok;
+}
+
+/**
+ * \brief Draw an indexed image through a palette.
+ *
+ * \param x          X-coordinate of image start.
+ * \param y          Y-coordinate of image start.
+ * \param index      Packed indexes, rows padded to a byte boundary.
+ * \param index_bpp  Bits per index (1, 2, 4 or 8).
+ * \param palette    Colors in the canvas format.
+ * \param width      Image width.
+ * \param height     Image height.
+ */
+void lcdd_draw_image_palette(uint32_t x, uint32_t y, const uint8_t *index,
+			     uint8_t index_bpp, const uint32_t *palette,
+			     uint32_t width, uint32_t height)
+{
+	_hide_canvas();
+	lcd_raster_draw_palette(&surface, x, y, index, index_bpp,
+			(width * index_bpp + 7) / 8, palette, width, height);
+	_show_canvas();
 }
 
 /**
@@ -715,8 +812,10 @@ void lcdd_draw_fast_hline (uint32_t x, uint32_t y, uint32_t w, uint32_t color)
  */
 static void _lcdd_fill_rectangle (uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
 {
-	uint32_t i;
-	for (i=x; i<x+w; i++) lcdd_draw_fast_vline(i, y, h, color);
+	if (w == 0 || h == 0)
+		return;
+	_set_front_color(color);
+	_fill_rect(x, y, x + w - 1, y + h - 1);
 }
 /**
  * Draw a circle
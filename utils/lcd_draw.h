@@ -45,6 +45,9 @@
  *   - lcdd_draw_rectangle(), lcdd_draw_filled_rectangle()
  *   - lcdd_draw_circle(), lcdd_draw_filled_circle()
  *   - lcdd_draw_image()
+ *   - lcdd_copy_rect()
+ *   - lcdd_draw_image_alpha(), lcdd_draw_image_rle(),
+ *     lcdd_draw_image_palette()
  * - String related:
  *   - lcdd_draw_string()
  *   - lcdd_get_string_size()
@@ -62,6 +65,7 @@
  *        Headers
  *----------------------------------------------------------------------------*/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*----------------------------------------------------------------------------
@@ -108,6 +112,19 @@ extern void lcdd_get_string_size(const char *pString, uint32_t * pWidth,
 extern void lcdd_draw_image(uint32_t x, uint32_t y, const uint8_t * pImage,
 			   uint32_t width, uint32_t height);
 
+extern void lcdd_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x,
+			   uint32_t dst_y, uint32_t width, uint32_t height);
+
+extern void lcdd_draw_image_alpha(uint32_t x, uint32_t y, const uint32_t *image,
+				  uint32_t width, uint32_t height, uint8_t alpha);
+
+extern bool lcdd_draw_image_rle(uint32_t x, uint32_t y, const uint8_t *data,
+				uint32_t size, uint32_t width, uint32_t height);
+
+extern void lcdd_draw_image_palette(uint32_t x, uint32_t y, const uint8_t *index,
+				    uint8_t index_bpp, const uint32_t *palette,
+				    uint32_t width, uint32_t height);
+
 extern void lcdd_clear_window(uint32_t dwX, uint32_t dwY, uint32_t dwWidth,
 								uint32_t dwHeight, uint32_t dwColor);
 
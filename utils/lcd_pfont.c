@@ -0,0 +1,395 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Implementation of proportional, anti-aliased font drawing on LCD.
+ *
+ * Glyphs are rasterized once into a small cache (a direct-mapped entry
+ * table and a linear pixel pool). When the pool is full the whole cache is
+ * dropped by bumping its generation number, which keeps the allocator
+ * trivial and the lookup constant-time.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "compiler.h"
+
+#include "video/lcdd.h"
+
+#include "lcd_pfont.h"
+#include "lcd_raster.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+/** Glyph cache entry */
+struct _glyph_entry {
+	const struct _lcdd_pfont *font;
+	uint32_t color;
+	uint32_t bg_color;
+	uint16_t code;
+	uint16_t generation;
+	uint8_t bpp;        /* canvas bits per pixel */
+	bool opaque;        /* cell with background, or ARGB 8888 glyph */
+	uint16_t width;
+	uint16_t height;
+	uint32_t stride;
+	uint32_t offset;    /* in the pixel pool */
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Font used by the drawing functions */
+static const struct _lcdd_pfont *font_sel;
+
+/** Glyph cache entries */
+static struct _glyph_entry cache[LCDD_PFONT_CACHE_ENTRIES];
+
+/** Glyph cache pixel pool */
+ALIGNED(4) static uint8_t pool[LCDD_PFONT_CACHE_SIZE];
+
+/** Used bytes in the pixel pool */
+static uint32_t pool_used;
+
+/** Current cache generation, entries of older generations are stale */
+static uint16_t generation = 1;
+
+/** Coverage to color table, used while rasterizing a glyph */
+static uint32_t palette[256];
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static const struct _lcdd_pfont_glyph *_find_glyph(
+		const struct _lcdd_pfont *font, uint8_t code)
+{
+	const struct _lcdd_pfont_header *header = font->header;
+
+	if (code < header->first || code - header->first >= header->count)
+		return NULL;
+	return &font->glyphs[code - header->first];
+}
+
+/**
+ * \brief Rasterize a glyph into the pixel pool.
+ * \return true on success, false if the glyph cannot fit in the pool.
+ */
+static bool _render_glyph(struct _glyph_entry *entry,
+		const struct _lcdd_pfont_glyph *glyph)
+{
+	const struct _lcdd_pfont_header *header = entry->font->header;
+	uint32_t max = (1 << header->bpp) - 1;
+	uint32_t argb = lcd_raster_to_argb(entry->color, entry->bpp) & 0xFFFFFF;
+	uint8_t fmt = entry->opaque ? entry->bpp : 32;
+	const uint32_t src_stride = (glyph->width * header->bpp + 7) / 8;
+	const uint8_t *src = &entry->font->data[glyph->offset];
+	uint32_t gx = 0, gy = 0, sx = 0, sy = 0;
+	struct _lcd_surface cell;
+	uint32_t size, i;
+
+	if (entry->opaque) {
+		entry->width = glyph->advance;
+		entry->height = header->height;
+		/* A negative bearing overhangs the previous cell: drop the
+		 * overhanging columns / rows rather than shifting the glyph */
+		if (glyph->left > 0)
+			gx = glyph->left;
+		else
+			sx = -glyph->left;
+		if (glyph->top > 0)
+			gy = glyph->top;
+		else
+			sy = -glyph->top;
+	} else {
+		entry->width = glyph->width;
+		entry->height = glyph->height;
+	}
+	entry->stride = lcd_raster_stride(entry->width, fmt);
+	size = entry->stride * entry->height;
+
+	if (size > sizeof(pool) - pool_used) {
+		lcdd_pfont_flush_cache();
+		if (size > sizeof(pool))
+			return false;
+	}
+	entry->offset = pool_used;
+	entry->generation = generation;
+	pool_used += size;
+
+	for (i = 0; i <= max; i++) {
+		uint8_t alpha = i * 255 / max;
+		if (entry->opaque)
+			palette[i] = lcd_raster_mix(entry->color,
+					entry->bg_color, entry->bpp, alpha);
+		else
+			palette[i] = ((uint32_t)alpha << 24) | argb;
+	}
+
+	lcd_raster_init_surface(&cell, &pool[entry->offset], entry->width,
+			entry->height, fmt);
+	if (entry->opaque)
+		lcd_raster_fill_rect(&cell, 0, 0, cell.width, cell.height,
+				entry->bg_color);
+	if (glyph->width > sx && glyph->height > sy)
+		lcd_raster_draw_palette_part(&cell, gx, gy,
+				src + sy * src_stride, header->bpp, src_stride,
+				sx, palette, glyph->width - sx,
+				glyph->height - sy);
+	return true;
+}
+
+/**
+ * \brief Return the cache entry of a glyph, rasterizing it if needed.
+ */
+static const struct _glyph_entry *_get_entry(uint8_t code,
+		const struct _lcdd_pfont_glyph *glyph, uint8_t bpp,
+		uint32_t color, uint32_t bg_color, bool opaque)
+{
+	uint32_t hash = code ^ (color >> 3) ^ (bg_color << 1) ^ opaque
+		^ ((uintptr_t)font_sel >> 4);
+	struct _glyph_entry *entry = &cache[hash & (LCDD_PFONT_CACHE_ENTRIES - 1)];
+
+	if (entry->generation == generation && entry->font == font_sel
+	    && entry->code == code && entry->bpp == bpp
+	    && entry->opaque == opaque && entry->color == color
+	    && (!opaque || entry->bg_color == bg_color))
+		return entry;
+
+	entry->font = font_sel;
+	entry->code = code;
+	entry->bpp = bpp;
+	entry->opaque = opaque;
+	entry->color = color;
+	entry->bg_color = bg_color;
+	if (!_render_glyph(entry, glyph)) {
+		entry->generation = 0;
+		return NULL;
+	}
+	return entry;
+}
+
+/**
+ * \brief Draw a string in one pass, one cached glyph at a time.
+ */
+static void _draw_string(uint32_t x, uint32_t y, const char *str,
+		uint32_t color, uint32_t bg_color, bool opaque)
+{
+	struct _lcdd_layer *canvas = lcdd_get_canvas();
+	const struct _lcdd_pfont_glyph *glyph;
+	const struct _glyph_entry *entry;
+	struct _lcd_surface surface;
+	uint32_t xorg = x;
+
+	if (font_sel == NULL || canvas->buffer == NULL)
+		return;
+	lcd_raster_init_surface(&surface, canvas->buffer, canvas->width,
+			canvas->height, canvas->bpp);
+
+	for (; *str; str++) {
+		if (*str == '\n') {
+			x = xorg;
+			y += font_sel->header->height;
+			continue;
+		}
+
+		glyph = _find_glyph(font_sel, *str);
+		if (glyph == NULL)
+			continue;
+
+		if (opaque || glyph->width) {
+			entry = _get_entry(*str, glyph, surface.bpp, color,
+					bg_color, opaque);
+			if (entry == NULL) {
+				/* Glyph larger than the cache, skip it */
+			} else if (opaque) {
+				lcd_raster_blit(&surface, x, y, &pool[entry->offset],
+						entry->stride, entry->width,
+						entry->height);
+			} else {
+				int32_t gx = (int32_t)x + glyph->left;
+				int32_t gy = (int32_t)y + glyph->top;
+				const uint8_t *src = &pool[entry->offset];
+				uint32_t w = entry->width;
+				uint32_t h = entry->height;
+
+				/* Clip the bearing overhang at the left and
+				 * top edges of the canvas */
+				if (gx < 0 && (uint32_t)-gx < w) {
+					src += -gx * sizeof(uint32_t);
+					w += gx;
+					gx = 0;
+				}
+				if (gy < 0 && (uint32_t)-gy < h) {
+					src += -gy * entry->stride;
+					h += gy;
+					gy = 0;
+				}
+				if (gx >= 0 && gy >= 0)
+					lcd_raster_blend(&surface, gx, gy,
+							(const uint32_t*)src,
+							entry->stride, w, h, 255);
+			}
+		}
+		x += glyph->advance;
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Check a font blob and set up a font from it. The blob is used in
+ * place and shall stay mapped as long as the font is used.
+ *
+ * \param font  Font to set up.
+ * \param data  Font blob, in RAM, flash or memory-mapped QSPI flash.
+ * \return true if the blob is a valid font.
+ */
+bool lcdd_pfont_load(struct _lcdd_pfont *font, const void *data)
+{
+	const struct _lcdd_pfont_header *header = data;
+
+	if (((uintptr_t)data & 0x3) != 0)
+		return false;
+	if (header->magic != LCDD_PFONT_MAGIC
+	    || header->version != LCDD_PFONT_VERSION)
+		return false;
+	if (header->bpp != 1 && header->bpp != 2 && header->bpp != 4
+	    && header->bpp != 8)
+		return false;
+	if (header->height == 0 || header->count == 0)
+		return false;
+
+	font->header = header;
+	font->glyphs = (const struct _lcdd_pfont_glyph *)&header[1];
+	font->data = data;
+	return true;
+}
+
+/**
+ * \brief Select the font used by the proportional font drawing functions.
+ */
+void lcdd_pfont_select(const struct _lcdd_pfont *font)
+{
+	font_sel = font;
+}
+
+/**
+ * \brief Drop all the rasterized glyphs, e.g. after the memory holding a
+ * font blob has been reused.
+ */
+void lcdd_pfont_flush_cache(void)
+{
+	generation++;
+	if (generation == 0) {
+		memset(cache, 0, sizeof(cache));
+		generation = 1;
+	}
+	pool_used = 0;
+}
+
+/**
+ * \brief Returns the width & height in pixels that a string will occupy on
+ * the screen if drawn using lcdd_pfont_draw_string. Line breaks are
+ * honored, the width being the one of the longest line.
+ *
+ * \param str     String.
+ * \param width   Pointer for storing the string width (optional).
+ * \param height  Pointer for storing the string height (optional).
+ */
+void lcdd_pfont_get_string_size(const char *str, uint32_t *width,
+				uint32_t *height)
+{
+	const struct _lcdd_pfont_glyph *glyph;
+	uint32_t line = 0, w = 0, h = 0;
+
+	if (font_sel != NULL) {
+		h = font_sel->header->height;
+		for (; *str; str++) {
+			if (*str == '\n') {
+				h += font_sel->header->height;
+				line = 0;
+				continue;
+			}
+			glyph = _find_glyph(font_sel, *str);
+			if (glyph == NULL)
+				continue;
+			line += glyph->advance;
+			if (line > w)
+				w = line;
+		}
+	}
+
+	if (width != NULL)
+		*width = w;
+	if (height != NULL)
+		*height = h;
+}
+
+/**
+ * \brief Draws a string with the selected proportional font, blended over
+ * the canvas. Line breaks will be honored.
+ *
+ * \param x      X-coordinate of string top-left corner.
+ * \param y      Y-coordinate of string top-left corner.
+ * \param str    String to display.
+ * \param color  String color.
+ */
+void lcdd_pfont_draw_string(uint32_t x, uint32_t y, const char *str,
+			    uint32_t color)
+{
+	_draw_string(x, y, str, color, 0, false);
+}
+
+/**
+ * \brief Draws a string with the selected proportional font and given
+ * background color. Line breaks will be honored.
+ *
+ * \param x         X-coordinate of string top-left corner.
+ * \param y         Y-coordinate of string top-left corner.
+ * \param str       String to display.
+ * \param color     String color.
+ * \param bg_color  Background color.
+ */
+void lcdd_pfont_draw_string_with_bgcolor(uint32_t x, uint32_t y,
+					 const char *str, uint32_t color,
+					 uint32_t bg_color)
+{
+	_draw_string(x, y, str, color, bg_color, true);
+}
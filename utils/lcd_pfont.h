@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Interface for drawing proportional, anti-aliased fonts on LCD.
+ *
+ */
+
+/**
+ * \addtogroup lcdd_pfont LCD Proportional Font Drawing
+ *
+ * \section Purpose
+ *
+ * Proportional fonts are stored as a single read-only blob, usually linked
+ * in flash or placed in memory-mapped QSPI flash, and used in place
+ * without copy. Each glyph has its own size, bearing and advance, and
+ * pixels are stored as coverage values of 1, 2, 4 or 8 bits, 4 bits
+ * giving 16 levels of anti-aliasing.
+ *
+ * Glyphs are rasterized on first use into a cache, already converted to
+ * the canvas pixel format, and strings are then drawn with one blit per
+ * glyph:
+ * - with a background color, each cached glyph is an opaque cell of
+ *   advance x line height pixels, the edges being pre-blended between the
+ *   text and background colors;
+ * - without background color, each cached glyph is an ARGB 8888 image
+ *   blended over the canvas.
+ *
+ * \section Format
+ *
+ * The blob starts with a struct _lcdd_pfont_header, directly followed by
+ * \a count struct _lcdd_pfont_glyph entries for the consecutive character
+ * codes starting at \a first. Glyph bitmaps are referenced by their
+ * offset from the start of the blob. Rows are packed with the leftmost
+ * pixel in the most significant bits and padded to a byte boundary. All
+ * fields are little-endian and the blob shall be 4-byte aligned.
+ *
+ * Blobs are generated from TrueType/OpenType fonts by scripts/pfont_gen.py,
+ * either as C arrays (e.g. lcdd_pfont_sans_16) or as raw binaries.
+ *
+ * \section Usage
+ *
+ * -# Load a font blob with lcdd_pfont_load().
+ * -# Select or create canvas via lcdd_select_canvas() or
+ *    lcdd_create_canvas().
+ * -# Draw text with lcdd_pfont_draw_string() or
+ *    lcdd_pfont_draw_string_with_bgcolor().
+ *
+ * \sa \ref lcdd_font, \ref lcdd_draw.
+ */
+
+#ifndef _LCD_PFONT_
+#define _LCD_PFONT_
+/** \addtogroup lcdd_pfont
+ *@{
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Font blob magic, "PFNT" */
+#define LCDD_PFONT_MAGIC 0x544E4650
+
+/** Font blob format version */
+#define LCDD_PFONT_VERSION 1
+
+/** Size of the glyph cache pixel pool in bytes */
+#ifndef LCDD_PFONT_CACHE_SIZE
+#define LCDD_PFONT_CACHE_SIZE (16 * 1024)
+#endif
+
+/** Number of glyph cache entries (power of 2) */
+#ifndef LCDD_PFONT_CACHE_ENTRIES
+#define LCDD_PFONT_CACHE_ENTRIES 128
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** \brief Font blob header */
+struct _lcdd_pfont_header {
+	uint32_t magic;    /* LCDD_PFONT_MAGIC */
+	uint8_t version;   /* LCDD_PFONT_VERSION */
+	uint8_t bpp;       /* Bits per coverage value (1, 2, 4 or 8) */
+	uint8_t height;    /* Line height in pixels */
+	uint8_t baseline;  /* Distance from the top of line to the baseline */
+	uint16_t first;    /* First character code */
+	uint16_t count;    /* Number of glyphs */
+	uint32_t reserved;
+};
+
+/** \brief Font blob glyph descriptor */
+struct _lcdd_pfont_glyph {
+	uint32_t offset;   /* Bitmap offset from the start of the blob */
+	uint8_t width;     /* Bitmap width in pixels, 0 for blank glyphs */
+	uint8_t height;    /* Bitmap height in pixels */
+	int8_t left;       /* Bitmap offset from the pen position */
+	int8_t top;        /* Bitmap offset from the top of line */
+	uint8_t advance;   /* Pen displacement, including spacing */
+	uint8_t reserved[3];
+};
+
+/** \brief Loaded proportional font */
+struct _lcdd_pfont {
+	const struct _lcdd_pfont_header *header;
+	const struct _lcdd_pfont_glyph *glyphs;
+	const uint8_t *data;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported variables
+ *----------------------------------------------------------------------------*/
+
+/** Sample 16px 4 bpp sans-serif font (see scripts/pfont_gen.py) */
+extern const uint8_t lcdd_pfont_sans_16[];
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+/** \addtogroup lcdd_pfont_func Proportional Font Functions */
+/** @{*/
+
+extern bool lcdd_pfont_load(struct _lcdd_pfont *font, const void *data);
+
+extern void lcdd_pfont_select(const struct _lcdd_pfont *font);
+
+extern void lcdd_pfont_flush_cache(void);
+
+extern void lcdd_pfont_get_string_size(const char *str, uint32_t *width,
+				       uint32_t *height);
+
+extern void lcdd_pfont_draw_string(uint32_t x, uint32_t y, const char *str,
+				   uint32_t color);
+
+extern void lcdd_pfont_draw_string_with_bgcolor(uint32_t x, uint32_t y,
+						const char *str,
+						uint32_t color,
+						uint32_t bg_color);
+/** @}*/
+/**@}*/
+#endif /* _LCD_PFONT_ */
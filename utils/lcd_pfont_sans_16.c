@@ -0,0 +1,529 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Aileron Regular, 16px (line height 20), 4 bpp, characters 0x20-0x7E.
+ *
+ * Generated by scripts/pfont_gen.py, do not edit.
+ */
+
+#include "compiler.h"
+
+#include <stdint.h>
+
+ALIGNED(4) const uint8_t lcdd_pfont_sans_16[5844] = {
+	0x50, 0x46, 0x4E, 0x54, 0x01, 0x04, 0x14, 0x10, 0x20, 0x00, 0x5F, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x03, 0x00, 0x00, 0x00, 0x84, 0x04, 0x00, 0x00, 0x04, 0x0B, 0x00, 0x05,
+	0x04, 0x00, 0x00, 0x00, 0x9A, 0x04, 0x00, 0x00, 0x05, 0x0C, 0x00, 0x04,
+	0x05, 0x00, 0x00, 0x00, 0xBE, 0x04, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xF5, 0x04, 0x00, 0x00, 0x09, 0x0F, 0x00, 0x03,
+	0x09, 0x00, 0x00, 0x00, 0x40, 0x05, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0x82, 0x05, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0xC4, 0x05, 0x00, 0x00, 0x03, 0x0C, 0x00, 0x04,
+	0x03, 0x00, 0x00, 0x00, 0xDC, 0x05, 0x00, 0x00, 0x06, 0x0E, 0x00, 0x03,
+	0x06, 0x00, 0x00, 0x00, 0x06, 0x06, 0x00, 0x00, 0x05, 0x0E, 0x00, 0x03,
+	0x05, 0x00, 0x00, 0x00, 0x30, 0x06, 0x00, 0x00, 0x09, 0x08, 0x00, 0x08,
+	0x09, 0x00, 0x00, 0x00, 0x58, 0x06, 0x00, 0x00, 0x0A, 0x09, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0x85, 0x06, 0x00, 0x00, 0x05, 0x04, 0xFF, 0x0E,
+	0x04, 0x00, 0x00, 0x00, 0x91, 0x06, 0x00, 0x00, 0x04, 0x05, 0x00, 0x0B,
+	0x04, 0x00, 0x00, 0x00, 0x9B, 0x06, 0x00, 0x00, 0x03, 0x03, 0x00, 0x0D,
+	0x03, 0x00, 0x00, 0x00, 0xA1, 0x06, 0x00, 0x00, 0x06, 0x0D, 0xFF, 0x04,
+	0x05, 0x00, 0x00, 0x00, 0xC8, 0x06, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xFF, 0x06, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x36, 0x07, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x6D, 0x07, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xA4, 0x07, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xDB, 0x07, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x12, 0x08, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x49, 0x08, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x80, 0x08, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xB7, 0x08, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xEE, 0x08, 0x00, 0x00, 0x03, 0x09, 0x00, 0x07,
+	0x03, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x04, 0x0B, 0xFF, 0x07,
+	0x03, 0x00, 0x00, 0x00, 0x16, 0x09, 0x00, 0x00, 0x0A, 0x09, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0x43, 0x09, 0x00, 0x00, 0x09, 0x07, 0x00, 0x09,
+	0x09, 0x00, 0x00, 0x00, 0x66, 0x09, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0x93, 0x09, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xCA, 0x09, 0x00, 0x00, 0x0E, 0x0E, 0x00, 0x05,
+	0x0E, 0x00, 0x00, 0x00, 0x2C, 0x0A, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x6E, 0x0A, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0xB0, 0x0A, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0xF2, 0x0A, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0x34, 0x0B, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x6B, 0x0B, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0xA2, 0x0B, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0xE4, 0x0B, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0x26, 0x0C, 0x00, 0x00, 0x05, 0x0B, 0x00, 0x05,
+	0x05, 0x00, 0x00, 0x00, 0x47, 0x0C, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x7E, 0x0C, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0xC0, 0x0C, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0xF7, 0x0C, 0x00, 0x00, 0x0E, 0x0B, 0x00, 0x05,
+	0x0E, 0x00, 0x00, 0x00, 0x44, 0x0D, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0x86, 0x0D, 0x00, 0x00, 0x0C, 0x0B, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0xC8, 0x0D, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0x0A, 0x0E, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x05,
+	0x0C, 0x00, 0x00, 0x00, 0x52, 0x0E, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0x94, 0x0E, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0xCB, 0x0E, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x02, 0x0F, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0B, 0x00, 0x00, 0x00, 0x44, 0x0F, 0x00, 0x00, 0x0B, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x86, 0x0F, 0x00, 0x00, 0x10, 0x0B, 0x00, 0x05,
+	0x0F, 0x00, 0x00, 0x00, 0xDE, 0x0F, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x15, 0x10, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x4C, 0x10, 0x00, 0x00, 0x0A, 0x0B, 0x00, 0x05,
+	0x0A, 0x00, 0x00, 0x00, 0x83, 0x10, 0x00, 0x00, 0x06, 0x0F, 0x00, 0x03,
+	0x06, 0x00, 0x00, 0x00, 0xB0, 0x10, 0x00, 0x00, 0x06, 0x0D, 0xFF, 0x04,
+	0x05, 0x00, 0x00, 0x00, 0xD7, 0x10, 0x00, 0x00, 0x05, 0x0F, 0x00, 0x03,
+	0x05, 0x00, 0x00, 0x00, 0x04, 0x11, 0x00, 0x00, 0x09, 0x0B, 0x00, 0x05,
+	0x09, 0x00, 0x00, 0x00, 0x3B, 0x11, 0x00, 0x00, 0x08, 0x02, 0x00, 0x10,
+	0x08, 0x00, 0x00, 0x00, 0x43, 0x11, 0x00, 0x00, 0x05, 0x0C, 0x00, 0x04,
+	0x05, 0x00, 0x00, 0x00, 0x67, 0x11, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0x94, 0x11, 0x00, 0x00, 0x0A, 0x0C, 0x00, 0x04,
+	0x0A, 0x00, 0x00, 0x00, 0xD0, 0x11, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0xFD, 0x11, 0x00, 0x00, 0x0A, 0x0C, 0x00, 0x04,
+	0x0A, 0x00, 0x00, 0x00, 0x39, 0x12, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0x66, 0x12, 0x00, 0x00, 0x06, 0x0D, 0x00, 0x03,
+	0x06, 0x00, 0x00, 0x00, 0x8D, 0x12, 0x00, 0x00, 0x0A, 0x0C, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0xC9, 0x12, 0x00, 0x00, 0x09, 0x0C, 0x00, 0x04,
+	0x09, 0x00, 0x00, 0x00, 0x05, 0x13, 0x00, 0x00, 0x04, 0x0C, 0x00, 0x04,
+	0x04, 0x00, 0x00, 0x00, 0x1D, 0x13, 0x00, 0x00, 0x04, 0x0F, 0x00, 0x04,
+	0x04, 0x00, 0x00, 0x00, 0x3B, 0x13, 0x00, 0x00, 0x09, 0x0C, 0x00, 0x04,
+	0x08, 0x00, 0x00, 0x00, 0x77, 0x13, 0x00, 0x00, 0x04, 0x0C, 0x00, 0x04,
+	0x04, 0x00, 0x00, 0x00, 0x8F, 0x13, 0x00, 0x00, 0x0E, 0x09, 0x00, 0x07,
+	0x0E, 0x00, 0x00, 0x00, 0xCE, 0x13, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0xFB, 0x13, 0x00, 0x00, 0x0A, 0x09, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0x28, 0x14, 0x00, 0x00, 0x0A, 0x0C, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0x64, 0x14, 0x00, 0x00, 0x0A, 0x0C, 0x00, 0x07,
+	0x0A, 0x00, 0x00, 0x00, 0xA0, 0x14, 0x00, 0x00, 0x06, 0x09, 0x00, 0x07,
+	0x05, 0x00, 0x00, 0x00, 0xBB, 0x14, 0x00, 0x00, 0x08, 0x09, 0x00, 0x07,
+	0x08, 0x00, 0x00, 0x00, 0xDF, 0x14, 0x00, 0x00, 0x06, 0x0B, 0x00, 0x05,
+	0x06, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x09, 0x00, 0x00, 0x00, 0x2D, 0x15, 0x00, 0x00, 0x09, 0x09, 0x00, 0x07,
+	0x08, 0x00, 0x00, 0x00, 0x5A, 0x15, 0x00, 0x00, 0x0D, 0x09, 0x00, 0x07,
+	0x0D, 0x00, 0x00, 0x00, 0x99, 0x15, 0x00, 0x00, 0x09, 0x09, 0xFF, 0x07,
+	0x08, 0x00, 0x00, 0x00, 0xC6, 0x15, 0x00, 0x00, 0x09, 0x0C, 0x00, 0x07,
+	0x08, 0x00, 0x00, 0x00, 0x02, 0x16, 0x00, 0x00, 0x08, 0x09, 0x00, 0x07,
+	0x08, 0x00, 0x00, 0x00, 0x26, 0x16, 0x00, 0x00, 0x05, 0x0F, 0x00, 0x03,
+	0x05, 0x00, 0x00, 0x00, 0x53, 0x16, 0x00, 0x00, 0x05, 0x11, 0x00, 0x02,
+	0x05, 0x00, 0x00, 0x00, 0x86, 0x16, 0x00, 0x00, 0x06, 0x0F, 0x00, 0x03,
+	0x06, 0x00, 0x00, 0x00, 0xB3, 0x16, 0x00, 0x00, 0x09, 0x06, 0x00, 0x0A,
+	0x09, 0x00, 0x00, 0x00, 0x08, 0xF0, 0x08, 0xF0, 0x08, 0xF0, 0x08, 0xF0,
+	0x08, 0xF0, 0x08, 0xF0, 0x08, 0xF0, 0x08, 0xF0, 0x01, 0x10, 0x0D, 0xD0,
+	0x0C, 0xC0, 0x0F, 0x8F, 0x80, 0x0F, 0x8F, 0x80, 0x0F, 0x8F, 0x80, 0x0F,
+	0x8F, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xE0, 0x95, 0x00, 0x00, 0x03, 0xB0, 0xC1, 0x00,
+	0x00, 0x07, 0x71, 0xD0, 0x00, 0x06, 0xEF, 0xEE, 0xFE, 0x20, 0x00, 0x0D,
+	0x18, 0x60, 0x00, 0x00, 0x2C, 0x0B, 0x30, 0x00, 0x0D, 0xEF, 0xEF, 0xEA,
+	0x00, 0x02, 0x97, 0x4C, 0x21, 0x00, 0x00, 0xB3, 0x59, 0x00, 0x00, 0x00,
+	0xD1, 0x86, 0x00, 0x00, 0x01, 0xC0, 0xB3, 0x00, 0x00, 0x00, 0x08, 0xF0,
+	0x00, 0x00, 0x00, 0x5C, 0xF9, 0x20, 0x00, 0x07, 0xFC, 0xFA, 0xE2, 0x00,
+	0x0D, 0x98, 0xF0, 0xDA, 0x00, 0x0E, 0x88, 0xF0, 0x56, 0x00, 0x0C, 0xC8,
+	0xF0, 0x00, 0x00, 0x04, 0xEF, 0xF8, 0x10, 0x00, 0x00, 0x2B, 0xFE, 0xD2,
+	0x00, 0x00, 0x08, 0xF1, 0xDB, 0x00, 0x38, 0x18, 0xF0, 0x8E, 0x00, 0x5F,
+	0x58, 0xF0, 0x9D, 0x00, 0x1E, 0xDA, 0xF5, 0xE7, 0x00, 0x03, 0xCF, 0xFD,
+	0x70, 0x00, 0x00, 0x08, 0xF0, 0x00, 0x00, 0x00, 0x04, 0x80, 0x00, 0x00,
+	0x04, 0xCF, 0xC4, 0x00, 0x5E, 0x20, 0x0D, 0xB3, 0xBD, 0x01, 0xD7, 0x00,
+	0x0E, 0xA1, 0xAE, 0x09, 0xC0, 0x00, 0x05, 0xEF, 0xE5, 0x3F, 0x30, 0x00,
+	0x00, 0x02, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x07, 0xE1, 0x00, 0x00,
+	0x00, 0x00, 0x2E, 0x58, 0xEE, 0x80, 0x00, 0x00, 0xAB, 0x4F, 0x44, 0xF4,
+	0x00, 0x05, 0xE2, 0x7F, 0x00, 0xF7, 0x00, 0x1D, 0x70, 0x4F, 0x66, 0xF4,
+	0x00, 0x9C, 0x00, 0x08, 0xEE, 0x80, 0x00, 0x3A, 0xEF, 0xE3, 0x00, 0x00,
+	0x03, 0xFA, 0x32, 0x31, 0x00, 0x00, 0x07, 0xF1, 0x00, 0x04, 0x20, 0x00,
+	0x03, 0xF6, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x3D, 0xFE, 0xEF, 0xFE, 0x00,
+	0x02, 0xDA, 0x52, 0x2F, 0x92, 0x00, 0x0B, 0xC0, 0x00, 0x0F, 0x80, 0x00,
+	0x0E, 0x80, 0x00, 0x0F, 0x80, 0x00, 0x0E, 0xA0, 0x00, 0x0F, 0x80, 0x00,
+	0x08, 0xF8, 0x32, 0x3F, 0x80, 0x00, 0x00, 0x6C, 0xEF, 0xEC, 0x50, 0x00,
+	0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x01, 0xD2, 0x00, 0x08, 0xA0, 0x00, 0x1E, 0x40, 0x00, 0x6E, 0x00,
+	0x00, 0xAB, 0x00, 0x00, 0xD9, 0x00, 0x00, 0xE8, 0x00, 0x00, 0xE8, 0x00,
+	0x00, 0xD9, 0x00, 0x00, 0xAB, 0x00, 0x00, 0x6E, 0x00, 0x00, 0x1E, 0x40,
+	0x00, 0x08, 0xA0, 0x00, 0x01, 0xD2, 0x96, 0x00, 0x00, 0x2E, 0x10, 0x00,
+	0x0C, 0x80, 0x00, 0x07, 0xE0, 0x00, 0x04, 0xF3, 0x00, 0x01, 0xF6, 0x00,
+	0x00, 0xF7, 0x00, 0x00, 0xF7, 0x00, 0x01, 0xF6, 0x00, 0x04, 0xF3, 0x00,
+	0x07, 0xE0, 0x00, 0x0C, 0x80, 0x00, 0x2E, 0x10, 0x00, 0x96, 0x00, 0x00,
+	0x00, 0x00, 0xD0, 0x00, 0x00, 0x00, 0x00, 0xD0, 0x00, 0x00, 0x07, 0xA4,
+	0xD4, 0xA7, 0x00, 0x00, 0x39, 0xF9, 0x40, 0x00, 0x00, 0x0B, 0x5B, 0x00,
+	0x00, 0x00, 0x98, 0x08, 0x90, 0x00, 0x00, 0x30, 0x00, 0x30, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8,
+	0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0x0D, 0xEE, 0xFF, 0xEE, 0x60, 0x02, 0x22, 0xF9, 0x22, 0x10, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x0A, 0xD0, 0x00, 0x0E, 0x80, 0x00, 0x4F, 0x20, 0x00, 0x9B, 0x00,
+	0x00, 0x7E, 0xED, 0x12, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x0D, 0x50, 0x0C, 0x50, 0x00, 0x00, 0x3B, 0x00, 0x00, 0x87, 0x00,
+	0x00, 0xD2, 0x00, 0x03, 0xC0, 0x00, 0x08, 0x70, 0x00, 0x0C, 0x20, 0x00,
+	0x2C, 0x00, 0x00, 0x78, 0x00, 0x00, 0xC3, 0x00, 0x02, 0xD0, 0x00, 0x07,
+	0x80, 0x00, 0x0B, 0x30, 0x00, 0x07, 0x00, 0x00, 0x00, 0x3B, 0xEE, 0xB3,
+	0x00, 0x02, 0xEB, 0x33, 0xBE, 0x20, 0x08, 0xE1, 0x00, 0x1E, 0x80, 0x0C,
+	0xA0, 0x00, 0x0A, 0xC0, 0x0E, 0x80, 0x00, 0x08, 0xE0, 0x0F, 0x80, 0x00,
+	0x08, 0xF0, 0x0E, 0x80, 0x00, 0x08, 0xE0, 0x0C, 0xA0, 0x00, 0x0A, 0xC0,
+	0x08, 0xE1, 0x00, 0x1E, 0x80, 0x02, 0xEB, 0x33, 0xBE, 0x20, 0x00, 0x3B,
+	0xEE, 0xB3, 0x00, 0x00, 0x02, 0xAF, 0x80, 0x00, 0x00, 0x8F, 0xBF, 0x80,
+	0x00, 0x00, 0xD5, 0x0F, 0x80, 0x00, 0x00, 0x10, 0x0F, 0x80, 0x00, 0x00,
+	0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F,
+	0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00,
+	0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x2A,
+	0xEE, 0xB3, 0x00, 0x01, 0xEA, 0x33, 0xBE, 0x20, 0x07, 0xE0, 0x00, 0x2F,
+	0x60, 0x06, 0x70, 0x00, 0x1F, 0x60, 0x00, 0x00, 0x00, 0x7F, 0x20, 0x00,
+	0x00, 0x04, 0xF6, 0x00, 0x00, 0x00, 0x4E, 0x80, 0x00, 0x00, 0x04, 0xE8,
+	0x00, 0x00, 0x00, 0x4E, 0x70, 0x00, 0x00, 0x04, 0xF8, 0x11, 0x11, 0x10,
+	0x0F, 0xFF, 0xFF, 0xFF, 0x80, 0x00, 0x2A, 0xEE, 0xC4, 0x00, 0x01, 0xEA,
+	0x32, 0x8F, 0x30, 0x04, 0xC1, 0x00, 0x1F, 0x70, 0x00, 0x00, 0x01, 0x8F,
+	0x50, 0x00, 0x00, 0x7F, 0xFA, 0x00, 0x00, 0x00, 0x13, 0x76, 0x00, 0x00,
+	0x00, 0x00, 0x0B, 0x80, 0x0B, 0x70, 0x00, 0x08, 0xE0, 0x09, 0xC0, 0x00,
+	0x0B, 0xD0, 0x02, 0xFA, 0x33, 0x9F, 0x60, 0x00, 0x3B, 0xEE, 0xB4, 0x00,
+	0x00, 0x00, 0x01, 0xCF, 0x00, 0x00, 0x00, 0x09, 0xFF, 0x00, 0x00, 0x00,
+	0x5E, 0x9F, 0x00, 0x00, 0x02, 0xE6, 0x8F, 0x00, 0x00, 0x0C, 0xA0, 0x8F,
+	0x00, 0x00, 0x8D, 0x10, 0x8F, 0x00, 0x04, 0xE3, 0x00, 0x8F, 0x00, 0x0E,
+	0xFE, 0xEE, 0xFF, 0xE0, 0x02, 0x22, 0x22, 0x9F, 0x20, 0x00, 0x00, 0x00,
+	0x8F, 0x00, 0x00, 0x00, 0x00, 0x8F, 0x00, 0x04, 0xFF, 0xFF, 0xFF, 0x10,
+	0x06, 0xD1, 0x11, 0x11, 0x00, 0x08, 0xA0, 0x00, 0x00, 0x00, 0x0A, 0x9A,
+	0xED, 0x91, 0x00, 0x0C, 0xE7, 0x35, 0xEB, 0x00, 0x0B, 0x70, 0x00, 0x5F,
+	0x40, 0x00, 0x00, 0x00, 0x1F, 0x60, 0x18, 0x20, 0x00, 0x1F, 0x70, 0x0E,
+	0x80, 0x00, 0x5F, 0x30, 0x08, 0xF6, 0x25, 0xEA, 0x00, 0x00, 0x7D, 0xFD,
+	0x70, 0x00, 0x00, 0x08, 0xDF, 0xD7, 0x00, 0x00, 0xBB, 0x32, 0x6F, 0x70,
+	0x05, 0xE1, 0x00, 0x06, 0x70, 0x0B, 0xA6, 0xDE, 0xB4, 0x00, 0x0D, 0xDA,
+	0x34, 0xAF, 0x40, 0x0F, 0xD0, 0x00, 0x0D, 0xC0, 0x0F, 0x90, 0x00, 0x09,
+	0xF0, 0x0D, 0x80, 0x00, 0x08, 0xE0, 0x0A, 0xD0, 0x00, 0x0D, 0xB0, 0x03,
+	0xFA, 0x33, 0xAE, 0x30, 0x00, 0x3B, 0xEE, 0xB3, 0x00, 0x0F, 0xFF, 0xFF,
+	0xFF, 0xE0, 0x01, 0x11, 0x11, 0x2E, 0x80, 0x00, 0x00, 0x00, 0x7E, 0x10,
+	0x00, 0x00, 0x01, 0xE7, 0x00, 0x00, 0x00, 0x09, 0xD0, 0x00, 0x00, 0x00,
+	0x2F, 0x50, 0x00, 0x00, 0x00, 0xAC, 0x00, 0x00, 0x00, 0x03, 0xF4, 0x00,
+	0x00, 0x00, 0x0C, 0xB0, 0x00, 0x00, 0x00, 0x5F, 0x30, 0x00, 0x00, 0x00,
+	0xD9, 0x00, 0x00, 0x00, 0x00, 0x4C, 0xEE, 0xB3, 0x00, 0x03, 0xF9, 0x22,
+	0x9E, 0x20, 0x07, 0xF1, 0x00, 0x1F, 0x60, 0x03, 0xE7, 0x00, 0x7F, 0x50,
+	0x00, 0x5F, 0xFF, 0xFB, 0x00, 0x04, 0xE8, 0x34, 0xC5, 0x00, 0x0C, 0xB0,
+	0x00, 0x3F, 0x30, 0x0F, 0x80, 0x00, 0x1F, 0x70, 0x0D, 0xB0, 0x00, 0x3F,
+	0x60, 0x07, 0xF7, 0x23, 0xCE, 0x10, 0x00, 0x6C, 0xEE, 0xA2, 0x00, 0x00,
+	0x4B, 0xEE, 0xB3, 0x00, 0x04, 0xF9, 0x33, 0x9F, 0x30, 0x0C, 0xB0, 0x00,
+	0x0B, 0x90, 0x0F, 0x80, 0x00, 0x08, 0xD0, 0x0D, 0xA0, 0x00, 0x0B, 0xF0,
+	0x08, 0xF6, 0x11, 0x7E, 0xF0, 0x00, 0x7E, 0xFF, 0xA9, 0xD0, 0x02, 0x20,
+	0x11, 0x0B, 0xA0, 0x0B, 0xB0, 0x00, 0x1E, 0x50, 0x05, 0xF8, 0x23, 0xCB,
+	0x00, 0x00, 0x5C, 0xFD, 0x80, 0x00, 0x0C, 0x50, 0x0D, 0x50, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x0D, 0x50, 0x0C, 0x50,
+	0x00, 0xC5, 0x00, 0xD5, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x01, 0xF2, 0x05, 0xD0, 0x0A, 0x90, 0x0E, 0x50, 0x00, 0x00,
+	0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x4B, 0x70, 0x00, 0x00, 0x3B, 0xD5,
+	0x00, 0x00, 0x3B, 0xC5, 0x00, 0x00, 0x00, 0xF7, 0x00, 0x00, 0x00, 0x00,
+	0x6D, 0xA2, 0x00, 0x00, 0x00, 0x01, 0x7E, 0xA2, 0x00, 0x00, 0x00, 0x01,
+	0x7E, 0x60, 0x00, 0x00, 0x00, 0x01, 0x30, 0x0A, 0xEE, 0xEE, 0xEE, 0x00,
+	0x01, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0xEE,
+	0xEE, 0xEE, 0x00, 0x01, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x0E,
+	0x81, 0x00, 0x00, 0x00, 0x02, 0xAE, 0x71, 0x00, 0x00, 0x00, 0x02, 0x9E,
+	0x71, 0x00, 0x00, 0x00, 0x02, 0xD7, 0x00, 0x00, 0x00, 0x5D, 0xA2, 0x00,
+	0x00, 0x5D, 0xB3, 0x00, 0x00, 0x0D, 0xB3, 0x00, 0x00, 0x00, 0x04, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x6C, 0xED, 0x81, 0x00, 0x07, 0xF6, 0x25, 0xE9,
+	0x00, 0x0D, 0xA0, 0x00, 0x8E, 0x00, 0x03, 0x20, 0x00, 0xAD, 0x00, 0x00,
+	0x00, 0x03, 0xF5, 0x00, 0x00, 0x00, 0x1D, 0x70, 0x00, 0x00, 0x00, 0xB7,
+	0x00, 0x00, 0x00, 0x02, 0xB0, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
+	0x00, 0x06, 0xD0, 0x00, 0x00, 0x00, 0x05, 0xC0, 0x00, 0x00, 0x00, 0x00,
+	0x18, 0xCE, 0xDA, 0x30, 0x00, 0x00, 0x05, 0xEB, 0x53, 0x4A, 0xF6, 0x00,
+	0x00, 0x5F, 0x60, 0x00, 0x00, 0x8F, 0x30, 0x01, 0xE8, 0x08, 0xDD, 0x69,
+	0x0E, 0xA0, 0x08, 0xE1, 0x9E, 0x55, 0xEB, 0x09, 0xD0, 0x0C, 0xB2, 0xF6,
+	0x00, 0xD8, 0x08, 0xF0, 0x0E, 0x86, 0xF1, 0x00, 0xF5, 0x09, 0xE0, 0x0F,
+	0x87, 0xF0, 0x04, 0xF1, 0x0C, 0xB0, 0x0D, 0x94, 0xF5, 0x2C, 0xF1, 0x7F,
+	0x30, 0x0A, 0xD0, 0x8E, 0xC4, 0xCE, 0xC4, 0x00, 0x04, 0xF7, 0x00, 0x00,
+	0x00, 0x10, 0x00, 0x00, 0x7F, 0x82, 0x01, 0x5C, 0x60, 0x00, 0x00, 0x05,
+	0xCF, 0xFF, 0xB4, 0x00, 0x00, 0x00, 0x00, 0x01, 0x20, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0xBF, 0x70, 0x00, 0x00, 0x00, 0x02, 0xFB, 0xC0, 0x00, 0x00,
+	0x00, 0x07, 0xD3, 0xF2, 0x00, 0x00, 0x00, 0x0C, 0x70, 0xD7, 0x00, 0x00,
+	0x00, 0x3F, 0x20, 0x9D, 0x00, 0x00, 0x00, 0x8C, 0x00, 0x4F, 0x30, 0x00,
+	0x00, 0xDF, 0xFF, 0xFF, 0x80, 0x00, 0x04, 0xF4, 0x33, 0x3A, 0xD0, 0x00,
+	0x09, 0xC0, 0x00, 0x04, 0xF3, 0x00, 0x1E, 0x70, 0x00, 0x00, 0xD9, 0x00,
+	0x5F, 0x20, 0x00, 0x00, 0x8E, 0x00, 0x00, 0xFF, 0xFF, 0xEB, 0x40, 0x00,
+	0x00, 0xF8, 0x11, 0x29, 0xF3, 0x00, 0x00, 0xF8, 0x00, 0x01, 0xF7, 0x00,
+	0x00, 0xF8, 0x00, 0x17, 0xF5, 0x00, 0x00, 0xFF, 0xEE, 0xFF, 0xA0, 0x00,
+	0x00, 0xF9, 0x22, 0x37, 0x80, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xBA, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0x8E, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xAD, 0x00,
+	0x00, 0xF8, 0x11, 0x27, 0xF7, 0x00, 0x00, 0xFF, 0xFF, 0xFC, 0x60, 0x00,
+	0x00, 0x04, 0xBE, 0xEC, 0x71, 0x00, 0x00, 0x7F, 0x83, 0x25, 0xDB, 0x00,
+	0x04, 0xF6, 0x00, 0x00, 0x3F, 0x50, 0x0A, 0xD0, 0x00, 0x00, 0x09, 0x70,
+	0x0E, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x00,
+	0x0E, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x0B, 0xD0, 0x00, 0x00, 0x0A, 0x60,
+	0x05, 0xF6, 0x00, 0x00, 0x4F, 0x40, 0x00, 0x9F, 0x72, 0x26, 0xEA, 0x00,
+	0x00, 0x06, 0xCE, 0xFC, 0x70, 0x00, 0x00, 0xFF, 0xFF, 0xEB, 0x50, 0x00,
+	0x00, 0xF8, 0x12, 0x38, 0xF9, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x5F, 0x50,
+	0x00, 0xF8, 0x00, 0x00, 0x0C, 0xB0, 0x00, 0xF8, 0x00, 0x00, 0x09, 0xE0,
+	0x00, 0xF8, 0x00, 0x00, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0x09, 0xE0,
+	0x00, 0xF8, 0x00, 0x00, 0x0D, 0xA0, 0x00, 0xF8, 0x00, 0x00, 0x6F, 0x40,
+	0x00, 0xF8, 0x11, 0x38, 0xF7, 0x00, 0x00, 0xFF, 0xFF, 0xEB, 0x40, 0x00,
+	0x00, 0xFF, 0xFF, 0xFF, 0xF5, 0x00, 0xF8, 0x11, 0x11, 0x10, 0x00, 0xF8,
+	0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0x00, 0x00, 0xFF, 0xEE, 0xEE, 0xC0, 0x00, 0xF9, 0x22, 0x22, 0x20, 0x00,
+	0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x11,
+	0x11, 0x11, 0x00, 0xFF, 0xFF, 0xFF, 0xF7, 0x00, 0xFF, 0xFF, 0xFF, 0xF5,
+	0x00, 0xF8, 0x11, 0x11, 0x10, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8,
+	0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xEE, 0xEE,
+	0xA0, 0x00, 0xF9, 0x22, 0x22, 0x10, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0x00, 0x00, 0x04, 0xBE, 0xED, 0x81, 0x00, 0x00, 0x7F, 0x72, 0x26,
+	0xEC, 0x10, 0x04, 0xF6, 0x00, 0x00, 0x6F, 0x60, 0x0A, 0xD0, 0x00, 0x00,
+	0x06, 0x40, 0x0E, 0x90, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x9E,
+	0xEE, 0x70, 0x0E, 0xA0, 0x00, 0x12, 0x3F, 0x80, 0x0B, 0xD0, 0x00, 0x00,
+	0x3F, 0x80, 0x05, 0xF6, 0x00, 0x00, 0xAF, 0x80, 0x00, 0xAF, 0x72, 0x29,
+	0xAF, 0x80, 0x00, 0x07, 0xCF, 0xE9, 0x1F, 0x80, 0x00, 0xF8, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0xFF, 0xEE, 0xEE, 0xEF, 0xF0, 0x00, 0xF9, 0x22, 0x22,
+	0x29, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0x00, 0x00, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x8F, 0x00, 0x00, 0x00, 0x00,
+	0x8F, 0x00, 0x00, 0x00, 0x00, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x8F, 0x00,
+	0x00, 0x00, 0x00, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x8F, 0x00, 0x0E, 0x70,
+	0x00, 0x8F, 0x00, 0x0D, 0x90, 0x00, 0xAD, 0x00, 0x08, 0xE5, 0x26, 0xF8,
+	0x00, 0x00, 0x7D, 0xED, 0x70, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x8E, 0x30,
+	0x00, 0xF8, 0x00, 0x07, 0xE3, 0x00, 0x00, 0xF8, 0x00, 0x6F, 0x40, 0x00,
+	0x00, 0xF8, 0x05, 0xF5, 0x00, 0x00, 0x00, 0xF8, 0x4F, 0x60, 0x00, 0x00,
+	0x00, 0xFB, 0xEC, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x9F, 0x80, 0x00, 0x00,
+	0x00, 0xF9, 0x07, 0xF5, 0x00, 0x00, 0x00, 0xF8, 0x00, 0xAF, 0x30, 0x00,
+	0x00, 0xF8, 0x00, 0x1C, 0xE2, 0x00, 0x00, 0xF8, 0x00, 0x02, 0xEC, 0x10,
+	0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8,
+	0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00,
+	0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF9, 0x22,
+	0x22, 0x21, 0x00, 0xFF, 0xFF, 0xFF, 0xF7, 0x00, 0xFF, 0x80, 0x00, 0x00,
+	0x7F, 0xF0, 0x00, 0xFE, 0xD0, 0x00, 0x00, 0xCE, 0xF0, 0x00, 0xFA, 0xF3,
+	0x00, 0x02, 0xF9, 0xF0, 0x00, 0xF8, 0xC7, 0x00, 0x07, 0xC8, 0xF0, 0x00,
+	0xF8, 0x7C, 0x00, 0x0C, 0x78, 0xF0, 0x00, 0xF8, 0x2F, 0x20, 0x1F, 0x28,
+	0xF0, 0x00, 0xF8, 0x0D, 0x70, 0x6C, 0x08, 0xF0, 0x00, 0xF8, 0x08, 0xC0,
+	0xB7, 0x08, 0xF0, 0x00, 0xF8, 0x02, 0xF3, 0xF2, 0x08, 0xF0, 0x00, 0xF8,
+	0x00, 0xDC, 0xC0, 0x08, 0xF0, 0x00, 0xF8, 0x00, 0x7F, 0x70, 0x08, 0xF0,
+	0x00, 0xFF, 0x70, 0x00, 0x0F, 0x80, 0x00, 0xFD, 0xE1, 0x00, 0x0F, 0x80,
+	0x00, 0xF8, 0xD7, 0x00, 0x0F, 0x80, 0x00, 0xF8, 0x6E, 0x10, 0x0F, 0x80,
+	0x00, 0xF8, 0x0E, 0x70, 0x0F, 0x80, 0x00, 0xF8, 0x07, 0xE1, 0x0F, 0x80,
+	0x00, 0xF8, 0x01, 0xE7, 0x0F, 0x80, 0x00, 0xF8, 0x00, 0x7E, 0x0F, 0x80,
+	0x00, 0xF8, 0x00, 0x1E, 0x6F, 0x80, 0x00, 0xF8, 0x00, 0x07, 0xDF, 0x80,
+	0x00, 0xF8, 0x00, 0x01, 0xEF, 0x80, 0x00, 0x05, 0xBE, 0xFD, 0x91, 0x00,
+	0x00, 0x8F, 0x83, 0x24, 0xCD, 0x20, 0x04, 0xF6, 0x00, 0x00, 0x0D, 0xC0,
+	0x0B, 0xD0, 0x00, 0x00, 0x05, 0xF3, 0x0E, 0xA0, 0x00, 0x00, 0x02, 0xF6,
+	0x0F, 0x80, 0x00, 0x00, 0x01, 0xF7, 0x0E, 0xA0, 0x00, 0x00, 0x02, 0xF6,
+	0x0B, 0xD0, 0x00, 0x00, 0x05, 0xF3, 0x04, 0xF6, 0x00, 0x00, 0x0D, 0xC0,
+	0x00, 0x8F, 0x73, 0x24, 0xCE, 0x20, 0x00, 0x05, 0xBE, 0xFD, 0x91, 0x00,
+	0x00, 0xFF, 0xFF, 0xFC, 0x70, 0x00, 0x00, 0xF8, 0x11, 0x26, 0xE8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0x9E, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x8E, 0x00,
+	0x00, 0xF8, 0x00, 0x03, 0xE9, 0x00, 0x00, 0xFF, 0xEE, 0xFE, 0x91, 0x00,
+	0x00, 0xF9, 0x22, 0x20, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0xBE, 0xFD, 0x81, 0x00,
+	0x00, 0x8F, 0x83, 0x24, 0xCD, 0x20, 0x04, 0xF6, 0x00, 0x00, 0x0D, 0xB0,
+	0x0B, 0xD0, 0x00, 0x00, 0x05, 0xF3, 0x0E, 0xA0, 0x00, 0x00, 0x02, 0xF6,
+	0x0F, 0x80, 0x00, 0x00, 0x01, 0xF7, 0x0E, 0xA0, 0x00, 0x00, 0x02, 0xF6,
+	0x0B, 0xD0, 0x00, 0x00, 0x05, 0xF3, 0x04, 0xF6, 0x00, 0x00, 0x0D, 0xB0,
+	0x00, 0x8F, 0x73, 0x24, 0xCD, 0x10, 0x00, 0x05, 0xBE, 0xFF, 0xFF, 0xB2,
+	0x00, 0x00, 0x00, 0x00, 0x03, 0x71, 0x00, 0xFF, 0xFF, 0xFD, 0x81, 0x00,
+	0x00, 0xF8, 0x11, 0x26, 0xE9, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x9E, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0x9E, 0x00, 0x00, 0xF8, 0x00, 0x04, 0xE6, 0x00,
+	0x00, 0xFF, 0xEE, 0xFF, 0x70, 0x00, 0x00, 0xF9, 0x22, 0x3B, 0xE1, 0x00,
+	0x00, 0xF8, 0x00, 0x02, 0xF5, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xE7, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xBA, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x8E, 0x00,
+	0x00, 0x6C, 0xED, 0x91, 0x00, 0x08, 0xE5, 0x24, 0xDB, 0x00, 0x0E, 0x80,
+	0x00, 0x4F, 0x30, 0x0D, 0xB0, 0x00, 0x03, 0x10, 0x06, 0xFC, 0x62, 0x00,
+	0x00, 0x00, 0x39, 0xEF, 0xB3, 0x00, 0x00, 0x00, 0x04, 0xCE, 0x20, 0x24,
+	0x00, 0x00, 0x2F, 0x60, 0x4F, 0x50, 0x00, 0x1F, 0x60, 0x0B, 0xE6, 0x23,
+	0xBE, 0x10, 0x01, 0x8D, 0xED, 0x92, 0x00, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x01, 0x11, 0x1F, 0x81, 0x11, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00,
+	0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80,
+	0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00,
+	0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F,
+	0x80, 0x00, 0x0F, 0x80, 0x00, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00,
+	0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00,
+	0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00,
+	0xF8, 0x00, 0x0F, 0x80, 0x00, 0x00, 0xF7, 0x00, 0x0F, 0x80, 0x00, 0x01,
+	0xF7, 0x00, 0x0C, 0xC0, 0x00, 0x05, 0xF4, 0x00, 0x04, 0xFA, 0x32, 0x6E,
+	0xB0, 0x00, 0x00, 0x4B, 0xEE, 0xD8, 0x10, 0x00, 0x5F, 0x20, 0x00, 0x00,
+	0x8E, 0x00, 0x0E, 0x70, 0x00, 0x00, 0xD9, 0x00, 0x09, 0xC0, 0x00, 0x03,
+	0xF4, 0x00, 0x04, 0xF2, 0x00, 0x08, 0xD0, 0x00, 0x00, 0xE7, 0x00, 0x0D,
+	0x80, 0x00, 0x00, 0x9C, 0x00, 0x3F, 0x20, 0x00, 0x00, 0x4F, 0x20, 0x8C,
+	0x00, 0x00, 0x00, 0x0D, 0x70, 0xD7, 0x00, 0x00, 0x00, 0x08, 0xC3, 0xF1,
+	0x00, 0x00, 0x00, 0x03, 0xFA, 0xB0, 0x00, 0x00, 0x00, 0x00, 0xDF, 0x50,
+	0x00, 0x00, 0x7F, 0x20, 0x00, 0x4F, 0xD0, 0x00, 0x07, 0xE0, 0x3F, 0x50,
+	0x00, 0x8E, 0xF2, 0x00, 0x0B, 0xB0, 0x0E, 0x90, 0x00, 0xC8, 0xE5, 0x00,
+	0x0E, 0x60, 0x0A, 0xC0, 0x01, 0xF3, 0xB9, 0x00, 0x3F, 0x20, 0x06, 0xF1,
+	0x05, 0xE0, 0x7D, 0x00, 0x7D, 0x00, 0x02, 0xF4, 0x09, 0xA0, 0x3F, 0x20,
+	0xB9, 0x00, 0x00, 0xD8, 0x0D, 0x60, 0x0E, 0x60, 0xE5, 0x00, 0x00, 0x9B,
+	0x2F, 0x20, 0x0A, 0xA3, 0xF1, 0x00, 0x00, 0x5F, 0x6D, 0x00, 0x06, 0xD7,
+	0xB0, 0x00, 0x00, 0x1F, 0xD9, 0x00, 0x02, 0xFD, 0x70, 0x00, 0x00, 0x0C,
+	0xF4, 0x00, 0x00, 0xDF, 0x30, 0x00, 0x1E, 0x90, 0x00, 0x02, 0xE7, 0x05,
+	0xF4, 0x00, 0x0C, 0xB0, 0x00, 0xAD, 0x00, 0x7E, 0x20, 0x00, 0x1E, 0x82,
+	0xF5, 0x00, 0x00, 0x04, 0xFD, 0x90, 0x00, 0x00, 0x00, 0xCF, 0x20, 0x00,
+	0x00, 0x06, 0xEC, 0xB0, 0x00, 0x00, 0x2E, 0x52, 0xE7, 0x00, 0x00, 0xCA,
+	0x00, 0x6F, 0x30, 0x08, 0xE1, 0x00, 0x0A, 0xD1, 0x4F, 0x50, 0x00, 0x01,
+	0xE9, 0x9E, 0x10, 0x00, 0x06, 0xF2, 0x1E, 0x80, 0x00, 0x1E, 0x80, 0x07,
+	0xF2, 0x00, 0x9D, 0x10, 0x00, 0xDB, 0x02, 0xF5, 0x00, 0x00, 0x4F, 0x5B,
+	0xB0, 0x00, 0x00, 0x0A, 0xEF, 0x30, 0x00, 0x00, 0x02, 0xF9, 0x00, 0x00,
+	0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00,
+	0xF8, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x0F, 0xFF, 0xFF, 0xFF,
+	0xF0, 0x01, 0x11, 0x11, 0x3E, 0xA0, 0x00, 0x00, 0x00, 0xBD, 0x10, 0x00,
+	0x00, 0x06, 0xE3, 0x00, 0x00, 0x00, 0x2E, 0x50, 0x00, 0x00, 0x00, 0xC9,
+	0x00, 0x00, 0x00, 0x08, 0xC0, 0x00, 0x00, 0x00, 0x4E, 0x20, 0x00, 0x00,
+	0x01, 0xD4, 0x00, 0x00, 0x00, 0x0A, 0x91, 0x11, 0x11, 0x10, 0x0F, 0xFF,
+	0xFF, 0xFF, 0xF0, 0x00, 0xEE, 0xE2, 0x00, 0xF9, 0x20, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xFF, 0xE2, 0x00, 0x22, 0x20,
+	0x0D, 0x10, 0x00, 0x09, 0x60, 0x00, 0x04, 0xB0, 0x00, 0x00, 0xE1, 0x00,
+	0x00, 0xA5, 0x00, 0x00, 0x5A, 0x00, 0x00, 0x1E, 0x10, 0x00, 0x0A, 0x50,
+	0x00, 0x05, 0xA0, 0x00, 0x01, 0xE0, 0x00, 0x00, 0xB4, 0x00, 0x00, 0x69,
+	0x00, 0x00, 0x16, 0xAE, 0xE7, 0x00, 0x12, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0xAE, 0xF8, 0x00, 0x12, 0x21, 0x00,
+	0x00, 0x00, 0x72, 0x00, 0x00, 0x00, 0x05, 0xD9, 0x00, 0x00, 0x00, 0x0C,
+	0x3D, 0x10, 0x00, 0x00, 0x3C, 0x08, 0x70, 0x00, 0x00, 0xA6, 0x02, 0xD0,
+	0x00, 0x01, 0xE1, 0x00, 0xA5, 0x00, 0x08, 0x90, 0x00, 0x4C, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0xEE, 0xEE, 0xE3, 0x02,
+	0x22, 0x22, 0x20, 0x1E, 0x30, 0x00, 0x05, 0xA0, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x4C, 0xEE, 0xA1, 0x00, 0x03, 0xF8, 0x24, 0xDA,
+	0x00, 0x07, 0xC0, 0x00, 0x8E, 0x00, 0x00, 0x02, 0x45, 0xAF, 0x00, 0x02,
+	0xCE, 0xBA, 0xCF, 0x00, 0x0C, 0xD1, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00,
+	0xBF, 0x00, 0x0C, 0xD3, 0x27, 0xEF, 0x10, 0x02, 0xBE, 0xEA, 0x7F, 0x20,
+	0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80,
+	0x00, 0x00, 0x00, 0x0F, 0x88, 0xDF, 0xC4, 0x00, 0x0F, 0xDA, 0x33, 0xBF,
+	0x30, 0x0F, 0xD0, 0x00, 0x0E, 0xA0, 0x0F, 0x90, 0x00, 0x09, 0xD0, 0x0F,
+	0x80, 0x00, 0x08, 0xF0, 0x0F, 0x90, 0x00, 0x09, 0xD0, 0x0F, 0xD0, 0x00,
+	0x1E, 0x90, 0x0F, 0xEA, 0x33, 0xBE, 0x20, 0x0F, 0x8A, 0xEE, 0xA2, 0x00,
+	0x00, 0x2A, 0xEE, 0xA2, 0x00, 0x02, 0xEA, 0x33, 0xBD, 0x10, 0x0A, 0xD0,
+	0x00, 0x2F, 0x60, 0x0E, 0x90, 0x00, 0x01, 0x10, 0x0F, 0x80, 0x00, 0x00,
+	0x00, 0x0E, 0x90, 0x00, 0x00, 0x00, 0x0B, 0xD0, 0x00, 0x2F, 0x40, 0x04,
+	0xFA, 0x33, 0xCC, 0x00, 0x00, 0x4C, 0xFE, 0x91, 0x00, 0x00, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0x00, 0x00, 0x08, 0xF0, 0x00, 0x00, 0x00, 0x08, 0xF0,
+	0x00, 0x2A, 0xEE, 0xA8, 0xF0, 0x02, 0xEB, 0x33, 0xAE, 0xF0, 0x0A, 0xE1,
+	0x00, 0x0D, 0xF0, 0x0D, 0x90, 0x00, 0x09, 0xF0, 0x0F, 0x80, 0x00, 0x08,
+	0xF0, 0x0D, 0x90, 0x00, 0x09, 0xF0, 0x0A, 0xE0, 0x00, 0x0D, 0xF0, 0x03,
+	0xFA, 0x33, 0xAD, 0xF0, 0x00, 0x4C, 0xFD, 0x88, 0xF0, 0x00, 0x2B, 0xEE,
+	0x91, 0x00, 0x02, 0xEA, 0x33, 0xCA, 0x00, 0x09, 0xD0, 0x00, 0x3F, 0x30,
+	0x0E, 0x90, 0x00, 0x0E, 0x60, 0x0F, 0xFE, 0xEE, 0xEF, 0x70, 0x0E, 0x92,
+	0x22, 0x22, 0x10, 0x0B, 0xB0, 0x00, 0x2D, 0x30, 0x03, 0xF8, 0x23, 0xCC,
+	0x00, 0x00, 0x4C, 0xFE, 0x91, 0x00, 0x00, 0x16, 0x70, 0x00, 0xAE, 0xA0,
+	0x00, 0xE8, 0x00, 0x00, 0xF8, 0x00, 0x0F, 0xFF, 0xF0, 0x01, 0xF8, 0x10,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x2A, 0xEE,
+	0xA8, 0xF0, 0x02, 0xEB, 0x33, 0xAE, 0xF0, 0x0A, 0xE1, 0x00, 0x0D, 0xF0,
+	0x0D, 0x90, 0x00, 0x09, 0xF0, 0x0F, 0x80, 0x00, 0x08, 0xF0, 0x0D, 0x90,
+	0x00, 0x09, 0xF0, 0x0A, 0xE0, 0x00, 0x0D, 0xF0, 0x03, 0xFA, 0x33, 0xAD,
+	0xF0, 0x00, 0x4C, 0xFD, 0x88, 0xF0, 0x08, 0x90, 0x00, 0x0B, 0xC0, 0x05,
+	0xF7, 0x23, 0x8F, 0x50, 0x00, 0x5C, 0xEE, 0xB4, 0x00, 0x0F, 0x80, 0x00,
+	0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00,
+	0x0F, 0x88, 0xEE, 0xA1, 0x00, 0x0F, 0xDA, 0x34, 0xEA, 0x00, 0x0F, 0xD0,
+	0x00, 0x9E, 0x00, 0x0F, 0x90, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F,
+	0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F,
+	0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0A, 0x40, 0x0C,
+	0x50, 0x00, 0x00, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F,
+	0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0A, 0x40, 0x0C,
+	0x50, 0x00, 0x00, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F,
+	0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x70, 0x5F,
+	0x60, 0xFC, 0x10, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00,
+	0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x01, 0xDB, 0x00, 0x0F,
+	0x80, 0x1C, 0xC1, 0x00, 0x0F, 0x80, 0xBC, 0x10, 0x00, 0x0F, 0x89, 0xD1,
+	0x00, 0x00, 0x0F, 0xDF, 0x80, 0x00, 0x00, 0x0F, 0xE8, 0xF5, 0x00, 0x00,
+	0x0F, 0x80, 0xAE, 0x30, 0x00, 0x0F, 0x80, 0x1C, 0xD1, 0x00, 0x0F, 0x80,
+	0x02, 0xEC, 0x10, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F,
+	0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0F,
+	0x91, 0x0A, 0xF8, 0x0F, 0x8B, 0xED, 0x61, 0xBE, 0xD6, 0x00, 0x0F, 0xE7,
+	0x29, 0xFC, 0x72, 0x9F, 0x30, 0x0F, 0xC0, 0x01, 0xFC, 0x00, 0x1F, 0x70,
+	0x0F, 0x90, 0x00, 0xF9, 0x00, 0x0F, 0x70, 0x0F, 0x80, 0x00, 0xF8, 0x00,
+	0x0F, 0x80, 0x0F, 0x80, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x0F, 0x80, 0x00,
+	0xF8, 0x00, 0x0F, 0x80, 0x0F, 0x80, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x0F,
+	0x80, 0x00, 0xF8, 0x00, 0x0F, 0x80, 0x0F, 0x88, 0xEE, 0xA1, 0x00, 0x0F,
+	0xDA, 0x34, 0xEA, 0x00, 0x0F, 0xD0, 0x00, 0x9E, 0x00, 0x0F, 0x90, 0x00,
+	0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00,
+	0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80,
+	0x00, 0x8F, 0x00, 0x00, 0x2A, 0xEF, 0xD6, 0x00, 0x02, 0xEC, 0x42, 0x7F,
+	0x80, 0x09, 0xE1, 0x00, 0x07, 0xF2, 0x0E, 0xA0, 0x00, 0x02, 0xF6, 0x0F,
+	0x80, 0x00, 0x00, 0xF7, 0x0E, 0xA0, 0x00, 0x02, 0xF6, 0x09, 0xE1, 0x00,
+	0x08, 0xF2, 0x02, 0xEC, 0x42, 0x7F, 0x80, 0x00, 0x2A, 0xEF, 0xD7, 0x00,
+	0x0F, 0x88, 0xDF, 0xC4, 0x00, 0x0F, 0xDA, 0x33, 0xBF, 0x30, 0x0F, 0xD0,
+	0x00, 0x0E, 0xA0, 0x0F, 0x90, 0x00, 0x09, 0xD0, 0x0F, 0x80, 0x00, 0x08,
+	0xF0, 0x0F, 0x90, 0x00, 0x09, 0xD0, 0x0F, 0xD0, 0x00, 0x1E, 0x90, 0x0F,
+	0xEA, 0x33, 0xBE, 0x20, 0x0F, 0x8A, 0xEE, 0xA2, 0x00, 0x0F, 0x80, 0x00,
+	0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x0F, 0x80, 0x00, 0x00, 0x00,
+	0x00, 0x2A, 0xEE, 0xA8, 0xF0, 0x02, 0xEB, 0x33, 0xAE, 0xF0, 0x0A, 0xE1,
+	0x00, 0x0D, 0xF0, 0x0D, 0x90, 0x00, 0x09, 0xF0, 0x0F, 0x80, 0x00, 0x08,
+	0xF0, 0x0D, 0x90, 0x00, 0x09, 0xF0, 0x0A, 0xE0, 0x00, 0x0D, 0xF0, 0x03,
+	0xFA, 0x33, 0xAD, 0xF0, 0x00, 0x4C, 0xFD, 0x88, 0xF0, 0x00, 0x00, 0x00,
+	0x08, 0xF0, 0x00, 0x00, 0x00, 0x08, 0xF0, 0x00, 0x00, 0x00, 0x08, 0xF0,
+	0x0F, 0x8A, 0xE0, 0x0F, 0xE9, 0x30, 0x0F, 0xC0, 0x00, 0x0F, 0x80, 0x00,
+	0x0F, 0x80, 0x00, 0x0F, 0x80, 0x00, 0x0F, 0x80, 0x00, 0x0F, 0x80, 0x00,
+	0x0F, 0x80, 0x00, 0x02, 0xBE, 0xE8, 0x00, 0x0B, 0xC2, 0x5F, 0x70, 0x0E,
+	0x80, 0x07, 0x80, 0x0B, 0xE6, 0x10, 0x00, 0x01, 0x9E, 0xFA, 0x10, 0x00,
+	0x01, 0x6E, 0xB0, 0x2B, 0x30, 0x08, 0xE0, 0x0D, 0xC3, 0x3C, 0xB0, 0x02,
+	0xBE, 0xEA, 0x20, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x0F, 0xFF, 0xF0,
+	0x01, 0xF8, 0x10, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xEB, 0x20, 0x00, 0x8E, 0xE0,
+	0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80,
+	0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F, 0x00, 0x0F, 0x80, 0x00, 0x8F,
+	0x00, 0x0F, 0x80, 0x00, 0x9F, 0x00, 0x0E, 0xA0, 0x00, 0xDF, 0x00, 0x0A,
+	0xF5, 0x29, 0xDF, 0x00, 0x01, 0xAE, 0xE9, 0x8F, 0x00, 0xCA, 0x00, 0x00,
+	0x7E, 0x00, 0x7F, 0x10, 0x00, 0xC9, 0x00, 0x2F, 0x50, 0x02, 0xF3, 0x00,
+	0x0B, 0xA0, 0x07, 0xD0, 0x00, 0x06, 0xE1, 0x0C, 0x80, 0x00, 0x01, 0xE5,
+	0x1F, 0x20, 0x00, 0x00, 0xAA, 0x6C, 0x00, 0x00, 0x00, 0x5E, 0xB7, 0x00,
+	0x00, 0x00, 0x0E, 0xF1, 0x00, 0x00, 0xDB, 0x00, 0x0B, 0xF4, 0x00, 0x2F,
+	0x50, 0x8E, 0x00, 0x0E, 0xE8, 0x00, 0x6F, 0x10, 0x4F, 0x40, 0x3E, 0x8B,
+	0x00, 0xAB, 0x00, 0x0E, 0x70, 0x7B, 0x4F, 0x10, 0xE6, 0x00, 0x0A, 0xB0,
+	0xA7, 0x0F, 0x43, 0xF2, 0x00, 0x05, 0xF1, 0xE3, 0x0B, 0x87, 0xC0, 0x00,
+	0x01, 0xF7, 0xE0, 0x08, 0xBA, 0x80, 0x00, 0x00, 0xBE, 0xB0, 0x04, 0xFE,
+	0x30, 0x00, 0x00, 0x6F, 0x70, 0x00, 0xFE, 0x00, 0x00, 0x0A, 0xD1, 0x00,
+	0x6F, 0x30, 0x01, 0xE8, 0x01, 0xE7, 0x00, 0x00, 0x5F, 0x39, 0xC0, 0x00,
+	0x00, 0x0A, 0xDE, 0x20, 0x00, 0x00, 0x03, 0xFA, 0x00, 0x00, 0x00, 0x0B,
+	0xCF, 0x40, 0x00, 0x00, 0x6E, 0x19, 0xD0, 0x00, 0x02, 0xE6, 0x01, 0xE8,
+	0x00, 0x0B, 0xC0, 0x00, 0x6F, 0x30, 0xBC, 0x00, 0x00, 0x7E, 0x10, 0x5F,
+	0x20, 0x00, 0xC9, 0x00, 0x1E, 0x70, 0x02, 0xF4, 0x00, 0x09, 0xC0, 0x07,
+	0xD0, 0x00, 0x04, 0xF2, 0x0C, 0x70, 0x00, 0x00, 0xD7, 0x2F, 0x20, 0x00,
+	0x00, 0x8C, 0x7B, 0x00, 0x00, 0x00, 0x2F, 0xD6, 0x00, 0x00, 0x00, 0x0B,
+	0xE1, 0x00, 0x00, 0x00, 0x0B, 0x90, 0x00, 0x00, 0x02, 0x7E, 0x20, 0x00,
+	0x00, 0x0F, 0xD4, 0x00, 0x00, 0x00, 0x0F, 0xFF, 0xFF, 0xF0, 0x01, 0x11,
+	0x2D, 0xB0, 0x00, 0x00, 0x8E, 0x10, 0x00, 0x03, 0xF5, 0x00, 0x00, 0x0C,
+	0x90, 0x00, 0x00, 0x7D, 0x10, 0x00, 0x02, 0xE3, 0x00, 0x00, 0x0B, 0x91,
+	0x11, 0x10, 0x0F, 0xFF, 0xFF, 0xF0, 0x00, 0x6D, 0x80, 0x00, 0xEB, 0x10,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x01, 0xF7, 0x00,
+	0x0A, 0xD2, 0x00, 0x0B, 0xB1, 0x00, 0x01, 0xF7, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF9, 0x00, 0x00, 0x8F, 0x80,
+	0x00, 0x01, 0x10, 0x00, 0x84, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x0E, 0xB1, 0x00, 0x04, 0xF7, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0x9E, 0x40, 0x00, 0x6D, 0x50, 0x00, 0xE8, 0x00, 0x00, 0xF8, 0x00,
+	0x00, 0xF8, 0x00, 0x00, 0xF8, 0x00, 0x02, 0xF7, 0x00, 0x0F, 0xD2, 0x00,
+	0x02, 0x00, 0x00, 0x07, 0xEB, 0x73, 0xAD, 0x00, 0x0E, 0x90, 0x5B, 0xE7,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
@@ -0,0 +1,534 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Software raster core used by the LCD drawing functions.
+ *
+ * Spans are filled with aligned 32-bit stores, unrolled so that the
+ * compiler can merge them into store-multiple instructions. Rectangle
+ * fills only build the first row and then copy it with memcpy().
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lcd_raster.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Divide by 255 with rounding, for 0 <= value <= 255 * 255.
+ */
+static inline uint32_t _div255(uint32_t value)
+{
+	value += 128;
+	return (value + (value >> 8)) >> 8;
+}
+
+/**
+ * \brief Blend one 8-bit component.
+ */
+static inline uint32_t _blend8(uint32_t src, uint32_t dst, uint32_t alpha)
+{
+	return _div255(src * alpha + dst * (255 - alpha));
+}
+
+/**
+ * \brief Clip a rectangle size against the surface. Coordinates are
+ * unsigned, so only the right and bottom edges can clip.
+ */
+static bool _clip_size(const struct _lcd_surface *surface, uint32_t x,
+		uint32_t y, uint32_t *w, uint32_t *h)
+{
+	if (surface->buffer == NULL)
+		return false;
+	if (x >= surface->width || y >= surface->height)
+		return false;
+	if (*w > surface->width - x)
+		*w = surface->width - x;
+	if (*h > surface->height - y)
+		*h = surface->height - y;
+	return *w > 0 && *h > 0;
+}
+
+/**
+ * \brief Store \a count words, unrolled by 8.
+ */
+static void _fill_words(uint32_t *dst, uint32_t count, uint32_t value)
+{
+	while (count >= 8) {
+		dst[0] = value;
+		dst[1] = value;
+		dst[2] = value;
+		dst[3] = value;
+		dst[4] = value;
+		dst[5] = value;
+		dst[6] = value;
+		dst[7] = value;
+		dst += 8;
+		count -= 8;
+	}
+	while (count--)
+		*dst++ = value;
+}
+
+static void _fill_span16(uint8_t *dst, uint32_t count, uint32_t color)
+{
+	uint16_t *p = (uint16_t*)dst;
+	uint16_t c = color & 0xFFFF;
+
+	if (((uintptr_t)p & 0x3) && count) {
+		*p++ = c;
+		count--;
+	}
+	_fill_words((uint32_t*)p, count >> 1, c | ((uint32_t)c << 16));
+	if (count & 1)
+		p[count - 1] = c;
+}
+
+static void _fill_span24(uint8_t *dst, uint32_t count, uint32_t color)
+{
+	uint32_t c = color & 0xFFFFFF;
+	uint32_t w0, w1, w2;
+	uint32_t *p;
+
+	/* Reach a word boundary, at most 3 pixels */
+	while (((uintptr_t)dst & 0x3) && count) {
+		dst[0] = c;
+		dst[1] = c >> 8;
+		dst[2] = c >> 16;
+		dst += 3;
+		count--;
+	}
+
+	/* 4 pixels fit in 3 words */
+	w0 = c | (c << 24);
+	w1 = (c >> 8) | (c << 16);
+	w2 = (c >> 16) | (c << 8);
+	p = (uint32_t*)dst;
+	while (count >= 4) {
+		p[0] = w0;
+		p[1] = w1;
+		p[2] = w2;
+		p += 3;
+		count -= 4;
+	}
+
+	dst = (uint8_t*)p;
+	while (count--) {
+		dst[0] = c;
+		dst[1] = c >> 8;
+		dst[2] = c >> 16;
+		dst += 3;
+	}
+}
+
+/**
+ * \brief Write one pixel at an address computed by the caller.
+ */
+static inline void _write_pixel(uint8_t *dst, uint8_t bpp, uint32_t color)
+{
+	switch (bpp) {
+	case 16:
+		dst[0] = color;
+		dst[1] = color >> 8;
+		break;
+	case 24:
+		dst[0] = color;
+		dst[1] = color >> 8;
+		dst[2] = color >> 16;
+		break;
+	case 32:
+		*(uint32_t*)dst = color;
+		break;
+	}
+}
+
+/**
+ * \brief Read one pixel at an address computed by the caller.
+ */
+static inline uint32_t _read_pixel(const uint8_t *src, uint8_t bpp)
+{
+	switch (bpp) {
+	case 16:
+		return src[0] | (src[1] << 8);
+	case 24:
+		return src[0] | (src[1] << 8) | (src[2] << 16);
+	case 32:
+		return *(const uint32_t*)src;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief Blend an ARGB 8888 pixel over a pixel of the given format.
+ */
+static uint32_t _blend_pixel(uint32_t src, uint32_t dst, uint8_t bpp,
+		uint32_t alpha)
+{
+	uint32_t sr = (src >> 16) & 0xFF;
+	uint32_t sg = (src >> 8) & 0xFF;
+	uint32_t sb = src & 0xFF;
+	uint32_t r, g, b;
+
+	if (bpp == 16) {
+		/* Expand RGB 565 to 8 bits per component */
+		r = (dst >> 11) & 0x1F;
+		g = (dst >> 5) & 0x3F;
+		b = dst & 0x1F;
+		r = _blend8(sr, (r << 3) | (r >> 2), alpha);
+		g = _blend8(sg, (g << 2) | (g >> 4), alpha);
+		b = _blend8(sb, (b << 3) | (b >> 2), alpha);
+		return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+	}
+
+	r = _blend8(sr, (dst >> 16) & 0xFF, alpha);
+	g = _blend8(sg, (dst >> 8) & 0xFF, alpha);
+	b = _blend8(sb, dst & 0xFF, alpha);
+	if (bpp == 32) {
+		uint32_t a = alpha + _div255((dst >> 24) * (255 - alpha));
+		return (a << 24) | (r << 16) | (g << 8) | b;
+	}
+	return (r << 16) | (g << 8) | b;
+}
+
+/**
+ * \brief Convert an ARGB 8888 pixel to the given format, alpha dropped.
+ */
+static uint32_t _convert_pixel(uint32_t src, uint8_t bpp)
+{
+	if (bpp == 16)
+		return ((src >> 8) & 0xF800) | ((src >> 5) & 0x07E0)
+			| ((src >> 3) & 0x001F);
+	if (bpp == 24)
+		return src & 0xFFFFFF;
+	return src;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t lcd_raster_to_argb(uint32_t color, uint8_t bpp)
+{
+	uint32_t r, g, b;
+
+	switch (bpp) {
+	case 16:
+		r = (color >> 11) & 0x1F;
+		g = (color >> 5) & 0x3F;
+		b = color & 0x1F;
+		r = (r << 3) | (r >> 2);
+		g = (g << 2) | (g >> 4);
+		b = (b << 3) | (b >> 2);
+		return 0xFF000000 | (r << 16) | (g << 8) | b;
+	case 24:
+		return 0xFF000000 | (color & 0xFFFFFF);
+	default:
+		return color;
+	}
+}
+
+uint32_t lcd_raster_mix(uint32_t fg, uint32_t bg, uint8_t bpp, uint8_t alpha)
+{
+	if (alpha == 0)
+		return bg;
+	if (alpha == 255)
+		return fg;
+	return _blend_pixel(lcd_raster_to_argb(fg, bpp), bg, bpp, alpha);
+}
+
+uint32_t lcd_raster_stride(uint16_t width, uint8_t bpp)
+{
+	uint32_t stride = width * (bpp / 8);
+
+	return (stride + 3) & ~3u;
+}
+
+void lcd_raster_init_surface(struct _lcd_surface *surface, void *buffer,
+		uint16_t width, uint16_t height, uint8_t bpp)
+{
+	surface->buffer = buffer;
+	surface->width = width;
+	surface->height = height;
+	surface->bpp = bpp;
+	surface->stride = lcd_raster_stride(width, bpp);
+}
+
+bool lcd_raster_clip(const struct _lcd_surface *surface,
+		uint32_t *x, uint32_t *y, uint32_t *w, uint32_t *h)
+{
+	return _clip_size(surface, *x, *y, w, h);
+}
+
+uint8_t *lcd_raster_pixel_addr(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y)
+{
+	return &surface->buffer[y * surface->stride + x * (surface->bpp / 8)];
+}
+
+void lcd_raster_fill_span(uint8_t *dst, uint32_t count, uint8_t bpp,
+		uint32_t color)
+{
+	switch (bpp) {
+	case 16:
+		_fill_span16(dst, count, color);
+		break;
+	case 24:
+		_fill_span24(dst, count, color);
+		break;
+	case 32:
+		/* Rows are word aligned, so are 32bpp pixels */
+		_fill_words((uint32_t*)dst, count, color);
+		break;
+	}
+}
+
+void lcd_raster_put_pixel(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, uint32_t color)
+{
+	if (surface->buffer == NULL)
+		return;
+	if (x >= surface->width || y >= surface->height)
+		return;
+	_write_pixel(lcd_raster_pixel_addr(surface, x, y), surface->bpp, color);
+}
+
+uint32_t lcd_raster_get_pixel(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y)
+{
+	if (surface->buffer == NULL)
+		return 0;
+	if (x >= surface->width || y >= surface->height)
+		return 0;
+	return _read_pixel(lcd_raster_pixel_addr(surface, x, y), surface->bpp);
+}
+
+void lcd_raster_fill_rect(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+{
+	uint8_t *first, *row;
+	uint32_t len;
+
+	if (!_clip_size(surface, x, y, &w, &h))
+		return;
+
+	first = lcd_raster_pixel_addr(surface, x, y);
+	lcd_raster_fill_span(first, w, surface->bpp, color);
+
+	len = w * (surface->bpp / 8);
+	for (row = first + surface->stride; --h; row += surface->stride)
+		memcpy(row, first, len);
+}
+
+void lcd_raster_copy_rect(const struct _lcd_surface *surface,
+		uint32_t dst_x, uint32_t dst_y, uint32_t src_x, uint32_t src_y,
+		uint32_t w, uint32_t h)
+{
+	uint8_t *src, *dst;
+	int32_t step;
+	uint32_t len;
+
+	if (!_clip_size(surface, src_x, src_y, &w, &h))
+		return;
+	if (!_clip_size(surface, dst_x, dst_y, &w, &h))
+		return;
+
+	src = lcd_raster_pixel_addr(surface, src_x, src_y);
+	dst = lcd_raster_pixel_addr(surface, dst_x, dst_y);
+	len = w * (surface->bpp / 8);
+	step = surface->stride;
+
+	/* Walk rows bottom-up when moving down over the source */
+	if (dst_y > src_y) {
+		src += (h - 1) * surface->stride;
+		dst += (h - 1) * surface->stride;
+		step = -step;
+	}
+	for (; h; h--) {
+		memmove(dst, src, len);
+		src += step;
+		dst += step;
+	}
+}
+
+void lcd_raster_blit(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *src, uint32_t src_stride,
+		uint32_t w, uint32_t h)
+{
+	uint8_t *dst;
+	uint32_t len;
+
+	if (!_clip_size(surface, x, y, &w, &h))
+		return;
+
+	dst = lcd_raster_pixel_addr(surface, x, y);
+	len = w * (surface->bpp / 8);
+	for (; h; h--) {
+		memcpy(dst, src, len);
+		src += src_stride;
+		dst += surface->stride;
+	}
+}
+
+void lcd_raster_blend(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint32_t *src, uint32_t src_stride,
+		uint32_t w, uint32_t h, uint8_t alpha)
+{
+	uint8_t cw = surface->bpp / 8;
+	uint8_t *row;
+	uint32_t i;
+
+	if (!_clip_size(surface, x, y, &w, &h))
+		return;
+
+	row = lcd_raster_pixel_addr(surface, x, y);
+	for (; h; h--) {
+		uint8_t *dst = row;
+		for (i = 0; i < w; i++, dst += cw) {
+			uint32_t s = src[i];
+			uint32_t a = _div255((s >> 24) * alpha);
+			if (a == 0)
+				continue;
+			if (a == 255)
+				_write_pixel(dst, surface->bpp,
+						_convert_pixel(s, surface->bpp));
+			else
+				_write_pixel(dst, surface->bpp,
+						_blend_pixel(s, _read_pixel(dst, surface->bpp),
+							surface->bpp, a));
+		}
+		src = (const uint32_t*)((const uint8_t*)src + src_stride);
+		row += surface->stride;
+	}
+}
+
+bool lcd_raster_draw_rle(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *rle, uint32_t size,
+		uint32_t w, uint32_t h)
+{
+	const uint8_t *end = rle + size;
+	uint8_t cw = surface->bpp / 8;
+	uint32_t vw = w, vh = h;
+	uint32_t col = 0, row = 0;
+	bool visible;
+
+	if (w == 0 || h == 0)
+		return size == 0;
+	visible = _clip_size(surface, x, y, &vw, &vh);
+
+	while (rle < end && row < h) {
+		bool run = (*rle & 0x80) != 0;
+		uint32_t count = (*rle & 0x7F) + 1;
+		uint32_t color = 0;
+
+		rle++;
+		if (rle + (run ? 1 : count) * cw > end)
+			return false;
+		if (run) {
+			color = _read_pixel(rle, surface->bpp);
+			rle += cw;
+		}
+
+		while (count && row < h) {
+			uint32_t n = w - col;
+			if (n > count)
+				n = count;
+
+			if (visible && row < vh && col < vw) {
+				uint8_t *dst = lcd_raster_pixel_addr(surface, x + col, y + row);
+				uint32_t vn = vw - col;
+				if (vn > n)
+					vn = n;
+				if (run)
+					lcd_raster_fill_span(dst, vn, surface->bpp, color);
+				else
+					memcpy(dst, rle, vn * cw);
+			}
+
+			if (!run)
+				rle += n * cw;
+			count -= n;
+			col += n;
+			if (col == w) {
+				col = 0;
+				row++;
+			}
+		}
+		if (count)
+			return false;
+	}
+
+	return rle == end && row == h;
+}
+
+void lcd_raster_draw_palette(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *index, uint8_t index_bpp,
+		uint32_t src_stride, const uint32_t *palette,
+		uint32_t w, uint32_t h)
+{
+	lcd_raster_draw_palette_part(surface, x, y, index, index_bpp,
+			src_stride, 0, palette, w, h);
+}
+
+void lcd_raster_draw_palette_part(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *index, uint8_t index_bpp,
+		uint32_t src_stride, uint32_t src_x, const uint32_t *palette,
+		uint32_t w, uint32_t h)
+{
+	uint8_t cw = surface->bpp / 8;
+	uint8_t mask = (1 << index_bpp) - 1;
+	uint8_t *row;
+	uint32_t i;
+
+	if (index_bpp != 1 && index_bpp != 2 && index_bpp != 4 && index_bpp != 8)
+		return;
+	if (!_clip_size(surface, x, y, &w, &h))
+		return;
+
+	row = lcd_raster_pixel_addr(surface, x, y);
+	for (; h; h--) {
+		uint8_t *dst = row;
+		uint32_t bit = src_x * index_bpp;
+		for (i = 0; i < w; i++, dst += cw, bit += index_bpp) {
+			uint8_t shift = 8 - index_bpp - (bit & 7);
+			uint8_t idx = (index[bit >> 3] >> shift) & mask;
+			_write_pixel(dst, surface->bpp, palette[idx]);
+		}
+		index += src_stride;
+		row += surface->stride;
+	}
+}
@@ -0,0 +1,210 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Software raster core used by the LCD drawing functions.
+ *
+ * The functions in this module only operate on a memory surface
+ * description (buffer, size, bits per pixel and row stride) and have no
+ * dependency on the LCD controller, the caches or the DMA. They can thus
+ * be compiled for the host to check the drawing code against reference
+ * images.
+ *
+ * Colors are given in the native pixel format of the surface:
+ * - 16bpp: RGB 565
+ * - 24bpp: RGB 888 packed, blue in the lowest byte
+ * - 32bpp: ARGB 8888
+ *
+ * All rectangles are clipped against the surface bounds.
+ */
+
+#ifndef LCD_RASTER_H
+#define LCD_RASTER_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Memory surface drawn by the raster functions */
+struct _lcd_surface {
+	uint8_t *buffer;   /**< First pixel of the surface */
+	uint16_t width;    /**< Width in pixels */
+	uint16_t height;   /**< Height in pixels */
+	uint8_t bpp;       /**< Bits per pixel (16, 24 or 32) */
+	uint32_t stride;   /**< Distance between two rows, in bytes */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Convert a color from the given pixel format to ARGB 8888 (opaque).
+ */
+extern uint32_t lcd_raster_to_argb(uint32_t color, uint8_t bpp);
+
+/**
+ * \brief Mix two colors of the given pixel format.
+ * \param alpha  Weight of \a fg, from 0 (\a bg only) to 255 (\a fg only).
+ */
+extern uint32_t lcd_raster_mix(uint32_t fg, uint32_t bg, uint8_t bpp,
+		uint8_t alpha);
+
+/**
+ * \brief Return the row stride used by the LCD driver for a given layer
+ * width, rows being padded to a multiple of 4 bytes.
+ */
+extern uint32_t lcd_raster_stride(uint16_t width, uint8_t bpp);
+
+/**
+ * \brief Initialize a surface description with the LCD driver row stride.
+ */
+extern void lcd_raster_init_surface(struct _lcd_surface *surface, void *buffer,
+		uint16_t width, uint16_t height, uint8_t bpp);
+
+/**
+ * \brief Clip a rectangle against the surface.
+ * \param x, y  Top-left corner, updated with the clipped position.
+ * \param w, h  Size in pixels, updated with the clipped size.
+ * \return true if some part of the rectangle is visible.
+ */
+extern bool lcd_raster_clip(const struct _lcd_surface *surface,
+		uint32_t *x, uint32_t *y, uint32_t *w, uint32_t *h);
+
+/**
+ * \brief Return the address of a pixel (no bound check).
+ */
+extern uint8_t *lcd_raster_pixel_addr(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y);
+
+/**
+ * \brief Fill \a count pixels starting at \a dst with \a color.
+ */
+extern void lcd_raster_fill_span(uint8_t *dst, uint32_t count, uint8_t bpp,
+		uint32_t color);
+
+/**
+ * \brief Write one pixel, ignored if outside the surface.
+ */
+extern void lcd_raster_put_pixel(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, uint32_t color);
+
+/**
+ * \brief Read one pixel, 0 if outside the surface.
+ */
+extern uint32_t lcd_raster_get_pixel(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y);
+
+/**
+ * \brief Fill a rectangle with \a color.
+ *
+ * Only the first row is filled pixel by pixel, the following rows are
+ * copies of it.
+ */
+extern void lcd_raster_fill_rect(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color);
+
+/**
+ * \brief Copy a rectangle of the surface to another position of the same
+ * surface. Overlapping areas are handled.
+ */
+extern void lcd_raster_copy_rect(const struct _lcd_surface *surface,
+		uint32_t dst_x, uint32_t dst_y, uint32_t src_x, uint32_t src_y,
+		uint32_t w, uint32_t h);
+
+/**
+ * \brief Copy an image in the surface pixel format.
+ * \param src         First pixel of the image.
+ * \param src_stride  Distance between two image rows, in bytes.
+ */
+extern void lcd_raster_blit(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *src, uint32_t src_stride,
+		uint32_t w, uint32_t h);
+
+/**
+ * \brief Blend an ARGB 8888 image over the surface.
+ *
+ * Each source pixel is weighted by its own alpha multiplied by \a alpha
+ * (255 keeps the per-pixel alpha unchanged).
+ */
+extern void lcd_raster_blend(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint32_t *src, uint32_t src_stride,
+		uint32_t w, uint32_t h, uint8_t alpha);
+
+/**
+ * \brief Decode a run-length encoded image in the surface pixel format.
+ *
+ * The stream is a sequence of packets starting with a header byte:
+ * - bit 7 set: the next pixel is repeated (header & 0x7f) + 1 times
+ * - bit 7 clear: (header + 1) literal pixels follow
+ *
+ * Pixels take bpp / 8 bytes and runs may cross row boundaries.
+ *
+ * \param rle   Encoded stream.
+ * \param size  Size of the stream in bytes.
+ * \return true if the stream exactly covered the w * h pixels.
+ */
+extern bool lcd_raster_draw_rle(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *rle, uint32_t size,
+		uint32_t w, uint32_t h);
+
+/**
+ * \brief Decode a palette image.
+ *
+ * \param index       Packed indexes, leftmost pixel in the most
+ *                    significant bits of each byte.
+ * \param index_bpp   Bits per index (1, 2, 4 or 8).
+ * \param src_stride  Distance between two index rows, in bytes.
+ * \param palette     Colors in the surface pixel format.
+ */
+extern void lcd_raster_draw_palette(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *index, uint8_t index_bpp,
+		uint32_t src_stride, const uint32_t *palette,
+		uint32_t w, uint32_t h);
+
+/**
+ * \brief Decode the columns \a src_x to \a src_x + \a w - 1 of a palette
+ * image, see lcd_raster_draw_palette().
+ *
+ * \param src_x  First source column, need not start on a byte boundary.
+ */
+extern void lcd_raster_draw_palette_part(const struct _lcd_surface *surface,
+		uint32_t x, uint32_t y, const uint8_t *index, uint8_t index_bpp,
+		uint32_t src_stride, uint32_t src_x, const uint32_t *palette,
+		uint32_t w, uint32_t h);
+
+#endif /* LCD_RASTER_H */
@@ -27,9 +27,31 @@
  * ----------------------------------------------------------------------------
  */
 
+#include "chip.h"
+
 #include "mutex.h"
+#include "sched.h"
+
+/* Release the lock without waking up waiters, see mutex_armv*_*.S */
+extern void mutex_release(mutex_t* mutex);
 
 void mutex_lock(mutex_t* mutex)
 {
-	while (!mutex_try_lock(mutex)) {}
+	uint32_t state;
+
+	while (!mutex_try_lock(mutex)) {
+		/* with IRQs masked the owner cannot release the mutex between
+		 * the check and the wait, so the wake-up is not missed */
+		state = irq_save();
+		if (mutex_is_locked(mutex))
+			sched_wait_object(mutex);
+		irq_restore(state);
+	}
+}
+
+void mutex_unlock(mutex_t* mutex)
+{
+	mutex_release(mutex);
+	/* the first waiter retries to take the mutex */
+	sched_wake_object(mutex);
 }
@@ -24,9 +24,9 @@ mutex_try_lock:
 	bx      lr
 
 /* unlock mutex */
-	SECTION .mutex_unlock:CODE:NOROOT(2)
-	PUBLIC  mutex_unlock
-mutex_unlock:
+	SECTION .mutex_release:CODE:NOROOT(2)
+	PUBLIC  mutex_release
+mutex_release:
 	mov     r1, #UNLOCKED
 	dmb                   /* Required before releasing protected resource */
 	str     r1, [r0]      /* Unlock mutex */
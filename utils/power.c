@@ -0,0 +1,367 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  Tickless idle power manager.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "hrtimer.h"
+#include "intmath.h"
+#include "power.h"
+#include "timer.h"
+#include "peripherals/aic.h"
+#include "peripherals/pmc.h"
+#ifdef CONFIG_SOC_SAMA5D2
+#include "peripherals/rtc.h"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Longest ULP1 sleep: the RTC alarm only matches on the seconds field */
+#define ULP1_MAX_SECONDS 59
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Conservative defaults, ULP0/ULP1 exit includes the PLL and oscillator
+ * start-up of pmc_set_custom_pck_mck() */
+static const struct _power_state_desc _default_states[POWER_STATE_COUNT] = {
+	[POWER_STATE_RUN]  = { .latency = 0,     .min_residency = 0 },
+	[POWER_STATE_WFI]  = { .latency = 0,     .min_residency = 0 },
+	[POWER_STATE_ULP0] = { .latency = 3000,  .min_residency = 10000 },
+	[POWER_STATE_ULP1] = { .latency = 10000, .min_residency = 2000000 },
+};
+
+static const char* _state_names[POWER_STATE_COUNT] = {
+	[POWER_STATE_RUN]  = "run",
+	[POWER_STATE_WFI]  = "wfi",
+	[POWER_STATE_ULP0] = "ulp0",
+	[POWER_STATE_ULP1] = "ulp1",
+};
+
+static struct _power_config _config;
+static const struct _power_state_desc* _states = _default_states;
+static uint32_t _max_latency = UINT32_MAX;
+
+static struct {
+	bool running;
+	uint32_t start;
+	uint32_t end;
+	struct _power_stats stats;
+} _measure;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static bool _state_is_available(enum _power_state state)
+{
+	switch (state) {
+	case POWER_STATE_WFI:
+		return true;
+	case POWER_STATE_ULP0:
+		return _config.run_clock && _config.ulp0_clock &&
+			!hrtimer_get_frequency();
+#if defined(CONFIG_SOC_SAMA5D2) && defined(CONFIG_HAVE_PMC_FAST_STARTUP)
+	case POWER_STATE_ULP1:
+		return _config.run_clock && _config.ulp1_clock &&
+			!hrtimer_get_frequency();
+#endif
+	default:
+		return false;
+	}
+}
+
+/**
+ * \brief Time left before the deadline or the next hrtimer expiry, in us.
+ * The current tick is considered fully elapsed.
+ */
+static uint32_t _get_budget(uint32_t ticks)
+{
+	uint64_t budget = (uint64_t)(ticks - 1) * timer_get_resolution();
+
+	if (hrtimer_get_frequency()) {
+		uint64_t next = hrtimer_get_next_expiry();
+		if (next != UINT64_MAX) {
+			uint64_t now = hrtimer_get_ticks();
+			uint64_t delta = 0;
+			if (next > now)
+				delta = hrtimer_ticks_to_ns(next - now) / 1000;
+			if (delta < budget)
+				budget = delta;
+		}
+	}
+	return budget > UINT32_MAX ? UINT32_MAX : (uint32_t)budget;
+}
+
+static enum _power_state _select_state(uint32_t budget)
+{
+	int state;
+
+	for (state = POWER_STATE_COUNT - 1; state > POWER_STATE_WFI; state--) {
+		if (!_state_is_available((enum _power_state)state))
+			continue;
+		if (_states[state].latency > _max_latency)
+			continue;
+		if (_states[state].latency >= budget ||
+		    _states[state].min_residency > budget)
+			continue;
+		return (enum _power_state)state;
+	}
+	return POWER_STATE_WFI;
+}
+
+static bool _enter_wfi(uint32_t wake, uint32_t* slept)
+{
+	if (!timer_suspend_tick(wake, 0))
+		return false;
+	irq_wait();
+	*slept = timer_resume_tick(0);
+	return true;
+}
+
+static bool _enter_ulp0(uint32_t wake, uint32_t* slept)
+{
+	if (_config.suspend)
+		_config.suspend(POWER_STATE_ULP0);
+
+	/* the PIT runs on the slow MCK and wakes the system up */
+	pmc_set_custom_pck_mck(_config.ulp0_clock);
+	if (timer_suspend_tick(wake, pmc_get_peripheral_clock(ID_PIT))) {
+		irq_wait();
+		pmc_set_custom_pck_mck(_config.run_clock);
+		*slept = timer_resume_tick(0);
+	} else {
+		pmc_set_custom_pck_mck(_config.run_clock);
+		*slept = 0;
+	}
+
+	if (_config.resume)
+		_config.resume(POWER_STATE_ULP0);
+	return *slept != 0;
+}
+
+#if defined(CONFIG_SOC_SAMA5D2) && defined(CONFIG_HAVE_PMC_FAST_STARTUP)
+static void _power_rtc_handler(void)
+{
+	if (rtc_get_sr(RTC_SR_ALARM)) {
+		rtc_disable_it(RTC_IDR_ALRDIS);
+		rtc_clear_sccr(RTC_SCCR_ALRCLR);
+	}
+}
+
+static uint32_t _time_to_seconds(const struct _time* time)
+{
+	return time->hour * 3600 + time->min * 60 + time->sec;
+}
+
+static bool _enter_ulp1(uint32_t budget, uint32_t* slept)
+{
+	struct _time before, after, alarm;
+	uint32_t seconds = budget / 1000000;
+
+	if (seconds > ULP1_MAX_SECONDS)
+		seconds = ULP1_MAX_SECONDS;
+	rtc_get_time(&before);
+	/* a null seconds field disables the alarm, wake up one second early */
+	if ((before.sec + seconds) % 60 == 0)
+		seconds--;
+	if (seconds == 0)
+		return false;
+
+	/* the PIT clock is stopped in ULP1, the RTC measures the time */
+	timer_suspend_tick(TIMER_NO_DEADLINE, 0);
+
+	if (_config.suspend)
+		_config.suspend(POWER_STATE_ULP1);
+
+	alarm.hour = 0;
+	alarm.min = 0;
+	alarm.sec = (before.sec + seconds) % 60;
+	rtc_set_time_alarm(&alarm);
+	rtc_clear_sccr(RTC_SCCR_ALRCLR);
+	rtc_enable_it(RTC_IER_ALREN);
+
+	pmc_set_custom_pck_mck(_config.ulp1_clock);
+	pmc_set_fast_startup_mode(PMC_FSMR_RTCAL | PMC_FSMR_LPM |
+			_config.ulp1_wakeup);
+
+	/* WFE ignores masked interrupts. The first WFE may return at once
+	 * if the event register is already set. */
+	irq_enable();
+	asm("WFE");
+	asm("WFE");
+	irq_disable();
+
+	while ((PMC->PMC_SR & PMC_SR_MCKRDY) == 0);
+	pmc_set_fast_startup_mode(0);
+	pmc_set_custom_pck_mck(_config.run_clock);
+	rtc_disable_it(RTC_IDR_ALRDIS);
+
+	rtc_get_time(&after);
+	seconds = (_time_to_seconds(&after) + 86400 -
+			_time_to_seconds(&before)) % 86400;
+	*slept = timer_resume_tick(seconds ? seconds * 1000000 : 1);
+
+	if (_config.resume)
+		_config.resume(POWER_STATE_ULP1);
+	return true;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void power_configure(const struct _power_config* config)
+{
+	_config = *config;
+	_states = config->states ? config->states : _default_states;
+
+#if defined(CONFIG_SOC_SAMA5D2) && defined(CONFIG_HAVE_PMC_FAST_STARTUP)
+	if (_config.ulp1_clock) {
+		aic_set_source_vector(ID_SYSC, _power_rtc_handler);
+		aic_enable(ID_SYSC);
+	}
+#endif
+}
+
+void power_set_latency_constraint(uint32_t latency)
+{
+	_max_latency = latency;
+}
+
+enum _power_state power_idle(uint32_t deadline)
+{
+	enum _power_state state;
+	uint32_t irqs, ticks, budget, wake, latency;
+	uint32_t slept = 0;
+	bool done;
+
+	irqs = irq_save();
+
+	ticks = deadline - timer_get_tick();
+	if (ticks == 0 || ticks > (UINT32_MAX >> 1)) {
+		irq_restore(irqs);
+		return POWER_STATE_RUN;
+	}
+
+	budget = _get_budget(ticks);
+	state = _select_state(budget);
+
+	/* wake up early enough to absorb the exit latency */
+	wake = deadline;
+	latency = CEIL_INT_DIV(_states[state].latency, timer_get_resolution());
+	if (state != POWER_STATE_WFI) {
+		if (latency < ticks)
+			wake = deadline - latency;
+		else
+			state = POWER_STATE_WFI;
+	}
+
+	switch (state) {
+	case POWER_STATE_ULP0:
+		done = _enter_ulp0(wake, &slept);
+		break;
+#if defined(CONFIG_SOC_SAMA5D2) && defined(CONFIG_HAVE_PMC_FAST_STARTUP)
+	case POWER_STATE_ULP1:
+		done = _enter_ulp1(budget - _states[state].latency, &slept);
+		break;
+#endif
+	default:
+		done = _enter_wfi(wake, &slept);
+		break;
+	}
+	if (!done)
+		state = POWER_STATE_RUN;
+
+	if (_measure.running && done) {
+		_measure.stats.entries[state]++;
+		_measure.stats.residency[state] += slept;
+		if ((int32_t)(timer_get_tick() - wake) < 0)
+			_measure.stats.early_wakeups++;
+	}
+
+	irq_restore(irqs);
+	return state;
+}
+
+void power_start_measure(void)
+{
+	uint32_t irqs = irq_save();
+
+	memset(&_measure.stats, 0, sizeof(_measure.stats));
+	_measure.start = timer_get_tick();
+	_measure.running = true;
+	irq_restore(irqs);
+}
+
+void power_stop_measure(void)
+{
+	_measure.end = timer_get_tick();
+	_measure.running = false;
+}
+
+void power_get_stats(struct _power_stats* stats)
+{
+	uint32_t irqs = irq_save();
+	uint32_t end = _measure.running ? timer_get_tick() : _measure.end;
+	uint64_t sleep = 0;
+	int state;
+
+	*stats = _measure.stats;
+	irq_restore(irqs);
+
+	stats->duration = (uint64_t)(end - _measure.start) *
+		timer_get_resolution();
+	for (state = POWER_STATE_WFI; state < POWER_STATE_COUNT; state++)
+		sleep += stats->residency[state];
+	stats->residency[POWER_STATE_RUN] =
+		stats->duration > sleep ? stats->duration - sleep : 0;
+}
+
+const char* power_get_state_name(enum _power_state state)
+{
+	if (state >= POWER_STATE_COUNT)
+		return "unknown";
+	return _state_names[state];
+}
@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  \par Purpose
+ *  Tickless idle power manager.
+ *
+ *  power_idle() is called when the application has nothing to do before a
+ *  deadline expressed in system ticks (see timer.h). It stops the periodic
+ *  tick, picks the deepest low-power state whose wake-up latency fits both
+ *  the time left before the deadline (and before the next hrtimer expiry)
+ *  and the latency constraint set by the application, then compensates the
+ *  tick counter when the system wakes up.
+ *
+ *  Supported states:
+ *  - POWER_STATE_WFI: core clock stopped, MCK unchanged.
+ *  - POWER_STATE_ULP0: MCK switched to a slow setting, core clock stopped.
+ *    The PIT keeps running on the slow MCK and wakes the system up.
+ *  - POWER_STATE_ULP1 (SAMA5D2 only): all clocks stopped, woken up by an RTC
+ *    alarm or a fast start-up input. The time spent in ULP1 is measured with
+ *    the RTC, i.e. with a one second resolution.
+ *
+ *  ULP states change MCK, so they are never selected while the hrtimer
+ *  service is configured: its time base would be lost.
+ *
+ *  \par Usage
+ *  -# Optionally call power_configure() with the clock settings of the ULP
+ *     states and the board hooks to run around them. Without configuration
+ *     only WFI is used.
+ *  -# Build with CONFIG_TIMER_TICKLESS so that timer_wait() uses
+ *     power_idle(), or call power_idle() from the application idle loop.
+ *  -# Use power_start_measure() and power_get_stats() to get the residency
+ *     in each state.
+ */
+
+#ifndef POWER_HEADER_
+#define POWER_HEADER_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "peripherals/pmc.h"
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+enum _power_state {
+	POWER_STATE_RUN,   /**< not sleeping */
+	POWER_STATE_WFI,
+	POWER_STATE_ULP0,
+	POWER_STATE_ULP1,
+	POWER_STATE_COUNT,
+};
+
+/** Characteristics of a low-power state */
+struct _power_state_desc {
+	uint32_t latency;       /**< worst case entry + exit time (us) */
+	uint32_t min_residency; /**< shortest sleep worth entering it (us) */
+};
+
+struct _power_config {
+	/** MCK setting restored on wake-up, required by the ULP states */
+	struct pck_mck_cfg* run_clock;
+	/** MCK setting used in ULP0, NULL to disable ULP0 */
+	struct pck_mck_cfg* ulp0_clock;
+	/** MCK setting used before entering ULP1, NULL to disable ULP1 */
+	struct pck_mck_cfg* ulp1_clock;
+	/** Additional fast start-up sources (PMC_FSMR_FSTTx) for ULP1 */
+	uint32_t ulp1_wakeup;
+	/** Table of POWER_STATE_COUNT entries, NULL for the defaults */
+	const struct _power_state_desc* states;
+	/** Called before entering a ULP state (save and park IOs...) */
+	void (*suspend)(enum _power_state state);
+	/** Called after leaving a ULP state, MCK restored (console...) */
+	void (*resume)(enum _power_state state);
+};
+
+/** Residency report, filled while a measurement is running */
+struct _power_stats {
+	uint64_t duration;                     /**< measured time (us) */
+	uint64_t residency[POWER_STATE_COUNT]; /**< time in each state (us) */
+	uint32_t entries[POWER_STATE_COUNT];   /**< number of entries */
+	uint32_t early_wakeups;                /**< woken up before the deadline */
+};
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Configure the low-power states available to power_idle().
+ *
+ * The configuration is copied. If ULP1 is enabled, the RTC must be running
+ * in 24-hour mode; its interrupt vector is taken over to acknowledge the
+ * wake-up alarm.
+ */
+extern void power_configure(const struct _power_config* config);
+
+/**
+ * \brief Set the maximum wake-up latency the application can tolerate.
+ *
+ * \param latency Latency in us, UINT32_MAX for no constraint (default).
+ */
+extern void power_set_latency_constraint(uint32_t latency);
+
+/**
+ * \brief Sleep in the deepest suitable state until \a deadline or an
+ * interrupt.
+ *
+ * \param deadline Tick count (as returned by timer_get_tick()) to wake up at.
+ * \return The state that was used, POWER_STATE_RUN if the deadline was
+ * already reached.
+ */
+extern enum _power_state power_idle(uint32_t deadline);
+
+/**
+ * \brief Reset the statistics and start measuring residency.
+ */
+extern void power_start_measure(void);
+
+/**
+ * \brief Stop measuring residency, statistics are kept.
+ */
+extern void power_stop_measure(void);
+
+/**
+ * \brief Get the residency statistics.
+ *
+ * POWER_STATE_RUN residency is the measured time not spent sleeping.
+ */
+extern void power_get_stats(struct _power_stats* stats);
+
+/**
+ * \brief Get a printable name for a state.
+ */
+extern const char* power_get_state_name(enum _power_state state);
+
+#endif /* POWER_HEADER_ */
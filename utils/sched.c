@@ -0,0 +1,662 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  Implementation of the preemptive scheduler.
+ *
+ *  All scheduler data is only changed with IRQs masked. The running thread
+ *  is not part of the ready lists.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include "core/irq.h"
+
+#include "sched.h"
+#include "timer.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+enum {
+	THREAD_READY,
+	THREAD_RUNNING,
+	THREAD_BLOCKED,
+	THREAD_ENDED,
+};
+
+/** Words of the context saved on a thread stack: r0-r12, lr, pc, cpsr */
+#define CONTEXT_WORDS     16
+
+/** Fill pattern of thread stacks, to find out the unused part */
+#define STACK_PATTERN     0xa5a5a5a5
+
+/** CPSR of a new thread: SVC mode, IRQ and FIQ enabled */
+#define THREAD_CPSR       0x13
+
+/** Thumb state bit of the CPSR */
+#define THREAD_CPSR_THUMB 0x20
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Context switch requested on interrupt exit, used by sched_irq_switch */
+struct {
+	uint32_t** save;
+	uint32_t* load;
+} sched_irq_context;
+
+static struct _thread _main_thread;
+
+static struct _thread* _current;
+
+static struct _thread* _threads;
+
+static struct {
+	struct _thread* head;
+	struct _thread* tail;
+} _ready[SCHED_PRIORITIES];
+
+static uint32_t _ready_mask;
+
+/** Threads blocked in sched_wait_irq() */
+static struct _sched_wait _irq_waiters;
+
+/** Threads blocked in sched_wait_object(), whatever the object */
+static struct _sched_wait _object_waiters;
+
+/** Set while the core waits for an interrupt with no thread ready */
+static bool _idle;
+
+static uint32_t _last_tick;
+static uint32_t _slice_start;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+extern void sched_context_switch(uint32_t** save, uint32_t* load);
+extern void sched_irq_switch(void);
+
+static void _ready_push(struct _thread* thread, bool front)
+{
+	uint8_t prio = thread->priority;
+
+	thread->state = THREAD_READY;
+	if (!_ready[prio].head) {
+		thread->next = NULL;
+		_ready[prio].head = _ready[prio].tail = thread;
+	} else if (front) {
+		thread->next = _ready[prio].head;
+		_ready[prio].head = thread;
+	} else {
+		thread->next = NULL;
+		_ready[prio].tail->next = thread;
+		_ready[prio].tail = thread;
+	}
+	_ready_mask |= 1u << prio;
+}
+
+static void _ready_remove(struct _thread* thread)
+{
+	uint8_t prio = thread->priority;
+	struct _thread* prev = NULL;
+	struct _thread* t;
+
+	for (t = _ready[prio].head; t && t != thread; t = t->next)
+		prev = t;
+	if (!t)
+		return;
+	if (prev)
+		prev->next = t->next;
+	else
+		_ready[prio].head = t->next;
+	if (_ready[prio].tail == t)
+		_ready[prio].tail = prev;
+	if (!_ready[prio].head)
+		_ready_mask &= ~(1u << prio);
+}
+
+/**
+ * \brief Priority of the highest ready thread, -1 if none
+ */
+static int _ready_highest(void)
+{
+	int prio;
+
+	for (prio = SCHED_PRIO_MAX; prio >= 0; prio--)
+		if (_ready_mask & (1u << prio))
+			return prio;
+	return -1;
+}
+
+static struct _thread* _ready_pop(void)
+{
+	int prio = _ready_highest();
+	struct _thread* thread;
+
+	if (prio < 0)
+		return NULL;
+	thread = _ready[prio].head;
+	_ready[prio].head = thread->next;
+	if (!_ready[prio].head) {
+		_ready[prio].tail = NULL;
+		_ready_mask &= ~(1u << prio);
+	}
+	thread->next = NULL;
+	return thread;
+}
+
+/**
+ * \brief Insert a thread in a wait list, after the waiters of the same or
+ * a higher priority
+ */
+static void _wait_insert(struct _sched_wait* wait, struct _thread* thread)
+{
+	struct _thread** link = &wait->head;
+
+	while (*link && (*link)->priority >= thread->priority)
+		link = &(*link)->next;
+	thread->next = *link;
+	*link = thread;
+	thread->wait = wait;
+}
+
+static void _wait_remove(struct _sched_wait* wait, struct _thread* thread)
+{
+	struct _thread** link = &wait->head;
+
+	while (*link && *link != thread)
+		link = &(*link)->next;
+	if (*link)
+		*link = thread->next;
+	thread->next = NULL;
+	thread->wait = NULL;
+}
+
+/**
+ * \brief Make a blocked thread ready
+ */
+static void _wake(struct _thread* thread, bool timed_out)
+{
+	if (thread->wait)
+		_wait_remove(thread->wait, thread);
+	thread->timed = false;
+	thread->timed_out = timed_out;
+	_ready_push(thread, false);
+}
+
+/**
+ * \brief Wake up the highest priority thread of a wait list
+ */
+static struct _thread* _wake_first(struct _sched_wait* wait)
+{
+	struct _thread* thread = wait->head;
+
+	if (thread)
+		_wake(thread, false);
+	return thread;
+}
+
+/**
+ * \brief Wake up the threads whose timed wait expired
+ */
+static void _check_timeouts(uint32_t tick)
+{
+	struct _thread* thread;
+
+	for (thread = _threads; thread; thread = thread->all_next) {
+		if (thread->state == THREAD_BLOCKED && thread->timed &&
+		    (int32_t)(tick - thread->wake) >= 0)
+			_wake(thread, true);
+	}
+}
+
+/**
+ * \brief Switch to the highest priority ready thread, if it should run
+ * instead of the current one. Called in thread context with IRQs masked.
+ * \param yield  Let the ready threads of the same priority run first.
+ */
+static void _reschedule(bool yield)
+{
+	struct _thread* prev = _current;
+	struct _thread* next;
+	int prio = _ready_highest();
+
+	if (prev->state == THREAD_RUNNING) {
+		if (prio < prev->priority || (prio == prev->priority && !yield))
+			return;
+		_ready_push(prev, false);
+	}
+
+	/* Nothing to run: wait for an interrupt to make a thread ready */
+	while (!_ready_mask) {
+		_idle = true;
+		irq_wait();
+		irq_enable();
+		irq_disable();
+		_idle = false;
+	}
+
+	next = _ready_pop();
+	next->state = THREAD_RUNNING;
+	_slice_start = _last_tick;
+	if (next != prev) {
+		_current = next;
+		sched_context_switch(&prev->sp, next->sp);
+	}
+}
+
+/**
+ * \brief Preempt the calling thread if a higher priority one is ready,
+ * does nothing in interrupt context (see _sched_irq_exit()).
+ */
+static void _preempt(void)
+{
+	if (!irq_in_interrupt() && _ready_highest() > _current->priority)
+		_reschedule(false);
+}
+
+/**
+ * \brief Block the calling thread, IRQs masked.
+ * \return false on timeout.
+ */
+static bool _block(struct _sched_wait* wait, uint32_t timeout)
+{
+	struct _thread* thread = _current;
+
+	thread->state = THREAD_BLOCKED;
+	thread->timed_out = false;
+	if (wait)
+		_wait_insert(wait, thread);
+	if (timeout != SCHED_WAIT_FOREVER) {
+		thread->timed = true;
+		thread->wake = timer_get_tick() + timeout;
+	}
+	_reschedule(false);
+	return !thread->timed_out;
+}
+
+/**
+ * \brief Called when an interrupt returns to thread context: wakes up the
+ * threads waiting for interrupts or timeouts and preempts the interrupted
+ * thread if needed.
+ */
+static irq_exit_t _sched_irq_exit(void)
+{
+	struct _thread* prev = _current;
+	struct _thread* next;
+	uint32_t tick = timer_get_tick();
+	bool slice_end;
+	int prio;
+
+	while (_wake_first(&_irq_waiters)) {}
+
+	if (tick != _last_tick) {
+		_last_tick = tick;
+		_check_timeouts(tick);
+	}
+
+	/* The interrupted code is _reschedule(), waiting for a thread */
+	if (_idle)
+		return NULL;
+
+	prio = _ready_highest();
+	slice_end = (tick - _slice_start) >= SCHED_TIME_SLICE;
+	if (prio < prev->priority || (prio == prev->priority && !slice_end))
+		return NULL;
+
+	/* a preempted thread resumes first at its priority, one at the end
+	 * of its time slice goes after the others */
+	_ready_push(prev, prio > prev->priority);
+	next = _ready_pop();
+	next->state = THREAD_RUNNING;
+	_slice_start = tick;
+	_current = next;
+
+	sched_irq_context.save = &prev->sp;
+	sched_irq_context.load = next->sp;
+	return sched_irq_switch;
+}
+
+/**
+ * \brief Return point of the thread functions
+ */
+static void _thread_return(void)
+{
+	sched_thread_exit();
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void sched_start(uint8_t priority)
+{
+	uint32_t state = irq_save();
+
+	if (_current) {
+		irq_restore(state);
+		return;
+	}
+
+	memset(&_main_thread, 0, sizeof(_main_thread));
+	_main_thread.name = "main";
+	_main_thread.priority = priority > SCHED_PRIO_MAX ? SCHED_PRIO_MAX : priority;
+	_main_thread.state = THREAD_RUNNING;
+	_threads = &_main_thread;
+	_current = &_main_thread;
+	_last_tick = _slice_start = timer_get_tick();
+
+	irq_set_exit_hook(_sched_irq_exit);
+	irq_restore(state);
+}
+
+bool sched_is_running(void)
+{
+	return _current != NULL;
+}
+
+bool sched_thread_create(struct _thread* thread, const char* name,
+		sched_entry_t entry, void* arg, void* stack, uint32_t stack_size,
+		uint8_t priority)
+{
+	uint32_t* frame;
+	uint32_t i, state;
+
+	if (!_current || priority > SCHED_PRIO_MAX ||
+	    stack_size < SCHED_STACK_MIN || ((uint32_t)stack & 7))
+		return false;
+
+	memset(thread, 0, sizeof(*thread));
+	thread->name = name;
+	thread->stack = (uint32_t*)stack;
+	thread->stack_size = stack_size & ~7;
+	thread->priority = priority;
+
+	for (i = 0; i < thread->stack_size / 4; i++)
+		thread->stack[i] = STACK_PATTERN;
+
+	/* initial context, as saved by a context switch */
+	frame = thread->stack + thread->stack_size / 4 - CONTEXT_WORDS;
+	memset(frame, 0, CONTEXT_WORDS * 4);
+	frame[0] = (uint32_t)arg;
+	frame[13] = (uint32_t)_thread_return;
+	frame[14] = (uint32_t)entry & ~1;
+	frame[15] = THREAD_CPSR;
+	if ((uint32_t)entry & 1)
+		frame[15] |= THREAD_CPSR_THUMB;
+	thread->sp = frame;
+
+	state = irq_save();
+	thread->all_next = _threads;
+	_threads = thread;
+	_ready_push(thread, false);
+	_preempt();
+	irq_restore(state);
+	return true;
+}
+
+void sched_thread_exit(void)
+{
+	struct _thread** link;
+
+	irq_disable();
+	for (link = &_threads; *link; link = &(*link)->all_next) {
+		if (*link == _current) {
+			*link = _current->all_next;
+			break;
+		}
+	}
+	_current->state = THREAD_ENDED;
+	_reschedule(false);
+	/* never reached */
+	while (1);
+}
+
+struct _thread* sched_current(void)
+{
+	return _current;
+}
+
+void sched_set_priority(struct _thread* thread, uint8_t priority)
+{
+	uint32_t state = irq_save();
+	struct _sched_wait* wait = thread->wait;
+
+	if (priority > SCHED_PRIO_MAX)
+		priority = SCHED_PRIO_MAX;
+
+	if (thread->state == THREAD_READY) {
+		_ready_remove(thread);
+		thread->priority = priority;
+		_ready_push(thread, false);
+	} else if (thread->state == THREAD_BLOCKED && wait) {
+		/* keep the wait list sorted */
+		_wait_remove(wait, thread);
+		thread->priority = priority;
+		_wait_insert(wait, thread);
+	} else {
+		thread->priority = priority;
+	}
+	if (_current)
+		_preempt();
+	irq_restore(state);
+}
+
+uint32_t sched_stack_unused(const struct _thread* thread)
+{
+	uint32_t i;
+
+	/* the main thread runs on the startup stack */
+	if (!thread->stack)
+		return 0;
+	for (i = 0; i < thread->stack_size / 4; i++)
+		if (thread->stack[i] != STACK_PATTERN)
+			break;
+	return i * 4;
+}
+
+void sched_yield(void)
+{
+	uint32_t state;
+
+	if (!_current || irq_in_interrupt())
+		return;
+	state = irq_save();
+	_reschedule(true);
+	irq_restore(state);
+}
+
+void sched_sleep(uint32_t ticks)
+{
+	uint32_t state;
+
+	if (!_current || irq_in_interrupt()) {
+		timer_wait(ticks);
+		return;
+	}
+	state = irq_save();
+	_block(NULL, ticks);
+	irq_restore(state);
+}
+
+void sched_wait_irq(void)
+{
+	uint32_t state;
+
+	if (!_current || irq_in_interrupt())
+		return;
+	state = irq_save();
+	_block(&_irq_waiters, SCHED_WAIT_FOREVER);
+	irq_restore(state);
+}
+
+void sched_wait_object(const volatile void* object)
+{
+	uint32_t state;
+
+	if (!_current || irq_in_interrupt())
+		return;
+	state = irq_save();
+	_current->object = object;
+	_block(&_object_waiters, SCHED_WAIT_FOREVER);
+	_current->object = NULL;
+	irq_restore(state);
+}
+
+bool sched_wake_object(const volatile void* object)
+{
+	uint32_t state = irq_save();
+	struct _thread* thread;
+
+	/* the list is sorted by priority */
+	for (thread = _object_waiters.head; thread; thread = thread->next)
+		if (thread->object == object)
+			break;
+	if (thread) {
+		_wake(thread, false);
+		_preempt();
+	}
+	irq_restore(state);
+	return thread != NULL;
+}
+
+void sched_sem_init(struct _sched_sem* sem, uint32_t count)
+{
+	sem->count = count;
+	sem->waiters.head = NULL;
+}
+
+void sched_sem_post(struct _sched_sem* sem)
+{
+	uint32_t state = irq_save();
+
+	/* the token goes straight to the first waiter */
+	if (_wake_first(&sem->waiters))
+		_preempt();
+	else
+		sem->count++;
+	irq_restore(state);
+}
+
+bool sched_sem_wait(struct _sched_sem* sem, uint32_t timeout)
+{
+	uint32_t state = irq_save();
+	bool taken = true;
+
+	if (sem->count)
+		sem->count--;
+	else if (timeout == 0 || !_current || irq_in_interrupt())
+		taken = false;
+	else
+		taken = _block(&sem->waiters, timeout);
+	irq_restore(state);
+	return taken;
+}
+
+void sched_msgq_init(struct _sched_msgq* msgq, void** buffer, uint32_t size)
+{
+	msgq->buffer = buffer;
+	msgq->size = size;
+	msgq->head = 0;
+	msgq->count = 0;
+	msgq->senders.head = NULL;
+	msgq->receivers.head = NULL;
+}
+
+bool sched_msgq_send(struct _sched_msgq* msgq, void* msg, uint32_t timeout)
+{
+	uint32_t state = irq_save();
+	struct _thread* receiver = msgq->receivers.head;
+	bool sent = true;
+
+	if (receiver) {
+		/* hand the message over */
+		receiver->msg = msg;
+		_wake(receiver, false);
+		_preempt();
+	} else if (msgq->count < msgq->size) {
+		msgq->buffer[(msgq->head + msgq->count) % msgq->size] = msg;
+		msgq->count++;
+	} else if (timeout == 0 || !_current || irq_in_interrupt()) {
+		sent = false;
+	} else {
+		/* the receiver takes the message from the blocked sender */
+		_current->msg = msg;
+		sent = _block(&msgq->senders, timeout);
+	}
+	irq_restore(state);
+	return sent;
+}
+
+bool sched_msgq_receive(struct _sched_msgq* msgq, void** msg,
+		uint32_t timeout)
+{
+	uint32_t state = irq_save();
+	struct _thread* sender = msgq->senders.head;
+	bool received = true;
+
+	if (msgq->count) {
+		*msg = msgq->buffer[msgq->head];
+		msgq->head = (msgq->head + 1) % msgq->size;
+		msgq->count--;
+		if (sender) {
+			/* room again for the first blocked sender */
+			msgq->buffer[(msgq->head + msgq->count) % msgq->size] =
+				sender->msg;
+			msgq->count++;
+			_wake(sender, false);
+			_preempt();
+		}
+	} else if (sender) {
+		*msg = sender->msg;
+		_wake(sender, false);
+		_preempt();
+	} else if (timeout == 0 || !_current || irq_in_interrupt()) {
+		received = false;
+	} else {
+		received = _block(&msgq->receivers, timeout);
+		if (received)
+			*msg = _current->msg;
+	}
+	irq_restore(state);
+	return received;
+}
@@ -0,0 +1,275 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  \par Purpose
+ *  Small priority-based preemptive scheduler for the Cortex-A5, with
+ *  semaphores, message queues and timed waits.
+ *
+ *  Threads run in SVC mode, each on its own stack. The highest priority
+ *  ready thread always runs; threads of the same priority share the CPU in
+ *  round robin, SCHED_TIME_SLICE ticks each. Preemption happens when
+ *  leaving the outermost interrupt (see irq_dispatch()), so an interrupt
+ *  handler that posts a semaphore or a message switches directly to the
+ *  thread it woke up. Interrupt handlers run on the stack of the thread
+ *  they interrupt: stack sizes must account for them.
+ *
+ *  Timeouts are counted in timer ticks (see timer_get_tick()). When no
+ *  thread is ready, the core waits for an interrupt on the stack of the
+ *  last running thread, there is no idle thread.
+ *
+ *  The VFP/NEON registers are not part of the thread context: threads and
+ *  interrupt handlers must not use floating point instructions.
+ *
+ *  \par Usage
+ *  -# Call sched_start() from main(): the caller becomes the first thread.
+ *  -# Create threads with sched_thread_create().
+ *  -# Synchronize with semaphores and message queues; both can be posted
+ *     from interrupt handlers.
+ *  -# Drivers waiting for an interrupt-driven transfer block on a
+ *     semaphore posted by their completion callback. sched_wait_irq(),
+ *     which blocks the calling thread until the next interrupt and returns
+ *     at once outside of threads, suits the loops that have no such event.
+ */
+
+#ifndef SCHED_HEADER_
+#define SCHED_HEADER_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of thread priorities, 0 being the lowest */
+#define SCHED_PRIORITIES    8
+
+/** Lowest priority, for background threads */
+#define SCHED_PRIO_IDLE     0
+
+/** Highest priority */
+#define SCHED_PRIO_MAX      (SCHED_PRIORITIES - 1)
+
+/** Ticks given to a thread before the next one of the same priority runs */
+#define SCHED_TIME_SLICE    10
+
+/** Timeout value waiting without limit */
+#define SCHED_WAIT_FOREVER  UINT32_MAX
+
+/** Minimum stack size of a thread, in bytes */
+#define SCHED_STACK_MIN     256
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+typedef void (*sched_entry_t)(void* arg);
+
+struct _thread;
+
+/** List of threads blocked on an object, highest priority first */
+struct _sched_wait {
+	struct _thread* head;
+};
+
+/** Thread, owned by the caller */
+struct _thread {
+	uint32_t* sp;                /**< saved context, must be first */
+	const char* name;
+	uint32_t* stack;
+	uint32_t stack_size;         /**< in bytes */
+	uint8_t priority;
+	uint8_t state;
+	bool timed;                  /**< blocked with a timeout */
+	bool timed_out;
+	uint32_t wake;               /**< tick to wake up at if timed */
+	struct _sched_wait* wait;    /**< list the thread is blocked on */
+	void* msg;                   /**< message handed over by a queue */
+	const volatile void* object; /**< see sched_wait_object() */
+	struct _thread* next;        /**< ready or wait list linkage */
+	struct _thread* all_next;    /**< list of all threads */
+};
+
+/** Counting semaphore */
+struct _sched_sem {
+	uint32_t count;
+	struct _sched_wait waiters;
+};
+
+/** Queue of pointer-sized messages */
+struct _sched_msgq {
+	void** buffer;
+	uint32_t size;
+	uint32_t head;
+	uint32_t count;
+	struct _sched_wait senders;
+	struct _sched_wait receivers;
+};
+
+/*----------------------------------------------------------------------------
+ *         Global functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Start the scheduler, the caller becomes a thread named "main".
+ * \param priority  Priority of the calling thread.
+ */
+extern void sched_start(uint8_t priority);
+
+/**
+ * \brief Tell whether the scheduler has been started
+ */
+extern bool sched_is_running(void);
+
+/**
+ * \brief Create a thread, ready to run at once.
+ * \param thread      Thread structure, must stay valid while it runs.
+ * \param name        Name, for debugging.
+ * \param entry       Thread function, returning from it ends the thread.
+ * \param arg         Argument given to the thread function.
+ * \param stack       Stack, 8-byte aligned.
+ * \param stack_size  Stack size in bytes, at least SCHED_STACK_MIN.
+ * \param priority    Thread priority, up to SCHED_PRIO_MAX.
+ * \return true on success, false if a parameter is invalid.
+ */
+extern bool sched_thread_create(struct _thread* thread, const char* name,
+		sched_entry_t entry, void* arg, void* stack, uint32_t stack_size,
+		uint8_t priority);
+
+/**
+ * \brief End the calling thread.
+ */
+extern void sched_thread_exit(void);
+
+/**
+ * \brief Get the calling thread, NULL before sched_start().
+ */
+extern struct _thread* sched_current(void);
+
+/**
+ * \brief Change the priority of a thread.
+ */
+extern void sched_set_priority(struct _thread* thread, uint8_t priority);
+
+/**
+ * \brief Get the number of bytes of a thread stack that were never used.
+ */
+extern uint32_t sched_stack_unused(const struct _thread* thread);
+
+/**
+ * \brief Let the other ready threads of the same priority run.
+ */
+extern void sched_yield(void);
+
+/**
+ * \brief Block the calling thread for a number of ticks.
+ */
+extern void sched_sleep(uint32_t ticks);
+
+/**
+ * \brief Block the calling thread until the next interrupt has been
+ * handled. Returns at once in interrupt context or if the scheduler is not
+ * running, so that callers fall back to polling.
+ */
+extern void sched_wait_irq(void);
+
+/**
+ * \brief Block the calling thread until sched_wake_object() is called for
+ * the same object, to build other blocking primitives (see mutex_lock()).
+ * Call it with IRQs masked, right after checking the condition to wait
+ * for, so that a wake-up cannot be missed. Returns at once in interrupt
+ * context or if the scheduler is not running.
+ */
+extern void sched_wait_object(const volatile void* object);
+
+/**
+ * \brief Wake up the highest priority thread waiting on an object. Can be
+ * called from interrupt handlers.
+ * \return true if a thread was woken up.
+ */
+extern bool sched_wake_object(const volatile void* object);
+
+/**
+ * \brief Initialize a semaphore.
+ */
+extern void sched_sem_init(struct _sched_sem* sem, uint32_t count);
+
+/**
+ * \brief Release a semaphore, wakes up the highest priority waiter.
+ * Can be called from interrupt handlers.
+ */
+extern void sched_sem_post(struct _sched_sem* sem);
+
+/**
+ * \brief Take a semaphore.
+ * \param sem      Semaphore.
+ * \param timeout  Ticks to wait, 0 to try only, or SCHED_WAIT_FOREVER.
+ * \return true if taken, false on timeout.
+ */
+extern bool sched_sem_wait(struct _sched_sem* sem, uint32_t timeout);
+
+/**
+ * \brief Initialize a message queue.
+ * \param msgq    Message queue.
+ * \param buffer  Storage for size messages.
+ * \param size    Number of messages the queue holds, 0 for a rendez-vous.
+ */
+extern void sched_msgq_init(struct _sched_msgq* msgq, void** buffer,
+		uint32_t size);
+
+/**
+ * \brief Send a message. Can be called from interrupt handlers with a 0
+ * timeout.
+ * \param msgq     Message queue.
+ * \param msg      Message.
+ * \param timeout  Ticks to wait for room, 0 to try only, or
+ *                 SCHED_WAIT_FOREVER.
+ * \return true if sent, false on timeout.
+ */
+extern bool sched_msgq_send(struct _sched_msgq* msgq, void* msg,
+		uint32_t timeout);
+
+/**
+ * \brief Receive a message.
+ * \param msgq     Message queue.
+ * \param msg      Received message.
+ * \param timeout  Ticks to wait for a message, 0 to try only, or
+ *                 SCHED_WAIT_FOREVER.
+ * \return true if received, false on timeout.
+ */
+extern bool sched_msgq_receive(struct _sched_msgq* msgq, void** msg,
+		uint32_t timeout);
+
+#endif /* SCHED_HEADER_ */
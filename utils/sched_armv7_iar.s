@@ -0,0 +1,57 @@
+	MODULE ?sched
+
+#define ARM_MODE_IRQ   0x12
+#define ARM_MODE_SVC   0x13
+#define I_BIT          0x80
+#define F_BIT          0x40
+
+/* A suspended thread keeps its context on its own stack, lowest address
+ * first: r0-r12, lr, pc, cpsr (16 words) */
+
+/* Switch threads from thread context: save the context on the current
+ * stack, store sp in *r0 and resume the thread whose saved sp is r1.
+ * Called in SVC mode with IRQs masked. */
+	SECTION .sched_context_switch:CODE:NOROOT(2)
+	PUBLIC  sched_context_switch
+sched_context_switch:
+	sub     sp, sp, #8
+	stmfd   sp!, {r0-r12, lr}
+	str     lr, [sp, #56] /* Resume by returning to the caller */
+	mrs     r2, cpsr
+	str     r2, [sp, #60]
+	str     sp, [r0]
+	mov     sp, r1
+	clrex                 /* Drop exclusive accesses of the previous thread */
+	ldmfd   sp!, {r0-r12, lr}
+	rfeia   sp!
+
+/* Switch threads on interrupt exit, branched to by irqHandler in SVC mode
+ * with IRQs masked and the interrupted context restored but r0, which is
+ * still in the frame {r0, spsr, lr} on the IRQ stack. The frame is moved to
+ * the thread stack and sched_irq_context gives where to store sp and the
+ * saved sp of the thread to resume. */
+	SECTION .sched_irq_switch:CODE:NOROOT(2)
+	PUBLIC  sched_irq_switch
+	EXTERN  sched_irq_context
+sched_irq_switch:
+	sub     sp, sp, #8
+	stmfd   sp!, {r1-r12, lr}
+	msr     CPSR_c, #ARM_MODE_IRQ | I_BIT | F_BIT
+	mov     r0, sp
+	add     sp, sp, #12   /* Pop the IRQ frame, IRQs stay masked */
+	msr     CPSR_c, #ARM_MODE_SVC | I_BIT
+	ldr     r1, [r0, #8]
+	str     r1, [sp, #52] /* Interrupted pc */
+	ldr     r1, [r0, #4]
+	str     r1, [sp, #56] /* Interrupted cpsr */
+	ldr     r1, [r0]
+	stmfd   sp!, {r1}     /* Interrupted r0 */
+	ldr     r0, =sched_irq_context
+	ldmia   r0, {r1, r2}
+	str     sp, [r1]
+	mov     sp, r2
+	clrex                 /* Drop exclusive accesses of the previous thread */
+	ldmfd   sp!, {r0-r12, lr}
+	rfeia   sp!
+
+	END
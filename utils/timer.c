@@ -37,11 +37,16 @@
  *----------------------------------------------------------------------------*/
 
 #include "board.h"
+#include "compiler.h"
 #include "timer.h"
+#include "power.h"
 #include "peripherals/tc.h"
 #include "peripherals/pit.h"
 #include "peripherals/aic.h"
 #include "peripherals/pmc.h"
+#include "intmath.h"
+
+#include <stdbool.h>
 
 /*----------------------------------------------------------------------------
  *         Local variables
@@ -51,6 +56,25 @@
 static volatile uint32_t _tick_counter = 0;
 static uint32_t _resolution = 0;
 
+#ifndef CONFIG_TIMER_POLLING
+/** PIV of the periodic tick */
+static uint32_t _periodic_piv = 0;
+
+/** Set while the PIT runs one shortened period to get back on a tick
+ * boundary after a tickless period */
+static volatile bool _realign = false;
+
+/** PIT state saved by timer_suspend_tick() */
+static struct {
+	bool stopped;   /* tick interrupt disabled, no PIT wake-up */
+	uint32_t cpiv;  /* counter value when the tick was suspended */
+	uint32_t phase; /* counts elapsed in the tick at that time */
+	uint32_t piv;   /* PIV programmed for the wake-up */
+	uint32_t clock; /* PIT input clock during the tickless period */
+	uint32_t run;   /* PIT input clock of the periodic tick */
+} _suspend;
+#endif
+
 /*----------------------------------------------------------------------------
  *         Exported Functions
  *----------------------------------------------------------------------------*/
@@ -69,9 +93,29 @@ static void timer_increment(void)
 		 * Return the number of occurrences of periodic intervals
 		 * since the last read of PIT_PIVR. */
 		_tick_counter += pit_get_pivr() >> 20;
+#ifndef CONFIG_TIMER_POLLING
+		if (_realign) {
+			/* back on a tick boundary, restore the periodic tick */
+			pit_set_piv(_periodic_piv);
+			_realign = false;
+		}
+#endif
 	}
 }
 
+#ifndef CONFIG_TIMER_POLLING
+/**
+ * \brief Convert a number of PIT counts from one PIT clock to another,
+ * rounding up
+ */
+static uint32_t _convert_counts(uint32_t counts, uint32_t from, uint32_t to)
+{
+	if (from == to)
+		return counts;
+	return (uint32_t)CEIL_INT_DIV((uint64_t)counts * to, from);
+}
+#endif
+
 void timer_configure(uint32_t resolution)
 {
 	_resolution = resolution ? resolution : BOARD_TIMER_RESOLUTION;
@@ -82,6 +126,8 @@ void timer_configure(uint32_t resolution)
 #ifdef CONFIG_TIMER_POLLING
 	pit_disable_it();
 #else
+	_periodic_piv = pit_get_mode() & PIT_MR_PIV_Msk;
+	_realign = false;
 	aic_set_source_vector(ID_PIT, timer_increment);
 	aic_enable(ID_PIT);
 	pit_enable_it();
@@ -122,7 +168,9 @@ void timer_wait(uint32_t count)
 	struct _timeout timeout;
 	timer_start_timeout(&timeout, count);
 	while (!timer_timeout_reached(&timeout)) {
-#ifndef CONFIG_TIMER_POLLING
+#if defined(CONFIG_TIMER_TICKLESS)
+		power_idle(timeout.start + timeout.count);
+#elif !defined(CONFIG_TIMER_POLLING)
 		irq_wait();
 #endif
 	}
@@ -140,3 +188,109 @@ uint32_t timer_get_tick(void)
 #endif
 	return _tick_counter;
 }
+
+uint32_t timer_suspend_tick(uint32_t deadline, uint32_t clock)
+{
+#ifdef CONFIG_TIMER_POLLING
+	return 0;
+#else
+	uint32_t pivr, piv, cpiv, period, remain, ticks, max_ticks;
+	uint32_t avail, counts;
+
+	_suspend.run = pmc_get_peripheral_clock(ID_PIT);
+	_suspend.clock = clock ? clock : _suspend.run;
+
+	/* account for elapsed periods, the counter keeps running */
+	pivr = pit_get_pivr();
+	_tick_counter += pivr >> PIT_PIVR_PICNT_Pos;
+	cpiv = pivr & PIT_PIVR_CPIV_Msk;
+	piv = pit_get_mode() & PIT_MR_PIV_Msk;
+
+	/* counts up to the end of the current period (always a tick
+	 * boundary, also when a realignment period was running) */
+	period = _periodic_piv + 1;
+	remain = piv + 1 - cpiv;
+
+	_suspend.cpiv = cpiv;
+	_suspend.phase = remain < period ? period - remain : 0;
+	_suspend.piv = piv;
+
+	if (deadline == TIMER_NO_DEADLINE) {
+		/* no wake-up from the PIT at all */
+		pit_disable_it();
+		_realign = false;
+		_suspend.stopped = true;
+		return TIMER_NO_DEADLINE;
+	}
+	_suspend.stopped = false;
+
+	ticks = deadline - _tick_counter;
+	if (ticks == 0 || ticks > (UINT32_MAX >> 1))
+		return 0;
+
+	/* clamp to the range of the 20-bit counter */
+	avail = (uint32_t)(((uint64_t)(PIT_MR_PIV_Msk - cpiv) * _suspend.run) /
+			_suspend.clock);
+	if (avail < remain)
+		return 0;
+	max_ticks = 1 + (avail - remain) / period;
+	if (ticks > max_ticks)
+		ticks = max_ticks;
+
+	counts = _convert_counts(remain + (ticks - 1) * period,
+			_suspend.run, _suspend.clock);
+	if (counts < 2)
+		return 0;
+
+	_realign = false;
+	_suspend.piv = cpiv + counts - 1;
+	pit_set_piv(_suspend.piv);
+	return ticks;
+#endif
+}
+
+uint32_t timer_resume_tick(uint32_t slept)
+{
+#ifdef CONFIG_TIMER_POLLING
+	return 0;
+#else
+	uint32_t pivr, cpiv, picnt, period, ticks, phase, piv;
+	uint64_t counts, elapsed;
+
+	pivr = pit_get_pivr();
+	cpiv = pivr & PIT_PIVR_CPIV_Msk;
+	picnt = pivr >> PIT_PIVR_PICNT_Pos;
+	period = _periodic_piv + 1;
+
+	if (slept) {
+		/* measured by the caller: the PIT clock was stopped */
+		elapsed = ((uint64_t)slept * (_suspend.run / 16)) / 1000000;
+	} else {
+		counts = (uint64_t)picnt * (_suspend.piv + 1) + cpiv;
+		counts -= _suspend.cpiv;
+		elapsed = ROUND_INT_DIV(counts * _suspend.run, _suspend.clock);
+	}
+
+	/* position relative to the tick boundary preceding the suspend */
+	counts = elapsed + _suspend.phase;
+	ticks = (uint32_t)(counts / period);
+	phase = (uint32_t)(counts % period);
+	_tick_counter += ticks;
+
+	/* finish the current tick from where the counter is now, the
+	 * handler will then restore the periodic PIV */
+	piv = cpiv + (period - phase) - 1;
+	if (piv > PIT_MR_PIV_Msk)
+		piv = PIT_MR_PIV_Msk;
+	if (piv == _periodic_piv) {
+		pit_set_piv(_periodic_piv);
+	} else {
+		pit_set_piv(piv);
+		_realign = true;
+	}
+	if (_suspend.stopped)
+		pit_enable_it();
+
+	return (uint32_t)((elapsed * 16000000) / _suspend.run);
+#endif
+}
@@ -44,6 +44,13 @@
  *  -# Uses timer_wait to actively wait according to your timer resolution.
  *  -# Uses timer_sleep to passively wait ccording to your timer resolution.
  *
+ *  \par Tickless idle
+ *
+ *  With CONFIG_TIMER_TICKLESS, timer_wait() hands the remaining time to
+ *  power_idle() (see power.h) instead of waking up on every tick. The power
+ *  manager uses timer_suspend_tick() to turn the PIT into a one-shot timer
+ *  expiring at the deadline and timer_resume_tick() to add the elapsed time
+ *  back to the tick counter on wake-up.
  */
 
 #ifndef TIMER_HEADER_
@@ -55,6 +62,9 @@
 
 #include <stdint.h>
 
+/** Deadline value meaning "no timer wake-up" for timer_suspend_tick() */
+#define TIMER_NO_DEADLINE UINT32_MAX
+
 struct _timeout
 {
 	uint32_t start;
@@ -130,4 +140,34 @@ extern uint32_t timer_get_interval(uint32_t start, uint32_t end);
  */
 extern uint32_t timer_get_tick(void);
 
+/**
+ * \brief Stop the periodic tick until a deadline.
+ *
+ * The PIT keeps counting but its period is stretched so that the next
+ * interrupt occurs on the tick boundary of \a deadline (clamped to the range
+ * of the PIT counter). Must be called with interrupts disabled and followed
+ * by timer_resume_tick().
+ *
+ * \param deadline Tick count to wake up at, or TIMER_NO_DEADLINE to disable
+ * the PIT interrupt altogether.
+ * \param clock PIT input clock (Hz) while the tick is suspended, if the
+ * caller is about to change MCK, 0 if unchanged.
+ * \return Number of ticks until the programmed wake-up, 0 if the deadline is
+ * too close (the tick is then left running).
+ */
+extern uint32_t timer_suspend_tick(uint32_t deadline, uint32_t clock);
+
+/**
+ * \brief Restart the periodic tick after timer_suspend_tick().
+ *
+ * The elapsed periods are added to the tick counter and the PIT is realigned
+ * on the original tick boundaries. Must be called with interrupts disabled,
+ * with MCK back to its periodic tick setting.
+ *
+ * \param slept Time spent with the PIT clock stopped (us), measured by the
+ * caller with another time base, 0 to measure the elapsed time with the PIT.
+ * \return Elapsed time since timer_suspend_tick() (us).
+ */
+extern uint32_t timer_resume_tick(uint32_t slept);
+
 #endif /* TIMER_HEADER_ */